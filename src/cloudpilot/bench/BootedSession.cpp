@@ -0,0 +1,66 @@
+#include "BootedSession.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+
+#include "EmDevice.h"
+#include "EmROMReader.h"
+#include "EmSession.h"
+#include "EmSystemState.h"
+#include "SessionImage.h"
+
+namespace {
+    constexpr const char* IMAGE_DIR = "../../web/embedded/public";
+    constexpr const char* ROM_NAME = "palmv.rom";
+    constexpr const char* DEVICE_ID = "PalmV";
+
+    constexpr uint64 MAX_BOOT_CYCLES = 100000000;
+    constexpr uint32 CYCLES_PER_SLICE = 100000;
+
+    vector<uint8> readRom() {
+        const char* imageDir = getenv("CLOUDPILOT_BENCH_IMAGES");
+        ifstream stream(string(imageDir ? imageDir : IMAGE_DIR) + "/" + ROM_NAME, ios::binary);
+
+        return vector<uint8>(istreambuf_iterator<char>(stream), istreambuf_iterator<char>());
+    }
+}  // namespace
+
+bool restoreBootedSession() {
+    static vector<uint8> image;
+
+    if (!image.empty()) {
+        vector<uint8> buffer = image;
+        SessionImage sessionImage;
+
+        return sessionImage.Deserialize(buffer.data(), buffer.size()) &&
+               gSession->LoadImage(sessionImage);
+    }
+
+    vector<uint8> rom = readRom();
+
+    EmROMReader reader(rom.data(), rom.size());
+    if (rom.empty() || !reader.Read()) return false;
+
+    EmDevice* device = new EmDevice(DEVICE_ID);
+    if (!device->Supported() || !device->SupportsROM(reader)) {
+        delete device;
+        return false;
+    }
+
+    if (!gSession->Initialize(device, rom.data(), rom.size())) return false;
+
+    while (!gSystemState->IsUIInitialized() && gSession->GetSystemCycles() < MAX_BOOT_CYCLES)
+        gSession->RunEmulation(CYCLES_PER_SLICE);
+
+    SessionImage sessionImage;
+
+    if (!gSystemState->IsUIInitialized() || !gSession->SaveImage(sessionImage) ||
+        !sessionImage.Serialize())
+        return false;
+
+    uint8* serialized = static_cast<uint8*>(sessionImage.GetSerializedImage());
+    image.assign(serialized, serialized + sessionImage.GetSerializedImageSize());
+
+    return true;
+}
@@ -0,0 +1,13 @@
+#ifndef _BENCH_BOOTED_SESSION_H_
+#define _BENCH_BOOTED_SESSION_H_
+
+// Puts gSession into the state of a Palm V that has just booted to the
+// launcher. The device is booted once; later calls restore a session image
+// taken after the boot. Returns false if the ROM is not available.
+//
+// The ROM is read from ../../web/embedded/public (relative to src/cloudpilot)
+// or from the directory in CLOUDPILOT_BENCH_IMAGES.
+
+bool restoreBootedSession();
+
+#endif  // _BENCH_BOOTED_SESSION_H_
@@ -0,0 +1,91 @@
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+#include <iterator>
+
+// clang-format off
+#include "Debugger.h"
+#include "EmDevice.h"
+#include "EmROMReader.h"
+#include "EmSession.h"
+#include "EmSystemState.h"
+// clang-format on
+
+// Compare the emulation speed with and without a debugger attached. "make
+// bench-debugger" runs these from the plain benchmark build and from a build
+// with -DENABLE_DEBUGGER; the detached numbers should match between both.
+
+namespace {
+    constexpr uint64 MAX_BOOT_CYCLES = 100000000;
+    constexpr uint32 CYCLES_PER_SLICE = 100000;
+
+    // Unmapped on the Palm V, so neither the breakpoint nor the watchpoint are ever hit.
+    constexpr emuptr UNUSED_ADDRESS = 0x3fff0000;
+
+    vector<uint8>& readRom() {
+        static vector<uint8> rom = []() {
+            ifstream stream("../../web/embedded/public/palmv.rom", ios::binary);
+
+            return vector<uint8>(istreambuf_iterator<char>(stream), istreambuf_iterator<char>());
+        }();
+
+        return rom;
+    }
+
+    // Boot a Palm V to the launcher. The CPU is idle most of the time once the
+    // UI is up, so the boot is what keeps the main loop busy.
+    void bootWithDebugger(benchmark::State& state, bool attach) {
+        vector<uint8>& rom = readRom();
+
+        EmROMReader reader(rom.data(), rom.size());
+        if (rom.empty() || !reader.Read())
+            return state.SkipWithError("unable to read ../../web/embedded/public/palmv.rom");
+
+        uint64 cycles = 0;
+
+        for (auto _ : state) {
+            EmDevice* device = new EmDevice("PalmV");
+
+            if (!gSession->Initialize(device, rom.data(), rom.size()))
+                return state.SkipWithError("unable to initialize session");
+
+            gDebugger->Reset();
+
+            if (attach) {
+                gDebugger->Enable();
+                gDebugger->SetBreakpoint(UNUSED_ADDRESS);
+                gDebugger->SetWatchpoint(UNUSED_ADDRESS, Debugger::WatchpointType::write, 4);
+            }
+
+            while (!gSystemState->IsUIInitialized() && !gDebugger->IsStopped() &&
+                   gSession->GetSystemCycles() < MAX_BOOT_CYCLES)
+                gSession->RunEmulation(CYCLES_PER_SLICE);
+
+            if (gDebugger->IsStopped()) return state.SkipWithError("debugger stopped emulation");
+
+            cycles += gSession->GetSystemCycles();
+
+            gDebugger->Reset();
+            gSession->Deinitialize();
+        }
+
+        state.SetItemsProcessed(cycles);
+    }
+
+    void BM_BootDebuggerDetached(benchmark::State& state) { bootWithDebugger(state, false); }
+
+    void BM_BootDebuggerAttached(benchmark::State& state) { bootWithDebugger(state, true); }
+
+#ifdef ENABLE_DEBUGGER
+    const string BUILD_SUFFIX = "/debugger_build";
+#else
+    const string BUILD_SUFFIX = "/plain_build";
+#endif
+}  // namespace
+
+BENCHMARK(BM_BootDebuggerDetached)
+    ->Name("BM_BootDebuggerDetached" + BUILD_SUFFIX)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BootDebuggerAttached)
+    ->Name("BM_BootDebuggerAttached" + BUILD_SUFFIX)
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,64 @@
+#include "EmCPU68K.h"
+
+#include <benchmark/benchmark.h>
+
+#include "BootedSession.h"
+#include "EmMemory.h"
+
+namespace {
+    constexpr emuptr CODE_ADDRESS = 0x8000;
+    constexpr emuptr DATA_ADDRESS = 0x9000;
+
+    constexpr uint32 CYCLES_PER_ITERATION = 1000000;
+
+    // A mix of register, memory and multiplication instructions that loops
+    // forever:
+    //
+    //          lea     $9000.l, a0
+    //          moveq   #0, d0
+    //   loop:  addq.l  #1, d0
+    //          move.l  d0, (a0)
+    //          move.l  (a0), d1
+    //          lsl.l   #2, d1
+    //          eor.l   d1, d0
+    //          move.w  d0, 4(a0)
+    //          mulu.w  d1, d0
+    //          bra.s   loop
+    constexpr uint16 CODE[] = {0x41f9, 0x0000, 0x9000, 0x7000, 0x5280, 0x2080, 0x2210,
+                               0xe589, 0xb380, 0x3140, 0x0004, 0xc0c1, 0x60ee};
+
+    // Run the code block in supervisor mode with all interrupts masked, so
+    // the OS does not get a chance to run in between.
+    bool setupCode() {
+        if (!restoreBootedSession()) return false;
+
+        CEnableFullAccess munge;
+
+        for (size_t i = 0; i < sizeof(CODE) / sizeof(CODE[0]); i++)
+            EmMemPut16(CODE_ADDRESS + 2 * i, CODE[i]);
+
+        gCPU68K->SetRegister(e68KRegID_SR, 0x2700);
+        gCPU68K->SetPC(CODE_ADDRESS);
+        gCPU68K->SetStopped(false);
+
+        return true;
+    }
+
+    void BM_EmCPU68KExecute(benchmark::State& state) {
+        if (!setupCode()) return state.SkipWithError("unable to boot session");
+
+        const uint64 instructionsBefore = gCPU68K->GetInstructionCount();
+
+        for (auto _ : state) gCPU68K->Execute(CYCLES_PER_ITERATION);
+
+        if (gCPU68K->GetPC() < CODE_ADDRESS || gCPU68K->GetPC() >= DATA_ADDRESS)
+            return state.SkipWithError("CPU left the code block");
+
+        state.SetItemsProcessed(state.iterations() * CYCLES_PER_ITERATION);
+        state.counters["instructions"] =
+            benchmark::Counter(gCPU68K->GetInstructionCount() - instructionsBefore,
+                               benchmark::Counter::kIsRate);
+    }
+}  // namespace
+
+BENCHMARK(BM_EmCPU68KExecute)->Unit(benchmark::kMicrosecond);
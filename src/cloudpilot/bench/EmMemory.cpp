@@ -0,0 +1,144 @@
+#include "EmMemory.h"
+
+#include <benchmark/benchmark.h>
+
+#include "BootedSession.h"
+#include "EmBankMapped.h"
+#include "EmHAL.h"
+#include "Miscellaneous.h"
+
+namespace {
+    constexpr uint32 ACCESSES_PER_ITERATION = 256;
+    constexpr uint32 STRIDE = 16;
+
+    constexpr emuptr ADDRESS_IMR = 0xfffff304;
+
+    enum class Bank { dram, sram, rom, regs, mapped };
+
+    class MappedBlock {
+       public:
+        MappedBlock() : mapper(block, sizeof(block)) {
+            address = EmBankMapped::GetEmulatedAddress(block);
+        }
+
+        emuptr GetAddress() const { return address; }
+
+       private:
+        uint8 block[ACCESSES_PER_ITERATION * STRIDE]{};
+        StMemoryMapper mapper;
+        emuptr address;
+    };
+
+    // The first address of a block of ACCESSES_PER_ITERATION * STRIDE bytes in
+    // the bank. The Dragonball registers are represented by the interrupt mask
+    // register, which can be read and written without side effects.
+    emuptr bankAddress(Bank bank, const MappedBlock& mapped) {
+        switch (bank) {
+            case Bank::dram:
+                return 0x4000;
+
+            case Bank::sram:
+                return EmHAL::GetDynamicHeapSize() + 0x4000;
+
+            case Bank::rom:
+                return EmHAL::GetROMBaseAddress() + 0x4000;
+
+            case Bank::regs:
+                return ADDRESS_IMR;
+
+            case Bank::mapped:
+                return mapped.GetAddress();
+        }
+
+        return EmMemNULL;
+    }
+
+    template <int size>
+    uint32 get(emuptr address) {
+        if constexpr (size == 1)
+            return EmMemGet8(address);
+        else if constexpr (size == 2)
+            return EmMemGet16(address);
+        else
+            return EmMemGet32(address);
+    }
+
+    template <int size>
+    void put(emuptr address, uint32 value) {
+        if constexpr (size == 1)
+            EmMemPut8(address, value);
+        else if constexpr (size == 2)
+            EmMemPut16(address, value);
+        else
+            EmMemPut32(address, value);
+    }
+
+    template <Bank bank, int size>
+    void BM_EmMemGet(benchmark::State& state) {
+        if (!restoreBootedSession()) return state.SkipWithError("unable to boot session");
+
+        MappedBlock mapped;
+        const emuptr base = bankAddress(bank, mapped);
+        const uint32 stride = bank == Bank::regs ? 0 : STRIDE;
+
+        uint32 sum = 0;
+
+        for (auto _ : state)
+            for (uint32 i = 0; i < ACCESSES_PER_ITERATION; i++)
+                sum += get<size>(base + i * stride);
+
+        benchmark::DoNotOptimize(sum);
+        state.SetItemsProcessed(state.iterations() * ACCESSES_PER_ITERATION);
+    }
+
+    // Writes back the values that are already there. Full access is enabled so
+    // that writes to the (write protected) storage heap go through.
+    template <Bank bank, int size>
+    void BM_EmMemPut(benchmark::State& state) {
+        if (!restoreBootedSession()) return state.SkipWithError("unable to boot session");
+
+        MappedBlock mapped;
+        const emuptr base = bankAddress(bank, mapped);
+        const uint32 stride = bank == Bank::regs ? 0 : STRIDE;
+
+        CEnableFullAccess munge;
+
+        uint32 values[ACCESSES_PER_ITERATION];
+        for (uint32 i = 0; i < ACCESSES_PER_ITERATION; i++)
+            values[i] = get<size>(base + i * stride);
+
+        for (auto _ : state)
+            for (uint32 i = 0; i < ACCESSES_PER_ITERATION; i++)
+                put<size>(base + i * stride, values[i]);
+
+        state.SetItemsProcessed(state.iterations() * ACCESSES_PER_ITERATION);
+    }
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_EmMemGet, Bank::dram, 1);
+BENCHMARK_TEMPLATE(BM_EmMemGet, Bank::dram, 2);
+BENCHMARK_TEMPLATE(BM_EmMemGet, Bank::dram, 4);
+BENCHMARK_TEMPLATE(BM_EmMemPut, Bank::dram, 1);
+BENCHMARK_TEMPLATE(BM_EmMemPut, Bank::dram, 2);
+BENCHMARK_TEMPLATE(BM_EmMemPut, Bank::dram, 4);
+
+BENCHMARK_TEMPLATE(BM_EmMemGet, Bank::sram, 1);
+BENCHMARK_TEMPLATE(BM_EmMemGet, Bank::sram, 2);
+BENCHMARK_TEMPLATE(BM_EmMemGet, Bank::sram, 4);
+BENCHMARK_TEMPLATE(BM_EmMemPut, Bank::sram, 1);
+BENCHMARK_TEMPLATE(BM_EmMemPut, Bank::sram, 2);
+BENCHMARK_TEMPLATE(BM_EmMemPut, Bank::sram, 4);
+
+BENCHMARK_TEMPLATE(BM_EmMemGet, Bank::rom, 1);
+BENCHMARK_TEMPLATE(BM_EmMemGet, Bank::rom, 2);
+BENCHMARK_TEMPLATE(BM_EmMemGet, Bank::rom, 4);
+
+BENCHMARK_TEMPLATE(BM_EmMemGet, Bank::regs, 4);
+BENCHMARK_TEMPLATE(BM_EmMemPut, Bank::regs, 4);
+
+BENCHMARK_TEMPLATE(BM_EmMemGet, Bank::mapped, 1);
+BENCHMARK_TEMPLATE(BM_EmMemGet, Bank::mapped, 2);
+BENCHMARK_TEMPLATE(BM_EmMemGet, Bank::mapped, 4);
+BENCHMARK_TEMPLATE(BM_EmMemPut, Bank::mapped, 1);
+BENCHMARK_TEMPLATE(BM_EmMemPut, Bank::mapped, 2);
+BENCHMARK_TEMPLATE(BM_EmMemPut, Bank::mapped, 4);
@@ -0,0 +1,134 @@
+#include <benchmark/benchmark.h>
+
+// clang-format off
+#include "EmBankMapped.h"
+#include "EmSubroutine.h"
+#include "EmSubroutineDecl.h"
+#include "Marshal.h"
+#include "Miscellaneous.h"
+// clang-format on
+
+// The prototype of NetLibSocketOpen, a typical ROMStubs / trap patch signature.
+
+#define RETURN_DECL "NetSocketRef"
+#define PARAM_DECL                                                                          \
+    "UInt16 libRefnum, NetSocketAddrEnum domain, NetSocketTypeEnum type, Int16 protocol, " \
+    "Int32 timeout, Err* errP"
+
+namespace {
+    constexpr size_t STACK_SIZE = 64;
+
+    class MappedStack {
+       public:
+        MappedStack() : mapper(stack, STACK_SIZE) {
+            address = EmBankMapped::GetEmulatedAddress(stack);
+        }
+
+        emuptr GetAddress() const { return address; }
+
+       private:
+        uint8 stack[STACK_SIZE]{};
+        StMemoryMapper mapper;
+        emuptr address;
+    };
+
+    void setupMemory() {
+        EmBankMapped::Initialize();
+        EmBankMapped::SetBankHandlers();
+    }
+
+    void BM_EmSubroutineDescribeDeclString(benchmark::State& state) {
+        for (auto _ : state) {
+            EmSubroutine sub;
+            sub.DescribeDecl(RETURN_DECL, PARAM_DECL);
+
+            benchmark::DoNotOptimize(sub);
+        }
+    }
+
+    void BM_EmSubroutineDescribeDeclConstexpr(benchmark::State& state) {
+        static constexpr EmSubroutineDecl subDecl(RETURN_DECL, PARAM_DECL);
+
+        for (auto _ : state) {
+            EmSubroutine sub;
+            sub.DescribeDecl(subDecl);
+
+            benchmark::DoNotOptimize(sub);
+        }
+    }
+
+    // The path taken by CALLED_SETUP_STDARG: describe the prototype on each call, then
+    // read the parameters.
+    void BM_EmSubroutineCalledStdarg(benchmark::State& state) {
+        setupMemory();
+        MappedStack stack;
+
+        for (auto _ : state) {
+            CALLED_SETUP_STDARG(RETURN_DECL, PARAM_DECL);
+            sub.PrepareStack(stack.GetAddress());
+
+            CALLED_GET_PARAM_VAL(UInt16, libRefnum);
+            CALLED_GET_PARAM_VAL(NetSocketAddrEnum, domain);
+            CALLED_GET_PARAM_VAL(NetSocketTypeEnum, type);
+            CALLED_GET_PARAM_VAL(Int16, protocol);
+            CALLED_GET_PARAM_VAL(Int32, timeout);
+
+            benchmark::DoNotOptimize(libRefnum + domain + type + protocol + timeout);
+        }
+    }
+
+    // The path taken by CALLED_SETUP in trap patches: the subroutine is static, so only
+    // the parameter reads are left.
+    void BM_EmSubroutineCalled(benchmark::State& state) {
+        setupMemory();
+        MappedStack stack;
+
+        DECLARE_SUBROUTINE_DECL(RETURN_DECL, PARAM_DECL);
+        static EmSubroutine sub;
+        sub.DescribeDecl(subDecl);
+
+        for (auto _ : state) {
+            sub.PrepareStack(stack.GetAddress());
+
+            CALLED_GET_PARAM_VAL(UInt16, libRefnum);
+            CALLED_GET_PARAM_VAL(NetSocketAddrEnum, domain);
+            CALLED_GET_PARAM_VAL(NetSocketTypeEnum, type);
+            CALLED_GET_PARAM_VAL(Int16, protocol);
+            CALLED_GET_PARAM_VAL(Int32, timeout);
+
+            benchmark::DoNotOptimize(libRefnum + domain + type + protocol + timeout);
+        }
+    }
+
+    // The path taken by CALLER_SETUP in ROMStubs, up to the actual call into the ROM.
+    void BM_EmSubroutineCaller(benchmark::State& state) {
+        setupMemory();
+        MappedStack stack;
+
+        DECLARE_SUBROUTINE_DECL(RETURN_DECL, PARAM_DECL);
+        static EmSubroutine sub;
+        sub.DescribeDecl(subDecl);
+
+        UInt16 libRefnum = 1;
+        NetSocketAddrEnum domain = netSocketAddrINET;
+        NetSocketTypeEnum type = netSocketTypeStream;
+        Int16 protocol = 0;
+        Int32 timeout = -1;
+
+        for (auto _ : state) {
+            sub.PrepareStack(stack.GetAddress());
+
+            CALLER_PUT_PARAM_VAL(UInt16, libRefnum);
+            CALLER_PUT_PARAM_VAL(NetSocketAddrEnum, domain);
+            CALLER_PUT_PARAM_VAL(NetSocketTypeEnum, type);
+            CALLER_PUT_PARAM_VAL(Int16, protocol);
+            CALLER_PUT_PARAM_VAL(Int32, timeout);
+        }
+    }
+}  // namespace
+
+BENCHMARK(BM_EmSubroutineDescribeDeclString);
+BENCHMARK(BM_EmSubroutineDescribeDeclConstexpr);
+BENCHMARK(BM_EmSubroutineCalledStdarg);
+BENCHMARK(BM_EmSubroutineCalled);
+BENCHMARK(BM_EmSubroutineCaller);
@@ -0,0 +1,105 @@
+#include "FrameConverter.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+
+#include "Frame.h"
+#include "Nibbler.h"
+
+namespace {
+    constexpr uint32 WIDTH = 320;
+    constexpr uint32 LINES = 320;
+
+    constexpr uint32 PALETTE_GRAYSCALE_16[] = {
+        0xffd2d2d2, 0xffc4c4c4, 0xffb6b6b6, 0xffa8a8a8, 0xff9a9a9a, 0xff8c8c8c,
+        0xff7e7e7e, 0xff707070, 0xff626262, 0xff545454, 0xff464646, 0xff383838,
+        0xff2a2a2a, 0xff1c1c1c, 0xff0e0e0e, 0xff000000};
+
+    constexpr uint16 MAPPING_2BPP = 0xfa50;
+
+    void setupFrame(Frame& frame, uint8 bpp) {
+        frame.bpp = bpp;
+        frame.lineWidth = WIDTH;
+        frame.lines = LINES;
+        frame.margin = 0;
+        // 24bpp frames are stored with 32 bits per pixel.
+        frame.bytesPerLine = WIDTH * (bpp == 24 ? 32 : bpp) / 8;
+        frame.firstDirtyLine = 0;
+        frame.lastDirtyLine = LINES - 1;
+        frame.firstDirtyColumn = 0;
+        frame.lastDirtyColumn = WIDTH - 1;
+
+        uint8* buffer = frame.GetBuffer();
+        for (size_t i = 0; i < frame.bytesPerLine * LINES; i++) buffer[i] = i * 0x9d + (i >> 7);
+    }
+
+    // This is the conversion that MainLoop::UpdateScreen used to perform.
+    template <int bpp>
+    void convertNibbler(Frame& frame, uint32* dest, const uint32* palette) {
+        Nibbler<bpp> nibbler;
+        uint8* buffer = frame.GetBuffer();
+
+        for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
+            nibbler.reset(buffer + y * frame.bytesPerLine, frame.margin);
+            uint32* line = dest + y * frame.lineWidth;
+
+            for (uint32 x = 0; x < frame.lineWidth; x++) *(line++) = palette[nibbler.nibble()];
+        }
+    }
+
+    template <int bpp>
+    void BM_FrameNibbler(benchmark::State& state) {
+        Frame frame(WIDTH * LINES * 4);
+        setupFrame(frame, bpp);
+
+        uint32 palette[16];
+        if constexpr (bpp == 1) {
+            palette[0] = PALETTE_GRAYSCALE_16[0];
+            palette[1] = PALETTE_GRAYSCALE_16[15];
+        } else if constexpr (bpp == 2) {
+            for (int i = 0; i < 4; i++)
+                palette[i] = PALETTE_GRAYSCALE_16[(MAPPING_2BPP >> (4 * i)) & 0x0f];
+        } else {
+            memcpy(palette, PALETTE_GRAYSCALE_16, sizeof(palette));
+        }
+
+        vector<uint32> dest(WIDTH * LINES);
+
+        for (auto _ : state) {
+            convertNibbler<bpp>(frame, dest.data(), palette);
+            benchmark::DoNotOptimize(dest.data());
+            benchmark::ClobberMemory();
+        }
+
+        state.SetItemsProcessed(state.iterations() * WIDTH * LINES);
+    }
+
+    template <int bpp>
+    void BM_FrameConverter(benchmark::State& state) {
+        Frame frame(WIDTH * LINES * 4);
+        setupFrame(frame, bpp);
+        frame.margin = state.range(0);
+
+        FrameConverter converter;
+        converter.SetPalette(PALETTE_GRAYSCALE_16);
+
+        vector<uint32> dest(WIDTH * LINES);
+
+        for (auto _ : state) {
+            converter.Convert(frame, dest.data(), WIDTH, MAPPING_2BPP);
+            benchmark::DoNotOptimize(dest.data());
+            benchmark::ClobberMemory();
+        }
+
+        state.SetItemsProcessed(state.iterations() * WIDTH * LINES);
+    }
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_FrameNibbler, 1);
+BENCHMARK_TEMPLATE(BM_FrameConverter, 1)->Arg(0)->Arg(3);
+BENCHMARK_TEMPLATE(BM_FrameNibbler, 2);
+BENCHMARK_TEMPLATE(BM_FrameConverter, 2)->Arg(0)->Arg(3);
+BENCHMARK_TEMPLATE(BM_FrameNibbler, 4);
+BENCHMARK_TEMPLATE(BM_FrameConverter, 4)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_FrameConverter, 24)->Arg(0);
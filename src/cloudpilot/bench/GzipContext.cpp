@@ -0,0 +1,67 @@
+#include "GzipContext.h"
+
+#include <benchmark/benchmark.h>
+
+#include "BootedSession.h"
+#include "EmSession.h"
+#include "GunzipContext.h"
+
+namespace {
+    // The RAM of a freshly booted Palm V is mostly empty heap with some
+    // initialized databases, which is typical for the images that are gzipped
+    // for download.
+    bool getRam(vector<uint8>& ram) {
+        if (!restoreBootedSession()) return false;
+
+        ram.assign(gSession->GetMemoryPtr(), gSession->GetMemoryPtr() + gSession->GetMemorySize());
+
+        return true;
+    }
+
+    bool gzip(const vector<uint8>& data, vector<uint8>& compressed) {
+        GzipContext context(data.data(), data.size());
+
+        while (context.Continue() == static_cast<int>(GzipContext::State::more)) {
+        }
+
+        if (context.GetState() != static_cast<int>(GzipContext::State::done)) return false;
+
+        compressed.assign(context.GetGzipData(), context.GetGzipData() + context.GetGzipSize());
+
+        return true;
+    }
+
+    void BM_GzipContext(benchmark::State& state) {
+        vector<uint8> ram, compressed;
+        if (!getRam(ram)) return state.SkipWithError("unable to boot session");
+
+        for (auto _ : state)
+            if (!gzip(ram, compressed)) return state.SkipWithError("gzip failed");
+
+        state.SetBytesProcessed(state.iterations() * ram.size());
+        state.counters["compressed"] = compressed.size();
+    }
+
+    void BM_GunzipContext(benchmark::State& state) {
+        vector<uint8> ram, compressed;
+        if (!getRam(ram) || !gzip(ram, compressed))
+            return state.SkipWithError("unable to prepare gzip data");
+
+        for (auto _ : state) {
+            GunzipContext context(compressed.data(), compressed.size());
+
+            while (context.Continue() == static_cast<int>(GunzipContext::State::more)) {
+            }
+
+            if (context.GetState() != static_cast<int>(GunzipContext::State::done))
+                return state.SkipWithError("gunzip failed");
+
+            benchmark::DoNotOptimize(context.GetUncompressedData());
+        }
+
+        state.SetBytesProcessed(state.iterations() * ram.size());
+    }
+}  // namespace
+
+BENCHMARK(BM_GzipContext)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GunzipContext)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,249 @@
+#include <arpa/inet.h>
+#include <benchmark/benchmark.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "ProxyClient.h"
+#include "networking.pb.h"
+#include "pb_decode.h"
+#include "pb_encode.h"
+
+namespace {
+    // The websocket backend needs a running proxy server. It is configured with
+    // CLOUDPILOT_BENCH_PROXY=host:port[/path] and skipped otherwise.
+    constexpr const char* PROXY_ENV = "CLOUDPILOT_BENCH_PROXY";
+
+    constexpr uint32 LOCALHOST = 0x7f000001;
+
+    struct Buffer {
+        const uint8* data;
+        size_t len;
+    };
+
+    bool encodeBufferCb(pb_ostream_t* stream, const pb_field_iter_t* field, void* const* arg) {
+        const Buffer* buffer = static_cast<const Buffer*>(*arg);
+
+        return pb_encode_tag_for_field(stream, field) &&
+               pb_encode_string(stream, buffer->data, buffer->len);
+    }
+
+    bool decodeBufferCb(pb_istream_t* stream, const pb_field_iter_t* field, void** arg) {
+        size_t* len = static_cast<size_t*>(*arg);
+
+        *len = stream->bytes_left;
+
+        return pb_read(stream, nullptr, stream->bytes_left);
+    }
+
+    bool payloadDecodeCb(pb_istream_t* stream, const pb_field_iter_t* field, void** arg) {
+        if (field->tag == MsgResponse_socketReceiveResponse_tag) {
+            MsgSocketReceiveResponse* response =
+                static_cast<MsgSocketReceiveResponse*>(field->pData);
+
+            response->data.arg = *arg;
+            response->data.funcs.decode = decodeBufferCb;
+        }
+
+        return true;
+    }
+
+    // A blocking TCP echo server on an ephemeral loopback port.
+    class EchoServer {
+       public:
+        EchoServer() {
+            listener = socket(AF_INET, SOCK_STREAM, 0);
+
+            sockaddr_in address;
+            socklen_t len = sizeof(address);
+
+            memset(&address, 0, sizeof(address));
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(LOCALHOST);
+
+            if (bind(listener, reinterpret_cast<sockaddr*>(&address), len) != 0 ||
+                listen(listener, 1) != 0 ||
+                getsockname(listener, reinterpret_cast<sockaddr*>(&address), &len) != 0)
+                return;
+
+            port = ntohs(address.sin_port);
+            t = thread([this]() { ThreadMain(); });
+        }
+
+        ~EchoServer() {
+            shutdown(listener, SHUT_RDWR);
+            if (connection >= 0) shutdown(connection, SHUT_RDWR);
+
+            if (t.joinable()) t.join();
+
+            close(listener);
+            if (connection >= 0) close(connection);
+        }
+
+        int32 GetPort() const { return port; }
+
+       private:
+        void ThreadMain() {
+            connection = accept(listener, nullptr, nullptr);
+            if (connection < 0) return;
+
+            uint8 buffer[65536];
+            ssize_t len;
+
+            while ((len = recv(connection, buffer, sizeof(buffer), 0)) > 0)
+                if (send(connection, buffer, len, 0) != len) break;
+        }
+
+       private:
+        int listener{-1};
+        atomic<int> connection{-1};
+        int32 port{0};
+
+        thread t;
+    };
+
+    class Session {
+       public:
+        Session(ProxyClient& client) : client(client) {}
+
+        bool Rpc(MsgRequest& request, MsgResponse& response) {
+            uint8 buffer[65536 + 128];
+            pb_ostream_t ostream = pb_ostream_from_buffer(buffer, sizeof(buffer));
+
+            request.id = ++id;
+            if (!pb_encode(&ostream, MsgRequest_fields, &request)) return false;
+
+            if (!client.Send(buffer, ostream.bytes_written)) return false;
+
+            auto [responseData, responseSize] = client.Receive();
+            if (!responseData) return false;
+
+            unique_ptr<uint8[]> responseOwner(responseData);
+
+            response = MsgResponse_init_zero;
+            response.cb_payload.funcs.decode = payloadDecodeCb;
+            response.cb_payload.arg = &received;
+
+            pb_istream_t istream = pb_istream_from_buffer(responseData, responseSize);
+
+            return pb_decode(&istream, MsgResponse_fields, &response) && response.id == id;
+        }
+
+        bool Open(int32 port) {
+            MsgRequest request = MsgRequest_init_zero;
+            MsgResponse response;
+
+            request.which_payload = MsgRequest_socketOpenRequest_tag;
+            request.payload.socketOpenRequest = {1, 0};
+
+            if (!Rpc(request, response) || response.payload.socketOpenResponse.err != 0)
+                return false;
+
+            handle = response.payload.socketOpenResponse.handle;
+
+            request = MsgRequest_init_zero;
+            request.which_payload = MsgRequest_socketConnectRequest_tag;
+            request.payload.socketConnectRequest = {handle, {LOCALHOST, port}, 1000};
+
+            return Rpc(request, response) && response.payload.socketConnectResponse.err == 0;
+        }
+
+        bool Echo(const vector<uint8>& payload) {
+            Buffer buffer{payload.data(), payload.size()};
+            MsgRequest request = MsgRequest_init_zero;
+            MsgResponse response;
+
+            request.which_payload = MsgRequest_socketSendRequest_tag;
+            request.payload.socketSendRequest.handle = handle;
+            request.payload.socketSendRequest.timeout = 1000;
+            request.payload.socketSendRequest.data.funcs.encode = encodeBufferCb;
+            request.payload.socketSendRequest.data.arg = &buffer;
+
+            if (!Rpc(request, response) || response.payload.socketSendResponse.err != 0)
+                return false;
+
+            for (size_t pending = payload.size(); pending > 0; pending -= received) {
+                request = MsgRequest_init_zero;
+                request.which_payload = MsgRequest_socketReceiveRequest_tag;
+                request.payload.socketReceiveRequest = {handle, 0, 1000,
+                                                        static_cast<uint32>(pending), false};
+
+                received = 0;
+
+                if (!Rpc(request, response) || response.payload.socketReceiveResponse.err != 0 ||
+                    received == 0)
+                    return false;
+            }
+
+            return true;
+        }
+
+       private:
+        ProxyClient& client;
+
+        uint32 id{0};
+        int32 handle{0};
+        size_t received{0};
+    };
+
+    ProxyClient* createWebsocketClient() {
+        const char* proxy = getenv(PROXY_ENV);
+        if (!proxy) return nullptr;
+
+        string spec(proxy);
+        string path;
+
+        if (size_t slash = spec.find('/'); slash != string::npos) {
+            path = spec.substr(slash);
+            spec = spec.substr(0, slash);
+        }
+
+        size_t colon = spec.find(':');
+        if (colon == string::npos) return nullptr;
+
+        return ProxyClient::Create(spec.substr(0, colon), atol(spec.c_str() + colon + 1), path);
+    }
+
+    // Round trips of a send RPC and the receive RPCs that pick up the echo.
+    void BM_NetworkProxyEcho(benchmark::State& state, bool native) {
+        unique_ptr<ProxyClient> client(native ? ProxyClient::CreateNative()
+                                              : createWebsocketClient());
+
+        if (!client) return state.SkipWithError("websocket proxy not configured");
+
+        if (!client->Connect()) return state.SkipWithError("unable to connect to proxy");
+
+        EchoServer server;
+        if (server.GetPort() == 0) return state.SkipWithError("unable to start echo server");
+
+        Session session(*client);
+        if (!session.Open(server.GetPort())) return state.SkipWithError("unable to connect");
+
+        vector<uint8> payload(state.range(0), 0x55);
+
+        for (auto _ : state)
+            if (!session.Echo(payload)) return state.SkipWithError("echo failed");
+
+        client->Disconnect();
+
+        state.SetBytesProcessed(state.iterations() * payload.size());
+    }
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_NetworkProxyEcho, native, true)
+    ->Arg(64)
+    ->Arg(4096)
+    ->Arg(65536)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_NetworkProxyEcho, websocket, false)
+    ->Arg(64)
+    ->Arg(4096)
+    ->Arg(65536)
+    ->UseRealTime();
@@ -0,0 +1,38 @@
+#include "Savestate.h"
+
+#include <benchmark/benchmark.h>
+
+#include "BootedSession.h"
+#include "EmSession.h"
+
+namespace {
+    void BM_SavestateSave(benchmark::State& state) {
+        if (!restoreBootedSession()) return state.SkipWithError("unable to boot session");
+
+        for (auto _ : state) {
+            if (!gSession->Save()) return state.SkipWithError("save failed");
+
+            benchmark::DoNotOptimize(gSession->GetSavestate().GetBuffer());
+        }
+
+        state.SetBytesProcessed(state.iterations() * gSession->GetSavestate().GetSize());
+    }
+
+    void BM_SavestateLoad(benchmark::State& state) {
+        if (!restoreBootedSession()) return state.SkipWithError("unable to boot session");
+        if (!gSession->Save()) return state.SkipWithError("save failed");
+
+        Savestate& savestate = gSession->GetSavestate();
+        uint8* buffer = static_cast<uint8*>(savestate.GetBuffer());
+        vector<uint8> saved(buffer, buffer + savestate.GetSize());
+
+        for (auto _ : state)
+            if (!gSession->Load(saved.size(), saved.data()))
+                return state.SkipWithError("load failed");
+
+        state.SetBytesProcessed(state.iterations() * saved.size());
+    }
+}  // namespace
+
+BENCHMARK(BM_SavestateSave)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SavestateLoad)->Unit(benchmark::kMicrosecond);
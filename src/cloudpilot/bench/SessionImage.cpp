@@ -0,0 +1,165 @@
+#include "SessionImage.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "miniz.h"
+
+namespace {
+    // Relative to src/cloudpilot. Can be overridden with CLOUDPILOT_BENCH_IMAGES.
+    constexpr const char* IMAGE_DIR = "../../web/embedded/public";
+
+    struct Image {
+        vector<uint8> serialized;
+
+        vector<uint8> rom, ram, savestate, metadata;
+        string deviceId;
+    };
+
+    vector<uint8> copyOf(void* data, size_t size) {
+        const uint8* bytes = static_cast<const uint8*>(data);
+
+        return vector<uint8>(bytes, bytes + size);
+    }
+
+    bool loadImage(const string& name, Image& image) {
+        const char* imageDir = getenv("CLOUDPILOT_BENCH_IMAGES");
+        ifstream stream(string(imageDir ? imageDir : IMAGE_DIR) + "/" + name, ios::binary);
+        if (stream.fail()) return false;
+
+        image.serialized.assign(istreambuf_iterator<char>(stream), istreambuf_iterator<char>());
+
+        SessionImage sessionImage;
+        if (!sessionImage.Deserialize(image.serialized.data(), image.serialized.size()))
+            return false;
+
+        image.rom = copyOf(sessionImage.GetRomImage(), sessionImage.GetRomImageSize());
+        image.ram = copyOf(sessionImage.GetMemoryImage(), sessionImage.GetMemoryImageSize());
+        image.savestate = copyOf(sessionImage.GetSavestate(), sessionImage.GetSavestateSize());
+        image.metadata = copyOf(sessionImage.GetMetadata(), sessionImage.GetMetadataSize());
+        image.deviceId = sessionImage.GetDeviceId();
+
+        return true;
+    }
+
+    void setupSessionImage(SessionImage& sessionImage, Image& image) {
+        sessionImage.SetDeviceId(image.deviceId)
+            .SetRomImage(image.rom.data(), image.rom.size())
+            .SetMemoryImage(image.ram.data(), image.ram.size())
+            .SetSavestate(image.savestate.data(), image.savestate.size())
+            .SetMetadata(image.metadata.data(), image.metadata.size());
+    }
+
+    size_t payloadSize(const Image& image) {
+        return image.rom.size() + image.ram.size() + image.savestate.size() +
+               image.metadata.size();
+    }
+
+    // The single stream layout that SessionImage used to write (version 4).
+    void BM_SessionImageSerializeSingleStream(benchmark::State& state, const char* name) {
+        Image image;
+        if (!loadImage(name, image)) return state.SkipWithError("unable to load image");
+
+        const size_t uncompressedSize = 20 + image.deviceId.size() + payloadSize(image);
+        mz_ulong compressedSize = 0;
+
+        for (auto _ : state) {
+            vector<uint8> payload(uncompressedSize);
+            uint8* next = payload.data() + 20;
+
+            for (auto section : {copyOf(image.deviceId.data(), image.deviceId.size()),
+                                 image.metadata, image.rom, image.ram, image.savestate}) {
+                memcpy(next, section.data(), section.size());
+                next += section.size();
+            }
+
+            compressedSize = compressBound(uncompressedSize);
+            unique_ptr<uint8[]> compressed = make_unique<uint8[]>(compressedSize);
+
+            compress2(compressed.get(), &compressedSize, payload.data(), uncompressedSize,
+                      MZ_DEFAULT_COMPRESSION);
+            benchmark::DoNotOptimize(compressed.get());
+        }
+
+        state.SetBytesProcessed(state.iterations() * payloadSize(image));
+        state.counters["compressed"] = compressedSize;
+    }
+
+    void BM_SessionImageSerialize(benchmark::State& state, const char* name) {
+        Image image;
+        if (!loadImage(name, image)) return state.SkipWithError("unable to load image");
+
+        SessionImage sessionImage;
+        setupSessionImage(sessionImage, image);
+        sessionImage.SetCompressionLevel(state.range(0));
+
+        for (auto _ : state) {
+            if (!sessionImage.Serialize()) return state.SkipWithError("serialization failed");
+
+            benchmark::DoNotOptimize(sessionImage.GetSerializedImage());
+        }
+
+        state.SetBytesProcessed(state.iterations() * payloadSize(image));
+        state.counters["compressed"] = sessionImage.GetSerializedImageSize();
+    }
+
+    // Deserializes the image as shipped (single stream) if arg is 0, or after
+    // converting it to the chunked format.
+    void BM_SessionImageDeserialize(benchmark::State& state, const char* name) {
+        Image image;
+        if (!loadImage(name, image)) return state.SkipWithError("unable to load image");
+
+        vector<uint8> serialized = image.serialized;
+
+        if (state.range(0) > 0) {
+            SessionImage sessionImage;
+            setupSessionImage(sessionImage, image);
+
+            if (!sessionImage.Serialize()) return state.SkipWithError("serialization failed");
+
+            serialized = copyOf(sessionImage.GetSerializedImage(),
+                                sessionImage.GetSerializedImageSize());
+        }
+
+        for (auto _ : state) {
+            SessionImage sessionImage;
+
+            if (!sessionImage.Deserialize(serialized.data(), serialized.size()))
+                return state.SkipWithError("deserialization failed");
+
+            benchmark::DoNotOptimize(sessionImage.GetMemoryImage());
+        }
+
+        state.SetBytesProcessed(state.iterations() * payloadSize(image));
+    }
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_SessionImageSerializeSingleStream, m515, "m515.img")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SessionImageSerialize, m515, "m515.img")
+    ->Arg(SessionImage::COMPRESSION_LEVEL_FAST)
+    ->Arg(MZ_DEFAULT_LEVEL)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_SessionImageDeserialize, m515, "m515.img")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_CAPTURE(BM_SessionImageSerializeSingleStream, palmv, "session.img")
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SessionImageSerialize, palmv, "session.img")
+    ->Arg(SessionImage::COMPRESSION_LEVEL_FAST)
+    ->Arg(MZ_DEFAULT_LEVEL)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_SessionImageDeserialize, palmv, "session.img")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
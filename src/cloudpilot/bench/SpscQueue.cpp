@@ -0,0 +1,70 @@
+#include "SpscQueue.h"
+
+#include <benchmark/benchmark.h>
+
+#include <thread>
+
+#include "EmThreadSafeQueue.h"
+#include "KeyboardEvent.h"
+
+namespace {
+    constexpr int QUEUE_SIZE = 20;
+    constexpr uint32 BATCH_SIZE = 1 << 16;
+
+    // A producer thread pushes a batch of events while the benchmark thread
+    // consumes them, polling GetUsed like the emulator does on its hot path.
+    template <typename Queue>
+    void BM_QueueContended(benchmark::State& state) {
+        Queue queue(QUEUE_SIZE);
+        uint32 sum = 0;
+
+        for (auto _ : state) {
+            thread producer([&]() {
+                for (uint32 i = 0; i < BATCH_SIZE; i++) {
+                    while (queue.GetFree() == 0) this_thread::yield();
+
+                    queue.Put(KeyboardEvent(i));
+                }
+            });
+
+            for (uint32 i = 0; i < BATCH_SIZE; i++) {
+                while (queue.GetUsed() == 0) this_thread::yield();
+
+                sum += queue.Get().GetKey();
+            }
+
+            producer.join();
+        }
+
+        benchmark::DoNotOptimize(sum);
+        state.SetItemsProcessed(state.iterations() * BATCH_SIZE);
+    }
+
+    // The common case: the emulator polls an empty queue.
+    template <typename Queue>
+    void BM_QueuePollEmpty(benchmark::State& state) {
+        Queue queue(QUEUE_SIZE);
+
+        for (auto _ : state) benchmark::DoNotOptimize(queue.GetUsed());
+    }
+
+    template <typename Queue>
+    void BM_QueuePutGet(benchmark::State& state) {
+        Queue queue(QUEUE_SIZE);
+        uint32 sum = 0;
+
+        for (auto _ : state) {
+            queue.Put(KeyboardEvent(sum));
+            sum += queue.Get().GetKey() + 1;
+        }
+
+        benchmark::DoNotOptimize(sum);
+    }
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_QueueContended, EmThreadSafeQueue<KeyboardEvent>)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_QueueContended, SpscQueue<KeyboardEvent>)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_QueuePollEmpty, EmThreadSafeQueue<KeyboardEvent>);
+BENCHMARK_TEMPLATE(BM_QueuePollEmpty, SpscQueue<KeyboardEvent>);
+BENCHMARK_TEMPLATE(BM_QueuePutGet, EmThreadSafeQueue<KeyboardEvent>);
+BENCHMARK_TEMPLATE(BM_QueuePutGet, SpscQueue<KeyboardEvent>);
@@ -0,0 +1,15 @@
+#include <benchmark/benchmark.h>
+
+#include "Logging.h"
+
+int main(int argc, char** argv) {
+    logging::disable();
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include "AddressSet.h"
+
+#include <algorithm>  // find
+
+void AddressSet::Add(emuptr address, uint32 size) {
+    if (size == 0) return;
+
+    const uint64 end = static_cast<uint64>(address) + size;
+
+    if (size > MAX_POINT_SPAN)
+        ranges.push_back({address, end});
+    else
+        for (uint64 a = address; a < end; a++) addresses.insert(a);
+
+    MarkPages(address, end);
+}
+
+void AddressSet::Remove(emuptr address, uint32 size) {
+    if (size == 0) return;
+
+    const uint64 end = static_cast<uint64>(address) + size;
+
+    if (size > MAX_POINT_SPAN) {
+        auto range = find(ranges.begin(), ranges.end(), make_pair(address, end));
+        if (range == ranges.end()) return;
+
+        ranges.erase(range);
+    } else
+        for (uint64 a = address; a < end; a++) addresses.erase(a);
+
+    UpdatePages(address, end);
+}
+
+void AddressSet::Clear() {
+    addresses.clear();
+    ranges.clear();
+    pages.clear();
+}
+
+bool AddressSet::IsEmpty() const { return addresses.empty() && ranges.empty(); }
+
+void AddressSet::MarkPages(emuptr start, uint64 end) {
+    const uint32 lastPage = (end - 1) >> PAGE_SHIFT;
+
+    if ((lastPage >> 6) >= pages.size()) pages.resize((lastPage >> 6) + 1, 0);
+
+    for (uint32 page = start >> PAGE_SHIFT; page <= lastPage; page++)
+        pages[page >> 6] |= 1ull << (page & 63);
+}
+
+void AddressSet::UpdatePages(emuptr start, uint64 end) {
+    const uint32 lastPage = (end - 1) >> PAGE_SHIFT;
+
+    for (uint32 page = start >> PAGE_SHIFT; page <= lastPage; page++)
+        if (!PageInUse(page)) pages[page >> 6] &= ~(1ull << (page & 63));
+}
+
+bool AddressSet::Lookup(emuptr address, uint32 size) const {
+    const uint64 end = static_cast<uint64>(address) + size;
+
+    for (uint64 a = address; a < end; a++)
+        if (addresses.find(a) != addresses.end()) return true;
+
+    for (const auto& range : ranges)
+        if (range.first < end && address < range.second) return true;
+
+    return false;
+}
+
+bool AddressSet::PageInUse(uint32 page) const {
+    const emuptr start = page << PAGE_SHIFT;
+
+    // Probing every byte of the page is cheaper than walking a large set.
+    if (addresses.size() > PAGE_SIZE) return Lookup(start, PAGE_SIZE);
+
+    for (emuptr address : addresses)
+        if ((address >> PAGE_SHIFT) == page) return true;
+
+    const uint64 end = static_cast<uint64>(start) + PAGE_SIZE;
+
+    for (const auto& range : ranges)
+        if (range.first < end && start < range.second) return true;
+
+    return false;
+}
@@ -0,0 +1,73 @@
+#ifndef _ADDRESS_SET_H_
+#define _ADDRESS_SET_H_
+
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "EmCommon.h"
+
+// A set of emulated addresses for breakpoints and watchpoints. Short spans are
+// stored byte by byte, longer spans (a whole heap, say) as a single range. A
+// bitmap with one bit per page of PAGE_SIZE bytes sits in front of both, so
+// checking an address that lies on an unmarked page is a single bit test.
+
+class AddressSet {
+   public:
+    static constexpr uint32 PAGE_SHIFT = 8;
+    static constexpr uint32 PAGE_SIZE = 1 << PAGE_SHIFT;
+
+    // Spans longer than this are stored as a range.
+    static constexpr uint32 MAX_POINT_SPAN = 16;
+
+   public:
+    AddressSet() = default;
+
+    // Spans are removed with the same address and size they were added with.
+    void Add(emuptr address, uint32 size = 1);
+    void Remove(emuptr address, uint32 size = 1);
+    void Clear();
+
+    bool IsEmpty() const;
+
+    // Does any byte in [address, address + size) belong to the set? Size must
+    // not exceed PAGE_SIZE.
+    bool Contains(emuptr address, uint32 size = 1) const;
+
+   private:
+    bool IsPageMarked(emuptr address) const;
+    void MarkPages(emuptr start, uint64 end);
+    void UpdatePages(emuptr start, uint64 end);
+
+    bool Lookup(emuptr address, uint32 size) const;
+    bool PageInUse(uint32 page) const;
+
+   private:
+    unordered_set<emuptr> addresses;
+    vector<pair<emuptr, uint64>> ranges;
+
+    vector<uint64> pages;
+
+   private:
+    AddressSet(const AddressSet&) = delete;
+    AddressSet(AddressSet&&) = delete;
+    AddressSet& operator=(const AddressSet&) = delete;
+    AddressSet& operator=(AddressSet&&) = delete;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// IMPLEMENTATION
+///////////////////////////////////////////////////////////////////////////////
+
+inline bool AddressSet::Contains(emuptr address, uint32 size) const {
+    // A span no longer than a page touches at most two of them.
+    return (IsPageMarked(address) || IsPageMarked(address + size - 1)) && Lookup(address, size);
+}
+
+inline bool AddressSet::IsPageMarked(emuptr address) const {
+    const uint32 page = address >> PAGE_SHIFT;
+
+    return (page >> 6) < pages.size() && (pages[page >> 6] & (1ull << (page & 63)));
+}
+
+#endif  // _ADDRESS_SET_H_
@@ -5,6 +5,7 @@
 #include "EmBankMapped.h"
 #include "EmCPU68K.h"
 #include "EmCommon.h"
+#include "EmSessionContext.h"
 #include "MetaMemory.h"
 
 namespace {
@@ -16,7 +17,9 @@ namespace {
         uint16* stub;
     };
 
-    map<emuptr, RegisteredCallback> registeredCallbacks;
+    thread_local map<emuptr, RegisteredCallback> registeredCallbacks;
+
+    const EmSessionState sessionState{EM_SESSION_VARIABLE(registeredCallbacks)};
 }  // namespace
 
 void CallbackManager::Clear() {
@@ -16,7 +16,7 @@ bool DbBackupNative::Init(bool includeRomDatabases) {
         return false;
     }
 
-    if (gSystemState.OSMajorVersion() < 3) return false;
+    if (gSystemState->OSMajorVersion() < 3) return false;
 
     return DbBackup::Init(includeRomDatabases);
 }
@@ -7,6 +7,7 @@
 #include "EmHAL.h"
 #include "EmMemory.h"
 #include "EmSession.h"
+#include "EmSessionContext.h"
 #include "Miscellaneous.h"
 #include "UAE.h"
 
@@ -15,10 +16,15 @@ namespace {
     bool setContains(const T& set, K key) {
         return set.find(key) != set.end();
     }
+
+    thread_local Debugger debugger;
 }  // namespace
 
-Debugger gDebugger;
-void* gDebuggerPtr = &gDebugger;
+thread_local Debugger* gDebugger{&debugger};
+
+namespace {
+    const EmSessionState sessionState{EM_SESSION_OBJECT(gDebugger)};
+}  // namespace
 
 Debugger::BreakState Debugger::GetBreakState() const { return breakState; }
 
@@ -26,15 +32,19 @@ bool Debugger::IsStopped() const { return breakState != BreakState::none; }
 
 bool Debugger::IsStepping() const { return stepping; }
 
+bool Debugger::IsEnabled() const { return enabled; }
+
 void Debugger::Reset() {
     breakState = BreakState::none;
     stepping = false;
     lastBreakAtPc = 0xffffffff;
     enabled = false;
 
-    breakpoints.clear();
-    watchpointsRead.clear();
-    watchpointsWrite.clear();
+    breakpoints.Clear();
+    watchpointsRead.Clear();
+    watchpointsWrite.Clear();
+
+    UpdateMemoryHooks();
 }
 
 void Debugger::Enable() {
@@ -42,6 +52,8 @@ void Debugger::Enable() {
 
     romStart = EmHAL::GetROMBaseAddress();
     romSize = EmHAL::GetROMSize();
+
+    UpdateMemoryHooks();
 }
 
 void Debugger::ResetBreakMode() { breakMode = BreakMode::all; }
@@ -64,14 +76,14 @@ emuptr Debugger::GetAppStart() const { return appStart; }
 uint32 Debugger::GetAppSize() const { return appSize; }
 
 void Debugger::NotificyPc(emuptr pc) {
-    if (!enabled) return;
+    if (!enabled || (!stepping && !breakpoints.Contains(pc))) return;
     if (breakMode == BreakMode::appOnly && (pc < appStart || pc >= appStart + appSize)) return;
     if (breakMode == BreakMode::ramOnly && pc >= romStart && pc < romStart + romSize) return;
 
     EmAssert(gSession);
     if (gSession->IsNested() || breakState != BreakState::none) return;
 
-    if (setContains(breakpoints, pc))
+    if (breakpoints.Contains(pc))
         Break(BreakState::breakpoint);
     else if (stepping && pc != lastBreakAtPc)
         Break(BreakState::step);
@@ -80,7 +92,7 @@ void Debugger::NotificyPc(emuptr pc) {
 void Debugger::NotifyMemoryRead8(emuptr address) {
     if (!enabled || memoryAccess) return;
 
-    if (setContains(watchpointsRead, address)) {
+    if (watchpointsRead.Contains(address)) {
         Break(BreakState::trapRead);
 
         watchpointAddress = address;
@@ -90,7 +102,7 @@ void Debugger::NotifyMemoryRead8(emuptr address) {
 void Debugger::NotifyMemoryRead16(emuptr address) {
     if (!enabled || memoryAccess) return;
 
-    if (setContains(watchpointsRead, address) || setContains(watchpointsRead, address + 1)) {
+    if (watchpointsRead.Contains(address, 2)) {
         Break(BreakState::trapRead);
 
         watchpointAddress = address;
@@ -100,8 +112,7 @@ void Debugger::NotifyMemoryRead16(emuptr address) {
 void Debugger::NotifyMemoryRead32(emuptr address) {
     if (!enabled || memoryAccess) return;
 
-    if (setContains(watchpointsRead, address) || setContains(watchpointsRead, address + 1) ||
-        setContains(watchpointsRead, address + 2) || setContains(watchpointsRead, address + 3)) {
+    if (watchpointsRead.Contains(address, 4)) {
         Break(BreakState::trapRead);
 
         watchpointAddress = address;
@@ -111,7 +122,7 @@ void Debugger::NotifyMemoryRead32(emuptr address) {
 void Debugger::NotifyMemoryWrite8(emuptr address) {
     if (!enabled || memoryAccess) return;
 
-    if (setContains(watchpointsWrite, address)) {
+    if (watchpointsWrite.Contains(address)) {
         Break(BreakState::trapWrite);
 
         watchpointAddress = address;
@@ -121,7 +132,7 @@ void Debugger::NotifyMemoryWrite8(emuptr address) {
 void Debugger::NotifyMemoryWrite16(emuptr address) {
     if (!enabled || memoryAccess) return;
 
-    if (setContains(watchpointsWrite, address) || setContains(watchpointsWrite, address + 1)) {
+    if (watchpointsWrite.Contains(address, 2)) {
         Break(BreakState::trapWrite);
 
         watchpointAddress = address;
@@ -131,8 +142,7 @@ void Debugger::NotifyMemoryWrite16(emuptr address) {
 void Debugger::NotifyMemoryWrite32(emuptr address) {
     if (!enabled || memoryAccess) return;
 
-    if (setContains(watchpointsWrite, address) || setContains(watchpointsWrite, address + 1) ||
-        setContains(watchpointsWrite, address + 2) || setContains(watchpointsWrite, address + 3)) {
+    if (watchpointsWrite.Contains(address, 4)) {
         Break(BreakState::trapWrite);
 
         watchpointAddress = address;
@@ -148,46 +158,46 @@ void Debugger::NotifyTrap(uint16 trapWord) {
     }
 }
 
-void Debugger::SetBreakpoint(emuptr pc) { breakpoints.insert(pc); }
+void Debugger::SetBreakpoint(emuptr pc) { breakpoints.Add(pc); }
 
-void Debugger::ClearBreakpoint(emuptr pc) { breakpoints.erase(pc); }
+void Debugger::ClearBreakpoint(emuptr pc) { breakpoints.Remove(pc); }
 
 void Debugger::SetWatchpoint(emuptr address, WatchpointType type, size_t len) {
-    for (size_t i = 0; i < len; i++) {
-        switch (type) {
-            case WatchpointType::read:
-                watchpointsRead.insert(address + i);
-                break;
-
-            case WatchpointType::write:
-                watchpointsWrite.insert(address + i);
-                break;
-
-            case WatchpointType::readwrite:
-                watchpointsRead.insert(address + i);
-                watchpointsWrite.insert(address + i);
-                break;
-        }
+    switch (type) {
+        case WatchpointType::read:
+            watchpointsRead.Add(address, len);
+            break;
+
+        case WatchpointType::write:
+            watchpointsWrite.Add(address, len);
+            break;
+
+        case WatchpointType::readwrite:
+            watchpointsRead.Add(address, len);
+            watchpointsWrite.Add(address, len);
+            break;
     }
+
+    UpdateMemoryHooks();
 }
 
 void Debugger::ClearWatchpoint(emuptr address, WatchpointType type, size_t len) {
-    for (size_t i = 0; i < len; i++) {
-        switch (type) {
-            case WatchpointType::read:
-                watchpointsRead.erase(address + i);
-                break;
-
-            case WatchpointType::write:
-                watchpointsWrite.erase(address + i);
-                break;
-
-            case WatchpointType::readwrite:
-                watchpointsRead.erase(address + i);
-                watchpointsWrite.erase(address + i);
-                break;
-        }
+    switch (type) {
+        case WatchpointType::read:
+            watchpointsRead.Remove(address, len);
+            break;
+
+        case WatchpointType::write:
+            watchpointsWrite.Remove(address, len);
+            break;
+
+        case WatchpointType::readwrite:
+            watchpointsRead.Remove(address, len);
+            watchpointsWrite.Remove(address, len);
+            break;
     }
+
+    UpdateMemoryHooks();
 }
 
 void Debugger::SetSyscallTrap(uint16 trapWord) { syscallTraps.insert(trapWord); }
@@ -199,9 +209,9 @@ void Debugger::ClearAllSyscallTraps() { syscallTraps.clear(); }
 const std::unordered_set<uint16> Debugger::GetSyscallTraps() const { return syscallTraps; }
 
 Debugger::WatchpointType Debugger::GetWatchpointType() const {
-    if (setContains(watchpointsRead, watchpointAddress))
-        return setContains(watchpointsWrite, watchpointAddress) ? WatchpointType::readwrite
-                                                                : WatchpointType::read;
+    if (watchpointsRead.Contains(watchpointAddress))
+        return watchpointsWrite.Contains(watchpointAddress) ? WatchpointType::readwrite
+                                                            : WatchpointType::read;
 
     return WatchpointType::write;
 }
@@ -306,26 +316,33 @@ void Debugger::Break(BreakState state) {
     }
 }
 
+void Debugger::UpdateMemoryHooks() {
+#ifdef ENABLE_DEBUGGER
+    Memory::SetInstrumented(enabled &&
+                            (!watchpointsRead.IsEmpty() || !watchpointsWrite.IsEmpty()));
+#endif
+}
+
 void DbgNotifyRead8(emuptr address) {
-    reinterpret_cast<Debugger*>(gDebuggerPtr)->NotifyMemoryRead8(address);
+    gDebugger->NotifyMemoryRead8(address);
 }
 
 void DbgNotifyRead16(emuptr address) {
-    reinterpret_cast<Debugger*>(gDebuggerPtr)->NotifyMemoryRead16(address);
+    gDebugger->NotifyMemoryRead16(address);
 }
 
 void DbgNotifyRead32(emuptr address) {
-    reinterpret_cast<Debugger*>(gDebuggerPtr)->NotifyMemoryRead32(address);
+    gDebugger->NotifyMemoryRead32(address);
 }
 
 void DbgNotifyWrite8(emuptr address) {
-    reinterpret_cast<Debugger*>(gDebuggerPtr)->NotifyMemoryWrite8(address);
+    gDebugger->NotifyMemoryWrite8(address);
 }
 
 void DbgNotifyWrite16(emuptr address) {
-    reinterpret_cast<Debugger*>(gDebuggerPtr)->NotifyMemoryWrite16(address);
+    gDebugger->NotifyMemoryWrite16(address);
 }
 
 void DbgNotifyWrite32(emuptr address) {
-    reinterpret_cast<Debugger*>(gDebuggerPtr)->NotifyMemoryWrite32(address);
+    gDebugger->NotifyMemoryWrite32(address);
 }
@@ -4,6 +4,7 @@
 #include <array>
 #include <unordered_set>
 
+#include "AddressSet.h"
 #include "EmCommon.h"
 
 class Debugger {
@@ -31,6 +32,10 @@ class Debugger {
     bool IsStopped() const;
     bool IsStepping() const;
 
+    // The CPU runs the instrumented variant of its main loop only while this
+    // is true, i.e. while a debugger is attached.
+    bool IsEnabled() const;
+
     void Reset();
     void Enable();
 
@@ -60,6 +65,8 @@ class Debugger {
     void SetBreakpoint(emuptr pc);
     void ClearBreakpoint(emuptr pc);
 
+    // Watchpoints longer than AddressSet::MAX_POINT_SPAN are kept as a single
+    // range, so watching a large region is cheap.
     void SetWatchpoint(emuptr address, WatchpointType type, size_t len);
     void ClearWatchpoint(emuptr address, WatchpointType type, size_t len);
 
@@ -90,6 +97,7 @@ class Debugger {
 
    private:
     void Break(BreakState state);
+    void UpdateMemoryHooks();
 
    private:
     bool enabled{false};
@@ -102,9 +110,9 @@ class Debugger {
 
     bool memoryAccess{false};
 
-    unordered_set<emuptr> breakpoints;
-    unordered_set<emuptr> watchpointsRead;
-    unordered_set<emuptr> watchpointsWrite;
+    AddressSet breakpoints;
+    AddressSet watchpointsRead;
+    AddressSet watchpointsWrite;
     unordered_set<uint16> syscallTraps;
 
     emuptr watchpointAddress;
@@ -123,6 +131,6 @@ class Debugger {
     Debugger& operator=(Debugger&&) = delete;
 };
 
-extern Debugger gDebugger;
+extern thread_local Debugger* gDebugger;
 
 #endif  // _DEBUGGER_H_
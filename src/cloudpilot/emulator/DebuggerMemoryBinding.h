@@ -7,7 +7,8 @@
 extern "C" {
 #endif
 
-extern void* gDebuggerPtr;
+// Called by the instrumented memory banks that are installed while the
+// debugger has watchpoints (see Memory::SetInstrumented).
 
 void DbgNotifyRead8(emuptr address);
 void DbgNotifyRead16(emuptr address);
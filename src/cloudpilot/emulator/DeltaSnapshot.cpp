@@ -0,0 +1,265 @@
+#include "DeltaSnapshot.h"
+
+#include <random>
+
+#include "EmMemory.h"
+
+namespace {
+    constexpr uint32 MAGIC = 0x44504e53;
+    constexpr uint32 VERSION = 1;
+    constexpr size_t HEADER_SIZE = 32;
+
+    void put32(uint8* buffer, uint32 value) {
+        buffer[0] = value & 0xff;
+        buffer[1] = (value >> 8) & 0xff;
+        buffer[2] = (value >> 16) & 0xff;
+        buffer[3] = (value >> 24) & 0xff;
+    }
+
+    uint32 get32(const uint8* buffer) {
+        return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | (buffer[3] << 24);
+    }
+
+    uint32 newChainId() {
+        random_device random;
+
+        return random();
+    }
+}  // namespace
+
+DeltaSnapshot::DeltaSnapshot(Kind kind, uint32 chainId, uint32 sequence, uint32 memorySize)
+    : kind(kind), chainId(chainId), sequence(sequence), memorySize(memorySize) {}
+
+DeltaSnapshot::Kind DeltaSnapshot::GetKind() const { return kind; }
+
+uint32 DeltaSnapshot::GetChainId() const { return chainId; }
+
+uint32 DeltaSnapshot::GetSequence() const { return sequence; }
+
+uint32 DeltaSnapshot::GetMemorySize() const { return memorySize; }
+
+size_t DeltaSnapshot::GetPageCount() const { return pageIndices.size(); }
+
+uint32 DeltaSnapshot::GetPageIndex(size_t i) const { return pageIndices[i]; }
+
+const uint8* DeltaSnapshot::GetPageData(size_t i) const { return pageData.data() + i * PAGE_SIZE; }
+
+bool DeltaSnapshot::AddPage(uint32 index, const uint8* data) {
+    if (index >= memorySize / PAGE_SIZE) return false;
+    if (!pageIndices.empty() && index <= pageIndices.back()) return false;
+
+    pageIndices.push_back(index);
+    pageData.insert(pageData.end(), data, data + PAGE_SIZE);
+
+    return true;
+}
+
+const void* DeltaSnapshot::GetSavestate() const { return savestate.data(); }
+
+size_t DeltaSnapshot::GetSavestateSize() const { return savestate.size(); }
+
+void DeltaSnapshot::SetSavestate(const void* savestate, size_t size) {
+    const uint8* buffer = static_cast<const uint8*>(savestate);
+
+    this->savestate.assign(buffer, buffer + size);
+}
+
+bool DeltaSnapshot::Apply(uint8* memory, uint32 memorySize, uint8* dirtyPages) const {
+    if (memorySize != this->memorySize) return false;
+
+    for (size_t i = 0; i < pageIndices.size(); i++) {
+        const uint32 index = pageIndices[i];
+
+        memcpy(memory + index * PAGE_SIZE, GetPageData(i), PAGE_SIZE);
+        if (dirtyPages) dirtyPages[index >> 3] |= (1 << (index & 0x07));
+    }
+
+    return true;
+}
+
+bool DeltaSnapshot::Compact(const DeltaSnapshot& next) {
+    if (next.kind != Kind::delta || next.chainId != chainId || next.memorySize != memorySize ||
+        next.sequence != sequence + 1)
+        return false;
+
+    vector<uint32> mergedIndices;
+    vector<uint8> mergedData;
+
+    mergedIndices.reserve(pageIndices.size() + next.pageIndices.size());
+    mergedData.reserve(pageData.size() + next.pageData.size());
+
+    size_t i = 0, j = 0;
+
+    while (i < pageIndices.size() || j < next.pageIndices.size()) {
+        const bool takeNext = j < next.pageIndices.size() &&
+                              (i == pageIndices.size() || next.pageIndices[j] <= pageIndices[i]);
+
+        if (takeNext) {
+            if (i < pageIndices.size() && pageIndices[i] == next.pageIndices[j]) i++;
+
+            mergedIndices.push_back(next.pageIndices[j]);
+            mergedData.insert(mergedData.end(), next.GetPageData(j),
+                              next.GetPageData(j) + PAGE_SIZE);
+
+            j++;
+        } else {
+            mergedIndices.push_back(pageIndices[i]);
+            mergedData.insert(mergedData.end(), GetPageData(i), GetPageData(i) + PAGE_SIZE);
+
+            i++;
+        }
+    }
+
+    pageIndices = move(mergedIndices);
+    pageData = move(mergedData);
+    savestate = next.savestate;
+    sequence = next.sequence;
+
+    return true;
+}
+
+bool DeltaSnapshot::Serialize() {
+    serializedImageSize =
+        HEADER_SIZE + savestate.size() + pageIndices.size() * 4 + pageData.size();
+    serializedImage = make_unique<uint8[]>(serializedImageSize);
+
+    uint8* buffer = serializedImage.get();
+
+    put32(buffer, MAGIC);
+    put32(buffer + 4, VERSION);
+    put32(buffer + 8, static_cast<uint32>(kind));
+    put32(buffer + 12, chainId);
+    put32(buffer + 16, sequence);
+    put32(buffer + 20, memorySize);
+    put32(buffer + 24, savestate.size());
+    put32(buffer + 28, pageIndices.size());
+    buffer += HEADER_SIZE;
+
+    if (!savestate.empty()) memcpy(buffer, savestate.data(), savestate.size());
+    buffer += savestate.size();
+
+    for (uint32 index : pageIndices) {
+        put32(buffer, index);
+        buffer += 4;
+    }
+
+    if (!pageData.empty()) memcpy(buffer, pageData.data(), pageData.size());
+
+    return true;
+}
+
+void* DeltaSnapshot::GetSerializedImage() const { return serializedImage.get(); }
+
+size_t DeltaSnapshot::GetSerializedImageSize() const { return serializedImageSize; }
+
+bool DeltaSnapshot::Deserialize(const void* buffer, size_t size) {
+    const uint8* data = static_cast<const uint8*>(buffer);
+
+    if (size < HEADER_SIZE || get32(data) != MAGIC || get32(data + 4) != VERSION) return false;
+
+    const uint32 kind = get32(data + 8);
+    const uint32 memorySize = get32(data + 20);
+    const size_t savestateSize = get32(data + 24);
+    const size_t pageCount = get32(data + 28);
+
+    if (kind > static_cast<uint32>(Kind::delta) || memorySize % PAGE_SIZE != 0) return false;
+    if (pageCount > memorySize / PAGE_SIZE) return false;
+    if (kind == static_cast<uint32>(Kind::full) && pageCount != memorySize / PAGE_SIZE)
+        return false;
+
+    // size_t is 32 bit on wasm, so the individual sizes are checked against the
+    // remaining buffer instead of adding them up.
+    size_t remaining = size - HEADER_SIZE;
+
+    if (savestateSize > remaining) return false;
+    remaining -= savestateSize;
+
+    if (pageCount > remaining / (4 + PAGE_SIZE) || remaining != pageCount * (4 + PAGE_SIZE))
+        return false;
+
+    const uint8* savestateData = data + HEADER_SIZE;
+    const uint8* indexData = savestateData + savestateSize;
+    const uint8* pages = indexData + pageCount * 4;
+
+    vector<uint32> pageIndices(pageCount);
+
+    for (size_t i = 0; i < pageCount; i++) {
+        pageIndices[i] = get32(indexData + 4 * i);
+
+        if (pageIndices[i] >= memorySize / PAGE_SIZE) return false;
+        if (i > 0 && pageIndices[i] <= pageIndices[i - 1]) return false;
+    }
+
+    this->kind = static_cast<Kind>(kind);
+    chainId = get32(data + 12);
+    sequence = get32(data + 16);
+    this->memorySize = memorySize;
+
+    this->pageIndices = move(pageIndices);
+    pageData.assign(pages, pages + pageCount * PAGE_SIZE);
+    savestate.assign(savestateData, savestateData + savestateSize);
+
+    return true;
+}
+
+DeltaSnapshotTracker::~DeltaSnapshotTracker() { Reset(); }
+
+void DeltaSnapshotTracker::Reset() {
+    if (dirtyPages) EmMemory::RemoveDirtyPageSink(dirtyPages.get());
+
+    dirtyPages.reset();
+    dirtyPagesSize = 0;
+    hasBase = false;
+}
+
+void DeltaSnapshotTracker::Capture(DeltaSnapshot& snapshot, const void* savestate,
+                                   size_t savestateSize, bool full) {
+    Track();
+    EmMemory::CollectDirtyPages();
+
+    const uint8* memory = EmMemory::GetTotalMemory();
+    const uint32 memorySize = EmMemory::GetTotalMemorySize();
+    const uint32 pageCount = memorySize / DeltaSnapshot::PAGE_SIZE;
+
+    if (!hasBase || full) {
+        chainId = newChainId();
+        sequence = 0;
+
+        snapshot = DeltaSnapshot(DeltaSnapshot::Kind::full, chainId, sequence, memorySize);
+
+        for (uint32 i = 0; i < pageCount; i++)
+            snapshot.AddPage(i, memory + i * DeltaSnapshot::PAGE_SIZE);
+    } else {
+        snapshot = DeltaSnapshot(DeltaSnapshot::Kind::delta, chainId, ++sequence, memorySize);
+
+        for (uint32 i = 0; i < pageCount; i++)
+            if (dirtyPages[i >> 3] & (1 << (i & 0x07)))
+                snapshot.AddPage(i, memory + i * DeltaSnapshot::PAGE_SIZE);
+    }
+
+    snapshot.SetSavestate(savestate, savestateSize);
+
+    memset(dirtyPages.get(), 0, dirtyPagesSize);
+    hasBase = true;
+}
+
+void DeltaSnapshotTracker::Rebase(const DeltaSnapshot& snapshot) {
+    Track();
+    EmMemory::CollectDirtyPages();
+
+    memset(dirtyPages.get(), 0, dirtyPagesSize);
+
+    chainId = snapshot.GetChainId();
+    sequence = snapshot.GetSequence();
+    hasBase = true;
+}
+
+void DeltaSnapshotTracker::Track() {
+    if (dirtyPages) return;
+
+    dirtyPagesSize = EmMemory::GetTotalDirtyPagesSize();
+    dirtyPages = make_unique<uint8[]>(dirtyPagesSize);
+
+    memset(dirtyPages.get(), 0, dirtyPagesSize);
+    EmMemory::AddDirtyPageSink(dirtyPages.get());
+}
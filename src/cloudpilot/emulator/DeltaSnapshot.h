@@ -0,0 +1,103 @@
+#ifndef _DELTA_SNAPSHOT_H_
+#define _DELTA_SNAPSHOT_H_
+
+#include <memory>
+#include <vector>
+
+#include "EmCommon.h"
+
+// A snapshot of the emulated memory and the savestate that stores memory as
+// a list of 1k pages. A full snapshot contains every page; a delta contains
+// only the pages that were marked dirty since the previous snapshot of the
+// same chain. Snapshots are chained by a random chain ID and a sequence
+// number that increments by one with every delta.
+//
+// A chain of deltas can be folded into its base (or into an earlier delta) by
+// Compact, which yields the same state as applying both snapshots in order.
+
+class DeltaSnapshot {
+   public:
+    static constexpr uint32 PAGE_SIZE = 1024;
+
+    enum class Kind : uint8 { full = 0, delta = 1 };
+
+   public:
+    DeltaSnapshot() = default;
+    DeltaSnapshot(Kind kind, uint32 chainId, uint32 sequence, uint32 memorySize);
+
+    Kind GetKind() const;
+    uint32 GetChainId() const;
+    uint32 GetSequence() const;
+    uint32 GetMemorySize() const;
+
+    size_t GetPageCount() const;
+    uint32 GetPageIndex(size_t i) const;
+    const uint8* GetPageData(size_t i) const;
+
+    // Pages must be added in ascending order.
+    bool AddPage(uint32 index, const uint8* data);
+
+    const void* GetSavestate() const;
+    size_t GetSavestateSize() const;
+    void SetSavestate(const void* savestate, size_t size);
+
+    // Copies all pages to memory and marks them in the dirty page bitmap (if
+    // given). Fails if the memory size does not match.
+    bool Apply(uint8* memory, uint32 memorySize, uint8* dirtyPages = nullptr) const;
+
+    // Folds the next delta of the same chain into this snapshot.
+    bool Compact(const DeltaSnapshot& next);
+
+    bool Serialize();
+    void* GetSerializedImage() const;
+    size_t GetSerializedImageSize() const;
+
+    bool Deserialize(const void* buffer, size_t size);
+
+   private:
+    Kind kind{Kind::full};
+    uint32 chainId{0};
+    uint32 sequence{0};
+    uint32 memorySize{0};
+
+    vector<uint32> pageIndices;
+    vector<uint8> pageData;
+    vector<uint8> savestate;
+
+    unique_ptr<uint8[]> serializedImage;
+    size_t serializedImageSize{0};
+};
+
+// Tracks the pages that changed since the last snapshot. The tracker
+// registers its own sink with Memory, so it is independent of the host
+// consuming (and clearing) the dirty pages bitmap.
+
+class DeltaSnapshotTracker {
+   public:
+    DeltaSnapshotTracker() = default;
+    ~DeltaSnapshotTracker();
+
+    // Drops the base. The next capture will be a full snapshot.
+    void Reset();
+
+    // Captures a delta against the last snapshot, or a full snapshot if there
+    // is no base or if full is requested.
+    void Capture(DeltaSnapshot& snapshot, const void* savestate, size_t savestateSize,
+                 bool full);
+
+    // Makes the snapshot the base after memory was restored from it.
+    void Rebase(const DeltaSnapshot& snapshot);
+
+   private:
+    void Track();
+
+   private:
+    bool hasBase{false};
+    uint32 chainId{0};
+    uint32 sequence{0};
+
+    unique_ptr<uint8[]> dirtyPages;
+    uint32 dirtyPagesSize{0};
+};
+
+#endif  // _DELTA_SNAPSHOT_H_
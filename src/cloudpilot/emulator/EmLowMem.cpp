@@ -66,7 +66,7 @@ uint8 EmLowMem::GetEvtMgrIdle(void) {
     // the "idle" field.  Under that version of the OS, we therefore
     // have to add 4 to get the right offset.
 
-    if (gSystemState.OSMajorVersion() == 1) {
+    if (gSystemState->OSMajorVersion() == 1) {
         idleOffset += 4;
     }
 
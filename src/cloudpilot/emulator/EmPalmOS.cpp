@@ -26,6 +26,7 @@
 #include "EmPalmStructs.h"  // EmAliasCardHeaderType
 #include "EmPatchMgr.h"     // EmPatchMgr
 #include "EmSession.h"      // gSession->Reset
+#include "EmSessionContext.h"
 #include "EmSystemState.h"
 #include "Logging.h"
 #include "Miscellaneous.h"
@@ -40,15 +41,26 @@ namespace {
     constexpr int EVENT_QUEUE_SIZE = 20;
 }  // namespace
 
-static emuptr gBigROMEntry;
-
-EmThreadSafeQueue<PenEvent> EmPalmOS::penEventQueue{EVENT_QUEUE_SIZE};
-EmThreadSafeQueue<KeyboardEvent> EmPalmOS::keyboardEventQueue{EVENT_QUEUE_SIZE};
-EmThreadSafeQueue<PenEvent> EmPalmOS::penEventQueueIncoming{EVENT_QUEUE_SIZE};
-EmThreadSafeQueue<KeyboardEvent> EmPalmOS::keyboardEventQueueIncoming{EVENT_QUEUE_SIZE};
-uint64 EmPalmOS::lastEventPromotedAt{0};
-LocalID EmPalmOS::dbForLaunch{0};
-bool EmPalmOS::postNilEvent{false};
+static EM_THREAD_LOCAL emuptr gBigROMEntry;
+
+thread_local EmThreadSafeQueue<PenEvent> EmPalmOS::penEventQueue{EVENT_QUEUE_SIZE};
+thread_local EmThreadSafeQueue<KeyboardEvent> EmPalmOS::keyboardEventQueue{EVENT_QUEUE_SIZE};
+thread_local EmThreadSafeQueue<PenEvent> EmPalmOS::penEventQueueIncoming{EVENT_QUEUE_SIZE};
+thread_local EmThreadSafeQueue<KeyboardEvent> EmPalmOS::keyboardEventQueueIncoming{
+    EVENT_QUEUE_SIZE};
+EM_THREAD_LOCAL uint64 EmPalmOS::lastEventPromotedAt{0};
+EM_THREAD_LOCAL LocalID EmPalmOS::dbForLaunch{0};
+EM_THREAD_LOCAL bool EmPalmOS::postNilEvent{false};
+
+const EmSessionState EmPalmOS::sessionState{
+    EM_SESSION_VARIABLE(gBigROMEntry),
+    EM_SESSION_VARIABLE(penEventQueue, EVENT_QUEUE_SIZE),
+    EM_SESSION_VARIABLE(keyboardEventQueue, EVENT_QUEUE_SIZE),
+    EM_SESSION_VARIABLE(penEventQueueIncoming, EVENT_QUEUE_SIZE),
+    EM_SESSION_VARIABLE(keyboardEventQueueIncoming, EVENT_QUEUE_SIZE),
+    EM_SESSION_VARIABLE(lastEventPromotedAt),
+    EM_SESSION_VARIABLE(dbForLaunch),
+    EM_SESSION_VARIABLE(postNilEvent)};
 
 /***********************************************************************
  *
@@ -275,9 +287,11 @@ Bool EmPalmOS::HandleSystemCall(Bool fromTrap) {
     }
 
 #ifdef ENABLE_DEBUGGER
-    gDebugger.NotifyTrap(context.fTrapWord);
+    gDebugger->NotifyTrap(context.fTrapWord);
 #endif
 
+    gSession->GetStats().CountTrap();
+
     CEnableFullAccess munge;
 
     UInt32 memSemaphoreIDP = EmLowMem_GetGlobal(memSemaphoreID);
@@ -313,6 +327,18 @@ Bool EmPalmOS::HandleSystemCall(Bool fromTrap) {
         return true;
     }
 
+    // ======================================================================
+    //	If the call blocks, rewind to the system call and doze until the
+    //	next interrupt. The call is executed again when the CPU wakes up.
+    // ======================================================================
+
+    if (result == kRestartCall) {
+        gCPU->SetPC(context.fPC);
+        gCPU->SetStopped(true);
+
+        return true;
+    }
+
     return false;
 }
 
@@ -338,11 +364,25 @@ bool EmPalmOS::HasKeyboardEvent() { return keyboardEventQueue.GetUsed() != 0; }
 
 PenEvent EmPalmOS::PeekPenEvent() { return HasPenEvent() ? penEventQueue.Peek() : PenEvent(); }
 
+bool EmPalmOS::IsInputIdle() {
+    return penEventQueue.GetUsed() == 0 && keyboardEventQueue.GetUsed() == 0 &&
+           penEventQueueIncoming.GetUsed() == 0 && keyboardEventQueueIncoming.GetUsed() == 0 &&
+           gSession->GetSystemCycles() - lastEventPromotedAt >= MIN_CYCLES_BETWEEN_EVENTS;
+}
+
+void EmPalmOS::ResetInput() {
+    ClearQueues();
+
+    const uint64 systemCycles = gSession->GetSystemCycles();
+    lastEventPromotedAt =
+        systemCycles > MIN_CYCLES_BETWEEN_EVENTS ? systemCycles - MIN_CYCLES_BETWEEN_EVENTS : 0;
+}
+
 bool EmPalmOS::DispatchNextEvent() {
     uint64 systemCycles = gSession->GetSystemCycles();
 
     if (systemCycles - lastEventPromotedAt < MIN_CYCLES_BETWEEN_EVENTS ||
-        !gSystemState.IsUIInitialized())
+        !gSystemState->IsUIInitialized())
         return false;
 
     if (DispatchPenEvent() || DispatchKeyboardEvent()) {
@@ -377,7 +417,7 @@ bool EmPalmOS::DispatchPenEvent() {
 }
 
 void EmPalmOS::Wakeup() {
-    if (gSystemState.OSMajorVersion() >= 4) {
+    if (gSystemState->OSMajorVersion() >= 4) {
         EvtWakeupWithoutNilEvent();
     } else {
         EvtWakeup();
@@ -457,7 +497,7 @@ void EmPalmOS::InjectUIEvent() {
 }
 
 bool EmPalmOS::LaunchAppByName(const string& name) {
-    if (!gSystemState.IsUIInitialized() || gSession->IsCpuStopped()) return false;
+    if (!gSystemState->IsUIInitialized() || gSession->IsCpuStopped()) return false;
 
     LocalID id = DmFindDatabase(0, name.c_str());
     if (id == 0) return false;
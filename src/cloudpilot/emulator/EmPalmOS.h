@@ -21,6 +21,8 @@
 #include "KeyboardEvent.h"
 #include "PenEvent.h"
 
+class EmSessionState;
+
 class EmPalmOS {
    public:
     static void Initialize(void);
@@ -34,6 +36,12 @@ class EmPalmOS {
     static bool HasKeyboardEvent();
     static PenEvent PeekPenEvent();
 
+    // Input is idle if no events are pending and the next event would be
+    // dispatched without delay. ResetInput drops pending events and moves the
+    // session to this state.
+    static bool IsInputIdle();
+    static void ResetInput();
+
     static void InjectSystemEvent(CallROMType& callROM);
     static void InjectUIEvent();
 
@@ -54,15 +62,17 @@ class EmPalmOS {
 
     static void ClearQueues();
 
-    static EmThreadSafeQueue<PenEvent> penEventQueue;
-    static EmThreadSafeQueue<KeyboardEvent> keyboardEventQueue;
+    static thread_local EmThreadSafeQueue<PenEvent> penEventQueue;
+    static thread_local EmThreadSafeQueue<KeyboardEvent> keyboardEventQueue;
+
+    static thread_local EmThreadSafeQueue<PenEvent> penEventQueueIncoming;
+    static thread_local EmThreadSafeQueue<KeyboardEvent> keyboardEventQueueIncoming;
+    static EM_THREAD_LOCAL uint64 lastEventPromotedAt;
 
-    static EmThreadSafeQueue<PenEvent> penEventQueueIncoming;
-    static EmThreadSafeQueue<KeyboardEvent> keyboardEventQueueIncoming;
-    static uint64 lastEventPromotedAt;
+    static EM_THREAD_LOCAL LocalID dbForLaunch;
+    static EM_THREAD_LOCAL bool postNilEvent;
 
-    static LocalID dbForLaunch;
-    static bool postNilEvent;
+    static const EmSessionState sessionState;
 };
 
 #endif /* EmPalmOS_h */
@@ -1,6 +1,8 @@
 #include "EmSession.h"
 
+#include <ctime>
 #include <functional>
+#include <random>
 
 #include "CallbackManager.h"
 #include "Chars.h"
@@ -8,11 +10,13 @@
 #include "Debugger.h"
 #include "EmBankSRAM.h"
 #include "EmCPU.h"
+#include "EmCPU68K.h"
 #include "EmHAL.h"
 #include "EmLowMem.h"
 #include "EmMemory.h"
 #include "EmPalmOS.h"
 #include "EmPatchMgr.h"
+#include "EmSessionContext.h"
 #include "EmSystemState.h"
 #include "ExternalStorage.h"
 #include "Logging.h"
@@ -31,12 +35,21 @@ namespace {
 
     constexpr int MIN_CYCLES_BETWEEN_BUTTON_EVENTS = 400000;
 
+    // Input queue slots that only releases may use: one for the pen and one for
+    // each button that may be held at the same time.
+    constexpr int INPUT_QUEUE_RESERVE = 16;
+
     constexpr uint32 YIELD_MEMMGR_LIMIT = 10000000;
     constexpr uint32 EXECUTE_SUBROUTINE_LIMIT = 100000000;
 
     constexpr double DEFAULT_CLOCK_FACTOR = 0.5;
 
-    EmSession _gSession;
+    constexpr uint32 MIN_REWIND_INTERVAL = 10;
+
+    constexpr uint32 MIN_CHECKPOINT_INTERVAL = 100;
+    constexpr uint32 SEEK_SLICE_CYCLES = 1000000;
+
+    thread_local EmSession _gSession;
 
     uint32 CurrentDate() {
         uint32 year, month, day;
@@ -45,9 +58,32 @@ namespace {
 
         return (year << 16) | (month << 8) | day;
     }
+
+    // Local wall clock time in seconds since the epoch, as if local time were
+    // UTC.
+    int64 LocalTime() {
+        time_t now = time(nullptr);
+
+        tm t;
+        localtime_r(&now, &t);
+
+        return timegm(&t);
+    }
+
+    uint32 SplitMix(uint64 x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+
+        return (x ^ (x >> 31)) & 0xffffffff;
+    }
 }  // namespace
 
-EmSession* gSession = &_gSession;
+thread_local EmSession* gSession = &_gSession;
+
+namespace {
+    const EmSessionState sessionState{EM_SESSION_OBJECT(gSession)};
+}  // namespace
 
 bool EmSession::Initialize(EmDevice* device, const uint8* romImage, size_t romLength) {
     if (isInitialized) {
@@ -73,18 +109,20 @@ bool EmSession::Initialize(EmDevice* device, const uint8* romImage, size_t romLe
 
     systemCycles = 0;
     extraCycles = 0;
+    stats.Reset();
+    lastStatsLog = {};
     Reset(ResetType::soft);
 
-    gSystemState.Initialize();
+    gSystemState->Initialize();
 
     RecalculateClocksPerSecond();
 
     dateCheckedAt = 0;
     lastDate = CurrentDate();
 
-    gDebugger.Reset();
-    gDebugger.ResetBreakMode();
-    gDebugger.ResetAppRegion();
+    gDebugger->Reset();
+    gDebugger->ResetBreakMode();
+    gDebugger->ResetAppRegion();
 
     UpdateUARTModeSync();
 
@@ -94,7 +132,7 @@ bool EmSession::Initialize(EmDevice* device, const uint8* romImage, size_t romLe
 void EmSession::Deinitialize() {
     if (!isInitialized) return;
 
-    gNetworkProxy.Reset();
+    gNetworkProxy->Reset();
     SuspendManager::Reset();
     EmPalmOS::Dispose();
     CallbackManager::Clear();
@@ -105,7 +143,7 @@ void EmSession::Deinitialize() {
     device.reset();
 
     EmHAL::onSystemClockChange.RemoveHandler(onSystemClockChangeHandle);
-    gSystemState.Reset();
+    gSystemState->Reset();
 
     bankResetScheduled = false;
     resetScheduled = false;
@@ -116,19 +154,35 @@ void EmSession::Deinitialize() {
     extraCycles = 0;
     holdingBootKeys = false;
 
+    stats.Reset();
+    lastStatsLog = {};
+
     dateCheckedAt = 0;
     lastDate = 0;
 
     romSize = 0;
     romImage.reset();
     savestate.Reset();
+    snapshotTracker.Reset();
+    rewindBuffer.Reset();
+    rewindSavestate.Reset();
+    nextRewindPointAt = 0;
 
-    gExternalStorage.UnmountAll();
+    StopRecording();
+    StopReplay();
+
+    gExternalStorage->UnmountAll();
 
     isInitialized = false;
 }
 
-bool EmSession::SaveImage(SessionImage& image) {
+bool EmSession::SaveImage(SessionImage& image) { return PrepareImage(image) && image.Serialize(); }
+
+bool EmSession::SaveImage(SessionImage& image, SessionImageSink& sink) {
+    return PrepareImage(image) && image.Serialize(sink);
+}
+
+bool EmSession::PrepareImage(SessionImage& image) {
     EmAssert(romImage);
 
     image.SetRomImage(romImage.get(), romSize)
@@ -137,6 +191,7 @@ bool EmSession::SaveImage(SessionImage& image) {
 
     if (savestate.Save(*this)) {
         image.SetSavestate(savestate.GetBuffer(), savestate.GetSize());
+        stats.CountSavestate(savestate.GetSize());
     } else {
         image.SetSavestate(nullptr, 0);
         logging::printf("failed to save savestate");
@@ -144,7 +199,7 @@ bool EmSession::SaveImage(SessionImage& image) {
         return false;
     }
 
-    return image.Serialize();
+    return true;
 }
 
 bool EmSession::LoadImage(SessionImage& image) {
@@ -186,7 +241,7 @@ bool EmSession::LoadImage(SessionImage& image) {
         return false;
     }
 
-    gExternalStorage.Remount();
+    gExternalStorage->Remount();
 
     return true;
 }
@@ -209,9 +264,9 @@ void EmSession::Save(T& savestate) {
 
     cpu->Save(savestate);
     EmPatchMgr::Save(savestate);
-    gSystemState.Save(savestate);
+    gSystemState->Save(savestate);
     Memory::Save(savestate);
-    gExternalStorage.Save(savestate);
+    gExternalStorage->Save(savestate);
 }
 
 template void EmSession::Save(Savestate& savestate);
@@ -250,11 +305,11 @@ void EmSession::Load(SavestateLoader& loader) {
 
     lastButtonEventReadAt = systemCycles;
 
-    gSystemState.Load(loader);
+    gSystemState->Load(loader);
     cpu->Load(loader);
     EmPatchMgr::Load(loader);
     Memory::Load(loader);
-    gExternalStorage.Load(loader);
+    gExternalStorage->Load(loader);
 
     SetCurrentDate();
     dateCheckedAt = systemCycles;
@@ -269,10 +324,21 @@ bool EmSession::Save() {
         return false;
     }
 
-    return savestate.Save(*this);
+    if (!savestate.Save(*this)) return false;
+
+    stats.CountSavestate(savestate.GetSize());
+
+    return true;
 }
 
 bool EmSession::Load(size_t size, uint8* buffer) {
+    snapshotTracker.Reset();
+    rewindBuffer.Reset();
+
+    return RestoreSavestate(size, buffer);
+}
+
+bool EmSession::RestoreSavestate(size_t size, uint8* buffer) {
     SavestateLoader loader;
 
     if (!loader.Load(buffer, size, *this)) {
@@ -283,9 +349,281 @@ bool EmSession::Load(size_t size, uint8* buffer) {
 
     Memory::ResetBankHandlers();
 
+    // Blocked NetLib calls are identified by the stack pointer of the calling
+    // task, so calls from the old timeline could pick up a response that was
+    // meant for a task in the new one.
+    gNetworkProxy->DiscardPendingCalls();
+
+    return true;
+}
+
+bool EmSession::CaptureSnapshot(DeltaSnapshot& snapshot, bool full) {
+    if (!Save()) return false;
+
+    snapshotTracker.Capture(snapshot, savestate.GetBuffer(), savestate.GetSize(), full);
+
+    return true;
+}
+
+bool EmSession::LoadSnapshot(const DeltaSnapshot& base, const vector<DeltaSnapshot>& deltas) {
+    if (base.GetKind() != DeltaSnapshot::Kind::full) {
+        logging::printf("unable to restore snapshot: not a full snapshot");
+        return false;
+    }
+
+    const uint32 memorySize = EmMemory::GetTotalMemorySize();
+
+    if (base.GetMemorySize() != memorySize) {
+        logging::printf("unable to restore snapshot: memory size mismatch");
+        return false;
+    }
+
+    const DeltaSnapshot* previous = &base;
+
+    for (const auto& delta : deltas) {
+        if (delta.GetKind() != DeltaSnapshot::Kind::delta ||
+            delta.GetChainId() != base.GetChainId() ||
+            delta.GetSequence() != previous->GetSequence() + 1 ||
+            delta.GetMemorySize() != memorySize) {
+            logging::printf("unable to restore snapshot: delta does not continue the chain");
+            return false;
+        }
+
+        previous = &delta;
+    }
+
+    const DeltaSnapshot& last = deltas.empty() ? base : deltas.back();
+
+    uint8* memory = EmMemory::GetTotalMemory();
+    uint8* dirtyPages = EmMemory::GetBankDirtyPages();
+
+    // The base is a full snapshot, so the rollback needs all of memory.
+    DeltaSnapshot rollback(DeltaSnapshot::Kind::full, 0, 0, memorySize);
+
+    auto restoreMemory = [&]() {
+        for (uint32 i = 0; i < memorySize / DeltaSnapshot::PAGE_SIZE; i++)
+            rollback.AddPage(i, memory + i * DeltaSnapshot::PAGE_SIZE);
+
+        base.Apply(memory, memorySize, dirtyPages);
+        for (const auto& delta : deltas) delta.Apply(memory, memorySize, dirtyPages);
+
+        // Rebase before the savestate is loaded: the load writes to memory
+        // (SetCurrentDate), and these writes belong to the next delta.
+        snapshotTracker.Rebase(last);
+
+        return true;
+    };
+
+    auto rollBackMemory = [&]() {
+        rollback.Apply(memory, memorySize, dirtyPages);
+
+        // The tracker was already rebased, so the next capture must be full.
+        snapshotTracker.Reset();
+    };
+
+    if (!LoadSavestateOrRollBack(last.GetSavestateSize(), last.GetSavestate(), restoreMemory,
+                                 rollBackMemory)) {
+        logging::printf("unable to restore snapshot: failed to load savestate");
+        return false;
+    }
+
+    // Memory changed behind the banks' back, so the block cache must go.
+    Memory::ResetBankHandlers();
+    gNetworkProxy->DiscardPendingCalls();
+
+    rewindBuffer.Reset();
+
+    return true;
+}
+
+void EmSession::ConfigureRewind(size_t capacity, uint32 intervalMsec) {
+    rewindBuffer.SetCapacity(capacity);
+    rewindInterval = max(intervalMsec, MIN_REWIND_INTERVAL);
+
+    nextRewindPointAt = systemCycles;
+}
+
+bool EmSession::Rewind(uint32 msec) {
+    EmAssert(nestLevel == 0);
+
+    const size_t depth = rewindBuffer.GetDepth();
+    if (depth == 0) return false;
+
+    const uint64 delta = static_cast<uint64>(msec) * clocksPerSecond / 1000;
+    const uint64 target = systemCycles > delta ? systemCycles - delta : 0;
+
+    size_t steps = 0;
+    while (steps + 1 < depth && rewindBuffer.GetSystemCycles(steps) > target) steps++;
+
+    // Memory is restored before the savestate is loaded, as loading the
+    // savestate reads and writes memory. If it fails to load, memory and
+    // history are rolled back.
+    if (!LoadSavestateOrRollBack(
+            rewindBuffer.GetSavestateSize(steps), rewindBuffer.GetSavestate(steps),
+            [&]() { return rewindBuffer.BeginRestore(steps); },
+            [&]() { rewindBuffer.RollBackRestore(); })) {
+        logging::printf("unable to rewind: failed to load savestate");
+        return false;
+    }
+
+    rewindBuffer.CommitRestore();
+    Memory::ResetBankHandlers();
+    gNetworkProxy->DiscardPendingCalls();
+
+    nextRewindPointAt = systemCycles + static_cast<uint64>(rewindInterval) * clocksPerSecond / 1000;
+
+    return true;
+}
+
+bool EmSession::LoadSavestateOrRollBack(size_t size, const void* buffer,
+                                        const function<bool()>& restoreMemory,
+                                        const function<void()>& rollBackMemory) {
+    if (!rewindSavestate.Save(*this)) {
+        logging::printf("unable to save current state");
+        return false;
+    }
+
+    if (!restoreMemory()) return false;
+
+    SavestateLoader loader;
+    if (loader.Load(const_cast<void*>(buffer), size, *this)) return true;
+
+    // Memory goes first, so reloading the old savestate sees the old memory.
+    rollBackMemory();
+    RestoreSavestate(rewindSavestate.GetSize(), static_cast<uint8*>(rewindSavestate.GetBuffer()));
+
+    return false;
+}
+
+const RewindBuffer& EmSession::GetRewindBuffer() const { return rewindBuffer; }
+
+void EmSession::CaptureRewindPoint() {
+    if (rewindSavestate.Save(*this))
+        rewindBuffer.Capture(rewindSavestate.GetBuffer(), rewindSavestate.GetSize(),
+                             systemCycles);
+
+    nextRewindPointAt = systemCycles + static_cast<uint64>(rewindInterval) * clocksPerSecond / 1000;
+}
+
+bool EmSession::StartRecording(Recording& recording, uint32 intervalMsec) {
+    EmAssert(nestLevel == 0);
+
+    if (IsRecording() || IsReplaying()) return false;
+
+    if (!Save()) {
+        logging::printf("unable to start recording: failed to save state");
+        return false;
+    }
+
+    recording.Clear();
+    recording.SetEnvironment(LocalTime(), random_device()(), clockFactor);
+
+    // The checkpoint is taken with input idle, so seeking to it restores the
+    // exact state of the session.
+    ResetInput();
+
+    DeltaSnapshot snapshot;
+    recordingTracker.Reset();
+    recordingTracker.Capture(snapshot, savestate.GetBuffer(), savestate.GetSize(), true);
+
+    if (!recording.AddCheckpoint(systemCycles, snapshot)) {
+        logging::printf("unable to start recording: failed to add checkpoint");
+        recordingTracker.Reset();
+
+        return false;
+    }
+
+    this->recording = &recording;
+    checkpointInterval = max(intervalMsec, MIN_CHECKPOINT_INTERVAL);
+    nextCheckpointAt =
+        systemCycles + static_cast<uint64>(checkpointInterval) * clocksPerSecond / 1000;
+
+    InstallEnvironment(recording);
+
+    return true;
+}
+
+void EmSession::StopRecording() {
+    if (!recording) return;
+
+    recording->SetEndCycles(max(recording->GetEndCycles(), systemCycles));
+    recording = nullptr;
+    recordingTracker.Reset();
+
+    UninstallEnvironment();
+}
+
+void EmSession::NotifyHostInput(Recording::HostInput input) {
+    const char* name = input == Recording::HostInput::network ? "network" : "serial";
+
+    if (recording && !recording->UsesHostInput(input)) {
+        logging::printf("recording is not deterministic: %s input is not recorded", name);
+        recording->MarkHostInput(input);
+    }
+
+    if (replay) {
+        logging::printf("stopping replay: %s input is not recorded", name);
+        StopReplay();
+    }
+}
+
+bool EmSession::StartReplay(const Recording& recording) {
+    if (IsRecording() || IsReplaying()) return false;
+
+    DeltaSnapshot snapshot;
+
+    if (!recording.RestoreCheckpoint(0, snapshot) || !LoadSnapshot(snapshot)) {
+        logging::printf("unable to start replay: failed to restore checkpoint");
+        return false;
+    }
+
+    ResetInput();
+
+    replay = &recording;
+    nextReplayEvent = 0;
+
+    SetClockFactor(recording.GetClockFactor());
+    InstallEnvironment(recording);
+
+    return true;
+}
+
+bool EmSession::SeekReplay(uint64 cycles) {
+    EmAssert(nestLevel == 0);
+
+    if (!replay) return false;
+
+    const size_t index = replay->FindCheckpoint(cycles);
+    const Recording::Checkpoint& checkpoint = replay->GetCheckpoints()[index];
+
+    if (systemCycles > cycles || systemCycles < checkpoint.cycles) {
+        DeltaSnapshot snapshot;
+
+        if (!replay->RestoreCheckpoint(index, snapshot) || !LoadSnapshot(snapshot)) {
+            logging::printf("unable to seek: failed to restore checkpoint");
+            return false;
+        }
+
+        ResetInput();
+        nextReplayEvent = checkpoint.nextEvent;
+    }
+
+    while (replay && systemCycles < cycles && !gDebugger->IsStopped() &&
+           !SuspendManager::IsSuspended())
+        RunEmulation(min<uint64>(cycles - systemCycles, SEEK_SLICE_CYCLES));
+
     return true;
 }
 
+void EmSession::StopReplay() {
+    if (!replay) return;
+
+    replay = nullptr;
+    nextReplayEvent = 0;
+
+    UninstallEnvironment();
+}
+
 Savestate& EmSession::GetSavestate() { return savestate; }
 
 pair<size_t, uint8*> EmSession::GetRomImage() {
@@ -318,12 +656,12 @@ void EmSession::Reset(ResetType resetType) {
     EmAssert(cpu);
     EmAssert(nestLevel == 0);
 
-    gNetworkProxy.Reset();
+    gNetworkProxy->Reset();
     SuspendManager::Reset();
     Memory::Reset(resetType != ResetType::sys);
     cpu->Reset(resetType != ResetType::sys);
     EmPalmOS::Reset();
-    gSystemState.Reset();
+    gSystemState->Reset();
 
     bankResetScheduled = false;
     resetScheduled = false;
@@ -438,11 +776,28 @@ uint32 EmSession::RunEmulation(uint32 maxCycles) {
         return cycles;
     }
 
+    DispatchHostInput();
+
+    if (replay) {
+        DispatchReplayEvents();
+        maxCycles = ClampToNextReplayEvent(maxCycles);
+    }
+
     uint32 cycles = cpu->Execute(maxCycles);
     systemCycles += cycles;
 
     CheckDayForRollover();
 
+    if (rewindBuffer.IsEnabled() && systemCycles >= nextRewindPointAt &&
+        !SuspendManager::IsSuspended())
+        CaptureRewindPoint();
+
+    if (recording && systemCycles >= nextCheckpointAt && !SuspendManager::IsSuspended() &&
+        IsInputIdle())
+        CaptureCheckpoint();
+
+    if (statsLogInterval > 0) LogStats();
+
     extraCycles = 0;
 
     return systemCycles - cyclesBefore;
@@ -452,6 +807,10 @@ void EmSession::ExecuteSubroutine() {
     EmAssert(cpu);
     EmAssert(nestLevel >= 0);
 
+    // Cycle consumers are not dispatched while nested, so make sure that they
+    // have caught up with the CPU before we start.
+    EmHAL::SyncCycles();
+
     EmValueChanger<bool> clearSubroutineReturn(subroutineReturn, false);
     EmValueChanger<int> increaseNestLevel(nestLevel, nestLevel + 1);
     EmValueChanger<bool> resetDeadMansSwitch(deadMansSwitch, false);
@@ -481,7 +840,7 @@ void EmSession::YieldMemoryMgr() {
     uint32 cycles = 0;
 
     while (memSemaphoreID.xsmuse != 0 && !EmPatchMgr::IsExecutingPatch() &&
-           !SuspendManager::IsSuspended() && !gDebugger.IsStopped()) {
+           !SuspendManager::IsSuspended() && !gDebugger->IsStopped()) {
         EmAssert(cycles < YIELD_MEMMGR_LIMIT);
 
         cycles += gCPU68K->Execute(0);
@@ -498,13 +857,82 @@ void EmSession::HandleInstructionBreak() {
     CallbackManager::HandleBreakpoint();
 }
 
-void EmSession::QueuePenEvent(PenEvent evt) { EmPalmOS::QueuePenEvent(evt); }
+bool EmSession::QueuePenEvent(PenEvent evt) {
+    Recording::Event event;
+    event.kind = Recording::Event::Kind::pen;
+    event.penEvent = evt;
+
+    return QueueInputEvent(event);
+}
+
+bool EmSession::QueueKeyboardEvent(KeyboardEvent evt) {
+    Recording::Event event;
+    event.kind = Recording::Event::Kind::key;
+    event.key = evt.GetKey();
+    event.ctrl = evt.hasCtrl();
+
+    return QueueInputEvent(event);
+}
+
+bool EmSession::QueueButtonEvent(ButtonEvent evt) {
+    Recording::Event event;
+    event.kind = Recording::Event::Kind::button;
+    event.button = evt.GetButton();
+    event.buttonType = evt.GetType();
+
+    return QueueInputEvent(event);
+}
+
+bool EmSession::QueueInputEvent(const Recording::Event& event) {
+    const bool isRelease =
+        (event.kind == Recording::Event::Kind::pen && !event.penEvent.isPenDown()) ||
+        (event.kind == Recording::Event::Kind::button &&
+         event.buttonType == ButtonEvent::Type::release);
+
+    // A pen move or press that does not fit is dropped; the next move or the
+    // release supersedes it.
+    if ((isRelease || inputQueue.GetFree() > INPUT_QUEUE_RESERVE) && inputQueue.Put(event))
+        return true;
+
+    logging::printf("input queue full, dropping event");
+
+    return false;
+}
+
+void EmSession::DispatchHostInput() {
+    while (inputQueue.GetUsed() > 0) {
+        Recording::Event event = inputQueue.Get();
+
+        if (replay) continue;
+        if (recording) RecordEvent(event);
+
+        DispatchInputEvent(event);
+    }
+}
+
+void EmSession::DispatchInputEvent(const Recording::Event& event) {
+    switch (event.kind) {
+        case Recording::Event::Kind::pen:
+            DoQueuePenEvent(event.penEvent);
+            break;
+
+        case Recording::Event::Kind::key:
+            DoQueueKeyboardEvent(KeyboardEvent(event.key, event.ctrl));
+            break;
+
+        case Recording::Event::Kind::button:
+            DoQueueButtonEvent(ButtonEvent(event.button, event.buttonType));
+            break;
+    }
+}
+
+void EmSession::DoQueuePenEvent(PenEvent evt) { EmPalmOS::QueuePenEvent(evt); }
 
-void EmSession::QueueKeyboardEvent(KeyboardEvent evt) { EmPalmOS::QueueKeyboardEvent(evt); }
+void EmSession::DoQueueKeyboardEvent(KeyboardEvent evt) { EmPalmOS::QueueKeyboardEvent(evt); }
 
-void EmSession::QueueButtonEvent(ButtonEvent evt) {
+void EmSession::DoQueueButtonEvent(ButtonEvent evt) {
     if (evt.GetButton() == ButtonEvent::Button::cradle && !device->SupportsHardBtnCradle()) {
-        if (evt.GetType() == ButtonEvent::Type::press) QueueKeyboardEvent(hardCradleChr);
+        if (evt.GetType() == ButtonEvent::Type::press) DoQueueKeyboardEvent(hardCradleChr);
         return;
     }
 
@@ -512,6 +940,82 @@ void EmSession::QueueButtonEvent(ButtonEvent evt) {
     buttonEventQueue.Put(evt);
 }
 
+bool EmSession::IsInputIdle() {
+    return EmPalmOS::IsInputIdle() && inputQueue.GetUsed() == 0 &&
+           buttonEventQueue.GetUsed() == 0 &&
+           systemCycles - lastButtonEventReadAt >= MIN_CYCLES_BETWEEN_BUTTON_EVENTS;
+}
+
+void EmSession::ResetInput() {
+    EmPalmOS::ResetInput();
+
+    inputQueue.Clear();
+    buttonEventQueue.Clear();
+    lastButtonEventReadAt = systemCycles > MIN_CYCLES_BETWEEN_BUTTON_EVENTS
+                                ? systemCycles - MIN_CYCLES_BETWEEN_BUTTON_EVENTS
+                                : 0;
+}
+
+void EmSession::RecordEvent(const Recording::Event& event) {
+    Recording::Event stampedEvent(event);
+    stampedEvent.cycles = systemCycles;
+
+    if (!recording->AddEvent(stampedEvent)) logging::printf("failed to record event");
+}
+
+void EmSession::CaptureCheckpoint() {
+    nextCheckpointAt =
+        systemCycles + static_cast<uint64>(checkpointInterval) * clocksPerSecond / 1000;
+
+    if (!Save()) return;
+
+    DeltaSnapshot snapshot;
+    recordingTracker.Capture(snapshot, savestate.GetBuffer(), savestate.GetSize(), false);
+
+    if (!recording->AddCheckpoint(systemCycles, snapshot))
+        logging::printf("failed to add checkpoint to recording");
+}
+
+void EmSession::DispatchReplayEvents() {
+    const vector<Recording::Event>& events = replay->GetEvents();
+
+    for (; nextReplayEvent < events.size() && events[nextReplayEvent].cycles <= systemCycles;
+         nextReplayEvent++) {
+        DispatchInputEvent(events[nextReplayEvent]);
+    }
+
+    if (nextReplayEvent == events.size() && systemCycles >= replay->GetEndCycles()) {
+        logging::printf("replay finished");
+        StopReplay();
+    }
+}
+
+uint32 EmSession::ClampToNextReplayEvent(uint32 maxCycles) const {
+    if (!replay || nextReplayEvent >= replay->GetEvents().size()) return maxCycles;
+
+    const uint64 nextEventAt = replay->GetEvents()[nextReplayEvent].cycles;
+
+    return nextEventAt > systemCycles ? min<uint64>(maxCycles, nextEventAt - systemCycles)
+                                      : maxCycles;
+}
+
+void EmSession::InstallEnvironment(const Recording& recording) {
+    const int64 startTime = recording.GetStartTime();
+    const uint64 startCycles = recording.GetStartCycles();
+    const uint32 randomSeed = recording.GetRandomSeed();
+
+    Platform::SetClockOverride([=]() {
+        return startTime + static_cast<int64>((systemCycles - startCycles) / clocksPerSecond);
+    });
+
+    Platform::SetRandomOverride([=]() { return SplitMix(randomSeed ^ systemCycles); });
+}
+
+void EmSession::UninstallEnvironment() {
+    Platform::SetClockOverride(nullptr);
+    Platform::SetRandomOverride(nullptr);
+}
+
 bool EmSession::HasButtonEvent() {
     if (holdingBootKeys) return false;
 
@@ -537,7 +1041,7 @@ uint32 EmSession::GetRandomSeed() const { return EmLowMem::fgLowMem.globals.sysR
 uint8* EmSession::GetDirtyPagesPtr() const { return EmMemory::GetTotalDirtyPages(); }
 
 void EmSession::SetHotsyncUserName(string hotsyncUserName) {
-    gSystemState.SetHotsyncUserName(hotsyncUserName);
+    gSystemState->SetHotsyncUserName(hotsyncUserName);
 
     if (IsCpuStopped()) {
         logging::printf("WARNING: attempt to set hotsync name with stopped CPU");
@@ -545,7 +1049,7 @@ void EmSession::SetHotsyncUserName(string hotsyncUserName) {
         return;
     }
 
-    if (gSystemState.IsUIInitialized() && IsPowerOn()) {
+    if (gSystemState->IsUIInitialized() && IsPowerOn()) {
         SetHotSyncUserName(hotsyncUserName.c_str());
     }
 }
@@ -595,6 +1099,32 @@ EmTransportSerial* EmSession::GetTransportSerial(EmUARTDeviceType type) {
 
 bool EmSession::LaunchAppByName(const string& name) { return EmPalmOS::LaunchAppByName(name); }
 
+SessionStats::Snapshot EmSession::GetStatsSnapshot() const {
+    return stats.Capture(Platform::GetMilliseconds(), clocksPerSecond, systemCycles,
+                         gCPU68K ? gCPU68K->GetInstructionCount() : 0);
+}
+
+void EmSession::SetStatsLogInterval(uint32 intervalMsec) {
+    statsLogInterval = intervalMsec;
+    lastStatsLog = {};
+}
+
+void EmSession::LogStats() {
+    const long now = Platform::GetMilliseconds();
+    if (lastStatsLog.timestamp > 0 && now - lastStatsLog.timestamp < statsLogInterval) return;
+
+    const SessionStats::Snapshot snapshot = GetStatsSnapshot();
+
+    // The first call only establishes the baseline.
+    if (lastStatsLog.timestamp > 0) {
+        const SessionStats::Rates rates = SessionStats::CalculateRates(lastStatsLog, snapshot);
+
+        logging::printf("stats: %s", SessionStats::FormatLogLine(snapshot, rates).c_str());
+    }
+
+    lastStatsLog = snapshot;
+}
+
 void EmSession::SetTransportSerial(EmUARTDeviceType type, EmTransportSerial* transport) {
     switch (type) {
         case kUARTIR:
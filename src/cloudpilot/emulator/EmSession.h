@@ -2,10 +2,12 @@
 #define _EM_SESSION_H_
 
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <utility>
 
 #include "ButtonEvent.h"
+#include "DeltaSnapshot.h"
 #include "EmCPU.h"
 #include "EmCommon.h"
 #include "EmDevice.h"
@@ -16,19 +18,27 @@
 #include "EmTransportSerialNull.h"
 #include "KeyboardEvent.h"
 #include "PenEvent.h"
+#include "Recording.h"
+#include "RewindBuffer.h"
 #include "Savestate.h"
+#include "SpscQueue.h"
+#include "SessionStats.h"
 
 class SavestateLoader;
 class SessionImage;
+class SessionImageSink;
 
 class EmSession {
    public:
     enum class ResetType : uint8 { sys = 0x01, soft = 0x02, noext = 0x03, hard = 0x04 };
 
+    static constexpr uint32 DEFAULT_CHECKPOINT_INTERVAL_MSEC = 10000;
+
    public:
     bool Initialize(EmDevice* device, const uint8* romImage, size_t romLength);
 
     bool SaveImage(SessionImage& image);
+    bool SaveImage(SessionImage& image, SessionImageSink& sink);
     bool LoadImage(SessionImage& image);
 
     template <typename T>
@@ -38,6 +48,45 @@ class EmSession {
     bool Save();
     bool Load(size_t size, uint8* buffer);
 
+    // Captures a delta against the previous snapshot (or a full snapshot if
+    // there is none or if requested). Restoring takes a full snapshot and the
+    // deltas that follow it in its chain. The savestate of the last snapshot
+    // is loaded before memory is touched, so a failed restore leaves the
+    // session as it was.
+    bool CaptureSnapshot(DeltaSnapshot& snapshot, bool full = false);
+    bool LoadSnapshot(const DeltaSnapshot& base, const vector<DeltaSnapshot>& deltas = {});
+
+    // Rewind captures a point every intervalMsec of emulated time and keeps up
+    // to capacity bytes of history. Rewind goes back to the latest point that
+    // lies at least msec in the past (or to the oldest point).
+    void ConfigureRewind(size_t capacity, uint32 intervalMsec);
+    bool Rewind(uint32 msec);
+    const RewindBuffer& GetRewindBuffer() const;
+
+    // Recording captures all pen, key and button events, stamped with the
+    // system cycle count, together with the seeds for the emulated clock and
+    // for random numbers. A checkpoint is added every intervalMsec of emulated
+    // time while input is idle. The recording is owned by the caller and must
+    // outlive the session's use of it.
+    //
+    // Replay restores the first checkpoint and feeds the events back at their
+    // cycle counts; host input is dropped meanwhile. Seek restores the latest
+    // checkpoint before the target and runs emulation up to it.
+    bool StartRecording(Recording& recording,
+                        uint32 intervalMsec = DEFAULT_CHECKPOINT_INTERVAL_MSEC);
+    void StopRecording();
+    bool IsRecording() const { return recording != nullptr; }
+
+    bool StartReplay(const Recording& recording);
+    bool SeekReplay(uint64 cycles);
+    void StopReplay();
+    bool IsReplaying() const { return replay != nullptr; }
+
+    // Called when network or serial input reaches the emulated device. This
+    // input is not recorded: the recording is marked as non-deterministic, and
+    // a replay stops, as it would diverge from here on.
+    void NotifyHostInput(Recording::HostInput input);
+
     void Reset(ResetType);
 
     Savestate& GetSavestate();
@@ -55,9 +104,14 @@ class EmSession {
     uint8* GetMemoryPtr() const;
     uint8* GetDirtyPagesPtr() const;
 
-    void QueuePenEvent(PenEvent evt);
-    void QueueKeyboardEvent(KeyboardEvent evt);
-    void QueueButtonEvent(ButtonEvent evt);
+    // Input may be queued from any one thread besides the emulation thread.
+    // The events are picked up when the next emulation slice starts. The last
+    // slots of the queue are reserved for pen and button releases, so anything
+    // that has been pressed can be released again. Returns false if the event
+    // was dropped because the queue is full.
+    bool QueuePenEvent(PenEvent evt);
+    bool QueueKeyboardEvent(KeyboardEvent evt);
+    bool QueueButtonEvent(ButtonEvent evt);
 
     void SetHotsyncUserName(string hotsyncUserName);
 
@@ -67,6 +121,13 @@ class EmSession {
 
     bool LaunchAppByName(const string& name);
 
+    // Runtime counters. If a log interval is set, RunEmulation logs the rates
+    // since the previous log line every intervalMsec of host time (0 disables).
+    SessionStats& GetStats() { return stats; }
+    SessionStats::Snapshot GetStatsSnapshot() const;
+    void SetStatsLogInterval(uint32 intervalMsec);
+    uint32 GetStatsLogInterval() const { return statsLogInterval; }
+
     void SetTransportSerial(EmUARTDeviceType type, EmTransportSerial* transport);
 
     ///////////////////////////////////////////////////////////////////////////
@@ -75,6 +136,14 @@ class EmSession {
 
     void Deinitialize();
 
+    bool RestoreSavestate(size_t size, uint8* buffer);
+    // Restores memory and loads the savestate. If the savestate fails to load,
+    // memory is rolled back and the previous state is reloaded.
+    bool LoadSavestateOrRollBack(size_t size, const void* buffer,
+                                 const function<bool()>& restoreMemory,
+                                 const function<void()>& rollBackMemory);
+    void CaptureRewindPoint();
+
     inline bool IsNested() const;
 
     void ReleaseBootKeys();
@@ -102,6 +171,8 @@ class EmSession {
     template <typename T>
     void DoSaveLoad(T& helper, uint32 version);
 
+    bool PrepareImage(SessionImage& image);
+
     bool PromoteKeyboardEvent();
     bool PromotePenEvent();
 
@@ -111,6 +182,27 @@ class EmSession {
 
     void UpdateUARTModeSync();
 
+    bool QueueInputEvent(const Recording::Event& event);
+    void DispatchHostInput();
+    void DispatchInputEvent(const Recording::Event& event);
+
+    void DoQueuePenEvent(PenEvent evt);
+    void DoQueueKeyboardEvent(KeyboardEvent evt);
+    void DoQueueButtonEvent(ButtonEvent evt);
+
+    bool IsInputIdle();
+    void ResetInput();
+
+    void RecordEvent(const Recording::Event& event);
+    void CaptureCheckpoint();
+    void DispatchReplayEvents();
+    uint32 ClampToNextReplayEvent(uint32 maxCycles) const;
+
+    void InstallEnvironment(const Recording& recording);
+    void UninstallEnvironment();
+
+    void LogStats();
+
    private:
     bool bankResetScheduled{false};
     bool resetScheduled{false};
@@ -124,6 +216,8 @@ class EmSession {
     unique_ptr<EmCPU> cpu{nullptr};
     typename EmEvent<>::HandleT onSystemClockChangeHandle;
 
+    SpscQueue<Recording::Event> inputQueue{64};
+
     EmThreadSafeQueue<ButtonEvent> buttonEventQueue{20};
     uint64 lastButtonEventReadAt{0};
 
@@ -142,9 +236,27 @@ class EmSession {
     unique_ptr<uint8[]> romImage;
     size_t romSize{0};
     Savestate savestate;
+    DeltaSnapshotTracker snapshotTracker;
+
+    RewindBuffer rewindBuffer;
+    Savestate rewindSavestate;
+    uint32 rewindInterval{1000};
+    uint64 nextRewindPointAt{0};
+
+    Recording* recording{nullptr};
+    DeltaSnapshotTracker recordingTracker;
+    uint32 checkpointInterval{DEFAULT_CHECKPOINT_INTERVAL_MSEC};
+    uint64 nextCheckpointAt{0};
+
+    const Recording* replay{nullptr};
+    size_t nextReplayEvent{0};
 
     bool deadMansSwitch{false};
 
+    SessionStats stats;
+    uint32 statsLogInterval{0};
+    SessionStats::Snapshot lastStatsLog{};
+
     EmTransportSerialNull defaultTransportIR;
     EmTransportSerialNull defaultTransportSerial;
 
@@ -154,7 +266,9 @@ class EmSession {
     int transportSerialRequiresSyncChangedHandle{-1};
 };
 
-extern EmSession* gSession;
+// The session of the current thread. Bind an EmSessionContext to run a session
+// on a thread other than the one that created it.
+extern thread_local EmSession* gSession;
 
 ///////////////////////////////////////////////////////////////////////////////
 // IMPLEMENTATION
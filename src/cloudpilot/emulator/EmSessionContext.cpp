@@ -0,0 +1,108 @@
+#include "EmSessionContext.h"
+
+#include <cstring>
+
+#include "EmSession.h"
+
+namespace {
+    EM_THREAD_LOCAL EmSessionContext* boundContext{nullptr};
+
+    vector<const EmSessionState::Variable*>& registry() {
+        static vector<const EmSessionState::Variable*> variables;
+
+        return variables;
+    }
+
+    size_t alignUp(size_t offset, size_t alignment) {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+}  // namespace
+
+EmSessionState::EmSessionState(std::initializer_list<Variable> variables) : variables(variables) {
+    for (const auto& variable : this->variables) registry().push_back(&variable);
+}
+
+const vector<const EmSessionState::Variable*>& EmSessionState::GetVariables() {
+    return registry();
+}
+
+EmSessionContext::Binding::Binding(EmSessionContext& context) : context(context) {
+    context.Bind();
+}
+
+EmSessionContext::Binding::~Binding() { context.Unbind(); }
+
+EmSessionContext::EmSessionContext() {
+    const auto& variables = EmSessionState::GetVariables();
+    size_t size = 0;
+
+    offsets.reserve(variables.size());
+
+    for (const auto* variable : variables) {
+        size = alignUp(size, variable->alignment);
+        offsets.push_back(size);
+
+        size += variable->size;
+    }
+
+    storage = make_unique<max_align_t[]>(alignUp(size, sizeof(max_align_t)) / sizeof(max_align_t));
+    uint8* base = reinterpret_cast<uint8*>(storage.get());
+
+    for (size_t i = 0; i < variables.size(); i++) {
+        const auto* variable = variables[i];
+
+        if (variable->construct)
+            variable->construct(base + offsets[i]);
+        else
+            memcpy(base + offsets[i], variable->initialValue.data(), variable->size);
+    }
+}
+
+EmSessionContext::~EmSessionContext() {
+    EmAssert(!bound);
+
+    // Tearing down the session touches the thread-local state, so this needs
+    // to happen while the context is bound.
+    {
+        Binding binding(*this);
+
+        gSession->Deinitialize();
+    }
+
+    const auto& variables = EmSessionState::GetVariables();
+    uint8* base = reinterpret_cast<uint8*>(storage.get());
+
+    for (size_t i = variables.size(); i > 0; i--) variables[i - 1]->destroy(base + offsets[i - 1]);
+}
+
+void EmSessionContext::Bind() {
+    EmAssert(!bound);
+    EmAssert(boundContext == nullptr);
+
+    Exchange();
+
+    bound = true;
+    boundContext = this;
+}
+
+void EmSessionContext::Unbind() {
+    EmAssert(bound);
+    EmAssert(boundContext == this);
+
+    Exchange();
+
+    bound = false;
+    boundContext = nullptr;
+}
+
+EmSessionContext* EmSessionContext::GetBound() { return boundContext; }
+
+void EmSessionContext::Exchange() {
+    const auto& variables = EmSessionState::GetVariables();
+    EmAssert(variables.size() == offsets.size());
+
+    uint8* base = reinterpret_cast<uint8*>(storage.get());
+
+    for (size_t i = 0; i < variables.size(); i++)
+        variables[i]->exchange(variables[i]->access(), base + offsets[i]);
+}
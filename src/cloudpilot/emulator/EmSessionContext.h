@@ -0,0 +1,193 @@
+#ifndef _EM_SESSION_CONTEXT_H_
+#define _EM_SESSION_CONTEXT_H_
+
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "EmCommon.h"
+
+// The emulator keeps per-session state in thread-local variables (see
+// EM_THREAD_LOCAL). Each of these variables is registered with an
+// EmSessionState list next to its definition. An EmSessionContext owns a
+// complete set of these variables and swaps it into the calling thread while
+// it is bound, so the accessors keep their plain TLS loads and sessions are
+// not tied to a thread:
+//
+//     EmSessionContext context;
+//
+//     {
+//         EmSessionContext::Binding binding(context);
+//         gSession->Initialize(...);
+//     }
+//
+//     // later, on any thread of a pool
+//     {
+//         EmSessionContext::Binding binding(context);
+//         gSession->RunEmulation();
+//     }
+//
+// A context can be bound to one thread at a time, and a thread can bind one
+// context at a time. While no context is bound, a thread runs on its own set
+// of variables, as before. Session state must not refer to the address of a
+// thread-local variable, as the address changes when the context moves to
+// another thread.
+
+class EmSessionState {
+   public:
+    struct Variable {
+        size_t size;
+        size_t alignment;
+
+        // The instance of the variable on the calling thread.
+        void* (*access)();
+
+        // Construct a fresh instance in the slot of a context. Trivially
+        // copyable variables are instead initialized from a copy of their
+        // value at registration.
+        void (*construct)(void* slot);
+        void (*destroy)(void* slot);
+        void (*exchange)(void* instance, void* slot);
+
+        vector<uint8> initialValue;
+    };
+
+   public:
+    EmSessionState(std::initializer_list<Variable> variables);
+
+    EmSessionState(const EmSessionState&) = delete;
+    EmSessionState& operator=(const EmSessionState&) = delete;
+
+    template <typename T>
+    static Variable MakeVariable(void* (*access)(), void (*construct)(void*));
+
+    template <typename T>
+    static Variable MakeObject(void* (*access)());
+
+    static const vector<const Variable*>& GetVariables();
+
+   private:
+    template <typename T>
+    static void Destroy(void* slot);
+
+    template <typename T>
+    static void Exchange(void* instance, void* slot);
+
+    template <typename T>
+    static void ConstructObject(void* slot);
+
+    template <typename T>
+    static void DestroyObject(void* slot);
+
+   private:
+    vector<Variable> variables;
+};
+
+// Registers a thread-local variable as session state. The arguments after the
+// variable are passed to the constructor of fresh instances.
+#define EM_SESSION_VARIABLE(variable, ...)                                                \
+    EmSessionState::MakeVariable<std::remove_reference_t<decltype(variable)>>(            \
+        []() -> void* { return &variable; }, [](void* slot) {                             \
+            new (slot) std::remove_reference_t<decltype(variable)>(__VA_ARGS__);          \
+        })
+
+// Registers a thread-local pointer to a singleton object. Every context owns a
+// default constructed instance, and binding the context points the variable to
+// it. The thread-local pointer must be initialized with the address of the
+// thread's own instance.
+#define EM_SESSION_OBJECT(pointer)                                                         \
+    EmSessionState::MakeObject<std::remove_pointer_t<std::remove_reference_t<decltype(pointer)>>>( \
+        []() -> void* { return &pointer; })
+
+class EmSessionContext {
+   public:
+    class Binding {
+       public:
+        explicit Binding(EmSessionContext& context);
+        ~Binding();
+
+        Binding(const Binding&) = delete;
+        Binding& operator=(const Binding&) = delete;
+
+       private:
+        EmSessionContext& context;
+    };
+
+   public:
+    EmSessionContext();
+    ~EmSessionContext();
+
+    EmSessionContext(const EmSessionContext&) = delete;
+    EmSessionContext& operator=(const EmSessionContext&) = delete;
+
+    void Bind();
+    void Unbind();
+    bool IsBound() const { return bound; }
+
+    // The context bound to the calling thread, or nullptr.
+    static EmSessionContext* GetBound();
+
+   private:
+    void Exchange();
+
+   private:
+    unique_ptr<max_align_t[]> storage;
+    vector<size_t> offsets;
+
+    bool bound{false};
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// IMPLEMENTATION
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+EmSessionState::Variable EmSessionState::MakeVariable(void* (*access)(),
+                                                      void (*construct)(void*)) {
+    static_assert(alignof(T) <= alignof(max_align_t), "overaligned session state");
+
+    Variable variable{
+        sizeof(T), alignof(T), access, construct, Destroy<T>, Exchange<T>, {}};
+
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        const uint8* value = static_cast<const uint8*>(access());
+
+        variable.construct = nullptr;
+        variable.initialValue.assign(value, value + sizeof(T));
+    }
+
+    return variable;
+}
+
+template <typename T>
+EmSessionState::Variable EmSessionState::MakeObject(void* (*access)()) {
+    return {sizeof(T*),           alignof(T*), access, ConstructObject<T>, DestroyObject<T>,
+            Exchange<T*>, {}};
+}
+
+template <typename T>
+void EmSessionState::Destroy(void* slot) {
+    static_cast<T*>(slot)->~T();
+}
+
+template <typename T>
+void EmSessionState::Exchange(void* instance, void* slot) {
+    using std::swap;
+
+    swap(*static_cast<T*>(instance), *static_cast<T*>(slot));
+}
+
+template <typename T>
+void EmSessionState::ConstructObject(void* slot) {
+    new (slot) T*(new T());
+}
+
+template <typename T>
+void EmSessionState::DestroyObject(void* slot) {
+    delete *static_cast<T**>(slot);
+}
+
+#endif  // _EM_SESSION_CONTEXT_H_
@@ -13,90 +13,16 @@
 
 #include "EmSubroutine.h"
 
-#include <ctype.h>  // isspace
-
 #include "Byteswapping.h"  // Canonical
 #include "EmBankMapped.h"  // EmBankMapped::GetEmulatedAddress
 #include "EmCPU68K.h"
 #include "EmCommon.h"
 #include "EmMemory.h"       // EmMemPut8, etc.
 #include "EmPalmStructs.h"  // EmAlias
-#include "EmStructs.h"      // StringList
-#include "Miscellaneous.h"  // SeparateList
+#include "EmSubroutineDecl.h"
+#include "Miscellaneous.h"  // StMemoryMapper
 #include "Platform.h"       // Platform::AllocateMemory
 
-static EmParamInfo kEmParamInfo[] = {
-    // These are the base integral types.
-
-    {"Int8", kEm_SI1, false},
-    {"Int16", kEm_SI2, false},
-    {"Int32", kEm_SI4, false},
-    //	{ "Int64",					kEm_SI8,	false },
-
-    {"UInt8", kEm_UI1, false},
-    {"UInt16", kEm_UI2, false},
-    {"UInt32", kEm_UI4, false},
-    //	{ "UInt64",					kEm_UI8,	false },
-
-    //	{ "Float",					kEm_FP4,	false },
-    //	{ "Double",					kEm_FP8,	false },
-    //	{ "LongDouble",				kEm_FP16,	false },
-
-    // These types are synonyms for the simple integral values.
-
-    {"char", kEm_SI1, false},
-    {"short", kEm_SI2, false},
-    {"long", kEm_SI4, false},
-
-    {"Char", kEm_UI1, false},
-    {"WChar", kEm_UI2, false},
-
-    {"Boolean", kEm_UI1, false},
-    {"ClipboardFormatType", kEm_UI1, false},
-    {"DlkSyncStateType", kEm_UI1, false},
-    {"FormObjectKind", kEm_UI1, false},
-    {"LocalIDKind", kEm_UI1, false},
-    {"NetSocketAddrEnum", kEm_UI1, false},
-    {"NetSocketTypeEnum", kEm_UI1, false},
-    {"SystemPreferencesChoice", kEm_UI1, false},
-
-    {"DmResID", kEm_UI2, false},
-    {"Err", kEm_UI2, false},
-    {"HostControlSelectorType", kEm_UI2, false},
-
-    {"Coord", kEm_SI2, false},
-    {"NetSocketRef", kEm_SI2, false},
-
-    {"DmResType", kEm_UI4, false},
-    {"LocalID", kEm_UI4, false},
-    {"NetFDSetType", kEm_UI4, false},
-    {"NetIPAddr", kEm_UI4, false},
-
-    {"HostBoolType", kEm_SI4, false},
-    {"HostClockType", kEm_SI4, false},
-    {"HostErrType", kEm_SI4, false},
-    {"HostIDType", kEm_SI4, false},
-    {"HostPlatformType", kEm_SI4, false},
-    {"HostSignalType", kEm_SI4, false},
-    {"HostSizeType", kEm_SI4, false},
-    {"HostTimeType", kEm_SI4, false},
-
-    // These types are pointer types, but are mostly treated as integral values.
-    // They get pushed onto the stack as a 4-byte value, but the stuff they
-    // point to is not affected or adjusted in any way.  Also, when used as a
-    // return type on the 68K, they are treated as pointers, not integers.
-
-    {"DmOpenRef", kEm_Void, true},
-    {"HostFILEType", kEm_Void, true},
-
-    // The void type can be used as a return type ("void foo (int);"), or as an
-    // empty parameter list ("int foo (void);").  It can also be used as a
-    // generic pointer type ("void foo (void*);").
-
-    {"void", kEm_Void, false}
-
-};
-
 class EmSubroutineCPU {
    public:
     EmSubroutineCPU(void);
@@ -197,38 +123,36 @@ EmSubroutine::~EmSubroutine(void) { delete fCPU; }
 // ---------------------------------------------------------------------------
 
 Err EmSubroutine::DescribeDecl(EmParamDecl returnType, EmParamListDecl decl) {
-    // Determine the return type.
+    // The parser is the same one that handles prototypes at compile time.
+
+    return this->DescribeDecl(EmSubroutineDecl(returnType, decl));
+}
 
-    Err err = this->ParseParamDecl(returnType, fReturnType);
+// ---------------------------------------------------------------------------
+//		� EmSubroutine::DescribeDecl
+// ---------------------------------------------------------------------------
+
+Err EmSubroutine::DescribeDecl(const EmSubroutineDecl& decl) {
 #if ERROR_CHECKING
-    if (err) {
+    if (!decl.IsValid()) {
         this->Reset();
-        return err;
+        return kEmErrUnsupportedType;
     }
 #endif
 
-    // Determine the parameter types.  Start by breaking up the parameter
-    // list at the commas.
+    // Determine the return type.
 
-    StringList paramDecls;
-    ::SeparateList(paramDecls, decl, ',');
+    this->SetParam(decl.GetReturnType(), fReturnType);
 
-    // Iterate over all the stuff we found between the commas.
+    // Determine the parameter types.
 
-    StringList::iterator iter = paramDecls.begin();
-    while (iter != paramDecls.end()) {
-        // For each intra-comma chunk, parse it up and determine the
-        // type and name information it specifies.
+    fParams.reserve(fParams.size() + decl.GetParamCount());
 
-        err = this->AddParam(iter->c_str());
-#if ERROR_CHECKING
-        if (err) {
-            this->Reset();
-            return err;
-        }
-#endif
+    for (size_t i = 0; i < decl.GetParamCount(); i++) {
+        EmParam param;
+        this->SetParam(decl.GetParam(i), param);
 
-        ++iter;
+        fParams.push_back(param);
     }
 
     // After all the parameters have been parsed up, determine where they
@@ -246,16 +170,7 @@ Err EmSubroutine::DescribeDecl(EmParamDecl returnType, EmParamListDecl decl) {
 
 Err EmSubroutine::AddParam(EmParamDecl decl) {
     EmParam param;
-
-#if ERROR_CHECKING
-    Err err = this->ParseParamDecl(decl, param);
-    if (err) {
-        this->Reset();
-        return err;
-    }
-#else
-    this->ParseParamDecl(decl, param);
-#endif
+    this->SetParam(EmSubroutineDecl::ParseParam(decl), param);
 
     // If it's not just a bare "(void)", push it onto our collection
     // of parsed parameter information.
@@ -1524,117 +1439,13 @@ Bool EmSubroutine::Is68K(void) { return true; }
 // ---------------------------------------------------------------------------
 
 // ---------------------------------------------------------------------------
-//		� EmSubroutine::ParseParamDecl
-// ---------------------------------------------------------------------------
-
-Err EmSubroutine::ParseParamDecl(EmParamDecl decl, EmParam& result) {
-    string token;
-    string::size_type offset = 0;
-
-    // Get the type.
-
-    token = this->GetToken(decl, offset);
-
-    // See if we recognize it.
-
-    size_t ii;
-    for (ii = 0; ii < countof(kEmParamInfo); ++ii) {
-        if (token == kEmParamInfo[ii].fTypeName) {
-            result.fType = kEmParamInfo[ii].fType;
-            result.fByRef = kEmParamInfo[ii].fByRef;
-            break;
-        }
-    }
-
-    // If not, try some default processing.
-
-    if (ii >= countof(kEmParamInfo)) {
-        // Set it up as an unknown type.  Hopefully, it will be
-        // followed by a "*", so that we can treat it as a pointer type.
-
-        result.fType = kEm_Unknown;
-        result.fByRef = false;
-
-        // Check the name to see if it ends in "Ptr" or "Handle.  If so,
-        // treat it as a pointer type.
-
-        if (::EndsWith(token.c_str(), "Ptr") || ::EndsWith(token.c_str(), "Handle")) {
-            result.fByRef = true;
-        }
-    }
-
-    // Get what follows the type.  This is either the parameter name,
-    // or a "*" to indicate a reference parameter.
-
-    token = this->GetToken(decl, offset);
-
-    if (token == "*") {
-        result.fByRef = true;
-
-        // OK, *now* get the parameter name.
-
-        token = this->GetToken(decl, offset);
-
-        // Whoops...it's another "*".  So make the param a ptr to a ptr.
-
-        while (token == "*") {
-            result.fType = kEm_Void;
-
-            // OK, *now* get the parameter name.
-
-            token = this->GetToken(decl, offset);
-        }
-    }
-
-    result.fName = token;
-
-    return errNone;
-}
-
-// ---------------------------------------------------------------------------
-//		� EmSubroutine::GetToken
+//		� EmSubroutine::SetParam
 // ---------------------------------------------------------------------------
 
-string EmSubroutine::GetToken(EmParamDecl decl, string::size_type& offset) {
-    string result;
-
-    // Get a C++ string so that we can use the STL routines.
-
-    string str(decl);
-
-    do {
-        // Skip whitespace.
-
-        while (isspace(str[offset])) ++offset;
-
-        // Nothing but whitespace.  This could happen if the
-        // declaration has a type but no name.
-
-        if (offset >= str.size()) {
-            result.erase();
-        }
-
-        // If this is a "*", return it.
-
-        else if (str[offset] == '*') {
-            ++offset;
-            result = "*";
-        }
-
-        // Otherwise, scoop of the identifer
-
-        else {
-            string::size_type begin = offset;
-
-            while (isalnum(str[offset]) || str[offset] == '_') ++offset;
-
-            result = str.substr(begin, offset - begin);
-        }
-
-        // If it's "const", "signed" or "unsigned", filter it out.
-    } while (result == "const" || result == "signed" || result == "unsigned");
-
-    return result;
+void EmSubroutine::SetParam(const EmParamDescriptor& descriptor, EmParam& result) {
+    result.fName.assign(descriptor.fName.data(), descriptor.fName.size());
+    result.fType = descriptor.fType;
+    result.fByRef = descriptor.fByRef;
 }
 
 // ---------------------------------------------------------------------------
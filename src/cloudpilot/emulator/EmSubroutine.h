@@ -234,6 +234,8 @@ struct EmParam {
 typedef vector<EmParam> EmParamList;
 
 class EmSubroutineCPU;
+class EmSubroutineDecl;
+struct EmParamDescriptor;
 
 #define kForCalling true
 #define kForBeingCalled false
@@ -248,6 +250,7 @@ class EmSubroutine {
     VIRTUAL ~EmSubroutine(void);
 
     VIRTUAL Err DescribeDecl(EmParamDecl, EmParamListDecl);
+    VIRTUAL Err DescribeDecl(const EmSubroutineDecl&);
     VIRTUAL Err AddParam(EmParamDecl);
     VIRTUAL Err PrepareStack(Bool forCalling, Bool forStdArgs);
     VIRTUAL Err PrepareStack(emuptr);
@@ -341,8 +344,7 @@ class EmSubroutine {
     EmSubroutineCPU* GetCPU(void);
     Bool Is68K(void);
 
-    Err ParseParamDecl(EmParamDecl, EmParam&);
-    string GetToken(EmParamDecl, string::size_type& offset);
+    void SetParam(const EmParamDescriptor&, EmParam&);
     EmParamList::iterator FindParam(EmParamNameArg);
 
    private:
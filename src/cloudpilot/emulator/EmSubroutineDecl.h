@@ -0,0 +1,259 @@
+#ifndef _EM_SUBROUTINE_DECL_H_
+#define _EM_SUBROUTINE_DECL_H_
+
+#include <string_view>
+
+#include "EmCommon.h"
+#include "EmSubroutine.h"
+
+// A parsed prototype for EmSubroutine. The parser is constexpr, so prototypes
+// that are string literals (as in the CALLED_SETUP and CALLER_SETUP macros)
+// are parsed by the compiler:
+//
+//      static constexpr EmSubroutineDecl decl("Err", "UInt16 refNum, void* bufP");
+//      static_assert(decl.IsValid());
+//
+// The same parser handles prototypes that are only known at runtime. Names
+// refer to the prototype string, so it must outlive the declaration.
+
+inline constexpr EmParamInfo kEmParamInfo[] = {
+    // These are the base integral types.
+
+    {"Int8", kEm_SI1, false},
+    {"Int16", kEm_SI2, false},
+    {"Int32", kEm_SI4, false},
+    //	{ "Int64",					kEm_SI8,	false },
+
+    {"UInt8", kEm_UI1, false},
+    {"UInt16", kEm_UI2, false},
+    {"UInt32", kEm_UI4, false},
+    //	{ "UInt64",					kEm_UI8,	false },
+
+    //	{ "Float",					kEm_FP4,	false },
+    //	{ "Double",					kEm_FP8,	false },
+    //	{ "LongDouble",				kEm_FP16,	false },
+
+    // These types are synonyms for the simple integral values.
+
+    {"char", kEm_SI1, false},
+    {"short", kEm_SI2, false},
+    {"long", kEm_SI4, false},
+
+    {"Char", kEm_UI1, false},
+    {"WChar", kEm_UI2, false},
+
+    {"Boolean", kEm_UI1, false},
+    {"ClipboardFormatType", kEm_UI1, false},
+    {"DlkSyncStateType", kEm_UI1, false},
+    {"FormObjectKind", kEm_UI1, false},
+    {"LocalIDKind", kEm_UI1, false},
+    {"NetSocketAddrEnum", kEm_UI1, false},
+    {"NetSocketTypeEnum", kEm_UI1, false},
+    {"SystemPreferencesChoice", kEm_UI1, false},
+
+    {"DmResID", kEm_UI2, false},
+    {"Err", kEm_UI2, false},
+    {"HostControlSelectorType", kEm_UI2, false},
+
+    {"Coord", kEm_SI2, false},
+    {"NetSocketRef", kEm_SI2, false},
+
+    {"DmResType", kEm_UI4, false},
+    {"LocalID", kEm_UI4, false},
+    {"NetFDSetType", kEm_UI4, false},
+    {"NetIPAddr", kEm_UI4, false},
+
+    {"HostBoolType", kEm_SI4, false},
+    {"HostClockType", kEm_SI4, false},
+    {"HostErrType", kEm_SI4, false},
+    {"HostIDType", kEm_SI4, false},
+    {"HostPlatformType", kEm_SI4, false},
+    {"HostSignalType", kEm_SI4, false},
+    {"HostSizeType", kEm_SI4, false},
+    {"HostTimeType", kEm_SI4, false},
+
+    // These types are pointer types, but are mostly treated as integral values.
+    // They get pushed onto the stack as a 4-byte value, but the stuff they
+    // point to is not affected or adjusted in any way.  Also, when used as a
+    // return type on the 68K, they are treated as pointers, not integers.
+
+    {"DmOpenRef", kEm_Void, true},
+    {"HostFILEType", kEm_Void, true},
+
+    // The void type can be used as a return type ("void foo (int);"), or as an
+    // empty parameter list ("int foo (void);").  It can also be used as a
+    // generic pointer type ("void foo (void*);").
+
+    {"void", kEm_Void, false}
+
+};
+
+struct EmParamDescriptor {
+    string_view fName{};
+    EmParamType fType{kEm_Void};
+    Bool fByRef{false};
+};
+
+class EmSubroutineDecl {
+   public:
+    static constexpr size_t kMaxParams = 16;
+    static constexpr size_t kNotFound = ~static_cast<size_t>(0);
+
+   public:
+    constexpr EmSubroutineDecl(string_view returnDecl, string_view paramListDecl)
+        : fReturnType(ParseParam(returnDecl)) {
+        // Break up the parameter list at the commas.
+
+        size_t begin = 0;
+
+        while (begin <= paramListDecl.size()) {
+            size_t end = paramListDecl.find(',', begin);
+            if (end == string_view::npos) end = paramListDecl.size();
+
+            string_view chunk = paramListDecl.substr(begin, end - begin);
+            EmParamDescriptor param = ParseParam(chunk);
+
+            // Skip empty lists and a bare "(void)".
+
+            if (!IsBlank(chunk) && (param.fByRef || param.fType != kEm_Void)) {
+                if (fParamCount == kMaxParams) {
+                    fValid = false;
+                    break;
+                }
+
+                fParams[fParamCount++] = param;
+            }
+
+            begin = end + 1;
+        }
+    }
+
+    constexpr bool IsValid() const { return fValid; }
+
+    constexpr const EmParamDescriptor& GetReturnType() const { return fReturnType; }
+    constexpr size_t GetParamCount() const { return fParamCount; }
+    constexpr const EmParamDescriptor& GetParam(size_t index) const { return fParams[index]; }
+
+    constexpr size_t IndexOf(string_view name) const {
+        for (size_t i = 0; i < fParamCount; i++)
+            if (fParams[i].fName == name) return i;
+
+        return kNotFound;
+    }
+
+    static constexpr EmParamDescriptor ParseParam(string_view decl) {
+        EmParamDescriptor result;
+        size_t offset = 0;
+
+        // Get the type and see if we recognize it.
+
+        string_view token = GetToken(decl, offset);
+        bool found = false;
+
+        for (const auto& info : kEmParamInfo) {
+            if (token == info.fTypeName) {
+                result.fType = info.fType;
+                result.fByRef = info.fByRef;
+                found = true;
+
+                break;
+            }
+        }
+
+        // If not, set it up as an unknown type.  Hopefully, it will be
+        // followed by a "*", so that we can treat it as a pointer type.
+        // Names that end in "Ptr" or "Handle" are treated as pointers as well.
+
+        if (!found) {
+            result.fType = kEm_Unknown;
+            result.fByRef = EndsWith(token, "Ptr") || EndsWith(token, "Handle");
+        }
+
+        // Get what follows the type.  This is either the parameter name,
+        // or a "*" to indicate a reference parameter.
+
+        token = GetToken(decl, offset);
+
+        if (token == "*") {
+            result.fByRef = true;
+            token = GetToken(decl, offset);
+
+            // Another "*" makes the param a ptr to a ptr.
+
+            while (token == "*") {
+                result.fType = kEm_Void;
+                token = GetToken(decl, offset);
+            }
+        }
+
+        result.fName = token;
+
+        return result;
+    }
+
+   private:
+    static constexpr bool IsWhitespace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    static constexpr bool IsBlank(string_view str) {
+        for (char c : str)
+            if (!IsWhitespace(c)) return false;
+
+        return true;
+    }
+
+    static constexpr bool IsIdentifierChar(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+               c == '_';
+    }
+
+    static constexpr char ToLowerAscii(char c) {
+        return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+    }
+
+    static constexpr bool EndsWith(string_view str, string_view suffix) {
+        if (str.size() < suffix.size()) return false;
+
+        const size_t offset = str.size() - suffix.size();
+
+        for (size_t i = 0; i < suffix.size(); i++)
+            if (ToLowerAscii(str[offset + i]) != ToLowerAscii(suffix[i])) return false;
+
+        return true;
+    }
+
+    static constexpr string_view GetToken(string_view decl, size_t& offset) {
+        string_view result;
+
+        do {
+            while (offset < decl.size() && IsWhitespace(decl[offset])) ++offset;
+
+            if (offset >= decl.size()) {
+                // Nothing but whitespace.  This could happen if the
+                // declaration has a type but no name.
+
+                result = string_view();
+            } else if (decl[offset] == '*') {
+                result = decl.substr(offset++, 1);
+            } else {
+                size_t begin = offset;
+                while (offset < decl.size() && IsIdentifierChar(decl[offset])) ++offset;
+
+                result = decl.substr(begin, offset - begin);
+            }
+
+            // If it's "const", "signed" or "unsigned", filter it out.
+        } while (result == "const" || result == "signed" || result == "unsigned");
+
+        return result;
+    }
+
+   private:
+    EmParamDescriptor fReturnType;
+    EmParamDescriptor fParams[kMaxParams]{};
+    size_t fParamCount{0};
+    bool fValid{true};
+};
+
+#endif  // _EM_SUBROUTINE_DECL_H_
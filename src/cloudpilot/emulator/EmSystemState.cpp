@@ -1,12 +1,22 @@
 #include "EmSystemState.h"
 
 #include "ChunkHelper.h"
+#include "EmSession.h"
+#include "EmSessionContext.h"
 #include "Logging.h"
 #include "Savestate.h"
 #include "SavestateLoader.h"
 #include "SavestateProbe.h"
 
-EmSystemState gSystemState;
+namespace {
+    thread_local EmSystemState systemState;
+}  // namespace
+
+thread_local EmSystemState* gSystemState{&systemState};
+
+namespace {
+    const EmSessionState sessionState{EM_SESSION_OBJECT(gSystemState)};
+}  // namespace
 
 namespace {
     constexpr uint32 SAVESTATE_VERSION = 2;
@@ -102,6 +112,8 @@ const string& EmSystemState::GetHotsyncUserName() const { return hotsyncUserName
 bool EmSystemState::IsScreenDirty() const { return screenState != ScreenState::clean; }
 
 void EmSystemState::MarkScreenClean() {
+    if (screenState != ScreenState::clean) gSession->GetStats().CountScreenUpdate();
+
     screenState = ScreenState::clean;
     screenLowWatermark = screenHighWatermark = 0;
 
@@ -113,3 +125,21 @@ emuptr EmSystemState::GetScreenLowWatermark() const { return screenLowWatermark;
 bool EmSystemState::ScreenRequiresFullRefresh() const {
     return screenState == ScreenState::needsFullRefresh;
 }
+
+void EmSystemState::SetScreenGeometry(emuptr baseAddr, uint32 rowBytes) {
+    if (ScreenGeometryMatches(baseAddr, rowBytes)) return;
+
+    screenBase = baseAddr;
+    screenRowBytes = rowBytes;
+
+    // Columns recorded so far refer to the old geometry
+    screenLowColumn = 0;
+    screenHighColumn = rowBytes > 0 ? rowBytes - 1 : 0;
+}
+
+bool EmSystemState::ScreenGeometryMatches(emuptr baseAddr, uint32 rowBytes) const {
+    return screenBase == baseAddr && screenRowBytes == rowBytes;
+}
+
+uint32 EmSystemState::GetScreenLowColumn() const { return screenLowColumn; }
+uint32 EmSystemState::GetScreenHighColumn() const { return screenHighColumn; }
@@ -42,6 +42,14 @@ class EmSystemState {
     emuptr GetScreenHighWatermark() const;
     emuptr GetScreenLowWatermark() const;
 
+    // Screen writes are also tracked by their offset within a row of the framebuffer,
+    // relative to the base address and row size given here.
+    void SetScreenGeometry(emuptr baseAddr, uint32 rowBytes);
+    bool ScreenGeometryMatches(emuptr baseAddr, uint32 rowBytes) const;
+
+    uint32 GetScreenLowColumn() const;
+    uint32 GetScreenHighColumn() const;
+
    public:
     EmEvent<> onMarkScreenClean;
 
@@ -49,6 +57,8 @@ class EmSystemState {
     template <typename T>
     void DoSaveLoad(T& helper, uint32 version);
 
+    inline void UpdateScreenColumns(emuptr addressLo, emuptr addressHi);
+
    private:
     enum class ScreenState : uint8 { clean, dirty, needsFullRefresh };
 
@@ -62,9 +72,14 @@ class EmSystemState {
     ScreenState screenState;
     emuptr screenHighWatermark;
     emuptr screenLowWatermark;
+
+    emuptr screenBase{0};
+    uint32 screenRowBytes{0};
+    uint32 screenLowColumn{0};
+    uint32 screenHighColumn{0};
 };
 
-extern EmSystemState gSystemState;
+extern thread_local EmSystemState* gSystemState;
 
 ///////////////////////////////////////////////////////////////////////////////
 // IMPLEMENTATION
@@ -79,8 +94,42 @@ inline void EmSystemState::MarkScreenDirty(emuptr addressLo, emuptr addressHi) {
     } else if (screenState == ScreenState::clean) {
         screenLowWatermark = addressLo;
         screenHighWatermark = addressHi;
+        screenLowColumn = 0xffffffff;
+        screenHighColumn = 0;
         screenState = ScreenState::dirty;
+    } else {
+        return;
+    }
+
+    if (screenRowBytes > 0) UpdateScreenColumns(addressLo, addressHi);
+}
+
+inline void EmSystemState::UpdateScreenColumns(emuptr addressLo, emuptr addressHi) {
+    if (screenLowColumn == 0 && screenHighColumn == screenRowBytes - 1) return;
+
+    if (addressLo < screenBase) {
+        screenLowColumn = 0;
+        screenHighColumn = screenRowBytes - 1;
+
+        return;
+    }
+
+    // Word and long writes pass the address past their last byte as addressHi
+    const uint32 columnLo = (addressLo - screenBase) % screenRowBytes;
+    uint32 columnHi = columnLo + (addressHi - addressLo);
+
+    if (columnHi == screenRowBytes) columnHi--;
+
+    // The write wraps around into the next row
+    if (columnHi > screenRowBytes) {
+        screenLowColumn = 0;
+        screenHighColumn = screenRowBytes - 1;
+
+        return;
     }
+
+    if (columnLo < screenLowColumn) screenLowColumn = columnLo;
+    if (columnHi > screenHighColumn) screenHighColumn = columnHi;
 }
 
 #endif  // _EM_SYSTEM_STATE_H_
@@ -130,9 +130,23 @@ int EmThreadSafeQueue<T>::GetMaxSize(void) {
     return fMaxSize;
 }
 
+// ---------------------------------------------------------------------------
+//		� EmThreadSafeQueue::Swap
+// ---------------------------------------------------------------------------
+
+template <class T>
+void EmThreadSafeQueue<T>::Swap(EmThreadSafeQueue& other) {
+    EmAssert(fMaxSize == other.fMaxSize);
+
+#ifdef EM_THREADS
+    scoped_lock lock(fMutex, other.fMutex);
+#endif
+
+    fContainer.swap(other.fContainer);
+}
+
 // Instantiate the ones we want.
 
-template class EmThreadSafeQueue<uint8>;
 template class EmThreadSafeQueue<PenEvent>;
 template class EmThreadSafeQueue<KeyboardEvent>;
 template class EmThreadSafeQueue<ButtonEvent>;
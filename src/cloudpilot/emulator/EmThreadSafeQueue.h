@@ -37,6 +37,11 @@ class EmThreadSafeQueue {
     void Clear(void);
     int GetMaxSize(void);
 
+    // Exchanges the contents of two queues of the same size.
+    void Swap(EmThreadSafeQueue& other);
+
+    friend void swap(EmThreadSafeQueue& a, EmThreadSafeQueue& b) { a.Swap(b); }
+
    private:
     deque<T> fContainer;
     const int fMaxSize;
@@ -46,6 +51,4 @@ class EmThreadSafeQueue {
 #endif
 };
 
-typedef EmThreadSafeQueue<uint8> EmByteQueue;
-
 #endif  // EmThreadSafeQueue_h
@@ -48,4 +48,17 @@ typedef int32 EmCoord;
 #define EmMemNULL ((emuptr)0)
 #define EmMemEOM ((emuptr)0xFFFFFFFF)
 
+// Storage class for per-session emulator state. Unlike thread_local, __thread
+// never requires dynamic initialization, so accesses compile to a plain TLS
+// load without an init wrapper, and it can be shared with the C parts of UAE.
+// Objects with constructors must use thread_local instead.
+//
+// Every per-session variable must be registered with an EmSessionState (see
+// EmSessionContext.h), so a session can be bound to any thread of a pool.
+// Per-call scratch buffers that do not outlive a call are the exception. Every
+// thread in the process reserves the static TLS block, so large per-session
+// tables must be allocated on the heap and only be referenced from TLS.
+
+#define EM_THREAD_LOCAL __thread
+
 #endif  // EmTypes_h
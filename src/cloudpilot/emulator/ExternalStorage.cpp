@@ -1,12 +1,21 @@
 #include "ExternalStorage.h"
 
 #include "ChunkHelper.h"
+#include "EmSessionContext.h"
 #include "EmSPISlaveSD.h"
 #include "Savestate.h"
 #include "SavestateLoader.h"
 #include "SavestateProbe.h"
 
-ExternalStorage gExternalStorage;
+namespace {
+    thread_local ExternalStorage externalStorage;
+}  // namespace
+
+thread_local ExternalStorage* gExternalStorage{&externalStorage};
+
+namespace {
+    const EmSessionState sessionState{EM_SESSION_OBJECT(gExternalStorage)};
+}  // namespace
 
 namespace {
     constexpr uint32 SAVESTATE_VERSION = 1;
@@ -27,6 +36,14 @@ bool ExternalStorage::AddImage(const string& key, uint8* imageData, size_t size)
     return true;
 }
 
+bool ExternalStorage::AddImage(const string& key, unique_ptr<CardImage> image) {
+    if (key.length() > MAX_KEY_LENGTH || !image || HasImage(key)) return false;
+
+    images.emplace(key, move(image));
+
+    return true;
+}
+
 bool ExternalStorage::Mount(const string& key, EmHAL::Slot slot) {
     if (slot == EmHAL::Slot::none || IsMounted(slot) || !HasImage(key) ||
         GetSlot(key) != EmHAL::Slot::none || !EmHAL::SupportsImageInSlot(slot, *images.at(key)))
@@ -50,6 +67,9 @@ bool ExternalStorage::Mount(const string& key) {
 bool ExternalStorage::Unmount(EmHAL::Slot slot) {
     if (!IsMounted(slot)) return false;
 
+    if (!slots[static_cast<uint8>(slot)]->image.Sync())
+        logging::printf("failed to sync card image on unmount");
+
     slots[static_cast<uint8>(slot)].reset();
     EmHAL::Unmount(slot);
 
@@ -70,6 +90,8 @@ void ExternalStorage::Remount() {
 
         if (key.empty()) continue;
 
+        if (!HasImage(key) && keyResolver) keyResolver(key);
+
         if (!HasImage(key)) {
             EmHAL::Unmount(static_cast<EmHAL::Slot>(slot));
             remountFailed = true;
@@ -120,6 +142,8 @@ void ExternalStorage::RekeyImage(string oldKey, string newKey) {
         if (slot && slot->key == oldKey) slot->key = newKey;
 }
 
+void ExternalStorage::SetKeyResolver(key_resolver_t resolver) { keyResolver = resolver; }
+
 bool ExternalStorage::RemoveImage(const string& key) {
     if (!HasImage(key)) return false;
 
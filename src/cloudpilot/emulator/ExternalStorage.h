@@ -1,6 +1,7 @@
 #ifndef _EXTERNAL_STORAGE_H_
 #define _EXTERNAL_STORAGE_H_
 
+#include <functional>
 #include <memory>
 #include <unordered_map>
 
@@ -16,6 +17,10 @@ class ExternalStorage {
    public:
     static constexpr size_t MAX_KEY_LENGTH = 32;
 
+    // Called by Remount for keys from the savestate that are not registered.
+    // The resolver may register (or rekey) an image under that key.
+    using key_resolver_t = function<void(const string& key)>;
+
    public:
     ExternalStorage() = default;
 
@@ -26,6 +31,7 @@ class ExternalStorage {
     bool HasImage(const string& key) const;
     CardImage* GetImage(const string& key);
     bool AddImage(const string& key, uint8* imageData, size_t size);
+    bool AddImage(const string& key, unique_ptr<CardImage> image);
 
     bool Mount(const string& key, EmHAL::Slot slot);
     bool Mount(const string& key);
@@ -41,6 +47,7 @@ class ExternalStorage {
     string GetImageKeyInSlot(EmHAL::Slot slot);
 
     void RekeyImage(string oldKey, string newKey);
+    void SetKeyResolver(key_resolver_t resolver);
 
     bool RemoveImage(const string& key);
     void UnmountAll();
@@ -67,6 +74,8 @@ class ExternalStorage {
     string mountedKeysFromSavestate[static_cast<int>(EmHAL::MAX_SLOT) + 1];
     bool remountFailed{false};
 
+    key_resolver_t keyResolver;
+
    private:
     ExternalStorage(const ExternalStorage&) = delete;
     ExternalStorage(ExternalStorage&&) = delete;
@@ -74,6 +83,6 @@ class ExternalStorage {
     ExternalStorage& operator=(ExternalStorage&&) = delete;
 };
 
-extern ExternalStorage gExternalStorage;
+extern thread_local ExternalStorage* gExternalStorage;
 
 #endif  // _EXTERNAL_STORAGE_H_
@@ -1,11 +1,16 @@
 #include "Feature.h"
 
+#include "EmSessionContext.h"
 #include "SuspendContext.h"
 #include "SuspendManager.h"
 
-bool Feature::clipboardIntegration{false};
-bool Feature::networkRedirection{false};
-bool Feature::hotsyncNameManagement{true};
+EM_THREAD_LOCAL bool Feature::clipboardIntegration{false};
+EM_THREAD_LOCAL bool Feature::networkRedirection{false};
+EM_THREAD_LOCAL bool Feature::hotsyncNameManagement{true};
+
+const EmSessionState Feature::sessionState{EM_SESSION_VARIABLE(clipboardIntegration),
+                                           EM_SESSION_VARIABLE(networkRedirection),
+                                           EM_SESSION_VARIABLE(hotsyncNameManagement)};
 
 void Feature::SetClipboardIntegration(bool toggle) {
     clipboardIntegration = toggle;
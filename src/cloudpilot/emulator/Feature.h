@@ -1,6 +1,10 @@
 #ifndef _FEATURE_H_
 #define _FEATURE_H_
 
+#include "EmTypes.h"
+
+class EmSessionState;
+
 class Feature {
    public:
     static void SetClipboardIntegration(bool toggle);
@@ -16,9 +20,11 @@ class Feature {
     static bool GetHotsyncNameManagement();
 
    private:
-    static bool clipboardIntegration;
-    static bool networkRedirection;
-    static bool hotsyncNameManagement;
+    static EM_THREAD_LOCAL bool clipboardIntegration;
+    static EM_THREAD_LOCAL bool networkRedirection;
+    static EM_THREAD_LOCAL bool hotsyncNameManagement;
+
+    static const EmSessionState sessionState;
 };
 
 #endif  // _FEATURE_H_
@@ -9,6 +9,8 @@ Frame::Frame(size_t bufferSize)
 
 uint8* Frame::GetBuffer() { return buffer.get(); }
 
+const uint8* Frame::GetBuffer() const { return buffer.get(); }
+
 size_t Frame::GetBufferSize() const { return bufferSize; }
 
 uint8 Frame::GetBpp() const { return bpp; }
@@ -25,16 +27,26 @@ uint32 Frame::GetFirstDirtyLine() const { return firstDirtyLine; }
 
 uint32 Frame::GetLastDirtyLine() const { return lastDirtyLine; }
 
+uint32 Frame::GetFirstDirtyColumn() const { return firstDirtyColumn; }
+
+uint32 Frame::GetLastDirtyColumn() const { return lastDirtyColumn; }
+
 bool Frame::GetHasChanges() const { return hasChanges; }
 
 uint8 Frame::GetScaleX() const { return scaleX; }
 
 uint8 Frame::GetScaleY() const { return scaleY; }
 
-void Frame::UpdateDirtyLines(const EmSystemState& systemState, emuptr baseAddr, uint32 rowBytes,
+void Frame::UpdateDirtyLines(EmSystemState& systemState, emuptr baseAddr, uint32 rowBytes,
                              bool fullRefresh, bool dirtyRegionIsVertical) {
     this->dirtyRegionIsVertical = dirtyRegionIsVertical;
 
+    const bool geometryMatches = systemState.ScreenGeometryMatches(baseAddr, rowBytes);
+    systemState.SetScreenGeometry(baseAddr, rowBytes);
+
+    dirtyBytesKnown = false;
+    ResetDirtyColumns();
+
     if (!systemState.IsScreenDirty() && !fullRefresh) {
         hasChanges = false;
         return;
@@ -60,6 +72,24 @@ void Frame::UpdateDirtyLines(const EmSystemState& systemState, emuptr baseAddr,
         min((max(systemState.GetScreenLowWatermark(), baseAddr) - baseAddr) / rowBytes, maxLine);
 
     lastDirtyLine = min((systemState.GetScreenHighWatermark() - baseAddr) / rowBytes, maxLine);
+
+    if (geometryMatches && !dirtyRegionIsVertical &&
+        systemState.GetScreenLowColumn() <= systemState.GetScreenHighColumn()) {
+        dirtyBytesKnown = true;
+        dirtyBytesLow = systemState.GetScreenLowColumn();
+        dirtyBytesHigh = systemState.GetScreenHighColumn();
+    }
+}
+
+void Frame::UpdateDirtyColumns(uint8 bpp, uint32 margin) {
+    if (!dirtyBytesKnown || lineWidth == 0) return;
+
+    // Framebuffers may be word swapped, so widen the range to full words.
+    const uint32 firstPixel = ((dirtyBytesLow & ~1) * 8) / bpp;
+    const uint32 lastPixel = (((dirtyBytesHigh | 1) + 1) * 8) / bpp - 1;
+
+    firstDirtyColumn = firstPixel > margin ? min(firstPixel - margin, lineWidth - 1) : 0;
+    lastDirtyColumn = lastPixel > margin ? min(lastPixel - margin, lineWidth - 1) : 0;
 }
 
 void Frame::FlipDirtyRegion() {
@@ -70,9 +100,22 @@ void Frame::FlipDirtyRegion() {
     lastDirtyLine = tmp;
 }
 
+void Frame::FlipDirtyColumns() {
+    const uint32 tmp = lineWidth - 1 - firstDirtyColumn;
+    firstDirtyColumn = lineWidth - 1 - lastDirtyColumn;
+    lastDirtyColumn = tmp;
+}
+
 void Frame::ResetDirtyRegion(bool dirtyRegionIsVertical) {
     this->dirtyRegionIsVertical = dirtyRegionIsVertical;
 
     firstDirtyLine = 0;
     lastDirtyLine = lines - 1;
+
+    ResetDirtyColumns();
+}
+
+void Frame::ResetDirtyColumns() {
+    firstDirtyColumn = 0;
+    lastDirtyColumn = lineWidth > 0 ? lineWidth - 1 : 0;
 }
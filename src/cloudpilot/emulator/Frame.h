@@ -21,11 +21,14 @@ struct Frame {
     bool dirtyRegionIsVertical{false};
     uint32 firstDirtyLine{0};
     uint32 lastDirtyLine{0};
+    uint32 firstDirtyColumn{0};
+    uint32 lastDirtyColumn{0};
 
     uint8 scaleX{0};
     uint8 scaleY{0};
 
     uint8* GetBuffer();
+    const uint8* GetBuffer() const;
     size_t GetBufferSize() const;
 
     // using getters in the autogenerated IDL wrapper causes Safari to crash on iOS,
@@ -38,21 +41,36 @@ struct Frame {
 
     uint32 GetFirstDirtyLine() const;
     uint32 GetLastDirtyLine() const;
+    uint32 GetFirstDirtyColumn() const;
+    uint32 GetLastDirtyColumn() const;
     bool GetHasChanges() const;
 
     uint8 GetScaleX() const;
     uint8 GetScaleY() const;
 
-    void UpdateDirtyLines(const EmSystemState& systemState, emuptr baseAddr, uint32 rowBytes,
+    void UpdateDirtyLines(EmSystemState& systemState, emuptr baseAddr, uint32 rowBytes,
                           bool fullRefresh, bool dirtyRegionIsVertical = false);
 
+    // Narrows the dirty columns down to the pixels that were actually written. Must be called
+    // after UpdateDirtyLines, bpp and margin (in pixels) describe the source framebuffer.
+    // The columns span the full line if the written pixels are unknown.
+    void UpdateDirtyColumns(uint8 bpp, uint32 margin = 0);
+
     void FlipDirtyRegion();
+    void FlipDirtyColumns();
     void ResetDirtyRegion(bool dirtyRegionIsVertical = false);
 
+   private:
+    void ResetDirtyColumns();
+
    private:
     const unique_ptr<uint8[]> buffer;
     const size_t bufferSize;
 
+    bool dirtyBytesKnown{false};
+    uint32 dirtyBytesLow{0};
+    uint32 dirtyBytesHigh{0};
+
     Frame(const Frame&) = delete;
     Frame(Frame&&) = delete;
 
@@ -0,0 +1,117 @@
+#include "FrameConverter.h"
+
+#include <cstring>
+
+#include "Frame.h"
+
+namespace {
+    template <int bpp>
+    void convertLine(const uint8* src, uint32 margin, uint32 width, uint32* dest,
+                     const uint32* table) {
+        constexpr uint32 pixelsPerByte = 8 / bpp;
+
+        src += margin / pixelsPerByte;
+        const uint32 skip = margin % pixelsPerByte;
+
+        if (skip > 0 && width > 0) {
+            const uint32 count = min(pixelsPerByte - skip, width);
+
+            memcpy(dest, table + *(src++) * pixelsPerByte + skip, count * 4);
+            dest += count;
+            width -= count;
+        }
+
+        for (; width >= pixelsPerByte; width -= pixelsPerByte) {
+            memcpy(dest, table + *(src++) * pixelsPerByte, 4 * pixelsPerByte);
+            dest += pixelsPerByte;
+        }
+
+        if (width > 0) memcpy(dest, table + *src * pixelsPerByte, width * 4);
+    }
+
+    template <int bpp>
+    void convertLines(const Frame& frame, uint32* dest, uint32 pitch, const uint32* table) {
+        const uint8* buffer = frame.GetBuffer();
+        const uint32 columns = frame.lastDirtyColumn - frame.firstDirtyColumn + 1;
+
+        dest += frame.firstDirtyColumn;
+
+        for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
+            convertLine<bpp>(buffer + y * frame.bytesPerLine, frame.margin + frame.firstDirtyColumn,
+                             columns, dest, table);
+            dest += pitch;
+        }
+    }
+}  // namespace
+
+void FrameConverter::SetPalette(const uint32* palette) {
+    if (memcmp(this->palette, palette, sizeof(this->palette)) == 0) return;
+
+    memcpy(this->palette, palette, sizeof(this->palette));
+
+    table1bppValid = table2bppValid = table4bppValid = false;
+}
+
+void FrameConverter::Convert(const Frame& frame, uint32* dest, uint32 pitch, uint16 mapping2bpp) {
+    switch (frame.bpp) {
+        case 1:
+            if (!table1bppValid) UpdateTable1bpp();
+
+            convertLines<1>(frame, dest, pitch, table1bpp);
+            break;
+
+        case 2:
+            if (!table2bppValid || table2bppMapping != mapping2bpp) UpdateTable2bpp(mapping2bpp);
+
+            convertLines<2>(frame, dest, pitch, table2bpp);
+            break;
+
+        case 4:
+            if (!table4bppValid) UpdateTable4bpp();
+
+            convertLines<4>(frame, dest, pitch, table4bpp);
+            break;
+
+        case 24: {
+            const uint8* buffer = frame.GetBuffer();
+            const uint32 offset = 4 * (frame.margin + frame.firstDirtyColumn);
+            const uint32 columns = frame.lastDirtyColumn - frame.firstDirtyColumn + 1;
+
+            dest += frame.firstDirtyColumn;
+
+            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
+                memcpy(dest, buffer + y * frame.bytesPerLine + offset, 4 * columns);
+                dest += pitch;
+            }
+        } break;
+    }
+}
+
+void FrameConverter::UpdateTable1bpp() {
+    for (uint32 byte = 0; byte < 256; byte++)
+        for (uint32 i = 0; i < 8; i++)
+            table1bpp[8 * byte + i] = (byte & (0x80 >> i)) ? palette[15] : palette[0];
+
+    table1bppValid = true;
+}
+
+void FrameConverter::UpdateTable2bpp(uint16 mapping) {
+    for (uint32 byte = 0; byte < 256; byte++)
+        for (uint32 i = 0; i < 4; i++) {
+            const uint8 pixel = (byte >> (6 - 2 * i)) & 0x03;
+
+            table2bpp[4 * byte + i] = palette[(mapping >> (4 * pixel)) & 0x0f];
+        }
+
+    table2bppMapping = mapping;
+    table2bppValid = true;
+}
+
+void FrameConverter::UpdateTable4bpp() {
+    for (uint32 byte = 0; byte < 256; byte++) {
+        table4bpp[2 * byte] = palette[byte >> 4];
+        table4bpp[2 * byte + 1] = palette[byte & 0x0f];
+    }
+
+    table4bppValid = true;
+}
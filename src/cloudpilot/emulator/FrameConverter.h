@@ -0,0 +1,52 @@
+#ifndef _FRAME_CONVERTER_H_
+#define _FRAME_CONVERTER_H_
+
+#include "EmCommon.h"
+
+struct Frame;
+
+// Expands 1, 2 and 4 bpp frames to 32 bit pixels. The converter is agnostic of
+// the pixel format: the native frontend feeds it an ABGR8888 palette, the web
+// frontend an RGBA palette.
+//
+// Instead of extracting and looking up each pixel individually, every source
+// byte is expanded through a table that holds the 8, 4 or 2 pixels it decodes
+// to, so the conversion is table-driven and the inner loop boils down to a
+// single fixed size 32, 16 or 8 byte copy per byte. The tables are rebuilt
+// lazily after the palette or the 2bpp mapping changed.
+
+class FrameConverter {
+   public:
+    static constexpr size_t PALETTE_SIZE = 16;
+
+   public:
+    FrameConverter() = default;
+
+    // A palette of 16 grays. Entry 0 is used for cleared and entry 15 for set
+    // pixels in 1bpp mode.
+    void SetPalette(const uint32* palette);
+
+    // Converts the dirty rectangle of the frame. The first dirty line is written
+    // to dest, subsequent lines are pitch pixels apart. Pixels keep their column,
+    // so clean columns are left untouched. 24bpp frames are copied.
+    void Convert(const Frame& frame, uint32* dest, uint32 pitch, uint16 mapping2bpp);
+
+   private:
+    void UpdateTable1bpp();
+    void UpdateTable2bpp(uint16 mapping);
+    void UpdateTable4bpp();
+
+   private:
+    uint32 palette[PALETTE_SIZE]{0};
+
+    bool table1bppValid{false};
+    bool table2bppValid{false};
+    bool table4bppValid{false};
+    uint16 table2bppMapping{0};
+
+    alignas(16) uint32 table1bpp[256 * 8];
+    alignas(16) uint32 table2bpp[256 * 4];
+    alignas(16) uint32 table4bpp[256 * 2];
+};
+
+#endif  // _FRAME_CONVERTER_H_
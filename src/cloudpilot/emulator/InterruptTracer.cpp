@@ -0,0 +1,338 @@
+#include "InterruptTracer.h"
+#include "EmSessionContext.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <set>
+
+namespace {
+    thread_local InterruptTracer interruptTracer;
+}  // namespace
+
+thread_local InterruptTracer* gInterruptTracer{&interruptTracer};
+
+namespace {
+    const EmSessionState sessionState{EM_SESSION_OBJECT(gInterruptTracer)};
+}  // namespace
+
+namespace {
+    constexpr uint64 NOT_ACCEPTED = ~0ull;
+
+    constexpr uint32 HANDLER_TRACK_BASE = 1;
+    constexpr uint32 SOURCE_TRACK_BASE = 100;
+
+    string escapeJson(const string& str) {
+        string escaped;
+
+        for (char c : str) {
+            if (c == '"' || c == '\\') escaped.push_back('\\');
+            escaped.push_back(c);
+        }
+
+        return escaped;
+    }
+}  // namespace
+
+void InterruptTracer::Histogram::Add(uint64 value) {
+    size_t bucket = 0;
+    while (bucket < BUCKETS - 1 && (value >> bucket) > 0) bucket++;
+
+    buckets[bucket]++;
+    count++;
+    total += value;
+    max = std::max(max, value);
+}
+
+uint64 InterruptTracer::Histogram::Percentile(double percentile) const {
+    if (count == 0) return 0;
+
+    const uint64 threshold = ceil(percentile / 100. * count);
+    uint64 accumulated = 0;
+
+    for (size_t i = 0; i < BUCKETS; i++) {
+        accumulated += buckets[i];
+
+        if (accumulated >= threshold) return i == 0 ? 0 : std::min<uint64>(max, (1ull << i) - 1);
+    }
+
+    return max;
+}
+
+double InterruptTracer::Histogram::Mean() const {
+    return count == 0 ? 0 : static_cast<double>(total) / count;
+}
+
+void InterruptTracer::Start(size_t capacity) {
+    if (capacity == 0) capacity = DEFAULT_CAPACITY;
+
+    if (buffer.size() != capacity) Clear();
+    buffer.resize(capacity);
+
+    running = true;
+}
+
+void InterruptTracer::Stop() {
+    running = false;
+    activeLevels.clear();
+}
+
+void InterruptTracer::Clear() {
+    head = 0;
+    size = 0;
+    dropped = 0;
+
+    status = 0;
+    activeLevels.clear();
+}
+
+void InterruptTracer::UpdateStatus(uint64 cycles, uint32 status, const char* const* sourceNames) {
+    if (!running) return;
+
+    this->sourceNames = sourceNames;
+
+    const uint32 changed = status ^ this->status;
+    this->status = status;
+
+    if (changed == 0) return;
+
+    for (uint8 source = 0; source < SOURCE_COUNT; source++) {
+        if ((changed & (1u << source)) == 0) continue;
+
+        Push(cycles, (status & (1u << source)) ? Event::raise : Event::clear, source);
+    }
+}
+
+void InterruptTracer::Accept(uint64 cycles, int32 level) {
+    if (!running || level < 1 || level > 7) return;
+
+    // A handler on this level or above can only have been left without its
+    // mask dropping below its level if the CPU was reset.
+    while (!activeLevels.empty() && activeLevels.back() >= level) activeLevels.pop_back();
+
+    activeLevels.push_back(level);
+    Push(cycles, Event::accept, level);
+}
+
+bool InterruptTracer::CheckComplete(uint64 cycles, int32 intmask) {
+    if (!running) return false;
+
+    while (!activeLevels.empty() && intmask < activeLevels.back()) {
+        Push(cycles, Event::complete, activeLevels.back());
+        activeLevels.pop_back();
+    }
+
+    return !activeLevels.empty();
+}
+
+vector<InterruptTracer::Record> InterruptTracer::GetRecords() const {
+    vector<Record> records;
+    records.reserve(size);
+
+    const size_t start = (head + buffer.size() - size) % max<size_t>(buffer.size(), 1);
+
+    for (size_t i = 0; i < size; i++) records.push_back(buffer[(start + i) % buffer.size()]);
+
+    return records;
+}
+
+string InterruptTracer::GetSourceName(uint8 source) const {
+    if (source < SOURCE_COUNT && sourceNames && sourceNames[source])
+        return sourceNames[source];
+
+    return "source " + to_string(source);
+}
+
+vector<InterruptTracer::SourceStats> InterruptTracer::GetSourceStats(
+    uint32 clocksPerSecond) const {
+    vector<SourceStats> stats(SOURCE_COUNT);
+    for (uint8 source = 0; source < SOURCE_COUNT; source++) {
+        stats[source].source = source;
+        stats[source].name = GetSourceName(source);
+    }
+
+    const vector<Record> records = GetRecords();
+
+    for (const auto& record : records)
+        if (record.event == Event::raise) stats[record.id].raised++;
+
+    for (const auto& span : CollectSpans()) {
+        if (span.handler || span.acceptedAt == NOT_ACCEPTED) continue;
+
+        SourceStats& entry = stats[span.id];
+
+        // A source that is raised while its handler is already running (and
+        // serviced by it) has no latency.
+        entry.serviced++;
+        entry.latency.Add(span.acceptedAt > span.start ? span.acceptedAt - span.start : 0);
+        entry.serviceTime.Add(span.end - span.start);
+    }
+
+    const double seconds =
+        records.empty() || clocksPerSecond == 0
+            ? 0
+            : static_cast<double>(records.back().cycles - records.front().cycles) /
+                  clocksPerSecond;
+
+    for (auto& entry : stats) entry.ratePerSecond = seconds > 0 ? entry.raised / seconds : 0;
+
+    stats.erase(remove_if(stats.begin(), stats.end(),
+                          [](const SourceStats& entry) { return entry.raised == 0; }),
+                stats.end());
+
+    stable_sort(stats.begin(), stats.end(), [](const SourceStats& a, const SourceStats& b) {
+        return a.raised > b.raised;
+    });
+
+    return stats;
+}
+
+vector<InterruptTracer::LevelStats> InterruptTracer::GetLevelStats() const {
+    vector<LevelStats> stats;
+
+    for (const auto& record : GetRecords()) {
+        if (record.event != Event::accept) continue;
+
+        auto entry = find_if(stats.begin(), stats.end(),
+                             [&](const LevelStats& entry) { return entry.level == record.id; });
+
+        if (entry == stats.end()) {
+            stats.push_back({record.id, 0, {}});
+            entry = stats.end() - 1;
+        }
+
+        entry->accepted++;
+    }
+
+    for (const auto& span : CollectSpans()) {
+        if (!span.handler) continue;
+
+        for (auto& entry : stats)
+            if (entry.level == span.id) entry.duration.Add(span.end - span.start);
+    }
+
+    sort(stats.begin(), stats.end(),
+         [](const LevelStats& a, const LevelStats& b) { return a.level > b.level; });
+
+    return stats;
+}
+
+void InterruptTracer::WriteChromeTrace(ostream& stream, uint32 clocksPerSecond) const {
+    const vector<Record> records = GetRecords();
+    const uint64 origin = records.empty() ? 0 : records.front().cycles;
+    const double usecPerCycle = clocksPerSecond > 0 ? 1e6 / clocksPerSecond : 1;
+
+    const auto timestamp = [&](uint64 cycles) { return (cycles - origin) * usecPerCycle; };
+
+    const vector<Span> spans = CollectSpans();
+    set<uint32> tracks;
+
+    stream << fixed << setprecision(3) << "{\"traceEvents\": [";
+
+    bool first = true;
+    for (const auto& span : spans) {
+        string name, args;
+        uint32 track;
+
+        if (span.handler) {
+            track = HANDLER_TRACK_BASE + span.id;
+            name = "IRQ" + to_string(span.id);
+
+            for (uint8 source = 0; source < SOURCE_COUNT; source++) {
+                if ((span.sources & (1u << source)) == 0) continue;
+
+                args += (args.empty() ? "" : ", ") + GetSourceName(source);
+            }
+        } else {
+            track = SOURCE_TRACK_BASE + span.id;
+            name = GetSourceName(span.id);
+            args = span.acceptedAt == NOT_ACCEPTED ? "not serviced by a handler" : "serviced";
+        }
+
+        tracks.insert(track);
+
+        stream << (first ? "" : ",") << endl
+               << "  {\"name\": \"" << escapeJson(name) << "\", \"cat\": \""
+               << (span.handler ? "handler" : "pending") << "\", \"ph\": \"X\", \"ts\": "
+               << timestamp(span.start) << ", \"dur\": " << (span.end - span.start) * usecPerCycle
+               << ", \"pid\": 1, \"tid\": " << track << ", \"args\": {\""
+               << (span.handler ? "sources" : "state") << "\": \"" << escapeJson(args) << "\"}}";
+
+        first = false;
+    }
+
+    for (uint32 track : tracks) {
+        const string name = track >= SOURCE_TRACK_BASE
+                                ? GetSourceName(track - SOURCE_TRACK_BASE)
+                                : "level " + to_string(track - HANDLER_TRACK_BASE);
+
+        stream << (first ? "" : ",") << endl
+               << "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << track
+               << ", \"args\": {\"name\": \"" << escapeJson(name) << "\"}}";
+
+        first = false;
+    }
+
+    stream << endl << "]}" << endl << defaultfloat;
+}
+
+void InterruptTracer::Push(uint64 cycles, Event event, uint8 id) {
+    if (buffer.empty()) return;
+
+    buffer[head] = {cycles, event, id};
+    head = (head + 1) % buffer.size();
+
+    if (size < buffer.size())
+        size++;
+    else
+        dropped++;
+}
+
+vector<InterruptTracer::Span> InterruptTracer::CollectSpans() const {
+    vector<Span> spans;
+    vector<Span> handlers;
+
+    array<uint64, SOURCE_COUNT> raisedAt;
+    uint32 pendingMask = 0;
+
+    for (const auto& record : GetRecords()) {
+        switch (record.event) {
+            case Event::raise:
+                raisedAt[record.id] = record.cycles;
+                pendingMask |= 1u << record.id;
+
+                break;
+
+            case Event::clear: {
+                if ((pendingMask & (1u << record.id)) == 0) break;
+                pendingMask &= ~(1u << record.id);
+
+                uint64 acceptedAt = NOT_ACCEPTED;
+                if (!handlers.empty()) {
+                    handlers.back().sources |= 1u << record.id;
+                    acceptedAt = handlers.back().start;
+                }
+
+                spans.push_back(
+                    {raisedAt[record.id], record.cycles, record.id, false, 0, acceptedAt});
+
+                break;
+            }
+
+            case Event::accept:
+                handlers.push_back({record.cycles, 0, record.id, true, 0, record.cycles});
+                break;
+
+            case Event::complete:
+                if (handlers.empty() || handlers.back().id != record.id) break;
+
+                handlers.back().end = record.cycles;
+                spans.push_back(handlers.back());
+                handlers.pop_back();
+
+                break;
+        }
+    }
+
+    return spans;
+}
@@ -0,0 +1,165 @@
+#ifndef _INTERRUPT_TRACER_H_
+#define _INTERRUPT_TRACER_H_
+
+#include <array>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "EmCommon.h"
+
+// Records the life cycle of Dragonball interrupts into a ring buffer:
+//
+//   * raise: a source shows up in the interrupt status register (pending and
+//     not masked),
+//   * accept: the CPU takes an interrupt on a level,
+//   * clear: the source drops from the status register, usually because the
+//     guest acknowledged it, and
+//   * complete: the CPU interrupt mask drops below the level of the innermost
+//     accepted interrupt again, usually by RTE.
+//
+// Sources are identified by their bit in the 32 bit interrupt status register
+// (high word first). Statistics are derived from the buffer on demand. A
+// source that is cleared while a handler is active is attributed to the
+// innermost handler, which yields its latency (raise -> accept) and service
+// time (raise -> clear) without knowing how sources map to levels.
+//
+// Recording costs a single check while the tracer is off. While it is running,
+// the CPU checks for completed handlers after each instruction as long as a
+// handler is active.
+
+class InterruptTracer {
+   public:
+    static constexpr size_t DEFAULT_CAPACITY = 65536;
+    static constexpr size_t SOURCE_COUNT = 32;
+
+    enum class Event : uint8 { raise = 0, clear = 1, accept = 2, complete = 3 };
+
+    struct Record {
+        uint64 cycles;
+        Event event;
+
+        // The source for raise and clear, the level for accept and complete.
+        uint8 id;
+    };
+
+    // Log2 buckets: bucket 0 counts zero, bucket i counts [2^(i-1), 2^i).
+    struct Histogram {
+        static constexpr size_t BUCKETS = 40;
+
+        array<uint64, BUCKETS> buckets{};
+        uint64 count{0};
+        uint64 total{0};
+        uint64 max{0};
+
+        void Add(uint64 value);
+
+        // Upper bound of the bucket that contains the given percentile.
+        uint64 Percentile(double percentile) const;
+        double Mean() const;
+    };
+
+    struct SourceStats {
+        uint8 source;
+        string name;
+
+        uint64 raised;
+        uint64 serviced;
+        double ratePerSecond;
+
+        // In cycles.
+        Histogram latency;
+        Histogram serviceTime;
+    };
+
+    struct LevelStats {
+        uint8 level;
+
+        uint64 accepted;
+
+        // Cycles from accept to complete.
+        Histogram duration;
+    };
+
+   public:
+    InterruptTracer() = default;
+
+    void Start(size_t capacity = DEFAULT_CAPACITY);
+    void Stop();
+    void Clear();
+
+    bool IsRunning() const { return running; }
+    bool HasActiveHandlers() const { return !activeLevels.empty(); }
+
+    // Called by the Dragonball register handlers whenever the status register
+    // is updated. `sourceNames` must stay valid while the tracer holds
+    // records.
+    void UpdateStatus(uint64 cycles, uint32 status, const char* const* sourceNames);
+
+    // Called by the CPU when it takes an interrupt.
+    void Accept(uint64 cycles, int32 level);
+
+    // Called by the CPU after each instruction while handlers are active.
+    // Returns whether handlers remain active.
+    bool CheckComplete(uint64 cycles, int32 intmask);
+
+    // Records, oldest first.
+    vector<Record> GetRecords() const;
+    uint64 GetDroppedCount() const { return dropped; }
+
+    string GetSourceName(uint8 source) const;
+
+    // Sorted by the number of raised interrupts, in descending order.
+    vector<SourceStats> GetSourceStats(uint32 clocksPerSecond) const;
+    vector<LevelStats> GetLevelStats() const;
+
+    // Chrome trace event format, suitable for chrome://tracing and Perfetto.
+    // Handlers show up on one track per level, pending sources on one track
+    // per source.
+    void WriteChromeTrace(ostream& stream, uint32 clocksPerSecond) const;
+
+   private:
+    struct Span {
+        uint64 start;
+        uint64 end;
+
+        // Level for handlers, source for pending interrupts.
+        uint8 id;
+        bool handler;
+
+        // Sources serviced by a handler.
+        uint32 sources;
+
+        // Accept time of the handler that serviced a pending interrupt.
+        uint64 acceptedAt;
+    };
+
+   private:
+    void Push(uint64 cycles, Event event, uint8 id);
+
+    // Replays the records into handler and pending spans.
+    vector<Span> CollectSpans() const;
+
+   private:
+    bool running{false};
+
+    vector<Record> buffer;
+    size_t head{0};
+    size_t size{0};
+    uint64 dropped{0};
+
+    uint32 status{0};
+    vector<uint8> activeLevels;
+
+    const char* const* sourceNames{nullptr};
+
+   private:
+    InterruptTracer(const InterruptTracer&) = delete;
+    InterruptTracer(InterruptTracer&&) = delete;
+    InterruptTracer& operator=(const InterruptTracer&) = delete;
+    InterruptTracer& operator=(InterruptTracer&&) = delete;
+};
+
+extern thread_local InterruptTracer* gInterruptTracer;
+
+#endif  // _INTERRUPT_TRACER_H_
@@ -16,10 +16,11 @@
 
 #include "EmBankMapped.h"  // UnmapPhysicalMemory
 #include "EmCommon.h"
-#include "EmMemory.h"       // EmMemGet32, EmMemGet16, EmMemGet8, EmMem_memcpy
-#include "EmPalmStructs.h"  // EmProxy
-#include "EmSubroutine.h"   // EmSubroutine
-#include "Platform.h"       // Platform::AllocateMemory
+#include "EmMemory.h"          // EmMemGet32, EmMemGet16, EmMemGet8, EmMem_memcpy
+#include "EmPalmStructs.h"     // EmProxy
+#include "EmSubroutine.h"      // EmSubroutine
+#include "EmSubroutineDecl.h"  // EmSubroutineDecl
+#include "Platform.h"          // Platform::AllocateMemory
 
 /* ===========================================================================
 
@@ -113,47 +114,47 @@ struct HostUTimeType;
 typedef struct ExgSocketType* ExgSocketPtr;
 typedef UInt8* UInt8Ptr;
 
-#define CALLED_SETUP(return_decl, parameter_decl)      \
-    static EmSubroutine sub;                           \
-                                                       \
-    static Bool initialized;                           \
-    if (!initialized) {                                \
-        initialized = true;                            \
-        sub.DescribeDecl(return_decl, parameter_decl); \
-    }                                                  \
-                                                       \
+// The prototype is parsed at compile time. Subroutines for the common case
+// are static, so their stack layout is computed once.
+
+#define DECLARE_SUBROUTINE_DECL(return_decl, parameter_decl)                \
+    static constexpr EmSubroutineDecl subDecl(return_decl, parameter_decl); \
+    static_assert(subDecl.IsValid(), "too many parameters")
+
+#define CALLED_SETUP(return_decl, parameter_decl)         \
+    DECLARE_SUBROUTINE_DECL(return_decl, parameter_decl); \
+    static thread_local EmSubroutine sub;                 \
+                                                          \
+    static EM_THREAD_LOCAL Bool initialized;              \
+    if (!initialized) {                                   \
+        initialized = true;                               \
+        sub.DescribeDecl(subDecl);                        \
+    }                                                     \
+                                                          \
     sub.PrepareStack(kForBeingCalled, false)
 
-#define CALLED_SETUP_HC(return_decl, parameter_decl)                                         \
-    static EmSubroutine sub;                                                                 \
-                                                                                             \
-    static Bool initialized;                                                                 \
-    if (!initialized) {                                                                      \
-        initialized = true;                                                                  \
-        sub.DescribeDecl(return_decl, "HostControlSelectorType _selector, " parameter_decl); \
-    }                                                                                        \
-                                                                                             \
-    sub.PrepareStack(kForBeingCalled, false)
-
-#define CALLED_SETUP_STDARG(return_decl, parameter_decl) \
-    EmSubroutine sub;                                    \
-    sub.DescribeDecl(return_decl, parameter_decl);       \
-    sub.PrepareStack(kForBeingCalled, true)
+#define CALLED_SETUP_HC(return_decl, parameter_decl) \
+    CALLED_SETUP(return_decl, "HostControlSelectorType _selector, " parameter_decl)
 
-#define CALLED_SETUP_STDARG_HC(return_decl, parameter_decl)                             \
-    EmSubroutine sub;                                                                   \
-    sub.DescribeDecl(return_decl, "HostControlSelectorType selector, " parameter_decl); \
+#define CALLED_SETUP_STDARG(return_decl, parameter_decl)  \
+    DECLARE_SUBROUTINE_DECL(return_decl, parameter_decl); \
+    EmSubroutine sub;                                     \
+    sub.DescribeDecl(subDecl);                            \
     sub.PrepareStack(kForBeingCalled, true)
 
-#define CALLER_SETUP(return_decl, parameter_decl)      \
-    static EmSubroutine sub;                           \
-                                                       \
-    static Bool initialized;                           \
-    if (!initialized) {                                \
-        initialized = true;                            \
-        sub.DescribeDecl(return_decl, parameter_decl); \
-    }                                                  \
-                                                       \
+#define CALLED_SETUP_STDARG_HC(return_decl, parameter_decl) \
+    CALLED_SETUP_STDARG(return_decl, "HostControlSelectorType selector, " parameter_decl)
+
+#define CALLER_SETUP(return_decl, parameter_decl)         \
+    DECLARE_SUBROUTINE_DECL(return_decl, parameter_decl); \
+    static thread_local EmSubroutine sub;                 \
+                                                          \
+    static EM_THREAD_LOCAL Bool initialized;              \
+    if (!initialized) {                                   \
+        initialized = true;                               \
+        sub.DescribeDecl(subDecl);                        \
+    }                                                     \
+                                                          \
     sub.PrepareStack(kForCalling, false)
 
 #define GET_RESULT_VAL(type) \
@@ -376,10 +377,10 @@ class ParamVal {
 template <typename T, long inOut>
 class ParamRef {
    public:
-    ParamRef(EmSubroutine& sub, EmParamNameArg name) : fSub(&sub), fName(name), fPtr(EmMemNULL) {
+    ParamRef(EmSubroutine& sub, EmParamNameArg name) : fSub(&sub), fPtr(EmMemNULL) {
         // Get and cache the pointer to the data.
 
-        fSub->GetParamVal(fName.c_str(), fPtr);
+        fSub->GetParamVal(name, fPtr);
 
         // If there's a pointer and this is an input
         // variable, get the data.
@@ -406,7 +407,6 @@ class ParamRef {
 
    private:
     EmSubroutine* fSub;
-    EmParamName fName;
     emuptr fPtr;
     T fVal;
 };
@@ -428,10 +428,10 @@ template <typename T, long inOut>
 class ParamPtr {
    public:
     ParamPtr(EmSubroutine& sub, EmParamNameArg name, long len)
-        : fSub(&sub), fName(name), fPtr(EmMemNULL), fLen(len), fVal(NULL) {
+        : fSub(&sub), fPtr(EmMemNULL), fLen(len), fVal(NULL) {
         // Get and cache the pointer to the data.
 
-        fSub->GetParamVal(fName.c_str(), fPtr);
+        fSub->GetParamVal(name, fPtr);
 
         if (fPtr) {
             fVal = (T*)Platform::AllocateMemory(fLen);
@@ -458,7 +458,6 @@ class ParamPtr {
 
    private:
     EmSubroutine* fSub;
-    EmParamName fName;
     emuptr fPtr;
     long fLen;
     T* fVal;
@@ -478,8 +477,8 @@ template <typename T>
 class ParamStr {
    public:
     ParamStr(EmSubroutine& sub, EmParamNameArg name)
-        : fSub(&sub), fName(name), fPtr(EmMemNULL), fVal(NULL) {
-        fSub->GetParamVal(fName.c_str(), fPtr);
+        : fSub(&sub), fPtr(EmMemNULL), fVal(NULL) {
+        fSub->GetParamVal(name, fPtr);
 
         if (fPtr) {
             fVal = (T*)Platform::AllocateMemory(EmMem_strlen(fPtr) + 1);
@@ -502,7 +501,6 @@ class ParamStr {
 
    private:
     EmSubroutine* fSub;
-    EmParamName fName;
     emuptr fPtr;
     T* fVal;
 };
@@ -519,7 +517,7 @@ template <typename T, long inOut>
 class PushParamRef {
    public:
     PushParamRef(EmSubroutine& sub, EmParamNameArg name, T* ptr)
-        : fSub(&sub), fName(name), fHostPtr(ptr), fMappedData(NULL), fMappedPtr(EmMemNULL) {
+        : fSub(&sub), fHostPtr(ptr), fMappedData(NULL), fMappedPtr(EmMemNULL) {
         if (fHostPtr) {
             // Allocate a buffer big enough for the mapped/translated data.
 
@@ -539,14 +537,14 @@ class PushParamRef {
 
             // Pass the pointer to the data.
 
-            fSub->SetParamVal(fName.c_str(), fMappedPtr);
+            fSub->SetParamVal(name, fMappedPtr);
         } else {
             fMappedPtr = EmMemNULL;
         }
 
         // Pass the pointer to the data.
 
-        fSub->SetParamVal(fName.c_str(), fMappedPtr);
+        fSub->SetParamVal(name, fMappedPtr);
     }
 
     ~PushParamRef(void) {
@@ -564,7 +562,6 @@ class PushParamRef {
 
    private:
     EmSubroutine* fSub;
-    EmParamName fName;
     T* fHostPtr;
     void* fMappedData;
     emuptr fMappedPtr;
@@ -574,7 +571,7 @@ template <typename T, long inOut>
 class PushParamPtr {
    public:
     PushParamPtr(EmSubroutine& sub, EmParamNameArg name, const T* ptr, long size)
-        : fSub(&sub), fName(name), fHostPtr(ptr), fMappedPtr(EmMemNULL) {
+        : fSub(&sub), fHostPtr(ptr), fMappedPtr(EmMemNULL) {
         if (fHostPtr) {
             // Map the buffer
 
@@ -586,7 +583,7 @@ class PushParamPtr {
 
         // Pass the pointer to the data.
 
-        fSub->SetParamVal(fName.c_str(), fMappedPtr);
+        fSub->SetParamVal(name, fMappedPtr);
     }
 
     ~PushParamPtr(void) {
@@ -597,7 +594,6 @@ class PushParamPtr {
 
    private:
     EmSubroutine* fSub;
-    EmParamName fName;
     const T* fHostPtr;
     emuptr fMappedPtr;
 };
@@ -606,7 +602,7 @@ template <typename T>
 class PushParamStr {
    public:
     PushParamStr(EmSubroutine& sub, EmParamNameArg name, const T* const ptr)
-        : fSub(&sub), fName(name), fHostPtr(ptr), fMappedPtr(EmMemNULL) {
+        : fSub(&sub), fHostPtr(ptr), fMappedPtr(EmMemNULL) {
         if (fHostPtr) {
             // Map the buffer
 
@@ -619,7 +615,7 @@ class PushParamStr {
 
         // Pass the pointer to the data.
 
-        fSub->SetParamVal(fName.c_str(), fMappedPtr);
+        fSub->SetParamVal(name, fMappedPtr);
     }
 
     ~PushParamStr(void) {
@@ -630,7 +626,6 @@ class PushParamStr {
 
    private:
     EmSubroutine* fSub;
-    EmParamName fName;
     const T* const fHostPtr;
     emuptr fMappedPtr;
 };
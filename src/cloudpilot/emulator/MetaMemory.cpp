@@ -18,9 +18,12 @@
 #include "EmBankSRAM.h"
 #include "EmCommon.h"
 #include "EmMemory.h"
+#include "EmSessionContext.h"
 #include "MemoryRegion.h"
 
-set<emuptr> MetaMemory::breakpoints;
+thread_local set<emuptr> MetaMemory::breakpoints;
+
+const EmSessionState MetaMemory::sessionState{EM_SESSION_VARIABLE(breakpoints)};
 
 void MetaMemory::Clear() { EmAssert(breakpoints.size() == 0); }
 
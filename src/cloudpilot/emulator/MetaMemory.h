@@ -18,6 +18,8 @@
 
 #include "EmMemory.h"  // EmMemGetMetaAddress
 
+class EmSessionState;
+
 class MetaMemory {
    public:
     static void Clear();
@@ -42,7 +44,9 @@ class MetaMemory {
     static void UnmarkRange(emuptr start, emuptr end, uint8 v);
     static void MarkUnmarkRange(emuptr start, emuptr end, uint8 andValue, uint8 orValue);
 
-    static std::set<emuptr> breakpoints;
+    static thread_local std::set<emuptr> breakpoints;
+
+    static const EmSessionState sessionState;
 
     enum {
         kNoAppAccess = 0x0001,
@@ -429,7 +429,7 @@ string GetLibraryName(uint16 refNum) {
     // emuptr libEntry;
     emuptr dispatchTblP;
 
-    if (gSystemState.OSMajorVersion() > 1) {
+    if (gSystemState->OSMajorVersion() > 1) {
         EmAliasSysLibTblEntryType<PAS> libEntries(sysLibTableP);
         dispatchTblP = libEntries[refNum].dispatchTblP;
     } else {
@@ -1,12 +1,17 @@
 #include "NetworkProxy.h"
 
+#include <cstring>
 #include <memory>
+#include <utility>
 
 #ifdef __linux__
     #include <arpa/inet.h>
 #endif
 
+#include "EmCPU.h"
 #include "EmMemory.h"
+#include "EmSession.h"
+#include "EmSessionContext.h"
 #include "EmSubroutine.h"
 #include "Logging.h"
 #include "Marshal.h"
@@ -70,7 +75,7 @@ namespace {
     constexpr size_t REQUEST_STATIC_SIZE = 128;
     constexpr uint16 VALID_FLAGS = netIOFlagOutOfBand | netIOFlagPeek | netIOFlagDontRoute;
 
-    NetworkProxy networkProxy;
+    thread_local NetworkProxy networkProxy;
 
     bool serializeAddress(const NetSocketAddrType* sockAddr, Address& address) {
         if (sockAddr->family != netSocketAddrINET) return false;
@@ -168,15 +173,59 @@ namespace {
     }
 }  // namespace
 
-NetworkProxy& gNetworkProxy{networkProxy};
+thread_local NetworkProxy* gNetworkProxy{&networkProxy};
+
+namespace {
+    const EmSessionState sessionState{EM_SESSION_OBJECT(gNetworkProxy)};
+}  // namespace
 
 void NetworkProxy::Reset() {
     if (this->openCount > 0) onDisconnect.Dispatch(sessionId.c_str());
 
     openCount = 0;
+
+    DiscardPendingCalls();
+}
+
+void NetworkProxy::SetTransport(transportT transport) { this->transport = transport; }
+
+void NetworkProxy::DispatchResponse(const uint8* responseData, size_t size) {
+    MsgResponse response = MsgResponse_init_zero;
+    pb_istream_t stream = pb_istream_from_buffer(responseData, size);
+
+    if (!pb_decode(&stream, MsgResponse_fields, &response)) {
+        logging::printf("failed to decode response");
+
+        return;
+    }
+
+    if (!pendingCalls.Complete(response.id, responseData, size)) {
+        logging::printf("discarding response to unknown request %u", response.id);
+
+        return;
+    }
+
+    // Wake the CPU so that the blocked call picks up the response right away
+    // instead of waiting for the next interrupt.
+    gCPU->SetStopped(false);
+}
+
+void NetworkProxy::CancelPendingCalls() {
+    if (pendingCalls.Cancel()) gCPU->SetStopped(false);
+}
+
+void NetworkProxy::DiscardPendingCalls() {
+    pendingCalls.Clear();
+    callResult = kSkipROM;
 }
 
+size_t NetworkProxy::PendingCallCount() const { return pendingCalls.PendingCount(); }
+
+CallROMType NetworkProxy::CallResult() { return exchange(callResult, kSkipROM); }
+
 void NetworkProxy::Open() {
+    gSession->NotifyHostInput(Recording::HostInput::network);
+
     if (openCount > 0) {
         CALLED_SETUP("Err", "void");
         PUT_RESULT_VAL(Err, 0);
@@ -229,9 +278,9 @@ void NetworkProxy::SocketOpen(uint8 domain, uint8 type, uint16 protocol) {
     request.payload.socketOpenRequest.type = type;
     request.payload.socketOpenRequest.protocol = protocol;
 
-    SendAndSuspend(request, REQUEST_STATIC_SIZE,
-                   bind(&NetworkProxy::SocketOpenSuccess, this, _1, _2),
-                   bind(&NetworkProxy::SocketOpenFail, this, _1));
+    SendRequest(request, REQUEST_STATIC_SIZE,
+                bind(&NetworkProxy::SocketOpenSuccess, this, _1, _2),
+                bind(&NetworkProxy::SocketOpenFail, this, _1));
 }
 
 void NetworkProxy::SocketOpenSuccess(void* responseData, size_t size) {
@@ -272,9 +321,9 @@ void NetworkProxy::SocketBind(int16 handle, NetSocketAddrType* sockAddrP, Int32
     if (!serializeAddress(sockAddrP, request.payload.socketBindRequest.address))
         return SocketBindFail(netErrParamErr);
 
-    SendAndSuspend(request, REQUEST_STATIC_SIZE,
-                   bind(&NetworkProxy::SocketBindSuccess, this, _1, _2),
-                   bind(&NetworkProxy::SocketBindFail, this, _1));
+    SendRequest(request, REQUEST_STATIC_SIZE,
+                bind(&NetworkProxy::SocketBindSuccess, this, _1, _2),
+                bind(&NetworkProxy::SocketBindFail, this, _1));
 }
 
 void NetworkProxy::SocketBindSuccess(void* responseData, size_t size) {
@@ -320,9 +369,9 @@ void NetworkProxy::SocketAddr(int16 handle, NetSocketAddrType* locAddrP, Int16*
     request.payload.socketAddrRequest.requestAddressRemote = remAddrP;
     request.payload.socketAddrRequest.timeout = convertTimeout(timeout);
 
-    SendAndSuspend(request, REQUEST_STATIC_SIZE,
-                   bind(&NetworkProxy::SocketAddrSuccess, this, _1, _2),
-                   bind(&NetworkProxy::SocketAddrFail, this, _1));
+    SendRequest(request, REQUEST_STATIC_SIZE,
+                bind(&NetworkProxy::SocketAddrSuccess, this, _1, _2),
+                bind(&NetworkProxy::SocketAddrFail, this, _1));
 }
 
 void NetworkProxy::SocketAddrSuccess(void* responseData, size_t size) {
@@ -412,9 +461,9 @@ void NetworkProxy::SocketSend(int16 handle, uint8* data, size_t count, uint16 fl
     sendRequest.data.arg = &bufferEncodeCtx;
     sendRequest.data.funcs.encode = bufferEncodeCb;
 
-    SendAndSuspend(request, REQUEST_STATIC_SIZE + count,
-                   bind(&NetworkProxy::SocketSendSuccess, this, _1, _2),
-                   bind(&NetworkProxy::SocketSendFail, this, _1));
+    SendRequest(request, REQUEST_STATIC_SIZE + count,
+                bind(&NetworkProxy::SocketSendSuccess, this, _1, _2),
+                bind(&NetworkProxy::SocketSendFail, this, _1));
 }
 
 void NetworkProxy::SocketSendSuccess(void* responseData, size_t size) {
@@ -489,9 +538,9 @@ void NetworkProxy::SocketSendPB(int16 handle, NetIOParamType* pbP, uint16 flags,
     sendRequest.data.arg = &bufferEncodeCtx;
     sendRequest.data.funcs.encode = bufferEncodeCb;
 
-    SendAndSuspend(request, REQUEST_STATIC_SIZE + count,
-                   bind(&NetworkProxy::SocketSendPBSuccess, this, _1, _2),
-                   bind(&NetworkProxy::SocketSendPBFail, this, _1));
+    SendRequest(request, REQUEST_STATIC_SIZE + count,
+                bind(&NetworkProxy::SocketSendPBSuccess, this, _1, _2),
+                bind(&NetworkProxy::SocketSendPBFail, this, _1));
 }
 
 void NetworkProxy::SocketSendPBSuccess(void* responseData, size_t size) {
@@ -538,9 +587,9 @@ void NetworkProxy::SocketReceive(int16 handle, uint16 flags, uint16 bufLen, int3
     request.payload.socketReceiveRequest.maxLen = bufLen;
     request.payload.socketReceiveRequest.addressRequested = fromAddrP;
 
-    SendAndSuspend(request, REQUEST_STATIC_SIZE,
-                   bind(&NetworkProxy::SocketReceiveSuccess, this, _1, _2),
-                   bind(&NetworkProxy::SocketReceiveFail, this, _1));
+    SendRequest(request, REQUEST_STATIC_SIZE,
+                bind(&NetworkProxy::SocketReceiveSuccess, this, _1, _2),
+                bind(&NetworkProxy::SocketReceiveFail, this, _1));
 }
 
 void NetworkProxy::SocketReceiveSuccess(void* responseData, size_t size) {
@@ -615,9 +664,9 @@ void NetworkProxy::SocketReceivePB(int16 handle, NetIOParamType* pbP, uint16 fla
     request.payload.socketReceiveRequest.maxLen = bufLen;
     request.payload.socketReceiveRequest.addressRequested = pbP->addrP;
 
-    SendAndSuspend(request, REQUEST_STATIC_SIZE,
-                   bind(&NetworkProxy::SocketReceivePBSuccess, this, _1, _2),
-                   bind(&NetworkProxy::SocketReceivePBFail, this, _1));
+    SendRequest(request, REQUEST_STATIC_SIZE,
+                bind(&NetworkProxy::SocketReceivePBSuccess, this, _1, _2),
+                bind(&NetworkProxy::SocketReceivePBFail, this, _1));
 }
 
 void NetworkProxy::SocketReceivePBSuccess(void* responseData, size_t size) {
@@ -694,9 +743,9 @@ void NetworkProxy::SocketDmReceive(int16 handle, uint16 flags, uint16 rcvlen, in
     request.payload.socketReceiveRequest.maxLen = rcvlen;
     request.payload.socketReceiveRequest.addressRequested = fromAddrP;
 
-    SendAndSuspend(request, REQUEST_STATIC_SIZE,
-                   bind(&NetworkProxy::SocketDmReceiveSuccess, this, _1, _2),
-                   bind(&NetworkProxy::SocketDmReceiveFail, this, _1));
+    SendRequest(request, REQUEST_STATIC_SIZE,
+                bind(&NetworkProxy::SocketDmReceiveSuccess, this, _1, _2),
+                bind(&NetworkProxy::SocketDmReceiveFail, this, _1));
 }
 
 void NetworkProxy::SocketDmReceiveSuccess(void* responseData, size_t size) {
@@ -762,9 +811,9 @@ void NetworkProxy::SocketClose(int16 handle, int32 timeout) {
     request.payload.socketCloseRequest.handle = handle;
     request.payload.socketCloseRequest.timeout = convertTimeout(timeout);
 
-    SendAndSuspend(request, REQUEST_STATIC_SIZE,
-                   bind(&NetworkProxy::SocketCloseSuccess, this, _1, _2),
-                   bind(&NetworkProxy::SocketCloseFail, this, _1));
+    SendRequest(request, REQUEST_STATIC_SIZE,
+                bind(&NetworkProxy::SocketCloseSuccess, this, _1, _2),
+                bind(&NetworkProxy::SocketCloseFail, this, _1));
 }
 
 void NetworkProxy::SocketCloseSuccess(void* responseData, size_t size) {
@@ -799,9 +848,9 @@ void NetworkProxy::GetHostByName(const string name) {
 
     strcpy(request.name, name.c_str());
 
-    SendAndSuspend(requestMsg, REQUEST_STATIC_SIZE + sizeof(request.name),
-                   bind(&NetworkProxy::GetHostByNameSuccess, this, _1, _2),
-                   bind(&NetworkProxy::GetHostByNameFail, this, _1));
+    SendRequest(requestMsg, REQUEST_STATIC_SIZE + sizeof(request.name),
+                bind(&NetworkProxy::GetHostByNameSuccess, this, _1, _2),
+                bind(&NetworkProxy::GetHostByNameFail, this, _1));
 }
 
 void NetworkProxy::GetHostByNameSuccess(void* responseData, size_t size) {
@@ -873,10 +922,9 @@ void NetworkProxy::GetServByName(const string name, const string proto) {
     strcpy(request.name, name.c_str());
     strcpy(request.protocol, proto.c_str());
 
-    SendAndSuspend(requestMsg,
-                   REQUEST_STATIC_SIZE + sizeof(request.name) + sizeof(request.protocol),
-                   bind(&NetworkProxy::GetServByNameSuccess, this, _1, _2),
-                   bind(&NetworkProxy::GetServByNameFail, this, _1));
+    SendRequest(requestMsg, REQUEST_STATIC_SIZE + sizeof(request.name) + sizeof(request.protocol),
+                bind(&NetworkProxy::GetServByNameSuccess, this, _1, _2),
+                bind(&NetworkProxy::GetServByNameFail, this, _1));
 }
 
 void NetworkProxy::GetServByNameSuccess(void* responseData, size_t size) {
@@ -940,9 +988,9 @@ void NetworkProxy::SocketConnect(int16 handle, NetSocketAddrType* address, int16
     request.handle = handle;
     request.timeout = convertTimeout(timeout);
 
-    SendAndSuspend(msgRequest, REQUEST_STATIC_SIZE,
-                   bind(&NetworkProxy::SocketConnectSuccess, this, _1, _2),
-                   bind(&NetworkProxy::SocketConnectFail, this, _1));
+    SendRequest(msgRequest, REQUEST_STATIC_SIZE,
+                bind(&NetworkProxy::SocketConnectSuccess, this, _1, _2),
+                bind(&NetworkProxy::SocketConnectFail, this, _1));
 }
 
 void NetworkProxy::SocketConnectSuccess(void* responseData, size_t size) {
@@ -988,9 +1036,8 @@ void NetworkProxy::Select(UInt16 width, NetFDSetType readFDs, NetFDSetType write
     request.exceptFDs = exceptFDs;
     request.timeout = convertTimeout(timeout);
 
-    SendAndSuspend(msgRequest, REQUEST_STATIC_SIZE,
-                   bind(&NetworkProxy::SelectSuccess, this, _1, _2),
-                   bind(&NetworkProxy::SelectFail, this, _1));
+    SendRequest(msgRequest, REQUEST_STATIC_SIZE, bind(&NetworkProxy::SelectSuccess, this, _1, _2),
+                bind(&NetworkProxy::SelectFail, this, _1));
 }
 
 void NetworkProxy::SelectSuccess(void* responseData, size_t size) {
@@ -1053,9 +1100,9 @@ bool NetworkProxy::SettingGet(UInt16 setting) {
 
     request.setting = setting;
 
-    SendAndSuspend(msgRequest, REQUEST_STATIC_SIZE + 256,
-                   bind(&NetworkProxy::SettingGetSuccess, this, _1, _2),
-                   bind(&NetworkProxy::SettingGetFail, this, _1));
+    SendRequest(msgRequest, REQUEST_STATIC_SIZE + 256,
+                bind(&NetworkProxy::SettingGetSuccess, this, _1, _2),
+                bind(&NetworkProxy::SettingGetFail, this, _1));
 
     return true;
 }
@@ -1204,9 +1251,9 @@ void NetworkProxy::SocketOptionSet(int16 handle, uint16 level, uint16 option, em
         }
     }
 
-    SendAndSuspend(msgRequest, REQUEST_STATIC_SIZE,
-                   bind(&NetworkProxy::SocketOptionSetSuccess, this, _1, _2),
-                   bind(&NetworkProxy::SocketOptionSetFail, this, _1));
+    SendRequest(msgRequest, REQUEST_STATIC_SIZE,
+                bind(&NetworkProxy::SocketOptionSetSuccess, this, _1, _2),
+                bind(&NetworkProxy::SocketOptionSetFail, this, _1));
 }
 
 void NetworkProxy::SocketOptionSetSuccess(void* responseData, size_t size) {
@@ -1254,9 +1301,9 @@ void NetworkProxy::SocketOptionGet(int16 handle, uint16 level, uint16 option, in
     request.option = option;
     request.timeout = convertTimeout(timeout);
 
-    SendAndSuspend(msgRequest, REQUEST_STATIC_SIZE,
-                   bind(&NetworkProxy::SocketOptionGetSuccess, this, _1, _2),
-                   bind(&NetworkProxy::SocketOptionGetFail, this, _1));
+    SendRequest(msgRequest, REQUEST_STATIC_SIZE,
+                bind(&NetworkProxy::SocketOptionGetSuccess, this, _1, _2),
+                bind(&NetworkProxy::SocketOptionGetFail, this, _1));
 }
 
 void NetworkProxy::SocketOptionGetSuccess(void* responseData, size_t size) {
@@ -1374,9 +1421,9 @@ void NetworkProxy::SocketListen(int16 handle, int32 timeout) {
     request.backlog = 1;
     request.timeout = convertTimeout(timeout);
 
-    SendAndSuspend(msgRequest, REQUEST_STATIC_SIZE,
-                   bind(&NetworkProxy::SocketListenSuccess, this, _1, _2),
-                   bind(&NetworkProxy::SocketListenFail, this, _1));
+    SendRequest(msgRequest, REQUEST_STATIC_SIZE,
+                bind(&NetworkProxy::SocketListenSuccess, this, _1, _2),
+                bind(&NetworkProxy::SocketListenFail, this, _1));
 }
 
 void NetworkProxy::SocketListenSuccess(void* responseData, size_t size) {
@@ -1414,9 +1461,9 @@ void NetworkProxy::SocketAccept(int16 handle, int32 timeout) {
     request.handle = handle;
     request.timeout = convertTimeout(timeout);
 
-    SendAndSuspend(msgRequest, REQUEST_STATIC_SIZE,
-                   bind(&NetworkProxy::SocketAcceptSuccess, this, _1, _2),
-                   bind(&NetworkProxy::SocketAcceptFail, this, _1));
+    SendRequest(msgRequest, REQUEST_STATIC_SIZE,
+                bind(&NetworkProxy::SocketAcceptSuccess, this, _1, _2),
+                bind(&NetworkProxy::SocketAcceptFail, this, _1));
 }
 
 void NetworkProxy::SocketAcceptSuccess(void* responseData, size_t size) {
@@ -1481,7 +1528,7 @@ bool NetworkProxy::DecodeResponse(void* responseData, size_t size, MsgResponse&
         return false;
     }
 
-    if (response.id != currentId) {
+    if (response.id != responseId) {
         logging::printf("response out of order");
         return false;
     }
@@ -1503,16 +1550,64 @@ MsgRequest NetworkProxy::NewRequest(pb_size_t payloadTag) {
     return request;
 }
 
+void NetworkProxy::SendRequest(MsgRequest& request, size_t size,
+                               SuspendContextNetworkRpc::successCallbackT cbSuccess,
+                               function<void(Err)> cbFail) {
+    if (openCount == 0) return cbFail(netErrNotOpen);
+
+    gSession->NotifyHostInput(Recording::HostInput::network);
+
+    if (!transport || gSession->IsNested()) return SendAndSuspend(request, size, cbSuccess, cbFail);
+
+    // A blocked call executes again whenever the CPU wakes up.
+    emuptr sp = gCPU->GetSP();
+
+    switch (pendingCalls.Resume(sp, request.which_payload)) {
+        case NetworkRpcTracker::State::pending:
+            callResult = kRestartCall;
+            return;
+
+        case NetworkRpcTracker::State::completed:
+            return;
+
+        default:
+            break;
+    }
+
+    auto buffer = make_unique<uint8[]>(size);
+    pb_ostream_t stream = pb_ostream_from_buffer(buffer.get(), size);
+
+    pb_encode(&stream, MsgRequest_fields, &request);
+
+    if (!transport(buffer.get(), stream.bytes_written)) {
+        logging::printf("failed to send request");
+
+        return cbFail(netErrInternal);
+    }
+
+    const uint32 id = request.id;
+
+    pendingCalls.Add(
+        id, sp, request.which_payload,
+        [=](void* response, size_t size) {
+            responseId = id;
+            cbSuccess(response, size);
+        },
+        bind(cbFail, netErrInternal));
+
+    callResult = kRestartCall;
+}
+
 void NetworkProxy::SendAndSuspend(MsgRequest& request, size_t size,
                                   SuspendContextNetworkRpc::successCallbackT cbSuccess,
                                   function<void(Err)> cbFail) {
-    if (openCount == 0) return cbFail(netErrNotOpen);
-
     uint8* buffer = new uint8[size];
     pb_ostream_t stream = pb_ostream_from_buffer(buffer, size);
 
     pb_encode(&stream, MsgRequest_fields, &request);
 
+    responseId = request.id;
+
     SuspendManager::Suspend<SuspendContextNetworkRpc>(buffer, stream.bytes_written, cbSuccess,
                                                       bind(cbFail, netErrInternal));
 }
@@ -5,17 +5,43 @@
 
 #include "EmCommon.h"
 #include "EmEvent.h"
+#include "EmPatchModuleTypes.h"
+#include "NetworkRpcTracker.h"
 #include "SuspendContextNetworkRpc.h"
 #include "networking.pb.h"
 
 struct BufferDecodeContext;
 
 class NetworkProxy {
+   public:
+    using transportT = function<bool(const uint8* request, size_t size)>;
+
    public:
     NetworkProxy() = default;
 
     void Reset();
 
+    // Without a transport, each RPC suspends the emulator until the frontend
+    // has carried it out. With a transport, requests are sent right away and
+    // the calling task blocks in its NetLib call while the CPU keeps running.
+    // The frontend hands in the responses via DispatchResponse, in any order.
+    void SetTransport(transportT transport);
+
+    void DispatchResponse(const uint8* response, size_t size);
+
+    // Fails all calls that are still waiting for a response.
+    void CancelPendingCalls();
+
+    // Drops all calls that are waiting for a response. Used when the machine
+    // state is replaced and the calls belong to a different timeline.
+    void DiscardPendingCalls();
+
+    size_t PendingCallCount() const;
+
+    // Tells the NetLib headpatch how to proceed after issuing an RPC:
+    // kRestartCall if the call blocks, kSkipROM otherwise.
+    CallROMType CallResult();
+
     void Open();
 
     void Close();
@@ -131,6 +157,10 @@ class NetworkProxy {
     bool DecodeResponse(void* responseData, size_t size, MsgResponse& response,
                         pb_size_t payloadTag, BufferDecodeContext* bufferrDecodeContext = nullptr);
 
+    void SendRequest(MsgRequest& request, size_t bufferSize,
+                     SuspendContextNetworkRpc::successCallbackT cbSuccess,
+                     function<void(Err)> cbFail);
+
     void SendAndSuspend(MsgRequest& request, size_t bufferSize,
                         SuspendContextNetworkRpc::successCallbackT cbSuccess,
                         function<void(Err)> cbFail);
@@ -138,8 +168,13 @@ class NetworkProxy {
    private:
     uint32 openCount{0};
     uint32 currentId{0xffffffff};
+    uint32 responseId{0};
     string sessionId;
 
+    transportT transport;
+    NetworkRpcTracker pendingCalls;
+    CallROMType callResult{kSkipROM};
+
    private:
     NetworkProxy(const NetworkProxy&) = delete;
     NetworkProxy(NetworkProxy&&) = delete;
@@ -147,6 +182,6 @@ class NetworkProxy {
     NetworkProxy& operator=(NetworkProxy&&) = delete;
 };
 
-extern NetworkProxy& gNetworkProxy;
+extern thread_local NetworkProxy* gNetworkProxy;
 
 #endif  // _NETWORK_PROXY_H_
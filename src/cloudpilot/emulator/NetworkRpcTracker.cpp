@@ -0,0 +1,61 @@
+#include "NetworkRpcTracker.h"
+
+#include <algorithm>
+#include <cstring>
+
+void NetworkRpcTracker::Add(uint32 id, emuptr sp, uint32 tag, successCallbackT onSuccess,
+                            failCallbackT onFail) {
+    calls.push_back({id, sp, tag, onSuccess, onFail});
+}
+
+bool NetworkRpcTracker::Complete(uint32 id, const uint8* response, size_t size) {
+    auto call = find_if(calls.begin(), calls.end(),
+                        [&](const Call& call) { return call.id == id && !call.completed; });
+
+    if (call == calls.end()) return false;
+
+    call->response = make_unique<uint8[]>(size);
+    call->responseSize = size;
+    call->completed = true;
+
+    if (size > 0) memcpy(call->response.get(), response, size);
+
+    return true;
+}
+
+bool NetworkRpcTracker::Cancel() {
+    bool cancelled = false;
+
+    for (auto& call : calls) {
+        if (call.completed) continue;
+
+        call.completed = true;
+        cancelled = true;
+    }
+
+    return cancelled;
+}
+
+void NetworkRpcTracker::Clear() { calls.clear(); }
+
+NetworkRpcTracker::State NetworkRpcTracker::Resume(emuptr sp, uint32 tag) {
+    auto call = find_if(calls.begin(), calls.end(),
+                        [&](const Call& call) { return call.sp == sp && call.tag == tag; });
+
+    if (call == calls.end()) return State::unknown;
+    if (!call->completed) return State::pending;
+
+    Call completedCall = move(*call);
+    calls.erase(call);
+
+    if (completedCall.response)
+        completedCall.onSuccess(completedCall.response.get(), completedCall.responseSize);
+    else
+        completedCall.onFail();
+
+    return State::completed;
+}
+
+size_t NetworkRpcTracker::PendingCount() const {
+    return count_if(calls.begin(), calls.end(), [](const Call& call) { return !call.completed; });
+}
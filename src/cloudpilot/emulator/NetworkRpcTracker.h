@@ -0,0 +1,71 @@
+#ifndef _NETWORK_RPC_TRACKER_H_
+#define _NETWORK_RPC_TRACKER_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "EmCommon.h"
+
+// Keeps track of the NetLib calls that wait for a response from the proxy.
+// A blocked call executes again whenever the CPU wakes up, so it has no
+// identity of its own; it is identified by the stack pointer of the calling
+// task and the type of the request. Responses are matched by request id, in
+// any order.
+
+class NetworkRpcTracker {
+   public:
+    using successCallbackT = function<void(void* response, size_t size)>;
+    using failCallbackT = function<void()>;
+
+    enum class State : uint8 { unknown, pending, completed };
+
+   public:
+    NetworkRpcTracker() = default;
+
+    void Add(uint32 id, emuptr sp, uint32 tag, successCallbackT onSuccess, failCallbackT onFail);
+
+    // Completes a call that is waiting for its response. Completed calls are
+    // finished when the calling task resumes them. Returns false if no call
+    // waits for this id.
+    bool Complete(uint32 id, const uint8* response, size_t size);
+
+    // Completes all waiting calls with an error. Returns false if there were
+    // none.
+    bool Cancel();
+
+    // Drops all calls without invoking their callbacks. Responses that arrive
+    // later are discarded.
+    void Clear();
+
+    // Invoked when a task executes a call. A completed call is removed, and
+    // its callback is invoked. Pending and unknown calls are left alone.
+    State Resume(emuptr sp, uint32 tag);
+
+    size_t PendingCount() const;
+
+   private:
+    struct Call {
+        uint32 id;
+        emuptr sp;
+        uint32 tag;
+
+        successCallbackT onSuccess;
+        failCallbackT onFail;
+
+        bool completed{false};
+        unique_ptr<uint8[]> response;
+        size_t responseSize{0};
+    };
+
+   private:
+    vector<Call> calls;
+
+   private:
+    NetworkRpcTracker(const NetworkRpcTracker&) = delete;
+    NetworkRpcTracker(NetworkRpcTracker&&) = delete;
+    NetworkRpcTracker& operator=(const NetworkRpcTracker&) = delete;
+    NetworkRpcTracker& operator=(NetworkRpcTracker&&) = delete;
+};
+
+#endif  // _NETWORK_RPC_TRACKER_H_
@@ -4,6 +4,28 @@
 #include <cstring>
 #include <ctime>
 
+#include "EmSessionContext.h"
+
+namespace {
+    thread_local function<int64()> clockOverride;
+    thread_local function<uint32()> randomOverride;
+
+    const EmSessionState sessionState{EM_SESSION_VARIABLE(clockOverride),
+                                      EM_SESSION_VARIABLE(randomOverride)};
+
+    void currentTime(tm& t) {
+        if (clockOverride) {
+            time_t time = clockOverride();
+            gmtime_r(&time, &t);
+
+            return;
+        }
+
+        time_t time = chrono::system_clock::to_time_t(chrono::system_clock::now());
+        localtime_r(&time, &t);
+    }
+}  // namespace
+
 long Platform::GetMilliseconds() {
     return chrono::duration_cast<chrono::milliseconds>(
                chrono::system_clock::now().time_since_epoch())
@@ -11,10 +33,8 @@ long Platform::GetMilliseconds() {
 }
 
 void Platform::GetTime(uint32& hour, uint32& min, uint32& sec) {
-    time_t time = chrono::system_clock::to_time_t(chrono::system_clock::now());
-
     tm t;
-    localtime_r(&time, &t);
+    currentTime(t);
 
     hour = t.tm_hour;
     min = t.tm_min;
@@ -22,10 +42,8 @@ void Platform::GetTime(uint32& hour, uint32& min, uint32& sec) {
 }
 
 void Platform::GetDate(uint32& year, uint32& month, uint32& day) {
-    time_t time = chrono::system_clock::to_time_t(chrono::system_clock::now());
-
     tm t;
-    localtime_r(&time, &t);
+    currentTime(t);
 
     year = t.tm_year + 1900;
     month = t.tm_mon + 1;
@@ -45,4 +63,8 @@ void* Platform::AllocateMemoryClear(size_t count) {
     return mem;
 }
 
-uint32 Platform::Random() { return rand(); }
+uint32 Platform::Random() { return randomOverride ? randomOverride() : rand(); }
+
+void Platform::SetClockOverride(function<int64()> clock) { clockOverride = clock; }
+
+void Platform::SetRandomOverride(function<uint32()> random) { randomOverride = random; }
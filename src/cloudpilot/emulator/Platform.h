@@ -2,6 +2,7 @@
 #define _PLATFORM_H_
 
 #include <cstdlib>
+#include <functional>
 
 #include "EmCommon.h"
 
@@ -20,6 +21,15 @@ namespace Platform {
     void GetDate(uint32& year, uint32& month, uint32& day);
 
     uint32 Random();
+
+    // Replaces the host clock with a virtual clock that returns local wall
+    // clock time in seconds since the epoch (interpreted as UTC, so the result
+    // does not depend on the time zone of the host). Pass nullptr to restore
+    // the host clock.
+    void SetClockOverride(function<int64()> clock);
+
+    // Replaces the host random number generator. Pass nullptr to restore it.
+    void SetRandomOverride(function<uint32()> random);
 }  // namespace Platform
 
 ///////////////////////////////////////////////////////////////////////////////
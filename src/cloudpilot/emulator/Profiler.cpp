@@ -0,0 +1,201 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "EmBankROM.h"
+#include "EmBankSRAM.h"
+#include "EmMemory.h"
+#include "EmSessionContext.h"
+#include "UAE.h"
+
+namespace {
+    constexpr uint16 OPCODE_RTS = 0x4e75;
+    constexpr uint32 RTS_SEARCH_LIMIT = 0x1000;
+    constexpr size_t MAX_NAME_LENGTH = 64;
+
+    bool inRam(emuptr address, uint32 size) {
+        return address >= gMemoryStart &&
+               address - gMemoryStart + size <= EmMemory::GetRegionSize(MemoryRegion::ram);
+    }
+
+    bool inRom(emuptr address, uint32 size) {
+        emuptr romStart = EmBankROM::GetMemoryStart();
+
+        return address >= romStart && address - romStart + size <= EmBankROM::GetRomSize();
+    }
+
+    bool isValid(emuptr address, uint32 size) {
+        return inRam(address, size) || inRom(address, size);
+    }
+
+    string macsbugName(emuptr pc) {
+        CEnableFullAccess munge;
+
+        pc &= ~1;
+        emuptr rtsAddr;
+
+        for (rtsAddr = pc; rtsAddr < pc + RTS_SEARCH_LIMIT; rtsAddr += 2) {
+            if (!isValid(rtsAddr, 2)) return "";
+            if (EmMemGet16(rtsAddr) == OPCODE_RTS) break;
+        }
+
+        if (rtsAddr >= pc + RTS_SEARCH_LIMIT) return "";
+
+        string name;
+
+        for (emuptr addr = rtsAddr + 3; name.size() < MAX_NAME_LENGTH; addr++) {
+            if (!isValid(addr, 1)) return "";
+
+            uint8 c = EmMemGet8(addr);
+            if (c == 0) break;
+            if (c < 0x20 || c >= 0x7f) return "";
+
+            name.push_back(c);
+        }
+
+        return name.size() < MAX_NAME_LENGTH ? name : "";
+    }
+
+    string hexAddress(emuptr address) {
+        char buffer[11];
+        snprintf(buffer, sizeof(buffer), "0x%08x", address);
+
+        return buffer;
+    }
+
+    thread_local Profiler profiler;
+}  // namespace
+
+thread_local Profiler* gProfiler{&profiler};
+
+namespace {
+    const EmSessionState sessionState{EM_SESSION_OBJECT(gProfiler)};
+}  // namespace
+
+void Profiler::Start(uint32 sampleInterval) {
+    this->sampleInterval = max(sampleInterval, 1u);
+
+    running = true;
+    synced = false;
+}
+
+void Profiler::Stop() { running = false; }
+
+void Profiler::Clear() {
+    synced = false;
+
+    totalCycles = 0;
+    cyclesSinceSample = 0;
+    sampleCount = 0;
+
+    pcCycles.clear();
+    stackCycles.clear();
+}
+
+void Profiler::Tick(uint64 cycles, emuptr pc) {
+    // The cycle count jumps backwards if the emulator rewinds or calls into
+    // the ROM as a subroutine. Just pick up from the new value.
+    if (synced && cycles >= lastCycles) {
+        const uint64 delta = cycles - lastCycles;
+
+        pcCycles[lastPc] += delta;
+        totalCycles += delta;
+        cyclesSinceSample += delta;
+
+        if (cyclesSinceSample >= sampleInterval) Sample(lastPc);
+    }
+
+    synced = true;
+    lastCycles = cycles;
+    lastPc = pc;
+}
+
+void Profiler::Sample(emuptr pc) {
+    CEnableFullAccess munge;
+
+    vector<emuptr> stack{pc};
+    emuptr fp = m68k_areg(regs, 6);
+
+    while (stack.size() < MAX_STACK_DEPTH && (fp & 1) == 0 && inRam(fp, 8)) {
+        const emuptr returnAddress = EmMemGet32(fp + 4);
+        const emuptr nextFp = EmMemGet32(fp);
+
+        if (!isValid(returnAddress, 2)) break;
+
+        stack.push_back(returnAddress);
+
+        if (nextFp <= fp) break;
+        fp = nextFp;
+    }
+
+    stackCycles[stack] += cyclesSinceSample;
+
+    cyclesSinceSample = 0;
+    sampleCount++;
+}
+
+void Profiler::SetSymbols(vector<Symbol> symbols) {
+    sort(symbols.begin(), symbols.end(),
+         [](const Symbol& s1, const Symbol& s2) { return s1.address < s2.address; });
+
+    this->symbols = move(symbols);
+    nameCache.clear();
+}
+
+string Profiler::ResolveName(emuptr address) const {
+    if (address == IDLE_PC) return "[idle]";
+
+    if (auto cached = nameCache.find(address); cached != nameCache.end()) return cached->second;
+
+    string name;
+
+    auto symbol = upper_bound(symbols.begin(), symbols.end(), address,
+                              [](emuptr address, const Symbol& s) { return address < s.address; });
+
+    if (symbol != symbols.begin() && address - (symbol - 1)->address < (symbol - 1)->size)
+        name = (symbol - 1)->name;
+
+    if (name.empty()) name = macsbugName(address);
+    if (name.empty()) name = hexAddress(address);
+
+    nameCache[address] = name;
+
+    return name;
+}
+
+vector<pair<string, uint64>> Profiler::GetFunctionCycles() const {
+    unordered_map<string, uint64> functionCycles;
+
+    for (auto [pc, cycles] : pcCycles) functionCycles[ResolveName(pc)] += cycles;
+
+    vector<pair<string, uint64>> result(functionCycles.begin(), functionCycles.end());
+
+    sort(result.begin(), result.end(), [](const auto& f1, const auto& f2) {
+        return f1.second != f2.second ? f1.second > f2.second : f1.first < f2.first;
+    });
+
+    return result;
+}
+
+void Profiler::WriteCollapsedStacks(ostream& stream) const {
+    map<string, uint64> collapsed;
+
+    for (auto& [stack, cycles] : stackCycles) {
+        string line;
+
+        for (auto frame = stack.rbegin(); frame != stack.rend(); frame++) {
+            if (!line.empty()) line.push_back(';');
+
+            string name = ResolveName(*frame);
+            replace(name.begin(), name.end(), ';', ':');
+            replace(name.begin(), name.end(), ' ', '_');
+
+            line += name;
+        }
+
+        collapsed[line] += cycles;
+    }
+
+    for (auto& [line, cycles] : collapsed) stream << line << " " << cycles << endl;
+}
@@ -0,0 +1,98 @@
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "EmCommon.h"
+
+// Attributes emulated cycles to the instructions that consume them. While the
+// profiler is running, the CPU reports every completed instruction, and each
+// PC is charged with the exact number of cycles spent on it. In addition, the
+// call stack is sampled by following the A6 frame chain every
+// `sampleInterval` cycles, weighted by the cycles since the last sample.
+//
+// Addresses are resolved to function names when a report is generated: ELF
+// symbols take precedence, then the macsbug names that follow the RTS of
+// functions compiled with them. Collapsed stacks can be fed to flamegraph.pl
+// or speedscope.
+//
+// The hook in the CPU loop rides on the special flags that are checked after
+// every instruction anyway, so the profiler costs nothing while it is off.
+
+class Profiler {
+   public:
+    static constexpr uint32 DEFAULT_SAMPLE_INTERVAL = 1000;
+    static constexpr size_t MAX_STACK_DEPTH = 32;
+
+    // Stands in for the PC while the CPU is stopped.
+    static constexpr emuptr IDLE_PC = 0xffffffff;
+
+    struct Symbol {
+        emuptr address;
+        uint32 size;
+        string name;
+    };
+
+   public:
+    Profiler() = default;
+
+    void Start(uint32 sampleInterval = DEFAULT_SAMPLE_INTERVAL);
+    void Stop();
+    void Clear();
+
+    bool IsRunning() const { return running; }
+
+    // Called by the CPU after each instruction. `cycles` is the running cycle
+    // count, `pc` the address of the next instruction or IDLE_PC.
+    void Tick(uint64 cycles, emuptr pc);
+
+    // Function symbols, relocated to their addresses in emulated memory.
+    void SetSymbols(vector<Symbol> symbols);
+
+    string ResolveName(emuptr address) const;
+
+    uint64 GetTotalCycles() const { return totalCycles; }
+    size_t GetSampleCount() const { return sampleCount; }
+
+    // Cycles per function, in descending order.
+    vector<pair<string, uint64>> GetFunctionCycles() const;
+
+    // One line per distinct stack: "outermost;...;innermost cycles".
+    void WriteCollapsedStacks(ostream& stream) const;
+
+   private:
+    void Sample(emuptr pc);
+
+   private:
+    bool running{false};
+    uint32 sampleInterval{DEFAULT_SAMPLE_INTERVAL};
+
+    bool synced{false};
+    uint64 lastCycles{0};
+    emuptr lastPc{IDLE_PC};
+
+    uint64 totalCycles{0};
+    uint64 cyclesSinceSample{0};
+    size_t sampleCount{0};
+
+    unordered_map<emuptr, uint64> pcCycles;
+    map<vector<emuptr>, uint64> stackCycles;
+
+    vector<Symbol> symbols;
+    mutable unordered_map<emuptr, string> nameCache;
+
+   private:
+    Profiler(const Profiler&) = delete;
+    Profiler(Profiler&&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+    Profiler& operator=(Profiler&&) = delete;
+};
+
+extern thread_local Profiler* gProfiler;
+
+#endif  // _PROFILER_H_
@@ -786,6 +786,20 @@ Err SysUIAppSwitch(UInt16 cardNo, LocalID dbID, UInt16 cmd, emuptr cmdPBP) {
     RETURN_RESULT_VAL(Err);
 }
 
+Err SysCurAppDatabase(UInt16* cardNoP, LocalID* dbIDP) {
+    CALLER_SETUP("Err", "UInt16* cardNoP, LocalID* dbIDP");
+
+    CALLER_PUT_PARAM_REF(UInt16, cardNoP, Marshal::kOutput);
+    CALLER_PUT_PARAM_REF(LocalID, dbIDP, Marshal::kOutput);
+
+    sub.Call(sysTrapSysCurAppDatabase);
+
+    CALLER_GET_PARAM_REF(cardNoP);
+    CALLER_GET_PARAM_REF(dbIDP);
+
+    RETURN_RESULT_VAL(Err);
+}
+
 UInt16 DmNumResources(emuptr dbP) {
     CALLER_SETUP("UInt16", "DmOpenRef dbP");
 
@@ -0,0 +1,277 @@
+#include "Recording.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    constexpr uint32 MAGIC = 0x43524e53;
+    constexpr uint32 VERSION = 1;
+    constexpr size_t HEADER_SIZE = 48;
+    constexpr size_t EVENT_SIZE = 24;
+    constexpr size_t CHECKPOINT_HEADER_SIZE = 16;
+
+    constexpr uint8 FLAG_PEN_DOWN = 0x01;
+    constexpr uint8 FLAG_CTRL = 0x02;
+    constexpr uint8 FLAG_RELEASE = 0x04;
+
+    void put32(uint8* buffer, uint32 value) {
+        buffer[0] = value & 0xff;
+        buffer[1] = (value >> 8) & 0xff;
+        buffer[2] = (value >> 16) & 0xff;
+        buffer[3] = (value >> 24) & 0xff;
+    }
+
+    uint32 get32(const uint8* buffer) {
+        return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | (buffer[3] << 24);
+    }
+
+    void put64(uint8* buffer, uint64 value) {
+        put32(buffer, value & 0xffffffff);
+        put32(buffer + 4, value >> 32);
+    }
+
+    uint64 get64(const uint8* buffer) {
+        return static_cast<uint64>(get32(buffer)) | (static_cast<uint64>(get32(buffer + 4)) << 32);
+    }
+
+    void putEvent(uint8* buffer, const Recording::Event& event) {
+        uint8 flags = 0;
+        if (event.penEvent.isPenDown()) flags |= FLAG_PEN_DOWN;
+        if (event.ctrl) flags |= FLAG_CTRL;
+        if (event.buttonType == ButtonEvent::Type::release) flags |= FLAG_RELEASE;
+
+        memset(buffer, 0, EVENT_SIZE);
+
+        put64(buffer, event.cycles);
+        buffer[8] = static_cast<uint8>(event.kind);
+        buffer[9] = flags;
+        buffer[10] = static_cast<uint8>(event.button);
+        put32(buffer + 12, event.penEvent.getX());
+        put32(buffer + 16, event.penEvent.getY());
+        put32(buffer + 20, event.key);
+    }
+
+    bool getEvent(const uint8* buffer, Recording::Event& event) {
+        const uint8 kind = buffer[8];
+        const uint8 flags = buffer[9];
+        const uint8 button = buffer[10];
+
+        if (kind > static_cast<uint8>(Recording::Event::Kind::button)) return false;
+        if (button > static_cast<uint8>(ButtonEvent::Button::wheelPush)) return false;
+
+        event.cycles = get64(buffer);
+        event.kind = static_cast<Recording::Event::Kind>(kind);
+        event.penEvent = (flags & FLAG_PEN_DOWN)
+                             ? PenEvent::down(get32(buffer + 12), get32(buffer + 16))
+                             : PenEvent::up();
+        event.key = get32(buffer + 20);
+        event.ctrl = flags & FLAG_CTRL;
+        event.button = static_cast<ButtonEvent::Button>(button);
+        event.buttonType =
+            (flags & FLAG_RELEASE) ? ButtonEvent::Type::release : ButtonEvent::Type::press;
+
+        return true;
+    }
+}  // namespace
+
+void Recording::Clear() {
+    startTime = 0;
+    randomSeed = 0;
+    clockFactor = 1;
+    endCycles = 0;
+    hostInput = 0;
+
+    events.clear();
+    checkpoints.clear();
+
+    serializedImage.reset();
+    serializedImageSize = 0;
+}
+
+void Recording::SetEnvironment(int64 startTime, uint32 randomSeed, double clockFactor) {
+    this->startTime = startTime;
+    this->randomSeed = randomSeed;
+    this->clockFactor = clockFactor;
+}
+
+int64 Recording::GetStartTime() const { return startTime; }
+
+uint32 Recording::GetRandomSeed() const { return randomSeed; }
+
+double Recording::GetClockFactor() const { return clockFactor; }
+
+void Recording::MarkHostInput(HostInput input) { hostInput |= static_cast<uint32>(input); }
+
+bool Recording::UsesHostInput(HostInput input) const {
+    return hostInput & static_cast<uint32>(input);
+}
+
+bool Recording::IsDeterministic() const { return hostInput == 0; }
+
+uint64 Recording::GetStartCycles() const {
+    return checkpoints.empty() ? 0 : checkpoints.front().cycles;
+}
+
+uint64 Recording::GetEndCycles() const { return endCycles; }
+
+void Recording::SetEndCycles(uint64 endCycles) { this->endCycles = endCycles; }
+
+bool Recording::AddEvent(const Event& event) {
+    if (checkpoints.empty() || event.cycles < checkpoints.back().cycles) return false;
+    if (!events.empty() && event.cycles < events.back().cycles) return false;
+
+    events.push_back(event);
+    endCycles = max(endCycles, event.cycles);
+
+    return true;
+}
+
+const vector<Recording::Event>& Recording::GetEvents() const { return events; }
+
+bool Recording::AddCheckpoint(uint64 cycles, DeltaSnapshot& snapshot) {
+    if (checkpoints.empty() != (snapshot.GetKind() == DeltaSnapshot::Kind::full)) return false;
+    if (!checkpoints.empty() && cycles < checkpoints.back().cycles) return false;
+    if (!events.empty() && cycles < events.back().cycles) return false;
+
+    if (!snapshot.Serialize()) return false;
+
+    const uint8* image = static_cast<const uint8*>(snapshot.GetSerializedImage());
+
+    checkpoints.push_back(
+        {cycles, events.size(), vector<uint8>(image, image + snapshot.GetSerializedImageSize())});
+    endCycles = max(endCycles, cycles);
+
+    return true;
+}
+
+const vector<Recording::Checkpoint>& Recording::GetCheckpoints() const { return checkpoints; }
+
+size_t Recording::FindCheckpoint(uint64 cycles) const {
+    auto it = upper_bound(checkpoints.begin(), checkpoints.end(), cycles,
+                          [](uint64 cycles, const Checkpoint& checkpoint) {
+                              return cycles < checkpoint.cycles;
+                          });
+
+    return it == checkpoints.begin() ? 0 : it - checkpoints.begin() - 1;
+}
+
+bool Recording::RestoreCheckpoint(size_t index, DeltaSnapshot& snapshot) const {
+    if (index >= checkpoints.size()) return false;
+
+    const vector<uint8>& base = checkpoints[0].snapshot;
+    if (!snapshot.Deserialize(base.data(), base.size())) return false;
+
+    for (size_t i = 1; i <= index; i++) {
+        DeltaSnapshot delta;
+        const vector<uint8>& image = checkpoints[i].snapshot;
+
+        if (!delta.Deserialize(image.data(), image.size()) || !snapshot.Compact(delta))
+            return false;
+    }
+
+    return true;
+}
+
+bool Recording::Serialize() {
+    serializedImageSize = HEADER_SIZE + events.size() * EVENT_SIZE;
+    for (auto& checkpoint : checkpoints)
+        serializedImageSize += CHECKPOINT_HEADER_SIZE + checkpoint.snapshot.size();
+
+    serializedImage = make_unique<uint8[]>(serializedImageSize);
+
+    uint8* buffer = serializedImage.get();
+
+    uint64 clockFactorBits;
+    memcpy(&clockFactorBits, &clockFactor, sizeof(clockFactorBits));
+
+    memset(buffer, 0, HEADER_SIZE);
+    put32(buffer, MAGIC);
+    put32(buffer + 4, VERSION);
+    put64(buffer + 8, startTime);
+    put64(buffer + 16, clockFactorBits);
+    put64(buffer + 24, endCycles);
+    put32(buffer + 32, randomSeed);
+    put32(buffer + 36, events.size());
+    put32(buffer + 40, checkpoints.size());
+    put32(buffer + 44, hostInput);
+    buffer += HEADER_SIZE;
+
+    for (auto& event : events) {
+        putEvent(buffer, event);
+        buffer += EVENT_SIZE;
+    }
+
+    for (auto& checkpoint : checkpoints) {
+        put64(buffer, checkpoint.cycles);
+        put32(buffer + 8, checkpoint.nextEvent);
+        put32(buffer + 12, checkpoint.snapshot.size());
+        buffer += CHECKPOINT_HEADER_SIZE;
+
+        memcpy(buffer, checkpoint.snapshot.data(), checkpoint.snapshot.size());
+        buffer += checkpoint.snapshot.size();
+    }
+
+    return true;
+}
+
+void* Recording::GetSerializedImage() const { return serializedImage.get(); }
+
+size_t Recording::GetSerializedImageSize() const { return serializedImageSize; }
+
+bool Recording::Deserialize(const void* buffer, size_t size) {
+    const uint8* data = static_cast<const uint8*>(buffer);
+    const uint8* end = data + size;
+
+    if (size < HEADER_SIZE || get32(data) != MAGIC || get32(data + 4) != VERSION) return false;
+
+    const uint64 clockFactorBits = get64(data + 16);
+    const size_t eventCount = get32(data + 36);
+    const size_t checkpointCount = get32(data + 40);
+
+    if (eventCount > (size - HEADER_SIZE) / EVENT_SIZE || checkpointCount == 0) return false;
+
+    vector<Event> events(eventCount);
+    vector<Checkpoint> checkpoints;
+
+    const uint8* cursor = data + HEADER_SIZE;
+
+    for (size_t i = 0; i < eventCount; i++) {
+        if (!getEvent(cursor, events[i])) return false;
+        if (i > 0 && events[i].cycles < events[i - 1].cycles) return false;
+
+        cursor += EVENT_SIZE;
+    }
+
+    for (size_t i = 0; i < checkpointCount; i++) {
+        if (static_cast<size_t>(end - cursor) < CHECKPOINT_HEADER_SIZE) return false;
+
+        const uint64 cycles = get64(cursor);
+        const size_t nextEvent = get32(cursor + 8);
+        const size_t snapshotSize = get32(cursor + 12);
+        cursor += CHECKPOINT_HEADER_SIZE;
+
+        if (static_cast<size_t>(end - cursor) < snapshotSize || nextEvent > eventCount)
+            return false;
+        if (i > 0 &&
+            (cycles < checkpoints.back().cycles || nextEvent < checkpoints.back().nextEvent))
+            return false;
+
+        checkpoints.push_back({cycles, nextEvent, vector<uint8>(cursor, cursor + snapshotSize)});
+        cursor += snapshotSize;
+    }
+
+    if (cursor != end) return false;
+
+    Clear();
+
+    startTime = get64(data + 8);
+    memcpy(&clockFactor, &clockFactorBits, sizeof(clockFactor));
+    endCycles = get64(data + 24);
+    randomSeed = get32(data + 32);
+    hostInput = get32(data + 44);
+
+    this->events = move(events);
+    this->checkpoints = move(checkpoints);
+
+    return true;
+}
@@ -0,0 +1,113 @@
+#ifndef _RECORDING_H_
+#define _RECORDING_H_
+
+#include <memory>
+#include <vector>
+
+#include "ButtonEvent.h"
+#include "DeltaSnapshot.h"
+#include "EmCommon.h"
+#include "PenEvent.h"
+
+// A recording of a session that can be replayed deterministically. It holds
+//
+//   * the seeds of the emulated environment: the local wall clock time at the
+//     start of the recording, the seed for random numbers and the clock factor,
+//   * all pen, key and button events, stamped with the system cycle count at
+//     which the host queued them, and
+//   * checkpoints. The first checkpoint is a full snapshot of the state the
+//     recording starts from, all others are deltas against their predecessor.
+//
+// Network and serial input are not recorded. A recording notes whether the
+// session used them, and replay stops at their first use.
+//
+// Seeking to a checkpoint compacts the base and all deltas up to it into a
+// full snapshot.
+
+class Recording {
+   public:
+    struct Event {
+        enum class Kind : uint8 { pen = 0, key = 1, button = 2 };
+
+        uint64 cycles{0};
+        Kind kind{Kind::pen};
+
+        PenEvent penEvent;
+        uint16 key{0};
+        bool ctrl{false};
+        ButtonEvent::Button button{ButtonEvent::Button::invalid};
+        ButtonEvent::Type buttonType{ButtonEvent::Type::press};
+    };
+
+    enum class HostInput : uint8 { network = 0x01, serial = 0x02 };
+
+    struct Checkpoint {
+        uint64 cycles;
+
+        // Index of the first event that is not part of the checkpoint.
+        size_t nextEvent;
+
+        // Serialized DeltaSnapshot.
+        vector<uint8> snapshot;
+    };
+
+   public:
+    Recording() = default;
+
+    void Clear();
+
+    void SetEnvironment(int64 startTime, uint32 randomSeed, double clockFactor);
+    int64 GetStartTime() const;
+    uint32 GetRandomSeed() const;
+    double GetClockFactor() const;
+
+    void MarkHostInput(HostInput input);
+    bool UsesHostInput(HostInput input) const;
+    bool IsDeterministic() const;
+
+    uint64 GetStartCycles() const;
+    uint64 GetEndCycles() const;
+    void SetEndCycles(uint64 endCycles);
+
+    // Events must be added in order.
+    bool AddEvent(const Event& event);
+    const vector<Event>& GetEvents() const;
+
+    // The first checkpoint must be a full snapshot. Checkpoints capture the
+    // events that have been added so far.
+    bool AddCheckpoint(uint64 cycles, DeltaSnapshot& snapshot);
+    const vector<Checkpoint>& GetCheckpoints() const;
+
+    // The latest checkpoint at or before the given cycle count.
+    size_t FindCheckpoint(uint64 cycles) const;
+
+    // Assembles a full snapshot of the given checkpoint.
+    bool RestoreCheckpoint(size_t index, DeltaSnapshot& snapshot) const;
+
+    bool Serialize();
+    void* GetSerializedImage() const;
+    size_t GetSerializedImageSize() const;
+
+    bool Deserialize(const void* buffer, size_t size);
+
+   private:
+    int64 startTime{0};
+    uint32 randomSeed{0};
+    double clockFactor{1};
+    uint64 endCycles{0};
+    uint32 hostInput{0};
+
+    vector<Event> events;
+    vector<Checkpoint> checkpoints;
+
+    unique_ptr<uint8[]> serializedImage;
+    size_t serializedImageSize{0};
+
+   private:
+    Recording(const Recording&) = delete;
+    Recording(Recording&&) = delete;
+    Recording& operator=(const Recording&) = delete;
+    Recording& operator=(Recording&&) = delete;
+};
+
+#endif  // _RECORDING_H_
@@ -0,0 +1,225 @@
+#include "RewindBuffer.h"
+
+#include "EmMemory.h"
+
+namespace {
+    constexpr uint32 PAGE_SIZE = DeltaSnapshot::PAGE_SIZE;
+}
+
+void RewindBuffer::SetCapacity(size_t capacity) {
+    this->capacity = capacity;
+
+    if (capacity == 0)
+        Reset();
+    else
+        Trim();
+}
+
+size_t RewindBuffer::GetCapacity() const { return capacity; }
+
+bool RewindBuffer::IsEnabled() const { return capacity > 0; }
+
+void RewindBuffer::Reset() {
+    if (dirtyPages) EmMemory::RemoveDirtyPageSink(dirtyPages.get());
+
+    points.clear();
+    historySize = 0;
+
+    shadow.reset();
+    dirtyPages.reset();
+    memorySize = 0;
+    dirtyPagesSize = 0;
+
+    restorePending = false;
+    restoreRollback = DeltaSnapshot();
+    restoreDirtyPages.reset();
+}
+
+void RewindBuffer::Capture(const void* savestate, size_t savestateSize, uint64 systemCycles) {
+    EmAssert(!restorePending);
+    if (!IsEnabled()) return;
+
+    Track();
+    EmMemory::CollectDirtyPages();
+
+    const uint8* memory = EmMemory::GetTotalMemory();
+
+    if (!points.empty()) {
+        DeltaSnapshot& undo(points.back().undo);
+        historySize -= SizeOf(undo);
+
+        for (uint32 i = 0; i < memorySize / PAGE_SIZE; i++) {
+            if ((dirtyPages[i >> 3] & (1 << (i & 0x07))) == 0) continue;
+
+            undo.AddPage(i, shadow.get() + i * PAGE_SIZE);
+            memcpy(shadow.get() + i * PAGE_SIZE, memory + i * PAGE_SIZE, PAGE_SIZE);
+        }
+
+        historySize += SizeOf(undo);
+    }
+
+    memset(dirtyPages.get(), 0, dirtyPagesSize);
+
+    points.push_back({systemCycles, DeltaSnapshot(DeltaSnapshot::Kind::delta, 0, 0, memorySize)});
+    points.back().undo.SetSavestate(savestate, savestateSize);
+    historySize += SizeOf(points.back().undo);
+
+    Trim();
+}
+
+bool RewindBuffer::Restore(size_t steps) {
+    if (!BeginRestore(steps)) return false;
+
+    CommitRestore();
+
+    return true;
+}
+
+bool RewindBuffer::BeginRestore(size_t steps) {
+    EmAssert(!restorePending);
+    if (steps >= points.size()) return false;
+
+    EmMemory::CollectDirtyPages();
+
+    uint8* memory = EmMemory::GetTotalMemory();
+    uint8* bankDirtyPages = EmMemory::GetBankDirtyPages();
+
+    // The restore touches everything that was written since the latest point
+    // and the undo pages of all points that are unwound. Keep their current
+    // contents for a rollback.
+
+    vector<uint8> touchedPages(dirtyPages.get(), dirtyPages.get() + dirtyPagesSize);
+
+    for (size_t i = 1; i <= steps; i++) {
+        const DeltaSnapshot& undo(points[points.size() - 1 - i].undo);
+
+        for (size_t j = 0; j < undo.GetPageCount(); j++) {
+            const uint32 index = undo.GetPageIndex(j);
+            touchedPages[index >> 3] |= (1 << (index & 0x07));
+        }
+    }
+
+    restoreRollback = DeltaSnapshot(DeltaSnapshot::Kind::delta, 0, 0, memorySize);
+
+    for (uint32 i = 0; i < memorySize / PAGE_SIZE; i++)
+        if (touchedPages[i >> 3] & (1 << (i & 0x07)))
+            restoreRollback.AddPage(i, memory + i * PAGE_SIZE);
+
+    // Revert everything that was written since the latest point, then walk
+    // back through the undo pages.
+
+    for (uint32 i = 0; i < memorySize / PAGE_SIZE; i++) {
+        if ((dirtyPages[i >> 3] & (1 << (i & 0x07))) == 0) continue;
+
+        memcpy(memory + i * PAGE_SIZE, shadow.get() + i * PAGE_SIZE, PAGE_SIZE);
+        bankDirtyPages[i >> 3] |= (1 << (i & 0x07));
+    }
+
+    for (size_t i = 1; i <= steps; i++)
+        points[points.size() - 1 - i].undo.Apply(memory, memorySize, bankDirtyPages);
+
+    // The restored pages are now marked for the other consumers. Our own marks
+    // are set aside for a rollback, so from here on only later writes (like
+    // those done while loading the savestate) are tracked.
+
+    EmMemory::CollectDirtyPages();
+    memcpy(restoreDirtyPages.get(), dirtyPages.get(), dirtyPagesSize);
+    memset(dirtyPages.get(), 0, dirtyPagesSize);
+
+    restorePending = true;
+    restoreSteps = steps;
+
+    return true;
+}
+
+void RewindBuffer::CommitRestore() {
+    EmAssert(restorePending);
+
+    // Bring the shadow in line with the restored memory and drop the newer
+    // points.
+
+    for (size_t i = 0; i < restoreSteps; i++) {
+        historySize -= SizeOf(points.back().undo);
+        points.pop_back();
+
+        Point& point(points.back());
+
+        point.undo.Apply(shadow.get(), memorySize);
+
+        DeltaSnapshot latest(DeltaSnapshot::Kind::delta, 0, 0, memorySize);
+        latest.SetSavestate(point.undo.GetSavestate(), point.undo.GetSavestateSize());
+
+        historySize -= SizeOf(point.undo);
+        point.undo = move(latest);
+        historySize += SizeOf(point.undo);
+    }
+
+    restorePending = false;
+    restoreRollback = DeltaSnapshot();
+}
+
+void RewindBuffer::RollBackRestore() {
+    EmAssert(restorePending);
+
+    restoreRollback.Apply(EmMemory::GetTotalMemory(), memorySize, EmMemory::GetBankDirtyPages());
+
+    // The shadow did not change, so everything that differed from it before
+    // still does.
+
+    EmMemory::CollectDirtyPages();
+    for (uint32 i = 0; i < dirtyPagesSize; i++) dirtyPages[i] |= restoreDirtyPages[i];
+
+    restorePending = false;
+    restoreRollback = DeltaSnapshot();
+}
+
+size_t RewindBuffer::GetDepth() const { return points.size(); }
+
+uint64 RewindBuffer::GetSystemCycles(size_t steps) const {
+    EmAssert(steps < points.size());
+
+    return points[points.size() - 1 - steps].systemCycles;
+}
+
+const void* RewindBuffer::GetSavestate(size_t steps) const {
+    EmAssert(steps < points.size());
+
+    return points[points.size() - 1 - steps].undo.GetSavestate();
+}
+
+size_t RewindBuffer::GetSavestateSize(size_t steps) const {
+    EmAssert(steps < points.size());
+
+    return points[points.size() - 1 - steps].undo.GetSavestateSize();
+}
+
+size_t RewindBuffer::GetHistorySize() const { return historySize; }
+
+size_t RewindBuffer::GetMemoryUsage() const { return historySize + (shadow ? memorySize : 0); }
+
+void RewindBuffer::Track() {
+    if (shadow) return;
+
+    memorySize = EmMemory::GetTotalMemorySize();
+    dirtyPagesSize = EmMemory::GetTotalDirtyPagesSize();
+
+    shadow = make_unique<uint8[]>(memorySize);
+    dirtyPages = make_unique<uint8[]>(dirtyPagesSize);
+    restoreDirtyPages = make_unique<uint8[]>(dirtyPagesSize);
+
+    memcpy(shadow.get(), EmMemory::GetTotalMemory(), memorySize);
+    memset(dirtyPages.get(), 0, dirtyPagesSize);
+
+    EmMemory::AddDirtyPageSink(dirtyPages.get());
+}
+
+void RewindBuffer::Trim() {
+    while (points.size() > 1 && historySize > capacity) {
+        historySize -= SizeOf(points.front().undo);
+        points.pop_front();
+    }
+}
+
+size_t RewindBuffer::SizeOf(const DeltaSnapshot& undo) {
+    return undo.GetSavestateSize() + undo.GetPageCount() * (PAGE_SIZE + sizeof(uint32));
+}
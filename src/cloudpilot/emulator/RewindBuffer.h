@@ -0,0 +1,83 @@
+#ifndef _REWIND_BUFFER_H_
+#define _REWIND_BUFFER_H_
+
+#include <deque>
+#include <memory>
+
+#include "DeltaSnapshot.h"
+#include "EmCommon.h"
+
+// A bounded history of rewind points. Every point stores its savestate and
+// the previous contents of all pages that were written before the next point
+// was captured ("undo pages"). A shadow copy of memory at the latest point
+// provides those contents, and a dirty page sink registered with Memory tells
+// which pages changed.
+//
+// Restoring walks back from the latest point and applies the undo pages, so
+// its cost only depends on the amount of memory that changed in between. The
+// oldest points are dropped once the history exceeds the capacity; the
+// shadow copy is not included in the capacity.
+
+class RewindBuffer {
+   public:
+    RewindBuffer() = default;
+
+    // A capacity of zero disables rewind and drops the history.
+    void SetCapacity(size_t capacity);
+    size_t GetCapacity() const;
+    bool IsEnabled() const;
+
+    // Drops the history. The buffer remains enabled.
+    void Reset();
+
+    void Capture(const void* savestate, size_t savestateSize, uint64 systemCycles);
+
+    // Restores memory to the given point (0 is the latest) and drops all newer
+    // points. The savestate of the point must be loaded by the caller.
+    bool Restore(size_t steps);
+
+    // Restore in two steps: BeginRestore reverts memory to the given point and
+    // keeps the pages it overwrote. The history does not change until the
+    // restore is committed; rolling it back reverts memory to where it was.
+    bool BeginRestore(size_t steps);
+    void CommitRestore();
+    void RollBackRestore();
+
+    size_t GetDepth() const;
+    uint64 GetSystemCycles(size_t steps) const;
+    const void* GetSavestate(size_t steps) const;
+    size_t GetSavestateSize(size_t steps) const;
+
+    size_t GetHistorySize() const;
+    size_t GetMemoryUsage() const;
+
+   private:
+    struct Point {
+        uint64 systemCycles;
+        DeltaSnapshot undo;
+    };
+
+   private:
+    void Track();
+    void Trim();
+
+    static size_t SizeOf(const DeltaSnapshot& undo);
+
+   private:
+    size_t capacity{0};
+    size_t historySize{0};
+
+    deque<Point> points;
+
+    unique_ptr<uint8[]> shadow;
+    unique_ptr<uint8[]> dirtyPages;
+    uint32 memorySize{0};
+    uint32 dirtyPagesSize{0};
+
+    bool restorePending{false};
+    size_t restoreSteps{0};
+    DeltaSnapshot restoreRollback;
+    unique_ptr<uint8[]> restoreDirtyPages;
+};
+
+#endif  // _REWIND_BUFFER_H_
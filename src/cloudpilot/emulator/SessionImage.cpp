@@ -1,13 +1,30 @@
 #include "SessionImage.h"
 
+#include <algorithm>
+#include <atomic>
+
+#ifndef __EMSCRIPTEN__
+    #include <thread>
+#endif
+
 #include "miniz.h"
 
 namespace {
     constexpr uint32 MAGIC = 0x20150103;
-    constexpr uint32 VERSION = 0x04;
+    constexpr uint32 VERSION = 0x05;
     constexpr uint32 VERSION_MASK = 0x80000000;
-    constexpr size_t COMPRESSED_IMAGE_GROW_LIMIT = 128 * 1024 * 1024;
-    constexpr size_t UNCOMPRESSED_HEADER_SIZE = 12;
+
+    constexpr size_t CHUNKED_HEADER_SIZE = 32;
+    constexpr size_t CHUNK_DESCRIPTOR_SIZE = 12;
+    constexpr size_t CHUNK_SIZE = 256 * 1024;
+    constexpr size_t MAX_DEVICE_ID_SIZE = 16;
+
+    // Below this amount of (de)compression work per thread, starting a thread
+    // costs more than it saves.
+    constexpr size_t MIN_WORK_PER_THREAD = 4 * CHUNK_SIZE;
+
+    constexpr uint32 CODEC_STORE = 0;
+    constexpr uint32 CODEC_DEFLATE = 1;
 
     void put32(uint8* buffer, uint32 value) {
         buffer[0] = value & 0xff;
@@ -19,6 +36,53 @@ namespace {
     uint32 get32(uint8* buffer) {
         return buffer[0] | (buffer[1] << 8) | (buffer[2] << 16) | (buffer[3] << 24);
     }
+
+    // Runs fn(0) ... fn(count - 1), spreading workSize bytes of work over the
+    // available cores. The calling thread takes part, so this degrades to a
+    // plain loop if there are no threads or if there is little work.
+    template <typename F>
+    void forEachParallel(size_t count, size_t workSize, F fn) {
+#ifdef __EMSCRIPTEN__
+        for (size_t i = 0; i < count; i++) fn(i);
+#else
+        const size_t threadCount =
+            min({count, static_cast<size_t>(max(thread::hardware_concurrency(), 1u)),
+                 max(workSize / MIN_WORK_PER_THREAD, static_cast<size_t>(1))});
+
+        if (threadCount <= 1) {
+            for (size_t i = 0; i < count; i++) fn(i);
+            return;
+        }
+
+        atomic<size_t> next{0};
+
+        auto worker = [&]() {
+            for (size_t i = next++; i < count; i = next++) fn(i);
+        };
+
+        vector<thread> threads;
+        for (size_t i = 1; i < threadCount; i++) threads.emplace_back(worker);
+
+        worker();
+
+        for (auto& thread : threads) thread.join();
+#endif
+    }
+
+    class BufferSink : public SessionImageSink {
+       public:
+        explicit BufferSink(uint8* buffer) : next(buffer) {}
+
+        bool Write(const void* data, size_t size) override {
+            memcpy(next, data, size);
+            next += size;
+
+            return true;
+        }
+
+       private:
+        uint8* next;
+    };
 }  // namespace
 
 const char* SessionImage::GetDeviceId() const { return deviceId.c_str(); }
@@ -83,112 +147,121 @@ uint32 SessionImage::GetFramebufferSize() const { return framebufferSize; }
 
 uint32 SessionImage::GetVersion() const { return version; }
 
-bool SessionImage::Serialize() {
-    version = VERSION;
+SessionImage& SessionImage::SetCompressionLevel(int level) {
+    compressionLevel = max(COMPRESSION_LEVEL_STORE, min(level, COMPRESSION_LEVEL_BEST));
 
-    const size_t uncompressedSize =
-        20 + deviceId.size() + romSize + ramSize + savestateSize + metadataSize;
+    return *this;
+}
 
-    // Assume a compression ratio of at least 2 and make sure that the buffer will actually grow
-    const size_t initialBufferSize = max(static_cast<size_t>(1024), uncompressedSize / 2);
+int SessionImage::GetCompressionLevel() const { return compressionLevel; }
 
-    serializationBuffer = make_unique<uint8[]>(initialBufferSize + UNCOMPRESSED_HEADER_SIZE);
-    uint8* serializationBufferPtr = serializationBuffer.get();
+bool SessionImage::Serialize() {
+    vector<Chunk> chunks;
+    if (!CompressChunks(chunks)) return false;
 
-    put32(serializationBufferPtr, MAGIC);
-    put32(serializationBufferPtr + 4, VERSION | VERSION_MASK);
-    put32(serializationBufferPtr + 8, uncompressedSize);
+    serizalizedImageSize = GetChunkedImageSize(chunks);
+    serializationBuffer = make_unique<uint8[]>(serizalizedImageSize);
 
-    z_stream stream;
-    memset(&stream, 0, sizeof(stream));
+    BufferSink sink(serializationBuffer.get());
 
-    if (deflateInit(&stream, MZ_DEFAULT_COMPRESSION) != Z_OK) {
-        return false;
-    }
+    return WriteChunkedImage(sink, chunks);
+}
 
-    stream.next_out = serializationBufferPtr + UNCOMPRESSED_HEADER_SIZE;
-    stream.avail_out = initialBufferSize;
+bool SessionImage::Serialize(SessionImageSink& sink) {
+    vector<Chunk> chunks;
+    if (!CompressChunks(chunks)) return false;
 
-    uint8 header[20];
+    serializationBuffer.reset();
+    serizalizedImageSize = GetChunkedImageSize(chunks);
 
-    put32(header, deviceId.size());
-    put32(header + 4, metadataSize);
-    put32(header + 8, romSize);
-    put32(header + 12, ramSize);
-    put32(header + 16, savestateSize);
+    return WriteChunkedImage(sink, chunks);
+}
 
-    if (!AppendToSerializationStream(stream, header, 20)) return false;
+bool SessionImage::CompressChunks(vector<Chunk>& chunks) {
+    version = VERSION;
 
-    if (deviceId.size() > 0 &&
-        !AppendToSerializationStream(stream, (void*)deviceId.c_str(), deviceId.size()))
-        return false;
+    if (deviceId.size() > MAX_DEVICE_ID_SIZE) return false;
 
-    if (metadataSize > 0 && !AppendToSerializationStream(stream, metadata, metadataSize))
-        return false;
+    for (auto [section, sectionSize] : {make_pair(metadata, metadataSize),
+                                        make_pair(romImage, romSize), make_pair(ramImage, ramSize),
+                                        make_pair(savestate, savestateSize)}) {
+        const uint8* data = static_cast<const uint8*>(section);
 
-    if (romSize > 0 && !AppendToSerializationStream(stream, romImage, romSize)) return false;
+        for (size_t offset = 0; offset < sectionSize; offset += CHUNK_SIZE)
+            chunks.push_back(
+                {data + offset, min(CHUNK_SIZE, sectionSize - offset), CODEC_STORE, nullptr, 0});
+    }
 
-    if (ramSize > 0 && !AppendToSerializationStream(stream, ramImage, ramSize)) return false;
+    const size_t workSize = compressionLevel == COMPRESSION_LEVEL_STORE
+                                ? 0
+                                : metadataSize + romSize + ramSize + savestateSize;
+    atomic<bool> success{true};
 
-    if (savestateSize > 0 && !AppendToSerializationStream(stream, savestate, savestateSize))
-        return false;
+    forEachParallel(chunks.size(), workSize, [&](size_t i) {
+        Chunk& chunk(chunks[i]);
+
+        if (compressionLevel == COMPRESSION_LEVEL_STORE) return;
 
-    int finishStreamResult;
-    while (true) {
-        finishStreamResult = deflate(&stream, Z_FINISH);
+        mz_ulong compressedSize = compressBound(chunk.size);
+        unique_ptr<uint8[]> compressedData = make_unique<uint8[]>(compressedSize);
 
-        if (!(finishStreamResult == Z_OK || finishStreamResult == Z_BUF_ERROR) ||
-            !GrowSerializationBuffer(stream)) {
-            break;
+        if (compress2(compressedData.get(), &compressedSize, chunk.data, chunk.size,
+                      compressionLevel) != Z_OK) {
+            success = false;
+            return;
         }
-    }
 
-    if (finishStreamResult != Z_STREAM_END) {
-        deflateEnd(&stream);
-        return false;
-    }
+        if (compressedSize >= chunk.size) return;
 
-    serizalizedImageSize = stream.total_out + UNCOMPRESSED_HEADER_SIZE;
+        chunk.codec = CODEC_DEFLATE;
+        chunk.compressedData = move(compressedData);
+        chunk.compressedSize = compressedSize;
+    });
 
-    deflateEnd(&stream);
-    return true;
+    return success;
 }
 
-bool SessionImage::AppendToSerializationStream(z_stream& stream, void* buffer, size_t size) {
-    stream.next_in = reinterpret_cast<const unsigned char*>(buffer);
-    stream.avail_in = size;
+size_t SessionImage::GetChunkedImageSize(const vector<Chunk>& chunks) const {
+    size_t size = CHUNKED_HEADER_SIZE + deviceId.size() + chunks.size() * CHUNK_DESCRIPTOR_SIZE;
 
-    int deflateResult;
-    do {
-        deflateResult = deflate(&stream, Z_NO_FLUSH);
+    for (auto& chunk : chunks)
+        size += chunk.codec == CODEC_STORE ? chunk.size : chunk.compressedSize;
 
-        if (deflateResult == Z_BUF_ERROR && GrowSerializationBuffer(stream)) deflateResult = Z_OK;
-    } while (stream.avail_in != 0 && deflateResult == Z_OK);
+    return size;
+}
 
-    if (deflateResult != Z_OK) {
-        deflateEnd(&stream);
+bool SessionImage::WriteChunkedImage(SessionImageSink& sink, const vector<Chunk>& chunks) const {
+    uint8 header[CHUNKED_HEADER_SIZE];
 
-        return false;
-    }
+    put32(header, MAGIC);
+    put32(header + 4, VERSION | VERSION_MASK);
+    put32(header + 8, deviceId.size());
+    put32(header + 12, metadataSize);
+    put32(header + 16, romSize);
+    put32(header + 20, ramSize);
+    put32(header + 24, savestateSize);
+    put32(header + 28, chunks.size());
 
-    return true;
-}
+    if (!sink.Write(header, CHUNKED_HEADER_SIZE)) return false;
+    if (!sink.Write(deviceId.c_str(), deviceId.size())) return false;
 
-bool SessionImage::GrowSerializationBuffer(mz_stream_s& stream) {
-    if (stream.avail_out + stream.total_out + UNCOMPRESSED_HEADER_SIZE ==
-        COMPRESSED_IMAGE_GROW_LIMIT)
-        return false;
+    for (auto& chunk : chunks) {
+        uint8 descriptor[CHUNK_DESCRIPTOR_SIZE];
 
-    size_t growTo = min(((stream.total_out + stream.avail_out + UNCOMPRESSED_HEADER_SIZE) * 3) / 2,
-                        COMPRESSED_IMAGE_GROW_LIMIT);
-    unique_ptr<uint8[]> newBuffer = make_unique<uint8[]>(growTo);
+        put32(descriptor, chunk.codec);
+        put32(descriptor + 4, chunk.size);
+        put32(descriptor + 8, chunk.codec == CODEC_STORE ? chunk.size : chunk.compressedSize);
 
-    memcpy(newBuffer.get(), serializationBuffer.get(), UNCOMPRESSED_HEADER_SIZE + stream.total_out);
+        if (!sink.Write(descriptor, CHUNK_DESCRIPTOR_SIZE)) return false;
+    }
 
-    stream.next_out = newBuffer.get() + stream.total_out + UNCOMPRESSED_HEADER_SIZE;
-    stream.avail_out = growTo - stream.total_out - UNCOMPRESSED_HEADER_SIZE;
+    for (auto& chunk : chunks) {
+        const bool success = chunk.codec == CODEC_STORE
+                                 ? sink.Write(chunk.data, chunk.size)
+                                 : sink.Write(chunk.compressedData.get(), chunk.compressedSize);
 
-    serializationBuffer.swap(newBuffer);
+        if (!success) return false;
+    }
 
     return true;
 }
@@ -209,6 +282,8 @@ bool SessionImage::Deserialize(void* _buffer, size_t size) {
     version &= ~VERSION_MASK;
 
     if (version > VERSION) return false;
+    if (version >= 5) return DeserializeChunkedImage(buffer, size);
+
     uint32 headerSize = (version >= 2 && version < 4) ? 24 : 20;
 
     if (version > 2) {
@@ -261,6 +336,102 @@ bool SessionImage::Deserialize(void* _buffer, size_t size) {
     return true;
 }
 
+bool SessionImage::DeserializeChunkedImage(uint8* buffer, size_t size) {
+    if (size < CHUNKED_HEADER_SIZE) return false;
+
+    const size_t deviceIdSize = get32(buffer + 8);
+    const size_t chunkCount = get32(buffer + 28);
+
+    if (deviceIdSize > MAX_DEVICE_ID_SIZE || chunkCount > size / CHUNK_DESCRIPTOR_SIZE)
+        return false;
+
+    const size_t dataOffset =
+        CHUNKED_HEADER_SIZE + deviceIdSize + chunkCount * CHUNK_DESCRIPTOR_SIZE;
+    if (dataOffset > size) return false;
+
+    const uint64 sizes[] = {get32(buffer + 12), get32(buffer + 16), get32(buffer + 20),
+                            get32(buffer + 24)};
+    const uint64 payloadSize = sizes[0] + sizes[1] + sizes[2] + sizes[3];
+
+    struct CompressedChunk {
+        uint32 codec;
+        uint8* data;
+        size_t compressedSize;
+        size_t offset;
+        size_t size;
+    };
+
+    vector<CompressedChunk> chunks(chunkCount);
+    uint64 offset = 0, compressedOffset = dataOffset, workSize = 0;
+
+    for (size_t i = 0; i < chunkCount; i++) {
+        uint8* descriptor = buffer + CHUNKED_HEADER_SIZE + deviceIdSize + i * CHUNK_DESCRIPTOR_SIZE;
+        CompressedChunk& chunk(chunks[i]);
+
+        chunk.codec = get32(descriptor);
+        chunk.size = get32(descriptor + 4);
+        chunk.compressedSize = get32(descriptor + 8);
+
+        if (chunk.codec != CODEC_STORE && chunk.codec != CODEC_DEFLATE) return false;
+        if (chunk.codec == CODEC_STORE && chunk.compressedSize != chunk.size) return false;
+        if (compressedOffset + chunk.compressedSize > size) return false;
+
+        chunk.data = buffer + compressedOffset;
+        chunk.offset = offset;
+
+        offset += chunk.size;
+        compressedOffset += chunk.compressedSize;
+
+        if (chunk.codec == CODEC_DEFLATE) workSize += chunk.size;
+    }
+
+    if (offset != payloadSize || compressedOffset != size) return false;
+
+    deserializationBuffer = make_unique<uint8[]>(payloadSize);
+    uint8* payload = deserializationBuffer.get();
+
+    atomic<bool> success{true};
+
+    forEachParallel(chunkCount, workSize, [&](size_t i) {
+        CompressedChunk& chunk(chunks[i]);
+
+        if (chunk.codec == CODEC_STORE) {
+            memcpy(payload + chunk.offset, chunk.data, chunk.size);
+            return;
+        }
+
+        mz_ulong uncompressedSize = chunk.size;
+
+        if (uncompress(payload + chunk.offset, &uncompressedSize, chunk.data,
+                       chunk.compressedSize) != Z_OK ||
+            uncompressedSize != chunk.size)
+            success = false;
+    });
+
+    if (!success) return false;
+
+    deviceId = string(reinterpret_cast<const char*>(buffer + CHUNKED_HEADER_SIZE), deviceIdSize);
+    framebufferSize = 0;
+
+    metadataSize = sizes[0];
+    romSize = sizes[1];
+    ramSize = sizes[2];
+    savestateSize = sizes[3];
+
+    metadata = metadataSize > 0 ? payload : nullptr;
+    payload += metadataSize;
+
+    romImage = romSize > 0 ? payload : nullptr;
+    payload += romSize;
+
+    ramImage = ramSize > 0 ? payload : nullptr;
+    payload += ramSize;
+
+    savestate = savestateSize > 0 ? payload : nullptr;
+
+    return true;
+}
+
 bool SessionImage::DeserializeLegacyImage(void* _buffer, size_t size) {
     uint8* buffer = static_cast<uint8*>(_buffer);
 
@@ -3,12 +3,31 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "EmCommon.h"
 
-struct mz_stream_s;
+// Receives a serialized session image piece by piece. This allows to write
+// images to disk without assembling them in memory first.
+class SessionImageSink {
+   public:
+    virtual ~SessionImageSink() = default;
+
+    virtual bool Write(const void* data, size_t size) = 0;
+};
+
+// Images are written in a chunked format: ROM, RAM, savestate and metadata are
+// split into chunks that are deflated independently (and concurrently where
+// threads are available). Chunks that do not compress are stored verbatim.
+// Deserialize reads both the chunked format and the older single stream
+// formats.
 
 class SessionImage {
+   public:
+    static constexpr int COMPRESSION_LEVEL_STORE = 0;
+    static constexpr int COMPRESSION_LEVEL_FAST = 1;
+    static constexpr int COMPRESSION_LEVEL_BEST = 9;
+
    public:
     SessionImage() = default;
 
@@ -35,20 +54,38 @@ class SessionImage {
     uint32 GetFramebufferSize() const;
     uint32 GetVersion() const;
 
+    // The deflate level used by Serialize. Defaults to COMPRESSION_LEVEL_FAST.
+    SessionImage& SetCompressionLevel(int level);
+    int GetCompressionLevel() const;
+
     bool Serialize();
+    bool Serialize(SessionImageSink& sink);
     void* GetSerializedImage() const;
     size_t GetSerializedImageSize() const;
 
     bool Deserialize(void* buffer, size_t size);
 
    private:
-    bool DeserializeLegacyImage(void* buffer, size_t size);
+    struct Chunk {
+        const uint8* data;
+        size_t size;
+
+        uint32 codec;
+        unique_ptr<uint8[]> compressedData;
+        size_t compressedSize;
+    };
 
-    bool AppendToSerializationStream(mz_stream_s& stream, void* buffer, size_t size);
-    bool GrowSerializationBuffer(mz_stream_s& stream);
+   private:
+    bool CompressChunks(vector<Chunk>& chunks);
+    size_t GetChunkedImageSize(const vector<Chunk>& chunks) const;
+    bool WriteChunkedImage(SessionImageSink& sink, const vector<Chunk>& chunks) const;
+
+    bool DeserializeChunkedImage(uint8* buffer, size_t size);
+    bool DeserializeLegacyImage(void* buffer, size_t size);
 
    private:
     uint32 version;
+    int compressionLevel{COMPRESSION_LEVEL_FAST};
 
     void *romImage{nullptr}, *ramImage{nullptr}, *savestate{nullptr}, *metadata{nullptr};
     size_t romSize{0}, ramSize{0}, savestateSize{0}, metadataSize{0}, framebufferSize{0};
@@ -0,0 +1,97 @@
+#include "SessionStats.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace {
+    uint64 delta(uint64 from, uint64 to) { return to >= from ? to - from : 0; }
+
+    double perSecond(uint64 from, uint64 to, double seconds) {
+        return seconds > 0 ? delta(from, to) / seconds : 0;
+    }
+}  // namespace
+
+void SessionStats::Reset() {
+    stoppedCycles = 0;
+    traps = 0;
+    interrupts = 0;
+    screenUpdates = 0;
+    frames = 0;
+
+    savestates = 0;
+    savestateSize = 0;
+}
+
+void SessionStats::CountSavestate(size_t size) {
+    savestates++;
+    savestateSize = size;
+}
+
+SessionStats::Snapshot SessionStats::Capture(long timestamp, uint32 clocksPerSecond, uint64 cycles,
+                                             uint64 instructions) const {
+    return {.timestamp = timestamp,
+            .clocksPerSecond = clocksPerSecond,
+            .cycles = cycles,
+            .stoppedCycles = stoppedCycles,
+            .instructions = instructions,
+            .traps = traps,
+            .interrupts = interrupts,
+            .screenUpdates = screenUpdates,
+            .frames = frames,
+            .savestates = savestates,
+            .savestateSize = savestateSize};
+}
+
+SessionStats::Rates SessionStats::CalculateRates(const Snapshot& from, const Snapshot& to) {
+    const double seconds =
+        to.timestamp > from.timestamp ? (to.timestamp - from.timestamp) / 1000. : 0;
+    const uint64 cycles = delta(from.cycles, to.cycles);
+    const uint64 stoppedCycles = min(delta(from.stoppedCycles, to.stoppedCycles), cycles);
+
+    Rates rates{.seconds = seconds};
+
+    rates.mips = perSecond(from.instructions, to.instructions, seconds) / 1e6;
+    rates.cyclesPerSecond = perSecond(from.cycles, to.cycles, seconds);
+    rates.idleRatio = cycles > 0 ? static_cast<double>(stoppedCycles) / cycles : 0;
+    rates.trapsPerSecond = perSecond(from.traps, to.traps, seconds);
+    rates.interruptsPerSecond = perSecond(from.interrupts, to.interrupts, seconds);
+    rates.screenUpdatesPerSecond = perSecond(from.screenUpdates, to.screenUpdates, seconds);
+    rates.framesPerSecond = perSecond(from.frames, to.frames, seconds);
+
+    if (to.clocksPerSecond > 0) rates.speed = rates.cyclesPerSecond / to.clocksPerSecond;
+
+    return rates;
+}
+
+void SessionStats::WriteJson(ostream& stream, const Snapshot& snapshot, const Rates& rates) {
+    stream << "{" << endl
+           << "  \"counters\": {\"cycles\": " << snapshot.cycles
+           << ", \"stoppedCycles\": " << snapshot.stoppedCycles
+           << ", \"instructions\": " << snapshot.instructions << ", \"traps\": " << snapshot.traps
+           << ", \"interrupts\": " << snapshot.interrupts
+           << ", \"screenUpdates\": " << snapshot.screenUpdates
+           << ", \"frames\": " << snapshot.frames << ", \"savestates\": " << snapshot.savestates
+           << ", \"savestateSize\": " << snapshot.savestateSize
+           << ", \"clocksPerSecond\": " << snapshot.clocksPerSecond << "}," << endl
+           << "  \"rates\": {\"seconds\": " << rates.seconds << ", \"mips\": " << rates.mips
+           << ", \"cyclesPerSecond\": " << rates.cyclesPerSecond << ", \"speed\": " << rates.speed
+           << ", \"idleRatio\": " << rates.idleRatio
+           << ", \"trapsPerSecond\": " << rates.trapsPerSecond
+           << ", \"interruptsPerSecond\": " << rates.interruptsPerSecond
+           << ", \"screenUpdatesPerSecond\": " << rates.screenUpdatesPerSecond
+           << ", \"framesPerSecond\": " << rates.framesPerSecond << "}" << endl
+           << "}" << endl;
+}
+
+string SessionStats::FormatLogLine(const Snapshot& snapshot, const Rates& rates) {
+    ostringstream stream;
+
+    stream << fixed << setprecision(2) << "mips=" << rates.mips
+           << " mcycles/s=" << rates.cyclesPerSecond / 1e6 << " speed=" << rates.speed
+           << " idle=" << rates.idleRatio << setprecision(1)
+           << " traps/s=" << rates.trapsPerSecond << " irq/s=" << rates.interruptsPerSecond
+           << " screen/s=" << rates.screenUpdatesPerSecond << " fps=" << rates.framesPerSecond
+           << " savestate=" << snapshot.savestateSize;
+
+    return stream.str();
+}
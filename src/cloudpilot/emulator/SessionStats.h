@@ -0,0 +1,101 @@
+#ifndef _SESSION_STATS_H_
+#define _SESSION_STATS_H_
+
+#include <ostream>
+#include <string>
+
+#include "EmCommon.h"
+
+// Runtime counters for a session. Counters are bumped at most once per trap,
+// interrupt, frame or savestate and never per instruction; instructions and
+// cycles are sampled from the CPU and the session when a snapshot is taken.
+//
+// Counters are cumulative since the session was initialized. Rates (MIPS,
+// idle ratio, trap and frame rates) are calculated between two snapshots, for
+// example between two consecutive log lines.
+
+class SessionStats {
+   public:
+    struct Snapshot {
+        long timestamp;
+        uint32 clocksPerSecond;
+
+        uint64 cycles;
+        uint64 stoppedCycles;
+        uint64 instructions;
+        uint64 traps;
+        uint64 interrupts;
+        uint64 screenUpdates;
+        uint64 frames;
+
+        uint64 savestates;
+        size_t savestateSize;
+    };
+
+    struct Rates {
+        double seconds;
+
+        double mips;
+        double cyclesPerSecond;
+        double speed;
+        double idleRatio;
+        double trapsPerSecond;
+        double interruptsPerSecond;
+        double screenUpdatesPerSecond;
+        double framesPerSecond;
+    };
+
+   public:
+    SessionStats() = default;
+
+    void Reset();
+
+    inline void AddStoppedCycles(uint32 cycles);
+    inline void CountTrap();
+    inline void CountInterrupt();
+    inline void CountScreenUpdate();
+    inline void CountFrame();
+    void CountSavestate(size_t size);
+
+    Snapshot Capture(long timestamp, uint32 clocksPerSecond, uint64 cycles,
+                     uint64 instructions) const;
+
+    // Rates between two snapshots of the same session. Counters that went
+    // backwards (the session was reinitialized in between) count as zero.
+    static Rates CalculateRates(const Snapshot& from, const Snapshot& to);
+
+    static void WriteJson(ostream& stream, const Snapshot& snapshot, const Rates& rates);
+    static string FormatLogLine(const Snapshot& snapshot, const Rates& rates);
+
+   private:
+    uint64 stoppedCycles{0};
+    uint64 traps{0};
+    uint64 interrupts{0};
+    uint64 screenUpdates{0};
+    uint64 frames{0};
+
+    uint64 savestates{0};
+    size_t savestateSize{0};
+
+   private:
+    SessionStats(const SessionStats&) = delete;
+    SessionStats(SessionStats&&) = delete;
+    SessionStats& operator=(const SessionStats&) = delete;
+    SessionStats& operator=(SessionStats&&) = delete;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// IMPLEMENTATION
+///////////////////////////////////////////////////////////////////////////////
+
+void SessionStats::AddStoppedCycles(uint32 cycles) { stoppedCycles += cycles; }
+
+void SessionStats::CountTrap() { traps++; }
+
+void SessionStats::CountInterrupt() { interrupts++; }
+
+void SessionStats::CountScreenUpdate() { screenUpdates++; }
+
+void SessionStats::CountFrame() { frames++; }
+
+#endif  // _SESSION_STATS_H_
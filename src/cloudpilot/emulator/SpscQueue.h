@@ -0,0 +1,175 @@
+#ifndef _SPSC_QUEUE_H_
+#define _SPSC_QUEUE_H_
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "EmAssert.h"
+#include "EmCommon.h"
+
+// A fixed capacity, lock-free ring for a single producer and a single consumer
+// thread. The interface follows EmThreadSafeQueue:
+//
+//   * Put is called by the producer and drops the value if the queue is full.
+//   * Get, Peek and Clear are called by the consumer. Get and Peek require
+//     the queue not to be empty.
+//   * GetUsed and GetFree may be called on either end. The other end may
+//     change the result at any time, but the producer never sees more room
+//     and the consumer never sees more elements than are actually
+//     available.
+//
+// Head and tail are free running counters that are masked into a power of two
+// sized buffer. Each side caches the other side's counter in order to avoid
+// touching the shared cache line on every call.
+
+template <typename T>
+class SpscQueue {
+   public:
+    explicit SpscQueue(int maxSize);
+    ~SpscQueue();
+
+    bool Put(const T& value);
+    T Get();
+    T Peek();
+
+    int GetUsed() const;
+    int GetFree() const;
+
+    void Clear();
+    int GetMaxSize() const;
+
+   private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    using Slot = typename aligned_storage<sizeof(T), alignof(T)>::type;
+
+   private:
+    T* At(uint32 index) { return reinterpret_cast<T*>(&buffer[index & mask]); }
+
+   private:
+    const uint32 maxSize;
+    const uint32 mask;
+    unique_ptr<Slot[]> buffer;
+
+    // Written by the consumer.
+    alignas(CACHE_LINE) atomic<uint32> head{0};
+    uint32 cachedTail{0};
+
+    // Written by the producer.
+    alignas(CACHE_LINE) atomic<uint32> tail{0};
+    uint32 cachedHead{0};
+
+   private:
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue(SpscQueue&&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+    SpscQueue& operator=(SpscQueue&&) = delete;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// IMPLEMENTATION
+///////////////////////////////////////////////////////////////////////////////
+
+namespace spsc_queue_detail {
+    inline uint32 BufferSize(uint32 maxSize) {
+        uint32 size = 1;
+        while (size < maxSize) size <<= 1;
+
+        return size;
+    }
+}  // namespace spsc_queue_detail
+
+template <typename T>
+SpscQueue<T>::SpscQueue(int maxSize)
+    : maxSize(maxSize),
+      mask(spsc_queue_detail::BufferSize(maxSize) - 1),
+      buffer(make_unique<Slot[]>(mask + 1)) {
+    EmAssert(maxSize > 0);
+}
+
+template <typename T>
+SpscQueue<T>::~SpscQueue() {
+    Clear();
+}
+
+template <typename T>
+bool SpscQueue<T>::Put(const T& value) {
+    const uint32 t = tail.load(memory_order_relaxed);
+
+    if (t - cachedHead >= maxSize) {
+        cachedHead = head.load(memory_order_acquire);
+
+        if (t - cachedHead >= maxSize) return false;
+    }
+
+    new (At(t)) T(value);
+    tail.store(t + 1, memory_order_release);
+
+    return true;
+}
+
+template <typename T>
+T SpscQueue<T>::Get() {
+    const uint32 h = head.load(memory_order_relaxed);
+
+    if (h == cachedTail) cachedTail = tail.load(memory_order_acquire);
+
+    // The caller should always call GetUsed before Get.
+    EmAssert(h != cachedTail);
+
+    T* slot = At(h);
+    T result(move(*slot));
+    slot->~T();
+
+    head.store(h + 1, memory_order_release);
+
+    return result;
+}
+
+template <typename T>
+T SpscQueue<T>::Peek() {
+    const uint32 h = head.load(memory_order_relaxed);
+
+    if (h == cachedTail) cachedTail = tail.load(memory_order_acquire);
+
+    EmAssert(h != cachedTail);
+
+    return *At(h);
+}
+
+template <typename T>
+int SpscQueue<T>::GetUsed() const {
+    // Head never passes tail, so loading head first keeps the difference from
+    // going negative. It may overshoot while the consumer is active, though.
+    const uint32 h = head.load(memory_order_acquire);
+    const uint32 t = tail.load(memory_order_acquire);
+
+    return min(t - h, maxSize);
+}
+
+template <typename T>
+int SpscQueue<T>::GetFree() const {
+    return maxSize - GetUsed();
+}
+
+template <typename T>
+void SpscQueue<T>::Clear() {
+    uint32 h = head.load(memory_order_relaxed);
+    const uint32 t = tail.load(memory_order_acquire);
+
+    if (!is_trivially_destructible<T>::value)
+        for (; h != t; h++) At(h)->~T();
+
+    cachedTail = t;
+    head.store(t, memory_order_release);
+}
+
+template <typename T>
+int SpscQueue<T>::GetMaxSize() const {
+    return maxSize;
+}
+
+#endif  // _SPSC_QUEUE_H_
@@ -10,11 +10,14 @@
 #include "EmBankROM.h"
 #include "EmCPU68K.h"
 #include "EmMemory.h"
+#include "EmSessionContext.h"
 #include "UAE.h"
 
 namespace {
     constexpr uint32 RTS_SEARCH_LIMIT = 0x400;
-    bool wroteRam{false};
+    EM_THREAD_LOCAL bool wroteRam{false};
+
+    const EmSessionState sessionState{EM_SESSION_VARIABLE(wroteRam)};
 
     bool inRom(emuptr ptr) {
         emuptr romStart = EmBankROM::GetMemoryStart();
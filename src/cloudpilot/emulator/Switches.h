@@ -138,6 +138,12 @@
 
 #define HAS_TRACER 0
 
+// Define BLOCK_CACHE to 1 to have EmCPU68K::Execute dispatch opcodes from a
+// cache of predecoded basic blocks (see EmBlockCache.h) instead of fetching
+// and decoding every opcode through the memory banks.
+
+#define BLOCK_CACHE 1
+
 #define HAS_OMNI_THREAD 0
 
 // Define sub-flags for specific internal features.
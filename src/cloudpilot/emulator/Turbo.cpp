@@ -0,0 +1,78 @@
+#include "Turbo.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "Debugger.h"
+#include "EmSession.h"
+#include "EmSessionContext.h"
+#include "Platform.h"
+#include "SuspendManager.h"
+
+namespace {
+    // Emulated time per call to RunEmulation. The host clock is checked in
+    // between.
+    constexpr double SLICE_MSEC = 10;
+
+    thread_local Turbo turbo;
+}  // namespace
+
+thread_local Turbo* gTurbo{&turbo};
+
+namespace {
+    const EmSessionState sessionState{EM_SESSION_OBJECT(gTurbo)};
+}  // namespace
+
+void Turbo::Enable(long millis, double speed) {
+    this->speed = max(speed, UNLIMITED);
+
+    enabled = true;
+    enabledAt = millis;
+    lastFrameAt = millis;
+    emulatedMsec = 0;
+}
+
+void Turbo::Disable() { enabled = false; }
+
+void Turbo::SetFrameInterval(uint32 frameInterval) { this->frameInterval = frameInterval; }
+
+uint64 Turbo::Run(EmSession& session, uint32 budgetMsec) {
+    const long startedAt = Platform::GetMilliseconds();
+    const double clocksPerMsec = session.GetClocksPerSecond() / 1000.;
+
+    uint64 cycles = 0;
+
+    for (long millis = startedAt; millis - startedAt < static_cast<long>(budgetMsec);
+         millis = Platform::GetMilliseconds()) {
+        if (gDebugger->IsStopped() || SuspendManager::IsSuspended()) break;
+
+        const double sliceMsec = min(GetLag(millis), SLICE_MSEC);
+        if (sliceMsec * clocksPerMsec < 1) break;
+
+        const uint32 cyclesPassed = session.RunEmulation(sliceMsec * clocksPerMsec);
+
+        cycles += cyclesPassed;
+        emulatedMsec += cyclesPassed / clocksPerMsec;
+    }
+
+    return cycles;
+}
+
+double Turbo::GetLag(long millis) {
+    if (speed == UNLIMITED) return numeric_limits<double>::infinity();
+
+    const double allowedMsec = (millis - enabledAt) * speed;
+
+    if (allowedMsec - emulatedMsec > MAX_LAG_MSEC) emulatedMsec = allowedMsec - MAX_LAG_MSEC;
+
+    return allowedMsec - emulatedMsec;
+}
+
+bool Turbo::IsFrameDue(long millis) {
+    if (!enabled) return true;
+    if (millis - lastFrameAt < static_cast<long>(frameInterval)) return false;
+
+    lastFrameAt = millis;
+
+    return true;
+}
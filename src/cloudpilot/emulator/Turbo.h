@@ -0,0 +1,71 @@
+#ifndef _TURBO_H_
+#define _TURBO_H_
+
+#include "EmCommon.h"
+
+class EmSession;
+
+// Runs emulated time faster than the wall clock, for scripted setup runs like
+// boot, hard reset and app installation. Instead of pacing the emulator by
+// wall clock, the host calls Run once per iteration of its main loop, and
+// emulation proceeds for a fixed budget of host time. If a speed is set,
+// emulated time is capped at `speed` times the wall clock.
+//
+// Stopped periods collapse by themselves: the CPU skips ahead to the next
+// interrupt, and turbo mode hands it large slices to do so. The host is
+// expected to convert and present frames only if IsFrameDue says so.
+
+class Turbo {
+   public:
+    static constexpr double UNLIMITED = 0;
+
+    static constexpr uint32 DEFAULT_BUDGET_MSEC = 15;
+    static constexpr uint32 DEFAULT_FRAME_INTERVAL = 250;
+
+    // With a speed limit, emulation does not catch up on more than this.
+    static constexpr double MAX_LAG_MSEC = 500;
+
+   public:
+    Turbo() = default;
+
+    void Enable(long millis, double speed = UNLIMITED);
+    void Disable();
+
+    bool IsEnabled() const { return enabled; }
+    double GetSpeed() const { return speed; }
+
+    void SetFrameInterval(uint32 frameInterval);
+    uint32 GetFrameInterval() const { return frameInterval; }
+
+    // Runs the session until budgetMsec of host time have passed, the speed
+    // limit is reached or emulation is interrupted by the debugger or a
+    // suspension. Returns the number of cycles executed.
+    uint64 Run(EmSession& session, uint32 budgetMsec = DEFAULT_BUDGET_MSEC);
+
+    // Emulated milliseconds that may run at the given host time without
+    // exceeding the speed limit.
+    double GetLag(long millis);
+
+    // Whether a frame should be presented at the given host time. Always
+    // true if turbo mode is off.
+    bool IsFrameDue(long millis);
+
+   private:
+    bool enabled{false};
+    double speed{UNLIMITED};
+    uint32 frameInterval{DEFAULT_FRAME_INTERVAL};
+
+    long enabledAt{0};
+    long lastFrameAt{0};
+    double emulatedMsec{0};
+
+   private:
+    Turbo(const Turbo&) = delete;
+    Turbo(Turbo&&) = delete;
+    Turbo& operator=(const Turbo&) = delete;
+    Turbo& operator=(Turbo&&) = delete;
+};
+
+extern thread_local Turbo* gTurbo;
+
+#endif  // _TURBO_H_
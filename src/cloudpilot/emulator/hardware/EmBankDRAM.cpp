@@ -18,6 +18,7 @@
 #include "EmBankDRAM.h"
 
 #include "EmBankSRAM.h"  // gRAMBank_Size, gRAM_Memory, gMemoryAccess
+#include "EmBlockCache.h"
 #include "EmCPU.h"       // GetSP
 #include "EmCPU68K.h"    // gCPU68K
 #include "EmCommon.h"
@@ -25,6 +26,7 @@
 #include "EmMemory.h"        // Memory::InitializeBanks, IsPCInRAM (implicitly, through META_CHECK)
 #include "EmPalmFunction.h"  // InSysLaunch
 #include "EmSession.h"       // gSession
+#include "EmSessionContext.h"
 #include "EmSystemState.h"
 #include "MemoryRegion.h"
 #include "MetaMemory.h"  // MetaMemory
@@ -32,7 +34,12 @@
 namespace {
     constexpr uint32 kMemoryStart = 0x00000000;
 
-    uint32 dynamicHeapSize;
+    // Reads above the dynamic heap are forwarded to EmBankSRAM, so direct reads
+    // require the SRAM checks to be compiled out as well.
+    constexpr bool kDirectReads = !(VALIDATE_DRAM_GET || VALIDATE_SRAM_GET ||
+                                    PREVENT_USER_SRAM_GET || PROFILE_MEMORY);
+
+    EM_THREAD_LOCAL uint32 dynamicHeapSize;
 
     EmAddressBank addressBank = {EmBankDRAM::GetLong,        EmBankDRAM::GetWord,
                                  EmBankDRAM::GetByte,        EmBankDRAM::SetLong,
@@ -46,9 +53,9 @@ namespace {
                                          EmBankDRAM::GetRealAddress, EmBankDRAM::ValidAddress,
                                          EmBankDRAM::GetMetaAddress, EmBankDRAM::AddOpcodeCycles};
 
-    uint32 ramSize;
-    uint8* ram;
-    uint8* dirtyPages;
+    EM_THREAD_LOCAL uint32 ramSize;
+    EM_THREAD_LOCAL uint8* ram;
+    EM_THREAD_LOCAL uint8* dirtyPages;
 
     inline int InlineValidAddress(emuptr address, size_t size) {
         int result = (address + size) <= ramSize;
@@ -64,8 +71,14 @@ namespace {
 
     inline void markDirty(emuptr address) {
         dirtyPages[address >> 13] |= (1 << ((address >> 10) & 0x07));
+
+        EmBlockCache::NotifyRAMWrite(address);
     }
 
+    const EmSessionState sessionState{EM_SESSION_VARIABLE(dynamicHeapSize),
+                                      EM_SESSION_VARIABLE(ramSize),
+                                      EM_SESSION_VARIABLE(ram),
+                                      EM_SESSION_VARIABLE(dirtyPages)};
 }  // namespace
 
 // ===========================================================================
@@ -157,8 +170,11 @@ void EmBankDRAM::SetBankHandlers(void) {
     uint32 sixtyFourK = 64 * 1024L;
     uint32 numBanks = (dynamicHeapSize + sixtyFourK - 1) / sixtyFourK;
 
-    Memory::InitializeBanks(EmHAL::EnableRAM() ? addressBank : addressBankDisabled,
-                            EmMemBankIndex(kMemoryStart), numBanks);
+    if (EmHAL::EnableRAM())
+        Memory::InitializeBanks(addressBank, EmMemBankIndex(kMemoryStart), numBanks,
+                                kDirectReads ? ram : nullptr, gRAMBank_Mask);
+    else
+        Memory::InitializeBanks(addressBankDisabled, EmMemBankIndex(kMemoryStart), numBanks);
 }
 
 // ---------------------------------------------------------------------------
@@ -242,7 +258,7 @@ void EmBankDRAM::SetLong(emuptr address, uint32 value) {
     markDirty(address + 2);
 
     if (MetaMemory::IsScreenBuffer32(InlineGetMetaAddress(address)))
-        gSystemState.MarkScreenDirty(address, address + 4);
+        gSystemState->MarkScreenDirty(address, address + 4);
 }
 
 // ---------------------------------------------------------------------------
@@ -270,7 +286,7 @@ void EmBankDRAM::SetWord(emuptr address, uint32 value) {
     markDirty(address);
 
     if (MetaMemory::IsScreenBuffer16(InlineGetMetaAddress(address)))
-        gSystemState.MarkScreenDirty(address, address + 2);
+        gSystemState->MarkScreenDirty(address, address + 2);
 }
 
 // ---------------------------------------------------------------------------
@@ -293,7 +309,7 @@ void EmBankDRAM::SetByte(emuptr address, uint32 value) {
     markDirty(address);
 
     if (MetaMemory::IsScreenBuffer8(InlineGetMetaAddress(address)))
-        gSystemState.MarkScreenDirty(address, address);
+        gSystemState->MarkScreenDirty(address, address);
 }
 
 uint32 EmBankDRAM::GetDummy(emuptr address) { return 0; }
@@ -20,10 +20,11 @@
 #include "EmCommon.h"
 #include "EmMemory.h"  // Memory::InitializeBanks
 #include "EmSession.h"
+#include "EmSessionContext.h"
 #include "MemoryRegion.h"
 
 namespace {
-    uint32 ramSize;
+    EM_THREAD_LOCAL uint32 ramSize;
 
     EmAddressBank addressBank = {
         EmBankDummy::GetLong,        EmBankDummy::GetWord,      EmBankDummy::GetByte,
@@ -38,6 +39,7 @@ namespace {
         return false;
     }
 
+    const EmSessionState sessionState{EM_SESSION_VARIABLE(ramSize)};
 }  // namespace
 
 /***********************************************************************
@@ -228,7 +230,7 @@ void EmBankDummy::InvalidAccess(emuptr address, long size, Bool forRead) {
     if (CEnableFullAccess::AccessOK()) return;
 
 #ifdef ENABLE_DEBUGGER
-    if (gDebugger.IsMemoryAccess()) return;
+    if (gDebugger->IsMemoryAccess()) return;
 #endif
 
     EmAssert(gCPU68K);
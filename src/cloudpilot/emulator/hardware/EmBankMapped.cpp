@@ -17,6 +17,7 @@
 
 #include "EmCPU68K.h"  // gCPU68K
 #include "EmMemory.h"  // Memory::InitializeBanks
+#include "EmSessionContext.h"
 
 // ===========================================================================
 //		� Dummy Bank Accessors
@@ -51,8 +52,13 @@ struct MapRange {
 };
 typedef vector<MapRange> MapRangeList;
 
-static MapRangeList gMappedRanges;
-static MapRangeList::iterator gLastIter;
+static thread_local MapRangeList gMappedRanges;
+static thread_local MapRangeList::iterator gLastIter;
+
+namespace {
+    const EmSessionState sessionState{EM_SESSION_VARIABLE(gMappedRanges),
+                                      EM_SESSION_VARIABLE(gLastIter)};
+}  // namespace
 
 // Map in blocks starting at this address.  I used to have it way out of
 // the way at 0x60000000.  However, there's a check in SysGetAppInfo to
@@ -16,12 +16,14 @@
 #include <memory>
 
 #include "Byteswapping.h"  // ByteswapWords
+#include "EmBlockCache.h"
 #include "EmCPU68K.h"      // gCPU68K
 #include "EmCommon.h"
 #include "EmHAL.h"          // EmHAL
 #include "EmMemory.h"       // Memory::InitializeBanks, EmMem_memset
 #include "EmPalmStructs.h"  // EmProxyCardHeaderType
 #include "EmSession.h"      // GetDevice, ScheduleDeferredError
+#include "EmSessionContext.h"
 #include "Miscellaneous.h"  // StWordSwapper, NextPowerOf2
 #include "Platform.h"
 
@@ -39,7 +41,7 @@ class Card {
 
 // static member initialization
 
-emuptr EmBankROM::gROMMemoryStart = kDefaultROMMemoryStart;
+EM_THREAD_LOCAL emuptr EmBankROM::gROMMemoryStart = kDefaultROMMemoryStart;
 
 // ===========================================================================
 //		� ROM Bank Accessors
@@ -53,11 +55,16 @@ static EmAddressBank gROMAddressBank = {
     EmBankROM::GetRealAddress, EmBankROM::ValidAddress, nullptr,
     EmBankROM::AddOpcodeCycles};
 
-static uint32 gROMBank_Size;
-static uint32 gManagedROMSize;
-static uint32 gROMImage_Size;
-static uint32 gROMBank_Mask;
-static uint8* gROM_Memory;
+static EM_THREAD_LOCAL uint32 gROMBank_Size;
+static EM_THREAD_LOCAL uint32 gManagedROMSize;
+static EM_THREAD_LOCAL uint32 gROMImage_Size;
+static EM_THREAD_LOCAL uint32 gROMBank_Mask;
+static EM_THREAD_LOCAL uint8* gROM_Memory;
+
+// ROM reads have no side effects unless access checks or profiling are
+// compiled in, so they can be served directly from gROM_Memory.
+static constexpr bool kDirectReads =
+    !(VALIDATE_ROM_GET || PREVENT_USER_ROM_GET || PREVENT_SYSTEM_ROM_GET || PROFILE_MEMORY);
 
 /***********************************************************************
  *
@@ -118,7 +125,11 @@ void EmBankROM::Reset(Bool /*hardwareReset*/) {}
  *
  ***********************************************************************/
 
-void EmBankROM::Dispose(void) { Platform::DisposeMemory(gROM_Memory); }
+void EmBankROM::Dispose(void) {
+    // The image is allocated with make_unique<uint8[]> in LoadROM.
+    delete[] gROM_Memory;
+    gROM_Memory = nullptr;
+}
 
 /***********************************************************************
  *
@@ -146,7 +157,8 @@ void EmBankROM::SetBankHandlers(void) {
     uint32 first_bank = EmMemBankIndex(EmBankROM::GetMemoryStart());
     uint32 last_bank = EmMemBankIndex(EmBankROM::GetMemoryStart() + gManagedROMSize - 1);
 
-    Memory::InitializeBanks(gROMAddressBank, first_bank, last_bank - first_bank + 1);
+    Memory::InitializeBanks(gROMAddressBank, first_bank, last_bank - first_bank + 1,
+                            kDirectReads ? gROM_Memory : nullptr, gROMBank_Mask);
 }
 
 // ---------------------------------------------------------------------------
@@ -277,6 +289,8 @@ void EmBankROM::SetLong(emuptr address, uint32 value) {
     address &= gROMBank_Mask;
 
     EmMemDoPut32(gROM_Memory + address, value);
+
+    EmBlockCache::Flush();
 }
 
 // ---------------------------------------------------------------------------
@@ -309,6 +323,8 @@ void EmBankROM::SetWord(emuptr address, uint32 value) {
     address &= gROMBank_Mask;
 
     EmMemDoPut16(gROM_Memory + address, value);
+
+    EmBlockCache::Flush();
 }
 
 // ---------------------------------------------------------------------------
@@ -335,6 +351,8 @@ void EmBankROM::SetByte(emuptr address, uint32 value) {
     address &= gROMBank_Mask;
 
     EmMemDoPut8(gROM_Memory + address, value);
+
+    EmBlockCache::Flush();
 }
 
 // ---------------------------------------------------------------------------
@@ -703,8 +721,14 @@ static EmAddressBank gFlashAddressBank = {
 
 #define FLASHBASE (EmBankROM::GetMemoryStart())
 
-static int gState = kAMDState_Normal;
-static Bool gEraseIsSetup;
+static EM_THREAD_LOCAL int gState = kAMDState_Normal;
+static EM_THREAD_LOCAL Bool gEraseIsSetup;
+
+const EmSessionState EmBankROM::sessionState{
+    EM_SESSION_VARIABLE(gROMMemoryStart), EM_SESSION_VARIABLE(gROMBank_Size),
+    EM_SESSION_VARIABLE(gManagedROMSize), EM_SESSION_VARIABLE(gROMImage_Size),
+    EM_SESSION_VARIABLE(gROMBank_Mask),   EM_SESSION_VARIABLE(gROM_Memory),
+    EM_SESSION_VARIABLE(gState),          EM_SESSION_VARIABLE(gEraseIsSetup)};
 
 /***********************************************************************
  *
@@ -1024,6 +1048,7 @@ void EmBankFlash::SetWord(emuptr address, uint32 value) {
 
             address &= gROMBank_Mask;
             EmMemDoPut16(gROM_Memory + address, value);
+            EmBlockCache::Flush();
 
             gState = kAMDState_ProgramDone;
             return;
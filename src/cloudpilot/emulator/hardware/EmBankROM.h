@@ -16,6 +16,7 @@
 
 #include "EmCommon.h"
 
+class EmSessionState;
 class EmStream;
 const emuptr kDefaultROMMemoryStart = 0x10C00000;
 
@@ -45,7 +46,9 @@ class EmBankROM {
     static void InvalidAccess(emuptr address, long size, Bool forRead);
     static bool LoadROM(size_t len, const uint8* buffer);
 
-    static emuptr gROMMemoryStart;
+    static EM_THREAD_LOCAL emuptr gROMMemoryStart;
+
+    static const EmSessionState sessionState;
 };
 
 class EmBankFlash {
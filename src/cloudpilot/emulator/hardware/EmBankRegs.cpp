@@ -16,8 +16,10 @@
 #include "EmCPU.h"     // GetPC
 #include "EmCPU68K.h"  // gCPU68K
 #include "EmCommon.h"
+#include "EmHAL.h"      // SyncCycles
 #include "EmMemory.h"   // gMemAccessFlags, EmMemory::IsPCInRAM
 #include "EmSession.h"  // GetDevice, ScheduleDeferredError
+#include "EmSessionContext.h"
 #include "Savestate.h"
 #include "SavestateLoader.h"
 #include "SavestateProbe.h"
@@ -70,12 +72,18 @@ static EmAddressBank gAddressBank = {EmBankRegs::GetLong,
                                      NULL,
                                      NULL};
 
-EmRegsList EmBankRegs::fgSubBanks;
-EmRegsList EmBankRegs::fgDisabledSubBanks;
+thread_local EmRegsList EmBankRegs::fgSubBanks;
+thread_local EmRegsList EmBankRegs::fgDisabledSubBanks;
 
-static EmRegs* gLastSubBank;
-static uint64 gLastStart;
-static uint32 gLastRange;
+static EM_THREAD_LOCAL EmRegs* gLastSubBank;
+static EM_THREAD_LOCAL uint64 gLastStart;
+static EM_THREAD_LOCAL uint32 gLastRange;
+
+const EmSessionState EmBankRegs::sessionState{EM_SESSION_VARIABLE(fgSubBanks),
+                                              EM_SESSION_VARIABLE(fgDisabledSubBanks),
+                                              EM_SESSION_VARIABLE(gLastSubBank),
+                                              EM_SESSION_VARIABLE(gLastStart),
+                                              EM_SESSION_VARIABLE(gLastRange)};
 
 static void PrvSwitchBanks(EmRegsList& fromList, EmRegsList& toList, emuptr address);
 
@@ -236,6 +244,8 @@ uint32 EmBankRegs::GetLong(emuptr address) {
     EmRegs* bank = EmBankRegs::GetSubBank(address, sizeof(uint32));
 
     if (bank) {
+        EmHAL::SyncCycles();
+
 #if (CHECK_FOR_ADDRESS_ERROR)
         if ((address & 1 && !bank->AllowUnalignedAccess(address, 4)) != 0) {
             AddressError(address, sizeof(uint32), true);
@@ -264,6 +274,8 @@ uint32 EmBankRegs::GetWord(emuptr address) {
     EmRegs* bank = EmBankRegs::GetSubBank(address, sizeof(uint16));
 
     if (bank) {
+        EmHAL::SyncCycles();
+
 #if (CHECK_FOR_ADDRESS_ERROR)
         if ((address & 1 && !bank->AllowUnalignedAccess(address, 2)) != 0) {
             AddressError(address, sizeof(uint16), true);
@@ -292,6 +304,8 @@ uint32 EmBankRegs::GetByte(emuptr address) {
     EmRegs* bank = EmBankRegs::GetSubBank(address, sizeof(uint8));
 
     if (bank) {
+        EmHAL::SyncCycles();
+
         return bank->GetByte(address);
     }
 
@@ -313,6 +327,8 @@ void EmBankRegs::SetLong(emuptr address, uint32 value) {
     EmRegs* bank = EmBankRegs::GetSubBank(address, sizeof(uint32));
 
     if (bank) {
+        EmHAL::SyncCycles();
+
 #if (CHECK_FOR_ADDRESS_ERROR)
         if ((address & 1 && !bank->AllowUnalignedAccess(address, 4)) != 0) {
             AddressError(address, sizeof(uint32), false);
@@ -342,6 +358,8 @@ void EmBankRegs::SetWord(emuptr address, uint32 value) {
     EmRegs* bank = EmBankRegs::GetSubBank(address, sizeof(uint16));
 
     if (bank) {
+        EmHAL::SyncCycles();
+
 #if (CHECK_FOR_ADDRESS_ERROR)
         if ((address & 1 && !bank->AllowUnalignedAccess(address, 2)) != 0) {
             AddressError(address, sizeof(uint16), false);
@@ -371,6 +389,8 @@ void EmBankRegs::SetByte(emuptr address, uint32 value) {
     EmRegs* bank = EmBankRegs::GetSubBank(address, sizeof(uint8));
 
     if (bank) {
+        EmHAL::SyncCycles();
+
         bank->SetByte(address, value);
 
         return;
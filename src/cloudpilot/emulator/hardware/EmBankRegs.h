@@ -16,6 +16,7 @@
 
 #include "EmRegs.h"  // EmRegsList
 
+class EmSessionState;
 class SavestateLoader;
 
 class EmBankRegs {
@@ -49,8 +50,10 @@ class EmBankRegs {
     static void AddressError(emuptr address, long size, Bool forRead);
     static void InvalidAccess(emuptr address, long size, Bool forRead);
 
-    static EmRegsList fgSubBanks;
-    static EmRegsList fgDisabledSubBanks;
+    static thread_local EmRegsList fgSubBanks;
+    static thread_local EmRegsList fgDisabledSubBanks;
+
+    static const EmSessionState sessionState;
 
     friend class EmRegs;  // EmBankRegs::InvalidAccess
 };
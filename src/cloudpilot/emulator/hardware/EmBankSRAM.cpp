@@ -14,20 +14,22 @@
 #include "EmBankSRAM.h"
 
 #include "Byteswapping.h"  // ByteswapWords
+#include "EmBlockCache.h"
 #include "EmCPU68K.h"      // gCPU68K
 #include "EmCommon.h"
 #include "EmHAL.h"
 #include "EmMemory.h"   // gRAMBank_Size, gRAM_Memory, gMemoryAccess
 #include "EmSession.h"  // GetDevice
+#include "EmSessionContext.h"
 #include "EmSystemState.h"
 #include "MemoryRegion.h"
 #include "MetaMemory.h"  // MetaMemory::
 #include "Platform.h"
 
 namespace {
-    uint32 ramSize;
-    uint8* dirtyPages;
-    uint8* ram;
+    EM_THREAD_LOCAL uint32 ramSize;
+    EM_THREAD_LOCAL uint8* dirtyPages;
+    EM_THREAD_LOCAL uint8* ram;
 
     EmAddressBank gAddressBank = {EmBankSRAM::GetLong,        EmBankSRAM::GetWord,
                                   EmBankSRAM::GetByte,        EmBankSRAM::SetLong,
@@ -50,19 +52,34 @@ namespace {
     constexpr emuptr kMemoryStartVZ = 0x00000000;
     constexpr emuptr kMemoryStartSZ = 0x00000000;
 
+    // SRAM reads have no side effects unless access checks or profiling are
+    // compiled in, so they can be served directly from the RAM region.
+    constexpr bool kDirectReads = !(VALIDATE_SRAM_GET || PREVENT_USER_SRAM_GET || PROFILE_MEMORY);
+
     inline uint8* InlineGetMetaAddress(emuptr address) {
         return (uint8*)&(gRAM_MetaMemory[address]);
     }
 
     inline void markDirty(emuptr address) {
         dirtyPages[address >> 13] |= (1 << ((address >> 10) & 0x07));
+
+        EmBlockCache::NotifyRAMWrite(address);
     }
 
 }  // namespace
 
-emuptr gMemoryStart;
-uint32 gRAMBank_Mask;
-uint8* gRAM_MetaMemory;
+EM_THREAD_LOCAL emuptr gMemoryStart;
+EM_THREAD_LOCAL uint32 gRAMBank_Mask;
+EM_THREAD_LOCAL uint8* gRAM_MetaMemory;
+
+namespace {
+    const EmSessionState sessionState{EM_SESSION_VARIABLE(ramSize),
+                                      EM_SESSION_VARIABLE(dirtyPages),
+                                      EM_SESSION_VARIABLE(ram),
+                                      EM_SESSION_VARIABLE(gMemoryStart),
+                                      EM_SESSION_VARIABLE(gRAMBank_Mask),
+                                      EM_SESSION_VARIABLE(gRAM_MetaMemory)};
+}  // namespace
 
 /***********************************************************************
  *
@@ -165,8 +182,11 @@ void EmBankSRAM::SetBankHandlers(void) {
     // physical memory is actually accessed.
     if (ramSize == 16 * 1024 * 1024 && gSession->GetDevice().NeedsSDCTLHack()) numBanks *= 2;
 
-    Memory::InitializeBanks(EmHAL::EnableRAM() ? gAddressBank : gAddressBankDisabled,
-                            EmMemBankIndex(gMemoryStart), numBanks);
+    if (EmHAL::EnableRAM())
+        Memory::InitializeBanks(gAddressBank, EmMemBankIndex(gMemoryStart), numBanks,
+                                kDirectReads ? ram : nullptr, gRAMBank_Mask);
+    else
+        Memory::InitializeBanks(gAddressBankDisabled, EmMemBankIndex(gMemoryStart), numBanks);
 }
 
 // ---------------------------------------------------------------------------
@@ -302,7 +322,7 @@ void EmBankSRAM::SetLong(emuptr address, uint32 value) {
     markDirty(phyAddress + 2);
 
     if (MetaMemory::IsScreenBuffer32(InlineGetMetaAddress(phyAddress)))
-        gSystemState.MarkScreenDirty(address, address + 4);
+        gSystemState->MarkScreenDirty(address, address + 4);
 }
 
 // ---------------------------------------------------------------------------
@@ -340,7 +360,7 @@ void EmBankSRAM::SetWord(emuptr address, uint32 value) {
     markDirty(phyAddress);
 
     if (MetaMemory::IsScreenBuffer16(InlineGetMetaAddress(phyAddress)))
-        gSystemState.MarkScreenDirty(address, address + 2);
+        gSystemState->MarkScreenDirty(address, address + 2);
 }
 
 // ---------------------------------------------------------------------------
@@ -371,7 +391,7 @@ void EmBankSRAM::SetByte(emuptr address, uint32 value) {
     markDirty(phyAddress);
 
     if (MetaMemory::IsScreenBuffer8(InlineGetMetaAddress(phyAddress)))
-        gSystemState.MarkScreenDirty(address, address);
+        gSystemState->MarkScreenDirty(address, address);
 }
 
 uint32 EmBankSRAM::GetDummy(emuptr address) { return 0; }
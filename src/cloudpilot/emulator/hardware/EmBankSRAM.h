@@ -16,11 +16,11 @@
 
 #include "EmCommon.h"
 
-extern emuptr gMemoryStart;
+extern EM_THREAD_LOCAL emuptr gMemoryStart;
 
 // These are also accessed by the DRAMBank functions.
-extern uint32 gRAMBank_Mask;
-extern uint8* gRAM_MetaMemory;
+extern EM_THREAD_LOCAL uint32 gRAMBank_Mask;
+extern EM_THREAD_LOCAL uint8* gRAM_MetaMemory;
 
 class EmBankSRAM {
    public:
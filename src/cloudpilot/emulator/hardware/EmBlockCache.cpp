@@ -0,0 +1,237 @@
+#include "EmBlockCache.h"
+
+#include "EmBankDRAM.h"
+#include "EmBankROM.h"
+#include "EmBankSRAM.h"  // gRAMBank_Mask
+#include "EmMemory.h"
+#include "EmSessionContext.h"
+#include "MemoryRegion.h"
+
+#ifdef __EMSCRIPTEN__
+extern cpuop_func* cpufunctbl_base;
+#else
+extern cpuop_func* cpufunctbl[65536];
+#endif
+
+namespace {
+    // The longest 68000 instruction is 10 bytes. Anything else that is not a
+    // step forward is a change of control flow and terminates the block.
+    constexpr uint32 MAX_INSTRUCTION_LENGTH = 10;
+
+    inline cpuop_func* lookupHandler(uint16 opcode) {
+#ifdef __EMSCRIPTEN__
+        return (cpuop_func*)((long)cpufunctbl_base + opcode);
+#else
+        return cpufunctbl[opcode];
+#endif
+    }
+}  // namespace
+
+EM_THREAD_LOCAL EmBlockCache::Block* EmBlockCache::blocks{nullptr};
+EM_THREAD_LOCAL uint8* EmBlockCache::codePages{nullptr};
+EM_THREAD_LOCAL uint32 EmBlockCache::codePagesSize{0};
+EM_THREAD_LOCAL uint32* EmBlockCache::pageBlocks{nullptr};
+EM_THREAD_LOCAL uint32 EmBlockCache::pageCount{0};
+EM_THREAD_LOCAL uint32 EmBlockCache::nextTag{1};
+EM_THREAD_LOCAL bool EmBlockCache::enabled{true};
+
+const EmSessionState EmBlockCache::sessionState{EM_SESSION_VARIABLE(blocks),
+                                                EM_SESSION_VARIABLE(codePages),
+                                                EM_SESSION_VARIABLE(codePagesSize),
+                                                EM_SESSION_VARIABLE(pageBlocks),
+                                                EM_SESSION_VARIABLE(pageCount),
+                                                EM_SESSION_VARIABLE(nextTag),
+                                                EM_SESSION_VARIABLE(enabled)};
+
+void EmBlockCache::Initialize() {
+    EmAssert(!blocks);
+
+    const uint32 ramSize = EmMemory::GetRegionSize(MemoryRegion::ram);
+
+    pageCount = ramSize / 1024 + (ramSize % 1024 == 0 ? 0 : 1);
+    codePagesSize = pageCount / 8 + (pageCount % 8 == 0 ? 0 : 1);
+    codePages = new uint8[codePagesSize];
+    pageBlocks = new uint32[pageCount];
+    blocks = new Block[BLOCK_COUNT];
+
+    for (uint32 i = 0; i < pageCount; i++) pageBlocks[i] = NO_LINK;
+
+    Flush();
+}
+
+void EmBlockCache::Dispose() {
+    delete[] blocks;
+    delete[] codePages;
+    delete[] pageBlocks;
+
+    blocks = nullptr;
+    codePages = nullptr;
+    pageBlocks = nullptr;
+    codePagesSize = 0;
+    pageCount = 0;
+}
+
+void EmBlockCache::Flush() {
+    if (!blocks) return;
+
+    for (uint32 i = 0; i < BLOCK_COUNT; i++) Invalidate(blocks[i]);
+
+    memset(codePages, 0, codePagesSize);
+}
+
+void EmBlockCache::SetEnabled(bool enabled) {
+    EmBlockCache::enabled = enabled;
+
+    Flush();
+}
+
+bool EmBlockCache::IsEnabled() { return enabled; }
+
+void EmBlockCache::InvalidateRAMPage(uint32 page) {
+    codePages[page >> 3] &= ~(1 << (page & 0x07));
+
+    // Invalidating the block unlinks it from the list.
+    while (pageBlocks[page] != NO_LINK) Invalidate(blocks[pageBlocks[page] >> 1]);
+}
+
+void EmBlockCache::Invalidate(Block& block) {
+    for (uint32 slot = 0; slot < 2; slot++)
+        if (block.pages[slot] != NO_PAGE) Unlink(block, slot);
+
+    block.tag = nextTag++;
+    block.start = EmMemNULL;
+    block.size = 0;
+}
+
+bool EmBlockCache::AddPage(Block& block, uint32 page) {
+    if (block.pages[0] == page || block.pages[1] == page) return true;
+
+    for (uint32 slot = 0; slot < 2; slot++) {
+        if (block.pages[slot] != NO_PAGE) continue;
+
+        block.pages[slot] = page;
+        Link(block, slot);
+
+        return true;
+    }
+
+    return false;
+}
+
+void EmBlockCache::Link(Block& block, uint32 slot) {
+    const uint32 page = block.pages[slot];
+    const uint32 link = static_cast<uint32>(&block - blocks) * 2 + slot;
+    const uint32 head = pageBlocks[page];
+
+    block.next[slot] = head;
+    block.prev[slot] = NO_LINK;
+
+    if (head != NO_LINK) blocks[head >> 1].prev[head & 1] = link;
+    pageBlocks[page] = link;
+}
+
+void EmBlockCache::Unlink(Block& block, uint32 slot) {
+    const uint32 page = block.pages[slot];
+    const uint32 next = block.next[slot];
+    const uint32 prev = block.prev[slot];
+
+    if (next != NO_LINK) blocks[next >> 1].prev[next & 1] = prev;
+
+    if (prev != NO_LINK)
+        blocks[prev >> 1].next[prev & 1] = next;
+    else
+        pageBlocks[page] = next;
+
+    block.pages[slot] = NO_PAGE;
+    block.next[slot] = block.prev[slot] = NO_LINK;
+}
+
+bool EmBlockCache::IsCacheable(emuptr pc, uint32& page) {
+    if (pc & 1) return false;
+
+    const auto wget = Memory::GetHandlerBank(pc).wget;
+
+    if (wget == EmBankSRAM::GetWord || wget == EmBankDRAM::GetWord) {
+        page = (pc & gRAMBank_Mask) >> 10;
+        return true;
+    }
+
+    page = NO_PAGE;
+    return wget == EmBankROM::GetWord || wget == EmBankFlash::GetWord;
+}
+
+bool EmBlockCache::Cursor::StartRecording(emuptr pc) {
+    uint32 page;
+    if (!IsCacheable(pc, page)) return false;
+
+    Block& slot(Slot(pc));
+
+    Invalidate(slot);
+    slot.start = pc;
+
+    recording = &slot;
+    recordingTag = slot.tag;
+
+    return true;
+}
+
+void EmBlockCache::Cursor::StopRecording() { recording = nullptr; }
+
+cpuop_func* EmBlockCache::Cursor::FetchSlow(emuptr pc, uint32& opcode) {
+    block = nullptr;
+
+    if (!enabled) {
+        opcode = EmMemGet16(pc);
+        return lookupHandler(opcode);
+    }
+
+    if (recording) {
+        // The block under construction may have been invalidated by a write
+        // or by a nested Execute that reused the slot.
+        if (recording->tag != recordingTag || recording->size >= BLOCK_SIZE) {
+            StopRecording();
+        } else if (recording->size > 0) {
+            const emuptr lastPc = recording->instructions[recording->size - 1].pc;
+
+            if (pc <= lastPc || pc > lastPc + MAX_INSTRUCTION_LENGTH) StopRecording();
+        }
+    }
+
+    if (!recording) {
+        Block& slot(Slot(pc));
+
+        if (slot.start == pc && slot.size > 0) {
+            block = &slot;
+            tag = slot.tag;
+            index = 1;
+
+            opcode = slot.instructions[0].opcode;
+            return slot.instructions[0].handler;
+        }
+
+        StartRecording(pc);
+    }
+
+    uint8* directBase = EmMemGetDirectBase(pc);
+
+    opcode = (directBase && (pc & 1) == 0) ? EmMemDoGet16(directBase + (pc & 0xffff))
+                                           : Memory::GetHandlerBank(pc).wget(pc);
+    cpuop_func* handler = lookupHandler(opcode);
+
+    uint32 page;
+    if (!recording || !IsCacheable(pc, page) ||
+        (page != NO_PAGE && !AddPage(*recording, page))) {
+        StopRecording();
+
+        return handler;
+    }
+
+    Instruction& instruction(recording->instructions[recording->size++]);
+    instruction.handler = handler;
+    instruction.pc = pc;
+    instruction.opcode = opcode;
+
+    if (page != NO_PAGE) codePages[page >> 3] |= (1 << (page & 0x07));
+
+    return handler;
+}
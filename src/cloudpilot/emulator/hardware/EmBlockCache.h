@@ -0,0 +1,136 @@
+#ifndef _EM_BLOCK_CACHE_H_
+#define _EM_BLOCK_CACHE_H_
+
+#include "EmCommon.h"
+#include "UAE.h"  // cpuop_func
+
+class EmSessionState;
+
+// A cache of predecoded basic blocks for EmCPU68K::Execute. Each block is a
+// straight line run of instructions keyed by the PC of its first instruction.
+// For every instruction, the block records its PC, its opcode word and the
+// resolved handler from cpufunctbl, so a cache hit skips the bank dispatch for
+// the opcode fetch and the table lookup. Operand words are still fetched by
+// the handlers themselves, so only the opcode words need to be guarded.
+//
+// Blocks are recorded while they execute. Replay verifies the PC of each
+// instruction before dispatching it, so a branch out of the middle of a block
+// simply falls back to a lookup at the new PC.
+//
+// Invalidation: RAM writes are checked against a bitmap of 1k pages that
+// contain cached code (same granularity as the dirty page bitmap); a hit drops
+// all blocks on that page. The blocks on each page are kept in a linked list,
+// so this does not scan the whole cache. Writes to ROM / flash and any change
+// to the bank layout flush the whole cache.
+
+class EmBlockCache {
+   public:
+    static constexpr uint32 BLOCK_SIZE = 16;
+    static constexpr uint32 BLOCK_COUNT = 2048;
+
+    struct Instruction {
+        cpuop_func* handler;
+        emuptr pc;
+        uint16 opcode;
+    };
+
+    struct Block {
+        uint32 tag{0};
+        emuptr start{EmMemNULL};
+        uint32 size{0};
+
+        // A block covers at most two RAM pages. For each of them, the block is
+        // linked into the list of that page.
+        uint32 pages[2]{NO_PAGE, NO_PAGE};
+        uint32 next[2]{NO_LINK, NO_LINK};
+        uint32 prev[2]{NO_LINK, NO_LINK};
+
+        Instruction instructions[BLOCK_SIZE];
+    };
+
+    class Cursor {
+       public:
+        inline cpuop_func* Fetch(emuptr pc, uint32& opcode);
+
+       private:
+        cpuop_func* FetchSlow(emuptr pc, uint32& opcode);
+
+        bool StartRecording(emuptr pc);
+        void StopRecording();
+
+       private:
+        Block* block{nullptr};
+        uint32 tag{0};
+        uint32 index{0};
+
+        Block* recording{nullptr};
+        uint32 recordingTag{0};
+    };
+
+   public:
+    static void Initialize();
+    static void Dispose();
+
+    static void Flush();
+
+    // A disabled cache fetches every opcode through the banks. This is meant
+    // for comparing both paths.
+    static void SetEnabled(bool enabled);
+    static bool IsEnabled();
+
+    static inline void NotifyRAMWrite(uint32 offset);
+
+   private:
+    static constexpr uint32 NO_PAGE = 0xffffffff;
+
+    // Links identify a page slot of a block: block index * 2 + slot.
+    static constexpr uint32 NO_LINK = 0xffffffff;
+
+    static void InvalidateRAMPage(uint32 page);
+    static void Invalidate(Block& block);
+
+    static bool AddPage(Block& block, uint32 page);
+    static void Link(Block& block, uint32 slot);
+    static void Unlink(Block& block, uint32 slot);
+
+    static bool IsCacheable(emuptr pc, uint32& page);
+
+    static inline Block& Slot(emuptr pc);
+
+   private:
+    static EM_THREAD_LOCAL Block* blocks;
+    static EM_THREAD_LOCAL uint8* codePages;
+    static EM_THREAD_LOCAL uint32 codePagesSize;
+    static EM_THREAD_LOCAL uint32* pageBlocks;
+    static EM_THREAD_LOCAL uint32 pageCount;
+    static EM_THREAD_LOCAL uint32 nextTag;
+    static EM_THREAD_LOCAL bool enabled;
+
+    static const EmSessionState sessionState;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// IMPLEMENTATION
+///////////////////////////////////////////////////////////////////////////////
+
+inline EmBlockCache::Block& EmBlockCache::Slot(emuptr pc) {
+    return blocks[(pc >> 1) & (BLOCK_COUNT - 1)];
+}
+
+inline void EmBlockCache::NotifyRAMWrite(uint32 offset) {
+    if (codePages[offset >> 13] & (1 << ((offset >> 10) & 0x07))) InvalidateRAMPage(offset >> 10);
+}
+
+inline cpuop_func* EmBlockCache::Cursor::Fetch(emuptr pc, uint32& opcode) {
+    if (block && block->tag == tag && index < block->size &&
+        block->instructions[index].pc == pc) {
+        const Instruction& instruction(block->instructions[index++]);
+
+        opcode = instruction.opcode;
+        return instruction.handler;
+    }
+
+    return FetchSlow(pc, opcode);
+}
+
+#endif  // _EM_BLOCK_CACHE_H_
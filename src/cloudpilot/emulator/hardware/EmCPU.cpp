@@ -14,8 +14,13 @@
 #include "EmCPU.h"
 
 #include "EmCommon.h"
+#include "EmSessionContext.h"
 
-EmCPU* gCPU;
+EM_THREAD_LOCAL EmCPU* gCPU;
+
+namespace {
+    const EmSessionState sessionState{EM_SESSION_VARIABLE(gCPU)};
+}  // namespace
 
 // ---------------------------------------------------------------------------
 //		� EmCPU::EmCPU
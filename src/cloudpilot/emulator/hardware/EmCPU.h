@@ -23,7 +23,7 @@ class SavestateLoader;
 class EmSession;
 
 class EmCPU;
-extern EmCPU* gCPU;
+extern EM_THREAD_LOCAL EmCPU* gCPU;
 
 class EmCPU {
    public:
@@ -67,6 +67,11 @@ class EmCPU {
 
     virtual Bool Stopped(void) = 0;
 
+    // Enter or leave the state a STOP instruction puts the CPU into. The CPU
+    // does not stop while interrupts are masked, as it would never wake up.
+
+    virtual void SetStopped(Bool) = 0;
+
    protected:
     EmSession* fSession;
 };
@@ -18,19 +18,25 @@
 #endif
 
 #include <algorithm>  // find
+#include <mutex>      // call_once
 
 #include "Byteswapping.h"  // Canonical
 #include "ChunkHelper.h"
 #include "Debugger.h"
+#include "DebuggerMemoryBinding.h"
 #include "EmBankROM.h"  // EmBankROM::GetMemoryStart
+#include "EmBlockCache.h"
 #include "EmCommon.h"
 #include "EmHAL.h"      // EmHAL::GetInterruptLevel
 #include "EmMemory.h"   // CEnableFullAccess
 #include "EmSession.h"  // HandleInstructionBreak
+#include "EmSessionContext.h"
+#include "InterruptTracer.h"
 #include "Logging.h"
 #include "MetaMemory.h"
 #include "Miscellaneous.h"
 #include "Platform.h"
+#include "Profiler.h"
 #include "Savestate.h"
 #include "SavestateLoader.h"
 #include "SavestateStructures.h"
@@ -48,6 +54,8 @@ constexpr uint32 SAVESTATE_VERSION = 1;
 // and avoid using the high bit just for safety.
 
 #define SPCFLAG_END_OF_CYCLE (0x40000000)
+#define SPCFLAG_PROFILE (0x20000000)
+#define SPCFLAG_INTERRUPT_TRACE (0x10000000)
 
 // Data needed by UAE.
 
@@ -64,12 +72,12 @@ cpuop_func* cpufunctbl_base;
 cpuop_func* cpufunctbl[65536];  // (normally in newcpu.c)
 #endif
 
-uint16 last_op_for_exception_3;    /* Opcode of faulting instruction */
-emuptr last_addr_for_exception_3;  /* PC at fault time */
-emuptr last_fault_for_exception_3; /* Address that generated the exception */
+EM_THREAD_LOCAL uint16 last_op_for_exception_3;    /* Opcode of faulting instruction */
+EM_THREAD_LOCAL emuptr last_addr_for_exception_3;  /* PC at fault time */
+EM_THREAD_LOCAL emuptr last_fault_for_exception_3; /* Address that generated the exception */
 
-struct regstruct regs;        // (normally in newcpu.c)
-struct flag_struct regflags;  // (normally in support.c)
+EM_THREAD_LOCAL struct regstruct regs;        // (normally in newcpu.c)
+EM_THREAD_LOCAL struct flag_struct regflags;  // (normally in support.c)
 
 // These variables should strictly be in a sub-system that implements
 // the stack overflow checking, etc.  However, for performance reasons,
@@ -78,10 +86,10 @@ struct flag_struct regflags;  // (normally in support.c)
 //
 // Similar comments for the CheckKernelStack function.
 
-uae_u32 gStackHigh;
-uae_u32 gStackLowWarn;
-uae_u32 gStackLow;
-uae_u32 gKernelStackOverflowed;
+EM_THREAD_LOCAL uae_u32 gStackHigh;
+EM_THREAD_LOCAL uae_u32 gStackLowWarn;
+EM_THREAD_LOCAL uae_u32 gStackLow;
+EM_THREAD_LOCAL uae_u32 gKernelStackOverflowed;
 
 // Definitions of the stack frames used in EmCPU68K::ProcessException.
 
@@ -102,7 +110,20 @@ struct ExceptionStackFrame2 {
 
 #include "PalmPackPop.h"
 
-EmCPU68K* gCPU68K;
+EM_THREAD_LOCAL EmCPU68K* gCPU68K;
+
+namespace {
+    const EmSessionState sessionState{EM_SESSION_VARIABLE(last_op_for_exception_3),
+                                      EM_SESSION_VARIABLE(last_addr_for_exception_3),
+                                      EM_SESSION_VARIABLE(last_fault_for_exception_3),
+                                      EM_SESSION_VARIABLE(regs),
+                                      EM_SESSION_VARIABLE(regflags),
+                                      EM_SESSION_VARIABLE(gStackHigh),
+                                      EM_SESSION_VARIABLE(gStackLowWarn),
+                                      EM_SESSION_VARIABLE(gStackLow),
+                                      EM_SESSION_VARIABLE(gKernelStackOverflowed),
+                                      EM_SESSION_VARIABLE(gCPU68K)};
+}  // namespace
 
 // ---------------------------------------------------------------------------
 //		� EmCPU68K::Cycle
@@ -120,8 +141,12 @@ EmCPU68K* gCPU68K;
                                                                                          \
         EmAssert(session);                                                               \
         if (!session->IsNested()) {                                                      \
-            /* Perform CPU-specific idling. */                                           \
-            EmHAL::DispatchCycle(session->GetSystemCycles() + fCurrentCycles, sleeping); \
+            /* Perform CPU-specific idling. Dispatching is deadline driven, but */       \
+            /* the stopped loop skips ahead to the next interrupt anyway. */             \
+            if (sleeping)                                                                \
+                EmHAL::DispatchCycle(session->GetSystemCycles() + fCurrentCycles, true); \
+            else                                                                         \
+                EmHAL::Cycle(session->GetSystemCycles() + fCurrentCycles, false);        \
                                                                                          \
             /* Perform expensive operations. */                                          \
                                                                                          \
@@ -134,7 +159,7 @@ EmCPU68K* gCPU68K;
 namespace {
 #ifdef TRACE_FUNCTION_CALLS
     const char* getFunctionName(emuptr address) {
-        static char fname[33];
+        static EM_THREAD_LOCAL char fname[33];
         memset(fname, 0, 33);
 
         emuptr addr;
@@ -354,23 +379,53 @@ void EmCPU68K::DoSaveLoad(T& helper) {
 // ---------------------------------------------------------------------------
 
 uint32 EmCPU68K::Execute(uint32 maxCycles) {
+    // The debugger hooks are compiled into a separate copy of the main loop
+    // that only runs while a debugger is attached. The debugger is attached
+    // and detached in between calls, and breaks raised by traps and
+    // watchpoints can only happen while it is attached.
+
+#ifdef ENABLE_DEBUGGER
+    if (gDebugger->IsEnabled()) return ExecuteLoop<true>(maxCycles);
+#endif
+
+    return ExecuteLoop<false>(maxCycles);
+}
+
+// ---------------------------------------------------------------------------
+//		� EmCPU68K::ExecuteLoop
+// ---------------------------------------------------------------------------
+
+template <bool debuggerHooks>
+uint32 EmCPU68K::ExecuteLoop(uint32 maxCycles) {
     // This function is the bottleneck for all 68K emulation.  It's
     // important that it run as quickly as possible.  To that end,
     // fine tune register allocation as much as we can by hand.
 
     EmValueChanger<uint32> resetCurrentCycles(fCurrentCycles, 0);
 
+    // The cycle count may have been modified or the consumers may have been
+    // reset or reloaded since the last call.
+    EmHAL::InvalidateCycleDeadline();
+
     // Do not run cycleSlowly on each call if single stepping
     int counter = maxCycles ? 0 : 1;
 
     uint32 cycles;
 
+#if BLOCK_CACHE
+    EmBlockCache::Cursor blockCursor;
+#endif
+
 #define pc (regs.pc)
 #define spcflags (regs.spcflags)
 #define session (fSession)
 
     EmAssert(session);
 
+    // The flags are cleared on reset, so rearm them on each call.
+    if (gProfiler->IsRunning()) spcflags |= SPCFLAG_PROFILE;
+    if (gInterruptTracer->HasActiveHandlers()) spcflags |= SPCFLAG_INTERRUPT_TRACE;
+
     // -----------------------------------------------------------------------
     // Check for the stopped flag before entering the "execute an opcode"
     // section.  It could be that we last exited the loop while still in stop
@@ -401,10 +456,10 @@ uint32 EmCPU68K::Execute(uint32 maxCycles) {
         // needing to execute tailpatches.
         // -----------------------------------------------------------------------
 
-#ifdef ENABLE_DEBUGGER
-        gDebugger.NotificyPc(pc);
-        if (gDebugger.IsStopped() && !gSession->IsNested()) break;
-#endif
+        if constexpr (debuggerHooks) {
+            gDebugger->NotificyPc(pc);
+            if (gDebugger->IsStopped() && !gSession->IsNested()) break;
+        }
 
         if (MetaMemory::IsCPUBreak(m68k_getpc())) {
             session->HandleInstructionBreak();
@@ -418,17 +473,34 @@ uint32 EmCPU68K::Execute(uint32 maxCycles) {
 
         EmOpcode68K opcode;
 
+#if BLOCK_CACHE
+        // Fetches from the block cache bypass the memory banks.
+        if constexpr (debuggerHooks) {
+            if (Memory::IsInstrumented()) DbgNotifyRead16(pc);
+        }
+
+        cpuop_func* handler;
+
+        handler = blockCursor.Fetch(pc, opcode);
+    #ifdef TRACE_FUNCTION_CALLS
+        traceFunctionCalls(opcode, pc);
+    #endif
+
+        cycles = handler(opcode);
+#else
         opcode = EmMemGet16(pc);
-#ifdef TRACE_FUNCTION_CALLS
+    #ifdef TRACE_FUNCTION_CALLS
         traceFunctionCalls(opcode, pc);
-#endif
+    #endif
 
-#ifdef __EMSCRIPTEN__
+    #ifdef __EMSCRIPTEN__
         cycles = ((cpuop_func*)((long)cpufunctbl_base + opcode))(opcode);
-#else
+    #else
         cycles = (cpufunctbl[opcode])(opcode);
+    #endif
 #endif
         fCurrentCycles += cycles;
+        fInstructionCount++;
         // =======================================================================
 
         // Perform periodic tasks.
@@ -456,6 +528,10 @@ uint32 EmCPU68K::Execute(uint32 maxCycles) {
 #undef spcflags
 #undef session
 
+    // Leave the cycle consumers in sync with the CPU for everything that
+    // happens between two calls.
+    EmHAL::SyncCycles();
+
     return fCurrentCycles;
 }
 
@@ -466,6 +542,20 @@ uint32 EmCPU68K::Execute(uint32 maxCycles) {
 Bool EmCPU68K::ExecuteSpecial(uint32 maxCycles) {
     EmAssert(fSession);
 
+    if (regs.spcflags & SPCFLAG_PROFILE) {
+        if (gProfiler->IsRunning())
+            gProfiler->Tick(fSession->GetSystemCycles() + fCurrentCycles,
+                           regs.stopped ? Profiler::IDLE_PC : m68k_getpc());
+        else
+            regs.spcflags &= ~SPCFLAG_PROFILE;
+    }
+
+    // Watch the interrupt mask for the return from interrupt handlers.
+    if ((regs.spcflags & SPCFLAG_INTERRUPT_TRACE) &&
+        !gInterruptTracer->CheckComplete(fSession->GetSystemCycles() + fCurrentCycles,
+                                        regs.intmask))
+        regs.spcflags &= ~SPCFLAG_INTERRUPT_TRACE;
+
     // Return stopped, tracing, interrupts, reset when calling into PalmOS
     if (fSession->IsNested()) return this->CheckForBreak();
     if (SuspendManager::IsSuspended()) return true;
@@ -541,10 +631,13 @@ Bool EmCPU68K::ExecuteStoppedLoop(uint32 maxCycles) {
     do {
         uint32 cyclesToNextInterrupt =
             EmHAL::CyclesToNextInterrupt(session->GetSystemCycles() + fCurrentCycles);
-        fCurrentCycles += ((gSession->IsPowerOn() && cyclesToNextInterrupt > 0 &&
-                            cyclesToNextInterrupt != 0xffffffff)
-                               ? cyclesToNextInterrupt
-                               : (maxCycles > 0 ? maxCycles : 1));
+        const uint32 stoppedCycles = (gSession->IsPowerOn() && cyclesToNextInterrupt > 0 &&
+                                      cyclesToNextInterrupt != 0xffffffff)
+                                         ? cyclesToNextInterrupt
+                                         : (maxCycles > 0 ? maxCycles : 1);
+
+        fCurrentCycles += stoppedCycles;
+        session->GetStats().AddStoppedCycles(stoppedCycles);
 
         CYCLE(true);
 
@@ -767,6 +860,12 @@ void EmCPU68K::SetRegister(int index, uint32 val) {
 
 Bool EmCPU68K::Stopped(void) { return regs.stopped; }
 
+// ---------------------------------------------------------------------------
+//		� EmCPU68K::SetStopped
+// ---------------------------------------------------------------------------
+
+void EmCPU68K::SetStopped(Bool stopped) { m68k_setstopped(stopped && regs.intmask < 7); }
+
 // ---------------------------------------------------------------------------
 //		� EmCPU68K::CheckForBreak
 // ---------------------------------------------------------------------------
@@ -788,6 +887,13 @@ void EmCPU68K::ProcessInterrupt(int32 interrupt) {
 
     regs.intmask = interrupt;
     regs.spcflags |= SPCFLAG_INT;  // Check for higher-level interrupts
+
+    fSession->GetStats().CountInterrupt();
+
+    if (gInterruptTracer->IsRunning()) {
+        gInterruptTracer->Accept(fSession->GetSystemCycles() + fCurrentCycles, interrupt);
+        regs.spcflags |= SPCFLAG_INTERRUPT_TRACE;
+    }
 }
 
 // ---------------------------------------------------------------------------
@@ -1136,15 +1242,17 @@ void EmCPU68K::AddressError(emuptr address, long size, Bool forRead) {
 // ---------------------------------------------------------------------------
 
 void EmCPU68K::InitializeUAETables(void) {
-    static int initialized;
+    // All of the stuff in DoInitializeUAETables needs to be done only once;
+    // it doesn't need to be executed every time we create a new CPU. The
+    // tables are shared by all sessions in the process, and sessions may be
+    // created on different threads.
 
-    // All of the stuff in this function needs to be done only once;
-    // it doesn't need to be executed every time we create a new CPU.
+    static once_flag initialized;
 
-    if (initialized) return;
-
-    initialized = true;
+    call_once(initialized, &EmCPU68K::DoInitializeUAETables);
+}
 
+void EmCPU68K::DoInitializeUAETables(void) {
     // Initialize some CPU-related tables
     // (This initialization code is taken from init_m68k in newcpu.c)
 
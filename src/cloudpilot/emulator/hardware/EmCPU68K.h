@@ -182,7 +182,7 @@ typedef vector<Hook68KNewPC> Hook68KNewPCList;
 typedef vector<Hook68KNewSP> Hook68KNewSPList;
 
 class EmCPU68K;
-extern EmCPU68K* gCPU68K;
+extern EM_THREAD_LOCAL EmCPU68K* gCPU68K;
 
 // These variables should strictly be in a sub-system that implements
 // the stack overflow checking, etc.  However, for performance reasons,
@@ -192,10 +192,10 @@ extern EmCPU68K* gCPU68K;
 // Similar comments for the CheckKernelStack function.
 
 #if 0  // CSDUBIOUS
-extern "C" uint32 gStackHigh;
-extern "C" uint32 gStackLowWarn;
-extern "C" uint32 gStackLow;
-extern "C" uint32 gKernelStackOverflowed;
+extern "C" EM_THREAD_LOCAL uint32 gStackHigh;
+extern "C" EM_THREAD_LOCAL uint32 gStackLowWarn;
+extern "C" EM_THREAD_LOCAL uint32 gStackLow;
+extern "C" EM_THREAD_LOCAL uint32 gKernelStackOverflowed;
 #endif
 
 class EmCPU68K : public EmCPU {
@@ -228,6 +228,14 @@ class EmCPU68K : public EmCPU {
     virtual uint32 Execute(uint32 maxCycles);
     virtual void CheckAfterCycle(void);
 
+    // Cycles executed so far by the current call to Execute.
+
+    uint32 GetCurrentCycles(void) const { return fCurrentCycles; }
+
+    // Total number of instructions executed since the CPU was created.
+
+    uint64 GetInstructionCount(void) const { return fInstructionCount; }
+
     // Low-level access to CPU state.
 
     virtual emuptr GetPC(void);
@@ -239,6 +247,7 @@ class EmCPU68K : public EmCPU {
     virtual void SetRegister(int, uint32);
 
     virtual Bool Stopped(void);
+    virtual void SetStopped(Bool);
 
     // Called from routines in EmUAEGlue.cpp
 
@@ -270,6 +279,9 @@ class EmCPU68K : public EmCPU {
     void AddressError(emuptr address, long size, Bool forRead);
 
    private:
+    template <bool debuggerHooks>
+    uint32 ExecuteLoop(uint32 maxCycles);
+
     Bool ExecuteSpecial(uint32 maxCycles);
     Bool ExecuteStoppedLoop(uint32 maxCycles);
 
@@ -279,6 +291,7 @@ class EmCPU68K : public EmCPU {
     void ProcessInterrupt(int32 interrupt);
 
     void InitializeUAETables(void);
+    static void DoInitializeUAETables(void);
 
     template <typename T>
     void DoSave(T& savestate);
@@ -291,6 +304,7 @@ class EmCPU68K : public EmCPU {
     Hook68KExceptionList fExceptionHandlers[kException_LastException];
     Hook68KJSR_IndList fHookJSR_Ind;
     uint32 fCurrentCycles{0};
+    uint64 fInstructionCount{0};
     Bool isSettingUpExceptionFrame{false};
 
 #if REGISTER_HISTORY
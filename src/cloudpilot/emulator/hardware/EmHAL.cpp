@@ -13,12 +13,14 @@
 
 #include "EmHAL.h"
 
+#include "EmCPU68K.h"
 #include "EmCommon.h"
 #include "EmSession.h"
+#include "EmSessionContext.h"
 #include "EmTransportSerial.h"
 #include "Logging.h"
 
-EmHALHandler* EmHAL::fgRootHandler;
+EM_THREAD_LOCAL EmHALHandler* EmHAL::fgRootHandler;
 
 #define PRINTF \
     if (!0)    \
@@ -39,11 +41,21 @@ EmHALHandler* EmHAL::fgRootHandler;
  *
  ***********************************************************************/
 
-EmEvent<> EmHAL::onSystemClockChange{};
-EmEvent<double, double> EmHAL::onPwmChange{};
-EmEvent<> EmHAL::onDayRollover{};
+thread_local EmEvent<> EmHAL::onSystemClockChange{};
+thread_local EmEvent<double, double> EmHAL::onPwmChange{};
+thread_local EmEvent<> EmHAL::onDayRollover{};
 
-vector<EmHAL::CycleConsumer> EmHAL::cycleConsumers;
+thread_local vector<EmHAL::CycleConsumer> EmHAL::cycleConsumers;
+EM_THREAD_LOCAL uint64 EmHAL::nextCycleDeadline{0};
+EM_THREAD_LOCAL uint64 EmHAL::lastDispatchedCycles{~0ull};
+
+const EmSessionState EmHAL::sessionState{EM_SESSION_VARIABLE(fgRootHandler),
+                                         EM_SESSION_VARIABLE(onSystemClockChange),
+                                         EM_SESSION_VARIABLE(onPwmChange),
+                                         EM_SESSION_VARIABLE(onDayRollover),
+                                         EM_SESSION_VARIABLE(cycleConsumers),
+                                         EM_SESSION_VARIABLE(nextCycleDeadline),
+                                         EM_SESSION_VARIABLE(lastDispatchedCycles)};
 
 // ---------------------------------------------------------------------------
 //		� EmHAL::AddHandler
@@ -222,7 +234,12 @@ Bool EmHAL::GetLCDHasFrame(void) {
 
 bool EmHAL::CopyLCDFrame(Frame& frame, bool fullRefresh) {
     EmAssert(EmHAL::GetRootHandler());
-    return EmHAL::GetRootHandler()->CopyLCDFrame(frame, fullRefresh);
+
+    if (!EmHAL::GetRootHandler()->CopyLCDFrame(frame, fullRefresh)) return false;
+
+    gSession->GetStats().CountFrame();
+
+    return true;
 }
 
 uint16 EmHAL::GetLCD2bitMapping() {
@@ -448,13 +465,16 @@ void EmHAL::AddCycleConsumer(CycleHandler handler, void* context) {
     }
 
     cycleConsumers.push_back({handler, context});
+
+    lastDispatchedCycles = ~0ull;
+    InvalidateCycleDeadline();
 }
 
 void EmHAL::RemoveCycleConsumer(CycleHandler handler, void* context) {
     typename vector<CycleConsumer*>::size_type j = 0;
 
     for (typename vector<CycleConsumer*>::size_type i = 0; i < cycleConsumers.size(); i++)
-        if (cycleConsumers[i].handler != handler && cycleConsumers[i].context != context) {
+        if (cycleConsumers[i].handler != handler || cycleConsumers[i].context != context) {
             if (j != i) cycleConsumers[j] = cycleConsumers[i];
             j++;
         }
@@ -463,7 +483,44 @@ void EmHAL::RemoveCycleConsumer(CycleHandler handler, void* context) {
 }
 
 void EmHAL::DispatchCycle(uint64 cycles, bool sleeping) {
-    for (auto consumer : cycleConsumers) consumer.handler(consumer.context, cycles, sleeping);
+    uint64 deadline = ~0ull;
+
+    for (auto consumer : cycleConsumers)
+        deadline = min(deadline, consumer.handler(consumer.context, cycles, sleeping));
+
+    nextCycleDeadline = deadline;
+    lastDispatchedCycles = cycles;
+}
+
+// ---------------------------------------------------------------------------
+//		� EmHAL::SyncCycles
+// ---------------------------------------------------------------------------
+// Consumers only see the cycle count when they are dispatched. Anything that
+// inspects or modifies their state from within an instruction (i.e. register
+// accesses) needs to bring them up to date first. The deadline is reset, as the
+// access may well reschedule the consumer.
+
+void EmHAL::SyncCycles() {
+    InvalidateCycleDeadline();
+
+    if (!gSession || !gCPU68K || gSession->IsNested()) return;
+
+    const uint64 cycles = GetCurrentCycles();
+    if (cycles == lastDispatchedCycles) return;
+
+    DispatchCycle(cycles, false);
+    InvalidateCycleDeadline();
+}
+
+// ---------------------------------------------------------------------------
+//		� EmHAL::GetCurrentCycles
+// ---------------------------------------------------------------------------
+// System cycles including the cycles spent in the current Execute slice.
+
+uint64 EmHAL::GetCurrentCycles() {
+    if (!gSession) return 0;
+
+    return gSession->GetSystemCycles() + (gCPU68K ? gCPU68K->GetCurrentCycles() : 0);
 }
 
 bool EmHAL::SupportsImageInSlot(Slot slot, uint32 blocksTotal) {
@@ -23,6 +23,7 @@
 
 class EmHAL;
 class EmPixMap;
+class EmSessionState;
 struct Frame;
 
 enum { kLEDOff = 0x00, kLEDGreen = 0x01, kLEDRed = 0x02 };
@@ -39,7 +40,9 @@ class EmHAL {
     constexpr static Slot MAX_SLOT = Slot::memorystick;
 
    public:
-    typedef void (*CycleHandler)(void*, uint64, bool);
+    // Cycle consumers are called with the current system cycle count and return the
+    // cycle count at which they need to be called again.
+    typedef uint64 (*CycleHandler)(void*, uint64, bool);
 
    public:
     static void AddHandler(EmHALHandler*);
@@ -92,7 +95,11 @@ class EmHAL {
 
     static void AddCycleConsumer(CycleHandler handler, void* context);
     static void RemoveCycleConsumer(CycleHandler handler, void* context);
+    static inline void Cycle(uint64 cycles, bool sleeping);
     static void DispatchCycle(uint64 cycles, bool sleeping);
+    static void SyncCycles();
+    static uint64 GetCurrentCycles();
+    static inline void InvalidateCycleDeadline();
 
     static bool SupportsImageInSlot(Slot slot, uint32 blocksTotal);
     static bool SupportsImageInSlot(Slot slot, const CardImage& cardImage);
@@ -102,9 +109,9 @@ class EmHAL {
 
     static void SetUARTSync(bool sync);
 
-    static EmEvent<> onSystemClockChange;
-    static EmEvent<double, double> onPwmChange;
-    static EmEvent<> onDayRollover;
+    static thread_local EmEvent<> onSystemClockChange;
+    static thread_local EmEvent<double, double> onPwmChange;
+    static thread_local EmEvent<> onDayRollover;
 
    private:
     struct CycleConsumer {
@@ -114,9 +121,13 @@ class EmHAL {
 
    private:
     static EmHALHandler* GetRootHandler(void) { return fgRootHandler; }
-    static EmHALHandler* fgRootHandler;
+    static EM_THREAD_LOCAL EmHALHandler* fgRootHandler;
 
-    static vector<CycleConsumer> cycleConsumers;
+    static thread_local vector<CycleConsumer> cycleConsumers;
+    static EM_THREAD_LOCAL uint64 nextCycleDeadline;
+    static EM_THREAD_LOCAL uint64 lastDispatchedCycles;
+
+    static const EmSessionState sessionState;
 };
 
 class EmHALHandler {
@@ -180,4 +191,26 @@ class EmHALHandler {
     friend class EmHAL;
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// IMPLEMENTATION
+///////////////////////////////////////////////////////////////////////////////
+
+// ---------------------------------------------------------------------------
+//		� EmHAL::Cycle
+// ---------------------------------------------------------------------------
+// Called by the CPU loop after each instruction. The consumers are only
+// dispatched once the earliest of their deadlines has passed.
+
+inline void EmHAL::Cycle(uint64 cycles, bool sleeping) {
+    if (unlikely(cycles >= nextCycleDeadline)) DispatchCycle(cycles, sleeping);
+}
+
+// ---------------------------------------------------------------------------
+//		� EmHAL::InvalidateCycleDeadline
+// ---------------------------------------------------------------------------
+// Forces a dispatch after the current instruction. Consumers call this if
+// their deadline changes outside of a dispatch.
+
+inline void EmHAL::InvalidateCycleDeadline() { nextCycleDeadline = 0; }
+
 #endif /* EmHAL_h */
@@ -13,7 +13,10 @@
 
 #include "EmMemory.h"
 
+#include <algorithm>
 #include <array>
+#include <unordered_map>
+#include <vector>
 
 #include "EmBankDRAM.h"    // EmBankDRAM::Initialize
 #include "EmBankDummy.h"   // EmBankDummy::Initialize
@@ -21,9 +24,12 @@
 #include "EmBankROM.h"     // EmBankROM::Initialize
 #include "EmBankRegs.h"    // EmBankRegs::Initialize
 #include "EmBankSRAM.h"    // EmBankSRAM::Initialize
+#include "EmBlockCache.h"  // EmBlockCache::Initialize
 #include "EmCommon.h"
 #include "EmDevice.h"
+#include "DebuggerMemoryBinding.h"
 #include "EmSession.h"  // gSession, GetDevice
+#include "EmSessionContext.h"
 #include "MemoryRegion.h"
 #include "MetaMemory.h"  // MetaMemory::Initialize
 #include "Savestate.h"
@@ -187,10 +193,11 @@
 
 #pragma mark Globals
 
-EmAddressBank* gEmMemBanks[65536];  // (normally defined in memory.c)
+EM_THREAD_LOCAL EmAddressBank** gEmMemBanks;  // (normally defined in memory.c)
+EM_THREAD_LOCAL uint8** gEmMemDirectBanks;
 
-Bool gPCInRAM;
-Bool gPCInROM;
+EM_THREAD_LOCAL Bool gPCInRAM;
+EM_THREAD_LOCAL Bool gPCInROM;
 
 /*
 uint32 gTotalMemorySize;
@@ -204,7 +211,7 @@ uint8* gFramebufferMemory;
 uint8* gFramebufferDirtyPages;
 */
 
-MemAccessFlags gMemAccessFlags = {
+EM_THREAD_LOCAL MemAccessFlags gMemAccessFlags = {
     MASTER_RUNTIME_VALIDATE_SWITCH, MASTER_RUNTIME_VALIDATE_SWITCH, MASTER_RUNTIME_VALIDATE_SWITCH,
     MASTER_RUNTIME_VALIDATE_SWITCH, MASTER_RUNTIME_VALIDATE_SWITCH, MASTER_RUNTIME_VALIDATE_SWITCH,
     MASTER_RUNTIME_VALIDATE_SWITCH, MASTER_RUNTIME_VALIDATE_SWITCH, MASTER_RUNTIME_VALIDATE_SWITCH,
@@ -248,12 +255,51 @@ MemAccessFlags gMemAccessFlags = {
 MemAccessFlags kZeroMemAccessFlags;
 
 namespace {
-    unique_ptr<uint8[]> memory;
-    unique_ptr<uint8[]> dirtyPages;
-    MemoryRegionMap regionMap;
-
-    array<uint8*, N_MEMORY_REGIONS> memoryRegionPointers;
-    array<uint8*, N_MEMORY_REGIONS> dirtyPageRegionPointers;
+    thread_local unique_ptr<uint8[]> memory;
+    thread_local unique_ptr<uint8[]> dirtyPages;
+    thread_local unique_ptr<uint8[]> collectedDirtyPages;
+    EM_THREAD_LOCAL uint32 dirtyPagesSize{0};
+    thread_local vector<uint8*> dirtyPageSinks;
+    thread_local MemoryRegionMap regionMap;
+
+    // Backing store for gEmMemBanks and gEmMemDirectBanks. The tables take
+    // 1MB, so they are allocated only on threads that run a session instead
+    // of being reserved in the static TLS block of every thread.
+    constexpr size_t N_BANKS = 65536;
+
+    thread_local unique_ptr<EmAddressBank*[]> banks;
+    thread_local unique_ptr<uint8*[]> directBanks;
+
+    // Instrumentation (see Memory::SetInstrumented). The copies are keyed by
+    // the bank they wrap; the direct table stays zero.
+    EM_THREAD_LOCAL bool instrumented{false};
+
+    thread_local unique_ptr<EmAddressBank*[]> instrumentedBanks;
+    thread_local unique_ptr<uint8*[]> instrumentedDirectBanks;
+    thread_local unordered_map<const EmAddressBank*, EmAddressBank> instrumentedBankCopies;
+
+    EM_THREAD_LOCAL array<uint8*, N_MEMORY_REGIONS> memoryRegionPointers;
+    EM_THREAD_LOCAL array<uint8*, N_MEMORY_REGIONS> dirtyPageRegionPointers;
+
+    const EmSessionState sessionState{EM_SESSION_VARIABLE(gEmMemBanks),
+                                      EM_SESSION_VARIABLE(gEmMemDirectBanks),
+                                      EM_SESSION_VARIABLE(gPCInRAM),
+                                      EM_SESSION_VARIABLE(gPCInROM),
+                                      EM_SESSION_VARIABLE(gMemAccessFlags),
+                                      EM_SESSION_VARIABLE(memory),
+                                      EM_SESSION_VARIABLE(dirtyPages),
+                                      EM_SESSION_VARIABLE(collectedDirtyPages),
+                                      EM_SESSION_VARIABLE(dirtyPagesSize),
+                                      EM_SESSION_VARIABLE(dirtyPageSinks),
+                                      EM_SESSION_VARIABLE(regionMap),
+                                      EM_SESSION_VARIABLE(banks),
+                                      EM_SESSION_VARIABLE(directBanks),
+                                      EM_SESSION_VARIABLE(instrumented),
+                                      EM_SESSION_VARIABLE(instrumentedBanks),
+                                      EM_SESSION_VARIABLE(instrumentedDirectBanks),
+                                      EM_SESSION_VARIABLE(instrumentedBankCopies),
+                                      EM_SESSION_VARIABLE(memoryRegionPointers),
+                                      EM_SESSION_VARIABLE(dirtyPageRegionPointers)};
 
     constexpr MemoryRegion ORDERED_REGIONS[N_MEMORY_REGIONS] = {
         MemoryRegion::ram,     MemoryRegion::framebuffer, MemoryRegion::memorystick,
@@ -262,6 +308,43 @@ namespace {
     uint32 get32(uint8* address) {
         return address[0] | (address[1] << 8) | (address[2] << 16) | (address[3] << 24);
     }
+
+    template <EmMemGetFunc EmAddressBank::*get, void (*notify)(emuptr)>
+    uint32 InstrumentedGet(emuptr address) {
+        notify(address);
+
+        return (banks[EmMemBankIndex(address)]->*get)(address);
+    }
+
+    template <EmMemPutFunc EmAddressBank::*put, void (*notify)(emuptr)>
+    void InstrumentedPut(emuptr address, uint32 value) {
+        notify(address);
+
+        (banks[EmMemBankIndex(address)]->*put)(address, value);
+    }
+
+    EmAddressBank* InstrumentedBank(EmAddressBank* bank) {
+        if (!bank) return nullptr;
+
+        auto it = instrumentedBankCopies.find(bank);
+        if (it != instrumentedBankCopies.end()) return &it->second;
+
+        EmAddressBank copy = *bank;
+
+        copy.lget = InstrumentedGet<&EmAddressBank::lget, DbgNotifyRead32>;
+        copy.wget = InstrumentedGet<&EmAddressBank::wget, DbgNotifyRead16>;
+        copy.bget = InstrumentedGet<&EmAddressBank::bget, DbgNotifyRead8>;
+        copy.lput = InstrumentedPut<&EmAddressBank::lput, DbgNotifyWrite32>;
+        copy.wput = InstrumentedPut<&EmAddressBank::wput, DbgNotifyWrite16>;
+        copy.bput = InstrumentedPut<&EmAddressBank::bput, DbgNotifyWrite8>;
+
+        return &instrumentedBankCopies.emplace(bank, copy).first->second;
+    }
+
+    void BindBankTables() {
+        gEmMemBanks = instrumented ? instrumentedBanks.get() : banks.get();
+        gEmMemDirectBanks = instrumented ? instrumentedDirectBanks.get() : directBanks.get();
+    }
 }  // namespace
 
 // ===========================================================================
@@ -279,11 +362,13 @@ bool Memory::Initialize(const uint8* romBuffer, size_t romSize, EmDevice& device
 
     regionMap = device.GetMemoryRegionMap();
 
-    const uint32 dirtyPagesSize =
+    dirtyPagesSize =
         regionMap.GetTotalSize() / 8192 + (regionMap.GetTotalSize() % 8192 == 0 ? 0 : 1);
 
     memory = make_unique<uint8[]>(regionMap.GetTotalSize());
     dirtyPages = make_unique<uint8[]>(dirtyPagesSize);
+    collectedDirtyPages = make_unique<uint8[]>(dirtyPagesSize);
+    dirtyPageSinks.clear();
 
     uint8* regionPtr = memory.get();
     uint8* dirtyPagePtr = dirtyPages.get();
@@ -309,11 +394,21 @@ bool Memory::Initialize(const uint8* romBuffer, size_t romSize, EmDevice& device
     *toc = 0xffffffff;
 
     memset(dirtyPages.get(), 0, dirtyPagesSize);
+    memset(collectedDirtyPages.get(), 0, dirtyPagesSize);
     dirtyPages[dirtyPagesSize - 1] = 0x01;
 
     // Clear everything out.
 
-    memset(gEmMemBanks, 0, sizeof(gEmMemBanks));
+    if (!banks) banks = make_unique<EmAddressBank*[]>(N_BANKS);
+    if (!directBanks) directBanks = make_unique<uint8*[]>(N_BANKS);
+
+    memset(banks.get(), 0, N_BANKS * sizeof(*banks.get()));
+    memset(directBanks.get(), 0, N_BANKS * sizeof(*directBanks.get()));
+
+    instrumentedBankCopies.clear();
+    if (instrumented) memset(instrumentedBanks.get(), 0, N_BANKS * sizeof(*instrumentedBanks.get()));
+
+    BindBankTables();
 
     // Initialize the valid memory banks.
 
@@ -342,6 +437,8 @@ bool Memory::Initialize(const uint8* romBuffer, size_t romSize, EmDevice& device
     EmAssert(gSession);
     if (gSession->GetDevice().HasFlash()) EmBankFlash::Initialize();
 
+    EmBlockCache::Initialize();
+
     return success;
 }
 
@@ -411,6 +508,9 @@ void Memory::Dispose(void) {
     EmBankDRAM::Dispose();
     EmBankROM::Dispose();
     EmBankMapped::Dispose();
+    EmBlockCache::Dispose();
+
+    dirtyPageSinks.clear();
 
     // We can't reliably call GetDevice here.  That's because the
     // session may not have been initialized (we could be disposing
@@ -429,12 +529,24 @@ void Memory::Dispose(void) {
 //		� Memory::InitializeBanks
 // ---------------------------------------------------------------------------
 // Initializes the specified memory banks with the given data.
+//
+// Banks that can be read without side effects may pass the host memory that
+// backs them together with an address mask; reads from these banks are then
+// done inline by EmMemGet* instead of calling through the bank handlers.
 
 void Memory::InitializeBanks(EmAddressBank& iBankInitializer, int32 iStartingBankIndex,
-                             int32 iNumberOfBanks) {
+                             int32 iNumberOfBanks, uint8* iDirectBase, uint32 iDirectMask) {
+    // The direct path addresses a full bank without masking.
+    if (iDirectMask < 0xffff) iDirectBase = nullptr;
+
     for (int32 aBankIndex = iStartingBankIndex; aBankIndex < iStartingBankIndex + iNumberOfBanks;
          aBankIndex++) {
-        gEmMemBanks[aBankIndex] = &iBankInitializer;
+        banks[aBankIndex] = &iBankInitializer;
+        directBanks[aBankIndex] =
+            iDirectBase ? iDirectBase + ((static_cast<uint32>(aBankIndex) << 16) & iDirectMask)
+                        : nullptr;
+
+        if (instrumented) instrumentedBanks[aBankIndex] = InstrumentedBank(&iBankInitializer);
     }
 }
 
@@ -464,6 +576,37 @@ void Memory::ResetBankHandlers(void) {
 
     EmAssert(gSession);
     if (gSession->GetDevice().HasFlash()) EmBankFlash::SetBankHandlers();
+
+    EmBlockCache::Flush();
+}
+
+// ---------------------------------------------------------------------------
+//		� Memory::SetInstrumented
+// ---------------------------------------------------------------------------
+// Switches between the plain and the instrumented bank tables. The accessors
+// are the same in both modes, so a session without watchpoints pays nothing
+// for the debugger.
+
+void Memory::SetInstrumented(bool enable) {
+    if (enable == instrumented) return;
+    instrumented = enable;
+
+    if (instrumented) {
+        if (!instrumentedBanks) instrumentedBanks = make_unique<EmAddressBank*[]>(N_BANKS);
+        if (!instrumentedDirectBanks) instrumentedDirectBanks = make_unique<uint8*[]>(N_BANKS);
+
+        if (banks) {
+            for (size_t i = 0; i < N_BANKS; i++) instrumentedBanks[i] = InstrumentedBank(banks[i]);
+        }
+    }
+
+    if (banks) BindBankTables();
+}
+
+bool Memory::IsInstrumented() { return instrumented; }
+
+const EmAddressBank& Memory::GetHandlerBank(emuptr address) {
+    return *banks[EmMemBankIndex(address)];
 }
 
 // ---------------------------------------------------------------------------
@@ -512,12 +655,41 @@ uint32 Memory::GetTotalMemorySize() { return regionMap.GetTotalSize(); }
 
 uint8* Memory::GetTotalMemory() { return memory.get(); }
 
-uint8* Memory::GetTotalDirtyPages() { return dirtyPages.get(); }
+uint8* Memory::GetTotalDirtyPages() {
+    CollectDirtyPages();
+
+    return collectedDirtyPages.get();
+}
+
+uint32 Memory::GetTotalDirtyPagesSize() { return dirtyPagesSize; }
+
+void Memory::CollectDirtyPages() {
+    for (uint32 i = 0; i < dirtyPagesSize; i++) {
+        const uint8 pages = dirtyPages[i];
+        if (pages == 0) continue;
+
+        collectedDirtyPages[i] |= pages;
+        for (uint8* sink : dirtyPageSinks) sink[i] |= pages;
+
+        dirtyPages[i] = 0;
+    }
+}
+
+uint8* Memory::GetBankDirtyPages() { return dirtyPages.get(); }
+
+void Memory::AddDirtyPageSink(uint8* sink) { dirtyPageSinks.push_back(sink); }
+
+void Memory::RemoveDirtyPageSink(uint8* sink) {
+    dirtyPageSinks.erase(remove(dirtyPageSinks.begin(), dirtyPageSinks.end(), sink),
+                         dirtyPageSinks.end());
+}
 
 bool Memory::LoadMemoryV1(void* ram, size_t size) {
     if (size != regionMap.GetRegionSize(MemoryRegion::ram)) return false;
 
     memcpy(memoryRegionPointers[static_cast<uint8>(MemoryRegion::ram)], ram, size);
+    EmBlockCache::Flush();
+
     return true;
 }
 
@@ -530,6 +702,8 @@ bool Memory::LoadMemoryV2(void* memory, size_t size) {
     memcpy(memoryRegionPointers[static_cast<uint8>(MemoryRegion::ram)], memory, ramSize);
     memcpy(memoryRegionPointers[static_cast<uint8>(MemoryRegion::framebuffer)],
            reinterpret_cast<uint8*>(memory) + ramSize, framebufferSize);
+    EmBlockCache::Flush();
+
     return true;
 }
 
@@ -576,6 +750,8 @@ bool Memory::LoadMemoryV4(void* memory, size_t size) {
         offset += regionSize;
     }
 
+    EmBlockCache::Flush();
+
     return true;
 }
 
@@ -585,7 +761,9 @@ bool Memory::LoadMemoryV4(void* memory, size_t size) {
 //		� CEnableFullAccess
 // ===========================================================================
 
-long CEnableFullAccess::fgAccessCount = 0;
+EM_THREAD_LOCAL long CEnableFullAccess::fgAccessCount = 0;
+
+const EmSessionState CEnableFullAccess::sessionState{EM_SESSION_VARIABLE(fgAccessCount)};
 
 // ---------------------------------------------------------------------------
 //		� CEnableFullAccess::CEnableFullAccess
@@ -690,8 +868,8 @@ emuptr EmMem_memset(emuptr dst, int val, size_t len) {
     longVal |= (longVal << 8);
     longVal |= (longVal << 16);
 
-    EmMemPutFunc longPutter = EmMemGetBank(dst).lput;
-    EmMemPutFunc bytePutter = EmMemGetBank(dst).bput;
+    EmMemPutFunc longPutter = Memory::GetHandlerBank(dst).lput;
+    EmMemPutFunc bytePutter = Memory::GetHandlerBank(dst).bput;
 
     while ((q & 3) && len > 0)  // while there are leading bytes
     {
@@ -19,7 +19,6 @@
 // which doesn't pull in EmCommon.h.  So I have to explicitly
 // make sure they're included.
 
-#include "DebuggerMemoryBinding.h"
 #include "EmAssert.h"   // EmAssert
 #include "EmTypes.h"    // uint32, etc.
 #include "Switches.h"   // WORDSWAP_MEMORY, UNALIGNED_LONG_ACCESS
@@ -63,7 +62,15 @@ typedef struct EmAddressBank {
 
 #ifndef ECM_DYNAMIC_PATCH
 
-extern EmAddressBank* gEmMemBanks[65536];
+// The bank tables hold one entry per 64k bank. They are allocated on the heap
+// by Memory::Initialize; only the pointers live in TLS.
+
+extern EM_THREAD_LOCAL EmAddressBank** gEmMemBanks;
+
+// Host pointer to the start of each 64k bank for banks that can be read
+// without side effects (ROM and RAM), NULL for all others.
+
+extern EM_THREAD_LOCAL uint8** gEmMemDirectBanks;
 
 #else  // ECM_DYNAMIC_PATCH
 
@@ -83,6 +90,8 @@ extern EmAddressBank** gDynEmMemBanksP;
     #define EmMemGetBank(addr) (*EmMemGetBankPtr(addr))
     #define EmMemPutBank(addr, b) (gEmMemBanks[EmMemBankIndex(addr)] = (b))
 
+    #define EmMemGetDirectBase(addr) (gEmMemDirectBanks[EmMemBankIndex(addr)])
+
 #else  // ECM_DYNAMIC_PATCH
 
     #define EmMemBankIndex(addr) (((unsigned long)(addr)) >> 16)
@@ -90,19 +99,29 @@ extern EmAddressBank** gDynEmMemBanksP;
     #define EmMemGetBank(addr) (*((gDynEmMemBanksP)[EmMemBankIndex(addr)]))
     #define EmMemPutBank(addr, b) ((gDynEmMemBanksP)[EmMemBankIndex(addr)] = (b))
 
+    #define EmMemGetDirectBase(addr) ((uint8*)NULL)
+
 #endif  // ECM_DYNAMIC_PATCH
 
 #define EmMemCallGetFunc(func, addr) ((*EmMemGetBank(addr).func)(addr))
 #define EmMemCallPutFunc(func, addr, v) ((*EmMemGetBank(addr).func)(addr, v))
 
+STATIC_INLINE uint32 EmMemDoGet32(void* a);
+STATIC_INLINE uint16 EmMemDoGet16(void* a);
+STATIC_INLINE uint8 EmMemDoGet8(void* a);
+
 // ---------------------------------------------------------------------------
 //		� EmMemGet32
 // ---------------------------------------------------------------------------
+// Reads from banks that have a direct host base are done inline. Odd
+// addresses (address errors) and longs that straddle two banks still go
+// through the bank handlers.
 
 STATIC_INLINE uint32 EmMemGet32(emuptr addr) {
-#ifdef ENABLE_DEBUGGER
-    DbgNotifyRead32(addr);
-#endif
+    uint8* directBase = EmMemGetDirectBase(addr);
+
+    if (directBase && (addr & 1) == 0 && (addr & 0xffff) != 0xfffe)
+        return EmMemDoGet32(directBase + (addr & 0xffff));
 
     return EmMemCallGetFunc(lget, addr);
 }
@@ -112,9 +131,9 @@ STATIC_INLINE uint32 EmMemGet32(emuptr addr) {
 // ---------------------------------------------------------------------------
 
 STATIC_INLINE uint16 EmMemGet16(emuptr addr) {
-#ifdef ENABLE_DEBUGGER
-    DbgNotifyRead16(addr);
-#endif
+    uint8* directBase = EmMemGetDirectBase(addr);
+
+    if (directBase && (addr & 1) == 0) return EmMemDoGet16(directBase + (addr & 0xffff));
 
     return EmMemCallGetFunc(wget, addr);
 }
@@ -124,9 +143,9 @@ STATIC_INLINE uint16 EmMemGet16(emuptr addr) {
 // ---------------------------------------------------------------------------
 
 STATIC_INLINE uint8 EmMemGet8(emuptr addr) {
-#ifdef ENABLE_DEBUGGER
-    DbgNotifyRead8(addr);
-#endif
+    uint8* directBase = EmMemGetDirectBase(addr);
+
+    if (directBase) return EmMemDoGet8(directBase + (addr & 0xffff));
 
     return EmMemCallGetFunc(bget, addr);
 }
@@ -136,10 +155,6 @@ STATIC_INLINE uint8 EmMemGet8(emuptr addr) {
 // ---------------------------------------------------------------------------
 
 STATIC_INLINE void EmMemPut32(emuptr addr, uint32 l) {
-#ifdef ENABLE_DEBUGGER
-    DbgNotifyWrite32(addr);
-#endif
-
     EmMemCallPutFunc(lput, addr, l);
 }
 
@@ -148,10 +163,6 @@ STATIC_INLINE void EmMemPut32(emuptr addr, uint32 l) {
 // ---------------------------------------------------------------------------
 
 STATIC_INLINE void EmMemPut16(emuptr addr, uint16 w) {
-#ifdef ENABLE_DEBUGGER
-    DbgNotifyWrite16(addr);
-#endif
-
     EmMemCallPutFunc(wput, addr, w);
 }
 
@@ -160,10 +171,6 @@ STATIC_INLINE void EmMemPut16(emuptr addr, uint16 w) {
 // ---------------------------------------------------------------------------
 
 STATIC_INLINE void EmMemPut8(emuptr addr, uint8 b) {
-#ifdef ENABLE_DEBUGGER
-    DbgNotifyWrite8(addr);
-#endif
-
     EmMemCallPutFunc(bput, addr, b);
 }
 
@@ -324,9 +331,9 @@ struct MemAccessFlags {
 
 // Globals.
 
-extern MemAccessFlags gMemAccessFlags;
-extern Bool gPCInRAM;
-extern Bool gPCInROM;
+extern EM_THREAD_LOCAL MemAccessFlags gMemAccessFlags;
+extern EM_THREAD_LOCAL Bool gPCInRAM;
+extern EM_THREAD_LOCAL Bool gPCInROM;
 
 struct EmAddressBank;
 class SavestateLoader;
@@ -334,6 +341,7 @@ class SavestateLoader;
 // Function prototypes.
 
 class EmDevice;
+class EmSessionState;
 
 class Memory {
    public:
@@ -347,10 +355,20 @@ class Memory {
     static void Dispose(void);
 
     static void InitializeBanks(EmAddressBank& iBankInitializer, int32 iStartingBankIndex,
-                                int32 iNumberOfBanks);
+                                int32 iNumberOfBanks, uint8* iDirectBase = nullptr,
+                                uint32 iDirectMask = 0);
 
     static void ResetBankHandlers(void);
 
+    // While instrumented, gEmMemBanks points to copies of the banks whose
+    // accessors notify the debugger before they call the actual handlers, and
+    // gEmMemDirectBanks points to a table without direct bases, so that no
+    // access bypasses the notifications. The accessors above are the same in
+    // both modes. GetHandlerBank returns the actual bank in either mode.
+    static void SetInstrumented(bool enable);
+    static bool IsInstrumented();
+    static const EmAddressBank& GetHandlerBank(emuptr address);
+
     static void MapPhysicalMemory(const void*, uint32);
     static void UnmapPhysicalMemory(const void*);
     static void GetMappingInfo(emuptr, void**, uint32*);
@@ -366,6 +384,17 @@ class Memory {
     static uint32 GetTotalMemorySize();
     static uint8* GetTotalMemory();
     static uint8* GetTotalDirtyPages();
+    static uint32 GetTotalDirtyPagesSize();
+
+    // The banks mark writes in a private bitmap. CollectDirtyPages merges it
+    // into the bitmap returned by GetTotalDirtyPages and into all registered
+    // sinks (of GetTotalDirtyPagesSize bytes) and then clears it, so several
+    // consumers can track and clear dirty pages independently. Code that
+    // modifies memory behind the banks' back marks GetBankDirtyPages.
+    static void CollectDirtyPages();
+    static uint8* GetBankDirtyPages();
+    static void AddDirtyPageSink(uint8* sink);
+    static void RemoveDirtyPageSink(uint8* sink);
 
     static bool LoadMemoryV1(void* ram, size_t size);
     static bool LoadMemoryV2(void* memory, size_t size);
@@ -395,7 +424,9 @@ class CEnableFullAccess {
    private:
     MemAccessFlags fOldMemAccessFlags;
 
-    static long fgAccessCount;
+    static EM_THREAD_LOCAL long fgAccessCount;
+
+    static const EmSessionState sessionState;
 };
 
 // Std C Library-ish routines for manipulating data
@@ -49,7 +49,7 @@ uint8 EMPalmVZWithSD<XZ>::GetPortInternalValue(int port) {
     uint32 result = XZ::GetPortInternalValue(port);
 
     if (port == 'D') {
-        if (!gExternalStorage.IsMounted(EmHAL::Slot::sdcard))
+        if (!gExternalStorage->IsMounted(EmHAL::Slot::sdcard))
             result |= 0x20;
         else
             result &= ~0x20;
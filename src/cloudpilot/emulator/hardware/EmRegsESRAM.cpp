@@ -2,13 +2,16 @@
 
 #include "EmCommon.h"
 #include "EmMemory.h"
+#include "EmSessionContext.h"
 #include "EmSystemState.h"
 
 namespace {
     constexpr uint32 esramSize = 1024 * 100;
 
-    uint8* esram;
-    uint8* dirtyPages;
+    EM_THREAD_LOCAL uint8* esram;
+    EM_THREAD_LOCAL uint8* dirtyPages;
+
+    const EmSessionState sessionState{EM_SESSION_VARIABLE(esram), EM_SESSION_VARIABLE(dirtyPages)};
 
     inline void markDirty(emuptr offset) {
         dirtyPages[offset >> 13] |= (1 << ((offset >> 10) & 0x07));
@@ -74,7 +77,7 @@ void EmRegsESRAM::SetLong(emuptr address, uint32 value) {
     uint32 offset = address - baseAddr;
     EmMemDoPut32(esram + offset, value);
 
-    if (isFramebuffer) gSystemState.MarkScreenDirty(address, address + 4);
+    if (isFramebuffer) gSystemState->MarkScreenDirty(address, address + 4);
 
     markDirty(offset);
     markDirty(offset + 2);
@@ -84,7 +87,7 @@ void EmRegsESRAM::SetWord(emuptr address, uint32 value) {
     uint32 offset = address - baseAddr;
     EmMemDoPut16(esram + offset, value);
 
-    if (isFramebuffer) gSystemState.MarkScreenDirty(address, address + 2);
+    if (isFramebuffer) gSystemState->MarkScreenDirty(address, address + 2);
 
     markDirty(offset);
 }
@@ -93,7 +96,7 @@ void EmRegsESRAM::SetByte(emuptr address, uint32 value) {
     uint32 offset = address - baseAddr;
     EmMemDoPut8(esram + offset, value);
 
-    if (isFramebuffer) gSystemState.MarkScreenDirty(address, address);
+    if (isFramebuffer) gSystemState->MarkScreenDirty(address, address);
 
     markDirty(offset);
 }
@@ -25,6 +25,7 @@
 #include "EmSession.h"   // GetDevice
 #include "EmSystemState.h"
 #include "Frame.h"
+#include "InterruptTracer.h"
 #include "Logging.h"  // LogAppendMsg
 #include "MetaMemory.h"
 #include "Platform.h"
@@ -64,6 +65,13 @@
 namespace {
     constexpr uint32 SAVESTATE_VERSION = 4;
 
+    // Interrupt sources by their bit in the status register (hi << 16 | lo).
+    const char* const INTERRUPT_SOURCES[InterruptTracer::SOURCE_COUNT] = {
+        "SPIM", "Timer", "UART", "WDT", "RTC", nullptr, "Kbd", "PWM", "Int0", "Int1", "Int2",
+        "Int3", nullptr, nullptr, nullptr, nullptr, "IRQ1", "IRQ2", "IRQ3", "IRQ6", "Pen", nullptr,
+        "SampleTimer", "EMU", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+        nullptr};
+
     constexpr uint16 UPSIZ = 0x1800;  // Mask to get the unprotected memory size from csDSelect.
     constexpr uint16 SIZ = 0x000E;    // Mask to get the memory size from csASelect.
     constexpr uint16 EN = 0x0001;     // Mask to get the enable bit from csASelect.
@@ -74,8 +82,8 @@ namespace {
     constexpr long hwrEZ328LcdPageSize = 0x00020000;  // 128K
     constexpr long hwrEZ328LcdPageMask = 0xFFFE0000;
 
-    void cycleThunk(void* context, uint64 cycles, bool sleeping) {
-        ((EmRegsEZ*)context)->Cycle(cycles, sleeping);
+    uint64 cycleThunk(void* context, uint64 cycles, bool sleeping) {
+        return ((EmRegsEZ*)context)->Cycle(cycles, sleeping);
     }
 
     // Values used to initialize the DragonBallEZ registers.
@@ -462,7 +470,8 @@ void EmRegsEZ::Initialize(void) {
 
     fUART = new EmUARTDragonball(EmUARTDragonball::kUART_DragonballEZ, 0);
 
-    onMarkScreenCleanHandle = gSystemState.onMarkScreenClean.AddHandler([this]() { MarkScreen(); });
+    onMarkScreenCleanHandle =
+        gSystemState->onMarkScreenClean.AddHandler([this]() { MarkScreen(); });
     onDayRolloverHandle = EmHAL::onDayRollover.AddHandler([this]() { HandleDayRollover(); });
 
     EmHAL::AddCycleConsumer(cycleThunk, this);
@@ -605,7 +614,7 @@ void EmRegsEZ::Dispose(void) {
 
     EmRegs::Dispose();
 
-    gSystemState.onMarkScreenClean.RemoveHandler(onMarkScreenCleanHandle);
+    gSystemState->onMarkScreenClean.RemoveHandler(onMarkScreenCleanHandle);
     EmHAL::onDayRollover.RemoveHandler(onDayRolloverHandle);
     EmHAL::RemoveCycleConsumer(cycleThunk, this);
 }
@@ -783,17 +792,21 @@ uint32 EmRegsEZ::GetAddressRange(void) { return kMemorySize; }
 // updating timer registers).  This function is called in two places from
 // Emulator::Execute.  Interestingly, the loop runs 3% FASTER if this function
 // is in its own separate function instead of being inline.
+//
+// Returns the cycle count at which the next timer event is due.
 
-void EmRegsEZ::Cycle(uint64 systemCycles, Bool sleeping) {
+uint64 EmRegsEZ::Cycle(uint64 systemCycles, Bool sleeping) {
     if (unlikely(afterLoad)) {
         DispatchPwmChange();
         afterLoad = false;
     }
 
-    if (unlikely(powerOffCached)) return;
+    if (unlikely(powerOffCached)) return ~0ull;
 
     this->systemCycles = systemCycles;
     if (unlikely(systemCycles >= nextTimerEventAfterCycle)) UpdateTimer();
+
+    return nextTimerEventAfterCycle;
 }
 
 void EmRegsEZ::SetUARTSync(bool sync) {
@@ -948,15 +961,14 @@ bool EmRegsEZ::CopyLCDFrame(Frame& frame, bool fullRefresh) {
     frame.lines = READ_REGISTER(lcdScreenHeight) + 1;
     frame.bytesPerLine = READ_REGISTER(lcdPageWidth) * 2;
     frame.margin = READ_REGISTER(lcdPanningOffset);
-    frame.firstDirtyLine = 0;
-    frame.lastDirtyLine = frame.lines - 1;
+    frame.ResetDirtyRegion();
     frame.scaleX = frame.scaleY = 1;
     frame.hasChanges = true;
 
     emuptr baseAddr = READ_REGISTER(lcdStartAddr);
     if (baseAddr == 0) return false;
 
-    if (!gSystemState.IsScreenDirty() && !fullRefresh) {
+    if (!gSystemState->IsScreenDirty() && !fullRefresh) {
         frame.hasChanges = false;
         return true;
     }
@@ -989,7 +1001,7 @@ bool EmRegsEZ::CopyLCDFrame(Frame& frame, bool fullRefresh) {
     emuptr boundaryAddr = ((baseAddr & hwrEZ328LcdPageMask) + hwrEZ328LcdPageSize);
 
     if (lastLineAddr <= boundaryAddr) {
-        frame.UpdateDirtyLines(gSystemState, baseAddr, frame.bytesPerLine, fullRefresh);
+        frame.UpdateDirtyLines(*gSystemState, baseAddr, frame.bytesPerLine, fullRefresh);
         if (!frame.hasChanges) return true;
 
         firstLineAddr = baseAddr + frame.firstDirtyLine * frame.bytesPerLine;
@@ -1036,7 +1048,7 @@ void EmRegsEZ::UnmarkScreen() {
     screenMarked = false;
 }
 
-void EmRegsEZ::MarkScreenDirty() { gSystemState.MarkScreenDirty(); }
+void EmRegsEZ::MarkScreenDirty() { gSystemState->MarkScreenDirty(); }
 
 double EmRegsEZ::TimerTicksPerSecond() {
     uint8 clksource = (READ_REGISTER(tmr1Control) >> 1) & 0x7;
@@ -1797,7 +1809,7 @@ void EmRegsEZ::pllRegisterWrite(emuptr address, int size, uint32 value) {
     EmRegsEZ::StdWrite(address, size, value);
 
     UpdateTimer();
-    gSystemState.MarkScreenDirty();
+    gSystemState->MarkScreenDirty();
     EmHAL::onSystemClockChange.Dispatch();
     powerOffCached = GetAsleep();
 }
@@ -2057,6 +2069,12 @@ void EmRegsEZ::UpdateInterrupts(void) {
     f68EZ328Regs.intStatusHi = f68EZ328Regs.intPendingHi & ~f68EZ328Regs.intMaskHi;
     f68EZ328Regs.intStatusLo = f68EZ328Regs.intPendingLo & ~f68EZ328Regs.intMaskLo;
 
+    if (gInterruptTracer->IsRunning())
+        gInterruptTracer->UpdateStatus(
+            EmHAL::GetCurrentCycles(),
+            ((uint32)READ_REGISTER(intStatusHi) << 16) | READ_REGISTER(intStatusLo),
+            INTERRUPT_SOURCES);
+
     PRINTF("EmRegsEZ::UpdateInterrupts: intMask    = 0x%04lX %04lX", (uint32)f68EZ328Regs.intMaskHi,
            (uint32)f68EZ328Regs.intMaskLo);
 
@@ -2549,6 +2567,8 @@ uint32 EmRegsEZ::CyclesToNextInterrupt(uint64 systemCycles) {
 }
 
 void EmRegsEZ::UpdateTimer() {
+    EmHAL::InvalidateCycleDeadline();
+
     nextTimerEventAfterCycle = ~0;
     if (GetAsleep()) return;
 
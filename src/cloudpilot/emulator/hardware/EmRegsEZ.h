@@ -71,7 +71,7 @@ class EmRegsEZ : public EmRegs, public EmHALHandler {
     virtual void GetKeyInfo(int* numRows, int* numCols, uint16* keyMap, Bool* rows) = 0;
 
     virtual uint32 CyclesToNextInterrupt(uint64 systemCycles);
-    void Cycle(uint64 systemCycles, Bool sleeping);
+    uint64 Cycle(uint64 systemCycles, Bool sleeping);
 
     virtual void SetUARTSync(bool sync);
 
@@ -16,6 +16,7 @@
 #include "Byteswapping.h"  // ByteswapWords
 #include "EmCommon.h"
 #include "EmMemory.h"  // EmMemDoGet32
+#include "EmSessionContext.h"
 #include "EmSystemState.h"
 #include "MemoryRegion.h"
 #include "Miscellaneous.h"  // StWordSwapper
@@ -27,9 +28,13 @@
 namespace {
     constexpr int SAVESTATE_VERSION = 1;
 
-    uint32 framebufferSize;
-    uint8* framebuffer;
-    uint8* dirtyPages;
+    EM_THREAD_LOCAL uint32 framebufferSize;
+    EM_THREAD_LOCAL uint8* framebuffer;
+    EM_THREAD_LOCAL uint8* dirtyPages;
+
+    const EmSessionState sessionState{EM_SESSION_VARIABLE(framebufferSize),
+                                      EM_SESSION_VARIABLE(framebuffer),
+                                      EM_SESSION_VARIABLE(dirtyPages)};
 
     inline void markDirty(emuptr offset) {
         dirtyPages[offset >> 13] |= (1 << ((offset >> 10) & 0x07));
@@ -129,7 +134,7 @@ void EmRegsFrameBuffer::SetLong(emuptr address, uint32 value) {
     uint32 offset = address - fBaseAddr;
     EmMemDoPut32((framebuffer) + offset, value);
 
-    gSystemState.MarkScreenDirty(address, address + 4);
+    gSystemState->MarkScreenDirty(address, address + 4);
 
     markDirty(offset);
     markDirty(offset + 2);
@@ -143,7 +148,7 @@ void EmRegsFrameBuffer::SetWord(emuptr address, uint32 value) {
     uint32 offset = address - fBaseAddr;
     EmMemDoPut16((framebuffer) + offset, value);
 
-    gSystemState.MarkScreenDirty(address, address + 2);
+    gSystemState->MarkScreenDirty(address, address + 2);
 
     markDirty(offset);
 }
@@ -156,7 +161,7 @@ void EmRegsFrameBuffer::SetByte(emuptr address, uint32 value) {
     uint32 offset = address - fBaseAddr;
     EmMemDoPut8((framebuffer) + offset, value);
 
-    gSystemState.MarkScreenDirty(address, address);
+    gSystemState->MarkScreenDirty(address, address);
 
     markDirty(offset);
 }
@@ -20,6 +20,7 @@
 #include "EmCommon.h"
 #include "EmRegsFrameBuffer.h"
 #include "EmSession.h"
+#include "EmSessionContext.h"
 #include "EmSystemState.h"
 #include "Frame.h"
 #include "Logging.h"  // LogAppendMsg
@@ -45,7 +46,9 @@
 namespace {
     constexpr uint32 SAVESTATE_VERSION = 1;
 
-    uint16 cscolor = 0;
+    EM_THREAD_LOCAL uint16 cscolor = 0;
+
+    const EmSessionState sessionState{EM_SESSION_VARIABLE(cscolor)};
 
     template <typename T>
     bool IsEven(T t) {
@@ -1905,7 +1908,7 @@ void EmRegsMediaQ11xx::GC0CWrite(emuptr address, int size, uint32 value) {
 
     WRITE_REGISTER(gcREG[0x0c], READ_REGISTER(gcREG[0x0c]) & 0x0003ffff);
 
-    gSystemState.MarkScreenDirty();
+    gSystemState->MarkScreenDirty();
 }
 
 // ---------------------------------------------------------------------------
@@ -1998,13 +2001,13 @@ void EmRegsMediaQ11xx::invalidateWrite(emuptr address, int size, uint32 value) {
     // Invalidate the entire LCD area so that it can get redrawn with
     // the new palette information.
 
-    gSystemState.MarkScreenDirty();
+    gSystemState->MarkScreenDirty();
 }
 
 void EmRegsMediaQ11xx::CPWrite(emuptr address, int size, uint32 value) {
     this->MQWrite(address, size, value);
 
-    gSystemState.MarkScreenDirty();
+    gSystemState->MarkScreenDirty();
     paletteDirty = true;
 }
 
@@ -3428,7 +3431,7 @@ void EmRegsMediaQ11xx::PrvIncBlitterRun(void) {
     if (!fBlitInProgress) return;
 
 #ifdef LOGGING
-    static long counter = 0;
+    static EM_THREAD_LOCAL long counter = 0;
 #endif
 
     PRINTF_BLIT(
@@ -266,7 +266,7 @@ bool EmRegsSED1375::CopyLCDFrame(Frame& frame, bool fullRefresh) {
 
     if (4 * width * height > static_cast<ssize_t>(frame.GetBufferSize())) return false;
 
-    frame.UpdateDirtyLines(gSystemState, baseAddr, rowBytes, fullRefresh);
+    frame.UpdateDirtyLines(*gSystemState, baseAddr, rowBytes, fullRefresh);
     if (!frame.hasChanges) return true;
 
     uint32* buffer =
@@ -328,7 +328,7 @@ uint16 EmRegsSED1375::GetLCD2bitMapping() { return 0xfa50; }
 
 void EmRegsSED1375::invalidateWrite(emuptr address, int size, uint32 value) {
     this->StdWriteBE(address, size, value);
-    gSystemState.MarkScreenDirty();
+    gSystemState->MarkScreenDirty();
 }
 
 // ---------------------------------------------------------------------------
@@ -415,7 +415,7 @@ void EmRegsSED1375::lookUpTableDataWrite(emuptr address, int size, uint32 value)
             break;
     }
 
-    gSystemState.MarkScreenDirty();
+    gSystemState->MarkScreenDirty();
 }
 
 void EmRegsSED1375::ClearLut() {
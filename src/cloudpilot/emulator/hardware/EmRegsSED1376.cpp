@@ -314,7 +314,7 @@ Bool EmRegsSED1376::GetLCDHasFrame(void) { return true; }
 
 void EmRegsSED1376::invalidateWrite(emuptr address, int size, uint32 value) {
     this->StdWriteBE(address, size, value);
-    gSystemState.MarkScreenDirty();
+    gSystemState->MarkScreenDirty();
 }
 
 // ---------------------------------------------------------------------------
@@ -349,7 +349,7 @@ void EmRegsSED1376::lutWriteAddressWrite(emuptr address, int size, uint32 value)
     fClutData[value] = 0xff000000 | (((blue & 0xFC) | (blue >> 6)) << 16) |
                        (((green & 0xFC) | (green >> 6)) << 8) | ((red & 0xFC) | (red >> 6));
 
-    gSystemState.MarkScreenDirty();
+    gSystemState->MarkScreenDirty();
     lutDirty = true;
 }
 
@@ -636,61 +636,78 @@ bool EmRegsSED1376PalmGeneric::CopyLCDFrame(Frame& frame, bool fullRefresh) {
 
     if (4 * width * height > static_cast<ssize_t>(frame.GetBufferSize())) return false;
 
-    frame.UpdateDirtyLines(gSystemState, baseAddr, rowBytes, fullRefresh);
+    frame.UpdateDirtyLines(*gSystemState, baseAddr, rowBytes, fullRefresh);
     if (!frame.hasChanges) return true;
 
-    uint32* buffer =
-        reinterpret_cast<uint32*>(frame.GetBuffer() + frame.firstDirtyLine * frame.bytesPerLine);
+    frame.UpdateDirtyColumns(bpp);
+
+    const uint32 firstColumn = frame.firstDirtyColumn;
+    const uint32 lastColumn = frame.lastDirtyColumn;
+
+    uint32* frameBuffer = reinterpret_cast<uint32*>(frame.GetBuffer());
     const uint32* lut = GetLUT(mono);
 
     switch (bpp) {
         case 1: {
             Nibbler<1, true> nibbler;
-            nibbler.reset(framebuffer.GetRealAddress(baseAddr + frame.firstDirtyLine * rowBytes),
-                          0);
 
-            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++)
-                for (int32 x = 0; x < width; x++) *(buffer++) = lut[nibbler.nibble()];
+            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
+                nibbler.reset(framebuffer.GetRealAddress(baseAddr + y * rowBytes), firstColumn);
+                uint32* buffer = frameBuffer + y * width + firstColumn;
+
+                for (uint32 x = firstColumn; x <= lastColumn; x++)
+                    *(buffer++) = lut[nibbler.nibble()];
+            }
 
             break;
         }
 
         case 2: {
             Nibbler<2, true> nibbler;
-            nibbler.reset(framebuffer.GetRealAddress(baseAddr + frame.firstDirtyLine * rowBytes),
-                          0);
 
-            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++)
-                for (int32 x = 0; x < width; x++) *(buffer++) = lut[nibbler.nibble()];
+            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
+                nibbler.reset(framebuffer.GetRealAddress(baseAddr + y * rowBytes), firstColumn);
+                uint32* buffer = frameBuffer + y * width + firstColumn;
+
+                for (uint32 x = firstColumn; x <= lastColumn; x++)
+                    *(buffer++) = lut[nibbler.nibble()];
+            }
 
             break;
         }
 
         case 4: {
             Nibbler<4, true> nibbler;
-            nibbler.reset(framebuffer.GetRealAddress(baseAddr + frame.firstDirtyLine * rowBytes),
-                          0);
 
-            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++)
-                for (int32 x = 0; x < width; x++) *(buffer++) = lut[nibbler.nibble()];
+            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
+                nibbler.reset(framebuffer.GetRealAddress(baseAddr + y * rowBytes), firstColumn);
+                uint32* buffer = frameBuffer + y * width + firstColumn;
+
+                for (uint32 x = firstColumn; x <= lastColumn; x++)
+                    *(buffer++) = lut[nibbler.nibble()];
+            }
 
             break;
         }
 
         case 8: {
-            uint8* fbuf = framebuffer.GetRealAddress(baseAddr + frame.firstDirtyLine * rowBytes);
+            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
+                uint8* fbuf = framebuffer.GetRealAddress(baseAddr + y * rowBytes + firstColumn);
+                uint32* buffer = frameBuffer + y * width + firstColumn;
 
-            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++)
-                for (int32 x = 0; x < width; x++) *(buffer++) = lut[*(uint8*)((long)(fbuf++) ^ 1)];
+                for (uint32 x = firstColumn; x <= lastColumn; x++)
+                    *(buffer++) = lut[*(uint8*)((long)(fbuf++) ^ 1)];
+            }
 
             break;
         }
 
         default: {
-            uint8* fbuf = framebuffer.GetRealAddress(baseAddr + frame.firstDirtyLine * rowBytes);
+            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
+                uint8* fbuf = framebuffer.GetRealAddress(baseAddr + y * rowBytes + 2 * firstColumn);
+                uint32* buffer = frameBuffer + y * width + firstColumn;
 
-            for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++)
-                for (int32 x = 0; x < width; x++) {
+                for (uint32 x = firstColumn; x <= lastColumn; x++) {
                     uint8 p1 = *(uint8*)((long)(fbuf++) ^ 1);  // GGGBBBBB
                     uint8 p2 = *(uint8*)((long)(fbuf++) ^ 1);  // RRRRRGGG
 
@@ -720,6 +737,7 @@ bool EmRegsSED1376PalmGeneric::CopyLCDFrame(Frame& frame, bool fullRefresh) {
                                     (((p >> 8) & 0xF8) | ((p >> 11) & 0x07));
                     }
                 }
+            }
 
             break;
         }
@@ -26,6 +26,7 @@
 #include "EmSession.h"   // gSession
 #include "EmSystemState.h"
 #include "Frame.h"
+#include "InterruptTracer.h"
 #include "Logging.h"  // LogAppendMsg
 #include "MetaMemory.h"
 #include "Miscellaneous.h"  // GetHostTime
@@ -64,6 +65,12 @@ static const int kBaseAddressShift = 16;  // Shift to get base address from CSGB
 namespace {
     constexpr uint32 SAVESTATE_VERSION = 2;
 
+    // Interrupt sources by their bit in the status register (hi << 16 | lo).
+    const char* const INTERRUPT_SOURCES[InterruptTracer::SOURCE_COUNT] = {
+        nullptr, "Timer", "UART", "WDT", "RTC", "Timer2", "PortJ", "PWM", "PortG", "PortF", "PortE",
+        "PortD", "UART2", "PWM2", "DMA2", "DMA1", "IRQ1", "IRQ2", "IRQ3", "IRQ6", "PortR", "CSPI",
+        "SampleTimer", "EMU", "ADC", "PortP", "PortN", "PortM", "PortK", "MMC", "I2C", "USB"};
+
     double TimerTicksPerSecond(uint16 tmrControl, uint16 tmrPrescaler, int32 systemClockFrequency) {
         uint8 clksource = (tmrControl >> 1) & 0x7;
         double prescaler = ((tmrPrescaler & 0xff) + 1);
@@ -80,8 +87,8 @@ namespace {
         }
     }
 
-    void cycleThunk(void* context, uint64 cycles, bool sleeping) {
-        ((EmRegsSZ*)context)->Cycle(cycles, sleeping);
+    uint64 cycleThunk(void* context, uint64 cycles, bool sleeping) {
+        return ((EmRegsSZ*)context)->Cycle(cycles, sleeping);
     }
 
     template <class T>
@@ -1154,7 +1161,8 @@ void EmRegsSZ::Initialize(void) {
     UpdateTimers();
     powerOffCached = GetAsleep();
 
-    onMarkScreenCleanHandle = gSystemState.onMarkScreenClean.AddHandler([this]() { MarkScreen(); });
+    onMarkScreenCleanHandle =
+        gSystemState->onMarkScreenClean.AddHandler([this]() { MarkScreen(); });
 }
 
 // ---------------------------------------------------------------------------
@@ -1211,7 +1219,7 @@ void EmRegsSZ::Dispose(void) {
 
     EmRegs::Dispose();
 
-    gSystemState.onMarkScreenClean.RemoveHandler(onMarkScreenCleanHandle);
+    gSystemState->onMarkScreenClean.RemoveHandler(onMarkScreenCleanHandle);
     EmHAL::onDayRollover.RemoveHandler(onDayRolloverHandle);
     EmHAL::RemoveCycleConsumer(cycleThunk, this);
 }
@@ -1754,17 +1762,21 @@ uint32 EmRegsSZ::GetAddressRange(void) { return kMemorySize; }
 // updating timer registers).  This function is called in two places from
 // Emulator::Execute.  Interestingly, the loop runs 3% FASTER if this function
 // is in its own separate function instead of being inline.
+//
+// Returns the cycle count at which the next timer event is due.
 
-inline void EmRegsSZ::Cycle(uint64 systemCycles, Bool sleeping) {
+inline uint64 EmRegsSZ::Cycle(uint64 systemCycles, Bool sleeping) {
     if (unlikely(afterLoad)) {
         // DispatchPwmChange();
         afterLoad = false;
     }
 
-    if (unlikely(powerOffCached)) return;
+    if (unlikely(powerOffCached)) return ~0ull;
 
     this->systemCycles = systemCycles;
     if (unlikely(systemCycles >= nextTimerEventAfterCycle)) UpdateTimers();
+
+    return nextTimerEventAfterCycle;
 }
 
 void EmRegsSZ::SetUARTSync(bool sync) {
@@ -2825,7 +2837,7 @@ void EmRegsSZ::uart2Write(emuptr address, int size, uint32 value) {
 void EmRegsSZ::pllRegisterWrite(emuptr address, int size, uint32 value) {
     EmRegsSZ::StdWrite(address, size, value);
 
-    gSystemState.MarkScreenDirty();
+    gSystemState->MarkScreenDirty();
 
     EmHAL::onSystemClockChange.Dispatch();
 
@@ -3069,6 +3081,12 @@ void EmRegsSZ::UpdateInterrupts(void) {
     f68SZ328Regs.intStatusHi = f68SZ328Regs.intPendingHi & ~f68SZ328Regs.intMaskHi;
     f68SZ328Regs.intStatusLo = f68SZ328Regs.intPendingLo & ~f68SZ328Regs.intMaskLo;
 
+    if (gInterruptTracer->IsRunning())
+        gInterruptTracer->UpdateStatus(
+            EmHAL::GetCurrentCycles(),
+            ((uint32)READ_REGISTER(intStatusHi) << 16) | READ_REGISTER(intStatusLo),
+            INTERRUPT_SOURCES);
+
     PRINTF("EmRegsSZ::UpdateInterrupts: intMask    = 0x%04lX %04lX", (uint32)f68SZ328Regs.intMaskHi,
            (uint32)f68SZ328Regs.intMaskLo);
 
@@ -3777,22 +3795,23 @@ bool EmRegsSZ::CopyLCDFrame(Frame& frame, bool fullRefresh) {
     frame.scaleX = frame.scaleY = 1;
     frame.lineWidth = screenWidth;
 
-    frame.UpdateDirtyLines(gSystemState, startAddress, virtualPageWidth, fullRefresh);
+    frame.UpdateDirtyLines(*gSystemState, startAddress, virtualPageWidth, fullRefresh);
     if (!frame.hasChanges) return true;
 
-    uint32* dest =
-        reinterpret_cast<uint32*>(frame.GetBuffer()) + frame.firstDirtyLine * frame.lineWidth;
+    uint32* buffer = reinterpret_cast<uint32*>(frame.GetBuffer());
 
     switch (bpp) {
         case 4: {
+            frame.UpdateDirtyColumns(bpp, panningOffset);
             UpdatePalette();
             uint8* base = EmMemGetRealAddress(startAddress);
             Nibbler<4, true> nibbler;
 
             for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
-                nibbler.reset(base + y * virtualPageWidth, panningOffset);
+                nibbler.reset(base + y * virtualPageWidth, panningOffset + frame.firstDirtyColumn);
+                uint32* dest = buffer + y * frame.lineWidth + frame.firstDirtyColumn;
 
-                for (uint32 x = 0; x < screenWidth; x++) {
+                for (uint32 x = frame.firstDirtyColumn; x <= frame.lastDirtyColumn; x++) {
                     *(dest++) = palette[nibbler.nibble()];
                 }
             }
@@ -3801,13 +3820,16 @@ bool EmRegsSZ::CopyLCDFrame(Frame& frame, bool fullRefresh) {
         }
 
         case 8: {
+            frame.UpdateDirtyColumns(bpp, panningOffset >> 3);
             UpdatePalette();
             uint8* base = EmMemGetRealAddress(startAddress);
 
             for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
-                uint8* src = base + y * virtualPageWidth + (panningOffset >> 3);
+                uint8* src =
+                    base + y * virtualPageWidth + (panningOffset >> 3) + frame.firstDirtyColumn;
+                uint32* dest = buffer + y * frame.lineWidth + frame.firstDirtyColumn;
 
-                for (uint32 x = 0; x < screenWidth; x++) {
+                for (uint32 x = frame.firstDirtyColumn; x <= frame.lastDirtyColumn; x++) {
                     *(dest++) = palette[EmMemDoGet8(src++)];
                 }
             }
@@ -3816,12 +3838,15 @@ bool EmRegsSZ::CopyLCDFrame(Frame& frame, bool fullRefresh) {
         }
 
         case 16: {
+            frame.UpdateDirtyColumns(bpp, panningOffset >> 4);
             uint16* base = reinterpret_cast<uint16*>(EmMemGetRealAddress(startAddress & ~1));
 
             for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
-                uint16* src = base + y * (virtualPageWidth >> 1) + (panningOffset >> 4);
+                uint16* src = base + y * (virtualPageWidth >> 1) + (panningOffset >> 4) +
+                              frame.firstDirtyColumn;
+                uint32* dest = buffer + y * frame.lineWidth + frame.firstDirtyColumn;
 
-                for (uint32 x = 0; x < screenWidth; x++) {
+                for (uint32 x = frame.firstDirtyColumn; x <= frame.lastDirtyColumn; x++) {
                     *(dest++) = convertColor_16bit(EmMemDoGet16(src++));
                 }
             }
@@ -3855,7 +3880,7 @@ void EmRegsSZ::UnmarkScreen() {
     screenMarked = false;
 }
 
-void EmRegsSZ::MarkScreenDirty() { gSystemState.MarkScreenDirty(); }
+void EmRegsSZ::MarkScreenDirty() { gSystemState->MarkScreenDirty(); }
 
 uint32 EmRegsSZ::CyclesToNextInterrupt(uint64 systemCycles) {
     this->systemCycles = systemCycles;
@@ -3877,6 +3902,8 @@ int32 EmRegsSZ::GetSysClk() {
 }
 
 void EmRegsSZ::UpdateTimers() {
+    EmHAL::InvalidateCycleDeadline();
+
     nextTimerEventAfterCycle = ~0;
     if (GetAsleep()) return;
 
@@ -77,7 +77,7 @@ class EmRegsSZ : public EmRegs, public EmHALHandler {
 
     virtual uint32 CyclesToNextInterrupt(uint64 systemCycles);
     virtual bool EnableRAM();
-    inline void Cycle(uint64 systemCycles, Bool sleeping);
+    inline uint64 Cycle(uint64 systemCycles, Bool sleeping);
 
     virtual void SetUARTSync(bool sync);
 
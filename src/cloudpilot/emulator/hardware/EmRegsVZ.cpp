@@ -28,6 +28,7 @@
 #include "EmSession.h"   // gSession
 #include "EmSystemState.h"
 #include "Frame.h"
+#include "InterruptTracer.h"
 #include "Logging.h"  // LogAppendMsg
 #include "MetaMemory.h"
 #include "Miscellaneous.h"  // GetHostTime
@@ -82,6 +83,13 @@ static const int kBaseAddressShift = 13;  // Shift to get base address from CSGB
 namespace {
     constexpr uint32 SAVESTATE_VERSION = 5;
 
+    // Interrupt sources by their bit in the status register (hi << 16 | lo).
+    const char* const INTERRUPT_SOURCES[InterruptTracer::SOURCE_COUNT] = {
+        "SPIM", "Timer", "UART", "WDT", "RTC", "Timer2", "Kbd", "PWM", "Int0", "Int1", "Int2",
+        "Int3", "UART2", "PWM2", nullptr, nullptr, "IRQ1", "IRQ2", "IRQ3", "IRQ6", "Pen", "SPI1",
+        "SampleTimer", "EMU", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+        nullptr};
+
     double TimerTicksPerSecond(uint16 tmrControl, uint16 tmrPrescaler, int32 systemClockFrequency) {
         uint8 clksource = (tmrControl >> 1) & 0x7;
         double prescaler = ((tmrPrescaler & 0xff) + 1);
@@ -109,8 +117,8 @@ namespace {
         marker(firstLineAddr, lastLineAddr);
     }
 
-    void cycleThunk(void* context, uint64 cycles, bool sleeping) {
-        ((EmRegsVZ*)context)->Cycle(cycles, sleeping);
+    uint64 cycleThunk(void* context, uint64 cycles, bool sleeping) {
+        return ((EmRegsVZ*)context)->Cycle(cycles, sleeping);
     }
 }  // namespace
 
@@ -545,7 +553,8 @@ void EmRegsVZ::Initialize(void) {
     fUART[0] = new EmUARTDragonball(EmUARTDragonball::kUART_DragonballVZ, 0);
     fUART[1] = new EmUARTDragonball(EmUARTDragonball::kUART_DragonballVZ, 1);
 
-    onMarkScreenCleanHandle = gSystemState.onMarkScreenClean.AddHandler([this]() { MarkScreen(); });
+    onMarkScreenCleanHandle =
+        gSystemState->onMarkScreenClean.AddHandler([this]() { MarkScreen(); });
     onDayRolloverHandle = EmHAL::onDayRollover.AddHandler([this]() { HandleDayRollover(); });
 
     ApplySdctl();
@@ -708,7 +717,7 @@ void EmRegsVZ::Dispose(void) {
 
     EmRegs::Dispose();
 
-    gSystemState.onMarkScreenClean.RemoveHandler(onMarkScreenCleanHandle);
+    gSystemState->onMarkScreenClean.RemoveHandler(onMarkScreenCleanHandle);
     EmHAL::onDayRollover.RemoveHandler(onDayRolloverHandle);
 
     EmHAL::RemoveCycleConsumer(cycleThunk, this);
@@ -941,14 +950,16 @@ uint32 EmRegsVZ::GetAddressRange(void) { return kMemorySize; }
 // updating timer registers).  This function is called in two places from
 // Emulator::Execute.  Interestingly, the loop runs 3% FASTER if this function
 // is in its own separate function instead of being inline.
+//
+// Returns the cycle count at which the next timer or SPI event is due.
 
-inline void EmRegsVZ::Cycle(uint64 systemCycles, Bool sleeping) {
+inline uint64 EmRegsVZ::Cycle(uint64 systemCycles, Bool sleeping) {
     if (unlikely(afterLoad)) {
         DispatchPwmChange();
         afterLoad = false;
     }
 
-    if (unlikely(powerOffCached)) return;
+    if (unlikely(powerOffCached)) return ~0ull;
 
     if (spi1TransferInProgress) {
         uint32 delta = systemCycles - this->systemCycles;
@@ -960,6 +971,9 @@ inline void EmRegsVZ::Cycle(uint64 systemCycles, Bool sleeping) {
     this->systemCycles = systemCycles;
 
     if (unlikely(systemCycles >= nextTimerEventAfterCycle)) UpdateTimers();
+
+    return spi1TransferInProgress ? min(nextTimerEventAfterCycle, systemCycles + (uint64)spi1Countdown)
+                                  : nextTimerEventAfterCycle;
 }
 
 void EmRegsVZ::SetUARTSync(bool sync) {
@@ -1192,12 +1206,12 @@ bool EmRegsVZ::CopyLCDFrame(Frame& frame, bool fullRefresh) {
     const emuptr baseAddr = READ_REGISTER(lcdStartAddr);
     if (baseAddr == 0) return false;
 
-    if (!gSystemState.IsScreenDirty() && !fullRefresh) {
+    if (!gSystemState->IsScreenDirty() && !fullRefresh) {
         frame.hasChanges = false;
         return true;
     }
 
-    frame.UpdateDirtyLines(gSystemState, baseAddr, frame.bytesPerLine, fullRefresh);
+    frame.UpdateDirtyLines(*gSystemState, baseAddr, frame.bytesPerLine, fullRefresh);
     if (!frame.hasChanges) return true;
 
     switch (frame.bpp) {
@@ -1217,6 +1231,9 @@ bool EmRegsVZ::CopyLCDFrame(Frame& frame, bool fullRefresh) {
             return false;
     }
 
+    // Lines are always copied in full, but consumers only need to convert the dirty columns.
+    frame.UpdateDirtyColumns(frame.bpp, frame.margin);
+
     // Determine first and last scanlines to fetch, and fetch them.
 
     emuptr firstLineAddr = baseAddr + frame.firstDirtyLine * frame.bytesPerLine;
@@ -1253,7 +1270,7 @@ void EmRegsVZ::UnmarkScreen() {
     screenMarked = false;
 }
 
-void EmRegsVZ::MarkScreenDirty() { gSystemState.MarkScreenDirty(); }
+void EmRegsVZ::MarkScreenDirty() { gSystemState->MarkScreenDirty(); }
 
 // ---------------------------------------------------------------------------
 //		� EmRegsVZ::GetDynamicHeapSize
@@ -2133,7 +2150,7 @@ void EmRegsVZ::lcdRegisterWrite(emuptr address, int size, uint32 value) {
 void EmRegsVZ::pllRegisterWrite(emuptr address, int size, uint32 value) {
     EmRegsVZ::StdWrite(address, size, value);
 
-    gSystemState.MarkScreenDirty();
+    gSystemState->MarkScreenDirty();
 
     EmHAL::onSystemClockChange.Dispatch();
 
@@ -2379,6 +2396,12 @@ void EmRegsVZ::UpdateInterrupts(void) {
     f68VZ328Regs.intStatusHi = f68VZ328Regs.intPendingHi & ~f68VZ328Regs.intMaskHi;
     f68VZ328Regs.intStatusLo = f68VZ328Regs.intPendingLo & ~f68VZ328Regs.intMaskLo;
 
+    if (gInterruptTracer->IsRunning())
+        gInterruptTracer->UpdateStatus(
+            EmHAL::GetCurrentCycles(),
+            ((uint32)READ_REGISTER(intStatusHi) << 16) | READ_REGISTER(intStatusLo),
+            INTERRUPT_SOURCES);
+
     PRINTF("EmRegsVZ::UpdateInterrupts: intMask    = 0x%04lX %04lX", (uint32)f68VZ328Regs.intMaskHi,
            (uint32)f68VZ328Regs.intMaskLo);
 
@@ -3024,6 +3047,8 @@ uint32 EmRegsVZ::CyclesToNextInterrupt(uint64 systemCycles) {
 }
 
 void EmRegsVZ::UpdateTimers() {
+    EmHAL::InvalidateCycleDeadline();
+
     nextTimerEventAfterCycle = ~0;
     if (GetAsleep()) return;
 
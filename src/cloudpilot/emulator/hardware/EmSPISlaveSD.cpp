@@ -23,7 +23,7 @@ namespace {
     constexpr uint8 DATA_RESPONSE_ACCEPTED = 0xe5;
     constexpr uint8 DATA_RESPONSE_WRITE_FAILED = 0x0d;
 
-    CardImage* image() { return gExternalStorage.GetImageInSlot(EmHAL::Slot::sdcard); }
+    CardImage* image() { return gExternalStorage->GetImageInSlot(EmHAL::Slot::sdcard); }
 
     bool determineLayout(size_t blocksTotal, uint32& cSizeMult, uint32& cSize) {
         for (cSizeMult = 0; cSizeMult < 8; cSizeMult++) {
@@ -90,7 +90,7 @@ uint16 EmSPISlaveSD::DoExchange(uint16 control, uint16 data) {
 void EmSPISlaveSD::Enable(void) {
     if (spiState != SpiState::notSelected) return;
 
-    if (gExternalStorage.IsMounted(EmHAL::Slot::sdcard)) {
+    if (gExternalStorage->IsMounted(EmHAL::Slot::sdcard)) {
         spiState = SpiState::rxCmdByte;
         lastCmd = 0;
     }
@@ -126,7 +126,7 @@ void EmSPISlaveSD::DoSaveLoad(T& helper) {
 }
 
 uint8 EmSPISlaveSD::DoExchange8(uint8 data) {
-    if (!gExternalStorage.IsMounted(EmHAL::Slot::sdcard)) return 0x00;
+    if (!gExternalStorage->IsMounted(EmHAL::Slot::sdcard)) return 0x00;
     if (cardState == CardState::multiblockRead) HandleCmd12(data);
 
     switch (spiState) {
@@ -673,6 +673,8 @@ void EmUARTDragonball::ReceiveRxFIFO(EmTransportSerial* transport) {
 #endif
                 PRINTF("UART: Received %ld serial bytes.", bytesToBuffer);
 
+                gSession->NotifyHostInput(Recording::HostInput::serial);
+
                 for (long ii = 0; ii < bytesToBuffer; ++ii) {
                     fRxFIFO.Put(buffer[ii]);
                 }  // end loop that puts bytes into FIFO
@@ -702,8 +704,8 @@ EmTransportSerial* EmUARTDragonball::GetTransport(void) {
     return gSession->GetTransportSerial(type);
 }
 
-void EmUARTDragonball::Cycle(uint64 systemCycles, bool isSleeping) {
-    if (!sync) return;
+uint64 EmUARTDragonball::Cycle(uint64 systemCycles, bool isSleeping) {
+    if (!sync) return ~0ull;
 
     this->systemCycles = systemCycles;
 
@@ -717,10 +719,13 @@ void EmUARTDragonball::Cycle(uint64 systemCycles, bool isSleeping) {
 #endif
         UpdateTransactionState(TransactionState::idle);
     }
+
+    // The stopped check above needs to run after every instruction.
+    return systemCycles;
 }
 
-void EmUARTDragonball::CycleThunk(void* ctx, uint64 systemCycles, bool isSleeping) {
-    reinterpret_cast<EmUARTDragonball*>(ctx)->Cycle(systemCycles, isSleeping);
+uint64 EmUARTDragonball::CycleThunk(void* ctx, uint64 systemCycles, bool isSleeping) {
+    return reinterpret_cast<EmUARTDragonball*>(ctx)->Cycle(systemCycles, isSleeping);
 }
 
 void EmUARTDragonball::SetModeSync(bool sync) {
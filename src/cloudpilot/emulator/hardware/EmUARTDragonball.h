@@ -14,7 +14,7 @@
 #ifndef EmUARTDragonball_h
 #define EmUARTDragonball_h
 
-#include "EmThreadSafeQueue.h"  // EmByteQueue
+#include "SpscQueue.h"
 
 // #define TRACE_UART_SYNC
 
@@ -139,14 +139,14 @@ class EmUARTDragonball {
     int PrvLevelMarker(Bool forRX);
     void UpdateTransactionState(TransactionState state);
 
-    void Cycle(uint64 systemCycles, bool isSleeping);
-    static void CycleThunk(void* ctx, uint64 systemCycles, bool isSleeping);
+    uint64 Cycle(uint64 systemCycles, bool isSleeping);
+    static uint64 CycleThunk(void* ctx, uint64 systemCycles, bool isSleeping);
 
    private:
     int fUARTNum;
     State fState;
-    EmByteQueue fRxFIFO;
-    EmByteQueue fTxFIFO;
+    SpscQueue<uint8> fRxFIFO;
+    SpscQueue<uint8> fTxFIFO;
 
     bool receiveInProgress{false};
     bool sync{false};
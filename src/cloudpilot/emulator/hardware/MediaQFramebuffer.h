@@ -21,7 +21,7 @@ class MediaQFramebuffer : public EmHALHandler {
     virtual bool CopyLCDFrame(Frame& frame, bool fullRefresh) override;
 
    private:
-    template <bool flipX, bool flipY, bool swapXY, bool trivialPitch>
+    template <bool flipX, bool flipY, bool swapXY>
     bool DecodeFrame(Frame& frame, uint32 rowBytes, uint32 bpp, bool fullRefresh);
 
     template <bool flipX, bool flipY, bool swapXY>
@@ -48,8 +48,6 @@ bool MediaQFramebuffer<T>::CopyLCDFrame(Frame& frame, bool fullRefresh) {
     const uint32 width =
         swapXY ? static_cast<T*>(this)->GetWidth()
                : std::min(static_cast<T*>(this)->GetWidth(), (rowBytes * scaleX * 8) / bpp);
-    const bool trivialPitch =
-        rowBytes == (swapXY ? ((height * bpp) / (8 * scaleY)) : ((width * bpp) / (8 * scaleX)));
 
     EmAssert(gSession);
     const ScreenDimensions screenDimensions(gSession->GetDevice().GetScreenDimensions());
@@ -69,15 +67,14 @@ bool MediaQFramebuffer<T>::CopyLCDFrame(Frame& frame, bool fullRefresh) {
 
     if (4 * frame.lineWidth * frame.lines > frame.GetBufferSize()) return false;
 
-    // We combine those four flags in to a nibble and instantiate a template in a switch block
+    // We combine those three flags in to a nibble and instantiate a template in a switch block
     // in order to generate optimized code paths for the various combinations.
-    const uint8 variant = (flipX ? 0x08 : 0x00) | (flipY ? 0x04 : 0x00) | (swapXY ? 0x02 : 0x00) |
-                          (trivialPitch ? 0x01 : 0x00);
+    const uint8 variant = (flipX ? 0x04 : 0x00) | (flipY ? 0x02 : 0x00) | (swapXY ? 0x01 : 0x00);
 
-#define MQ_RENDER_VARIANT(x)                                                             \
-    case x:                                                                              \
-        return DecodeFrame<(x >> 3) & 0x01, (x >> 2) & 0x01, (x >> 1) & 0x01, x & 0x01>( \
-            frame, rowBytes, bpp, fullRefresh);
+#define MQ_RENDER_VARIANT(x)                                                                     \
+    case x:                                                                                      \
+        return DecodeFrame<(x >> 2) & 0x01, (x >> 1) & 0x01, x & 0x01>(frame, rowBytes, bpp, \
+                                                                       fullRefresh);
 
     switch (variant) {
         MQ_RENDER_VARIANT(0x00);
@@ -88,14 +85,6 @@ bool MediaQFramebuffer<T>::CopyLCDFrame(Frame& frame, bool fullRefresh) {
         MQ_RENDER_VARIANT(0x05);
         MQ_RENDER_VARIANT(0x06);
         MQ_RENDER_VARIANT(0x07);
-        MQ_RENDER_VARIANT(0x08);
-        MQ_RENDER_VARIANT(0x09);
-        MQ_RENDER_VARIANT(0x0a);
-        MQ_RENDER_VARIANT(0x0b);
-        MQ_RENDER_VARIANT(0x0c);
-        MQ_RENDER_VARIANT(0x0d);
-        MQ_RENDER_VARIANT(0x0e);
-        MQ_RENDER_VARIANT(0x0f);
         default:
             EmAssert(false);
             return false;
@@ -104,7 +93,7 @@ bool MediaQFramebuffer<T>::CopyLCDFrame(Frame& frame, bool fullRefresh) {
 }
 
 template <class T>
-template <bool flipX, bool flipY, bool swapXY, bool trivialPitch>
+template <bool flipX, bool flipY, bool swapXY>
 bool MediaQFramebuffer<T>::DecodeFrame(Frame& frame, uint32 rowBytes, uint32 bpp,
                                        bool fullRefresh) {
     // The internal geometry of the image is rotated by 90° if swapXY is trze.
@@ -138,46 +127,63 @@ bool MediaQFramebuffer<T>::DecodeFrame(Frame& frame, uint32 rowBytes, uint32 bpp
     }
 
     // Caclulate the dirty region.
-    frame.UpdateDirtyLines(gSystemState, baseAddr, rowBytes, fullRefresh, swapXY);
+    frame.UpdateDirtyLines(*gSystemState, baseAddr, rowBytes, fullRefresh, swapXY);
     if (!frame.hasChanges) return true;
 
+    frame.UpdateDirtyColumns(bpp);
+
     const uint32 firstLine = frame.firstDirtyLine;
     const uint32 lastLine = frame.lastDirtyLine;
 
+    // Dirty columns are only tracked if the axes are not swapped.
+    const uint32 firstColumn = swapXY ? 0 : frame.firstDirtyColumn;
+    const uint32 lastColumn = swapXY ? lineWidth - 1 : frame.lastDirtyColumn;
+
     // The frontend code cannot deal with a vertically oriented dirty region, so always do a
     // full update in the frontend if swapXY is true.
     if constexpr (swapXY) frame.ResetDirtyRegion();
 
     // If flipY is true, the actual image is flipped relative to our scanning direction, so
-    // flip the dirty region for the frontend.
+    // flip the dirty region for the frontend. The same holds for the columns and flipX.
     if constexpr (!swapXY && flipY) frame.FlipDirtyRegion();
+    if constexpr (!swapXY && flipX) frame.FlipDirtyColumns();
 
     uint32* destBuffer = reinterpret_cast<uint32*>(frame.GetBuffer());
 
     // If the image is not transformed we can skip recalculating the offset and just increment
     // the pointer. In this case we need to fast-forward the pointer to the start of relevant
-    // region.
+    // region and skip the clean columns at the end of each line.
     if constexpr (!swapXY && flipX == flipY) destBuffer += frame.firstDirtyLine * frame.lineWidth;
+    if constexpr (!swapXY && !flipX && !flipY) destBuffer += firstColumn;
 
     // We can do the same trick in case of a point reflection by *decrementing* the pointer instead
     // -> forward the pointer to the *end* of the relevant region.
     if constexpr (!swapXY && flipX && flipY)
-        destBuffer += (frame.lastDirtyLine - frame.firstDirtyLine + 1) * frame.lineWidth - 1;
+        destBuffer +=
+            (frame.lastDirtyLine - frame.firstDirtyLine + 1) * frame.lineWidth - 1 - firstColumn;
+
+    const uint32 skipColumns = lineWidth - (lastColumn - firstColumn + 1);
+
+    auto nextLine = [&]() {
+        if constexpr (!swapXY && !flipX && !flipY) destBuffer += skipColumns;
+        if constexpr (!swapXY && flipX && flipY) destBuffer -= skipColumns;
+    };
 
     switch (bpp) {
         case 1: {
             static_cast<T*>(this)->PrvUpdatePalette();
             Nibbler<1, true> nibbler;
-            nibbler.reset(
-                static_cast<T*>(this)->framebuffer.GetRealAddress(baseAddr + firstLine * rowBytes),
-                0);
 
             for (uint32 y = firstLine; y <= lastLine; y++) {
-                for (uint32 x = 0; x < lineWidth; x++)
+                nibbler.reset(
+                    static_cast<T*>(this)->framebuffer.GetRealAddress(baseAddr + y * rowBytes),
+                    firstColumn);
+
+                for (uint32 x = firstColumn; x <= lastColumn; x++)
                     UpdatePixel<flipX, flipY, swapXY>(
                         destBuffer, frame, x, y, static_cast<T*>(this)->palette[nibbler.nibble()]);
 
-                if constexpr (!trivialPitch) nibbler.skipBytes(pitchDelta);
+                nextLine();
             }
 
             break;
@@ -186,16 +192,17 @@ bool MediaQFramebuffer<T>::DecodeFrame(Frame& frame, uint32 rowBytes, uint32 bpp
         case 2: {
             static_cast<T*>(this)->PrvUpdatePalette();
             Nibbler<2, true> nibbler;
-            nibbler.reset(
-                static_cast<T*>(this)->framebuffer.GetRealAddress(baseAddr + firstLine * rowBytes),
-                0);
 
             for (uint32 y = firstLine; y <= lastLine; y++) {
-                for (uint32 x = 0; x < lineWidth; x++)
+                nibbler.reset(
+                    static_cast<T*>(this)->framebuffer.GetRealAddress(baseAddr + y * rowBytes),
+                    firstColumn);
+
+                for (uint32 x = firstColumn; x <= lastColumn; x++)
                     UpdatePixel<flipX, flipY, swapXY>(
                         destBuffer, frame, x, y, static_cast<T*>(this)->palette[nibbler.nibble()]);
 
-                if constexpr (!trivialPitch) nibbler.skipBytes(pitchDelta);
+                nextLine();
             }
 
             break;
@@ -204,16 +211,17 @@ bool MediaQFramebuffer<T>::DecodeFrame(Frame& frame, uint32 rowBytes, uint32 bpp
         case 4: {
             static_cast<T*>(this)->PrvUpdatePalette();
             Nibbler<4, true> nibbler;
-            nibbler.reset(
-                static_cast<T*>(this)->framebuffer.GetRealAddress(baseAddr + firstLine * rowBytes),
-                0);
 
             for (uint32 y = firstLine; y <= lastLine; y++) {
-                for (uint32 x = 0; x < lineWidth; x++)
+                nibbler.reset(
+                    static_cast<T*>(this)->framebuffer.GetRealAddress(baseAddr + y * rowBytes),
+                    firstColumn);
+
+                for (uint32 x = firstColumn; x <= lastColumn; x++)
                     UpdatePixel<flipX, flipY, swapXY>(
                         destBuffer, frame, x, y, static_cast<T*>(this)->palette[nibbler.nibble()]);
 
-                if constexpr (!trivialPitch) nibbler.skipBytes(pitchDelta);
+                nextLine();
             }
 
             break;
@@ -222,28 +230,28 @@ bool MediaQFramebuffer<T>::DecodeFrame(Frame& frame, uint32 rowBytes, uint32 bpp
         case 8: {
             static_cast<T*>(this)->PrvUpdatePalette();
 
-            uint8* srcBuffer =
-                static_cast<T*>(this)->framebuffer.GetRealAddress(baseAddr + firstLine * rowBytes);
-
             for (uint32 y = firstLine; y <= lastLine; y++) {
-                for (uint32 x = 0; x < lineWidth; x++)
+                uint8* srcBuffer = static_cast<T*>(this)->framebuffer.GetRealAddress(
+                    baseAddr + y * rowBytes + firstColumn);
+
+                for (uint32 x = firstColumn; x <= lastColumn; x++)
                     // Pixels are arranged in LE words in the framebuffer, so byteswap
                     UpdatePixel<flipX, flipY, swapXY>(
                         destBuffer, frame, x, y,
                         static_cast<T*>(this)->palette[*(uint8*)((long)(srcBuffer++) ^ 1)]);
 
-                if constexpr (!trivialPitch) srcBuffer += pitchDelta;
+                nextLine();
             }
 
             break;
         }
 
         default: {
-            uint8* srcBuffer =
-                static_cast<T*>(this)->framebuffer.GetRealAddress(baseAddr + firstLine * rowBytes);
-
             for (uint32 y = firstLine; y <= lastLine; y++) {
-                for (uint32 x = 0; x < lineWidth; x++) {
+                uint8* srcBuffer = static_cast<T*>(this)->framebuffer.GetRealAddress(
+                    baseAddr + y * rowBytes + 2 * firstColumn);
+
+                for (uint32 x = firstColumn; x <= lastColumn; x++) {
                     // Pixel data is LE, so byteswap
                     uint8 p1 = *(uint8*)((long)(srcBuffer++) ^ 1);  // GGGBBBBB
                     uint8 p2 = *(uint8*)((long)(srcBuffer++) ^ 1);  // RRRRRGGG
@@ -269,7 +277,7 @@ bool MediaQFramebuffer<T>::DecodeFrame(Frame& frame, uint32 rowBytes, uint32 bpp
                             (((p >> 8) & 0xF8) | ((p >> 11) & 0x07)));
                 }
 
-                if constexpr (!trivialPitch) srcBuffer += pitchDelta;
+                nextLine();
             }
             break;
         }
@@ -24,7 +24,7 @@ EmRegsVZAcerS1x::EmRegsVZAcerS1x(EmRegsMB86189& mb86189) : mb86189(mb86189) {
     fSPISlaveADC = new EmSPISlaveADS784x(kChannelSet1);
 
     mb86189.SetGpioReadHandler(
-        []() { return gExternalStorage.IsMounted(EmHAL::Slot::memorystick) ? 0x01 : 0x00; });
+        []() { return gExternalStorage->IsMounted(EmHAL::Slot::memorystick) ? 0x01 : 0x00; });
     mb86189.irqChange.AddHandler([=](bool newState) { UpdateIRQ3(newState ? 0x40 : 0x00); });
 }
 
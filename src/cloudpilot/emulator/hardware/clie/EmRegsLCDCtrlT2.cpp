@@ -372,7 +372,7 @@ uint16 EmRegsMQLCDControlT2::GetLCD2bitMapping() { return 0xfa50; }
 
 void EmRegsMQLCDControlT2::InvalidateWrite(emuptr address, int size, uint32 value) {
     this->StdWriteBE(address, size, value);
-    gSystemState.MarkScreenDirty();
+    gSystemState->MarkScreenDirty();
 }
 
 // ---------------------------------------------------------------------------
@@ -396,7 +396,7 @@ void EmRegsMQLCDControlT2::ColorPaletteWrite(emuptr address, int size, uint32 va
     // registers.
     this->StdWriteBE(address, size, value);
 
-    gSystemState.MarkScreenDirty();
+    gSystemState->MarkScreenDirty();
     paletteDirty = true;
 }
 
@@ -50,7 +50,7 @@ uint8 EmSonyXzWithSlot<XZ>::GetPortInternalValue(int port) {
     uint8 result = XZ::GetPortInternalValue(port);
 
     if (port == 'D') {
-        if (gExternalStorage.IsMounted(EmHAL::Slot::memorystick))
+        if (gExternalStorage->IsMounted(EmHAL::Slot::memorystick))
             result |= 0x08;
         else
             result &= ~0x08;
@@ -151,7 +151,7 @@ uint32 EmRegs330CPLD::GetWord(emuptr address) {
                 Reg2 &= ~Cpld2NoCfDetect;
             else
                 Reg2 |= Cpld2NoCfDetect;
-            if (gExternalStorage.IsMounted(EmHAL::Slot::sdcard))
+            if (gExternalStorage->IsMounted(EmHAL::Slot::sdcard))
                 Reg2 &= ~Cpld2NoSdDetect;
             else
                 Reg2 |= Cpld2NoSdDetect;
@@ -230,7 +230,7 @@ void EmRegs330CPLD::SetWord(emuptr address, uint32 val) {
                 spiSlaveSD->Disable();
 
             if ((fPortMgr->LCDOn != lcdWasOn) || (fPortMgr->BacklightOn != backlightWasOn))
-                gSystemState.MarkScreenDirty();
+                gSystemState->MarkScreenDirty();
 
             if (irWasOn != fPortMgr->IRPortOn) EmHAL::LineDriverChanged(kUARTIR);
 
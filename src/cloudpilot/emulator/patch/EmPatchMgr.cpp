@@ -14,7 +14,10 @@
 
 #include "EmPatchMgr.h"
 
+#include <chrono>
+
 #include "ChunkHelper.h"
+#include "EmCPU68K.h"  // gCPU68K
 #include "EmCommon.h"
 #include "EmHAL.h"  // EmHAL::GetLineDriverState
 #include "EmLowMem.h"  // EmLowMem::GetEvtMgrIdle, EmLowMem::TrapExists, EmLowMem_SetGlobal, EmLowMem_GetGlobal
@@ -23,6 +26,7 @@
 #include "EmPatchModuleHtal.h"
 #include "EmPatchModuleSys.h"
 #include "EmSession.h"  // GetDevice
+#include "EmSessionContext.h"
 #include "KeyboardEvent.h"
 #include "Logging.h"     // LogEvtAddEventToQueue, etc.
 #include "MetaMemory.h"  // MetaMemory mark functions
@@ -34,6 +38,7 @@
 #include "Savestate.h"
 #include "SavestateLoader.h"
 #include "SavestateProbe.h"
+#include "SyscallProfiler.h"
 #include "UAE.h"  // gRegs, m68k_dreg, etc.
 
 // ======================================================================
@@ -42,11 +47,11 @@
 
 // Table of currently Patched shared libraries
 //
-static PatchedLibIndex gPatchedLibs;
+static thread_local PatchedLibIndex gPatchedLibs;
 
 // Table of currently installed tail patches
 //
-static TailPatchIndex gInstalledTailpatches;
+static thread_local TailPatchIndex gInstalledTailpatches;
 
 // ======================================================================
 //	Private functions
@@ -78,13 +83,27 @@ namespace {
         DoSaveLoad(helper, patch.fContext);
     }
 
-    bool executingPatch = false;
+    EM_THREAD_LOCAL bool executingPatch = false;
+
+    uint64 currentCycles() { return gSession->GetSystemCycles() + gCPU68K->GetCurrentCycles(); }
+
+    uint64 hostNsec() {
+        return chrono::duration_cast<chrono::nanoseconds>(
+                   chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
 }  // namespace
 
-EmPatchModule* EmPatchMgr::patchModuleSys = nullptr;
-EmPatchModule* EmPatchMgr::patchModuleHtal = nullptr;
-EmPatchModule* EmPatchMgr::patchModuleNetlib = nullptr;
-EmPatchModule* EmPatchMgr::patchModuleClieStubAll = nullptr;
+EM_THREAD_LOCAL EmPatchModule* EmPatchMgr::patchModuleSys = nullptr;
+EM_THREAD_LOCAL EmPatchModule* EmPatchMgr::patchModuleHtal = nullptr;
+EM_THREAD_LOCAL EmPatchModule* EmPatchMgr::patchModuleNetlib = nullptr;
+EM_THREAD_LOCAL EmPatchModule* EmPatchMgr::patchModuleClieStubAll = nullptr;
+
+const EmSessionState EmPatchMgr::sessionState{
+    EM_SESSION_VARIABLE(gPatchedLibs),          EM_SESSION_VARIABLE(gInstalledTailpatches),
+    EM_SESSION_VARIABLE(executingPatch),        EM_SESSION_VARIABLE(patchModuleSys),
+    EM_SESSION_VARIABLE(patchModuleHtal),       EM_SESSION_VARIABLE(patchModuleNetlib),
+    EM_SESSION_VARIABLE(patchModuleClieStubAll)};
 
 /***********************************************************************
  *
@@ -142,6 +161,7 @@ void EmPatchMgr::Initialize(void) {
 
 void EmPatchMgr::Reset(void) {
     gInstalledTailpatches.clear();
+    gSyscallProfiler->DiscardPendingCalls();
 
     // Clear the installed lib patches (for "loaded" libraries)
     //
@@ -209,6 +229,7 @@ void EmPatchMgr::Load(SavestateLoader& loader) {
 
     gPatchedLibs.clear();
     gInstalledTailpatches.clear();
+    gSyscallProfiler->DiscardPendingCalls();
     RemoveInstructionBreaks();
 
     executingPatch = false;
@@ -337,8 +358,23 @@ CallROMType EmPatchMgr::HandleSystemCall(const SystemCallContext& context) {
     cerr << "syscall: " << trapWordToString(context.fTrapWord) << endl << flush;
 #endif
 
+    // Calls made by the emulator itself are accounted to the patch that
+    // issued them.
+    const bool profile = gSyscallProfiler->IsRunning() && !gSession->IsNested();
+    const uint64 cycles = profile ? currentCycles() : 0;
+
     CallROMType handled = EmPatchMgr::HandlePatches(context, hp, tp);
 
+    // A restarted call is recorded once it eventually completes. Calls that
+    // are passed on to the ROM need a break on their return address.
+    if (profile && handled == kExecuteROM) {
+        RemoveInstructionBreaks();
+        gSyscallProfiler->RecordCall(context, cycles, true);
+        InstallInstructionBreaks();
+    } else if (profile && handled == kSkipROM) {
+        gSyscallProfiler->RecordCall(context, cycles, false);
+    }
+
     return handled;
 }
 
@@ -416,7 +452,12 @@ CallROMType EmPatchMgr::HandlePatches(const SystemCallContext& context, Headpatc
     // to enter the debugger.
 
     if (hp) {
+        const uint64 start = gSyscallProfiler->IsRunning() ? hostNsec() : 0;
+
         handled = CallHeadpatch(hp);
+
+        if (gSyscallProfiler->IsRunning())
+            gSyscallProfiler->RecordHeadpatch(context, hostNsec() - start);
     }
 
     // Next, see if there's a SysTailpatch function for this trap. If
@@ -426,8 +467,13 @@ CallROMType EmPatchMgr::HandlePatches(const SystemCallContext& context, Headpatc
     if (tp) {
         if (handled == kExecuteROM) {
             SetupForTailpatch(tp, context);
-        } else {
+        } else if (handled == kSkipROM) {
+            const uint64 start = gSyscallProfiler->IsRunning() ? hostNsec() : 0;
+
             CallTailpatch(tp);
+
+            if (gSyscallProfiler->IsRunning())
+                gSyscallProfiler->RecordTailpatch(context, hostNsec() - start);
         }
     }
 
@@ -451,11 +497,30 @@ void EmPatchMgr::HandleInstructionBreak(void) {
     // Get the address of the tailpatch to call.  May return NULL if
     // there is no tailpatch for this memory location.
 
-    TailpatchProc tp = RecoverFromTailpatch(gCPU->GetPC());
+    const emuptr pc = gCPU->GetPC();
+
+    SystemCallContext context;
+    TailpatchProc tp = RecoverFromTailpatch(pc, context);
 
     // Call the tailpatch handler for the trap that just returned.
 
-    CallTailpatch(tp);
+    if (tp && gSyscallProfiler->IsRunning()) {
+        const uint64 start = hostNsec();
+
+        CallTailpatch(tp);
+
+        gSyscallProfiler->RecordTailpatch(context, hostNsec() - start);
+    } else {
+        CallTailpatch(tp);
+    }
+
+    // Complete the profile of the trap that just returned, if any.
+
+    if (gSyscallProfiler->IsReturnAddress(pc)) {
+        RemoveInstructionBreaks();
+        gSyscallProfiler->RecordReturn(pc, currentCycles());
+        InstallInstructionBreaks();
+    }
 }
 
 /***********************************************************************
@@ -478,6 +543,9 @@ void EmPatchMgr::InstallInstructionBreaks(void) {
         MetaMemory::MarkInstructionBreak(iter->fContext.fNextPC);
         ++iter;
     }
+
+    for (emuptr returnAddress : gSyscallProfiler->GetReturnAddresses())
+        MetaMemory::MarkInstructionBreak(returnAddress);
 }
 
 /***********************************************************************
@@ -500,6 +568,9 @@ void EmPatchMgr::RemoveInstructionBreaks(void) {
         MetaMemory::UnmarkInstructionBreak(iter->fContext.fNextPC);
         ++iter;
     }
+
+    for (emuptr returnAddress : gSyscallProfiler->GetReturnAddresses())
+        MetaMemory::UnmarkInstructionBreak(returnAddress);
 }
 
 /***********************************************************************
@@ -558,7 +629,7 @@ void EmPatchMgr::SetupForTailpatch(TailpatchProc tp, const SystemCallContext& co
  *
  ***********************************************************************/
 
-TailpatchProc EmPatchMgr::RecoverFromTailpatch(emuptr startPC) {
+TailpatchProc EmPatchMgr::RecoverFromTailpatch(emuptr startPC, SystemCallContext& context) {
     // Get the current PC so that we can find the record for this tailpatch.
 
     emuptr patchPC = startPC;
@@ -570,6 +641,7 @@ TailpatchProc EmPatchMgr::RecoverFromTailpatch(emuptr startPC) {
     while (iter != gInstalledTailpatches.end()) {
         if (iter->fContext.fNextPC == patchPC) {
             TailpatchProc result = iter->fTailpatch;
+            context = iter->fContext;
 
             // Decrement the use-count.  If it reaches zero, remove the
             // patch from our list.
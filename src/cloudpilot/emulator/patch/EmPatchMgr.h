@@ -21,6 +21,7 @@
 
 struct SystemCallContext;
 class EmPatchModule;
+class EmSessionState;
 class SavestateLoader;
 
 class EmPatchMgr {
@@ -55,12 +56,14 @@ class EmPatchMgr {
 
    private:
     static void SetupForTailpatch(TailpatchProc tp, const SystemCallContext&);
-    static TailpatchProc RecoverFromTailpatch(emuptr oldpc);
+    static TailpatchProc RecoverFromTailpatch(emuptr oldpc, SystemCallContext& context);
 
-    static EmPatchModule* patchModuleSys;
-    static EmPatchModule* patchModuleHtal;
-    static EmPatchModule* patchModuleNetlib;
-    static EmPatchModule* patchModuleClieStubAll;
+    static EM_THREAD_LOCAL EmPatchModule* patchModuleSys;
+    static EM_THREAD_LOCAL EmPatchModule* patchModuleHtal;
+    static EM_THREAD_LOCAL EmPatchModule* patchModuleNetlib;
+    static EM_THREAD_LOCAL EmPatchModule* patchModuleClieStubAll;
+
+    static const EmSessionState sessionState;
 };
 
 #endif /* EmPatchMgr_h */
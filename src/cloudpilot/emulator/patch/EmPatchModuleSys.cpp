@@ -41,7 +41,7 @@ namespace {
         // called SysSemaphoreWait instead.  See our headpatch of that function
         // for a chunk of pretty similar code.
 
-        if (gSystemState.OSMajorVersion() == 1) {
+        if (gSystemState->OSMajorVersion() == 1) {
             return kExecuteROM;
         }
 
@@ -66,7 +66,7 @@ namespace {
         // calls SysEvGroupWait instead.  See our headpatch of that function
         // for a chunk of pretty similar code.
 
-        if (gSystemState.OSMajorVersion() != 1) {
+        if (gSystemState->OSMajorVersion() != 1) {
             return kExecuteROM;
         }
 
@@ -115,7 +115,7 @@ namespace {
     }
 
     CallROMType HeadpatchSysUIAppSwitch() {
-        gSystemState.SetSetupComplete();
+        gSystemState->SetSetupComplete();
 
         return kExecuteROM;
     }
@@ -250,10 +250,10 @@ namespace {
         Err err = ::FtrGet(sysFtrCreator, sysFtrNumROMVersion, &value);
 
         if (err == errNone) {
-            gSystemState.SetOSVersion(value);
+            gSystemState->SetOSVersion(value);
 
-            PRINTF("PalmOS version: %u.%u", gSystemState.OSMajorVersion(),
-                   gSystemState.OSMinorVersion());
+            PRINTF("PalmOS version: %u.%u", gSystemState->OSMajorVersion(),
+                   gSystemState->OSMinorVersion());
         } else {
             // EmSystemState::SetOSVersion(kOSUndeterminedVersion);
             PRINTF("vailed to determine PalmOS version");
@@ -311,11 +311,11 @@ namespace {
         }
 #endif
 
-        SetHotSyncUserName(gSystemState.GetHotsyncUserName().c_str());
+        SetHotSyncUserName(gSystemState->GetHotsyncUserName().c_str());
 
-        gSystemState.SetUIInitialized();
+        gSystemState->SetUIInitialized();
 
-        gNetworkProxy.Reset();
+        gNetworkProxy->Reset();
 
         PRINTF("syscall: UIInitialize");
     }
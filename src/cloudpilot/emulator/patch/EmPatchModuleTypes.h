@@ -21,7 +21,11 @@ class EmPatchModule;
 
 enum { kPatchErrNone, kPatchErrNotImplemented, kPatchErrInvalidIndex };
 
-enum CallROMType { kExecuteROM, kSkipROM };
+// kRestartCall: the call blocks and has not completed yet. The CPU is rewound
+// to the system call and dozes until the next interrupt; the call is executed
+// again once it wakes up.
+
+enum CallROMType { kExecuteROM, kSkipROM, kRestartCall };
 
 // Function types for head- and Tailpatch functions.
 
@@ -133,7 +133,7 @@ namespace {
     }
 
     const char* decodeCreator(uint32 creator) {
-        static char buf[5];
+        static EM_THREAD_LOCAL char buf[5];
 
         buf[0] = creator >> 24;
         buf[1] = (creator >> 16) & 0xff;
@@ -156,7 +156,7 @@ namespace {
             *netIFErrP = 0;
             CALLED_PUT_PARAM_REF(netIFErrP);
 
-            gNetworkProxy.Open();
+            gNetworkProxy->Open();
 
             return kSkipROM;
         }
@@ -170,7 +170,7 @@ namespace {
         CALLED_SETUP("Err", "UInt16 libRefNum, UInt16 immediate");
 
         if (Feature::GetNetworkRedirection()) {
-            gNetworkProxy.Close();
+            gNetworkProxy->Close();
 
             return kSkipROM;
         }
@@ -233,9 +233,9 @@ namespace {
         CALLED_GET_PARAM_REF(Err, errP, Marshal::kOutput);
 
         if (Feature::GetNetworkRedirection()) {
-            gNetworkProxy.SocketOpen(domain, type, protocol);
+            gNetworkProxy->SocketOpen(domain, type, protocol);
 
-            return kSkipROM;
+            return gNetworkProxy->CallResult();
         }
 
         return kExecuteROM;
@@ -252,9 +252,9 @@ namespace {
         CALLED_GET_PARAM_REF(Err, errP, Marshal::kOutput);
 
         if (Feature::GetNetworkRedirection()) {
-            gNetworkProxy.SocketClose(socket, timeout);
+            gNetworkProxy->SocketClose(socket, timeout);
 
-            return kSkipROM;
+            return gNetworkProxy->CallResult();
         }
 
         return kExecuteROM;
@@ -279,9 +279,9 @@ namespace {
         PRINTF("\nNetLibSocketOptionSet, option = 0x%04x", option);
 
         if (Feature::GetNetworkRedirection()) {
-            gNetworkProxy.SocketOptionSet(socket, level, option, optValueP, optValueLen, timeout);
+            gNetworkProxy->SocketOptionSet(socket, level, option, optValueP, optValueLen, timeout);
 
-            return kSkipROM;
+            return gNetworkProxy->CallResult();
         }
 
         return kExecuteROM;
@@ -306,9 +306,9 @@ namespace {
         CALLED_GET_PARAM_PTR(void, optValueP, *optValueLenP, Marshal::kOutput);
 
         if (Feature::GetNetworkRedirection()) {
-            gNetworkProxy.SocketOptionGet(socket, level, option, timeout);
+            gNetworkProxy->SocketOptionGet(socket, level, option, timeout);
 
-            return kSkipROM;
+            return gNetworkProxy->CallResult();
         }
 
         return kExecuteROM;
@@ -327,9 +327,9 @@ namespace {
             CALLED_GET_PARAM_REF(NetSocketAddrType, sockAddrP, Marshal::kInput);
             CALLED_GET_PARAM_VAL(Int32, timeout);
 
-            gNetworkProxy.SocketBind(socket, sockAddrP, timeout);
+            gNetworkProxy->SocketBind(socket, sockAddrP, timeout);
 
-            return kSkipROM;
+            return gNetworkProxy->CallResult();
         }
 
         return kExecuteROM;
@@ -351,9 +351,9 @@ namespace {
         CALLED_GET_PARAM_REF(Err, errP, Marshal::kOutput);
 
         if (Feature::GetNetworkRedirection()) {
-            gNetworkProxy.SocketConnect(socket, sockAddrP, addrLen, timeout);
+            gNetworkProxy->SocketConnect(socket, sockAddrP, addrLen, timeout);
 
-            return kSkipROM;
+            return gNetworkProxy->CallResult();
         }
 
         return kExecuteROM;
@@ -373,9 +373,9 @@ namespace {
         CALLED_GET_PARAM_REF(Err, errP, Marshal::kOutput);
 
         if (Feature::GetNetworkRedirection()) {
-            gNetworkProxy.SocketListen(socket, timeout);
+            gNetworkProxy->SocketListen(socket, timeout);
 
-            return kSkipROM;
+            return gNetworkProxy->CallResult();
         }
 
         return kExecuteROM;
@@ -397,9 +397,9 @@ namespace {
         CALLED_GET_PARAM_REF(Err, errP, Marshal::kOutput);
 
         if (Feature::GetNetworkRedirection()) {
-            gNetworkProxy.SocketAccept(socket, timeout);
+            gNetworkProxy->SocketAccept(socket, timeout);
 
-            return kSkipROM;
+            return gNetworkProxy->CallResult();
         }
 
         return kExecuteROM;
@@ -436,9 +436,9 @@ namespace {
         CALLED_GET_PARAM_REF(Err, errP, Marshal::kOutput);
 
         if (Feature::GetNetworkRedirection()) {
-            gNetworkProxy.SocketSendPB(socket, pbP, flags, timeout);
+            gNetworkProxy->SocketSendPB(socket, pbP, flags, timeout);
 
-            return kSkipROM;
+            return gNetworkProxy->CallResult();
         }
 
         return kExecuteROM;
@@ -464,9 +464,9 @@ namespace {
         if (Feature::GetNetworkRedirection()) {
             CALLED_GET_PARAM_PTR(uint8, bufP, bufLen, Marshal::kInput);
 
-            gNetworkProxy.SocketSend(socket, bufP, bufLen, flags, toAddrP, toLen, timeout);
+            gNetworkProxy->SocketSend(socket, bufP, bufLen, flags, toAddrP, toLen, timeout);
 
-            return kSkipROM;
+            return gNetworkProxy->CallResult();
         }
 
         return kExecuteROM;
@@ -487,9 +487,9 @@ namespace {
         CALLED_GET_PARAM_REF(Err, errP, Marshal::kOutput);
 
         if (Feature::GetNetworkRedirection()) {
-            gNetworkProxy.SocketReceivePB(socket, pbP, flags, timeout);
+            gNetworkProxy->SocketReceivePB(socket, pbP, flags, timeout);
 
-            return kSkipROM;
+            return gNetworkProxy->CallResult();
         }
 
         return kExecuteROM;
@@ -514,9 +514,9 @@ namespace {
                (long)fromAddrP, *fromLenP);
 
         if (Feature::GetNetworkRedirection()) {
-            gNetworkProxy.SocketReceive(socket, flags, bufLen, timeout, fromAddrP);
+            gNetworkProxy->SocketReceive(socket, flags, bufLen, timeout, fromAddrP);
 
-            return kSkipROM;
+            return gNetworkProxy->CallResult();
         }
 
         return kExecuteROM;
@@ -541,9 +541,9 @@ namespace {
         CALLED_GET_PARAM_REF(Err, errP, Marshal::kOutput);
 
         if (Feature::GetNetworkRedirection()) {
-            gNetworkProxy.SocketDmReceive(socket, flags, rcvLen, timeout, fromAddrP);
+            gNetworkProxy->SocketDmReceive(socket, flags, rcvLen, timeout, fromAddrP);
 
-            return kSkipROM;
+            return gNetworkProxy->CallResult();
         }
 
         return kExecuteROM;
@@ -566,9 +566,9 @@ namespace {
         CALLED_GET_PARAM_REF(Err, errP, Marshal::kOutput);
 
         if (Feature::GetNetworkRedirection()) {
-            gNetworkProxy.Select(width, *readFDs, *writeFDs, *exceptFDs, timeout);
+            gNetworkProxy->Select(width, *readFDs, *writeFDs, *exceptFDs, timeout);
 
-            return kSkipROM;
+            return gNetworkProxy->CallResult();
         }
 
         return kExecuteROM;
@@ -598,9 +598,9 @@ namespace {
         CALLED_GET_PARAM_REF(Err, errP, Marshal::kOutput);
 
         if (Feature::GetNetworkRedirection()) {
-            gNetworkProxy.GetHostByName(string(nameP));
+            gNetworkProxy->GetHostByName(string(nameP));
 
-            return kSkipROM;
+            return gNetworkProxy->CallResult();
         }
 
         return kExecuteROM;
@@ -615,7 +615,8 @@ namespace {
 
         PRINTF("\nNetLibSettingGet, setting = 0x%04x", setting);
 
-        if (Feature::GetNetworkRedirection() && gNetworkProxy.SettingGet(setting)) return kSkipROM;
+        if (Feature::GetNetworkRedirection() && gNetworkProxy->SettingGet(setting))
+            return gNetworkProxy->CallResult();
 
         return kExecuteROM;
     }
@@ -794,9 +795,9 @@ namespace {
         CALLED_GET_PARAM_REF(Err, errP, Marshal::kOutput);
 
         if (Feature::GetNetworkRedirection()) {
-            gNetworkProxy.GetServByName(string(servNameP), string(protoNameP));
+            gNetworkProxy->GetServByName(string(servNameP), string(protoNameP));
 
-            return kSkipROM;
+            return gNetworkProxy->CallResult();
         }
 
         return kExecuteROM;
@@ -821,9 +822,10 @@ namespace {
         CALLED_GET_PARAM_REF(Err, errP, Marshal::kOutput);
 
         if (Feature::GetNetworkRedirection()) {
-            gNetworkProxy.SocketAddr(socket, locAddrP, locAddrLenP, remAddrP, remAddrLenP, timeout);
+            gNetworkProxy->SocketAddr(socket, locAddrP, locAddrLenP, remAddrP, remAddrLenP,
+                                      timeout);
 
-            return kSkipROM;
+            return gNetworkProxy->CallResult();
         }
 
         return kExecuteROM;
@@ -858,7 +860,7 @@ namespace {
         if (Feature::GetNetworkRedirection()) {
             CALLED_GET_PARAM_REF(UInt16, countP, Marshal::kOutput);
 
-            *countP = gNetworkProxy.OpenCount();
+            *countP = gNetworkProxy->OpenCount();
 
             CALLED_PUT_PARAM_REF(countP);
             PUT_RESULT_VAL(Err, 0);
@@ -952,7 +954,7 @@ namespace {
             *netIFErrP = 0;
             CALLED_PUT_PARAM_REF(netIFErrP);
 
-            gNetworkProxy.Open();
+            gNetworkProxy->Open();
 
             return kSkipROM;
         }
@@ -0,0 +1,201 @@
+#include "SyscallProfiler.h"
+
+#include <algorithm>
+#include <iomanip>
+
+#include "DecodeSyscalls.h"
+#include "EmPalmFunction.h"
+#include "EmSessionContext.h"
+#include "EmStructs.h"
+#include "Miscellaneous.h"
+
+namespace {
+    const char* LIB_TRAP_NAMES[] = {"Name", "Open", "Close", "Sleep", "Wake"};
+
+    uint32 keyForContext(const SystemCallContext& context) {
+        // System traps and library traps occupy disjoint ranges, so library
+        // calls can be told apart by tagging them with their refnum.
+        return ::IsSystemTrap(context.fTrapWord)
+                   ? context.fTrapWord
+                   : ((context.fExtra & 0xffff) << 16) | context.fTrapWord;
+    }
+
+    string nameForContext(const SystemCallContext& context) {
+        if (::IsSystemTrap(context.fTrapWord)) return trapWordToString(context.fTrapWord);
+
+        const uint16 refNum = context.fExtra;
+
+        string libName = GetLibraryName(refNum);
+        if (libName.empty()) libName = "refNum " + to_string(refNum);
+
+        return libName + ":" +
+               (context.fTrapIndex < sizeof(LIB_TRAP_NAMES) / sizeof(LIB_TRAP_NAMES[0])
+                    ? LIB_TRAP_NAMES[context.fTrapIndex]
+                    : to_string(context.fTrapIndex));
+    }
+
+    string escapeJson(const string& str) {
+        string escaped;
+
+        for (char c : str) {
+            if (c == '"' || c == '\\') escaped.push_back('\\');
+            escaped.push_back(c);
+        }
+
+        return escaped;
+    }
+
+    string escapeCsv(const string& str) {
+        if (str.find_first_of(",\"") == string::npos) return str;
+
+        string escaped = "\"";
+
+        for (char c : str) {
+            if (c == '"') escaped.push_back('"');
+            escaped.push_back(c);
+        }
+
+        return escaped + "\"";
+    }
+
+    thread_local SyscallProfiler syscallProfiler;
+}  // namespace
+
+thread_local SyscallProfiler* gSyscallProfiler{&syscallProfiler};
+
+namespace {
+    const EmSessionState sessionState{EM_SESSION_OBJECT(gSyscallProfiler)};
+}  // namespace
+
+void SyscallProfiler::Start() { running = true; }
+
+void SyscallProfiler::Stop() { running = false; }
+
+void SyscallProfiler::Clear() {
+    stats.clear();
+
+    // Calls that are still pending belong to the old profile.
+    generation++;
+}
+
+void SyscallProfiler::RecordCall(const SystemCallContext& context, uint64 cycles, bool returns) {
+    Stats& entry = GetEntry(context);
+    entry.calls++;
+
+    if (!returns) return;
+
+    if (pendingCalls.size() >= MAX_PENDING_CALLS) pendingCalls.erase(pendingCalls.begin());
+
+    pendingCalls.push_back({keyForContext(context), context.fNextPC, cycles, generation});
+}
+
+void SyscallProfiler::RecordHeadpatch(const SystemCallContext& context, uint64 nsec) {
+    Stats& entry = GetEntry(context);
+
+    entry.headpatchCalls++;
+    entry.headpatchNsec += nsec;
+}
+
+void SyscallProfiler::RecordTailpatch(const SystemCallContext& context, uint64 nsec) {
+    Stats& entry = GetEntry(context);
+
+    entry.tailpatchCalls++;
+    entry.tailpatchNsec += nsec;
+}
+
+bool SyscallProfiler::RecordReturn(emuptr pc, uint64 cycles) {
+    auto call = find_if(pendingCalls.rbegin(), pendingCalls.rend(),
+                        [=](const PendingCall& call) { return call.returnAddress == pc; });
+
+    if (call == pendingCalls.rend()) return false;
+
+    // The cycle count jumps backwards if a savestate is loaded or the session
+    // is rewound; there is no sensible duration in this case.
+    if (call->generation == generation && cycles >= call->cycles) {
+        auto entry = stats.find(call->key);
+        if (entry != stats.end()) entry->second.inclusiveCycles += cycles - call->cycles;
+    }
+
+    pendingCalls.erase(call.base() - 1, pendingCalls.end());
+
+    return true;
+}
+
+bool SyscallProfiler::IsReturnAddress(emuptr pc) const {
+    return find_if(pendingCalls.begin(), pendingCalls.end(), [=](const PendingCall& call) {
+               return call.returnAddress == pc;
+           }) != pendingCalls.end();
+}
+
+vector<emuptr> SyscallProfiler::GetReturnAddresses() const {
+    vector<emuptr> returnAddresses;
+
+    for (auto& call : pendingCalls) returnAddresses.push_back(call.returnAddress);
+
+    return returnAddresses;
+}
+
+void SyscallProfiler::DiscardPendingCalls() { pendingCalls.clear(); }
+
+vector<SyscallProfiler::Stats> SyscallProfiler::GetStats() const {
+    vector<Stats> result;
+    result.reserve(stats.size());
+
+    for (auto& [key, entry] : stats) result.push_back(entry);
+
+    sort(result.begin(), result.end(), [](const Stats& s1, const Stats& s2) {
+        if (s1.inclusiveCycles != s2.inclusiveCycles)
+            return s1.inclusiveCycles > s2.inclusiveCycles;
+
+        return s1.calls != s2.calls ? s1.calls > s2.calls : s1.name < s2.name;
+    });
+
+    return result;
+}
+
+void SyscallProfiler::WriteCsv(ostream& stream) const {
+    stream << "name,trap,calls,inclusive cycles,headpatch calls,headpatch nsec,tailpatch calls,"
+              "tailpatch nsec"
+           << endl;
+
+    for (auto& entry : GetStats()) {
+        stream << escapeCsv(entry.name) << ",0x" << hex << setw(4) << setfill('0')
+               << entry.trapWord << dec << setfill(' ') << "," << entry.calls << ","
+               << entry.inclusiveCycles << "," << entry.headpatchCalls << ","
+               << entry.headpatchNsec << "," << entry.tailpatchCalls << ","
+               << entry.tailpatchNsec << endl;
+    }
+}
+
+void SyscallProfiler::WriteJson(ostream& stream) const {
+    const auto entries = GetStats();
+
+    stream << "[";
+
+    for (size_t i = 0; i < entries.size(); i++) {
+        const Stats& entry = entries[i];
+
+        stream << (i > 0 ? "," : "") << endl
+               << "  {\"name\": \"" << escapeJson(entry.name) << "\", \"trap\": "
+               << entry.trapWord << ", \"calls\": " << entry.calls
+               << ", \"inclusiveCycles\": " << entry.inclusiveCycles
+               << ", \"headpatchCalls\": " << entry.headpatchCalls
+               << ", \"headpatchNsec\": " << entry.headpatchNsec
+               << ", \"tailpatchCalls\": " << entry.tailpatchCalls
+               << ", \"tailpatchNsec\": " << entry.tailpatchNsec << "}";
+    }
+
+    stream << endl << "]" << endl;
+}
+
+SyscallProfiler::Stats& SyscallProfiler::GetEntry(const SystemCallContext& context) {
+    auto [entry, inserted] = stats.try_emplace(keyForContext(context));
+
+    if (inserted) {
+        entry->second = {};
+        entry->second.name = nameForContext(context);
+        entry->second.trapWord = context.fTrapWord;
+    }
+
+    return entry->second;
+}
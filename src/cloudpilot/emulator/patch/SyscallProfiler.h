@@ -0,0 +1,99 @@
+#ifndef _SYSCALL_PROFILER_H_
+#define _SYSCALL_PROFILER_H_
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "EmCommon.h"
+
+struct SystemCallContext;
+
+// Collects per trap statistics on the system and library calls dispatched
+// through EmPatchMgr: the number of calls, the emulated cycles spent between
+// the trap and the return to the caller (inclusive of nested calls) and the
+// host time spent in head- and tailpatches.
+//
+// In order to catch the return, EmPatchMgr places an instruction break on
+// the return address of each pending call. Calls that never return (because
+// of ErrThrow or an app switch) are dropped once an outer call returns or
+// once more than MAX_PENDING_CALLS are pending.
+
+class SyscallProfiler {
+   public:
+    static constexpr size_t MAX_PENDING_CALLS = 64;
+
+    struct Stats {
+        string name;
+        uint16 trapWord;
+
+        uint64 calls;
+        uint64 inclusiveCycles;
+
+        uint64 headpatchCalls;
+        uint64 headpatchNsec;
+        uint64 tailpatchCalls;
+        uint64 tailpatchNsec;
+    };
+
+   public:
+    SyscallProfiler() = default;
+
+    void Start();
+    void Stop();
+    void Clear();
+
+    bool IsRunning() const { return running; }
+
+    // Record a call at the given cycle count. If `returns` is set, the call
+    // is executed by the ROM and remains pending until RecordReturn.
+    void RecordCall(const SystemCallContext& context, uint64 cycles, bool returns);
+
+    void RecordHeadpatch(const SystemCallContext& context, uint64 nsec);
+    void RecordTailpatch(const SystemCallContext& context, uint64 nsec);
+
+    // Completes the innermost pending call that returns to `pc`, together
+    // with all calls nested within it. Returns false if there is none.
+    bool RecordReturn(emuptr pc, uint64 cycles);
+
+    bool IsReturnAddress(emuptr pc) const;
+    vector<emuptr> GetReturnAddresses() const;
+
+    // Forget about pending calls, for example after a reset.
+    void DiscardPendingCalls();
+
+    // Statistics, by inclusive cycles in descending order.
+    vector<Stats> GetStats() const;
+
+    void WriteCsv(ostream& stream) const;
+    void WriteJson(ostream& stream) const;
+
+   private:
+    struct PendingCall {
+        uint32 key;
+        emuptr returnAddress;
+        uint64 cycles;
+        uint32 generation;
+    };
+
+   private:
+    Stats& GetEntry(const SystemCallContext& context);
+
+   private:
+    bool running{false};
+    uint32 generation{0};
+
+    unordered_map<uint32, Stats> stats;
+    vector<PendingCall> pendingCalls;
+
+   private:
+    SyscallProfiler(const SyscallProfiler&) = delete;
+    SyscallProfiler(SyscallProfiler&&) = delete;
+    SyscallProfiler& operator=(const SyscallProfiler&) = delete;
+    SyscallProfiler& operator=(SyscallProfiler&&) = delete;
+};
+
+extern thread_local SyscallProfiler* gSyscallProfiler;
+
+#endif  // _SYSCALL_PROFILER_H_
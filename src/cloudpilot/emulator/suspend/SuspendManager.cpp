@@ -1,8 +1,11 @@
 #include "SuspendManager.h"
 
+#include "EmSessionContext.h"
 #include "SuspendContext.h"
 
-SuspendContext* SuspendManager::context{nullptr};
+EM_THREAD_LOCAL SuspendContext* SuspendManager::context{nullptr};
+
+const EmSessionState SuspendManager::sessionState{EM_SESSION_VARIABLE(context)};
 
 SuspendContext& SuspendManager::GetContext() { return *context; }
 
@@ -4,6 +4,7 @@
 #include "EmCommon.h"
 
 class SuspendContext;
+class EmSessionState;
 
 class SuspendManager {
     friend SuspendContext;
@@ -22,7 +23,9 @@ class SuspendManager {
     static void Resume();
 
    private:
-    static SuspendContext* context;
+    static EM_THREAD_LOCAL SuspendContext* context;
+
+    static const EmSessionState sessionState;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
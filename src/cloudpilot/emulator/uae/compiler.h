@@ -12,10 +12,10 @@ extern "C" {
 
 extern int Software_ProcessJSR_Ind (uaecptr oldpc, uaecptr dest);
 
-extern uae_u32	gStackHigh;
-extern uae_u32	gStackLowWarn;
-extern uae_u32	gStackLow;
-extern uae_u32	gKernelStackOverflowed;
+extern EM_THREAD_LOCAL uae_u32	gStackHigh;
+extern EM_THREAD_LOCAL uae_u32	gStackLowWarn;
+extern EM_THREAD_LOCAL uae_u32	gStackLow;
+extern EM_THREAD_LOCAL uae_u32	gKernelStackOverflowed;
 
 #define CHECK_STACK_POINTER_ASSIGNMENT() {}
 
@@ -18,7 +18,7 @@ struct flag_struct {
     unsigned int x;
 };
 
-extern struct flag_struct regflags;
+extern EM_THREAD_LOCAL struct flag_struct regflags;
 
 #define ZFLG (regflags.z)
 #define NFLG (regflags.n)
@@ -0,0 +1,254 @@
+#include "Benchmark.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "DbInstaller.h"
+#include "EmCPU68K.h"
+#include "EmLowMem.h"
+#include "EmPalmOS.h"
+#include "EmSession.h"
+#include "EmSystemState.h"
+#include "ROMStubs.h"
+#include "json/ArduinoJson.h"
+#include "util.h"
+
+using namespace std;
+
+namespace {
+    // The boot and launch phases end once the UI thread is idle in EvtGetEvent,
+    // which is checked after each slice.
+    constexpr uint32 SLICE_CYCLES = 10000;
+
+    constexpr size_t JSON_DOCUMENT_SIZE = 4096;
+
+    struct Phase {
+        string name;
+        bool success;
+        uint64 cycles;
+        uint64 instructions;
+        double wallSeconds;
+        optional<string> app;
+    };
+
+    uint64 instructionCount() { return gCPU68K ? gCPU68K->GetInstructionCount() : 0; }
+
+    uint64 timeoutCycles(const BenchmarkConfiguration& configuration) {
+        return static_cast<uint64>(configuration.timeoutSeconds * gSession->GetClocksPerSecond());
+    }
+
+    optional<LocalID> currentApp() {
+        UInt16 cardNo;
+        LocalID dbId;
+
+        if (!gSystemState->IsUIInitialized() || gSession->IsCpuStopped() ||
+            SysCurAppDatabase(&cardNo, &dbId) != errNone)
+            return nullopt;
+
+        return dbId;
+    }
+
+    optional<string> currentAppName() {
+        optional<LocalID> dbId = currentApp();
+        Char name[dmDBNameLength]{};
+
+        if (!dbId || DmDatabaseInfo(0, *dbId, name, nullptr, nullptr, nullptr, nullptr, nullptr,
+                                    nullptr, nullptr, nullptr, nullptr, nullptr) != errNone)
+            return nullopt;
+
+        return string(name);
+    }
+
+    Phase measure(const string& name, function<bool()> body) {
+        const uint64 cyclesBefore = gSession->GetSystemCycles();
+        const uint64 instructionsBefore = instructionCount();
+        const auto timestampStart = chrono::steady_clock::now();
+
+        const bool success = body();
+
+        return {
+            .name = name,
+            .success = success,
+            .cycles = gSession->GetSystemCycles() - cyclesBefore,
+            .instructions = instructionCount() - instructionsBefore,
+            .wallSeconds =
+                chrono::duration<double>(chrono::steady_clock::now() - timestampStart).count(),
+            .app = currentAppName()};
+    }
+
+    bool runUntil(function<bool()> condition, uint64 maxCycles) {
+        const uint64 cyclesStart = gSession->GetSystemCycles();
+
+        while (!condition()) {
+            if (gSession->GetSystemCycles() - cyclesStart >= maxCycles) return false;
+
+            gSession->RunEmulation(SLICE_CYCLES);
+        }
+
+        return true;
+    }
+
+    bool isIdle() { return EmLowMem::GetEvtMgrIdle(); }
+
+    // Installation and launch require the CPU to be running. A stopped CPU is
+    // woken by the next interrupt, so this usually takes a single slice.
+    bool waitForCpu(const BenchmarkConfiguration& configuration) {
+        return runUntil([]() { return !gSession->IsCpuStopped(); }, timeoutCycles(configuration));
+    }
+
+    bool boot(const BenchmarkConfiguration& configuration) {
+        return runUntil([]() { return gSystemState->IsUIInitialized() && isIdle(); },
+                        timeoutCycles(configuration));
+    }
+
+    // The installer calls into PalmOS from the host. These calls do not advance
+    // emulated time, so the phase executes instructions but no cycles.
+    bool install(const vector<uint8>& database, const BenchmarkConfiguration& configuration) {
+        if (!waitForCpu(configuration)) return false;
+
+        vector<uint8> buffer(database);
+        const DbInstaller::Result result = DbInstaller::Install(buffer.size(), buffer.data());
+
+        return result == DbInstaller::Result::success ||
+               result == DbInstaller::Result::needsReboot;
+    }
+
+    // SysUIAppSwitch only asks the current app to quit, so the launch is complete
+    // once the new app is current and has reached its event loop. The setup app
+    // that runs after a cold boot ignores the request.
+    bool launch(const string& name, const BenchmarkConfiguration& configuration) {
+        if (!gSystemState->IsSetupComplete()) {
+            cerr << "unable to launch " << name << ": device setup has not been completed" << endl;
+            return false;
+        }
+
+        if (!waitForCpu(configuration)) return false;
+
+        const LocalID dbId = DmFindDatabase(0, name.c_str());
+        if (dbId == 0 || !gSession->LaunchAppByName(name)) return false;
+
+        return runUntil(
+            [=]() {
+                return !EmPalmOS::HasPendingAppForLaunch() && isIdle() && currentApp() == dbId;
+            },
+            timeoutCycles(configuration));
+    }
+
+    // The database name is stored as a zero terminated string in the first 32
+    // bytes of the PDB / PRC header.
+    optional<string> databaseName(const vector<uint8>& database) {
+        if (database.size() < dmDBNameLength) return nullopt;
+
+        const char* name = reinterpret_cast<const char*>(database.data());
+        if (strnlen(name, dmDBNameLength) == dmDBNameLength) return nullopt;
+
+        return string(name);
+    }
+
+    bool writeReport(const string& image, const vector<Phase>& phases,
+                     const BenchmarkConfiguration& configuration) {
+        ArduinoJson::StaticJsonDocument<JSON_DOCUMENT_SIZE> report;
+
+        report["image"] = image;
+        report["device"] = gSession->GetDevice().GetIDString();
+        report["clocksPerSecond"] = gSession->GetClocksPerSecond();
+        report["uiInitialized"] = gSystemState->IsUIInitialized();
+        report["setupComplete"] = gSystemState->IsSetupComplete();
+
+        ArduinoJson::JsonArray reportPhases = report.createNestedArray("phases");
+        bool success = true;
+
+        for (auto& phase : phases) {
+            ArduinoJson::JsonObject reportPhase = reportPhases.createNestedObject();
+
+            reportPhase["name"] = phase.name;
+            reportPhase["success"] = phase.success;
+            reportPhase["cycles"] = phase.cycles;
+            reportPhase["instructions"] = phase.instructions;
+            reportPhase["emulatedSeconds"] =
+                static_cast<double>(phase.cycles) / gSession->GetClocksPerSecond();
+            reportPhase["wallSeconds"] = phase.wallSeconds;
+            reportPhase["mips"] =
+                phase.wallSeconds > 0 ? phase.instructions / phase.wallSeconds / 1e6 : 0;
+            if (phase.app) reportPhase["app"] = *phase.app;
+
+            success = success && phase.success;
+        }
+
+        report["success"] = success;
+
+        if (configuration.outputFile == "-") {
+            ArduinoJson::serializeJsonPretty(report, cout);
+            cout << endl << flush;
+
+            return true;
+        }
+
+        ofstream stream(configuration.outputFile);
+        ArduinoJson::serializeJsonPretty(report, stream);
+        stream << endl;
+
+        if (stream.fail()) {
+            cerr << "unable to write " << configuration.outputFile << endl;
+            return false;
+        }
+
+        return true;
+    }
+}  // namespace
+
+int runBenchmark(const string& image, optional<string> deviceId,
+                 const BenchmarkConfiguration& configuration) {
+    vector<uint8> database;
+    optional<string> launchApp = configuration.launchApp;
+
+    if (configuration.installFile) {
+        unique_ptr<uint8[]> buffer;
+        size_t len;
+
+        if (!util::readFile(*configuration.installFile, buffer, len)) {
+            cerr << "unable to open " << *configuration.installFile << endl;
+            return 1;
+        }
+
+        database.assign(buffer.get(), buffer.get() + len);
+
+        if (!launchApp) launchApp = databaseName(database);
+    }
+
+    vector<Phase> phases;
+
+    // Initialization does not execute any emulated code, but it is part of a
+    // cold start and thus reported as a phase of its own. Loading a session
+    // image restores the cycle counter, so it must not be included in the
+    // cycles of the boot phase.
+    const auto timestampStart = chrono::steady_clock::now();
+
+    if (!(deviceId ? util::initializeSession(image, *deviceId) : util::initializeSession(image)))
+        return 1;
+
+    phases.push_back(
+        {.name = "initialize",
+         .success = true,
+         .cycles = 0,
+         .instructions = 0,
+         .wallSeconds =
+             chrono::duration<double>(chrono::steady_clock::now() - timestampStart).count()});
+
+    phases.push_back(measure("boot", [&]() { return boot(configuration); }));
+
+    if (phases.back().success && configuration.installFile)
+        phases.push_back(measure("install", [&]() { return install(database, configuration); }));
+
+    if (phases.back().success && launchApp)
+        phases.push_back(measure("launch", [&]() { return launch(*launchApp, configuration); }));
+
+    if (!writeReport(image, phases, configuration)) return 1;
+
+    return phases.back().success ? 0 : 1;
+}
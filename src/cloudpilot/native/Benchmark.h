@@ -0,0 +1,23 @@
+#ifndef _BENCHMARK_H_
+#define _BENCHMARK_H_
+
+#include <optional>
+#include <string>
+
+#include "EmCommon.h"
+
+struct BenchmarkConfiguration {
+    string outputFile;
+    optional<string> installFile;
+    optional<string> launchApp;
+    double timeoutSeconds;
+};
+
+// Headless end-to-end benchmark: boot the image to the launcher, optionally
+// install a database and launch an app, and write emulated cycles, host wall
+// time and MIPS for each phase as JSON to outputFile ("-" for stdout).
+// Emulation runs as fast as possible. Returns the exit code for main.
+int runBenchmark(const string& image, optional<string> deviceId,
+                 const BenchmarkConfiguration& configuration);
+
+#endif  // _BENCHMARK_H_
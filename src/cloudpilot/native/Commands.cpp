@@ -3,6 +3,7 @@
 #include <cstring>
 #include <fstream>
 #include <iomanip>
+#include <optional>
 #include <sstream>
 #include <unordered_map>
 
@@ -10,6 +11,7 @@
 #include "DbInstaller.h"
 #include "DebugSupport.h"
 #include "Debugger.h"
+#include "DeltaSnapshot.h"
 #include "EmBankSRAM.h"
 #include "EmCommon.h"
 #include "EmErrCodes.h"
@@ -17,14 +19,39 @@
 #include "EmMemory.h"
 #include "EmSession.h"
 #include "ExternalStorage.h"
+#include "InterruptTracer.h"
+#include "Miscellaneous.h"
+#include "Platform.h"
+#include "Profiler.h"
+#include "Recording.h"
 #include "SessionImage.h"
+#include "SessionStats.h"
 #include "StackDump.h"
+#include "SyscallProfiler.h"
+#include "Turbo.h"
 #include "ZipfileWalker.h"
 #include "md5.h"
 #include "util.h"
 using namespace std;
 
 namespace {
+    Recording recording;
+    optional<SessionStats::Snapshot> lastStats;
+
+    class StreamSink : public SessionImageSink {
+       public:
+        explicit StreamSink(ostream& stream) : stream(stream) {}
+
+        bool Write(const void* data, size_t size) override {
+            stream.write(static_cast<const char*>(data), size);
+
+            return !stream.fail();
+        }
+
+       private:
+        ostream& stream;
+    };
+
     string translateInstallResult(DbInstaller::Result result) {
         switch (result) {
             case DbInstaller::Result::success:
@@ -90,12 +117,6 @@ namespace {
     void SaveImage(string file) {
         EmAssert(gSession);
 
-        SessionImage image;
-        if (!gSession->SaveImage(image)) {
-            cout << "failed to serialize session image" << endl << flush;
-            return;
-        }
-
         fstream stream(file, ios_base::out);
 
         if (stream.fail()) {
@@ -103,10 +124,14 @@ namespace {
             return;
         }
 
-        stream.write((const char*)image.GetSerializedImage(), image.GetSerializedImageSize());
+        SessionImage image;
+        StreamSink sink(stream);
 
-        if (stream.fail()) {
-            cout << "I/O error writing " << file << endl << flush;
+        if (!gSession->SaveImage(image, sink)) {
+            cout << (stream.fail() ? "I/O error writing " + file
+                                   : "failed to serialize session image")
+                 << endl
+                 << flush;
         }
     }
 
@@ -173,7 +198,7 @@ namespace {
         EmHAL::Slot slot = util::mountedSlot();
         if (slot == EmHAL::Slot::none) return false;
 
-        auto image = gExternalStorage.GetImageInSlot(slot);
+        auto image = gExternalStorage->GetImageInSlot(slot);
 
         fstream stream(file, ios_base::out);
 
@@ -219,13 +244,13 @@ namespace {
         cout << "saving session image to '" << args[0] << "'" << endl << flush;
 
         if (slot != EmHAL::Slot::none) {
-            CardImage* cardImage = gExternalStorage.GetImageInSlot(slot);
+            CardImage* cardImage = gExternalStorage->GetImageInSlot(slot);
 
-            const string oldKey = gExternalStorage.GetImageKeyInSlot(slot);
+            const string oldKey = gExternalStorage->GetImageKeyInSlot(slot);
             const string newKey =
                 md5(cardImage->RawData(), CardImage::BLOCK_SIZE * cardImage->BlocksTotal());
 
-            gExternalStorage.RekeyImage(oldKey, newKey);
+            gExternalStorage->RekeyImage(oldKey, newKey);
         }
 
         if (args.size() == 2) {
@@ -274,7 +299,7 @@ namespace {
             return;
         }
 
-        gExternalStorage.Clear();
+        gExternalStorage->Clear();
         util::initializeSession(args[0]);
 
         context.GetGdbStub().ClearRelocationOffset();
@@ -309,7 +334,7 @@ namespace {
             return;
         }
 
-        if (gExternalStorage.RemoveImage(gExternalStorage.GetImageKeyInSlot(slot)))
+        if (gExternalStorage->RemoveImage(gExternalStorage->GetImageKeyInSlot(slot)))
             cout << "card ejected successfully" << endl << flush;
         else
             cout << "failed to eject card" << endl << flush;
@@ -325,7 +350,7 @@ namespace {
         if (args.size() != 1) return context.PrintUsage();
 
         EmHAL::Slot slot = util::mountedSlot();
-        if (!gExternalStorage.IsMounted(slot)) {
+        if (!gExternalStorage->IsMounted(slot)) {
             cout << "no mounted card" << endl << flush;
             return;
         }
@@ -368,6 +393,151 @@ namespace {
         debug_support::Locate(buffer.get(), len);
     }
 
+    void CmdRewindConfig(vector<string> args, cli::CommandContext& context) {
+        if (args.size() < 1 || args.size() > 2) return context.PrintUsage();
+
+        double capacityMB;
+        uint32 intervalMsec = 1000;
+
+        istringstream sstream(args[0]);
+        sstream >> capacityMB;
+
+        if (sstream.fail() || !sstream.eof() || capacityMB < 0) {
+            cout << "invalid capacity" << endl << flush;
+            return;
+        }
+
+        if (args.size() == 2) {
+            sstream = istringstream(args[1]);
+            sstream >> intervalMsec;
+
+            if (sstream.fail() || !sstream.eof() || intervalMsec == 0) {
+                cout << "invalid interval" << endl << flush;
+                return;
+            }
+        }
+
+        gSession->ConfigureRewind(capacityMB * 1024 * 1024, intervalMsec);
+    }
+
+    void CmdRewindInfo(vector<string> args, cli::CommandContext& context) {
+        if (args.size() > 0) return context.PrintUsage();
+
+        const RewindBuffer& rewindBuffer(gSession->GetRewindBuffer());
+
+        if (!rewindBuffer.IsEnabled()) {
+            cout << "rewind disabled" << endl << flush;
+            return;
+        }
+
+        const size_t depth = rewindBuffer.GetDepth();
+        const double span =
+            depth == 0 ? 0
+                       : static_cast<double>(gSession->GetSystemCycles() -
+                                             rewindBuffer.GetSystemCycles(depth - 1)) /
+                             gSession->GetClocksPerSecond();
+
+        cout << fixed << setprecision(2) << depth << " rewind points covering " << span
+             << " seconds" << endl
+             << "history: " << rewindBuffer.GetHistorySize() / 1024. / 1024. << " MB of "
+             << rewindBuffer.GetCapacity() / 1024. / 1024. << " MB, "
+             << rewindBuffer.GetMemoryUsage() / 1024. / 1024. << " MB total" << endl
+             << defaultfloat << flush;
+    }
+
+    void CmdRewind(vector<string> args, cli::CommandContext& context) {
+        if (args.size() > 1) return context.PrintUsage();
+
+        double seconds = 1;
+
+        if (args.size() == 1) {
+            istringstream sstream(args[0]);
+            sstream >> seconds;
+
+            if (sstream.fail() || !sstream.eof() || seconds < 0) {
+                cout << "invalid time" << endl << flush;
+                return;
+            }
+        }
+
+        const uint64 cyclesBefore = gSession->GetSystemCycles();
+
+        if (!gSession->Rewind(seconds * 1000)) {
+            cout << "rewind failed" << endl << flush;
+            return;
+        }
+
+        cout << "rewound " << fixed << setprecision(2)
+             << static_cast<double>(cyclesBefore - gSession->GetSystemCycles()) /
+                    gSession->GetClocksPerSecond()
+             << " seconds" << endl
+             << defaultfloat << flush;
+    }
+
+    void CmdSaveSnapshot(vector<string> args, cli::CommandContext& context) {
+        if (args.size() < 1 || args.size() > 2 || (args.size() == 2 && args[1] != "full"))
+            return context.PrintUsage();
+
+        DeltaSnapshot snapshot;
+
+        if (!gSession->CaptureSnapshot(snapshot, args.size() == 2)) {
+            cout << "failed to capture snapshot" << endl << flush;
+            return;
+        }
+
+        snapshot.Serialize();
+
+        fstream stream(args[0], ios_base::out | ios_base::binary);
+        stream.write(static_cast<const char*>(snapshot.GetSerializedImage()),
+                     snapshot.GetSerializedImageSize());
+
+        if (stream.fail()) {
+            cout << "failed to write " << args[0] << endl << flush;
+            return;
+        }
+
+        cout << (snapshot.GetKind() == DeltaSnapshot::Kind::full ? "full snapshot " : "delta ")
+             << snapshot.GetSequence() << " written to " << args[0] << ", "
+             << snapshot.GetSerializedImageSize() / 1024 << " kB" << endl
+             << flush;
+    }
+
+    void CmdLoadSnapshot(vector<string> args, cli::CommandContext& context) {
+        if (args.empty()) return context.PrintUsage();
+
+        if (gSession->IsRecording() || gSession->IsReplaying()) {
+            cout << "stop recording or replay first" << endl << flush;
+            return;
+        }
+
+        vector<DeltaSnapshot> snapshots(args.size());
+
+        for (size_t i = 0; i < args.size(); i++) {
+            unique_ptr<uint8[]> buffer;
+            size_t len;
+
+            if (!util::readFile(args[i], buffer, len)) {
+                cout << "failed to read " << args[i] << endl << flush;
+                return;
+            }
+
+            if (!snapshots[i].Deserialize(buffer.get(), len)) {
+                cout << args[i] << " is not a valid snapshot" << endl << flush;
+                return;
+            }
+        }
+
+        DeltaSnapshot base = move(snapshots.front());
+        snapshots.erase(snapshots.begin());
+
+        if (!gSession->LoadSnapshot(base, snapshots)) {
+            cout << "failed to restore snapshot" << endl << flush;
+            return;
+        }
+
+        cout << "snapshot restored" << endl << flush;
+    }
+
     void CmdDebugSetApp(vector<string> args, cli::CommandContext& context) {
         if (args.size() != 1 && args.size() != 2) return context.PrintUsage();
 
@@ -433,7 +603,7 @@ namespace {
 
         cout << "syscall traps:" << endl << flush;
 
-        for (const uint16 trapWord : gDebugger.GetSyscallTraps())
+        for (const uint16 trapWord : gDebugger->GetSyscallTraps())
             cout << "  0x" << hex << setw(4) << setfill('0') << trapWord << dec << endl;
 
         cout << flush;
@@ -457,7 +627,7 @@ namespace {
             return;
         }
 
-        gDebugger.SetSyscallTrap(trapWord);
+        gDebugger->SetSyscallTrap(trapWord);
     }
 
     void CmdClearSyscallTrap(vector<string> args, cli::CommandContext& context) {
@@ -478,13 +648,551 @@ namespace {
             return;
         }
 
-        gDebugger.ClearSyscallTrap(trapWord);
+        gDebugger->ClearSyscallTrap(trapWord);
     }
 
     void CmdClearAllSyscallTraps(vector<string> args, cli::CommandContext& context) {
         if (args.size() > 0) return context.PrintUsage();
 
-        gDebugger.ClearAllSyscallTraps();
+        gDebugger->ClearAllSyscallTraps();
+    }
+
+    void CmdProfileStart(vector<string> args, cli::CommandContext& context) {
+        if (args.size() > 1) return context.PrintUsage();
+
+        uint32 sampleInterval = Profiler::DEFAULT_SAMPLE_INTERVAL;
+
+        if (args.size() == 1) {
+            istringstream sstream(args[0]);
+            sstream >> sampleInterval;
+
+            if (sstream.fail() || !sstream.eof() || sampleInterval == 0) {
+                cout << "invalid sample interval" << endl << flush;
+                return;
+            }
+        }
+
+        gProfiler->Clear();
+        gProfiler->Start(sampleInterval);
+
+        cout << "profiler started, sampling stacks every " << sampleInterval << " cycles" << endl
+             << flush;
+    }
+
+    void CmdProfileStop(vector<string> args, cli::CommandContext& context) {
+        if (args.size() > 0) return context.PrintUsage();
+
+        gProfiler->Stop();
+
+        cout << "profiler stopped after " << gProfiler->GetTotalCycles() << " cycles" << endl
+             << flush;
+    }
+
+    void CmdProfileReport(vector<string> args, cli::CommandContext& context) {
+        if (args.size() > 1) return context.PrintUsage();
+
+        size_t count = 20;
+
+        if (args.size() == 1) {
+            istringstream sstream(args[0]);
+            sstream >> count;
+
+            if (sstream.fail() || !sstream.eof()) {
+                cout << "invalid count" << endl << flush;
+                return;
+            }
+        }
+
+        const uint64 totalCycles = gProfiler->GetTotalCycles();
+        if (totalCycles == 0) {
+            cout << "no profile data" << endl << flush;
+            return;
+        }
+
+        const auto functionCycles = gProfiler->GetFunctionCycles();
+
+        cout << totalCycles << " cycles, " << gProfiler->GetSampleCount() << " stack samples"
+             << endl
+             << endl;
+
+        for (size_t i = 0; i < functionCycles.size() && i < count; i++) {
+            const auto& [name, cycles] = functionCycles[i];
+
+            cout << right << fixed << setprecision(2) << setw(6)
+                 << 100. * cycles / totalCycles << "% " << setw(12) << cycles << "  " << name
+                 << endl;
+        }
+
+        cout << defaultfloat << flush;
+    }
+
+    void CmdProfileSave(vector<string> args, cli::CommandContext& context) {
+        if (args.size() != 1) return context.PrintUsage();
+
+        fstream stream(args[0], ios_base::out);
+        gProfiler->WriteCollapsedStacks(stream);
+
+        if (stream.fail())
+            cout << "failed to write " << args[0] << endl << flush;
+        else
+            cout << "collapsed stacks written to " << args[0] << endl << flush;
+    }
+
+    void CmdProfileLoadSymbols(vector<string> args, cli::CommandContext& context) {
+        if (args.size() != 1 && args.size() != 2) return context.PrintUsage();
+
+        unique_ptr<uint8[]> buffer;
+        size_t len;
+
+        if (!util::readFile(args[0], buffer, len)) {
+            cout << "failed to read " << args[0] << endl << flush;
+            return;
+        }
+
+        debug_support::LoadSymbols(buffer.get(), len, args.size() == 2 ? args[1].c_str() : nullptr,
+                                   *gProfiler);
+    }
+
+    void CmdSyscallProfileStart(vector<string> args, cli::CommandContext& context) {
+        if (args.size() > 0) return context.PrintUsage();
+
+        gSyscallProfiler->Clear();
+        gSyscallProfiler->Start();
+
+        cout << "syscall profiler started" << endl << flush;
+    }
+
+    void CmdSyscallProfileStop(vector<string> args, cli::CommandContext& context) {
+        if (args.size() > 0) return context.PrintUsage();
+
+        gSyscallProfiler->Stop();
+
+        cout << "syscall profiler stopped" << endl << flush;
+    }
+
+    void CmdSyscallProfileReset(vector<string> args, cli::CommandContext& context) {
+        if (args.size() > 0) return context.PrintUsage();
+
+        gSyscallProfiler->Clear();
+
+        cout << "syscall profile cleared" << endl << flush;
+    }
+
+    void CmdSyscallProfileReport(vector<string> args, cli::CommandContext& context) {
+        if (args.size() > 1) return context.PrintUsage();
+
+        size_t count = 20;
+
+        if (args.size() == 1) {
+            istringstream sstream(args[0]);
+            sstream >> count;
+
+            if (sstream.fail() || !sstream.eof()) {
+                cout << "invalid count" << endl << flush;
+                return;
+            }
+        }
+
+        const auto stats = gSyscallProfiler->GetStats();
+        if (stats.empty()) {
+            cout << "no syscall profile data" << endl << flush;
+            return;
+        }
+
+        cout << right << setw(10) << "calls" << setw(14) << "cycles" << setw(12) << "head usec"
+             << setw(12) << "tail usec" << "  name" << endl;
+
+        for (size_t i = 0; i < stats.size() && i < count; i++) {
+            const auto& entry = stats[i];
+
+            cout << setw(10) << entry.calls << setw(14) << entry.inclusiveCycles << setw(12)
+                 << entry.headpatchNsec / 1000 << setw(12) << entry.tailpatchNsec / 1000 << "  "
+                 << entry.name << endl;
+        }
+
+        cout << flush;
+    }
+
+    void CmdSyscallProfileSave(vector<string> args, cli::CommandContext& context) {
+        if (args.size() != 1) return context.PrintUsage();
+
+        const bool json = EndsWith(args[0].c_str(), ".json");
+
+        fstream stream(args[0], ios_base::out);
+
+        if (json)
+            gSyscallProfiler->WriteJson(stream);
+        else
+            gSyscallProfiler->WriteCsv(stream);
+
+        if (stream.fail())
+            cout << "failed to write " << args[0] << endl << flush;
+        else
+            cout << "syscall profile written to " << args[0] << endl << flush;
+    }
+
+    void CmdIrqTraceStart(vector<string> args, cli::CommandContext& context) {
+        if (args.size() > 1) return context.PrintUsage();
+
+        size_t capacity = InterruptTracer::DEFAULT_CAPACITY;
+
+        if (args.size() == 1) {
+            istringstream sstream(args[0]);
+            sstream >> capacity;
+
+            if (sstream.fail() || !sstream.eof() || capacity == 0) {
+                cout << "invalid capacity" << endl << flush;
+                return;
+            }
+        }
+
+        gInterruptTracer->Clear();
+        gInterruptTracer->Start(capacity);
+
+        cout << "interrupt tracer started, keeping the last " << capacity << " events" << endl
+             << flush;
+    }
+
+    void CmdIrqTraceStop(vector<string> args, cli::CommandContext& context) {
+        if (args.size() > 0) return context.PrintUsage();
+
+        gInterruptTracer->Stop();
+
+        cout << "interrupt tracer stopped after " << gInterruptTracer->GetRecords().size()
+             << " events (" << gInterruptTracer->GetDroppedCount() << " dropped)" << endl
+             << flush;
+    }
+
+    void CmdIrqTraceReport(vector<string> args, cli::CommandContext& context) {
+        if (args.size() > 0) return context.PrintUsage();
+
+        const auto sourceStats = gInterruptTracer->GetSourceStats(gSession->GetClocksPerSecond());
+        const auto levelStats = gInterruptTracer->GetLevelStats();
+
+        if (sourceStats.empty() && levelStats.empty()) {
+            cout << "no interrupt trace data" << endl << flush;
+            return;
+        }
+
+        if (gInterruptTracer->GetDroppedCount() > 0)
+            cout << gInterruptTracer->GetDroppedCount() << " events dropped, statistics cover the "
+                 << "last " << gInterruptTracer->GetRecords().size() << " events" << endl
+                 << endl;
+
+        cout << "latency and service time in cycles" << endl
+             << endl
+             << left << setw(14) << "source" << right << setw(10) << "raised" << setw(10)
+             << "serviced" << setw(10) << "per sec" << setw(10) << "lat p50" << setw(10)
+             << "lat p99" << setw(10) << "lat max" << setw(10) << "svc p50" << setw(10)
+             << "svc p99" << endl;
+
+        for (const auto& entry : sourceStats)
+            cout << left << setw(14) << entry.name << right << setw(10) << entry.raised
+                 << setw(10) << entry.serviced << setw(10) << fixed << setprecision(1)
+                 << entry.ratePerSecond << setw(10) << entry.latency.Percentile(50) << setw(10)
+                 << entry.latency.Percentile(99) << setw(10) << entry.latency.max << setw(10)
+                 << entry.serviceTime.Percentile(50) << setw(10)
+                 << entry.serviceTime.Percentile(99) << endl;
+
+        cout << endl
+             << left << setw(14) << "level" << right << setw(10) << "accepted" << setw(10)
+             << "mean" << setw(10) << "p50" << setw(10) << "p99" << setw(10) << "max" << endl;
+
+        for (const auto& entry : levelStats)
+            cout << left << setw(14) << ("IRQ" + to_string(entry.level)) << right << setw(10)
+                 << entry.accepted << setw(10) << fixed << setprecision(1)
+                 << entry.duration.Mean() << setw(10) << entry.duration.Percentile(50)
+                 << setw(10) << entry.duration.Percentile(99) << setw(10) << entry.duration.max
+                 << endl;
+
+        cout << defaultfloat << flush;
+    }
+
+    void CmdIrqTraceSave(vector<string> args, cli::CommandContext& context) {
+        if (args.size() != 1) return context.PrintUsage();
+
+        fstream stream(args[0], ios_base::out);
+        gInterruptTracer->WriteChromeTrace(stream, gSession->GetClocksPerSecond());
+
+        if (stream.fail())
+            cout << "failed to write " << args[0] << endl << flush;
+        else
+            cout << "interrupt timeline written to " << args[0] << endl << flush;
+    }
+
+    void CmdTurboOn(vector<string> args, cli::CommandContext& context) {
+        if (args.size() > 1) return context.PrintUsage();
+
+        double speed = Turbo::UNLIMITED;
+
+        if (args.size() == 1) {
+            istringstream sstream(args[0]);
+            sstream >> speed;
+
+            if (sstream.fail() || !sstream.eof() || speed <= 0) {
+                cout << "invalid speed" << endl << flush;
+                return;
+            }
+        }
+
+        gTurbo->Enable(Platform::GetMilliseconds(), speed);
+
+        if (speed == Turbo::UNLIMITED)
+            cout << "turbo mode on" << endl << flush;
+        else
+            cout << "turbo mode on, running at " << speed << "x" << endl << flush;
+    }
+
+    void CmdTurboOff(vector<string> args, cli::CommandContext& context) {
+        if (args.size() > 0) return context.PrintUsage();
+
+        gTurbo->Disable();
+
+        cout << "turbo mode off" << endl << flush;
+    }
+
+    void CmdTurboFrameInterval(vector<string> args, cli::CommandContext& context) {
+        if (args.size() != 1) return context.PrintUsage();
+
+        uint32 frameInterval;
+
+        istringstream sstream(args[0]);
+        sstream >> frameInterval;
+
+        if (sstream.fail() || !sstream.eof()) {
+            cout << "invalid frame interval" << endl << flush;
+            return;
+        }
+
+        gTurbo->SetFrameInterval(frameInterval);
+
+        cout << "presenting a frame every " << frameInterval << " msec in turbo mode" << endl
+             << flush;
+    }
+
+    void CmdRecordStart(vector<string> args, cli::CommandContext& context) {
+        if (args.size() > 1) return context.PrintUsage();
+
+        uint32 intervalMsec = EmSession::DEFAULT_CHECKPOINT_INTERVAL_MSEC;
+
+        if (args.size() == 1) {
+            istringstream sstream(args[0]);
+            sstream >> intervalMsec;
+
+            if (sstream.fail() || !sstream.eof() || intervalMsec == 0) {
+                cout << "invalid interval" << endl << flush;
+                return;
+            }
+        }
+
+        if (!gSession->StartRecording(recording, intervalMsec)) {
+            cout << "failed to start recording" << endl << flush;
+            return;
+        }
+
+        cout << "recording started" << endl << flush;
+    }
+
+    void CmdRecordStop(vector<string> args, cli::CommandContext& context) {
+        if (args.size() > 0) return context.PrintUsage();
+
+        if (!gSession->IsRecording()) {
+            cout << "not recording" << endl << flush;
+            return;
+        }
+
+        gSession->StopRecording();
+
+        cout << "recorded " << recording.GetEvents().size() << " events and "
+             << recording.GetCheckpoints().size() << " checkpoints covering " << fixed
+             << setprecision(2)
+             << static_cast<double>(recording.GetEndCycles() - recording.GetStartCycles()) /
+                    gSession->GetClocksPerSecond()
+             << " seconds" << endl
+             << defaultfloat << flush;
+
+        if (!recording.IsDeterministic())
+            cout << "network or serial input was not recorded, replay will stop at its first use"
+                 << endl
+                 << flush;
+    }
+
+    void CmdRecordSave(vector<string> args, cli::CommandContext& context) {
+        if (args.size() != 1) return context.PrintUsage();
+
+        if (gSession->IsRecording()) {
+            cout << "stop recording first" << endl << flush;
+            return;
+        }
+
+        if (recording.GetCheckpoints().empty()) {
+            cout << "nothing recorded" << endl << flush;
+            return;
+        }
+
+        recording.Serialize();
+
+        fstream stream(args[0], ios_base::out | ios_base::binary);
+        stream.write(static_cast<const char*>(recording.GetSerializedImage()),
+                     recording.GetSerializedImageSize());
+
+        if (stream.fail())
+            cout << "failed to write " << args[0] << endl << flush;
+        else
+            cout << "recording written to " << args[0] << endl << flush;
+    }
+
+    bool SeekReplay(const string& arg) {
+        double seconds;
+
+        istringstream sstream(arg);
+        sstream >> seconds;
+
+        if (sstream.fail() || !sstream.eof() || seconds < 0) {
+            cout << "invalid time" << endl << flush;
+            return false;
+        }
+
+        if (!gSession->SeekReplay(recording.GetStartCycles() +
+                                  static_cast<uint64>(seconds * gSession->GetClocksPerSecond()))) {
+            cout << "seek failed" << endl << flush;
+            return false;
+        }
+
+        return true;
+    }
+
+    void CmdReplay(vector<string> args, cli::CommandContext& context) {
+        if (args.size() < 1 || args.size() > 2) return context.PrintUsage();
+
+        if (gSession->IsRecording() || gSession->IsReplaying()) {
+            cout << "stop recording or replay first" << endl << flush;
+            return;
+        }
+
+        unique_ptr<uint8[]> buffer;
+        size_t len;
+
+        if (!util::readFile(args[0], buffer, len)) {
+            cout << "failed to read " << args[0] << endl << flush;
+            return;
+        }
+
+        if (!recording.Deserialize(buffer.get(), len)) {
+            cout << "invalid recording" << endl << flush;
+            return;
+        }
+
+        if (!gSession->StartReplay(recording)) {
+            cout << "failed to start replay" << endl << flush;
+            return;
+        }
+
+        if (args.size() == 2 && !SeekReplay(args[1])) return;
+
+        gTurbo->Enable(Platform::GetMilliseconds());
+
+        cout << "replaying " << recording.GetEvents().size() << " events in turbo mode" << endl
+             << flush;
+
+        if (!recording.IsDeterministic())
+            cout << "replay will stop when the session uses network or serial input"
+                 << endl
+                 << flush;
+    }
+
+    void CmdReplaySeek(vector<string> args, cli::CommandContext& context) {
+        if (args.size() != 1) return context.PrintUsage();
+
+        if (!gSession->IsReplaying()) {
+            cout << "not replaying" << endl << flush;
+            return;
+        }
+
+        SeekReplay(args[0]);
+    }
+
+    void CmdReplayStop(vector<string> args, cli::CommandContext& context) {
+        if (args.size() > 0) return context.PrintUsage();
+
+        gSession->StopReplay();
+
+        cout << "replay stopped" << endl << flush;
+    }
+
+    void CmdStats(vector<string> args, cli::CommandContext& context) {
+        if (args.size() > 0) return context.PrintUsage();
+
+        const SessionStats::Snapshot snapshot = gSession->GetStatsSnapshot();
+
+        cout << "cycles:           " << snapshot.cycles << endl
+             << "stopped cycles:   " << snapshot.stoppedCycles << endl
+             << "instructions:     " << snapshot.instructions << endl
+             << "traps:            " << snapshot.traps << endl
+             << "interrupts:       " << snapshot.interrupts << endl
+             << "screen updates:   " << snapshot.screenUpdates << endl
+             << "frames:           " << snapshot.frames << endl
+             << "savestates:       " << snapshot.savestates << " (last "
+             << snapshot.savestateSize << " bytes)" << endl;
+
+        if (lastStats) {
+            const SessionStats::Rates rates = SessionStats::CalculateRates(*lastStats, snapshot);
+
+            cout << endl
+                 << "over the last " << fixed << setprecision(2) << rates.seconds
+                 << " seconds:" << endl
+                 << "MIPS:             " << rates.mips << endl
+                 << "Mcycles/s:        " << rates.cyclesPerSecond / 1e6 << endl
+                 << "speed:            " << rates.speed << "x realtime" << endl
+                 << "idle:             " << rates.idleRatio * 100 << "%" << endl
+                 << setprecision(1) << "traps/s:          " << rates.trapsPerSecond << endl
+                 << "interrupts/s:     " << rates.interruptsPerSecond << endl
+                 << "screen updates/s: " << rates.screenUpdatesPerSecond << endl
+                 << "frames/s:         " << rates.framesPerSecond << endl
+                 << defaultfloat;
+        }
+
+        cout << flush;
+
+        lastStats = snapshot;
+    }
+
+    void CmdStatsSave(vector<string> args, cli::CommandContext& context) {
+        if (args.size() != 1) return context.PrintUsage();
+
+        const SessionStats::Snapshot snapshot = gSession->GetStatsSnapshot();
+
+        fstream stream(args[0], ios_base::out);
+        SessionStats::WriteJson(
+            stream, snapshot, SessionStats::CalculateRates(lastStats.value_or(snapshot), snapshot));
+
+        lastStats = snapshot;
+
+        if (stream.fail())
+            cout << "failed to write " << args[0] << endl << flush;
+        else
+            cout << "stats written to " << args[0] << endl << flush;
+    }
+
+    void CmdStatsLog(vector<string> args, cli::CommandContext& context) {
+        if (args.size() != 1) return context.PrintUsage();
+
+        double seconds;
+
+        istringstream sstream(args[0]);
+        sstream >> seconds;
+
+        if (sstream.fail() || !sstream.eof() || seconds < 0) {
+            cout << "invalid interval" << endl << flush;
+            return;
+        }
+
+        gSession->SetStatsLogInterval(static_cast<uint32>(seconds * 1000));
+
+        if (seconds == 0)
+            cout << "stats logging off" << endl << flush;
+        else
+            cout << "logging stats every " << seconds << " seconds" << endl << flush;
     }
 
     void CmdHelp(vector<string> args, cli::CommandContext& context) {
@@ -596,6 +1304,182 @@ must match the current device - otherwise, the image will not display.)HELP",
      .usage = "locate <file>",
      .description = "Locate file contents in RAM.",
      .cmd = CmdLocate},
+    {.name = "rewind-config",
+     .usage = "rewind-config <capacity MB> [interval msec]",
+     .description = "Configure rewind.",
+     .help = R"HELP(
+Keep a history of rewind points, one every <interval> msec of emulated time
+(default: 1000), using at most <capacity> MB of memory for the history. A
+capacity of zero disables rewind.)HELP",
+     .cmd = CmdRewindConfig},
+    {.name = "rewind-info", .description = "Show rewind history.", .cmd = CmdRewindInfo},
+    {.name = "rewind",
+     .usage = "rewind [seconds]",
+     .description = "Go back in time.",
+     .help = R"HELP(
+Restore the latest rewind point that lies at least <seconds> (default: 1) in
+the past, or the oldest point if the history does not reach back that far.
+Newer points are discarded.)HELP",
+     .cmd = CmdRewind},
+    {.name = "save-snapshot",
+     .usage = "save-snapshot <file> [full]",
+     .description = "Save snapshot.",
+     .help = R"HELP(
+Write a snapshot of the session to <file>. The first snapshot after launch or
+after loading state contains all of memory. Subsequent snapshots only contain
+the pages that changed since the previous one, unless "full" is given.)HELP",
+     .cmd = CmdSaveSnapshot},
+    {.name = "load-snapshot",
+     .usage = "load-snapshot <full snapshot> [delta...]",
+     .description = "Load snapshot.",
+     .help = R"HELP(
+Restore a full snapshot and the deltas that followed it, in the order in which
+they were saved. If restoring fails, the session is left untouched.)HELP",
+     .cmd = CmdLoadSnapshot},
+    {.name = "profile-start",
+     .usage = "profile-start [sample interval]",
+     .description = "Start profiling.",
+     .help = R"HELP(
+Discard any previous profile and start attributing emulated cycles to the
+instructions that consume them. The call stack is sampled every <sample
+interval> cycles (default: 1000).)HELP",
+     .cmd = CmdProfileStart},
+    {.name = "profile-stop", .description = "Stop profiling.", .cmd = CmdProfileStop},
+    {.name = "profile-report",
+     .usage = "profile-report [count]",
+     .description = "Show the most expensive functions.",
+     .help = R"HELP(
+Show the <count> (default: 20) functions that consumed the most cycles. Names
+are resolved from symbols loaded with profile-load-symbols or from macsbug
+names.)HELP",
+     .cmd = CmdProfileReport},
+    {.name = "profile-save",
+     .usage = "profile-save <file>",
+     .description = "Save profile as collapsed stacks.",
+     .help = R"HELP(
+Write the sampled stacks in the collapsed format understood by flamegraph.pl
+and speedscope.)HELP",
+     .cmd = CmdProfileSave},
+    {.name = "profile-load-symbols",
+     .usage = "profile-load-symbols <file> [db name]",
+     .description = "Load function names for profiling.",
+     .help = R"HELP(
+Load an ELF file, locate .text in PalmOS memory like debug-set-app does and use
+its function symbols to resolve names in profiles.)HELP",
+     .cmd = CmdProfileLoadSymbols},
+    {.name = "syscall-profile-start",
+     .description = "Start profiling system calls.",
+     .help = R"HELP(
+Discard any previous syscall profile and start collecting per trap statistics:
+the number of calls, the emulated cycles spent until the call returns and the
+host time spent in the emulator's head- and tailpatches.)HELP",
+     .cmd = CmdSyscallProfileStart},
+    {.name = "syscall-profile-stop",
+     .description = "Stop profiling system calls.",
+     .cmd = CmdSyscallProfileStop},
+    {.name = "syscall-profile-reset",
+     .description = "Clear the syscall profile.",
+     .cmd = CmdSyscallProfileReset},
+    {.name = "syscall-profile-report",
+     .usage = "syscall-profile-report [count]",
+     .description = "Show the most expensive system calls.",
+     .help = R"HELP(
+Show the <count> (default: 20) system and library calls that consumed the most
+cycles, including the time spent in nested calls.)HELP",
+     .cmd = CmdSyscallProfileReport},
+    {.name = "syscall-profile-save",
+     .usage = "syscall-profile-save <file>",
+     .description = "Save syscall profile.",
+     .help = R"HELP(
+Write the syscall profile as JSON if <file> ends with .json and as CSV
+otherwise.)HELP",
+     .cmd = CmdSyscallProfileSave},
+    {.name = "irq-trace-start",
+     .usage = "irq-trace-start [capacity]",
+     .description = "Start tracing interrupts.",
+     .help = R"HELP(
+Discard any previous trace and record when interrupt sources are raised and
+cleared, and when the CPU enters and leaves interrupt handlers. The last
+<capacity> (default: 65536) events are kept.)HELP",
+     .cmd = CmdIrqTraceStart},
+    {.name = "irq-trace-stop", .description = "Stop tracing interrupts.", .cmd = CmdIrqTraceStop},
+    {.name = "irq-trace-report",
+     .description = "Show interrupt rates and latencies.",
+     .help = R"HELP(
+Show the rate, latency and service time of each interrupt source, and the
+time spent in handlers on each level. A source is attributed to the handler
+that clears it.)HELP",
+     .cmd = CmdIrqTraceReport},
+    {.name = "irq-trace-save",
+     .usage = "irq-trace-save <file>",
+     .description = "Save interrupt timeline.",
+     .help = R"HELP(
+Write the interrupt timeline in Chrome trace event format, suitable for
+chrome://tracing and ui.perfetto.dev.)HELP",
+     .cmd = CmdIrqTraceSave},
+    {.name = "turbo-on",
+     .usage = "turbo-on [speed]",
+     .description = "Run emulation faster than realtime.",
+     .help = R"HELP(
+Stop pacing the emulator by wall clock and run emulated time as fast as
+possible, or at <speed> times realtime. Idle periods are skipped, and the
+screen is only updated at the interval set with turbo-frame-interval.)HELP",
+     .cmd = CmdTurboOn},
+    {.name = "turbo-off", .description = "Return to realtime.", .cmd = CmdTurboOff},
+    {.name = "turbo-frame-interval",
+     .usage = "turbo-frame-interval <msec>",
+     .description = "Set screen update interval for turbo mode.",
+     .help = R"HELP(
+Update the screen at most once every <msec> milliseconds while turbo mode is
+on (default: 250). 0 updates the screen whenever it changes.)HELP",
+     .cmd = CmdTurboFrameInterval},
+    {.name = "record-start",
+     .usage = "record-start [checkpoint interval msec]",
+     .description = "Start recording input.",
+     .help = R"HELP(
+Record pen, key and button input together with the seeds for the emulated
+clock and random numbers, so the session can be replayed exactly. A
+checkpoint is stored every [checkpoint interval msec] milliseconds of emulated
+time (default: 10000). Network, serial, resets, installs and clipboard are not
+recorded; replay stops when the session first uses network or serial input.)HELP",
+     .cmd = CmdRecordStart},
+    {.name = "record-stop", .description = "Stop recording input.", .cmd = CmdRecordStop},
+    {.name = "record-save",
+     .usage = "record-save <file>",
+     .description = "Save the last recording.",
+     .cmd = CmdRecordSave},
+    {.name = "replay",
+     .usage = "replay <file> [seconds]",
+     .description = "Replay a recording.",
+     .help = R"HELP(
+Restore the session recorded in <file> and replay its input in turbo mode,
+optionally seeking [seconds] into the recording first. Host input is ignored
+while the replay runs.)HELP",
+     .cmd = CmdReplay},
+    {.name = "replay-seek",
+     .usage = "replay-seek <seconds>",
+     .description = "Seek within the replay.",
+     .cmd = CmdReplaySeek},
+    {.name = "replay-stop", .description = "Stop replay.", .cmd = CmdReplayStop},
+    {.name = "stats",
+     .description = "Show performance counters.",
+     .help = R"HELP(
+Show instructions and cycles executed, cycles spent with the CPU stopped,
+traps, interrupts, screen updates, frames and savestates since the session was
+started. From the second call on, the rates since the previous call are shown
+as well.)HELP",
+     .cmd = CmdStats},
+    {.name = "stats-save",
+     .usage = "stats-save <file>",
+     .description = "Save performance counters as JSON.",
+     .cmd = CmdStatsSave},
+    {.name = "stats-log",
+     .usage = "stats-log <seconds>",
+     .description = "Log performance counters periodically.",
+     .help = R"HELP(
+Log the rates of the performance counters every <seconds> seconds of host time.
+0 turns logging off.)HELP",
+     .cmd = CmdStatsLog},
 #ifdef ENABLE_DEBUGGER
     {.name = "debug-set-app",
      .usage = "debug-set-app <file> [db name]",
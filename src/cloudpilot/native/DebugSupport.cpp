@@ -58,54 +58,89 @@ namespace {
 
         return rscPtr;
     }
+
+    bool locateApp(ElfParser& parser, const uint8* elfData, size_t elfSize, const char* dbName,
+                   emuptr& textBase, uint32& textSize, int64& relocation) {
+        try {
+            parser.Parse(elfData, elfSize);
+        } catch (const ElfParser::EInvalidElf& e) {
+            cout << e.GetReason() << endl << flush;
+            return false;
+        }
+
+        if (parser.GetMachine() != 0x04) {
+            cout << "bad architecture" << endl << flush;
+            return false;
+        }
+
+        const auto sectionText = parser.GetSection(".text");
+        if (!sectionText.has_value()) {
+            cout << ".text not found in binary" << endl << flush;
+            return false;
+        }
+
+        emuptr searchBase = gMemoryStart;
+        uint32 searchSize = EmMemory::GetRegionSize(MemoryRegion::ram);
+
+        if (dbName) {
+            searchBase = locateCodeResource(dbName, searchSize);
+            if (searchBase == 0xffffffff) return false;
+        }
+
+        textBase = debug_support::FindRegion(elfData + sectionText->offset, sectionText->size,
+                                             searchBase, searchSize);
+
+        if (textBase == 0xffffffff) {
+            cout << "unable to locate application in " << (dbName ? "database" : "memory")
+                 << endl
+                 << flush;
+            return false;
+        }
+
+        textSize = sectionText->size;
+        relocation = static_cast<int64>(textBase) - sectionText->virtualAddress;
+        cout << "found .text relocated by " << relocation << " bytes" << endl << flush;
+
+        return true;
+    }
 }  // namespace
 
 void debug_support::SetApp(const uint8* elfData, size_t elfSize, const char* dbName,
                            GdbStub& gdbStub, Debugger& debugger) {
     ElfParser parser;
+    emuptr textBase;
+    uint32 textSize;
+    int64 relocation;
 
-    try {
-        parser.Parse(elfData, elfSize);
-    } catch (const ElfParser::EInvalidElf& e) {
-        cout << e.GetReason() << endl << flush;
-        return;
-    }
+    if (!locateApp(parser, elfData, elfSize, dbName, textBase, textSize, relocation)) return;
 
-    if (parser.GetMachine() != 0x04) {
-        cout << "bad architecture" << endl << flush;
-        return;
-    }
+    cout << "set break mode to app-only" << endl << flush;
 
-    const auto sectionText = parser.GetSection(".text");
-    if (!sectionText.has_value()) {
-        cout << ".text not found in binary" << endl << flush;
-        return;
-    }
+    gdbStub.SetRelocationOffset(relocation);
+    debugger.SetBreakMode(Debugger::BreakMode::appOnly);
+    debugger.SetAppRegion(textBase, textSize);
+}
+
+void debug_support::LoadSymbols(const uint8* elfData, size_t elfSize, const char* dbName,
+                                Profiler& profiler) {
+    ElfParser parser;
+    emuptr textBase;
+    uint32 textSize;
+    int64 relocation;
 
-    emuptr searchBase = gMemoryStart;
-    uint32 searchSize = EmMemory::GetRegionSize(MemoryRegion::ram);
+    if (!locateApp(parser, elfData, elfSize, dbName, textBase, textSize, relocation)) return;
 
-    if (dbName) {
-        searchBase = locateCodeResource(dbName, searchSize);
-        if (searchBase == 0xffffffff) return;
-    }
+    vector<Profiler::Symbol> symbols;
 
-    const emuptr textBase =
-        FindRegion(elfData + sectionText->offset, sectionText->size, searchBase, searchSize);
+    for (const auto& symbol : parser.GetFunctionSymbols()) {
+        const emuptr address = static_cast<emuptr>(symbol.value + relocation);
 
-    if (textBase == 0xffffffff) {
-        cout << "unable to locate application in " << (dbName ? "database" : "memory") << endl
-             << flush;
-        return;
+        symbols.push_back({address, symbol.size, symbol.name});
     }
 
-    const int64 relocation = static_cast<int64>(textBase) - sectionText->virtualAddress;
-    cout << "found .text relocated by " << relocation << " bytes" << endl;
-    cout << "set break mode to app-only" << endl << flush;
+    cout << "loaded " << symbols.size() << " function symbols" << endl << flush;
 
-    gdbStub.SetRelocationOffset(relocation);
-    debugger.SetBreakMode(Debugger::BreakMode::appOnly);
-    debugger.SetAppRegion(textBase, sectionText->size);
+    profiler.SetSymbols(move(symbols));
 }
 
 emuptr debug_support::FindRegion(const uint8* region, size_t regionSize, emuptr start,
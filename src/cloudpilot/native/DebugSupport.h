@@ -3,11 +3,17 @@
 
 #include "EmCommon.h"
 #include "GdbStub.h"
+#include "Profiler.h"
 
 namespace debug_support {
     void SetApp(const uint8* elfData, size_t elfSize, const char* dbName, GdbStub& gdbStub,
                 Debugger& debugger);
 
+    // Locates the app like SetApp and hands its relocated function symbols to
+    // the profiler.
+    void LoadSymbols(const uint8* elfData, size_t elfSize, const char* dbName,
+                     Profiler& profiler);
+
     emuptr FindRegion(const uint8* region, size_t regionSize, emuptr start, size_t size);
 
     void Locate(const uint8* data, size_t size);
@@ -1,6 +1,7 @@
 #include "ElfParser.h"
 
 #include <cstring>
+#include <iostream>
 
 using namespace std;
 
@@ -10,6 +11,9 @@ namespace {
     constexpr uint8_t ELF_ENDIAN_BE = 2;
     constexpr uint8_t ELF_VERSION = 1;
     constexpr uint32_t SECTION_TYPE_STRTAB = 0x03;
+    constexpr uint32_t SECTION_TYPE_SYMTAB = 0x02;
+    constexpr uint32_t SYMBOL_SIZE = 0x10;
+    constexpr uint8_t SYMBOL_TYPE_FUNC = 0x02;
 }  // namespace
 
 ElfParser::EInvalidElf::EInvalidElf(const string& reason) : reason(reason) {}
@@ -22,6 +26,7 @@ void ElfParser::Parse(const uint8_t* elfData, size_t size) {
 
     bigEndian = true;
     sections.resize(0);
+    functionSymbols.resize(0);
 
     try {
         if (Read32(0x00) != ELF_MAGIC) throw EInvalidElf("bad magic");
@@ -60,6 +65,8 @@ void ElfParser::Parse(const uint8_t* elfData, size_t size) {
 
             section.name = name;
         }
+
+        ReadFunctionSymbols();
     } catch (const EInvalidElf& e) {
         throw EInvalidElf("failed to parse ELF: " + e.GetReason());
     }
@@ -82,6 +89,10 @@ const optional<ElfParser::Section> ElfParser::GetSection(const string& name) con
     return optional<Section>();
 }
 
+const vector<ElfParser::Symbol>& ElfParser::GetFunctionSymbols() const {
+    return functionSymbols;
+}
+
 uint8_t ElfParser::Read8(uint32_t offset) {
     if (offset >= size) throw EInvalidElf("reference beyond bounds");
 
@@ -117,3 +128,35 @@ ElfParser::Section ElfParser::ReadSection(uint32_t offset) {
 
     return section;
 }
+
+// Symbols are only used for symbolication, so a broken symbol table must not
+// fail the whole binary. Symbols with malformed names are skipped, and a
+// table that exceeds the binary is dropped.
+void ElfParser::ReadFunctionSymbols() {
+    const auto symtab = GetSection(".symtab");
+    const auto strtab = GetSection(".strtab");
+
+    if (!symtab || !strtab || symtab->sectionType != SECTION_TYPE_SYMTAB ||
+        strtab->sectionType != SECTION_TYPE_STRTAB)
+        return;
+
+    const uint32_t end = symtab->offset + symtab->size;
+
+    try {
+        for (uint32_t offset = symtab->offset; offset + SYMBOL_SIZE <= end; offset += SYMBOL_SIZE) {
+            if ((Read8(offset + 0x0c) & 0x0f) != SYMBOL_TYPE_FUNC) continue;
+
+            uint32_t nameOffset = Read32(offset);
+            if (nameOffset >= strtab->size) continue;
+
+            const char* name = reinterpret_cast<const char*>(data + strtab->offset + nameOffset);
+            if (name[strnlen(name, strtab->size - nameOffset)] != '\0') continue;
+
+            functionSymbols.push_back({name, Read32(offset + 0x04), Read32(offset + 0x08)});
+        }
+    } catch (const EInvalidElf& e) {
+        cout << "ignoring symbol table: " << e.GetReason() << endl << flush;
+
+        functionSymbols.clear();
+    }
+}
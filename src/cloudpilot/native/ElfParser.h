@@ -33,6 +33,13 @@ class ElfParser {
         uint32_t offset;
     };
 
+    struct Symbol {
+        std::string name;
+
+        uint32_t value;
+        uint32_t size;
+    };
+
    public:
     ElfParser() = default;
 
@@ -47,12 +54,16 @@ class ElfParser {
     const std::vector<Section>& GetSections() const;
     const std::optional<Section> GetSection(const std::string& name) const;
 
+    // Function symbols from .symtab, if the binary has not been stripped.
+    const std::vector<Symbol>& GetFunctionSymbols() const;
+
    private:
     uint8_t Read8(uint32_t offset);
     uint16_t Read16(uint32_t offset);
     uint32_t Read32(uint32_t offset);
 
     Section ReadSection(uint32_t offset);
+    void ReadFunctionSymbols();
 
    private:
     const uint8_t* data{nullptr};
@@ -64,6 +75,7 @@ class ElfParser {
     uint32_t entrypoint;
 
     std::vector<Section> sections;
+    std::vector<Symbol> functionSymbols;
 };
 
 #endif  // _ELF_PARSER_H_
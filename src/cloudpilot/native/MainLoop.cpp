@@ -6,15 +6,12 @@
 #include "EmHAL.h"
 #include "EmSession.h"
 #include "EmSystemState.h"
-#include "Nibbler.h"
 #include "Silkscreen.h"
 #include "SuspendManager.h"
+#include "Turbo.h"
 
 constexpr uint8 SILKSCREEN_BACKGROUND_HUE = 0xbb;
 constexpr uint32 BACKGROUND_HUE = 0xd2;
-constexpr uint32 FOREGROUND_COLOR = 0xff000000;
-constexpr uint32 BACKGROUND_COLOR =
-    0xff000000 | BACKGROUND_HUE | (BACKGROUND_HUE << 8) | (BACKGROUND_HUE << 16);
 
 constexpr uint32 PALETTE_GRAYSCALE_16[] = {
     0xffd2d2d2, 0xffc4c4c4, 0xffb6b6b6, 0xffa8a8a8, 0xff9a9a9a, 0xff8c8c8c, 0xff7e7e7e, 0xff707070,
@@ -28,6 +25,7 @@ MainLoop::MainLoop(SDL_Window* window, SDL_Renderer* renderer, int scale)
       screenDimensions(gSession->GetDevice().GetScreenDimensions()),
       eventHandler(scale) {
     LoadSilkscreen();
+    frameConverter.SetPalette(PALETTE_GRAYSCALE_16);
 
     SDL_SetRenderDrawColor(renderer, 0xdd, 0xdd, 0xdd, 0xff);
     SDL_RenderClear(renderer);
@@ -49,7 +47,12 @@ void MainLoop::Cycle() {
     const long millis = Platform::GetMilliseconds();
     const uint32 clocksPerSecond = gSession->GetClocksPerSecond();
 
-    if (!gDebugger.IsStopped()) {
+    if (gTurbo->IsEnabled()) {
+        if (!gDebugger->IsStopped()) gTurbo->Run(*gSession);
+
+        // Pick up pacing by wall clock from here once turbo mode is turned off.
+        clockEmu = millis - millisOffset;
+    } else if (!gDebugger->IsStopped()) {
         if (millis - millisOffset - static_cast<long>(clockEmu) > 500)
             clockEmu = millis - millisOffset - 10;
 
@@ -59,7 +62,7 @@ void MainLoop::Cycle() {
         if (cycles > 0) {
             long cyclesPassed = 0;
 
-            while (cyclesPassed < cycles && !gDebugger.IsStopped())
+            while (cyclesPassed < cycles && !gDebugger->IsStopped())
                 cyclesPassed += gSession->RunEmulation(cycles);
             clockEmu +=
                 static_cast<double>(cyclesPassed) / (static_cast<double>(clocksPerSecond) / 1000.);
@@ -68,10 +71,11 @@ void MainLoop::Cycle() {
         clockEmu = millis - millisOffset;
     }
 
-    if (gSystemState.IsScreenDirty()) {
+    if (gSystemState->IsScreenDirty() && gTurbo->IsFrameDue(millis)) {
         UpdateScreen(false);
-        gSystemState.MarkScreenClean();
-    } else if (!SuspendManager::IsSuspended() && !gDebugger.IsStopped() && !gDebugger.IsStepping())
+        gSystemState->MarkScreenClean();
+    } else if (!gTurbo->IsEnabled() && !SuspendManager::IsSuspended() && !gDebugger->IsStopped() &&
+               !gDebugger->IsStepping())
         SDL_Delay(16);
 
     if (eventHandler.HandleEvents(millis)) UpdateScreen(true);
@@ -111,76 +115,26 @@ void MainLoop::UpdateScreen(bool fullRedraw) {
             frame.lines * frame.scaleY == screenDimensions.Height()) {
             uint32* pixels;
             int pitch;
-            uint8* buffer = frame.GetBuffer();
 
             SDL_LockTexture(lcdTempTexture, nullptr, (void**)&pixels, &pitch);
 
-            switch (frame.bpp) {
-                case 1: {
-                    Nibbler<1> nibbler;
-
-                    for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
-                        nibbler.reset(buffer + y * frame.bytesPerLine, frame.margin);
-                        uint32* line = pixels + y * pitch / 4;
-
-                        for (uint32 x = 0; x < frame.lineWidth; x++)
-                            *(line++) = nibbler.nibble() == 0 ? BACKGROUND_COLOR : FOREGROUND_COLOR;
-                    }
-                } break;
-
-                case 2: {
-                    uint16 mapping = EmHAL::GetLCD2bitMapping();
-
-                    uint32 palette[4] = {PALETTE_GRAYSCALE_16[mapping & 0x000f],
-                                         PALETTE_GRAYSCALE_16[(mapping >> 4) & 0x000f],
-                                         PALETTE_GRAYSCALE_16[(mapping >> 8) & 0x000f],
-                                         PALETTE_GRAYSCALE_16[(mapping >> 12) & 0x000f]};
-
-                    Nibbler<2> nibbler;
-
-                    for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
-                        nibbler.reset(buffer + y * frame.bytesPerLine, frame.margin);
-                        uint32* line = pixels + y * pitch / 4;
-
-                        for (uint32 x = 0; x < frame.lineWidth; x++)
-                            *(line++) = palette[nibbler.nibble()];
-                    }
-                } break;
-
-                case 4: {
-                    Nibbler<4> nibbler;
-
-                    for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
-                        nibbler.reset(buffer + y * frame.bytesPerLine, frame.margin);
-                        uint32* line = pixels + y * pitch / 4;
-
-                        for (uint32 x = 0; x < frame.lineWidth; x++)
-                            *(line++) = PALETTE_GRAYSCALE_16[nibbler.nibble()];
-                    }
-                } break;
-
-                case 24: {
-                    for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
-                        memcpy(pixels + y * pitch / 4,
-                               buffer + y * frame.bytesPerLine + 4 * frame.margin,
-                               4 * frame.lineWidth);
-                    }
-                } break;
-            }
+            frameConverter.Convert(frame, pixels + frame.firstDirtyLine * pitch / 4, pitch / 4,
+                                   EmHAL::GetLCD2bitMapping());
 
             SDL_UnlockTexture(lcdTempTexture);
 
-            SDL_Rect src = {
-                .x = 0,
-                .y = static_cast<int32>(frame.firstDirtyLine),
-                .w = static_cast<int32>(frame.lineWidth),
-                .h = static_cast<int32>(frame.lastDirtyLine - frame.firstDirtyLine + 1)};
+            const uint32 dirtyColumns = frame.lastDirtyColumn - frame.firstDirtyColumn + 1;
+            const uint32 dirtyLines = frame.lastDirtyLine - frame.firstDirtyLine + 1;
+
+            SDL_Rect src = {.x = static_cast<int32>(frame.firstDirtyColumn),
+                            .y = static_cast<int32>(frame.firstDirtyLine),
+                            .w = static_cast<int32>(dirtyColumns),
+                            .h = static_cast<int32>(dirtyLines)};
 
-            SDL_Rect dest = {.x = 0,
+            SDL_Rect dest = {.x = static_cast<int32>(frame.firstDirtyColumn * frame.scaleX),
                              .y = static_cast<int32>(frame.firstDirtyLine * frame.scaleY),
-                             .w = static_cast<int32>(frame.lineWidth * frame.scaleX),
-                             .h = static_cast<int32>(
-                                 (frame.lastDirtyLine - frame.firstDirtyLine + 1) * frame.scaleY)};
+                             .w = static_cast<int32>(dirtyColumns * frame.scaleX),
+                             .h = static_cast<int32>(dirtyLines * frame.scaleY)};
 
             SDL_SetRenderTarget(renderer, lcdTexture);
             SDL_RenderCopy(renderer, lcdTempTexture, &src, &dest);
@@ -0,0 +1,1145 @@
+#include "NativeNetwork.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "Logging.h"
+#include "pb_decode.h"
+#include "pb_encode.h"
+
+namespace {
+    constexpr int64 MAX_TIMEOUT = 10000;
+
+    constexpr uint32 PALM_SOCKET_TYPE_STREAM = 1;
+    constexpr uint32 PALM_SOCKET_TYPE_DGRAM = 2;
+    constexpr uint32 PALM_SOCKET_TYPE_RAW = 3;
+
+    constexpr size_t IP_HEADER_MIN_SIZE = 20;
+    constexpr size_t IP_OPTIONS_SIZE = 40;
+    constexpr size_t MAX_ADDRESSES = 3;
+
+#ifdef MSG_NOSIGNAL
+    constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+    constexpr int SEND_FLAGS = 0;
+#endif
+
+    struct BufferEncodeContext {
+        const uint8* data;
+        size_t len;
+    };
+
+    int64 now() {
+        return chrono::duration_cast<chrono::milliseconds>(
+                   chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    int64 deadlineFor(int32 timeout) {
+        return now() + (timeout > 0 && timeout < MAX_TIMEOUT ? timeout : MAX_TIMEOUT);
+    }
+
+    int32 errnoToPalm(int error) {
+        switch (error) {
+            case EINTR:
+                return netErrUserCancel;
+
+            case EDEADLK:
+            case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+            case EWOULDBLOCK:
+#endif
+            case EINPROGRESS:
+                return netErrWouldBlock;
+
+            case ENOMEM:
+                return netErrOutOfMemory;
+
+            case EACCES:
+                return netErrAuthFailure;
+
+            case EBUSY:
+                return netErrSocketBusy;
+
+            case EROFS:
+                return netErrReadOnlySetting;
+
+            case EALREADY:
+                return netErrAlreadyInProgress;
+
+            case ENOTSOCK:
+                return netErrNoSocket;
+
+            case EDESTADDRREQ:
+                return netErrIPNoDst;
+
+            case EMSGSIZE:
+                return netErrMessageTooBig;
+
+            case ENOPROTOOPT:
+            case EPROTONOSUPPORT:
+                return netErrUnknownProtocol;
+
+            case ESOCKTNOSUPPORT:
+            case EOPNOTSUPP:
+                return netErrWrongSocketType;
+
+            case EPFNOSUPPORT:
+            case EAFNOSUPPORT:
+                return netErrUnknownService;
+
+            case EADDRINUSE:
+            case EADDRNOTAVAIL:
+                return netErrPortInUse;
+
+            case ENETDOWN:
+                return netErrUnreachableDest;
+
+            case ENETUNREACH:
+                return netErrNoInterfaces;
+
+            case ENETRESET:
+            case ECONNABORTED:
+            case ECONNRESET:
+                return netErrSocketClosedByRemote;
+
+            case ENOBUFS:
+                return netErrNoTCB;
+
+            case EISCONN:
+                return netErrSocketAlreadyConnected;
+
+            case ENOTCONN:
+                return netErrSocketNotConnected;
+
+            case ESHUTDOWN:
+                return netErrSocketNotOpen;
+
+            case ETIMEDOUT:
+            case ECONNREFUSED:
+                return netErrTimeout;
+
+            case EHOSTDOWN:
+            case EHOSTUNREACH:
+                return netErrIPNoRoute;
+
+            default:
+                return netErrInternal;
+        }
+    }
+
+    int32 gaiErrorToPalm(int error) {
+        switch (error) {
+            case EAI_NONAME:
+                return netErrDNSUnreachable;
+
+            case EAI_AGAIN:
+                return netErrDNSServerFailure;
+
+            case EAI_FAIL:
+                return netErrDNSRefused;
+
+#ifdef EAI_NODATA
+            case EAI_NODATA:
+                return netErrDNSNonexistantName;
+#endif
+
+            case EAI_SYSTEM:
+                return errnoToPalm(errno);
+
+            default:
+                return netErrInternal;
+        }
+    }
+
+    void logError(const char* message, int32 err) {
+        if (err == 0 || err == netErrTimeout || err == netErrWouldBlock) return;
+
+        logging::printf("native network: %s, err = 0x%04x", message, err);
+    }
+
+    int translateFlags(uint32 flags) {
+        int translatedFlags = 0;
+
+        if (flags & netIOFlagOutOfBand) translatedFlags |= MSG_OOB;
+        if (flags & netIOFlagPeek) translatedFlags |= MSG_PEEK;
+        if (flags & netIOFlagDontRoute) translatedFlags |= MSG_DONTROUTE;
+
+        return translatedFlags;
+    }
+
+    sockaddr_in deserializeAddress(const Address& address) {
+        sockaddr_in result;
+
+        memset(&result, 0, sizeof(result));
+        result.sin_family = AF_INET;
+        result.sin_addr.s_addr = htonl(address.ip);
+        result.sin_port = htons(address.port);
+
+        return result;
+    }
+
+    void serializeAddress(const sockaddr_in& address, Address& target) {
+        if (address.sin_family != AF_INET) {
+            target.ip = 0;
+            target.port = 0;
+
+            return;
+        }
+
+        target.ip = ntohl(address.sin_addr.s_addr);
+        target.port = ntohs(address.sin_port);
+    }
+
+    bool setNonblocking(int fd) {
+        const int flags = fcntl(fd, F_GETFL);
+
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    int32 wait(int fd, bool nonblocking, short events, int64 deadline) {
+        if (nonblocking) return netErrWouldBlock;
+
+        while (true) {
+            const int64 remaining = deadline - now();
+            if (remaining <= 0) return netErrTimeout;
+
+            pollfd pfd{fd, events, 0};
+
+            const int result = poll(&pfd, 1, remaining);
+
+            if (result > 0) return 0;
+            if (result == 0) return netErrTimeout;
+            if (errno != EINTR) return errnoToPalm(errno);
+        }
+    }
+
+    // Runs op until it succeeds or fails with anything but EAGAIN, waiting
+    // for the socket to become ready in between.
+    template <typename T>
+    int32 retry(int fd, bool nonblocking, short events, int64 deadline, T op) {
+        while (true) {
+            if (op()) return 0;
+
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) return errnoToPalm(errno);
+
+            if (int32 err = wait(fd, nonblocking, events, deadline); err != 0) return err;
+        }
+    }
+
+    bool translateSockopt(uint32 level, uint32 option, int& nativeLevel, int& nativeOption) {
+        switch (level) {
+            case netSocketOptLevelIP:
+                nativeLevel = IPPROTO_IP;
+
+                if (option != netSocketOptIPOptions) return false;
+                nativeOption = IP_OPTIONS;
+
+                return true;
+
+            case netSocketOptLevelTCP:
+                nativeLevel = IPPROTO_TCP;
+
+                switch (option) {
+                    case netSocketOptTCPNoDelay:
+                        nativeOption = TCP_NODELAY;
+                        return true;
+
+                    case netSocketOptTCPMaxSeg:
+                        nativeOption = TCP_MAXSEG;
+                        return true;
+
+                    default:
+                        return false;
+                }
+
+            case netSocketOptLevelSocket:
+                nativeLevel = SOL_SOCKET;
+
+                switch (option) {
+                    case netSocketOptSockDebug:
+                        nativeOption = SO_DEBUG;
+                        return true;
+
+                    case netSocketOptSockAcceptConn:
+                        nativeOption = SO_ACCEPTCONN;
+                        return true;
+
+                    case netSocketOptSockReuseAddr:
+                        nativeOption = SO_REUSEADDR;
+                        return true;
+
+                    case netSocketOptSockKeepAlive:
+                        nativeOption = SO_KEEPALIVE;
+                        return true;
+
+                    case netSocketOptSockDontRoute:
+                        nativeOption = SO_DONTROUTE;
+                        return true;
+
+                    case netSocketOptSockBroadcast:
+                        nativeOption = SO_BROADCAST;
+                        return true;
+
+#ifdef SO_USELOOPBACK
+                    case netSocketOptSockUseLoopback:
+                        nativeOption = SO_USELOOPBACK;
+                        return true;
+#endif
+
+                    case netSocketOptSockLinger:
+                        nativeOption = SO_LINGER;
+                        return true;
+
+                    case netSocketOptSockOOBInLine:
+                        nativeOption = SO_OOBINLINE;
+                        return true;
+
+                    case netSocketOptSockSndBufSize:
+                        nativeOption = SO_SNDBUF;
+                        return true;
+
+                    case netSocketOptSockRcvBufSize:
+                        nativeOption = SO_RCVBUF;
+                        return true;
+
+                    case netSocketOptSockSndLowWater:
+                        nativeOption = SO_SNDLOWAT;
+                        return true;
+
+                    case netSocketOptSockRcvLowWater:
+                        nativeOption = SO_RCVLOWAT;
+                        return true;
+
+                    case netSocketOptSockSndTimeout:
+                        nativeOption = SO_SNDTIMEO;
+                        return true;
+
+                    case netSocketOptSockRcvTimeout:
+                        nativeOption = SO_RCVTIMEO;
+                        return true;
+
+                    case netSocketOptSockErrorStatus:
+                        nativeOption = SO_ERROR;
+                        return true;
+
+                    case netSocketOptSockSocketType:
+                        nativeOption = SO_TYPE;
+                        return true;
+
+                    default:
+                        return false;
+                }
+
+            default:
+                return false;
+        }
+    }
+
+    uint32 nameserver() {
+        ifstream stream("/etc/resolv.conf");
+        string line;
+
+        while (getline(stream, line)) {
+            if (line.compare(0, 10, "nameserver") != 0) continue;
+
+            const size_t start = line.find_first_not_of(" \t", 10);
+            if (start == string::npos) continue;
+
+            const size_t end = line.find_first_of(" \t#", start);
+
+            in_addr address;
+            if (inet_pton(AF_INET, line.substr(start, end - start).c_str(), &address) == 1)
+                return ntohl(address.s_addr);
+        }
+
+        return 0x08080808;
+    }
+
+    bool dataDecodeCb(pb_istream_t* stream, const pb_field_iter_t* field, void** arg) {
+        if (!arg) return false;
+
+        vector<uint8>* data = static_cast<vector<uint8>*>(*arg);
+
+        data->resize(stream->bytes_left);
+
+        return pb_read(stream, data->data(), data->size());
+    }
+
+    bool dataEncodeCb(pb_ostream_t* stream, const pb_field_iter_t* field, void* const* arg) {
+        if (!arg) return false;
+
+        const BufferEncodeContext* ctx = static_cast<const BufferEncodeContext*>(*arg);
+
+        return pb_encode_tag_for_field(stream, field) &&
+               pb_encode_string(stream, ctx->data, ctx->len);
+    }
+}  // namespace
+
+NativeNetwork::~NativeNetwork() { Reset(); }
+
+pair<uint8*, size_t> NativeNetwork::HandleRequest(const uint8* data, size_t size) {
+    MsgRequest request = MsgRequest_init_zero;
+    vector<uint8> sendData;
+
+    pb_istream_t istream = pb_istream_from_buffer(data, size);
+    if (!pb_decode(&istream, MsgRequest_fields, &request)) return {nullptr, 0};
+
+    // nanopb clears callbacks when it switches the oneof, so the payload of a
+    // send request is picked up by a second pass that keeps the preset member.
+    if (request.which_payload == MsgRequest_socketSendRequest_tag) {
+        request.payload.socketSendRequest.data.funcs.decode = dataDecodeCb;
+        request.payload.socketSendRequest.data.arg = &sendData;
+
+        istream = pb_istream_from_buffer(data, size);
+        if (!pb_decode_ex(&istream, MsgRequest_fields, &request, PB_DECODE_NOINIT))
+            return {nullptr, 0};
+    }
+
+    MsgResponse response = MsgResponse_init_zero;
+    ReceiveBuffer receiveBuffer;
+    BufferEncodeContext receiveContext{nullptr, 0};
+
+    response.id = request.id;
+    response.which_payload = request.which_payload;
+
+    switch (request.which_payload) {
+        case MsgRequest_socketOpenRequest_tag:
+            SocketOpen(request.payload.socketOpenRequest, response.payload.socketOpenResponse);
+            break;
+
+        case MsgRequest_socketBindRequest_tag:
+            SocketBind(request.payload.socketBindRequest, response.payload.socketBindResponse);
+            break;
+
+        case MsgRequest_socketAddrRequest_tag:
+            SocketAddr(request.payload.socketAddrRequest, response.payload.socketAddrResponse);
+            break;
+
+        case MsgRequest_socketSendRequest_tag:
+            SocketSend(request.payload.socketSendRequest, sendData.data(), sendData.size(),
+                       response.payload.socketSendResponse);
+            break;
+
+        case MsgRequest_socketReceiveRequest_tag:
+            SocketReceive(request.payload.socketReceiveRequest,
+                          response.payload.socketReceiveResponse, receiveBuffer);
+
+            receiveContext = {receiveBuffer.data.get(), receiveBuffer.len};
+            response.payload.socketReceiveResponse.data.funcs.encode = dataEncodeCb;
+            response.payload.socketReceiveResponse.data.arg = &receiveContext;
+
+            break;
+
+        case MsgRequest_socketCloseRequest_tag:
+            SocketClose(request.payload.socketCloseRequest, response.payload.socketCloseResponse);
+            break;
+
+        case MsgRequest_getHostByNameRequest_tag:
+            GetHostByName(request.payload.getHostByNameRequest,
+                          response.payload.getHostByNameResponse);
+            break;
+
+        case MsgRequest_getServByNameRequest_tag:
+            GetServByName(request.payload.getServByNameRequest,
+                          response.payload.getServByNameResponse);
+            break;
+
+        case MsgRequest_socketConnectRequest_tag:
+            SocketConnect(request.payload.socketConnectRequest,
+                          response.payload.socketConnectResponse);
+            break;
+
+        case MsgRequest_selectRequest_tag:
+            Select(request.payload.selectRequest, response.payload.selectResponse);
+            break;
+
+        case MsgRequest_settingGetRequest_tag:
+            SettingGet(request.payload.settingGetRequest, response.payload.settingGetResponse);
+            break;
+
+        case MsgRequest_socketOptionSetRequest_tag:
+            SocketOptionSet(request.payload.socketOptionSetRequest,
+                            response.payload.socketOptionSetResponse);
+            break;
+
+        case MsgRequest_socketListenRequest_tag:
+            SocketListen(request.payload.socketListenRequest,
+                         response.payload.socketListenResponse);
+            break;
+
+        case MsgRequest_socketAcceptRequest_tag:
+            SocketAccept(request.payload.socketAcceptRequest,
+                         response.payload.socketAcceptResponse);
+            break;
+
+        case MsgRequest_socketOptionGetRequest_tag:
+            SocketOptionGet(request.payload.socketOptionGetRequest,
+                            response.payload.socketOptionGetResponse);
+            break;
+
+        default:
+            logging::printf("native network: unknown request %u", request.which_payload);
+
+            response.which_payload = MsgResponse_invalidRequestResponse_tag;
+            response.payload.invalidRequestResponse.tag = true;
+
+            break;
+    }
+
+    size_t responseSize;
+    if (!pb_get_encoded_size(&responseSize, MsgResponse_fields, &response)) return {nullptr, 0};
+
+    uint8* responseBuffer = new uint8[responseSize];
+    pb_ostream_t ostream = pb_ostream_from_buffer(responseBuffer, responseSize);
+
+    if (!pb_encode(&ostream, MsgResponse_fields, &response)) {
+        delete[] responseBuffer;
+
+        return {nullptr, 0};
+    }
+
+    return {responseBuffer, responseSize};
+}
+
+void NativeNetwork::Reset() {
+    for (int32 handle = 1; handle <= MAX_HANDLE; handle++) {
+        Socket& socket(sockets[handle]);
+        if (socket.fd < 0) continue;
+
+        shutdown(socket.fd, SHUT_RDWR);
+        close(socket.fd);
+
+        socket = Socket();
+    }
+}
+
+void NativeNetwork::SocketOpen(const MsgSocketOpenRequest& request,
+                               MsgSocketOpenResponse& response) {
+    response.handle = -1;
+
+    int type;
+    int protocol = 0;
+
+    switch (request.type) {
+        case PALM_SOCKET_TYPE_STREAM:
+            type = SOCK_STREAM;
+            break;
+
+        case PALM_SOCKET_TYPE_DGRAM:
+            type = SOCK_DGRAM;
+            break;
+
+        case PALM_SOCKET_TYPE_RAW:
+            type = SOCK_RAW;
+
+            if (request.protocol != 255 && request.protocol != 1) {
+                logging::printf("native network: unsupported protocol for RAW socket: %u",
+                                request.protocol);
+                response.err = netErrParamErr;
+
+                return;
+            }
+
+            protocol = IPPROTO_ICMP;
+            break;
+
+        default:
+            response.err = netErrParamErr;
+            return;
+    }
+
+    const int32 handle = GetFreeHandle();
+    if (handle == 0) {
+        response.err = netErrNoMoreSockets;
+        logError("failed to open socket", response.err);
+
+        return;
+    }
+
+    const int fd = socket(AF_INET, type, protocol);
+    if (fd < 0) {
+        response.err = errnoToPalm(errno);
+        logError("failed to open socket", response.err);
+
+        return;
+    }
+
+#ifdef SO_NOSIGPIPE
+    const int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+    if (!setNonblocking(fd)) {
+        response.err = errnoToPalm(errno);
+        logError("failed to open socket", response.err);
+        close(fd);
+
+        return;
+    }
+
+    sockets[handle] = {fd, type, false};
+
+    response.handle = handle;
+    response.err = 0;
+}
+
+void NativeNetwork::SocketBind(const MsgSocketBindRequest& request,
+                               MsgSocketBindResponse& response) {
+    Socket* socket = GetSocket(request.handle);
+    if (!socket) {
+        response.err = netErrParamErr;
+        return;
+    }
+
+    const sockaddr_in address = deserializeAddress(request.address);
+
+    response.err = ::bind(socket->fd, reinterpret_cast<const sockaddr*>(&address),
+                          sizeof(address)) == 0
+                       ? 0
+                       : errnoToPalm(errno);
+
+    logError("failed to bind socket", response.err);
+}
+
+void NativeNetwork::SocketAddr(const MsgSocketAddrRequest& request,
+                               MsgSocketAddrResponse& response) {
+    Socket* socket = GetSocket(request.handle);
+    if (!socket) {
+        response.err = netErrParamErr;
+        return;
+    }
+
+    sockaddr_in address;
+    socklen_t len;
+
+    if (request.requestAddressLocal) {
+        len = sizeof(address);
+
+        if (getsockname(socket->fd, reinterpret_cast<sockaddr*>(&address), &len) != 0) {
+            response.err = errnoToPalm(errno);
+            logError("failed to get socket addresses", response.err);
+
+            return;
+        }
+
+        response.has_addressLocal = true;
+        serializeAddress(address, response.addressLocal);
+    }
+
+    if (request.requestAddressRemote) {
+        len = sizeof(address);
+
+        if (getpeername(socket->fd, reinterpret_cast<sockaddr*>(&address), &len) != 0) {
+            response.err = errnoToPalm(errno);
+            logError("failed to get socket addresses", response.err);
+
+            return;
+        }
+
+        response.has_addressRemote = true;
+        serializeAddress(address, response.addressRemote);
+    }
+
+    response.err = 0;
+}
+
+void NativeNetwork::SocketSend(const MsgSocketSendRequest& request, const uint8* data, size_t len,
+                               MsgSocketSendResponse& response) {
+    response.bytesSent = -1;
+
+    Socket* socket = GetSocket(request.handle);
+    if (!socket) {
+        response.err = netErrParamErr;
+        return;
+    }
+
+    const int flags = translateFlags(request.flags) | SEND_FLAGS;
+    const int64 deadline = deadlineFor(request.timeout);
+
+    const uint8* payload = data;
+    size_t payloadLen = len;
+    bool hasAddress = request.has_address;
+    sockaddr_in address = deserializeAddress(request.address);
+
+    // Raw sockets receive a complete IP packet from Palm OS, but the host
+    // builds the IP header itself.
+    if (socket->type == SOCK_RAW) {
+        if (len >= IP_HEADER_MIN_SIZE && (data[0] >> 4) == 4 && (data[0] & 0x0f) >= 5 &&
+            data[9] == IPPROTO_ICMP && static_cast<size_t>(4 * (data[0] & 0x0f)) <= len) {
+            payload = data + 4 * (data[0] & 0x0f);
+            payloadLen = len - 4 * (data[0] & 0x0f);
+        }
+
+        if (!hasAddress) {
+            if (len < IP_HEADER_MIN_SIZE) {
+                response.err = netErrParamErr;
+                logError("failed to send: bad IPv4 packet", response.err);
+
+                return;
+            }
+
+            address.sin_addr.s_addr = htonl((data[16] << 24) | (data[17] << 16) |
+                                            (data[18] << 8) | data[19]);
+            address.sin_port = htons(1);
+            hasAddress = true;
+        }
+    }
+
+    ssize_t sent = 0;
+
+    response.err = retry(socket->fd, socket->nonblocking, POLLOUT, deadline, [&]() {
+        sent = hasAddress ? sendto(socket->fd, payload, payloadLen, flags,
+                                   reinterpret_cast<const sockaddr*>(&address), sizeof(address))
+                          : send(socket->fd, payload, payloadLen, flags);
+
+        return sent >= 0;
+    });
+
+    if (response.err == 0)
+        response.bytesSent = sent + (len - payloadLen);
+    else
+        logError("failed to send", response.err);
+}
+
+void NativeNetwork::SocketReceive(const MsgSocketReceiveRequest& request,
+                                  MsgSocketReceiveResponse& response, ReceiveBuffer& buffer) {
+    Socket* socket = GetSocket(request.handle);
+    if (!socket) {
+        response.err = netErrParamErr;
+        return;
+    }
+
+    const int flags = translateFlags(request.flags);
+    const int64 deadline = deadlineFor(request.timeout);
+
+    buffer.data = make_unique<uint8[]>(max(request.maxLen, 1u));
+
+    sockaddr_in address;
+    socklen_t addressLen = 0;
+    ssize_t received = 0;
+
+    response.err = retry(socket->fd, socket->nonblocking, POLLIN, deadline, [&]() {
+        addressLen = sizeof(address);
+        received = recvfrom(socket->fd, buffer.data.get(), request.maxLen, flags,
+                            reinterpret_cast<sockaddr*>(&address), &addressLen);
+
+        return received >= 0;
+    });
+
+    if (response.err != 0) {
+        logError("failed to receive", response.err);
+
+        return;
+    }
+
+    buffer.len = received;
+
+    if (request.addressRequested && addressLen >= sizeof(address)) {
+        response.has_address = true;
+        serializeAddress(address, response.address);
+    }
+}
+
+void NativeNetwork::SocketClose(const MsgSocketCloseRequest& request,
+                                MsgSocketCloseResponse& response) {
+    Socket* socket = GetSocket(request.handle);
+    if (!socket) {
+        response.err = netErrParamErr;
+        logError("failed to close socket", response.err);
+
+        return;
+    }
+
+    const int fd = socket->fd;
+    *socket = Socket();
+
+    if (shutdown(fd, SHUT_RDWR) != 0 && errno != ENOTCONN) {
+        response.err = errnoToPalm(errno);
+        logError("failed to close socket", response.err);
+    } else
+        response.err = 0;
+
+    close(fd);
+}
+
+void NativeNetwork::GetHostByName(const MsgGetHostByNameRequest& request,
+                                  MsgGetHostByNameResponse& response) {
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_CANONNAME;
+
+    addrinfo* result = nullptr;
+
+    if (int err = getaddrinfo(request.name, nullptr, &hints, &result); err != 0) {
+        response.err = gaiErrorToPalm(err);
+        logError("failed to resolve host", response.err);
+
+        return;
+    }
+
+    snprintf(response.name, sizeof(response.name), "%s",
+             result->ai_canonname ? result->ai_canonname : request.name);
+
+    for (addrinfo* info = result; info && response.addresses_count < MAX_ADDRESSES;
+         info = info->ai_next) {
+        if (info->ai_family != AF_INET) continue;
+
+        const uint32 ip =
+            ntohl(reinterpret_cast<const sockaddr_in*>(info->ai_addr)->sin_addr.s_addr);
+
+        bool duplicate = false;
+        for (pb_size_t i = 0; i < response.addresses_count; i++)
+            duplicate = duplicate || response.addresses[i] == ip;
+
+        if (!duplicate) response.addresses[response.addresses_count++] = ip;
+    }
+
+    freeaddrinfo(result);
+
+    response.err = 0;
+}
+
+void NativeNetwork::GetServByName(const MsgGetServByNameRequest& request,
+                                  MsgGetServByNameResponse& response) {
+    const servent* service = getservbyname(request.name, request.protocol);
+
+    if (!service) {
+        response.port = 0;
+        response.err = netErrUnknownService;
+
+        return;
+    }
+
+    response.port = ntohs(service->s_port);
+    response.err = 0;
+}
+
+void NativeNetwork::SocketConnect(const MsgSocketConnectRequest& request,
+                                  MsgSocketConnectResponse& response) {
+    Socket* socket = GetSocket(request.handle);
+    if (!socket) {
+        response.err = netErrParamErr;
+        return;
+    }
+
+    const sockaddr_in address = deserializeAddress(request.address);
+    const int64 deadline = deadlineFor(request.timeout);
+
+    if (connect(socket->fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0) {
+        response.err = 0;
+        return;
+    }
+
+    if (errno != EINPROGRESS && errno != EINTR) {
+        response.err = errnoToPalm(errno);
+        logError("failed to connect socket", response.err);
+
+        return;
+    }
+
+    if (socket->nonblocking) {
+        response.err = netErrWouldBlock;
+        return;
+    }
+
+    response.err = wait(socket->fd, false, POLLOUT, deadline);
+    if (response.err != 0) {
+        logError("failed to connect socket", response.err);
+        return;
+    }
+
+    int error = 0;
+    socklen_t len = sizeof(error);
+
+    if (getsockopt(socket->fd, SOL_SOCKET, SO_ERROR, &error, &len) != 0) error = errno;
+
+    response.err = error == 0 ? 0 : errnoToPalm(error);
+    logError("failed to connect socket", response.err);
+}
+
+void NativeNetwork::Select(const MsgSelectRequest& request, MsgSelectResponse& response) {
+    constexpr short POLL_READ = POLLIN | POLLHUP | POLLERR;
+    constexpr short POLL_WRITE = POLLOUT | POLLERR;
+    constexpr short POLL_EXCEPT = POLLPRI;
+
+    const int32 width = min(request.width, static_cast<uint32>(MAX_HANDLE + 1));
+    const int64 deadline =
+        now() + (request.timeout >= 0 ? min(static_cast<int64>(request.timeout), MAX_TIMEOUT)
+                                      : MAX_TIMEOUT);
+
+    vector<pollfd> pollFds;
+    vector<int32> handles;
+
+    for (int32 handle = 1; handle < width; handle++) {
+        const uint32 mask = 1 << handle;
+        if (sockets[handle].fd < 0) continue;
+
+        short events = 0;
+
+        if (request.readFDs & mask) events |= POLLIN;
+        if (request.writeFDs & mask) events |= POLLOUT;
+        if (request.exceptFDs & mask) events |= POLLPRI;
+
+        if (events == 0) continue;
+
+        pollFds.push_back({sockets[handle].fd, events, 0});
+        handles.push_back(handle);
+    }
+
+    response.readFDs = response.writeFDs = response.exceptFDs = 0;
+
+    while (true) {
+        const int result =
+            poll(pollFds.data(), pollFds.size(), max(deadline - now(), static_cast<int64>(0)));
+
+        if (result >= 0) break;
+
+        if (errno != EINTR) {
+            response.err = errnoToPalm(errno);
+            logError("select failed", response.err);
+
+            return;
+        }
+    }
+
+    for (size_t i = 0; i < pollFds.size(); i++) {
+        const uint32 mask = 1 << handles[i];
+        const short revents = pollFds[i].revents;
+
+        if ((request.readFDs & mask) && (revents & POLL_READ)) response.readFDs |= mask;
+        if ((request.writeFDs & mask) && (revents & POLL_WRITE)) response.writeFDs |= mask;
+        if ((request.exceptFDs & mask) && (revents & POLL_EXCEPT)) response.exceptFDs |= mask;
+    }
+
+    response.err = 0;
+}
+
+void NativeNetwork::SettingGet(const MsgSettingGetRequest& request,
+                               MsgSettingGetResponse& response) {
+    response.err = 0;
+
+    switch (request.setting) {
+        case netSettingHostName:
+            response.which_value = MsgSettingGetResponse_strval_tag;
+
+            if (gethostname(response.value.strval, sizeof(response.value.strval) - 1) != 0) {
+                response.err = errnoToPalm(errno);
+                logError("settingGet failed", response.err);
+            }
+
+            break;
+
+        case netSettingPrimaryDNS:
+        case netSettingSecondaryDNS:
+        case netSettingRTPrimaryDNS:
+        case netSettingRTSecondaryDNS:
+            response.which_value = MsgSettingGetResponse_uint32val_tag;
+            response.value.uint32val = nameserver();
+
+            break;
+
+        default:
+            response.err = netErrParamErr;
+            break;
+    }
+}
+
+void NativeNetwork::SocketOptionSet(const MsgSocketOptionSetRequest& request,
+                                    MsgSocketOptionSetResponse& response) {
+    Socket* socket = GetSocket(request.handle);
+    if (!socket) {
+        response.err = netErrParamErr;
+        logError("socketOptionSet failed", response.err);
+
+        return;
+    }
+
+    const bool isBuffer = request.which_value == MsgSocketOptionSetRequest_bufval_tag;
+    const int32 intval = isBuffer ? 0 : request.value.intval;
+
+    response.err = 0;
+
+    if (request.level == netSocketOptLevelSocket &&
+        request.option == netSocketOptSockNonBlocking) {
+        socket->nonblocking = isBuffer ? request.value.bufval.size > 0 : intval != 0;
+        return;
+    }
+
+    int level, option;
+    if (!translateSockopt(request.level, request.option, level, option)) {
+        response.err = netErrParamErr;
+        return;
+    }
+
+    int result;
+
+    if (isBuffer) {
+        result = setsockopt(socket->fd, level, option, request.value.bufval.bytes,
+                            request.value.bufval.size);
+    } else if (request.level == netSocketOptLevelSocket &&
+               request.option == netSocketOptSockLinger) {
+        linger value{intval & 0xffff, (intval >> 16) & 0xffff};
+
+        result = setsockopt(socket->fd, level, option, &value, sizeof(value));
+    } else
+        result = setsockopt(socket->fd, level, option, &intval, sizeof(intval));
+
+    if (result != 0) {
+        response.err = errnoToPalm(errno);
+        logError("socketOptionSet failed", response.err);
+    }
+}
+
+void NativeNetwork::SocketOptionGet(const MsgSocketOptionGetRequest& request,
+                                    MsgSocketOptionGetResponse& response) {
+    Socket* socket = GetSocket(request.handle);
+    if (!socket) {
+        response.err = netErrParamErr;
+        logError("socketOptionGet failed", response.err);
+
+        return;
+    }
+
+    response.err = 0;
+
+    if (request.level == netSocketOptLevelSocket &&
+        request.option == netSocketOptSockNonBlocking) {
+        response.which_value = MsgSocketOptionGetResponse_intval_tag;
+        response.value.intval = socket->nonblocking;
+
+        return;
+    }
+
+    int level, option;
+    if (!translateSockopt(request.level, request.option, level, option)) {
+        response.err = netErrParamErr;
+        return;
+    }
+
+    int result;
+
+    if (request.level == netSocketOptLevelSocket && request.option == netSocketOptSockLinger) {
+        linger value;
+        socklen_t len = sizeof(value);
+
+        result = getsockopt(socket->fd, level, option, &value, &len);
+
+        response.which_value = MsgSocketOptionGetResponse_intval_tag;
+        response.value.intval = (value.l_onoff & 0xffff) | ((value.l_linger & 0xffff) << 16);
+    } else if (request.level == netSocketOptLevelIP) {
+        socklen_t len = IP_OPTIONS_SIZE;
+
+        result = getsockopt(socket->fd, level, option, response.value.bufval.bytes, &len);
+
+        response.which_value = MsgSocketOptionGetResponse_bufval_tag;
+        response.value.bufval.size = len;
+    } else {
+        int value = 0;
+        socklen_t len = sizeof(value);
+
+        result = getsockopt(socket->fd, level, option, &value, &len);
+
+        response.which_value = MsgSocketOptionGetResponse_intval_tag;
+        response.value.intval = value;
+    }
+
+    if (result != 0) {
+        response.which_value = 0;
+        response.err = errnoToPalm(errno);
+        logError("socketOptionGet failed", response.err);
+    }
+}
+
+void NativeNetwork::SocketListen(const MsgSocketListenRequest& request,
+                                 MsgSocketListenResponse& response) {
+    Socket* socket = GetSocket(request.handle);
+    if (!socket) {
+        response.err = netErrParamErr;
+        logError("socketListen failed", response.err);
+
+        return;
+    }
+
+    response.err = listen(socket->fd, request.backlog) == 0 ? 0 : errnoToPalm(errno);
+    logError("socketListen failed", response.err);
+}
+
+void NativeNetwork::SocketAccept(const MsgSocketAcceptRequest& request,
+                                 MsgSocketAcceptResponse& response) {
+    response.handle = -1;
+
+    const int32 handle = GetFreeHandle();
+    if (handle == 0) {
+        response.err = netErrNoMoreSockets;
+        logError("socketAccept failed", response.err);
+
+        return;
+    }
+
+    Socket* socket = GetSocket(request.handle);
+    if (!socket) {
+        response.err = netErrParamErr;
+        logError("socketAccept failed", response.err);
+
+        return;
+    }
+
+    const int64 deadline = deadlineFor(request.timeout);
+
+    sockaddr_in address;
+    socklen_t len;
+    int fd = -1;
+
+    response.err = retry(socket->fd, socket->nonblocking, POLLIN, deadline, [&]() {
+        len = sizeof(address);
+        fd = accept(socket->fd, reinterpret_cast<sockaddr*>(&address), &len);
+
+        return fd >= 0;
+    });
+
+    if (response.err == 0 && !setNonblocking(fd)) {
+        response.err = errnoToPalm(errno);
+        close(fd);
+    }
+
+    if (response.err != 0) {
+        logError("socketAccept failed", response.err);
+        return;
+    }
+
+    sockets[handle] = {fd, socket->type, false};
+
+    response.handle = handle;
+    serializeAddress(address, response.address);
+}
+
+NativeNetwork::Socket* NativeNetwork::GetSocket(int32 handle) {
+    if (handle < 1 || handle > MAX_HANDLE || sockets[handle].fd < 0) return nullptr;
+
+    return &sockets[handle];
+}
+
+int32 NativeNetwork::GetFreeHandle() const {
+    for (int32 handle = 1; handle <= MAX_HANDLE; handle++)
+        if (sockets[handle].fd < 0) return handle;
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+#ifndef _NATIVE_NETWORK_H_
+#define _NATIVE_NETWORK_H_
+
+#include <memory>
+
+#include "EmCommon.h"
+#include "networking.pb.h"
+
+// Carries out the requests of networking.proto directly against the sockets of
+// the host, mirroring the behavior of the proxy server. All host sockets are
+// nonblocking; blocking calls are emulated by polling with the timeout from the
+// request (capped at ten seconds, just like the server does).
+//
+// The class is not thread safe and is meant to be driven by a single I/O
+// thread.
+
+class NativeNetwork {
+   public:
+    static constexpr int32 MAX_HANDLE = 31;
+
+   public:
+    NativeNetwork() = default;
+    ~NativeNetwork();
+
+    // Decodes and executes a serialized MsgRequest and returns the serialized
+    // MsgResponse. The buffer is allocated with new[] and owned by the caller.
+    // Returns nullptr if the request cannot be decoded.
+    pair<uint8*, size_t> HandleRequest(const uint8* request, size_t size);
+
+    // Closes all sockets.
+    void Reset();
+
+   private:
+    struct Socket {
+        int fd{-1};
+        int type{0};
+        bool nonblocking{false};
+    };
+
+    struct ReceiveBuffer {
+        unique_ptr<uint8[]> data;
+        size_t len{0};
+    };
+
+   private:
+    void SocketOpen(const MsgSocketOpenRequest& request, MsgSocketOpenResponse& response);
+    void SocketBind(const MsgSocketBindRequest& request, MsgSocketBindResponse& response);
+    void SocketAddr(const MsgSocketAddrRequest& request, MsgSocketAddrResponse& response);
+    void SocketSend(const MsgSocketSendRequest& request, const uint8* data, size_t len,
+                    MsgSocketSendResponse& response);
+    void SocketReceive(const MsgSocketReceiveRequest& request, MsgSocketReceiveResponse& response,
+                       ReceiveBuffer& buffer);
+    void SocketClose(const MsgSocketCloseRequest& request, MsgSocketCloseResponse& response);
+    void GetHostByName(const MsgGetHostByNameRequest& request, MsgGetHostByNameResponse& response);
+    void GetServByName(const MsgGetServByNameRequest& request, MsgGetServByNameResponse& response);
+    void SocketConnect(const MsgSocketConnectRequest& request, MsgSocketConnectResponse& response);
+    void Select(const MsgSelectRequest& request, MsgSelectResponse& response);
+    void SettingGet(const MsgSettingGetRequest& request, MsgSettingGetResponse& response);
+    void SocketOptionSet(const MsgSocketOptionSetRequest& request,
+                         MsgSocketOptionSetResponse& response);
+    void SocketOptionGet(const MsgSocketOptionGetRequest& request,
+                         MsgSocketOptionGetResponse& response);
+    void SocketListen(const MsgSocketListenRequest& request, MsgSocketListenResponse& response);
+    void SocketAccept(const MsgSocketAcceptRequest& request, MsgSocketAcceptResponse& response);
+
+    Socket* GetSocket(int32 handle);
+    int32 GetFreeHandle() const;
+
+   private:
+    Socket sockets[MAX_HANDLE + 1];
+
+   private:
+    NativeNetwork(const NativeNetwork&) = delete;
+    NativeNetwork(NativeNetwork&&) = delete;
+    NativeNetwork& operator=(const NativeNetwork&) = delete;
+    NativeNetwork& operator=(NativeNetwork&&) = delete;
+};
+
+#endif  // _NATIVE_NETWORK_H_
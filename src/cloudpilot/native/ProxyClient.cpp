@@ -13,8 +13,10 @@
 #include <chrono>
 #include <condition_variable>
 #include <cstdio>
+#include <deque>
 #include <functional>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
@@ -89,6 +91,7 @@ class ProxyClientImpl : public ProxyClient {
         terminating = false;
 
         if (t.joinable()) t.join();
+        receiveQueue.clear();
         t = thread(bind(&ProxyClientImpl::ThreadMain, this));
 
         return true;
@@ -122,14 +125,19 @@ class ProxyClientImpl : public ProxyClient {
     }
 
     pair<uint8*, size_t> Receive() override {
-        if (ws.is_open()) {
-            unique_lock<mutex> lock(receiveMutex);
+        unique_lock<mutex> lock(receiveMutex);
 
-            while (!receiveBuffer && ws.is_open()) receiveCv.wait(lock);
-        }
+        while (receiveQueue.empty() && ws.is_open()) receiveCv.wait(lock);
+
+        return PopResponse();
+    }
 
-        return receiveBuffer ? make_pair(receiveBuffer.release(), receiveBufferSize)
-                             : make_pair(nullptr, 0);
+    bool TryReceive(pair<uint8*, size_t>& response) override {
+        unique_lock<mutex> lock(receiveMutex);
+
+        response = PopResponse();
+
+        return response.first || ws.is_open();
     }
 
    private:
@@ -158,12 +166,10 @@ class ProxyClientImpl : public ProxyClient {
                 }
 
                 if (ws.is_open()) {
-                    if (receiveBuffer) logging::printf("WARNING: discarding pending response");
-
-                    receiveBufferSize = buffer.size();
-                    receiveBuffer = make_unique<uint8[]>(receiveBufferSize);
+                    auto response = make_unique<uint8[]>(buffer.size());
+                    memcpy(response.get(), buffer.cdata().data(), buffer.size());
 
-                    memcpy(receiveBuffer.get(), buffer.cdata().data(), receiveBufferSize);
+                    receiveQueue.emplace_back(move(response), buffer.size());
                 }
             }
 
@@ -179,6 +185,17 @@ class ProxyClientImpl : public ProxyClient {
         terminatingCv.notify_one();
     }
 
+    pair<uint8*, size_t> PopResponse() {
+        if (receiveQueue.empty()) return {nullptr, 0};
+
+        auto& [data, size] = receiveQueue.front();
+        auto response = make_pair(data.release(), size);
+
+        receiveQueue.pop_front();
+
+        return response;
+    }
+
     bool Handshake(const tcp::resolver::results_type& resolveResults, string& token) {
         boost::system::error_code err;
 
@@ -248,8 +265,7 @@ class ProxyClientImpl : public ProxyClient {
     string port;
     string path;
 
-    unique_ptr<uint8[]> receiveBuffer;
-    size_t receiveBufferSize;
+    deque<pair<unique_ptr<uint8[]>, size_t>> receiveQueue;
 
     mutex receiveMutex;
     condition_variable receiveCv;
@@ -7,6 +7,10 @@ class ProxyClient {
    public:
     static ProxyClient* Create(const string& host, const long port, const string& path);
 
+    // Executes requests in process against the sockets of the host instead of
+    // forwarding them to a proxy server.
+    static ProxyClient* CreateNative();
+
     virtual ~ProxyClient() = default;
 
     virtual bool Connect() = 0;
@@ -16,6 +20,10 @@ class ProxyClient {
 
     virtual std::pair<uint8*, size_t> Receive() = 0;
 
+    // Nonblocking variant of Receive. Returns false if the connection is down;
+    // the response is nullptr if there is none pending.
+    virtual bool TryReceive(std::pair<uint8*, size_t>& response) = 0;
+
    protected:
     ProxyClient() = default;
 
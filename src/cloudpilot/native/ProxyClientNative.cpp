@@ -0,0 +1,142 @@
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Logging.h"
+#include "NativeNetwork.h"
+#include "ProxyClient.h"
+
+class ProxyClientNative : public ProxyClient {
+   public:
+    ProxyClientNative() = default;
+
+    ~ProxyClientNative() override { Disconnect(); }
+
+    bool Connect() override {
+        {
+            unique_lock<mutex> lock(mut);
+
+            if (running) return true;
+        }
+
+        if (t.joinable()) t.join();
+
+        running = true;
+        t = thread(bind(&ProxyClientNative::ThreadMain, this));
+
+        return true;
+    }
+
+    void Disconnect() override {
+        {
+            unique_lock<mutex> lock(mut);
+
+            running = false;
+        }
+
+        requestCv.notify_one();
+        responseCv.notify_one();
+
+        if (t.joinable()) t.join();
+
+        requests.clear();
+        network.Reset();
+    }
+
+    bool Send(const uint8* message, size_t size) override {
+        {
+            unique_lock<mutex> lock(mut);
+
+            if (!running) return false;
+
+            requests.emplace_back(message, message + size);
+        }
+
+        requestCv.notify_one();
+
+        return true;
+    }
+
+    pair<uint8*, size_t> Receive() override {
+        unique_lock<mutex> lock(mut);
+
+        while (responses.empty() && running) responseCv.wait(lock);
+        if (responses.empty()) return {nullptr, 0};
+
+        auto response = responses.front();
+        responses.pop_front();
+
+        return response;
+    }
+
+    bool TryReceive(pair<uint8*, size_t>& response) override {
+        unique_lock<mutex> lock(mut);
+
+        response = {nullptr, 0};
+        if (!running && responses.empty()) return false;
+
+        if (!responses.empty()) {
+            response = responses.front();
+            responses.pop_front();
+        }
+
+        return true;
+    }
+
+   private:
+    void ThreadMain() {
+        unique_lock<mutex> lock(mut);
+
+        while (true) {
+            while (requests.empty() && running) requestCv.wait(lock);
+            if (!running) break;
+
+            vector<uint8> request = move(requests.front());
+            requests.pop_front();
+
+            lock.unlock();
+
+            auto response = network.HandleRequest(request.data(), request.size());
+            if (!response.first) logging::printf("native network: bad request");
+
+            lock.lock();
+
+            if (!response.first) {
+                running = false;
+                break;
+            }
+
+            responses.push_back(response);
+            responseCv.notify_one();
+        }
+
+        for (auto& response : responses) delete[] response.first;
+        responses.clear();
+
+        responseCv.notify_one();
+    }
+
+   private:
+    NativeNetwork network;
+    thread t;
+
+    bool running{false};
+
+    deque<vector<uint8>> requests;
+    deque<pair<uint8*, size_t>> responses;
+
+    mutex mut;
+    condition_variable requestCv;
+    condition_variable responseCv;
+
+   private:
+    ProxyClientNative(const ProxyClientNative&) = delete;
+    ProxyClientNative(ProxyClientNative&&) = delete;
+    ProxyClientNative& operator=(const ProxyClientNative&) = delete;
+    ProxyClientNative& operator=(ProxyClientNative&&) = delete;
+};
+
+ProxyClient* ProxyClient::CreateNative() { return new ProxyClientNative(); }
@@ -22,15 +22,20 @@ void ProxyHandler::Initialize() {
     if (onDisconnectHandle) return;
 
     onDisconnectHandle =
-        gNetworkProxy.onDisconnect.AddHandler(bind(&ProxyHandler::OnDisconnectHandler, this, _1));
+        gNetworkProxy->onDisconnect.AddHandler(bind(&ProxyHandler::OnDisconnectHandler, this, _1));
+
+    gNetworkProxy->SetTransport(bind(&ProxyClient::Send, &client, _1, _2));
 }
 
 void ProxyHandler::Teardown() {
     client.Disconnect();
     sessionId = "";
 
+    gNetworkProxy->SetTransport(nullptr);
+    gNetworkProxy->CancelPendingCalls();
+
     if (onDisconnectHandle) {
-        gNetworkProxy.onDisconnect.RemoveHandler(*onDisconnectHandle);
+        gNetworkProxy->onDisconnect.RemoveHandler(*onDisconnectHandle);
         onDisconnectHandle.reset();
     }
 }
@@ -54,6 +59,23 @@ void ProxyHandler::HandleSuspend() {
     }
 }
 
+void ProxyHandler::DispatchResponses() {
+    if (gNetworkProxy->PendingCallCount() == 0) return;
+
+    pair<uint8*, size_t> response;
+
+    while (client.TryReceive(response)) {
+        if (!response.first) return;
+
+        gNetworkProxy->DispatchResponse(response.first, response.second);
+        delete[] response.first;
+    }
+
+    logging::printf("ERROR: network proxy connection lost");
+
+    gNetworkProxy->CancelPendingCalls();
+}
+
 void ProxyHandler::HandleConnect(SuspendContext& context) {
     client.Disconnect();
     sessionId = "";
@@ -97,4 +119,6 @@ void ProxyHandler::OnDisconnectHandler(const string& sessionId) {
 
     client.Disconnect();
     this->sessionId = "";
+
+    gNetworkProxy->CancelPendingCalls();
 }
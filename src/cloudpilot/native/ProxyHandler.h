@@ -18,6 +18,9 @@ class ProxyHandler {
 
     void HandleSuspend();
 
+    // Hands the responses that have arrived so far to the network proxy.
+    void DispatchResponses();
+
    private:
     void HandleConnect(SuspendContext& context);
     void HandleRpc(SuspendContext& context);
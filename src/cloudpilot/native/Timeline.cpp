@@ -0,0 +1,184 @@
+#include "Timeline.h"
+
+#include <cstdlib>
+#include <sstream>
+#include <unordered_map>
+
+#include "EmSession.h"
+
+using namespace std;
+
+namespace {
+    const unordered_map<string, ButtonEvent::Button> BUTTONS = {
+        {"app1", ButtonEvent::Button::app1},
+        {"app2", ButtonEvent::Button::app2},
+        {"app3", ButtonEvent::Button::app3},
+        {"app4", ButtonEvent::Button::app4},
+        {"up", ButtonEvent::Button::rockerUp},
+        {"down", ButtonEvent::Button::rockerDown},
+        {"power", ButtonEvent::Button::power},
+        {"cradle", ButtonEvent::Button::cradle},
+        {"contrast", ButtonEvent::Button::contrast},
+        {"antenna", ButtonEvent::Button::antenna},
+        {"wheel-up", ButtonEvent::Button::wheelUp},
+        {"wheel-down", ButtonEvent::Button::wheelDown},
+        {"wheel-push", ButtonEvent::Button::wheelPush}};
+
+    bool parseNumber(const string& token, long& value) {
+        if (token.empty()) return false;
+
+        char* end;
+        value = strtol(token.c_str(), &end, 0);
+
+        return *end == '\0';
+    }
+}  // namespace
+
+bool Timeline::Parse(istream& stream, string& error) {
+    events.clear();
+    nextEvent = 0;
+
+    string line;
+    int lineNumber = 0;
+
+    while (getline(stream, line)) {
+        lineNumber++;
+
+        if (!ParseLine(line, error)) {
+            error = "line " + to_string(lineNumber) + ": " + error;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Timeline::ParseLine(const string& line, string& error) {
+    istringstream tokenizer(line);
+    vector<string> tokens;
+
+    for (string token; tokenizer >> token;) tokens.push_back(token);
+
+    if (tokens.empty() || tokens[0][0] == '#') return true;
+
+    long msec;
+    if (!parseNumber(tokens[0], msec) || msec < 0) {
+        error = "invalid time";
+        return false;
+    }
+
+    if (!events.empty() && static_cast<uint64>(msec) < events.back().msec) {
+        error = "time must not decrease";
+        return false;
+    }
+
+    if (tokens.size() < 2) {
+        error = "missing event";
+        return false;
+    }
+
+    Event event;
+    event.msec = msec;
+
+    if (tokens[1] == "pen") {
+        event.kind = Event::Kind::pen;
+
+        long x, y;
+
+        if (tokens.size() == 3 && tokens[2] == "up") {
+            event.penEvent = PenEvent::up();
+        } else if (tokens.size() == 4 && parseNumber(tokens[2], x) && parseNumber(tokens[3], y)) {
+            event.penEvent = PenEvent::down(x, y);
+        } else {
+            error = "usage: pen <x> <y> | pen up";
+            return false;
+        }
+
+        events.push_back(event);
+
+        return true;
+    }
+
+    if (tokens[1] == "key") {
+        event.kind = Event::Kind::key;
+
+        long code;
+
+        if (tokens.size() != 3) {
+            error = "usage: key <char | code>";
+            return false;
+        }
+
+        if (tokens[2].size() == 1) {
+            event.key = static_cast<uint8>(tokens[2][0]);
+        } else if (parseNumber(tokens[2], code) && code >= 0 && code <= 0xffff) {
+            event.key = code;
+        } else {
+            error = "invalid key";
+            return false;
+        }
+
+        events.push_back(event);
+
+        return true;
+    }
+
+    if (tokens[1] == "button") {
+        event.kind = Event::Kind::button;
+
+        if (tokens.size() < 3 || tokens.size() > 4) {
+            error = "usage: button <name> [down | up]";
+            return false;
+        }
+
+        auto button = BUTTONS.find(tokens[2]);
+        if (button == BUTTONS.end()) {
+            error = "invalid button " + tokens[2];
+            return false;
+        }
+
+        event.button = button->second;
+
+        if (tokens.size() == 4 && tokens[3] != "down" && tokens[3] != "up") {
+            error = "button state must be down or up";
+            return false;
+        }
+
+        if (tokens.size() == 3 || tokens[3] == "down") {
+            event.buttonType = ButtonEvent::Type::press;
+            events.push_back(event);
+        }
+
+        if (tokens.size() == 3 || tokens[3] == "up") {
+            event.buttonType = ButtonEvent::Type::release;
+            events.push_back(event);
+        }
+
+        return true;
+    }
+
+    error = "invalid event " + tokens[1];
+    return false;
+}
+
+uint64 Timeline::Dispatch(uint64 msec) {
+    while (nextEvent < events.size() && events[nextEvent].msec <= msec) {
+        const Event& event(events[nextEvent++]);
+
+        switch (event.kind) {
+            case Event::Kind::pen:
+                gSession->QueuePenEvent(event.penEvent);
+                break;
+
+            case Event::Kind::key:
+                gSession->QueueKeyboardEvent(event.key);
+                break;
+
+            case Event::Kind::button:
+                gSession->QueueButtonEvent(ButtonEvent(event.button, event.buttonType));
+                break;
+        }
+    }
+
+    return nextEvent < events.size() ? events[nextEvent].msec : ~0ull;
+}
@@ -0,0 +1,52 @@
+#ifndef _TIMELINE_H_
+#define _TIMELINE_H_
+
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "ButtonEvent.h"
+#include "EmCommon.h"
+#include "PenEvent.h"
+
+// A scripted sequence of input events for unattended runs. The script is
+// line based, with one event per line:
+//
+//   <msec> pen <x> <y>                  pen down / move
+//   <msec> pen up
+//   <msec> key <char | code>            single character or numeric key code
+//   <msec> button <name> [down | up]    hard button; press and release if omitted
+//
+// Times are milliseconds of emulated time since the start of the run and must
+// not decrease. Empty lines and lines starting with '#' are ignored.
+
+class Timeline {
+   public:
+    struct Event {
+        enum class Kind { pen, key, button };
+
+        uint64 msec{0};
+        Kind kind{Kind::pen};
+
+        PenEvent penEvent;
+        uint16 key{0};
+        ButtonEvent::Button button{ButtonEvent::Button::invalid};
+        ButtonEvent::Type buttonType{ButtonEvent::Type::press};
+    };
+
+   public:
+    bool Parse(std::istream& stream, std::string& error);
+
+    // Queues all events that are due at the given emulated time. Returns the
+    // time of the next pending event, or ~0 if the timeline is exhausted.
+    uint64 Dispatch(uint64 msec);
+
+   private:
+    bool ParseLine(const std::string& line, std::string& error);
+
+   private:
+    std::vector<Event> events;
+    size_t nextEvent{0};
+};
+
+#endif  // _TIMELINE_H_
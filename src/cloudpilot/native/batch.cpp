@@ -0,0 +1,352 @@
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "EmCPU68K.h"
+#include "EmCommon.h"
+#include "EmSession.h"
+#include "SuspendContext.h"
+#include "SuspendContextClipboardCopy.h"
+#include "SuspendManager.h"
+#include "Timeline.h"
+#include "argparse.h"
+#include "util.h"
+
+using namespace std;
+
+// Headless batch runner: every run loads an image in a separate process,
+// replays the input timeline and executes a fixed amount of emulated time as
+// fast as possible. Runs are fanned out over a configurable number of worker
+// processes.
+
+namespace {
+    constexpr uint32 MAX_SLICE_CYCLES = 1000000;
+
+    struct Options {
+        vector<string> images;
+        optional<string> deviceId;
+        optional<string> timelineFile;
+        double seconds;
+        unsigned int jobs;
+        unsigned int repeat;
+        bool verbose;
+    };
+
+    struct Run {
+        size_t index;
+        string image;
+    };
+
+    // Sent from the worker to the parent through a pipe.
+    struct RunResult {
+        bool success;
+        uint64 cycles;
+        uint64 instructions;
+        double msecEmulated;
+        double wallSeconds;
+    };
+
+    // There is no host to serve a suspended session, so copies go nowhere and every other
+    // request fails as if the host had declined it. Otherwise RunEmulation would idle through
+    // the remaining run without executing a single instruction.
+    void handleSuspend() {
+        if (!SuspendManager::IsSuspended()) return;
+
+        SuspendContext& context = SuspendManager::GetContext();
+
+        switch (context.GetKind()) {
+            case SuspendContext::Kind::clipboardCopy:
+                context.AsContextClipboardCopy().Resume();
+                break;
+
+            default:
+                context.Cancel();
+                break;
+        }
+    }
+
+    bool execute(const string& image, const Options& options, Timeline& timeline,
+                 RunResult& result) {
+        if (!(options.deviceId ? util::initializeSession(image, *options.deviceId)
+                               : util::initializeSession(image)))
+            return false;
+
+        const double durationMsec = options.seconds * 1000.;
+        const uint64 cyclesBefore = gSession->GetSystemCycles();
+        const uint64 instructionsBefore = gCPU68K->GetInstructionCount();
+
+        double msec = 0;
+        uint64 nextEventMsec = timeline.Dispatch(0);
+
+        const auto timestampStart = chrono::steady_clock::now();
+
+        while (msec < durationMsec) {
+            const uint32 clocksPerSecond = gSession->GetClocksPerSecond();
+            const double sliceMsec = min(durationMsec, static_cast<double>(nextEventMsec)) - msec;
+
+            const uint32 cycles = max(
+                min(sliceMsec * clocksPerSecond / 1000., static_cast<double>(MAX_SLICE_CYCLES)),
+                1.);
+
+            msec += gSession->RunEmulation(cycles) * 1000. / clocksPerSecond;
+
+            handleSuspend();
+
+            if (SuspendManager::IsSuspended()) {
+                cerr << image << ": session remains suspended, aborting run" << endl;
+                return false;
+            }
+
+            if (msec >= nextEventMsec) nextEventMsec = timeline.Dispatch(msec);
+        }
+
+        result.wallSeconds =
+            chrono::duration<double>(chrono::steady_clock::now() - timestampStart).count();
+        result.cycles = gSession->GetSystemCycles() - cyclesBefore;
+        result.instructions = gCPU68K->GetInstructionCount() - instructionsBefore;
+        result.msecEmulated = msec;
+        result.success = true;
+
+        return true;
+    }
+
+    pid_t spawn(const Run& run, const Options& options, Timeline& timeline, int& fd) {
+        cout << flush;
+
+        int fds[2];
+        if (pipe(fds) != 0) {
+            perror("pipe");
+            return -1;
+        }
+
+        const pid_t pid = fork();
+
+        if (pid < 0) {
+            perror("fork");
+
+            close(fds[0]);
+            close(fds[1]);
+
+            return -1;
+        }
+
+        if (pid > 0) {
+            close(fds[1]);
+            fd = fds[0];
+
+            return pid;
+        }
+
+        close(fds[0]);
+
+        if (!options.verbose && !freopen("/dev/null", "w", stdout)) perror("freopen");
+
+        RunResult result{.success = false};
+        execute(run.image, options, timeline, result);
+
+        const bool written = write(fds[1], &result, sizeof(result)) == sizeof(result);
+        close(fds[1]);
+
+        _exit(written && result.success ? 0 : 1);
+    }
+
+    void report(const Run& run, size_t runCount, const RunResult& result) {
+        cout << "[" << (run.index + 1) << "/" << runCount << "] " << run.image << ": ";
+
+        if (!result.success) {
+            cout << "FAILED" << endl;
+            return;
+        }
+
+        cout << fixed << setprecision(2) << result.msecEmulated / 1000. << " s emulated, "
+             << result.instructions / 1e6 << " M instructions in " << result.wallSeconds
+             << " s: " << result.instructions / result.wallSeconds / 1e6 << " MIPS, "
+             << result.cycles / result.wallSeconds / 1e6 << " Mcycles/s, "
+             << result.msecEmulated / 1000. / result.wallSeconds << "x realtime" << endl
+             << defaultfloat;
+    }
+
+    int runAll(const Options& options, Timeline& timeline) {
+        vector<Run> runs;
+
+        for (unsigned int i = 0; i < options.repeat; i++)
+            for (auto& image : options.images) runs.push_back({runs.size(), image});
+
+        map<pid_t, pair<Run, int>> workers;
+        size_t nextRun = 0;
+        size_t failures = 0;
+
+        RunResult total{.success = true};
+
+        const auto timestampStart = chrono::steady_clock::now();
+
+        while (nextRun < runs.size() || !workers.empty()) {
+            while (nextRun < runs.size() && workers.size() < options.jobs) {
+                int fd;
+                const Run& run(runs[nextRun++]);
+                const pid_t pid = spawn(run, options, timeline, fd);
+
+                if (pid < 0) {
+                    failures++;
+                    report(run, runs.size(), RunResult{.success = false});
+
+                    continue;
+                }
+
+                workers[pid] = {run, fd};
+            }
+
+            if (workers.empty()) continue;
+
+            int status;
+            const pid_t pid = wait(&status);
+            if (pid < 0) break;
+
+            auto worker = workers.find(pid);
+            if (worker == workers.end()) continue;
+
+            auto [run, fd] = worker->second;
+            workers.erase(worker);
+
+            RunResult result{.success = false};
+            if (read(fd, &result, sizeof(result)) != sizeof(result)) result.success = false;
+            close(fd);
+
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) result.success = false;
+
+            report(run, runs.size(), result);
+
+            if (!result.success) {
+                failures++;
+                continue;
+            }
+
+            total.cycles += result.cycles;
+            total.instructions += result.instructions;
+            total.msecEmulated += result.msecEmulated;
+        }
+
+        const double wallSeconds =
+            chrono::duration<double>(chrono::steady_clock::now() - timestampStart).count();
+
+        cout << endl
+             << runs.size() - failures << " of " << runs.size() << " runs succeeded in " << fixed
+             << setprecision(2) << wallSeconds << " s with " << options.jobs
+             << " jobs: " << total.instructions / wallSeconds / 1e6 << " MIPS, "
+             << total.cycles / wallSeconds / 1e6 << " Mcycles/s aggregate" << endl;
+
+        return failures > 0 ? 1 : 0;
+    }
+}  // namespace
+
+int main(int argc, const char** argv) {
+    class bad_device_id : public exception {};
+
+    argparse::ArgumentParser program("cloudpilot-batch");
+
+    program.add_description(
+        "Run CloudpilotEmu sessions headless and as fast as possible, one process per run.");
+
+    program.add_argument("images")
+        .help("images or ROM files")
+        .nargs(argparse::nargs_pattern::at_least_one);
+
+    program.add_argument("--device-id", "-d")
+        .help("specify device ID")
+        .metavar("<device>")
+        .action([](const string& value) -> string {
+            for (auto& deviceId : util::SUPPORTED_DEVICES)
+                if (value == deviceId) return deviceId;
+
+            throw bad_device_id();
+        });
+
+    program.add_argument("--timeline", "-t")
+        .metavar("<timeline file>")
+        .help("replay pen, key and button events from file");
+
+    program.add_argument("--seconds", "-s")
+        .metavar("<seconds>")
+        .help("emulated time per run")
+        .default_value(60.)
+        .scan<'g', double>();
+
+    program.add_argument("--jobs", "-j")
+        .metavar("<jobs>")
+        .help("number of parallel worker processes")
+        .default_value(max(sysconf(_SC_NPROCESSORS_ONLN), 1l))
+        .scan<'i', long>();
+
+    program.add_argument("--repeat", "-r")
+        .metavar("<count>")
+        .help("number of runs per image")
+        .default_value(1l)
+        .scan<'i', long>();
+
+    program.add_argument("--verbose", "-v")
+        .help("do not silence emulator output")
+        .default_value(false)
+        .implicit_value(true);
+
+    try {
+        program.parse_args(argc, argv);
+    } catch (const bad_device_id& e) {
+        cerr << "bad device ID; valid IDs are:" << endl;
+
+        for (auto& deviceId : util::SUPPORTED_DEVICES) cerr << "  " << deviceId << endl;
+
+        exit(1);
+    } catch (const invalid_argument& e) {
+        cerr << "invalid argument" << endl << endl;
+        cerr << program;
+
+        exit(1);
+    } catch (const runtime_error& e) {
+        cerr << e.what() << endl << endl;
+        cerr << program;
+
+        exit(1);
+    }
+
+    Options options;
+
+    options.images = program.get<vector<string>>("images");
+    options.deviceId = program.present("--device-id");
+    options.timelineFile = program.present("--timeline");
+    options.seconds = program.get<double>("--seconds");
+    options.jobs = max(program.get<long>("--jobs"), 1l);
+    options.repeat = max(program.get<long>("--repeat"), 1l);
+    options.verbose = program.get<bool>("--verbose");
+
+    Timeline timeline;
+
+    if (options.timelineFile) {
+        ifstream stream(*options.timelineFile);
+        string error;
+
+        if (!stream) {
+            cerr << "unable to open " << *options.timelineFile << endl;
+            exit(1);
+        }
+
+        if (!timeline.Parse(stream, error)) {
+            cerr << *options.timelineFile << ": " << error << endl;
+            exit(1);
+        }
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    return runAll(options, timeline);
+}
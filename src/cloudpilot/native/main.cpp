@@ -10,6 +10,7 @@
 #include <optional>
 #include <string>
 
+#include "Benchmark.h"
 #include "Cli.h"
 #include "DebugSupport.h"
 #include "Debugger.h"
@@ -21,6 +22,7 @@
 #include "Feature.h"
 #include "GdbStub.h"
 #include "MainLoop.h"
+#include "Platform.h"
 #include "ProxyClient.h"
 #include "ProxyHandler.h"
 #include "ScreenDimensions.h"
@@ -28,6 +30,7 @@
 #include "SuspendContextClipboardCopy.h"
 #include "SuspendContextClipboardPaste.h"
 #include "SuspendManager.h"
+#include "Turbo.h"
 #include "argparse.h"
 #include "uri/uri.h"
 #include "util.h"
@@ -51,11 +54,16 @@ struct Options {
     string image;
     optional<string> deviceId;
     optional<ProxyConfiguration> proxyConfiguration;
+    bool nativeNetworking;
     optional<string> scriptFile;
     bool traceNetlib;
     bool traceDebugger;
     optional<string> mountImage;
+    bool mountWriteBack;
+    optional<double> turboSpeed;
+    optional<uint32> turboFrameInterval;
     DebuggerConfiguration debuggerConfiguration;
+    optional<BenchmarkConfiguration> benchmarkConfiguration;
 };
 
 void handleSuspend() {
@@ -86,16 +94,21 @@ void handleSuspend() {
 
 void setupCard(const Options& options) {
     string imageKey;
-    if (options.mountImage) imageKey = util::registerImage(*options.mountImage);
+    if (options.mountImage)
+        imageKey = util::registerImage(*options.mountImage, options.mountWriteBack);
 
     if (!(options.deviceId ? util::initializeSession(options.image, *options.deviceId)
                            : util::initializeSession(options.image)))
         exit(1);
 
-    if (!imageKey.empty() && gExternalStorage.RemountFailed()) {
+    // Restoring the session may have rekeyed the card to the key in the image.
+    if (!imageKey.empty() && !gExternalStorage->HasImage(imageKey))
+        imageKey = gExternalStorage->GetImageKeyInSlot(util::mountedSlot());
+
+    if (!imageKey.empty() && gExternalStorage->RemountFailed()) {
         cout << "remount failed" << endl << flush;
 
-        gExternalStorage.RemoveImage(imageKey);
+        gExternalStorage->RemoveImage(imageKey);
         imageKey.clear();
     }
 
@@ -104,10 +117,12 @@ void setupCard(const Options& options) {
 }
 
 void setupProxy(ProxyClient*& proxyClient, ProxyHandler*& proxyHandler, const Options& options) {
-    if (options.proxyConfiguration) {
-        proxyClient =
-            ProxyClient::Create(options.proxyConfiguration->host, options.proxyConfiguration->port,
-                                options.proxyConfiguration->path);
+    if (options.proxyConfiguration || options.nativeNetworking) {
+        proxyClient = options.nativeNetworking
+                          ? ProxyClient::CreateNative()
+                          : ProxyClient::Create(options.proxyConfiguration->host,
+                                                options.proxyConfiguration->port,
+                                                options.proxyConfiguration->path);
 
         proxyHandler = new ProxyHandler(*proxyClient);
         proxyHandler->Initialize();
@@ -135,7 +150,7 @@ void setupDebugger(GdbStub& gdbStub, const Options& options) {
                      << flush;
 
             else
-                debug_support::SetApp(buffer.get(), len, nullptr, gdbStub, gDebugger);
+                debug_support::SetApp(buffer.get(), len, nullptr, gdbStub, *gDebugger);
         }
     }
 }
@@ -168,7 +183,7 @@ void run(const Options& options) {
     ProxyHandler* proxyHandler = nullptr;
     setupProxy(proxyClient, proxyHandler, options);
 
-    GdbStub gdbStub(gDebugger, options.debuggerConfiguration.port);
+    GdbStub gdbStub(*gDebugger, options.debuggerConfiguration.port);
     setupDebugger(gdbStub, options);
 
     if (options.traceNetlib) logging::enableDomain(logging::domainNetlib);
@@ -176,6 +191,9 @@ void run(const Options& options) {
 
     Feature::SetClipboardIntegration(true);
 
+    if (options.turboFrameInterval) gTurbo->SetFrameInterval(*options.turboFrameInterval);
+    if (options.turboSpeed) gTurbo->Enable(Platform::GetMilliseconds(), *options.turboSpeed);
+
     SDL_Window* window;
     SDL_Renderer* renderer;
     int scale;
@@ -184,7 +202,7 @@ void run(const Options& options) {
     MainLoop mainLoop(window, renderer, scale);
 
     cli::Start(options.scriptFile);
-    cli::TaskContext taskContext = {.debugger = gDebugger, .gdbStub = gdbStub};
+    cli::TaskContext taskContext = {.debugger = *gDebugger, .gdbStub = gdbStub};
 
     while (mainLoop.IsRunning()) {
         mainLoop.Cycle();
@@ -192,10 +210,13 @@ void run(const Options& options) {
         if (cli::Execute(taskContext)) break;
 
         handleSuspend();
-        if (proxyHandler) proxyHandler->HandleSuspend();
+        if (proxyHandler) {
+            proxyHandler->DispatchResponses();
+            proxyHandler->HandleSuspend();
+        }
 
 #ifdef ENABLE_DEBUGGER
-        gdbStub.Cycle(gDebugger.IsStopped() ? 10 : 0);
+        gdbStub.Cycle(gDebugger->IsStopped() ? 10 : 0);
 #endif
     };
 
@@ -247,6 +268,11 @@ int main(int argc, const char** argv) {
             }
         });
 
+    program.add_argument("--net-native")
+        .help("enable network redirection via the sockets of the host, without a proxy")
+        .default_value(false)
+        .implicit_value(true);
+
     program.add_argument("--trace-netlib")
         .help("trace network API")
         .default_value(false)
@@ -254,10 +280,48 @@ int main(int argc, const char** argv) {
 
     program.add_argument("--mount").metavar("<image file>").help("mount card image");
 
+    program.add_argument("--write-back")
+        .help("write changes to the mounted card back to the image file")
+        .default_value(false)
+        .implicit_value(true);
+
     program.add_argument("--script", "-s")
         .metavar("<script file>")
         .help("execute script on startup");
 
+    program.add_argument("--turbo")
+        .help("run emulation as fast as possible; use turbo-off to return to realtime")
+        .default_value(false)
+        .implicit_value(true);
+
+    program.add_argument("--turbo-speed")
+        .metavar("<factor>")
+        .help("run emulation at a multiple of realtime; implies --turbo")
+        .scan<'g', double>();
+
+    program.add_argument("--turbo-frame-interval")
+        .metavar("<msec>")
+        .help("update the screen every <msec> milliseconds in turbo mode")
+        .scan<'u', unsigned int>();
+
+    program.add_argument("--benchmark")
+        .metavar("<json file>")
+        .help("run headless boot benchmark and write results to file (- for stdout)");
+
+    program.add_argument("--benchmark-install")
+        .metavar("<prc file>")
+        .help("install database after boot in benchmark mode");
+
+    program.add_argument("--benchmark-launch")
+        .metavar("<app name>")
+        .help("launch app in benchmark mode; defaults to the installed database");
+
+    program.add_argument("--benchmark-timeout")
+        .metavar("<seconds>")
+        .help("maximum emulated time per benchmark phase")
+        .default_value(120.)
+        .scan<'g', double>();
+
 #ifdef ENABLE_DEBUGGER
     program.add_argument("--listen", "-l")
         .metavar("<port>")
@@ -299,15 +363,37 @@ int main(int argc, const char** argv) {
         exit(1);
     }
 
-    Options options{.traceDebugger = false};
+    Options options{.traceDebugger = false, .mountWriteBack = false};
 
     options.image = program.get("image");
     options.traceNetlib = program.get<bool>("--trace-netlib");
     options.mountImage = program.present("--mount");
     options.deviceId = program.present("--device-id");
     options.proxyConfiguration = program.present<ProxyConfiguration>("--net-proxy");
+    options.nativeNetworking = program.get<bool>("--net-native");
     options.mountImage = program.present("--mount");
+    options.mountWriteBack = program.get<bool>("--write-back");
     options.scriptFile = program.present("--script");
+    options.turboFrameInterval = program.present<unsigned int>("--turbo-frame-interval");
+
+    if (auto turboSpeed = program.present<double>("--turbo-speed")) {
+        if (*turboSpeed <= 0) {
+            cerr << "turbo speed must be positive" << endl << endl;
+            cerr << program;
+
+            exit(1);
+        }
+
+        options.turboSpeed = *turboSpeed;
+    } else if (program.get<bool>("--turbo"))
+        options.turboSpeed = Turbo::UNLIMITED;
+
+    if (options.proxyConfiguration && options.nativeNetworking) {
+        cerr << "--net-proxy and --net-native are mutually exclusive" << endl << endl;
+        cerr << program;
+
+        exit(1);
+    }
 
 #ifdef ENABLE_DEBUGGER
     if (auto port = program.present<unsigned int>("--listen"))
@@ -319,5 +405,15 @@ int main(int argc, const char** argv) {
     options.debuggerConfiguration.appFile = program.present("--debug-app");
 #endif
 
+    if (auto outputFile = program.present("--benchmark"))
+        options.benchmarkConfiguration = {
+            .outputFile = *outputFile,
+            .installFile = program.present("--benchmark-install"),
+            .launchApp = program.present("--benchmark-launch"),
+            .timeoutSeconds = program.get<double>("--benchmark-timeout")};
+
+    if (options.benchmarkConfiguration)
+        return runBenchmark(options.image, options.deviceId, *options.benchmarkConfiguration);
+
     run(options);
 }
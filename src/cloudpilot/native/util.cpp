@@ -1,12 +1,60 @@
 #include "util.h"
 
+#include <sys/stat.h>
+
 #include <fstream>
+#include <set>
+#include <sstream>
 
 #include "EmSession.h"
+#include "EmSessionContext.h"
 #include "ExternalStorage.h"
 #include "SessionImage.h"
 #include "md5.h"
 
+namespace {
+    // Images that were registered with the key from fileKey. Their content is
+    // only hashed if a session image refers to a card that is not registered.
+    thread_local set<string> unhashedKeys;
+
+    const EmSessionState sessionState{EM_SESSION_VARIABLE(unhashedKeys)};
+
+    string fileKey(const string& image, const struct stat& fileStat) {
+        ostringstream identity;
+
+        identity << image << ":" << fileStat.st_dev << ":" << fileStat.st_ino << ":"
+                 << fileStat.st_size << ":" << fileStat.st_mtime;
+        string identityString = identity.str();
+
+        return md5(reinterpret_cast<uint8_t*>(identityString.data()), identityString.size());
+    }
+
+    // Session images refer to cards by the MD5 of their content (see save-image).
+    void resolveKey(const string& key) {
+        for (auto it = unhashedKeys.begin(); it != unhashedKeys.end();) {
+            CardImage* cardImage = gExternalStorage->GetImage(*it);
+
+            if (!cardImage) {
+                it = unhashedKeys.erase(it);
+                continue;
+            }
+
+            const string contentKey =
+                md5(cardImage->RawData(), cardImage->BlocksTotal() * CardImage::BLOCK_SIZE);
+
+            if (contentKey != key) {
+                it++;
+                continue;
+            }
+
+            gExternalStorage->RekeyImage(*it, key);
+            unhashedKeys.erase(it);
+
+            return;
+        }
+    }
+}  // namespace
+
 bool util::readFile(string file, unique_ptr<uint8[]>& buffer, size_t& len) {
     fstream stream(file, ios_base::in);
     if (stream.fail()) return false;
@@ -125,36 +173,51 @@ bool util::initializeSession(string file, optional<string> deviceId) {
     return true;
 }
 
-bool util::mountImage(const string& image) { return mountKey(registerImage(image)); }
+bool util::mountImage(const string& image, bool writeBack) {
+    return mountKey(registerImage(image, writeBack));
+}
+
+string util::registerImage(const string& image, bool writeBack) {
+    struct stat fileStat;
 
-string util::registerImage(const string& image) {
-    unique_ptr<uint8[]> fileBuffer;
-    size_t fileSize;
+    if (stat(image.c_str(), &fileStat) != 0) {
+        cerr << "unable to open card " << image << endl;
+
+        return "";
+    }
+
+    // Mapping the image instead of reading it keeps large cards out of memory
+    // until they are accessed. For the same reason, the key is derived from
+    // the file instead of its content.
+    unique_ptr<CardImage> cardImage = CardImage::Map(
+        image.c_str(), writeBack ? CardImage::MapMode::writeBack : CardImage::MapMode::copyOnWrite);
 
-    if (!util::readFile(image, fileBuffer, fileSize)) {
+    if (!cardImage) {
         cerr << "unable to open card " << image << endl;
 
         return "";
     }
 
-    string key = md5(fileBuffer.get(), fileSize);
+    string key = fileKey(image, fileStat);
 
-    if (!gExternalStorage.AddImage(key, fileBuffer.get(), fileSize)) {
+    if (!gExternalStorage->AddImage(key, move(cardImage))) {
         cerr << "failed to register card " << image << endl;
 
         return "";
     }
 
-    fileBuffer.release();
+    unhashedKeys.insert(key);
+    gExternalStorage->SetKeyResolver(resolveKey);
+
     return key;
 }
 
 bool util::mountKey(const string& key) {
     if (key.empty()) return false;
 
-    if (!gExternalStorage.IsMounted(key) && !gExternalStorage.Mount(key)) {
+    if (!gExternalStorage->IsMounted(key) && !gExternalStorage->Mount(key)) {
         cerr << "failed to mount card" << endl << flush;
-        gExternalStorage.RemoveImage(key);
+        gExternalStorage->RemoveImage(key);
 
         return false;
     }
@@ -165,7 +228,7 @@ bool util::mountKey(const string& key) {
 EmHAL::Slot util::mountedSlot() {
     EmHAL::Slot slot = EmHAL::Slot::none;
     for (auto s : {EmHAL::Slot::sdcard, EmHAL::Slot::memorystick})
-        if (gExternalStorage.IsMounted(s)) slot = s;
+        if (gExternalStorage->IsMounted(s)) slot = s;
 
     return slot;
 }
@@ -21,8 +21,10 @@ namespace util {
 
     void analyzeRom(EmROMReader& reader);
 
-    bool mountImage(const string& image);
-    string registerImage(const string& image);
+    // Card images are mapped copy-on-write unless writeBack is set, in which
+    // case modifications go to the file.
+    bool mountImage(const string& image, bool writeBack = false);
+    string registerImage(const string& image, bool writeBack = false);
     bool mountKey(const string& key);
 
     EmHAL::Slot mountedSlot();
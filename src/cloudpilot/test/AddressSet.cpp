@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+// clang-format off
+#include "AddressSet.h"
+// clang-format on
+
+namespace {
+    TEST(AddressSetTest, isEmptyOnCreation) {
+        AddressSet set;
+
+        EXPECT_TRUE(set.IsEmpty());
+        EXPECT_FALSE(set.Contains(0));
+        EXPECT_FALSE(set.Contains(0xfffffffc, 4));
+    }
+
+    TEST(AddressSetTest, itContainsAccessesThatOverlapAPoint) {
+        AddressSet set;
+        set.Add(0x1003, 2);
+
+        EXPECT_FALSE(set.IsEmpty());
+
+        EXPECT_TRUE(set.Contains(0x1004));
+        EXPECT_TRUE(set.Contains(0x1000, 4));
+        EXPECT_TRUE(set.Contains(0x1004, 2));
+
+        EXPECT_FALSE(set.Contains(0x1002));
+        EXPECT_FALSE(set.Contains(0x1005, 4));
+        EXPECT_FALSE(set.Contains(0x1010));
+    }
+
+    TEST(AddressSetTest, accessesMayStraddleAPageBoundary) {
+        AddressSet set;
+        set.Add(AddressSet::PAGE_SIZE);
+
+        EXPECT_TRUE(set.Contains(AddressSet::PAGE_SIZE - 2, 4));
+        EXPECT_FALSE(set.Contains(AddressSet::PAGE_SIZE - 4, 4));
+    }
+
+    TEST(AddressSetTest, removingAPointKeepsOtherPointsOnThePage) {
+        AddressSet set;
+        set.Add(0x2000);
+        set.Add(0x2010);
+
+        set.Remove(0x2000);
+
+        EXPECT_FALSE(set.Contains(0x2000));
+        EXPECT_TRUE(set.Contains(0x2010));
+
+        set.Remove(0x2010);
+
+        EXPECT_FALSE(set.Contains(0x2010));
+        EXPECT_TRUE(set.IsEmpty());
+    }
+
+    TEST(AddressSetTest, largeSpansAreStoredAsRanges) {
+        AddressSet set;
+        set.Add(0x10000, 0x10000);
+
+        EXPECT_TRUE(set.Contains(0x10000));
+        EXPECT_TRUE(set.Contains(0x18765, 2));
+        EXPECT_TRUE(set.Contains(0xfffe, 4));
+        EXPECT_TRUE(set.Contains(0x1ffff));
+
+        EXPECT_FALSE(set.Contains(0xfffc, 4));
+        EXPECT_FALSE(set.Contains(0x20000));
+    }
+
+    TEST(AddressSetTest, removingARangeKeepsOverlappingEntries) {
+        AddressSet set;
+        set.Add(0x10000, 0x1000);
+        set.Add(0x10800, 0x1000);
+        set.Add(0x10004);
+
+        set.Remove(0x10000, 0x1000);
+
+        EXPECT_TRUE(set.Contains(0x10004));
+        EXPECT_FALSE(set.Contains(0x10100));
+        EXPECT_TRUE(set.Contains(0x10800));
+        EXPECT_TRUE(set.Contains(0x117ff));
+
+        set.Remove(0x10800, 0x1000);
+        set.Remove(0x10004);
+
+        EXPECT_TRUE(set.IsEmpty());
+        EXPECT_FALSE(set.Contains(0x10800));
+    }
+
+    TEST(AddressSetTest, rangesMayEndAtTheTopOfTheAddressSpace) {
+        AddressSet set;
+        set.Add(0xffff0000, 0x10000);
+
+        EXPECT_TRUE(set.Contains(0xfffffffc, 4));
+        EXPECT_FALSE(set.Contains(0xfffefffc, 4));
+
+        set.Clear();
+
+        EXPECT_TRUE(set.IsEmpty());
+        EXPECT_FALSE(set.Contains(0xfffffffc, 4));
+    }
+}  // namespace
@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+
+// clang-format off
+#include "Debugger.h"
+#include "EmBlockCache.h"
+#include "EmCPU68K.h"
+#include "EmMemory.h"
+#include "EmSession.h"
+#include "SessionFixture.h"
+// clang-format on
+
+namespace {
+    constexpr emuptr CODE_ADDRESS = 0x8000;
+    constexpr emuptr DATA_ADDRESS = 0x9000;
+
+    //          moveq   #1, d0
+    //   loop:  addq.l  #1, d1
+    //          bra.s   loop
+    constexpr uint16 LOOP[] = {0x7001, 0x5281, 0x60fc};
+
+    // A mix of register, memory and multiplication instructions that loops
+    // forever:
+    //
+    //          lea     $9000.l, a0
+    //          moveq   #0, d0
+    //   loop:  addq.l  #1, d0
+    //          move.l  d0, (a0)
+    //          move.l  (a0), d1
+    //          lsl.l   #2, d1
+    //          eor.l   d1, d0
+    //          move.w  d0, 4(a0)
+    //          mulu.w  d1, d0
+    //          bra.s   loop
+    constexpr uint16 MIXED[] = {0x41f9, 0x0000, 0x9000, 0x7000, 0x5280, 0x2080, 0x2210,
+                                0xe589, 0xb380, 0x3140, 0x0004, 0xc0c1, 0x60ee};
+
+    // Patches the moveq in its loop through the CPU (a1 points to it): once
+    // with d2 before the loop runs, and once with d3 after the loop has been
+    // cached. The second patch sets d0 to 3 for the rest of the run.
+    //
+    //          move.w  d2, (a1)
+    //          moveq   #0, d1
+    //   loop:  moveq   #1, d0
+    //          addq.l  #1, d1
+    //          cmpi.l  #100, d1
+    //          bne.s   loop
+    //          move.w  d3, (a1)
+    //          bra.s   loop
+    constexpr uint16 SELF_MODIFYING[] = {0x3282, 0x7200, 0x7001, 0x5281, 0x0c81,
+                                         0x0000, 0x0064, 0x66f4, 0x3283, 0x60f0};
+
+    // Runs code blocks in supervisor mode with all interrupts masked, so
+    // PalmOS does not get a chance to run in between.
+    class BlockCacheTest : public PalmVSessionTest {
+       protected:
+        void SetUp() override {
+            PalmVSessionTest::SetUp();
+            if (IsSkipped() || HasFatalFailure()) return;
+
+            // RAM is mapped at address zero once the OS has set up the chip selects.
+            Boot();
+        }
+
+        void TearDown() override {
+            EmBlockCache::SetEnabled(true);
+            Memory::SetInstrumented(false);
+            gDebugger->Reset();
+
+            PalmVSessionTest::TearDown();
+        }
+
+        template <size_t N>
+        void Load(const uint16 (&code)[N]) {
+            CEnableFullAccess munge;
+
+            for (size_t i = 0; i < N; i++) EmMemPut16(CODE_ADDRESS + 2 * i, code[i]);
+
+            for (int reg = e68KRegID_D0; reg <= e68KRegID_D7; reg++)
+                gCPU68K->SetRegister(reg, 0);
+
+            gCPU68K->SetRegister(e68KRegID_A1, CODE_ADDRESS + 4);
+            gCPU68K->SetRegister(e68KRegID_SR, 0x2700);
+            gCPU68K->SetPC(CODE_ADDRESS);
+            gCPU68K->SetStopped(false);
+        }
+
+        uint32 Register(int reg) { return gCPU68K->GetRegister(reg); }
+
+        void Patch(emuptr address, uint16 value) {
+            CEnableFullAccess munge;
+
+            EmMemPut16(address, value);
+        }
+    };
+
+    TEST_F(BlockCacheTest, itExecutesCodeThatWasOverwrittenByTheHost) {
+        Load(LOOP);
+
+        gCPU68K->Execute(10000);
+        gCPU68K->SetPC(CODE_ADDRESS);
+        gCPU68K->Execute(10000);
+
+        EXPECT_EQ(Register(e68KRegID_D0), 1u);
+
+        Patch(CODE_ADDRESS, 0x7002);
+
+        gCPU68K->SetPC(CODE_ADDRESS);
+        gCPU68K->Execute(10000);
+
+        EXPECT_EQ(Register(e68KRegID_D0), 2u);
+        EXPECT_GE(gCPU68K->GetPC(), CODE_ADDRESS);
+        EXPECT_LT(gCPU68K->GetPC(), CODE_ADDRESS + sizeof(LOOP));
+    }
+
+    TEST_F(BlockCacheTest, itExecutesCodeThatModifiedItself) {
+        Load(SELF_MODIFYING);
+
+        gCPU68K->SetRegister(e68KRegID_D2, 0x7002);
+        gCPU68K->SetRegister(e68KRegID_D3, 0x7003);
+
+        gCPU68K->Execute(100000);
+
+        EXPECT_GT(Register(e68KRegID_D1), 100u);
+        EXPECT_EQ(Register(e68KRegID_D0), 3u);
+    }
+
+    TEST_F(BlockCacheTest, itReportsWatchpointsOnlyWhileMemoryIsInstrumented) {
+        gDebugger->Reset();
+        gDebugger->Enable();
+        gDebugger->SetWatchpoint(DATA_ADDRESS, Debugger::WatchpointType::write, 4);
+
+        Load(MIXED);
+        gCPU68K->Execute(10000);
+
+        EXPECT_EQ(gDebugger->GetBreakState(), Debugger::BreakState::none);
+
+        Memory::SetInstrumented(true);
+        EXPECT_EQ(EmMemGetDirectBase(DATA_ADDRESS), nullptr);
+
+        Load(MIXED);
+        gCPU68K->Execute(10000);
+
+        EXPECT_EQ(gDebugger->GetBreakState(), Debugger::BreakState::trapWrite);
+        EXPECT_EQ(gDebugger->GetWatchpointAddress(), DATA_ADDRESS);
+
+        Memory::SetInstrumented(false);
+        EXPECT_NE(EmMemGetDirectBase(DATA_ADDRESS), nullptr);
+    }
+
+    struct Result {
+        uint32 registers[e68KRegID_SR];
+        emuptr pc;
+        uint64 instructions;
+        uint64 cycles;
+        uint8 data[8];
+    };
+
+    class BlockCacheEquivalenceTest : public BlockCacheTest {
+       protected:
+        template <size_t N>
+        Result Run(const uint16 (&code)[N], bool enabled) {
+            EmBlockCache::SetEnabled(enabled);
+            Load(code);
+
+            gCPU68K->SetRegister(e68KRegID_D2, 0x7002);
+            gCPU68K->SetRegister(e68KRegID_D3, 0x7003);
+
+            Result result;
+            const uint64 instructionsBefore = gCPU68K->GetInstructionCount();
+
+            result.cycles = 0;
+            for (int i = 0; i < 100; i++) result.cycles += gCPU68K->Execute(10000);
+
+            result.instructions = gCPU68K->GetInstructionCount() - instructionsBefore;
+            result.pc = gCPU68K->GetPC();
+
+            for (int reg = e68KRegID_D0; reg <= e68KRegID_SR; reg++)
+                result.registers[reg - 1] = Register(reg);
+
+            CEnableFullAccess munge;
+            for (uint32 i = 0; i < sizeof(result.data); i++)
+                result.data[i] = EmMemGet8(DATA_ADDRESS + i);
+
+            return result;
+        }
+
+        template <size_t N>
+        void ExpectEquivalent(const uint16 (&code)[N]) {
+            const Result uncached = Run(code, false);
+            const Result cached = Run(code, true);
+
+            EXPECT_EQ(cached.cycles, uncached.cycles);
+            EXPECT_EQ(cached.instructions, uncached.instructions);
+            EXPECT_EQ(cached.pc, uncached.pc);
+
+            for (int reg = 0; reg < e68KRegID_SR; reg++)
+                EXPECT_EQ(cached.registers[reg], uncached.registers[reg]) << "register " << reg + 1;
+
+            EXPECT_EQ(memcmp(cached.data, uncached.data, sizeof(cached.data)), 0);
+        }
+    };
+
+    TEST_F(BlockCacheEquivalenceTest, itExecutesIdenticallyWithAndWithoutCache) {
+        ExpectEquivalent(MIXED);
+    }
+
+    TEST_F(BlockCacheEquivalenceTest, itExecutesSelfModifyingCodeIdentically) {
+        ExpectEquivalent(SELF_MODIFYING);
+    }
+
+    TEST_F(BlockCacheEquivalenceTest, itExecutesIdenticallyOnInstrumentedMemory) {
+        const Result plain = Run(MIXED, true);
+
+        Memory::SetInstrumented(true);
+        const Result instrumented = Run(MIXED, true);
+
+        EXPECT_EQ(instrumented.cycles, plain.cycles);
+        EXPECT_EQ(instrumented.instructions, plain.instructions);
+        EXPECT_EQ(instrumented.pc, plain.pc);
+        EXPECT_EQ(memcmp(instrumented.data, plain.data, sizeof(plain.data)), 0);
+    }
+}  // namespace
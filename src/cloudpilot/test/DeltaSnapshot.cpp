@@ -0,0 +1,315 @@
+#include <gtest/gtest.h>
+
+// clang-format off
+#include "DeltaSnapshot.h"
+#include "EmMemory.h"
+#include "EmSession.h"
+#include "SessionFixture.h"
+// clang-format on
+
+namespace {
+    constexpr uint32 PAGE_SIZE = DeltaSnapshot::PAGE_SIZE;
+    constexpr uint32 MEMORY_SIZE = 8 * PAGE_SIZE;
+
+    vector<uint8> page(uint8 value) { return vector<uint8>(PAGE_SIZE, value); }
+
+    DeltaSnapshot fullSnapshot(uint8 value) {
+        DeltaSnapshot snapshot(DeltaSnapshot::Kind::full, 42, 0, MEMORY_SIZE);
+
+        for (uint32 i = 0; i < MEMORY_SIZE / PAGE_SIZE; i++)
+            snapshot.AddPage(i, page(value).data());
+
+        snapshot.SetSavestate("base", 4);
+
+        return snapshot;
+    }
+
+    // The session tests write pages above the low memory globals. Loading a
+    // savestate updates the clock through a pointer in the globals.
+    constexpr uint32 FIRST_PAGE = 64;
+
+    class DeltaSnapshotSessionTest : public PalmVSessionTest {
+       protected:
+        void SetUp() override {
+            PalmVSessionTest::SetUp();
+            if (IsSkipped() || HasFatalFailure()) return;
+
+            memory = EmMemory::GetTotalMemory() + FIRST_PAGE * PAGE_SIZE;
+            original.assign(memory, memory + 4 * PAGE_SIZE);
+        }
+
+        // Writes behind the banks' back, marking the page dirty like a bank would.
+        void Write(uint32 page, uint8 value) {
+            memset(memory + page * PAGE_SIZE, value, PAGE_SIZE);
+
+            page += FIRST_PAGE;
+            EmMemory::GetBankDirtyPages()[page >> 3] |= 1 << (page & 0x07);
+        }
+
+        bool PageIs(uint32 page, uint8 value) {
+            for (uint32 i = 0; i < PAGE_SIZE; i++)
+                if (memory[page * PAGE_SIZE + i] != value) return false;
+
+            return true;
+        }
+
+        bool PageIsOriginal(uint32 page) {
+            return memcmp(memory + page * PAGE_SIZE, original.data() + page * PAGE_SIZE,
+                          PAGE_SIZE) == 0;
+        }
+
+       protected:
+        uint8* memory{nullptr};
+        vector<uint8> original;
+    };
+
+    TEST(DeltaSnapshotTest, pagesMustBeAddedInAscendingOrder) {
+        DeltaSnapshot snapshot(DeltaSnapshot::Kind::delta, 42, 1, MEMORY_SIZE);
+
+        ASSERT_TRUE(snapshot.AddPage(2, page(1).data()));
+        ASSERT_FALSE(snapshot.AddPage(2, page(1).data()));
+        ASSERT_FALSE(snapshot.AddPage(1, page(1).data()));
+        ASSERT_FALSE(snapshot.AddPage(8, page(1).data()));
+        ASSERT_EQ(snapshot.GetPageCount(), 1u);
+    }
+
+    TEST(DeltaSnapshotTest, applyCopiesPagesAndMarksThemDirty) {
+        DeltaSnapshot snapshot(DeltaSnapshot::Kind::delta, 42, 1, MEMORY_SIZE);
+        snapshot.AddPage(1, page(0x11).data());
+        snapshot.AddPage(6, page(0x66).data());
+
+        vector<uint8> memory(MEMORY_SIZE, 0);
+        uint8 dirtyPages = 0;
+
+        ASSERT_TRUE(snapshot.Apply(memory.data(), MEMORY_SIZE, &dirtyPages));
+
+        ASSERT_EQ(memory[0], 0);
+        ASSERT_EQ(memory[PAGE_SIZE], 0x11);
+        ASSERT_EQ(memory[7 * PAGE_SIZE - 1], 0x66);
+        ASSERT_EQ(memory[7 * PAGE_SIZE], 0);
+        ASSERT_EQ(dirtyPages, 0x42);
+
+        ASSERT_FALSE(snapshot.Apply(memory.data(), MEMORY_SIZE - PAGE_SIZE));
+    }
+
+    TEST(DeltaSnapshotTest, serializationRoundTrips) {
+        DeltaSnapshot snapshot(DeltaSnapshot::Kind::delta, 42, 3, MEMORY_SIZE);
+        snapshot.AddPage(0, page(0xaa).data());
+        snapshot.AddPage(5, page(0x55).data());
+        snapshot.SetSavestate("state", 5);
+
+        ASSERT_TRUE(snapshot.Serialize());
+        ASSERT_EQ(snapshot.GetSerializedImageSize(), 32u + 5u + 2u * (4u + PAGE_SIZE));
+
+        DeltaSnapshot restored;
+        ASSERT_TRUE(
+            restored.Deserialize(snapshot.GetSerializedImage(), snapshot.GetSerializedImageSize()));
+
+        ASSERT_EQ(restored.GetKind(), DeltaSnapshot::Kind::delta);
+        ASSERT_EQ(restored.GetChainId(), 42u);
+        ASSERT_EQ(restored.GetSequence(), 3u);
+        ASSERT_EQ(restored.GetMemorySize(), MEMORY_SIZE);
+        ASSERT_EQ(restored.GetPageCount(), 2u);
+        ASSERT_EQ(restored.GetPageIndex(1), 5u);
+        ASSERT_EQ(restored.GetPageData(1)[PAGE_SIZE - 1], 0x55);
+        ASSERT_EQ(string(static_cast<const char*>(restored.GetSavestate()),
+                         restored.GetSavestateSize()),
+                  "state");
+    }
+
+    TEST(DeltaSnapshotTest, deserializationRejectsTruncatedImages) {
+        DeltaSnapshot snapshot = fullSnapshot(0);
+        snapshot.Serialize();
+
+        DeltaSnapshot restored;
+        ASSERT_FALSE(restored.Deserialize(snapshot.GetSerializedImage(),
+                                          snapshot.GetSerializedImageSize() - 1));
+        ASSERT_FALSE(restored.Deserialize(snapshot.GetSerializedImage(), 16));
+    }
+
+    TEST(DeltaSnapshotTest, deserializationRejectsSizesThatWrapAround) {
+        DeltaSnapshot snapshot(DeltaSnapshot::Kind::delta, 42, 1, MEMORY_SIZE);
+        snapshot.AddPage(0, page(0).data());
+        snapshot.Serialize();
+
+        // 32 + 0xffffffff + 1028 wraps to 1059 with a 32 bit size_t.
+        vector<uint8> image(static_cast<const uint8*>(snapshot.GetSerializedImage()),
+                            static_cast<const uint8*>(snapshot.GetSerializedImage()) +
+                                snapshot.GetSerializedImageSize());
+        image.resize(1059);
+        image[24] = image[25] = image[26] = image[27] = 0xff;
+
+        DeltaSnapshot restored;
+        ASSERT_FALSE(restored.Deserialize(image.data(), image.size()));
+    }
+
+    TEST(DeltaSnapshotTest, compactFoldsDeltasIntoBase) {
+        DeltaSnapshot base = fullSnapshot(0);
+
+        DeltaSnapshot delta1(DeltaSnapshot::Kind::delta, 42, 1, MEMORY_SIZE);
+        delta1.AddPage(2, page(1).data());
+        delta1.AddPage(4, page(1).data());
+        delta1.SetSavestate("one", 3);
+
+        DeltaSnapshot delta2(DeltaSnapshot::Kind::delta, 42, 2, MEMORY_SIZE);
+        delta2.AddPage(4, page(2).data());
+        delta2.AddPage(7, page(2).data());
+        delta2.SetSavestate("two", 3);
+
+        ASSERT_FALSE(base.Compact(delta2));
+        ASSERT_TRUE(base.Compact(delta1));
+        ASSERT_TRUE(base.Compact(delta2));
+
+        ASSERT_EQ(base.GetKind(), DeltaSnapshot::Kind::full);
+        ASSERT_EQ(base.GetSequence(), 2u);
+        ASSERT_EQ(base.GetPageCount(), MEMORY_SIZE / PAGE_SIZE);
+        ASSERT_EQ(string(static_cast<const char*>(base.GetSavestate()), base.GetSavestateSize()),
+                  "two");
+
+        vector<uint8> memory(MEMORY_SIZE, 0xff);
+        base.Apply(memory.data(), MEMORY_SIZE);
+
+        ASSERT_EQ(memory[1 * PAGE_SIZE], 0);
+        ASSERT_EQ(memory[2 * PAGE_SIZE], 1);
+        ASSERT_EQ(memory[4 * PAGE_SIZE], 2);
+        ASSERT_EQ(memory[7 * PAGE_SIZE], 2);
+    }
+
+    TEST(DeltaSnapshotTest, compactMergesDeltas) {
+        DeltaSnapshot delta1(DeltaSnapshot::Kind::delta, 42, 1, MEMORY_SIZE);
+        delta1.AddPage(3, page(1).data());
+
+        DeltaSnapshot delta2(DeltaSnapshot::Kind::delta, 42, 2, MEMORY_SIZE);
+        delta2.AddPage(1, page(2).data());
+        delta2.AddPage(3, page(2).data());
+
+        ASSERT_TRUE(delta1.Compact(delta2));
+
+        ASSERT_EQ(delta1.GetKind(), DeltaSnapshot::Kind::delta);
+        ASSERT_EQ(delta1.GetPageCount(), 2u);
+        ASSERT_EQ(delta1.GetPageIndex(0), 1u);
+        ASSERT_EQ(delta1.GetPageIndex(1), 3u);
+        ASSERT_EQ(delta1.GetPageData(1)[0], 2);
+    }
+
+    TEST(DeltaSnapshotTest, compactRejectsForeignChains) {
+        DeltaSnapshot base = fullSnapshot(0);
+        DeltaSnapshot delta(DeltaSnapshot::Kind::delta, 43, 1, MEMORY_SIZE);
+
+        ASSERT_FALSE(base.Compact(delta));
+        ASSERT_FALSE(base.Compact(fullSnapshot(1)));
+    }
+
+    TEST_F(DeltaSnapshotSessionTest, deltasOnlyContainChangedPages) {
+        DeltaSnapshot base, delta;
+
+        ASSERT_TRUE(gSession->CaptureSnapshot(base));
+        Write(1, 0x11);
+        ASSERT_TRUE(gSession->CaptureSnapshot(delta));
+
+        ASSERT_EQ(base.GetKind(), DeltaSnapshot::Kind::full);
+        ASSERT_EQ(base.GetPageCount(), EmMemory::GetTotalMemorySize() / PAGE_SIZE);
+
+        ASSERT_EQ(delta.GetKind(), DeltaSnapshot::Kind::delta);
+        ASSERT_EQ(delta.GetChainId(), base.GetChainId());
+        ASSERT_EQ(delta.GetPageCount(), 1u);
+        ASSERT_EQ(delta.GetPageIndex(0), FIRST_PAGE + 1);
+    }
+
+    TEST_F(DeltaSnapshotSessionTest, loadSnapshotRestoresBaseAndDeltas) {
+        DeltaSnapshot base;
+        vector<DeltaSnapshot> deltas(2);
+
+        ASSERT_TRUE(gSession->CaptureSnapshot(base));
+        Write(0, 0x11);
+        ASSERT_TRUE(gSession->CaptureSnapshot(deltas[0]));
+        Write(1, 0x22);
+        ASSERT_TRUE(gSession->CaptureSnapshot(deltas[1]));
+
+        Write(0, 0x33);
+        Write(1, 0x33);
+        Write(2, 0x33);
+
+        ASSERT_TRUE(gSession->LoadSnapshot(base, deltas));
+
+        ASSERT_TRUE(PageIs(0, 0x11));
+        ASSERT_TRUE(PageIs(1, 0x22));
+        ASSERT_TRUE(PageIsOriginal(2));
+
+        DeltaSnapshot next;
+        Write(3, 0x44);
+        ASSERT_TRUE(gSession->CaptureSnapshot(next));
+
+        ASSERT_EQ(next.GetKind(), DeltaSnapshot::Kind::delta);
+        ASSERT_EQ(next.GetSequence(), 3u);
+
+        // Loading the savestate updates the clock in RAM after memory was
+        // restored, so that page is part of the next delta as well.
+        ASSERT_GE(next.GetPageCount(), 1u);
+        ASSERT_LE(next.GetPageCount(), 2u);
+
+        bool containsPage3 = false;
+        for (size_t i = 0; i < next.GetPageCount(); i++)
+            containsPage3 = containsPage3 || next.GetPageIndex(i) == FIRST_PAGE + 3;
+
+        ASSERT_TRUE(containsPage3);
+    }
+
+    TEST_F(DeltaSnapshotSessionTest, loadSnapshotRejectsBrokenChains) {
+        DeltaSnapshot base;
+        vector<DeltaSnapshot> deltas(2);
+
+        ASSERT_TRUE(gSession->CaptureSnapshot(base));
+        Write(0, 0x11);
+        ASSERT_TRUE(gSession->CaptureSnapshot(deltas[1]));
+        Write(1, 0x22);
+        ASSERT_TRUE(gSession->CaptureSnapshot(deltas[0]));
+
+        ASSERT_FALSE(gSession->LoadSnapshot(deltas[0]));
+        ASSERT_FALSE(gSession->LoadSnapshot(base, deltas));
+
+        ASSERT_TRUE(PageIs(0, 0x11));
+        ASSERT_TRUE(PageIs(1, 0x22));
+    }
+
+    TEST_F(DeltaSnapshotSessionTest, failedLoadLeavesMemoryUntouched) {
+        const uint32 memorySize = EmMemory::GetTotalMemorySize();
+        DeltaSnapshot snapshot(DeltaSnapshot::Kind::full, 42, 0, memorySize);
+
+        for (uint32 i = 0; i < memorySize / PAGE_SIZE; i++) snapshot.AddPage(i, page(0x55).data());
+        snapshot.SetSavestate("garbage", 7);
+
+        Write(0, 0x11);
+
+        ASSERT_FALSE(gSession->LoadSnapshot(snapshot));
+
+        ASSERT_TRUE(PageIs(0, 0x11));
+        ASSERT_TRUE(PageIsOriginal(1));
+    }
+
+    TEST_F(DeltaSnapshotSessionTest, loadSnapshotUpdatesTheClockInRestoredMemory) {
+        Boot();
+
+        DeltaSnapshot base;
+
+        setRtcHours(0);
+        ASSERT_TRUE(gSession->CaptureSnapshot(base));
+        setRtcHours(1);
+
+        ASSERT_TRUE(gSession->LoadSnapshot(base));
+
+        EXPECT_GT(getRtcHours(), 1u);
+    }
+
+    TEST_F(DeltaSnapshotSessionTest, trackerDetachesFromMemoryWhenDestroyed) {
+        {
+            DeltaSnapshotTracker tracker;
+            DeltaSnapshot snapshot;
+
+            tracker.Capture(snapshot, "state", 5, false);
+        }
+
+        Write(0, 0x11);
+        EmMemory::CollectDirtyPages();
+    }
+}  // namespace
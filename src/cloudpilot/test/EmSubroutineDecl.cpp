@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+// clang-format off
+#include "EmSubroutineDecl.h"
+// clang-format on
+
+namespace {
+    constexpr EmSubroutineDecl DECL_DM_GET_RECORD("MemHandle",
+                                                  "DmOpenRef dbP, UInt16 index, const Char* name");
+
+    static_assert(DECL_DM_GET_RECORD.IsValid());
+    static_assert(DECL_DM_GET_RECORD.GetParamCount() == 3);
+    static_assert(DECL_DM_GET_RECORD.IndexOf("index") == 1);
+    static_assert(DECL_DM_GET_RECORD.GetParam(1).fType == kEm_UI2);
+
+    TEST(EmSubroutineDeclTest, itParsesTypesAndNames) {
+        const auto& decl = DECL_DM_GET_RECORD;
+
+        EXPECT_EQ(decl.GetReturnType().fType, kEm_Unknown);
+        EXPECT_TRUE(decl.GetReturnType().fByRef);
+
+        EXPECT_EQ(decl.GetParam(0).fName, "dbP");
+        EXPECT_EQ(decl.GetParam(0).fType, kEm_Void);
+        EXPECT_TRUE(decl.GetParam(0).fByRef);
+
+        EXPECT_EQ(decl.GetParam(1).fName, "index");
+        EXPECT_FALSE(decl.GetParam(1).fByRef);
+
+        EXPECT_EQ(decl.GetParam(2).fName, "name");
+        EXPECT_EQ(decl.GetParam(2).fType, kEm_UI1);
+        EXPECT_TRUE(decl.GetParam(2).fByRef);
+
+        EXPECT_EQ(decl.IndexOf("dbp"), EmSubroutineDecl::kNotFound);
+    }
+
+    TEST(EmSubroutineDeclTest, itHandlesEmptyParameterLists) {
+        constexpr EmSubroutineDecl voidDecl("void", "void");
+        constexpr EmSubroutineDecl emptyDecl("UInt32", " ");
+
+        EXPECT_TRUE(voidDecl.IsValid());
+        EXPECT_EQ(voidDecl.GetParamCount(), 0u);
+        EXPECT_EQ(voidDecl.GetReturnType().fType, kEm_Void);
+        EXPECT_FALSE(voidDecl.GetReturnType().fByRef);
+
+        EXPECT_EQ(emptyDecl.GetParamCount(), 0u);
+        EXPECT_EQ(emptyDecl.GetReturnType().fType, kEm_UI4);
+    }
+
+    TEST(EmSubroutineDeclTest, itParsesPointers) {
+        constexpr EmSubroutineDecl decl("Err", "void** hP, FormPtr frmP, unsigned long* sizeP");
+
+        EXPECT_EQ(decl.GetParam(0).fType, kEm_Void);
+        EXPECT_TRUE(decl.GetParam(0).fByRef);
+
+        EXPECT_EQ(decl.GetParam(1).fName, "frmP");
+        EXPECT_EQ(decl.GetParam(1).fType, kEm_Unknown);
+        EXPECT_TRUE(decl.GetParam(1).fByRef);
+
+        EXPECT_EQ(decl.GetParam(2).fName, "sizeP");
+        EXPECT_EQ(decl.GetParam(2).fType, kEm_SI4);
+        EXPECT_TRUE(decl.GetParam(2).fByRef);
+    }
+
+    TEST(EmSubroutineDeclTest, itRejectsTooManyParameters) {
+        string paramList;
+
+        for (size_t i = 0; i <= EmSubroutineDecl::kMaxParams; i++)
+            paramList += (i > 0 ? ", UInt8 p" : "UInt8 p") + to_string(i);
+
+        EXPECT_FALSE(EmSubroutineDecl("void", paramList).IsValid());
+    }
+}  // namespace
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+// clang-format off
+#include "Frame.h"
+#include "EmSystemState.h"
+// clang-format on
+
+namespace {
+    constexpr emuptr BASE = 0x1000;
+    constexpr uint32 ROW_BYTES = 80;
+
+    class FrameTest : public ::testing::Test {
+       protected:
+        void SetUp() override {
+            frame.bpp = 4;
+            frame.lineWidth = 160;
+            frame.lines = 160;
+            frame.bytesPerLine = ROW_BYTES;
+
+            systemState.Initialize();
+
+            frame.UpdateDirtyLines(systemState, BASE, ROW_BYTES, true);
+            systemState.MarkScreenClean();
+        }
+
+        void Update(uint32 rowBytes = ROW_BYTES) {
+            frame.UpdateDirtyLines(systemState, BASE, rowBytes, false);
+            frame.UpdateDirtyColumns(frame.bpp);
+        }
+
+        Frame frame{ROW_BYTES * 160};
+        EmSystemState systemState;
+    };
+
+    TEST_F(FrameTest, dirtyColumnsFollowWrites) {
+        systemState.MarkScreenDirty(BASE + 10 * ROW_BYTES + 20, BASE + 10 * ROW_BYTES + 22);
+        systemState.MarkScreenDirty(BASE + 12 * ROW_BYTES + 23, BASE + 12 * ROW_BYTES + 23);
+
+        Update();
+
+        ASSERT_TRUE(frame.hasChanges);
+        ASSERT_EQ(frame.firstDirtyLine, 10u);
+        ASSERT_EQ(frame.lastDirtyLine, 12u);
+        ASSERT_EQ(frame.firstDirtyColumn, 40u);
+        ASSERT_EQ(frame.lastDirtyColumn, 47u);
+    }
+
+    TEST_F(FrameTest, writesAtTheEndOfARowDoNotWrap) {
+        systemState.MarkScreenDirty(BASE + ROW_BYTES - 4, BASE + ROW_BYTES);
+
+        Update();
+
+        ASSERT_EQ(frame.firstDirtyColumn, 152u);
+        ASSERT_EQ(frame.lastDirtyColumn, 159u);
+    }
+
+    TEST_F(FrameTest, writesAcrossRowsDirtyTheFullWidth) {
+        systemState.MarkScreenDirty(BASE + ROW_BYTES - 2, BASE + ROW_BYTES + 2);
+
+        Update();
+
+        ASSERT_EQ(frame.firstDirtyLine, 0u);
+        ASSERT_EQ(frame.lastDirtyLine, 1u);
+        ASSERT_EQ(frame.firstDirtyColumn, 0u);
+        ASSERT_EQ(frame.lastDirtyColumn, 159u);
+    }
+
+    TEST_F(FrameTest, geometryChangesDirtyTheFullWidth) {
+        systemState.MarkScreenDirty(BASE + 20, BASE + 22);
+
+        Update(ROW_BYTES / 2);
+
+        ASSERT_EQ(frame.firstDirtyColumn, 0u);
+        ASSERT_EQ(frame.lastDirtyColumn, 159u);
+    }
+
+    TEST_F(FrameTest, flipDirtyColumns) {
+        systemState.MarkScreenDirty(BASE + 2, BASE + 2);
+
+        Update();
+        frame.FlipDirtyColumns();
+
+        ASSERT_EQ(frame.firstDirtyColumn, 152u);
+        ASSERT_EQ(frame.lastDirtyColumn, 155u);
+    }
+}  // namespace
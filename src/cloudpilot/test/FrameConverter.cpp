@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+// clang-format off
+#include "FrameConverter.h"
+#include "Frame.h"
+#include "Nibbler.h"
+// clang-format on
+
+namespace {
+    constexpr uint32 LINES = 6;
+    constexpr uint32 PITCH = 80;
+    constexpr uint16 MAPPING_2BPP = 0x9e31;
+
+    uint32 palette[FrameConverter::PALETTE_SIZE];
+
+    template <int bpp>
+    void expectMatchesNibbler(uint32 lineWidth, uint8 margin, uint32 firstColumn = 0,
+                              uint32 lastColumn = 0) {
+        for (uint32 i = 0; i < FrameConverter::PALETTE_SIZE; i++)
+            palette[i] = 0xff000000 | (i * 0x111111);
+
+        Frame frame(4096);
+
+        frame.bpp = bpp;
+        frame.lineWidth = lineWidth;
+        frame.lines = LINES;
+        frame.margin = margin;
+        frame.bytesPerLine = ((lineWidth + margin) * bpp + 7) / 8;
+        frame.firstDirtyLine = 1;
+        frame.lastDirtyLine = LINES - 2;
+        frame.firstDirtyColumn = firstColumn;
+        frame.lastDirtyColumn = lastColumn > 0 ? lastColumn : lineWidth - 1;
+
+        for (size_t i = 0; i < frame.GetBufferSize(); i++)
+            frame.GetBuffer()[i] = i * 0x9d + (i >> 3);
+
+        vector<uint32> dest(PITCH * LINES, 0x12345678);
+
+        FrameConverter converter;
+        converter.SetPalette(palette);
+        converter.Convert(frame, dest.data(), PITCH, MAPPING_2BPP);
+
+        Nibbler<bpp> nibbler;
+
+        for (uint32 y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
+            nibbler.reset(frame.GetBuffer() + y * frame.bytesPerLine, margin);
+            const uint32* line = dest.data() + (y - frame.firstDirtyLine) * PITCH;
+
+            for (uint32 x = 0; x < lineWidth; x++) {
+                const uint8 nibble = nibbler.nibble();
+                uint32 expected;
+
+                if (x < frame.firstDirtyColumn || x > frame.lastDirtyColumn)
+                    expected = 0x12345678;
+                else if constexpr (bpp == 1)
+                    expected = nibble ? palette[15] : palette[0];
+                else if constexpr (bpp == 2)
+                    expected = palette[(MAPPING_2BPP >> (4 * nibble)) & 0x0f];
+                else
+                    expected = palette[nibble];
+
+                ASSERT_EQ(line[x], expected) << "line " << y << ", pixel " << x;
+            }
+
+            ASSERT_EQ(line[lineWidth], 0x12345678u);
+        }
+    }
+
+    TEST(FrameConverterTest, convert1bppMatchesNibbler) {
+        expectMatchesNibbler<1>(64, 0);
+        expectMatchesNibbler<1>(61, 3);
+        expectMatchesNibbler<1>(5, 2);
+    }
+
+    TEST(FrameConverterTest, convert2bppMatchesNibbler) {
+        expectMatchesNibbler<2>(64, 0);
+        expectMatchesNibbler<2>(62, 3);
+        expectMatchesNibbler<2>(2, 1);
+    }
+
+    TEST(FrameConverterTest, convert4bppMatchesNibbler) {
+        expectMatchesNibbler<4>(64, 0);
+        expectMatchesNibbler<4>(63, 1);
+    }
+
+    TEST(FrameConverterTest, onlyDirtyColumnsAreConverted) {
+        expectMatchesNibbler<1>(64, 3, 5, 37);
+        expectMatchesNibbler<2>(64, 1, 3, 4);
+        expectMatchesNibbler<4>(64, 1, 1, 62);
+    }
+
+    TEST(FrameConverterTest, paletteChangesAreApplied) {
+        Frame frame(64);
+
+        frame.bpp = 4;
+        frame.lineWidth = 2;
+        frame.lines = 1;
+        frame.bytesPerLine = 1;
+        frame.lastDirtyColumn = 1;
+        frame.GetBuffer()[0] = 0x0f;
+
+        uint32 dest[2];
+        uint32 palette[FrameConverter::PALETTE_SIZE] = {0};
+
+        FrameConverter converter;
+        converter.SetPalette(palette);
+        converter.Convert(frame, dest, 2, 0);
+
+        palette[15] = 0xff;
+        converter.SetPalette(palette);
+        converter.Convert(frame, dest, 2, 0);
+
+        ASSERT_EQ(dest[0], 0u);
+        ASSERT_EQ(dest[1], 0xffu);
+    }
+}  // namespace
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+// clang-format off
+#include "InterruptTracer.h"
+// clang-format on
+
+namespace {
+    constexpr uint32 TIMER = 1 << 1;
+    constexpr uint32 UART = 1 << 2;
+    constexpr uint32 IRQ6 = 1 << 19;
+
+    const char* const SOURCES[InterruptTracer::SOURCE_COUNT] = {
+        "SPIM", "Timer", "UART", nullptr, nullptr, nullptr, nullptr, nullptr,
+        nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+        nullptr, nullptr, nullptr, "IRQ6", nullptr, nullptr, nullptr, nullptr,
+        nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr};
+
+    class InterruptTracerTest : public ::testing::Test {
+       public:
+        void SetUp() override { tracer.Start(); }
+
+       protected:
+        InterruptTracer::SourceStats Source(const string& name) {
+            for (const auto& entry : tracer.GetSourceStats(1000))
+                if (entry.name == name) return entry;
+
+            ADD_FAILURE() << "no stats for " << name;
+            return {};
+        }
+
+       protected:
+        InterruptTracer tracer;
+    };
+
+    TEST(InterruptTracerHistogramTest, percentilesReportTheBucketUpperBound) {
+        InterruptTracer::Histogram histogram;
+
+        for (uint64 value : {0, 1, 2, 3, 100}) histogram.Add(value);
+
+        EXPECT_EQ(histogram.count, 5u);
+        EXPECT_EQ(histogram.max, 100u);
+        EXPECT_DOUBLE_EQ(histogram.Mean(), 106. / 5);
+
+        EXPECT_EQ(histogram.Percentile(20), 0u);
+        EXPECT_EQ(histogram.Percentile(50), 3u);
+        EXPECT_EQ(histogram.Percentile(100), 100u);
+    }
+
+    TEST_F(InterruptTracerTest, theRingBufferDropsTheOldestRecords) {
+        tracer.Start(4);
+
+        for (uint64 cycles = 0; cycles < 6; cycles++)
+            tracer.UpdateStatus(cycles, cycles % 2 ? 0 : UART, SOURCES);
+
+        const auto records = tracer.GetRecords();
+
+        ASSERT_EQ(records.size(), 4u);
+        EXPECT_EQ(tracer.GetDroppedCount(), 2u);
+
+        EXPECT_EQ(records[0].cycles, 2u);
+        EXPECT_EQ(records[0].event, InterruptTracer::Event::raise);
+        EXPECT_EQ(records[3].cycles, 5u);
+        EXPECT_EQ(records[3].event, InterruptTracer::Event::clear);
+    }
+
+    TEST_F(InterruptTracerTest, sourcesAreAttributedToTheHandlerThatClearsThem) {
+        tracer.UpdateStatus(100, UART, SOURCES);
+        tracer.Accept(130, 4);
+        tracer.UpdateStatus(180, 0, SOURCES);
+        EXPECT_FALSE(tracer.CheckComplete(200, 0));
+
+        const auto uart = Source("UART");
+
+        EXPECT_EQ(uart.raised, 1u);
+        EXPECT_EQ(uart.serviced, 1u);
+        EXPECT_EQ(uart.latency.max, 30u);
+        EXPECT_EQ(uart.serviceTime.max, 80u);
+
+        const auto levels = tracer.GetLevelStats();
+
+        ASSERT_EQ(levels.size(), 1u);
+        EXPECT_EQ(levels[0].level, 4);
+        EXPECT_EQ(levels[0].accepted, 1u);
+        EXPECT_EQ(levels[0].duration.max, 70u);
+    }
+
+    TEST_F(InterruptTracerTest, nestedHandlersCompleteInnermostFirst) {
+        tracer.UpdateStatus(0, TIMER, SOURCES);
+        tracer.Accept(10, 4);
+        tracer.UpdateStatus(20, TIMER | IRQ6, SOURCES);
+        tracer.Accept(25, 6);
+        tracer.UpdateStatus(40, TIMER, SOURCES);
+
+        EXPECT_TRUE(tracer.CheckComplete(50, 4));
+        EXPECT_TRUE(tracer.HasActiveHandlers());
+
+        tracer.UpdateStatus(60, 0, SOURCES);
+
+        EXPECT_FALSE(tracer.CheckComplete(70, 0));
+        EXPECT_FALSE(tracer.HasActiveHandlers());
+
+        EXPECT_EQ(Source("IRQ6").latency.max, 5u);
+        EXPECT_EQ(Source("Timer").latency.max, 10u);
+        EXPECT_EQ(Source("Timer").serviceTime.max, 60u);
+
+        const auto levels = tracer.GetLevelStats();
+
+        ASSERT_EQ(levels.size(), 2u);
+        EXPECT_EQ(levels[0].level, 6);
+        EXPECT_EQ(levels[0].duration.max, 25u);
+        EXPECT_EQ(levels[1].level, 4);
+        EXPECT_EQ(levels[1].duration.max, 60u);
+    }
+
+    TEST_F(InterruptTracerTest, sourcesClearedOutsideOfHandlersAreNotServiced) {
+        tracer.UpdateStatus(0, UART, SOURCES);
+        tracer.UpdateStatus(500, 0, SOURCES);
+        tracer.UpdateStatus(1000, UART, SOURCES);
+
+        const auto uart = Source("UART");
+
+        EXPECT_EQ(uart.raised, 2u);
+        EXPECT_EQ(uart.serviced, 0u);
+        EXPECT_DOUBLE_EQ(uart.ratePerSecond, 2);
+    }
+
+    TEST_F(InterruptTracerTest, nothingIsRecordedWhileStopped) {
+        tracer.Stop();
+
+        tracer.UpdateStatus(0, UART, SOURCES);
+        tracer.Accept(10, 4);
+
+        EXPECT_FALSE(tracer.CheckComplete(20, 0));
+        EXPECT_TRUE(tracer.GetRecords().empty());
+    }
+
+    TEST_F(InterruptTracerTest, chromeTraceContainsHandlersAndPendingSources) {
+        tracer.UpdateStatus(1000, UART, SOURCES);
+        tracer.Accept(2000, 4);
+        tracer.UpdateStatus(3000, 0, SOURCES);
+        tracer.CheckComplete(4000, 0);
+
+        ostringstream stream;
+        tracer.WriteChromeTrace(stream, 1000000);
+
+        const string trace = stream.str();
+
+        EXPECT_EQ(trace.rfind("{\"traceEvents\": [", 0), 0u);
+        EXPECT_NE(
+            trace.find("{\"name\": \"IRQ4\", \"cat\": \"handler\", \"ph\": \"X\", \"ts\": 1000.000, "
+                       "\"dur\": 2000.000, \"pid\": 1, \"tid\": 5, \"args\": {\"sources\": "
+                       "\"UART\"}}"),
+            string::npos);
+        EXPECT_NE(
+            trace.find("{\"name\": \"UART\", \"cat\": \"pending\", \"ph\": \"X\", \"ts\": 0.000, "
+                       "\"dur\": 2000.000, \"pid\": 1, \"tid\": 102"),
+            string::npos);
+        EXPECT_NE(trace.find("\"tid\": 5, \"args\": {\"name\": \"level 4\"}"), string::npos);
+    }
+}  // namespace
@@ -0,0 +1,383 @@
+#include <gtest/gtest.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+// clang-format off
+#include "EmDevice.h"
+#include "EmSession.h"
+#include "EmSessionContext.h"
+#include "EmSystemState.h"
+#include "Recording.h"
+#include "SessionFixture.h"
+// clang-format on
+
+namespace {
+    constexpr uint32 SLICE_CYCLES = 1000000;
+
+    struct BootResult {
+        bool initialized{false};
+        bool uiInitialized{false};
+        string deviceId;
+        EmSession* session{nullptr};
+    };
+
+    void boot(vector<uint8>& rom, const string& deviceId, BootResult& result) {
+        result.session = gSession;
+        result.initialized = initializeSession(rom, deviceId);
+        if (!result.initialized) return;
+
+        result.uiInitialized = bootSession();
+        result.deviceId = gSession->GetDevice().GetIDString();
+
+        gSession->Deinitialize();
+    }
+
+    // Runs one slice of the boot; returns true once the boot is done.
+    bool bootSlice() {
+        if (!gSystemState->IsUIInitialized() && gSession->GetSystemCycles() < MAX_BOOT_CYCLES)
+            gSession->RunEmulation(SLICE_CYCLES);
+
+        return gSystemState->IsUIInitialized() || gSession->GetSystemCycles() >= MAX_BOOT_CYCLES;
+    }
+
+    // A minimal pool of persistent workers. Each worker has its own queue, so
+    // the test controls which thread runs a slice of which session.
+    class WorkerPool {
+       public:
+        explicit WorkerPool(size_t size) : workers(size) {
+            for (auto& worker : workers) worker.workerThread = thread([&]() { worker.Run(); });
+        }
+
+        ~WorkerPool() {
+            for (auto& worker : workers) worker.Post(nullptr);
+            for (auto& worker : workers) worker.workerThread.join();
+        }
+
+        template <typename F>
+        future<invoke_result_t<F>> Submit(size_t index, F f) {
+            auto task = make_shared<packaged_task<invoke_result_t<F>()>>(move(f));
+            auto result = task->get_future();
+
+            workers[index % workers.size()].Post([=]() { (*task)(); });
+
+            return result;
+        }
+
+       private:
+        struct Worker {
+            void Post(function<void()> job) {
+                {
+                    lock_guard lock(jobsMutex);
+                    jobs.push_back(move(job));
+                }
+
+                condition.notify_one();
+            }
+
+            void Run() {
+                while (true) {
+                    function<void()> job;
+
+                    {
+                        unique_lock lock(jobsMutex);
+                        condition.wait(lock, [&]() { return !jobs.empty(); });
+
+                        job = move(jobs.front());
+                        jobs.pop_front();
+                    }
+
+                    if (!job) return;
+                    job();
+                }
+            }
+
+            thread workerThread;
+            mutex jobsMutex;
+            condition_variable condition;
+            deque<function<void()>> jobs;
+        };
+
+        vector<Worker> workers;
+    };
+
+    TEST(MultiSessionTest, twoDevicesBootSideBySide) {
+        vector<uint8> romPalmV = readRom("palmv.rom");
+        vector<uint8> romPalmIIIc = readRom("palmiii.rom");
+
+        if (romPalmV.empty() || romPalmIIIc.empty()) GTEST_SKIP() << "ROM images not available";
+
+        BootResult resultPalmV, resultPalmIIIc;
+
+        thread threadPalmV(boot, ref(romPalmV), "PalmV", ref(resultPalmV));
+        thread threadPalmIIIc(boot, ref(romPalmIIIc), "PalmIIIc", ref(resultPalmIIIc));
+
+        threadPalmV.join();
+        threadPalmIIIc.join();
+
+        ASSERT_TRUE(resultPalmV.initialized);
+        ASSERT_TRUE(resultPalmIIIc.initialized);
+
+        EXPECT_NE(resultPalmV.session, resultPalmIIIc.session);
+        EXPECT_NE(resultPalmV.session, gSession);
+
+        EXPECT_TRUE(resultPalmV.uiInitialized);
+        EXPECT_TRUE(resultPalmIIIc.uiInitialized);
+
+        EXPECT_EQ(resultPalmV.deviceId, "PalmV");
+        EXPECT_EQ(resultPalmIIIc.deviceId, "PalmIIIc");
+    }
+
+    TEST(MultiSessionTest, inputIsQueuedFromAnotherThread) {
+        vector<uint8> rom = readRom("palmv.rom");
+        if (rom.empty()) GTEST_SKIP() << "ROM image not available";
+
+        ASSERT_TRUE(initializeSession(rom, "PalmV"));
+        ASSERT_TRUE(bootSession());
+
+        Recording recording;
+        ASSERT_TRUE(gSession->StartRecording(recording));
+
+        EmSession* session = gSession;
+        thread producer([=]() {
+            session->QueuePenEvent(PenEvent::down(10, 20));
+            session->QueuePenEvent(PenEvent::up());
+            session->QueueButtonEvent(
+                ButtonEvent(ButtonEvent::Button::app1, ButtonEvent::Type::press));
+            session->QueueButtonEvent(
+                ButtonEvent(ButtonEvent::Button::app1, ButtonEvent::Type::release));
+        });
+
+        for (int i = 0; i < 1000 && recording.GetEvents().size() < 4; i++)
+            gSession->RunEmulation(10000);
+
+        producer.join();
+        gSession->RunEmulation(10000);
+        gSession->StopRecording();
+
+        ASSERT_EQ(recording.GetEvents().size(), 4u);
+        EXPECT_EQ(recording.GetEvents()[0].kind, Recording::Event::Kind::pen);
+        EXPECT_EQ(recording.GetEvents()[2].kind, Recording::Event::Kind::button);
+        EXPECT_EQ(recording.GetEvents()[3].buttonType, ButtonEvent::Type::release);
+
+        gSession->Deinitialize();
+    }
+
+    TEST(MultiSessionTest, contextsAlternateOnOneThread) {
+        vector<uint8> romPalmV = readRom("palmv.rom");
+        vector<uint8> romPalmIIIc = readRom("palmiii.rom");
+
+        if (romPalmV.empty() || romPalmIIIc.empty()) GTEST_SKIP() << "ROM images not available";
+
+        EmSession* ownSession = gSession;
+        EmSessionContext contextPalmV, contextPalmIIIc;
+        EmSession *sessionPalmV, *sessionPalmIIIc;
+
+        {
+            EmSessionContext::Binding binding(contextPalmV);
+
+            ASSERT_TRUE(initializeSession(romPalmV, "PalmV"));
+            sessionPalmV = gSession;
+        }
+
+        {
+            EmSessionContext::Binding binding(contextPalmIIIc);
+
+            ASSERT_TRUE(initializeSession(romPalmIIIc, "PalmIIIc"));
+            sessionPalmIIIc = gSession;
+        }
+
+        EXPECT_EQ(gSession, ownSession);
+        EXPECT_NE(sessionPalmV, sessionPalmIIIc);
+
+        bool donePalmV = false, donePalmIIIc = false;
+
+        while (!donePalmV || !donePalmIIIc) {
+            {
+                EmSessionContext::Binding binding(contextPalmV);
+                donePalmV = bootSlice();
+            }
+
+            {
+                EmSessionContext::Binding binding(contextPalmIIIc);
+                donePalmIIIc = bootSlice();
+            }
+        }
+
+        {
+            EmSessionContext::Binding binding(contextPalmV);
+
+            EXPECT_EQ(gSession, sessionPalmV);
+            EXPECT_TRUE(gSystemState->IsUIInitialized());
+            EXPECT_EQ(gSession->GetDevice().GetIDString(), "PalmV");
+        }
+
+        {
+            EmSessionContext::Binding binding(contextPalmIIIc);
+
+            EXPECT_EQ(gSession, sessionPalmIIIc);
+            EXPECT_TRUE(gSystemState->IsUIInitialized());
+            EXPECT_EQ(gSession->GetDevice().GetIDString(), "PalmIIIc");
+        }
+
+        EXPECT_EQ(EmSessionContext::GetBound(), nullptr);
+        EXPECT_EQ(gSession, ownSession);
+    }
+
+    TEST(MultiSessionTest, sessionsMigrateBetweenPoolThreads) {
+        vector<uint8> romPalmV = readRom("palmv.rom");
+        vector<uint8> romPalmIIIc = readRom("palmiii.rom");
+
+        if (romPalmV.empty() || romPalmIIIc.empty()) GTEST_SKIP() << "ROM images not available";
+
+        EmSessionContext contextPalmV, contextPalmIIIc;
+        WorkerPool pool(2);
+
+        auto initializeOn = [&](size_t worker, EmSessionContext& context, vector<uint8>& rom,
+                                const string& deviceId) {
+            return pool.Submit(worker, [&context, &rom, deviceId]() {
+                EmSessionContext::Binding binding(context);
+
+                return initializeSession(rom, deviceId) ? gSession : nullptr;
+            });
+        };
+
+        auto futurePalmV = initializeOn(0, contextPalmV, romPalmV, "PalmV");
+        auto futurePalmIIIc = initializeOn(1, contextPalmIIIc, romPalmIIIc, "PalmIIIc");
+
+        EmSession* sessionPalmV = futurePalmV.get();
+        EmSession* sessionPalmIIIc = futurePalmIIIc.get();
+
+        ASSERT_NE(sessionPalmV, nullptr);
+        ASSERT_NE(sessionPalmIIIc, nullptr);
+        EXPECT_NE(sessionPalmV, sessionPalmIIIc);
+
+        // Both sessions run concurrently, and every round swaps the workers.
+        auto slice = [](EmSessionContext& context, EmSession* session) {
+            EmSessionContext::Binding binding(context);
+            EXPECT_EQ(gSession, session);
+
+            return bootSlice();
+        };
+
+        bool donePalmV = false, donePalmIIIc = false;
+
+        for (size_t round = 1; !donePalmV || !donePalmIIIc; round++) {
+            auto resultPalmV =
+                pool.Submit(round, [&]() { return slice(contextPalmV, sessionPalmV); });
+            auto resultPalmIIIc =
+                pool.Submit(round + 1, [&]() { return slice(contextPalmIIIc, sessionPalmIIIc); });
+
+            donePalmV = resultPalmV.get();
+            donePalmIIIc = resultPalmIIIc.get();
+        }
+
+        struct Result {
+            EmSession* session;
+            bool uiInitialized;
+            string deviceId;
+            EmSession* ownSession;
+        };
+
+        auto inspect = [&](size_t worker, EmSessionContext& context) {
+            return pool.Submit(worker, [&context]() {
+                Result result;
+
+                {
+                    EmSessionContext::Binding binding(context);
+
+                    result.session = gSession;
+                    result.uiInitialized = gSystemState->IsUIInitialized();
+                    result.deviceId = gSession->GetDevice().GetIDString();
+                }
+
+                result.ownSession = gSession;
+
+                return result;
+            });
+        };
+
+        Result resultPalmV = inspect(0, contextPalmV).get();
+        Result resultPalmIIIc = inspect(0, contextPalmIIIc).get();
+
+        EXPECT_EQ(resultPalmV.session, sessionPalmV);
+        EXPECT_TRUE(resultPalmV.uiInitialized);
+        EXPECT_EQ(resultPalmV.deviceId, "PalmV");
+
+        EXPECT_EQ(resultPalmIIIc.session, sessionPalmIIIc);
+        EXPECT_TRUE(resultPalmIIIc.uiInitialized);
+        EXPECT_EQ(resultPalmIIIc.deviceId, "PalmIIIc");
+
+        // Unbinding restores the worker's own session.
+        EXPECT_EQ(resultPalmV.ownSession, resultPalmIIIc.ownSession);
+        EXPECT_NE(resultPalmV.ownSession, sessionPalmV);
+        EXPECT_NE(resultPalmV.ownSession, sessionPalmIIIc);
+        EXPECT_NE(resultPalmV.ownSession, gSession);
+    }
+
+    // Any state that leaks between contexts, or that refers to the address of
+    // a thread-local variable, makes an interleaved session diverge from a
+    // session that runs on its own. The interleaved sessions replay a
+    // recording of the solo run, as that fixes the clock and the random seed.
+    TEST(MultiSessionTest, interleavedSessionsMatchSoloRuns) {
+        constexpr size_t SLICES = 40;
+
+        vector<uint8> romPalmV = readRom("palmv.rom");
+        vector<uint8> romPalmIIIc = readRom("palmiii.rom");
+
+        if (romPalmV.empty() || romPalmIIIc.empty()) GTEST_SKIP() << "ROM images not available";
+
+        auto runSolo = [&](vector<uint8>& rom, const string& deviceId, Recording& recording) {
+            EmSessionContext context;
+            EmSessionContext::Binding binding(context);
+
+            EXPECT_TRUE(initializeSession(rom, deviceId));
+            EXPECT_TRUE(gSession->StartRecording(recording));
+
+            for (size_t i = 0; i < SLICES; i++) gSession->RunEmulation(SLICE_CYCLES);
+
+            gSession->StopRecording();
+
+            return captureState();
+        };
+
+        Recording recordingPalmV, recordingPalmIIIc;
+
+        CapturedState soloPalmV = runSolo(romPalmV, "PalmV", recordingPalmV);
+        CapturedState soloPalmIIIc = runSolo(romPalmIIIc, "PalmIIIc", recordingPalmIIIc);
+
+        EmSessionContext contextPalmV, contextPalmIIIc;
+        WorkerPool pool(2);
+
+        auto run = [&](size_t worker, EmSessionContext& context, function<void()> job) {
+            pool.Submit(worker, [&context, job]() {
+                    EmSessionContext::Binding binding(context);
+                    job();
+                })
+                .get();
+        };
+
+        run(0, contextPalmV, [&]() {
+            ASSERT_TRUE(initializeSession(romPalmV, "PalmV"));
+            ASSERT_TRUE(gSession->StartReplay(recordingPalmV));
+        });
+
+        run(0, contextPalmIIIc, [&]() {
+            ASSERT_TRUE(initializeSession(romPalmIIIc, "PalmIIIc"));
+            ASSERT_TRUE(gSession->StartReplay(recordingPalmIIIc));
+        });
+
+        // Both sessions share each worker, and change workers every round.
+        for (size_t i = 0; i < SLICES; i++) {
+            run(i, contextPalmV, []() { gSession->RunEmulation(SLICE_CYCLES); });
+            run(i, contextPalmIIIc, []() { gSession->RunEmulation(SLICE_CYCLES); });
+        }
+
+        run(0, contextPalmV, [&]() { expectStatesEqual(captureState(), soloPalmV); });
+        run(0, contextPalmIIIc, [&]() { expectStatesEqual(captureState(), soloPalmIIIc); });
+    }
+}  // namespace
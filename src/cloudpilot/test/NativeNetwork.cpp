@@ -0,0 +1,267 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+// clang-format off
+#include "NativeNetwork.h"
+#include "pb_decode.h"
+#include "pb_encode.h"
+// clang-format on
+
+namespace {
+    constexpr uint32 LOCALHOST = 0x7f000001;
+
+    struct Buffer {
+        const uint8* data;
+        size_t len;
+    };
+
+    bool encodeBufferCb(pb_ostream_t* stream, const pb_field_iter_t* field, void* const* arg) {
+        const Buffer* buffer = static_cast<const Buffer*>(*arg);
+
+        return pb_encode_tag_for_field(stream, field) &&
+               pb_encode_string(stream, buffer->data, buffer->len);
+    }
+
+    bool decodeBufferCb(pb_istream_t* stream, const pb_field_iter_t* field, void** arg) {
+        vector<uint8>* data = static_cast<vector<uint8>*>(*arg);
+
+        data->resize(stream->bytes_left);
+
+        return pb_read(stream, data->data(), data->size());
+    }
+
+    bool payloadDecodeCb(pb_istream_t* stream, const pb_field_iter_t* field, void** arg) {
+        if (field->tag == MsgResponse_socketReceiveResponse_tag) {
+            MsgSocketReceiveResponse* response =
+                static_cast<MsgSocketReceiveResponse*>(field->pData);
+
+            response->data.arg = *arg;
+            response->data.funcs.decode = decodeBufferCb;
+        }
+
+        return true;
+    }
+
+    class NativeNetworkTest : public ::testing::Test {
+       protected:
+        MsgResponse Execute(MsgRequest& request) {
+            uint8 buffer[1024];
+            pb_ostream_t ostream = pb_ostream_from_buffer(buffer, sizeof(buffer));
+
+            request.id = ++id;
+            EXPECT_TRUE(pb_encode(&ostream, MsgRequest_fields, &request));
+
+            auto [responseData, responseSize] =
+                network.HandleRequest(buffer, ostream.bytes_written);
+            EXPECT_NE(responseData, nullptr);
+
+            MsgResponse response = MsgResponse_init_zero;
+            response.cb_payload.funcs.decode = payloadDecodeCb;
+            response.cb_payload.arg = &received;
+
+            pb_istream_t istream = pb_istream_from_buffer(responseData, responseSize);
+            EXPECT_TRUE(pb_decode(&istream, MsgResponse_fields, &response));
+            EXPECT_EQ(response.id, id);
+
+            delete[] responseData;
+
+            return response;
+        }
+
+        MsgSocketOpenResponse Open(uint32 type = 1) {
+            MsgRequest request = MsgRequest_init_zero;
+            request.which_payload = MsgRequest_socketOpenRequest_tag;
+            request.payload.socketOpenRequest = {type, 0};
+
+            return Execute(request).payload.socketOpenResponse;
+        }
+
+        int32 Bind(int32 handle, uint32 ip, int32 port) {
+            MsgRequest request = MsgRequest_init_zero;
+            request.which_payload = MsgRequest_socketBindRequest_tag;
+            request.payload.socketBindRequest = {handle, {ip, port}, 1000};
+
+            return Execute(request).payload.socketBindResponse.err;
+        }
+
+        Address LocalAddress(int32 handle) {
+            MsgRequest request = MsgRequest_init_zero;
+            request.which_payload = MsgRequest_socketAddrRequest_tag;
+            request.payload.socketAddrRequest = {handle, true, false, 1000};
+
+            MsgSocketAddrResponse response = Execute(request).payload.socketAddrResponse;
+            EXPECT_EQ(response.err, 0);
+            EXPECT_TRUE(response.has_addressLocal);
+
+            return response.addressLocal;
+        }
+
+        int32 Listen(int32 handle) {
+            MsgRequest request = MsgRequest_init_zero;
+            request.which_payload = MsgRequest_socketListenRequest_tag;
+            request.payload.socketListenRequest = {handle, 1, 1000};
+
+            return Execute(request).payload.socketListenResponse.err;
+        }
+
+        int32 Connect(int32 handle, const Address& address) {
+            MsgRequest request = MsgRequest_init_zero;
+            request.which_payload = MsgRequest_socketConnectRequest_tag;
+            request.payload.socketConnectRequest = {handle, address, 1000};
+
+            return Execute(request).payload.socketConnectResponse.err;
+        }
+
+        MsgSocketAcceptResponse Accept(int32 handle) {
+            MsgRequest request = MsgRequest_init_zero;
+            request.which_payload = MsgRequest_socketAcceptRequest_tag;
+            request.payload.socketAcceptRequest = {handle, 1000};
+
+            return Execute(request).payload.socketAcceptResponse;
+        }
+
+        MsgSocketSendResponse Send(int32 handle, const char* data) {
+            Buffer buffer{reinterpret_cast<const uint8*>(data), strlen(data)};
+
+            MsgRequest request = MsgRequest_init_zero;
+            request.which_payload = MsgRequest_socketSendRequest_tag;
+            request.payload.socketSendRequest.handle = handle;
+            request.payload.socketSendRequest.timeout = 1000;
+            request.payload.socketSendRequest.data.funcs.encode = encodeBufferCb;
+            request.payload.socketSendRequest.data.arg = &buffer;
+
+            return Execute(request).payload.socketSendResponse;
+        }
+
+        int32 Receive(int32 handle, uint32 maxLen, int32 timeout = 1000) {
+            MsgRequest request = MsgRequest_init_zero;
+            request.which_payload = MsgRequest_socketReceiveRequest_tag;
+            request.payload.socketReceiveRequest = {handle, 0, timeout, maxLen, false};
+
+            received.clear();
+
+            return Execute(request).payload.socketReceiveResponse.err;
+        }
+
+        int32 Close(int32 handle) {
+            MsgRequest request = MsgRequest_init_zero;
+            request.which_payload = MsgRequest_socketCloseRequest_tag;
+            request.payload.socketCloseRequest = {handle, 1000};
+
+            return Execute(request).payload.socketCloseResponse.err;
+        }
+
+        MsgSelectResponse Select(uint32 readFDs, uint32 writeFDs, int32 timeout) {
+            MsgRequest request = MsgRequest_init_zero;
+            request.which_payload = MsgRequest_selectRequest_tag;
+            request.payload.selectRequest = {32, readFDs, writeFDs, 0, timeout};
+
+            return Execute(request).payload.selectResponse;
+        }
+
+        int32 SetNonblocking(int32 handle) {
+            MsgRequest request = MsgRequest_init_zero;
+            request.which_payload = MsgRequest_socketOptionSetRequest_tag;
+            request.payload.socketOptionSetRequest.handle = handle;
+            request.payload.socketOptionSetRequest.level = netSocketOptLevelSocket;
+            request.payload.socketOptionSetRequest.option = netSocketOptSockNonBlocking;
+            request.payload.socketOptionSetRequest.which_value =
+                MsgSocketOptionSetRequest_intval_tag;
+            request.payload.socketOptionSetRequest.value.intval = 1;
+
+            return Execute(request).payload.socketOptionSetResponse.err;
+        }
+
+        // Sets up a listening socket, a client and the accepted server end
+        // of the connection.
+        void Connection(int32& listener, int32& client, int32& server) {
+            listener = Open().handle;
+            ASSERT_EQ(Bind(listener, LOCALHOST, 0), 0);
+            ASSERT_EQ(Listen(listener), 0);
+
+            Address address = LocalAddress(listener);
+            ASSERT_NE(address.port, 0);
+
+            client = Open().handle;
+            ASSERT_EQ(Connect(client, address), 0);
+
+            MsgSocketAcceptResponse accepted = Accept(listener);
+            ASSERT_EQ(accepted.err, 0);
+            ASSERT_EQ(accepted.address.ip, LOCALHOST);
+
+            server = accepted.handle;
+        }
+
+       protected:
+        NativeNetwork network;
+
+        uint32 id{0};
+        vector<uint8> received;
+    };
+
+    TEST_F(NativeNetworkTest, itOpensAndClosesSockets) {
+        MsgSocketOpenResponse response = Open();
+
+        EXPECT_EQ(response.err, 0);
+        EXPECT_EQ(response.handle, 1);
+
+        EXPECT_EQ(Close(response.handle), 0);
+        EXPECT_EQ(Open().handle, 1);
+    }
+
+    TEST_F(NativeNetworkTest, itRejectsBadSocketTypesAndHandles) {
+        EXPECT_EQ(Open(42).err, netErrParamErr);
+
+        EXPECT_EQ(Close(5), netErrParamErr);
+        EXPECT_EQ(Receive(5, 16), netErrParamErr);
+        EXPECT_EQ(Send(NativeNetwork::MAX_HANDLE + 1, "x").err, netErrParamErr);
+    }
+
+    TEST_F(NativeNetworkTest, itTransfersDataOverLoopback) {
+        int32 listener, client, server;
+        Connection(listener, client, server);
+
+        MsgSocketSendResponse sent = Send(client, "hello world");
+        EXPECT_EQ(sent.err, 0);
+        EXPECT_EQ(sent.bytesSent, 11);
+
+        EXPECT_EQ(Receive(server, 5), 0);
+        EXPECT_EQ(string(received.begin(), received.end()), "hello");
+
+        EXPECT_EQ(Receive(server, 64), 0);
+        EXPECT_EQ(string(received.begin(), received.end()), " world");
+
+        EXPECT_EQ(Close(client), 0);
+
+        EXPECT_EQ(Receive(server, 64), 0);
+        EXPECT_TRUE(received.empty());
+    }
+
+    TEST_F(NativeNetworkTest, itReportsReadinessOnSelect) {
+        int32 listener, client, server;
+        Connection(listener, client, server);
+
+        MsgSelectResponse response = Select(1 << server, 1 << client, 0);
+        EXPECT_EQ(response.err, 0);
+        EXPECT_EQ(response.readFDs, 0u);
+        EXPECT_EQ(response.writeFDs, 1u << client);
+
+        Send(client, "ping");
+
+        response = Select(1 << server, 0, 1000);
+        EXPECT_EQ(response.err, 0);
+        EXPECT_EQ(response.readFDs, 1u << server);
+    }
+
+    TEST_F(NativeNetworkTest, itHonorsNonblockingMode) {
+        int32 listener, client, server;
+        Connection(listener, client, server);
+
+        EXPECT_EQ(SetNonblocking(server), 0);
+        EXPECT_EQ(Receive(server, 16), netErrWouldBlock);
+
+        EXPECT_EQ(Receive(client, 16, 10), netErrTimeout);
+    }
+}  // namespace
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+// clang-format off
+#include "NetworkRpcTracker.h"
+// clang-format on
+
+namespace {
+    constexpr emuptr SP_A = 0x1000;
+    constexpr emuptr SP_B = 0x2000;
+
+    constexpr uint32 TAG_RECEIVE = 1;
+    constexpr uint32 TAG_SEND = 2;
+
+    class NetworkRpcTrackerTest : public ::testing::Test {
+       protected:
+        void Add(uint32 id, emuptr sp, uint32 tag) {
+            tracker.Add(
+                id, sp, tag,
+                [=](void* response, size_t size) {
+                    results.push_back(string(static_cast<char*>(response), size));
+                },
+                [=]() { results.push_back("fail " + to_string(id)); });
+        }
+
+        bool Complete(uint32 id, const string& response) {
+            return tracker.Complete(id, reinterpret_cast<const uint8*>(response.data()),
+                                    response.size());
+        }
+
+       protected:
+        NetworkRpcTracker tracker;
+        vector<string> results;
+    };
+
+    TEST_F(NetworkRpcTrackerTest, itRestartsCallsUntilTheirResponseArrives) {
+        Add(1, SP_A, TAG_RECEIVE);
+
+        EXPECT_EQ(tracker.Resume(SP_A, TAG_RECEIVE), NetworkRpcTracker::State::pending);
+        EXPECT_EQ(tracker.PendingCount(), 1u);
+
+        ASSERT_TRUE(Complete(1, "hello"));
+
+        EXPECT_EQ(tracker.PendingCount(), 0u);
+        EXPECT_TRUE(results.empty());
+
+        EXPECT_EQ(tracker.Resume(SP_A, TAG_RECEIVE), NetworkRpcTracker::State::completed);
+        EXPECT_EQ(results, vector<string>({"hello"}));
+
+        EXPECT_EQ(tracker.Resume(SP_A, TAG_RECEIVE), NetworkRpcTracker::State::unknown);
+    }
+
+    TEST_F(NetworkRpcTrackerTest, itMatchesCallsByStackPointerAndRequestType) {
+        Add(1, SP_A, TAG_RECEIVE);
+        Add(2, SP_B, TAG_RECEIVE);
+        Add(3, SP_A, TAG_SEND);
+
+        EXPECT_EQ(tracker.Resume(SP_B, TAG_SEND), NetworkRpcTracker::State::unknown);
+
+        ASSERT_TRUE(Complete(3, "three"));
+        ASSERT_TRUE(Complete(2, "two"));
+
+        EXPECT_EQ(tracker.Resume(SP_A, TAG_RECEIVE), NetworkRpcTracker::State::pending);
+        EXPECT_EQ(tracker.Resume(SP_B, TAG_RECEIVE), NetworkRpcTracker::State::completed);
+        EXPECT_EQ(tracker.Resume(SP_A, TAG_SEND), NetworkRpcTracker::State::completed);
+
+        EXPECT_EQ(results, vector<string>({"two", "three"}));
+        EXPECT_EQ(tracker.PendingCount(), 1u);
+    }
+
+    TEST_F(NetworkRpcTrackerTest, itDiscardsResponsesToUnknownRequests) {
+        Add(1, SP_A, TAG_RECEIVE);
+
+        EXPECT_FALSE(Complete(2, "two"));
+        ASSERT_TRUE(Complete(1, "one"));
+        EXPECT_FALSE(Complete(1, "one again"));
+
+        EXPECT_EQ(tracker.Resume(SP_A, TAG_RECEIVE), NetworkRpcTracker::State::completed);
+        EXPECT_EQ(results, vector<string>({"one"}));
+    }
+
+    TEST_F(NetworkRpcTrackerTest, itFailsCancelledCalls) {
+        Add(1, SP_A, TAG_RECEIVE);
+        Add(2, SP_B, TAG_RECEIVE);
+
+        ASSERT_TRUE(Complete(1, "one"));
+        EXPECT_TRUE(tracker.Cancel());
+        EXPECT_FALSE(tracker.Cancel());
+
+        EXPECT_FALSE(Complete(2, "two"));
+
+        EXPECT_EQ(tracker.Resume(SP_A, TAG_RECEIVE), NetworkRpcTracker::State::completed);
+        EXPECT_EQ(tracker.Resume(SP_B, TAG_RECEIVE), NetworkRpcTracker::State::completed);
+
+        EXPECT_EQ(results, vector<string>({"one", "fail 2"}));
+    }
+
+    TEST_F(NetworkRpcTrackerTest, itForgetsCallsWhenCleared) {
+        Add(1, SP_A, TAG_RECEIVE);
+
+        tracker.Clear();
+
+        EXPECT_FALSE(Complete(1, "one"));
+        EXPECT_EQ(tracker.Resume(SP_A, TAG_RECEIVE), NetworkRpcTracker::State::unknown);
+        EXPECT_EQ(tracker.PendingCount(), 0u);
+        EXPECT_TRUE(results.empty());
+    }
+}  // namespace
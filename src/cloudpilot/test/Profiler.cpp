@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+// clang-format off
+#include "Profiler.h"
+#include "UAE.h"
+// clang-format on
+
+namespace {
+    class ProfilerTest : public ::testing::Test {
+       protected:
+        void SetUp() override {
+            // An odd frame pointer terminates the stack walk right away.
+            m68k_areg(regs, 6) = 1;
+
+            profiler.SetSymbols({{0x2000, 0x100, "bar"}, {0x1000, 0x100, "foo"}});
+        }
+
+        uint64 CyclesFor(const string& function) {
+            for (auto& [name, cycles] : profiler.GetFunctionCycles())
+                if (name == function) return cycles;
+
+            return 0;
+        }
+
+       protected:
+        Profiler profiler;
+    };
+
+    TEST_F(ProfilerTest, itAttributesCyclesToFunctions) {
+        profiler.Start(1000000);
+
+        profiler.Tick(0, 0x1000);
+        profiler.Tick(10, 0x1002);
+        profiler.Tick(14, 0x2000);
+        profiler.Tick(20, Profiler::IDLE_PC);
+        profiler.Tick(120, 0x1004);
+
+        EXPECT_EQ(profiler.GetTotalCycles(), 120u);
+
+        EXPECT_EQ(CyclesFor("foo"), 14u);
+        EXPECT_EQ(CyclesFor("bar"), 6u);
+        EXPECT_EQ(CyclesFor("[idle]"), 100u);
+
+        EXPECT_EQ(profiler.GetFunctionCycles().front().first, "[idle]");
+    }
+
+    TEST_F(ProfilerTest, itResyncsIfTheCycleCountJumpsBack) {
+        profiler.Start(1000000);
+
+        profiler.Tick(100, 0x1000);
+        profiler.Tick(50, 0x2000);
+        profiler.Tick(60, 0x1000);
+
+        EXPECT_EQ(profiler.GetTotalCycles(), 10u);
+        EXPECT_EQ(CyclesFor("bar"), 10u);
+    }
+
+    TEST_F(ProfilerTest, itSamplesCollapsedStacks) {
+        profiler.Start(10);
+
+        profiler.Tick(0, 0x1000);
+        profiler.Tick(10, 0x2000);
+        profiler.Tick(25, 0x1000);
+        profiler.Tick(30, 0x1000);
+
+        EXPECT_EQ(profiler.GetSampleCount(), 2u);
+
+        stringstream stream;
+        profiler.WriteCollapsedStacks(stream);
+
+        EXPECT_EQ(stream.str(), "bar 15\nfoo 10\n");
+    }
+
+    TEST_F(ProfilerTest, clearDiscardsTheProfile) {
+        profiler.Start(10);
+
+        profiler.Tick(0, 0x1000);
+        profiler.Tick(20, 0x1000);
+
+        profiler.Clear();
+        profiler.Stop();
+
+        EXPECT_FALSE(profiler.IsRunning());
+        EXPECT_EQ(profiler.GetTotalCycles(), 0u);
+        EXPECT_EQ(profiler.GetSampleCount(), 0u);
+        EXPECT_TRUE(profiler.GetFunctionCycles().empty());
+    }
+}  // namespace
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// clang-format off
+#include "ProxyClient.h"
+#include "networking.pb.h"
+#include "pb_decode.h"
+#include "pb_encode.h"
+// clang-format on
+
+using namespace std::chrono_literals;
+
+namespace {
+    bool sendOpen(ProxyClient& client, uint32 id) {
+        uint8 buffer[128];
+        pb_ostream_t stream = pb_ostream_from_buffer(buffer, sizeof(buffer));
+
+        MsgRequest request = MsgRequest_init_zero;
+        request.id = id;
+        request.which_payload = MsgRequest_socketOpenRequest_tag;
+        request.payload.socketOpenRequest = {1, 0};
+
+        return pb_encode(&stream, MsgRequest_fields, &request) &&
+               client.Send(buffer, stream.bytes_written);
+    }
+
+    TEST(ProxyClientNativeTest, itPipelinesRequests) {
+        unique_ptr<ProxyClient> client(ProxyClient::CreateNative());
+        ASSERT_TRUE(client->Connect());
+
+        for (uint32 id = 1; id <= 3; id++) ASSERT_TRUE(sendOpen(*client, id));
+
+        vector<MsgResponse> responses;
+        auto deadline = chrono::steady_clock::now() + 5s;
+
+        while (responses.size() < 3 && chrono::steady_clock::now() < deadline) {
+            pair<uint8*, size_t> response;
+            ASSERT_TRUE(client->TryReceive(response));
+
+            if (!response.first) {
+                this_thread::sleep_for(1ms);
+                continue;
+            }
+
+            MsgResponse decoded = MsgResponse_init_zero;
+            pb_istream_t stream = pb_istream_from_buffer(response.first, response.second);
+
+            EXPECT_TRUE(pb_decode(&stream, MsgResponse_fields, &decoded));
+            delete[] response.first;
+
+            responses.push_back(decoded);
+        }
+
+        ASSERT_EQ(responses.size(), 3u);
+
+        for (uint32 i = 0; i < 3; i++) {
+            EXPECT_EQ(responses[i].id, i + 1);
+            EXPECT_EQ(responses[i].which_payload, MsgResponse_socketOpenResponse_tag);
+            EXPECT_EQ(responses[i].payload.socketOpenResponse.handle, static_cast<int32>(i + 1));
+        }
+
+        client->Disconnect();
+
+        pair<uint8*, size_t> response;
+        EXPECT_FALSE(client->TryReceive(response));
+        EXPECT_EQ(response.first, nullptr);
+    }
+}  // namespace
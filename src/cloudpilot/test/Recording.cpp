@@ -0,0 +1,321 @@
+#include <gtest/gtest.h>
+
+// clang-format off
+#include "EmSession.h"
+#include "Recording.h"
+#include "SessionFixture.h"
+// clang-format on
+
+namespace {
+    constexpr uint32 PAGE_SIZE = DeltaSnapshot::PAGE_SIZE;
+    constexpr uint32 MEMORY_SIZE = 4 * PAGE_SIZE;
+
+    vector<uint8> page(uint8 value) { return vector<uint8>(PAGE_SIZE, value); }
+
+    DeltaSnapshot fullSnapshot(uint8 value) {
+        DeltaSnapshot snapshot(DeltaSnapshot::Kind::full, 42, 0, MEMORY_SIZE);
+
+        for (uint32 i = 0; i < MEMORY_SIZE / PAGE_SIZE; i++)
+            snapshot.AddPage(i, page(value).data());
+
+        snapshot.SetSavestate("base", 4);
+
+        return snapshot;
+    }
+
+    DeltaSnapshot delta(uint32 sequence, uint32 index, uint8 value) {
+        DeltaSnapshot snapshot(DeltaSnapshot::Kind::delta, 42, sequence, MEMORY_SIZE);
+        snapshot.AddPage(index, page(value).data());
+        snapshot.SetSavestate("delta", 5);
+
+        return snapshot;
+    }
+
+    Recording::Event penEvent(uint64 cycles, int32 x, int32 y) {
+        Recording::Event event;
+        event.cycles = cycles;
+        event.kind = Recording::Event::Kind::pen;
+        event.penEvent = PenEvent::down(x, y);
+
+        return event;
+    }
+
+    Recording::Event buttonEvent(uint64 cycles, ButtonEvent::Button button,
+                                 ButtonEvent::Type type) {
+        Recording::Event event;
+        event.cycles = cycles;
+        event.kind = Recording::Event::Kind::button;
+        event.button = button;
+        event.buttonType = type;
+
+        return event;
+    }
+
+    void populate(Recording& recording) {
+        DeltaSnapshot base = fullSnapshot(0);
+        DeltaSnapshot delta1 = delta(1, 1, 0x11);
+        DeltaSnapshot delta2 = delta(2, 2, 0x22);
+
+        recording.SetEnvironment(1234567890, 0xdeadbeef, 1.5);
+
+        ASSERT_TRUE(recording.AddCheckpoint(1000, base));
+        ASSERT_TRUE(recording.AddEvent(penEvent(1500, 10, 20)));
+        ASSERT_TRUE(recording.AddCheckpoint(2000, delta1));
+        ASSERT_TRUE(recording.AddEvent(
+            buttonEvent(2500, ButtonEvent::Button::app2, ButtonEvent::Type::release)));
+        ASSERT_TRUE(recording.AddCheckpoint(3000, delta2));
+
+        recording.SetEndCycles(4000);
+    }
+
+    TEST(RecordingTest, itRequiresAFullBaseAndOrderedEntries) {
+        Recording recording;
+        DeltaSnapshot base = fullSnapshot(0);
+        DeltaSnapshot delta1 = delta(1, 1, 0x11);
+
+        ASSERT_FALSE(recording.AddEvent(penEvent(100, 0, 0)));
+        ASSERT_FALSE(recording.AddCheckpoint(100, delta1));
+
+        ASSERT_TRUE(recording.AddCheckpoint(100, base));
+        ASSERT_FALSE(recording.AddCheckpoint(200, base));
+        ASSERT_FALSE(recording.AddEvent(penEvent(50, 0, 0)));
+
+        ASSERT_TRUE(recording.AddEvent(penEvent(300, 0, 0)));
+        ASSERT_FALSE(recording.AddEvent(penEvent(200, 0, 0)));
+        ASSERT_FALSE(recording.AddCheckpoint(200, delta1));
+
+        ASSERT_EQ(recording.GetEndCycles(), 300u);
+    }
+
+    TEST(RecordingTest, findCheckpointReturnsTheLatestCheckpointBeforeTheTarget) {
+        Recording recording;
+        populate(recording);
+
+        EXPECT_EQ(recording.FindCheckpoint(0), 0u);
+        EXPECT_EQ(recording.FindCheckpoint(1999), 0u);
+        EXPECT_EQ(recording.FindCheckpoint(2000), 1u);
+        EXPECT_EQ(recording.FindCheckpoint(2999), 1u);
+        EXPECT_EQ(recording.FindCheckpoint(100000), 2u);
+
+        EXPECT_EQ(recording.GetCheckpoints()[1].nextEvent, 1u);
+        EXPECT_EQ(recording.GetCheckpoints()[2].nextEvent, 2u);
+    }
+
+    TEST(RecordingTest, restoreCheckpointCompactsTheDeltas) {
+        Recording recording;
+        populate(recording);
+
+        DeltaSnapshot snapshot;
+        ASSERT_TRUE(recording.RestoreCheckpoint(2, snapshot));
+
+        vector<uint8> memory(MEMORY_SIZE, 0xff);
+
+        EXPECT_EQ(snapshot.GetKind(), DeltaSnapshot::Kind::full);
+        EXPECT_EQ(snapshot.GetSequence(), 2u);
+        ASSERT_TRUE(snapshot.Apply(memory.data(), MEMORY_SIZE));
+
+        EXPECT_EQ(memory[0], 0);
+        EXPECT_EQ(memory[PAGE_SIZE], 0x11);
+        EXPECT_EQ(memory[2 * PAGE_SIZE], 0x22);
+        EXPECT_EQ(memory[3 * PAGE_SIZE], 0);
+
+        EXPECT_FALSE(recording.RestoreCheckpoint(3, snapshot));
+    }
+
+    TEST(RecordingTest, serializationRoundTrips) {
+        Recording recording;
+        populate(recording);
+
+        ASSERT_TRUE(recording.Serialize());
+
+        Recording deserialized;
+        ASSERT_TRUE(deserialized.Deserialize(recording.GetSerializedImage(),
+                                             recording.GetSerializedImageSize()));
+
+        EXPECT_EQ(deserialized.GetStartTime(), 1234567890);
+        EXPECT_EQ(deserialized.GetRandomSeed(), 0xdeadbeef);
+        EXPECT_DOUBLE_EQ(deserialized.GetClockFactor(), 1.5);
+        EXPECT_EQ(deserialized.GetStartCycles(), 1000u);
+        EXPECT_EQ(deserialized.GetEndCycles(), 4000u);
+
+        ASSERT_EQ(deserialized.GetEvents().size(), 2u);
+
+        const Recording::Event& pen = deserialized.GetEvents()[0];
+        EXPECT_EQ(pen.cycles, 1500u);
+        EXPECT_EQ(pen.kind, Recording::Event::Kind::pen);
+        EXPECT_TRUE(pen.penEvent.isPenDown());
+        EXPECT_EQ(pen.penEvent.getX(), 10);
+        EXPECT_EQ(pen.penEvent.getY(), 20);
+
+        const Recording::Event& button = deserialized.GetEvents()[1];
+        EXPECT_EQ(button.kind, Recording::Event::Kind::button);
+        EXPECT_EQ(button.button, ButtonEvent::Button::app2);
+        EXPECT_EQ(button.buttonType, ButtonEvent::Type::release);
+
+        ASSERT_EQ(deserialized.GetCheckpoints().size(), 3u);
+        EXPECT_EQ(deserialized.GetCheckpoints()[2].snapshot,
+                  recording.GetCheckpoints()[2].snapshot);
+
+        DeltaSnapshot snapshot;
+        EXPECT_TRUE(deserialized.RestoreCheckpoint(2, snapshot));
+    }
+
+    TEST(RecordingTest, deserializeRejectsTruncatedImages) {
+        Recording recording;
+        populate(recording);
+
+        ASSERT_TRUE(recording.Serialize());
+
+        Recording deserialized;
+        EXPECT_FALSE(deserialized.Deserialize(recording.GetSerializedImage(),
+                                              recording.GetSerializedImageSize() - 1));
+        EXPECT_FALSE(deserialized.Deserialize(recording.GetSerializedImage(), 16));
+    }
+
+    TEST(RecordingTest, serializationKeepsHostInput) {
+        Recording recording;
+        populate(recording);
+
+        EXPECT_TRUE(recording.IsDeterministic());
+
+        recording.MarkHostInput(Recording::HostInput::serial);
+        ASSERT_TRUE(recording.Serialize());
+
+        Recording deserialized;
+        ASSERT_TRUE(deserialized.Deserialize(recording.GetSerializedImage(),
+                                             recording.GetSerializedImageSize()));
+
+        EXPECT_FALSE(deserialized.IsDeterministic());
+        EXPECT_TRUE(deserialized.UsesHostInput(Recording::HostInput::serial));
+        EXPECT_FALSE(deserialized.UsesHostInput(Recording::HostInput::network));
+    }
+
+    constexpr uint32 SLICE_CYCLES = 100000;
+
+    // Queues input between the slices of a recorded run: taps, a pen stroke
+    // and a few keys.
+    void queueInput(size_t slice) {
+        switch (slice) {
+            case 20:
+                gSession->QueuePenEvent(PenEvent::down(80, 80));
+                break;
+
+            case 22:
+                gSession->QueuePenEvent(PenEvent::down(90, 100));
+                break;
+
+            case 25:
+                gSession->QueuePenEvent(PenEvent::up());
+                break;
+
+            case 60:
+                gSession->QueueKeyboardEvent(KeyboardEvent('a'));
+                gSession->QueueKeyboardEvent(KeyboardEvent('b'));
+                break;
+
+            case 180:
+                gSession->QueuePenEvent(PenEvent::down(20, 140));
+                break;
+
+            case 184:
+                gSession->QueuePenEvent(PenEvent::up());
+                break;
+
+            case 220:
+                gSession->QueueKeyboardEvent(KeyboardEvent('c'));
+                break;
+        }
+    }
+
+    using RecordingSessionTest = PalmVSessionTest;
+
+    TEST_F(RecordingSessionTest, hostInputMarksTheRecordingAndStopsReplay) {
+        Recording recording;
+
+        ASSERT_TRUE(gSession->StartRecording(recording));
+        gSession->RunEmulation(100000);
+        gSession->NotifyHostInput(Recording::HostInput::network);
+        gSession->StopRecording();
+
+        EXPECT_TRUE(recording.UsesHostInput(Recording::HostInput::network));
+        EXPECT_FALSE(recording.IsDeterministic());
+
+        ASSERT_TRUE(gSession->StartReplay(recording));
+        gSession->RunEmulation(10000);
+        EXPECT_TRUE(gSession->IsReplaying());
+
+        gSession->NotifyHostInput(Recording::HostInput::network);
+        EXPECT_FALSE(gSession->IsReplaying());
+    }
+
+    TEST_F(RecordingSessionTest, replayReproducesTheRecordedRun) {
+        constexpr size_t MID_SLICE = 150;
+        constexpr size_t END_SLICE = 300;
+
+        Boot();
+
+        Recording recording;
+        ASSERT_TRUE(gSession->StartRecording(recording, 100));
+
+        CapturedState mid, end;
+
+        for (size_t slice = 0; slice < END_SLICE; slice++) {
+            if (slice == MID_SLICE) mid = captureState();
+
+            queueInput(slice);
+            gSession->RunEmulation(SLICE_CYCLES);
+        }
+
+        end = captureState();
+        gSession->StopRecording();
+
+        ASSERT_TRUE(recording.IsDeterministic());
+        ASSERT_GE(recording.GetEvents().size(), 8u);
+        ASSERT_GT(recording.FindCheckpoint(mid.systemCycles), 0u);
+
+        // Replay in slices that differ from the recorded run.
+        ASSERT_TRUE(gSession->StartReplay(recording));
+
+        while (gSession->IsReplaying() && gSession->GetSystemCycles() < end.systemCycles)
+            gSession->RunEmulation(
+                min<uint64>(end.systemCycles - gSession->GetSystemCycles(), SLICE_CYCLES / 3));
+
+        expectStatesEqual(captureState(), end);
+
+        // Seeking back restores a checkpoint from the middle of the run.
+        ASSERT_TRUE(gSession->IsReplaying());
+        ASSERT_TRUE(gSession->SeekReplay(mid.systemCycles));
+        expectStatesEqual(captureState(), mid);
+
+        ASSERT_TRUE(gSession->SeekReplay(end.systemCycles));
+        expectStatesEqual(captureState(), end);
+    }
+
+    TEST_F(RecordingSessionTest, aFullInputQueueKeepsRoomForReleases) {
+        Recording recording;
+        ASSERT_TRUE(gSession->StartRecording(recording));
+
+        size_t accepted = 0;
+        while (gSession->QueuePenEvent(PenEvent::down(10, accepted))) accepted++;
+
+        EXPECT_GT(accepted, 0u);
+        EXPECT_FALSE(gSession->QueueKeyboardEvent(KeyboardEvent('a')));
+        EXPECT_FALSE(gSession->QueueButtonEvent(
+            ButtonEvent(ButtonEvent::Button::app1, ButtonEvent::Type::press)));
+
+        EXPECT_TRUE(gSession->QueuePenEvent(PenEvent::up()));
+        EXPECT_TRUE(gSession->QueueButtonEvent(
+            ButtonEvent(ButtonEvent::Button::app1, ButtonEvent::Type::release)));
+
+        gSession->RunEmulation(10000);
+        gSession->StopRecording();
+
+        const vector<Recording::Event>& events = recording.GetEvents();
+
+        ASSERT_EQ(events.size(), accepted + 2);
+        EXPECT_FALSE(events[accepted].penEvent.isPenDown());
+        EXPECT_EQ(events[accepted + 1].buttonType, ButtonEvent::Type::release);
+
+        EXPECT_TRUE(gSession->QueueKeyboardEvent(KeyboardEvent('a')));
+    }
+}  // namespace
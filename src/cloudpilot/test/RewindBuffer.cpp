@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+
+// clang-format off
+#include "EmMemory.h"
+#include "EmSession.h"
+#include "RewindBuffer.h"
+#include "SessionFixture.h"
+// clang-format on
+
+namespace {
+    constexpr uint32 PAGE_SIZE = DeltaSnapshot::PAGE_SIZE;
+    constexpr size_t POINT_SIZE = PAGE_SIZE + sizeof(uint32) + 1;
+
+    class RewindBufferTest : public PalmVSessionTest {
+       protected:
+        void SetUp() override {
+            PalmVSessionTest::SetUp();
+            if (IsSkipped() || HasFatalFailure()) return;
+
+            memory = EmMemory::GetTotalMemory();
+            original.assign(memory, memory + 4 * PAGE_SIZE);
+        }
+
+        void TearDown() override {
+            rewindBuffer.Reset();
+
+            if (initialized) gSession->ConfigureRewind(0, 0);
+
+            PalmVSessionTest::TearDown();
+        }
+
+        // Writes behind the banks' back, as the rewind buffer does.
+        void Write(uint32 page, uint8 value) {
+            memset(memory + page * PAGE_SIZE, value, PAGE_SIZE);
+            EmMemory::GetBankDirtyPages()[page >> 3] |= 1 << (page & 0x07);
+        }
+
+        bool PageIs(uint32 page, uint8 value) {
+            for (uint32 i = 0; i < PAGE_SIZE; i++)
+                if (memory[page * PAGE_SIZE + i] != value) return false;
+
+            return true;
+        }
+
+        bool PageIsOriginal(uint32 page) {
+            return memcmp(memory + page * PAGE_SIZE, original.data() + page * PAGE_SIZE,
+                          PAGE_SIZE) == 0;
+        }
+
+        void Capture(char savestate, uint64 systemCycles) {
+            rewindBuffer.Capture(&savestate, 1, systemCycles);
+        }
+
+        char Savestate(size_t steps) {
+            EXPECT_EQ(rewindBuffer.GetSavestateSize(steps), 1u);
+
+            return *static_cast<const char*>(rewindBuffer.GetSavestate(steps));
+        }
+
+       protected:
+        uint8* memory{nullptr};
+        vector<uint8> original;
+
+        RewindBuffer rewindBuffer;
+    };
+
+    TEST_F(RewindBufferTest, itRestoresMemoryAtDepth) {
+        rewindBuffer.SetCapacity(1024 * 1024);
+
+        Write(0, 1);
+        Capture('a', 10);
+
+        Write(0, 2);
+        Write(1, 2);
+        Capture('b', 20);
+
+        Write(0, 3);
+        Capture('c', 30);
+
+        Write(2, 4);
+
+        ASSERT_EQ(rewindBuffer.GetDepth(), 3u);
+        EXPECT_EQ(rewindBuffer.GetSystemCycles(2), 10u);
+
+        ASSERT_TRUE(rewindBuffer.Restore(1));
+
+        EXPECT_EQ(rewindBuffer.GetDepth(), 2u);
+        EXPECT_EQ(Savestate(0), 'b');
+        EXPECT_TRUE(PageIs(0, 2));
+        EXPECT_TRUE(PageIs(1, 2));
+        EXPECT_TRUE(PageIsOriginal(2));
+
+        ASSERT_TRUE(rewindBuffer.Restore(1));
+
+        EXPECT_EQ(rewindBuffer.GetDepth(), 1u);
+        EXPECT_EQ(Savestate(0), 'a');
+        EXPECT_TRUE(PageIs(0, 1));
+        EXPECT_TRUE(PageIsOriginal(1));
+    }
+
+    TEST_F(RewindBufferTest, itRevertsUncapturedWritesAtDepthZero) {
+        rewindBuffer.SetCapacity(1024 * 1024);
+
+        Capture('a', 10);
+        Write(3, 7);
+
+        ASSERT_TRUE(rewindBuffer.Restore(0));
+
+        EXPECT_EQ(rewindBuffer.GetDepth(), 1u);
+        EXPECT_TRUE(PageIsOriginal(3));
+    }
+
+    TEST_F(RewindBufferTest, aRolledBackRestoreKeepsMemoryAndHistory) {
+        rewindBuffer.SetCapacity(1024 * 1024);
+
+        Write(0, 1);
+        Capture('a', 10);
+
+        Write(0, 2);
+        Capture('b', 20);
+
+        Write(1, 3);
+
+        ASSERT_TRUE(rewindBuffer.BeginRestore(1));
+
+        EXPECT_TRUE(PageIs(0, 1));
+        EXPECT_TRUE(PageIsOriginal(1));
+        EXPECT_EQ(rewindBuffer.GetDepth(), 2u);
+
+        rewindBuffer.RollBackRestore();
+
+        EXPECT_TRUE(PageIs(0, 2));
+        EXPECT_TRUE(PageIs(1, 3));
+        EXPECT_EQ(rewindBuffer.GetDepth(), 2u);
+
+        // The history still works after the rollback.
+        ASSERT_TRUE(rewindBuffer.Restore(1));
+
+        EXPECT_EQ(Savestate(0), 'a');
+        EXPECT_TRUE(PageIs(0, 1));
+        EXPECT_TRUE(PageIsOriginal(1));
+    }
+
+    TEST_F(RewindBufferTest, writesBeforeTheCommitAreTracked) {
+        rewindBuffer.SetCapacity(1024 * 1024);
+
+        Write(0, 1);
+        Capture('a', 10);
+
+        Write(0, 2);
+        Capture('b', 20);
+
+        ASSERT_TRUE(rewindBuffer.BeginRestore(1));
+
+        // Loading the savestate may write memory before the restore is done.
+        Write(2, 5);
+        rewindBuffer.CommitRestore();
+
+        EXPECT_EQ(rewindBuffer.GetDepth(), 1u);
+        EXPECT_TRUE(PageIs(2, 5));
+
+        ASSERT_TRUE(rewindBuffer.Restore(0));
+
+        EXPECT_TRUE(PageIs(0, 1));
+        EXPECT_TRUE(PageIsOriginal(2));
+    }
+
+    TEST_F(RewindBufferTest, itDropsTheOldestPointsWhenFull) {
+        // Every point but the latest holds one undo page and its savestate.
+        rewindBuffer.SetCapacity(3 * POINT_SIZE + 1);
+
+        for (uint8 i = 0; i < 10; i++) {
+            Write(0, i);
+            Capture('0' + i, i);
+        }
+
+        ASSERT_EQ(rewindBuffer.GetDepth(), 4u);
+        EXPECT_LE(rewindBuffer.GetHistorySize(), rewindBuffer.GetCapacity());
+        EXPECT_EQ(rewindBuffer.GetSystemCycles(3), 6u);
+
+        ASSERT_TRUE(rewindBuffer.Restore(3));
+
+        EXPECT_EQ(Savestate(0), '6');
+        EXPECT_TRUE(PageIs(0, 6));
+
+        // The history keeps working after it was trimmed and unwound.
+        Write(0, 42);
+        Capture('x', 20);
+
+        ASSERT_TRUE(rewindBuffer.Restore(1));
+        EXPECT_TRUE(PageIs(0, 6));
+    }
+
+    TEST_F(RewindBufferTest, itRejectsRestoresBeyondTheHistory) {
+        rewindBuffer.SetCapacity(1024 * 1024);
+
+        Write(0, 1);
+        Capture('a', 10);
+        Write(0, 2);
+
+        EXPECT_FALSE(rewindBuffer.Restore(1));
+        EXPECT_TRUE(PageIs(0, 2));
+
+        rewindBuffer.SetCapacity(0);
+
+        EXPECT_FALSE(rewindBuffer.IsEnabled());
+        EXPECT_EQ(rewindBuffer.GetDepth(), 0u);
+    }
+
+    TEST_F(RewindBufferTest, rewindUpdatesTheClockInRestoredMemory) {
+        Boot();
+
+        gSession->ConfigureRewind(16 * 1024 * 1024, 10);
+
+        setRtcHours(0);
+        while (gSession->GetRewindBuffer().GetDepth() < 2) gSession->RunEmulation(100000);
+        setRtcHours(1);
+
+        ASSERT_TRUE(gSession->Rewind(0));
+
+        EXPECT_GT(getRtcHours(), 1u);
+    }
+}  // namespace
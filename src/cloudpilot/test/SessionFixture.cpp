@@ -0,0 +1,93 @@
+#include "SessionFixture.h"
+
+#include <fstream>
+#include <iterator>
+
+// clang-format off
+#include "EmCPU68K.h"
+#include "EmDevice.h"
+#include "EmLowMem.h"
+#include "EmMemory.h"
+#include "EmPalmStructs.h"
+#include "EmROMReader.h"
+#include "EmSession.h"
+#include "EmSystemState.h"
+// clang-format on
+
+namespace {
+    constexpr const char* IMAGE_DIR = "../../web/embedded/public";
+}
+
+vector<uint8> readRom(const string& name) {
+    ifstream stream(string(IMAGE_DIR) + "/" + name, ios::binary);
+
+    return vector<uint8>(istreambuf_iterator<char>(stream), istreambuf_iterator<char>());
+}
+
+bool initializeSession(vector<uint8>& rom, const string& deviceId) {
+    EmROMReader reader(rom.data(), rom.size());
+    if (!reader.Read()) return false;
+
+    EmDevice* device = new EmDevice(deviceId);
+    if (!device->Supported() || !device->SupportsROM(reader)) {
+        delete device;
+        return false;
+    }
+
+    return gSession->Initialize(device, rom.data(), rom.size());
+}
+
+bool bootSession(uint32 sliceCycles) {
+    while (!gSystemState->IsUIInitialized() && gSession->GetSystemCycles() < MAX_BOOT_CYCLES)
+        gSession->RunEmulation(sliceCycles);
+
+    return gSystemState->IsUIInitialized();
+}
+
+uint32 getRtcHours() {
+    CEnableFullAccess munge;
+
+    return EmAliasTimGlobalsType<PAS>(EmLowMem_GetGlobal(timGlobalsP)).rtcHours;
+}
+
+void setRtcHours(uint32 hours) {
+    CEnableFullAccess munge;
+
+    EmAliasTimGlobalsType<PAS>(EmLowMem_GetGlobal(timGlobalsP)).rtcHours = hours;
+}
+
+CapturedState captureState() {
+    CapturedState state;
+
+    state.systemCycles = gSession->GetSystemCycles();
+
+    for (int reg = e68KRegID_D0; reg <= e68KRegID_SR; reg++)
+        state.registers.push_back(gCPU68K->GetRegister(reg));
+
+    state.memory.assign(EmMemory::GetTotalMemory(),
+                        EmMemory::GetTotalMemory() + EmMemory::GetTotalMemorySize());
+
+    return state;
+}
+
+void expectStatesEqual(const CapturedState& actual, const CapturedState& expected) {
+    EXPECT_EQ(actual.systemCycles, expected.systemCycles);
+    EXPECT_EQ(actual.registers, expected.registers);
+    EXPECT_TRUE(actual.memory == expected.memory) << "memory differs";
+}
+
+void PalmVSessionTest::SetUp() {
+    rom = readRom("palmv.rom");
+    if (rom.empty()) GTEST_SKIP() << "ROM image not available";
+
+    ASSERT_TRUE(initializeSession(rom, "PalmV"));
+    initialized = true;
+}
+
+void PalmVSessionTest::TearDown() {
+    if (initialized) gSession->Deinitialize();
+
+    initialized = false;
+}
+
+void PalmVSessionTest::Boot() { ASSERT_TRUE(bootSession()); }
@@ -0,0 +1,52 @@
+#ifndef _TEST_SESSION_FIXTURE_H_
+#define _TEST_SESSION_FIXTURE_H_
+
+#include <gtest/gtest.h>
+
+#include "EmCommon.h"
+
+// Helpers for tests that run gSession on a real ROM. ROMs are read from
+// ../../web/embedded/public (relative to src/cloudpilot); tests skip if they
+// are not available.
+
+constexpr uint64 MAX_BOOT_CYCLES = 100000000;
+
+// Returns an empty buffer if the ROM is not available.
+vector<uint8> readRom(const string& name);
+
+// Initializes gSession, failing if the device does not support the ROM.
+bool initializeSession(vector<uint8>& rom, const string& deviceId);
+
+// Runs gSession until the launcher is up or MAX_BOOT_CYCLES have passed.
+bool bootSession(uint32 sliceCycles = 100000);
+
+// The hours adjustment of the RTC, set by EmSession from the host date
+// whenever a savestate is loaded.
+uint32 getRtcHours();
+void setRtcHours(uint32 hours);
+
+// Cycle count, CPU registers and memory of gSession.
+struct CapturedState {
+    uint64 systemCycles;
+    vector<uint32> registers;
+    vector<uint8> memory;
+};
+
+CapturedState captureState();
+void expectStatesEqual(const CapturedState& actual, const CapturedState& expected);
+
+// Initializes a Palm V session for every test and tears it down afterwards.
+// Subclasses that override SetUp return early if the test has been skipped.
+class PalmVSessionTest : public ::testing::Test {
+   protected:
+    void SetUp() override;
+    void TearDown() override;
+
+    void Boot();
+
+   protected:
+    vector<uint8> rom;
+    bool initialized{false};
+};
+
+#endif  // _TEST_SESSION_FIXTURE_H_
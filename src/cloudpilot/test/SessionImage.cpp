@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+// clang-format off
+#include "SessionImage.h"
+#include "miniz.h"
+// clang-format on
+
+namespace {
+    class VectorSink : public SessionImageSink {
+       public:
+        bool Write(const void* data, size_t size) override {
+            const uint8* bytes = static_cast<const uint8*>(data);
+            buffer.insert(buffer.end(), bytes, bytes + size);
+
+            return true;
+        }
+
+        vector<uint8> buffer;
+    };
+
+    class FailingSink : public SessionImageSink {
+       public:
+        bool Write(const void* data, size_t size) override { return false; }
+    };
+
+    void put32(uint8* buffer, uint32 value) {
+        buffer[0] = value & 0xff;
+        buffer[1] = (value >> 8) & 0xff;
+        buffer[2] = (value >> 16) & 0xff;
+        buffer[3] = (value >> 24) & 0xff;
+    }
+
+    vector<uint8> pattern(size_t size, uint32 seed) {
+        vector<uint8> data(size);
+
+        // Compressible, but not trivially so
+        for (size_t i = 0; i < size; i++) data[i] = ((i >> 4) * seed) ^ (i % 7 == 0 ? i : 0);
+
+        return data;
+    }
+
+    class SessionImageTest : public ::testing::Test {
+       protected:
+        void SetUp() override {
+            rom = pattern(64 * 1024, 3);
+            ram = pattern(600 * 1024, 5);
+            savestate = pattern(1000, 7);
+            metadata = {'{', '}'};
+
+            image.SetDeviceId("PalmV")
+                .SetRomImage(rom.data(), rom.size())
+                .SetMemoryImage(ram.data(), ram.size())
+                .SetSavestate(savestate.data(), savestate.size())
+                .SetMetadata(metadata.data(), metadata.size());
+        }
+
+        void AssertMatches(SessionImage& deserialized) {
+            ASSERT_STREQ(deserialized.GetDeviceId(), "PalmV");
+
+            ASSERT_EQ(deserialized.GetRomImageSize(), rom.size());
+            ASSERT_EQ(memcmp(deserialized.GetRomImage(), rom.data(), rom.size()), 0);
+
+            ASSERT_EQ(deserialized.GetMemoryImageSize(), ram.size());
+            ASSERT_EQ(memcmp(deserialized.GetMemoryImage(), ram.data(), ram.size()), 0);
+
+            ASSERT_EQ(deserialized.GetSavestateSize(), savestate.size());
+            ASSERT_EQ(memcmp(deserialized.GetSavestate(), savestate.data(), savestate.size()), 0);
+
+            ASSERT_EQ(deserialized.GetMetadataSize(), metadata.size());
+            ASSERT_EQ(memcmp(deserialized.GetMetadata(), metadata.data(), metadata.size()), 0);
+        }
+
+        vector<uint8> rom, ram, savestate, metadata;
+        SessionImage image;
+    };
+
+    TEST_F(SessionImageTest, chunkedImageRoundtrips) {
+        ASSERT_TRUE(image.Serialize());
+        ASSERT_LT(image.GetSerializedImageSize(), rom.size() + ram.size());
+
+        SessionImage deserialized;
+        ASSERT_TRUE(deserialized.Deserialize(image.GetSerializedImage(),
+                                             image.GetSerializedImageSize()));
+
+        ASSERT_EQ(deserialized.GetVersion(), 5u);
+        AssertMatches(deserialized);
+    }
+
+    TEST_F(SessionImageTest, storedImageRoundtrips) {
+        image.SetCompressionLevel(SessionImage::COMPRESSION_LEVEL_STORE);
+        ASSERT_TRUE(image.Serialize());
+        ASSERT_GT(image.GetSerializedImageSize(),
+                  rom.size() + ram.size() + savestate.size() + metadata.size());
+
+        SessionImage deserialized;
+        ASSERT_TRUE(deserialized.Deserialize(image.GetSerializedImage(),
+                                             image.GetSerializedImageSize()));
+
+        AssertMatches(deserialized);
+    }
+
+    TEST_F(SessionImageTest, sinkReceivesTheSameImage) {
+        ASSERT_TRUE(image.Serialize());
+
+        const uint8* serializedImage = static_cast<const uint8*>(image.GetSerializedImage());
+        vector<uint8> buffer(serializedImage, serializedImage + image.GetSerializedImageSize());
+
+        VectorSink sink;
+        ASSERT_TRUE(image.Serialize(sink));
+
+        ASSERT_EQ(image.GetSerializedImageSize(), buffer.size());
+        ASSERT_EQ(sink.buffer, buffer);
+
+        FailingSink failingSink;
+        ASSERT_FALSE(image.Serialize(failingSink));
+    }
+
+    TEST_F(SessionImageTest, corruptImagesAreRejected) {
+        VectorSink sink;
+        ASSERT_TRUE(image.Serialize(sink));
+
+        SessionImage deserialized;
+        ASSERT_FALSE(deserialized.Deserialize(sink.buffer.data(), sink.buffer.size() - 1));
+
+        // Flip a byte in the last chunk
+        sink.buffer[sink.buffer.size() - 2] ^= 0xff;
+        ASSERT_FALSE(deserialized.Deserialize(sink.buffer.data(), sink.buffer.size()));
+    }
+
+    TEST_F(SessionImageTest, version4ImagesCanBeRead) {
+        const size_t uncompressedSize =
+            20 + 5 + metadata.size() + rom.size() + ram.size() + savestate.size();
+        vector<uint8> payload(uncompressedSize);
+        uint8* next = payload.data();
+
+        put32(next, 5);
+        put32(next + 4, metadata.size());
+        put32(next + 8, rom.size());
+        put32(next + 12, ram.size());
+        put32(next + 16, savestate.size());
+        next += 20;
+
+        for (auto section : {vector<uint8>{'P', 'a', 'l', 'm', 'V'}, metadata, rom, ram,
+                             savestate}) {
+            memcpy(next, section.data(), section.size());
+            next += section.size();
+        }
+
+        mz_ulong compressedSize = compressBound(uncompressedSize);
+        vector<uint8> legacyImage(12 + compressedSize);
+
+        ASSERT_EQ(compress(legacyImage.data() + 12, &compressedSize, payload.data(),
+                           uncompressedSize),
+                  Z_OK);
+
+        put32(legacyImage.data(), 0x20150103);
+        put32(legacyImage.data() + 4, 0x80000004);
+        put32(legacyImage.data() + 8, uncompressedSize);
+
+        SessionImage deserialized;
+        ASSERT_TRUE(deserialized.Deserialize(legacyImage.data(), 12 + compressedSize));
+
+        ASSERT_EQ(deserialized.GetVersion(), 4u);
+        AssertMatches(deserialized);
+    }
+}  // namespace
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+// clang-format off
+#include "SessionStats.h"
+// clang-format on
+
+namespace {
+    TEST(SessionStatsTest, itCapturesCounters) {
+        SessionStats stats;
+
+        stats.AddStoppedCycles(100);
+        stats.CountTrap();
+        stats.CountTrap();
+        stats.CountInterrupt();
+        stats.CountScreenUpdate();
+        stats.CountFrame();
+        stats.CountSavestate(1000);
+        stats.CountSavestate(2000);
+
+        SessionStats::Snapshot snapshot = stats.Capture(5, 1000, 400, 300);
+
+        EXPECT_EQ(snapshot.timestamp, 5);
+        EXPECT_EQ(snapshot.clocksPerSecond, 1000u);
+        EXPECT_EQ(snapshot.cycles, 400u);
+        EXPECT_EQ(snapshot.instructions, 300u);
+        EXPECT_EQ(snapshot.stoppedCycles, 100u);
+        EXPECT_EQ(snapshot.traps, 2u);
+        EXPECT_EQ(snapshot.interrupts, 1u);
+        EXPECT_EQ(snapshot.screenUpdates, 1u);
+        EXPECT_EQ(snapshot.frames, 1u);
+        EXPECT_EQ(snapshot.savestates, 2u);
+        EXPECT_EQ(snapshot.savestateSize, 2000u);
+
+        stats.Reset();
+        snapshot = stats.Capture(5, 1000, 0, 0);
+
+        EXPECT_EQ(snapshot.stoppedCycles, 0u);
+        EXPECT_EQ(snapshot.traps, 0u);
+        EXPECT_EQ(snapshot.savestateSize, 0u);
+    }
+
+    TEST(SessionStatsTest, itCalculatesRatesBetweenSnapshots) {
+        SessionStats stats;
+        const SessionStats::Snapshot from = stats.Capture(1000, 1000000, 0, 0);
+
+        stats.AddStoppedCycles(1500000);
+        for (int i = 0; i < 100; i++) stats.CountTrap();
+        for (int i = 0; i < 20; i++) stats.CountInterrupt();
+        for (int i = 0; i < 40; i++) stats.CountFrame();
+
+        const SessionStats::Snapshot to = stats.Capture(3000, 1000000, 2000000, 4000000);
+        const SessionStats::Rates rates = SessionStats::CalculateRates(from, to);
+
+        EXPECT_DOUBLE_EQ(rates.seconds, 2);
+        EXPECT_DOUBLE_EQ(rates.mips, 2);
+        EXPECT_DOUBLE_EQ(rates.cyclesPerSecond, 1000000);
+        EXPECT_DOUBLE_EQ(rates.speed, 1);
+        EXPECT_DOUBLE_EQ(rates.idleRatio, 0.75);
+        EXPECT_DOUBLE_EQ(rates.trapsPerSecond, 50);
+        EXPECT_DOUBLE_EQ(rates.interruptsPerSecond, 10);
+        EXPECT_DOUBLE_EQ(rates.framesPerSecond, 20);
+    }
+
+    TEST(SessionStatsTest, itTreatsCountersThatWentBackwardsAsZero) {
+        SessionStats stats;
+        stats.CountTrap();
+
+        const SessionStats::Snapshot from = stats.Capture(1000, 1000, 5000, 5000);
+
+        stats.Reset();
+        const SessionStats::Snapshot to = stats.Capture(2000, 1000, 1000, 1000);
+
+        const SessionStats::Rates rates = SessionStats::CalculateRates(from, to);
+
+        EXPECT_DOUBLE_EQ(rates.mips, 0);
+        EXPECT_DOUBLE_EQ(rates.cyclesPerSecond, 0);
+        EXPECT_DOUBLE_EQ(rates.idleRatio, 0);
+        EXPECT_DOUBLE_EQ(rates.trapsPerSecond, 0);
+    }
+
+    TEST(SessionStatsTest, itDoesNotDivideByZero) {
+        SessionStats stats;
+        const SessionStats::Snapshot snapshot = stats.Capture(1000, 0, 1000, 1000);
+
+        const SessionStats::Rates rates = SessionStats::CalculateRates(snapshot, snapshot);
+
+        EXPECT_DOUBLE_EQ(rates.seconds, 0);
+        EXPECT_DOUBLE_EQ(rates.mips, 0);
+        EXPECT_DOUBLE_EQ(rates.speed, 0);
+        EXPECT_DOUBLE_EQ(rates.idleRatio, 0);
+    }
+
+    TEST(SessionStatsTest, itFormatsALogLine) {
+        SessionStats stats;
+        const SessionStats::Snapshot from = stats.Capture(0, 1000000, 0, 0);
+
+        stats.CountSavestate(4096);
+        const SessionStats::Snapshot to = stats.Capture(1000, 1000000, 2000000, 3000000);
+
+        EXPECT_EQ(SessionStats::FormatLogLine(to, SessionStats::CalculateRates(from, to)),
+                  "mips=3.00 mcycles/s=2.00 speed=2.00 idle=0.00 traps/s=0.0 irq/s=0.0 "
+                  "screen/s=0.0 fps=0.0 savestate=4096");
+    }
+
+    TEST(SessionStatsTest, itWritesJson) {
+        SessionStats stats;
+        stats.CountFrame();
+
+        const SessionStats::Snapshot snapshot = stats.Capture(0, 1000, 10, 5);
+        std::ostringstream stream;
+
+        SessionStats::WriteJson(stream, snapshot, SessionStats::CalculateRates(snapshot, snapshot));
+
+        EXPECT_NE(stream.str().find("\"frames\": 1"), std::string::npos);
+        EXPECT_NE(stream.str().find("\"instructions\": 5"), std::string::npos);
+        EXPECT_NE(stream.str().find("\"rates\": {\"seconds\": 0"), std::string::npos);
+    }
+}  // namespace
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+
+// clang-format off
+#include "SpscQueue.h"
+// clang-format on
+
+namespace {
+    TEST(SpscQueueTest, isEmptyOnCreation) {
+        SpscQueue<uint8> queue(3);
+
+        EXPECT_EQ(queue.GetUsed(), 0);
+        EXPECT_EQ(queue.GetFree(), 3);
+        EXPECT_EQ(queue.GetMaxSize(), 3);
+    }
+
+    TEST(SpscQueueTest, itIsFirstInFirstOut) {
+        SpscQueue<uint8> queue(3);
+
+        EXPECT_TRUE(queue.Put(1));
+        EXPECT_TRUE(queue.Put(2));
+
+        EXPECT_EQ(queue.GetUsed(), 2);
+        EXPECT_EQ(queue.Peek(), 1);
+        EXPECT_EQ(queue.Get(), 1);
+        EXPECT_EQ(queue.Get(), 2);
+        EXPECT_EQ(queue.GetUsed(), 0);
+    }
+
+    TEST(SpscQueueTest, putDropsValuesIfTheQueueIsFull) {
+        SpscQueue<uint8> queue(3);
+
+        EXPECT_TRUE(queue.Put(1));
+        EXPECT_TRUE(queue.Put(2));
+        EXPECT_TRUE(queue.Put(3));
+        EXPECT_FALSE(queue.Put(4));
+
+        EXPECT_EQ(queue.GetFree(), 0);
+
+        EXPECT_EQ(queue.Get(), 1);
+        EXPECT_TRUE(queue.Put(5));
+
+        EXPECT_EQ(queue.Get(), 2);
+        EXPECT_EQ(queue.Get(), 3);
+        EXPECT_EQ(queue.Get(), 5);
+    }
+
+    TEST(SpscQueueTest, itWrapsAround) {
+        SpscQueue<uint32> queue(5);
+
+        for (uint32 i = 0; i < 1000; i++) {
+            ASSERT_TRUE(queue.Put(i));
+            ASSERT_TRUE(queue.Put(i + 1));
+
+            ASSERT_EQ(queue.Get(), i);
+            ASSERT_EQ(queue.Get(), i + 1);
+        }
+
+        EXPECT_EQ(queue.GetUsed(), 0);
+    }
+
+    TEST(SpscQueueTest, clearDestroysTheRemainingValues) {
+        auto value = make_shared<int>(42);
+        SpscQueue<shared_ptr<int>> queue(4);
+
+        queue.Put(value);
+        queue.Put(value);
+        EXPECT_EQ(value.use_count(), 3);
+
+        queue.Clear();
+
+        EXPECT_EQ(value.use_count(), 1);
+        EXPECT_EQ(queue.GetUsed(), 0);
+
+        queue.Put(value);
+        EXPECT_EQ(*queue.Get(), 42);
+        EXPECT_EQ(value.use_count(), 1);
+    }
+
+    TEST(SpscQueueTest, itTransfersValuesBetweenThreadsInOrder) {
+        constexpr uint32 COUNT = 200000;
+
+        SpscQueue<uint32> queue(20);
+
+        thread producer([&]() {
+            for (uint32 i = 0; i < COUNT; i++)
+                while (!queue.Put(i)) this_thread::yield();
+        });
+
+        uint32 mismatches = 0;
+
+        for (uint32 i = 0; i < COUNT; i++) {
+            while (queue.GetUsed() == 0) this_thread::yield();
+
+            if (queue.Get() != i) mismatches++;
+        }
+
+        producer.join();
+
+        EXPECT_EQ(mismatches, 0u);
+        EXPECT_EQ(queue.GetUsed(), 0);
+    }
+}  // namespace
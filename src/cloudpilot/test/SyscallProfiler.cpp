@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+// clang-format off
+#include "SyscallProfiler.h"
+#include "EmStructs.h"
+// clang-format on
+
+namespace {
+    constexpr uint16 TRAP_MEM_CHUNK_NEW = 0xA011;
+    constexpr uint16 TRAP_MEM_MOVE = 0xA026;
+
+    class SyscallProfilerTest : public ::testing::Test {
+       protected:
+        void SetUp() override { profiler.Start(); }
+
+        SystemCallContext Context(uint16 trapWord, emuptr nextPc) {
+            SystemCallContext context;
+
+            context.fPC = nextPc - 2;
+            context.fNextPC = nextPc;
+            context.fTrapWord = trapWord;
+            context.fTrapIndex = trapWord & 0x0fff;
+            context.fExtra = 0;
+            context.fViaTrap = true;
+            context.fViaJsrA1 = false;
+
+            return context;
+        }
+
+        SyscallProfiler::Stats StatsFor(uint16 trapWord) {
+            for (auto& entry : profiler.GetStats())
+                if (entry.trapWord == trapWord) return entry;
+
+            return {};
+        }
+
+       protected:
+        SyscallProfiler profiler;
+    };
+
+    TEST_F(SyscallProfilerTest, itMeasuresInclusiveCycles) {
+        profiler.RecordCall(Context(TRAP_MEM_MOVE, 0x1000), 100, true);
+        profiler.RecordCall(Context(TRAP_MEM_CHUNK_NEW, 0x2000), 120, true);
+
+        EXPECT_TRUE(profiler.RecordReturn(0x2000, 150));
+        EXPECT_TRUE(profiler.RecordReturn(0x1000, 200));
+        EXPECT_FALSE(profiler.RecordReturn(0x1000, 300));
+
+        EXPECT_EQ(StatsFor(TRAP_MEM_MOVE).calls, 1u);
+        EXPECT_EQ(StatsFor(TRAP_MEM_MOVE).inclusiveCycles, 100u);
+        EXPECT_EQ(StatsFor(TRAP_MEM_CHUNK_NEW).inclusiveCycles, 30u);
+
+        EXPECT_EQ(profiler.GetStats().front().name, "sysTrapMemMove");
+    }
+
+    TEST_F(SyscallProfilerTest, itUnwindsCallsThatNeverReturn) {
+        profiler.RecordCall(Context(TRAP_MEM_MOVE, 0x1000), 0, true);
+        profiler.RecordCall(Context(TRAP_MEM_CHUNK_NEW, 0x2000), 10, true);
+
+        EXPECT_TRUE(profiler.RecordReturn(0x1000, 50));
+
+        EXPECT_FALSE(profiler.IsReturnAddress(0x2000));
+        EXPECT_TRUE(profiler.GetReturnAddresses().empty());
+        EXPECT_EQ(StatsFor(TRAP_MEM_CHUNK_NEW).inclusiveCycles, 0u);
+    }
+
+    TEST_F(SyscallProfilerTest, itMatchesTheInnermostRecursiveCall) {
+        profiler.RecordCall(Context(TRAP_MEM_MOVE, 0x1000), 0, true);
+        profiler.RecordCall(Context(TRAP_MEM_MOVE, 0x1000), 10, true);
+
+        EXPECT_TRUE(profiler.RecordReturn(0x1000, 15));
+        EXPECT_TRUE(profiler.IsReturnAddress(0x1000));
+        EXPECT_TRUE(profiler.RecordReturn(0x1000, 20));
+
+        EXPECT_EQ(StatsFor(TRAP_MEM_MOVE).calls, 2u);
+        EXPECT_EQ(StatsFor(TRAP_MEM_MOVE).inclusiveCycles, 25u);
+    }
+
+    TEST_F(SyscallProfilerTest, itDropsPendingCallsOnClear) {
+        profiler.RecordCall(Context(TRAP_MEM_MOVE, 0x1000), 0, true);
+        profiler.RecordHeadpatch(Context(TRAP_MEM_MOVE, 0x1000), 500);
+
+        profiler.Clear();
+        profiler.RecordCall(Context(TRAP_MEM_MOVE, 0x1000), 10, false);
+
+        EXPECT_TRUE(profiler.RecordReturn(0x1000, 100));
+
+        EXPECT_EQ(StatsFor(TRAP_MEM_MOVE).calls, 1u);
+        EXPECT_EQ(StatsFor(TRAP_MEM_MOVE).inclusiveCycles, 0u);
+        EXPECT_EQ(StatsFor(TRAP_MEM_MOVE).headpatchNsec, 0u);
+    }
+
+    TEST_F(SyscallProfilerTest, itWritesCsvAndJson) {
+        profiler.RecordCall(Context(TRAP_MEM_MOVE, 0x1000), 0, false);
+        profiler.RecordHeadpatch(Context(TRAP_MEM_MOVE, 0x1000), 500);
+        profiler.RecordTailpatch(Context(TRAP_MEM_MOVE, 0x1000), 250);
+
+        ostringstream csv;
+        profiler.WriteCsv(csv);
+
+        EXPECT_EQ(csv.str(),
+                  "name,trap,calls,inclusive cycles,headpatch calls,headpatch nsec,tailpatch "
+                  "calls,tailpatch nsec\n"
+                  "sysTrapMemMove,0xa026,1,0,1,500,1,250\n");
+
+        ostringstream json;
+        profiler.WriteJson(json);
+
+        EXPECT_EQ(json.str(),
+                  "[\n"
+                  "  {\"name\": \"sysTrapMemMove\", \"trap\": 40998, \"calls\": 1, "
+                  "\"inclusiveCycles\": 0, \"headpatchCalls\": 1, \"headpatchNsec\": 500, "
+                  "\"tailpatchCalls\": 1, \"tailpatchNsec\": 250}\n"
+                  "]\n");
+    }
+}  // namespace
@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+// clang-format off
+#include "Turbo.h"
+// clang-format on
+
+namespace {
+    TEST(TurboTest, itIsUnlimitedByDefault) {
+        Turbo turbo;
+        turbo.Enable(1000);
+
+        EXPECT_TRUE(turbo.IsEnabled());
+        EXPECT_TRUE(std::isinf(turbo.GetLag(1000)));
+    }
+
+    TEST(TurboTest, itLimitsEmulatedTimeToTheSpeed) {
+        Turbo turbo;
+        turbo.Enable(1000, 4);
+
+        EXPECT_DOUBLE_EQ(turbo.GetLag(1000), 0);
+        EXPECT_DOUBLE_EQ(turbo.GetLag(1050), 200);
+    }
+
+    TEST(TurboTest, itDoesNotCatchUpOnMoreThanMaxLag) {
+        Turbo turbo;
+        turbo.Enable(0, 2);
+
+        EXPECT_DOUBLE_EQ(turbo.GetLag(10000), Turbo::MAX_LAG_MSEC);
+        EXPECT_DOUBLE_EQ(turbo.GetLag(10100), Turbo::MAX_LAG_MSEC);
+    }
+
+    TEST(TurboTest, itPresentsFramesAtTheConfiguredCadence) {
+        Turbo turbo;
+
+        EXPECT_TRUE(turbo.IsFrameDue(0));
+
+        turbo.SetFrameInterval(100);
+        turbo.Enable(0);
+
+        EXPECT_FALSE(turbo.IsFrameDue(50));
+        EXPECT_TRUE(turbo.IsFrameDue(100));
+        EXPECT_FALSE(turbo.IsFrameDue(150));
+        EXPECT_TRUE(turbo.IsFrameDue(220));
+
+        turbo.Disable();
+
+        EXPECT_TRUE(turbo.IsFrameDue(230));
+    }
+}  // namespace
@@ -1,7 +1,9 @@
 #include "Cloudpilot.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <sstream>
 
 #include "ButtonEvent.h"
 #include "DbInstaller.h"
@@ -16,7 +18,10 @@
 #include "Feature.h"
 #include "MemoryStick.h"
 #include "NetworkProxy.h"
+#include "Platform.h"
 #include "SuspendManager.h"
+#include "SyscallProfiler.h"
+#include "Turbo.h"
 
 namespace {
     EmTransportSerialBuffer serialTransportIR;
@@ -117,19 +122,47 @@ int Cloudpilot::RunEmulation(int cycles) { return gSession->RunEmulation(cycles)
 
 void Cloudpilot::SetClockFactor(double clockFactor) { gSession->SetClockFactor(clockFactor); }
 
+void Cloudpilot::EnableTurbo(double speed) { gTurbo->Enable(Platform::GetMilliseconds(), speed); }
+
+void Cloudpilot::DisableTurbo() { gTurbo->Disable(); }
+
+bool Cloudpilot::IsTurbo() { return gTurbo->IsEnabled(); }
+
+void Cloudpilot::SetTurboFrameInterval(int frameInterval) {
+    gTurbo->SetFrameInterval(max(frameInterval, 0));
+}
+
+int Cloudpilot::RunEmulationTurbo(int budgetMsec) {
+    return gTurbo->Run(*gSession, max(budgetMsec, 0));
+}
+
+bool Cloudpilot::IsTurboFrameDue() { return gTurbo->IsFrameDue(Platform::GetMilliseconds()); }
+
 Frame& Cloudpilot::CopyFrame() {
     EmHAL::CopyLCDFrame(frame);
 
     return frame;
 }
 
-bool Cloudpilot::IsScreenDirty() { return gSystemState.IsScreenDirty(); }
+void Cloudpilot::SetFramePalette(void* palette) {
+    frameConverter.SetPalette(static_cast<const uint32*>(palette));
+}
+
+void* Cloudpilot::ConvertFrame() {
+    if (frame.hasChanges && frame.bpp != 24)
+        frameConverter.Convert(frame, convertedFrame.get(), frame.lineWidth,
+                               EmHAL::GetLCD2bitMapping());
+
+    return convertedFrame.get();
+}
 
-bool Cloudpilot::IsUIInitialized() { return gSystemState.IsUIInitialized(); }
+bool Cloudpilot::IsScreenDirty() { return gSystemState->IsScreenDirty(); }
 
-int Cloudpilot::GetOSVersion() { return gSystemState.OSVersion(); }
+bool Cloudpilot::IsUIInitialized() { return gSystemState->IsUIInitialized(); }
 
-void Cloudpilot::MarkScreenClean() { gSystemState.MarkScreenClean(); }
+int Cloudpilot::GetOSVersion() { return gSystemState->OSVersion(); }
+
+void Cloudpilot::MarkScreenClean() { gSystemState->MarkScreenClean(); }
 
 int Cloudpilot::MinMemoryForDevice(string id) {
     EmDevice device(id);
@@ -167,7 +200,7 @@ void Cloudpilot::QueueKeyboardEvent(uint16 c, bool ctrl) {
 
 bool Cloudpilot::IsPowerOff() { return !gSession->IsPowerOn(); }
 
-bool Cloudpilot::IsSetupComplete() { return gSystemState.IsSetupComplete(); }
+bool Cloudpilot::IsSetupComplete() { return gSystemState->IsSetupComplete(); }
 
 void Cloudpilot::Reset() { gSession->Reset(EmSession::ResetType::soft); }
 
@@ -218,9 +251,82 @@ bool Cloudpilot::LoadState(void* buffer, int len) {
     return gSession->Load(len, reinterpret_cast<uint8*>(buffer));
 }
 
+void Cloudpilot::ConfigureRewind(int capacity, int intervalMsec) {
+    gSession->ConfigureRewind(max(capacity, 0), max(intervalMsec, 0));
+}
+
+bool Cloudpilot::Rewind(int msec) { return gSession->Rewind(max(msec, 0)); }
+
+int Cloudpilot::GetRewindDepth() { return gSession->GetRewindBuffer().GetDepth(); }
+
+bool Cloudpilot::CaptureSnapshot(bool full) {
+    return gSession->CaptureSnapshot(snapshot, full) && snapshot.Serialize();
+}
+
+void* Cloudpilot::GetSnapshotPtr() { return snapshot.GetSerializedImage(); }
+
+int Cloudpilot::GetSnapshotSize() { return snapshot.GetSerializedImageSize(); }
+
+bool Cloudpilot::AddSnapshotToChain(void* buffer, int len) {
+    DeltaSnapshot link;
+    if (!link.Deserialize(buffer, max(len, 0))) return false;
+
+    snapshotChain.push_back(move(link));
+
+    return true;
+}
+
+bool Cloudpilot::LoadSnapshotChain() {
+    if (snapshotChain.empty() || gSession->IsRecording() || gSession->IsReplaying()) {
+        snapshotChain.clear();
+        return false;
+    }
+
+    DeltaSnapshot base = move(snapshotChain.front());
+    snapshotChain.erase(snapshotChain.begin());
+
+    const bool success = gSession->LoadSnapshot(base, snapshotChain);
+    snapshotChain.clear();
+
+    return success;
+}
+
+bool Cloudpilot::StartRecording(int checkpointIntervalMsec) {
+    return gSession->StartRecording(recording, max(checkpointIntervalMsec, 0));
+}
+
+void Cloudpilot::StopRecording() { gSession->StopRecording(); }
+
+bool Cloudpilot::IsRecording() { return gSession->IsRecording(); }
+
+bool Cloudpilot::SerializeRecording() {
+    return !gSession->IsRecording() && !recording.GetCheckpoints().empty() &&
+           recording.Serialize();
+}
+
+void* Cloudpilot::GetRecordingPtr() { return recording.GetSerializedImage(); }
+
+int Cloudpilot::GetRecordingSize() { return recording.GetSerializedImageSize(); }
+
+bool Cloudpilot::StartReplay(void* buffer, int len) {
+    if (gSession->IsRecording() || gSession->IsReplaying()) return false;
+
+    return recording.Deserialize(buffer, max(len, 0)) && gSession->StartReplay(recording);
+}
+
+bool Cloudpilot::SeekReplay(int msec) {
+    const uint64 offset = static_cast<uint64>(max(msec, 0)) * gSession->GetClocksPerSecond() / 1000;
+
+    return gSession->SeekReplay(recording.GetStartCycles() + offset);
+}
+
+void Cloudpilot::StopReplay() { gSession->StopReplay(); }
+
+bool Cloudpilot::IsReplaying() { return gSession->IsReplaying(); }
+
 const char* Cloudpilot::GetHotsyncName() {
     static string name;
-    name = gSystemState.GetHotsyncUserName();
+    name = gSystemState->GetHotsyncUserName();
 
     return name.c_str();
 }
@@ -250,13 +356,63 @@ bool Cloudpilot::GetNetworkRedirection() { return Feature::GetNetworkRedirection
 void Cloudpilot::RegisterProxyDisconnectHandler(uint32 handlerPtr) {
     typedef void (*handler_ptr)(const char*);
 
-    gNetworkProxy.onDisconnect.AddHandler(reinterpret_cast<handler_ptr>(handlerPtr));
+    gNetworkProxy->onDisconnect.AddHandler(reinterpret_cast<handler_ptr>(handlerPtr));
 }
 
 void Cloudpilot::SetHotsyncNameManagement(bool toggle) {
     Feature::SetHotsyncNameManagement(toggle);
 }
 
+void Cloudpilot::SetSyscallProfiling(bool toggle) {
+    if (toggle)
+        gSyscallProfiler->Start();
+    else
+        gSyscallProfiler->Stop();
+}
+
+bool Cloudpilot::GetSyscallProfiling() { return gSyscallProfiler->IsRunning(); }
+
+void Cloudpilot::ResetSyscallProfile() { gSyscallProfiler->Clear(); }
+
+const char* Cloudpilot::GetSyscallProfileCsv() {
+    static string csv;
+
+    ostringstream stream;
+    gSyscallProfiler->WriteCsv(stream);
+    csv = stream.str();
+
+    return csv.c_str();
+}
+
+const char* Cloudpilot::GetSyscallProfileJson() {
+    static string json;
+
+    ostringstream stream;
+    gSyscallProfiler->WriteJson(stream);
+    json = stream.str();
+
+    return json.c_str();
+}
+
+const char* Cloudpilot::GetStatsJson() {
+    static string json;
+
+    const SessionStats::Snapshot snapshot = gSession->GetStatsSnapshot();
+
+    ostringstream stream;
+    SessionStats::WriteJson(stream, snapshot,
+                            SessionStats::CalculateRates(lastStats.value_or(snapshot), snapshot));
+    json = stream.str();
+
+    lastStats = snapshot;
+
+    return json.c_str();
+}
+
+void Cloudpilot::SetStatsLogInterval(int intervalMsec) {
+    gSession->SetStatsLogInterval(max(intervalMsec, 0));
+}
+
 bool Cloudpilot::LaunchAppByName(const char* name) {
     string encodedName = Utf8ToIsolatin1(name);
     if (encodedName.length() > 31) return false;
@@ -277,13 +433,13 @@ bool Cloudpilot::DeviceSupportsCardSize(uint32 size) {
            EmHAL::SupportsImageInSlot(EmHAL::Slot::memorystick, size / 512);
 }
 
-void Cloudpilot::ClearExternalStorage() { gExternalStorage.Clear(); }
+void Cloudpilot::ClearExternalStorage() { gExternalStorage->Clear(); }
 
 bool Cloudpilot::AllocateCard(const char* key, uint32 blockCount) {
     uint8* data = new uint8[CardImage::BLOCK_SIZE * blockCount];
     memset(data, 0, CardImage::BLOCK_SIZE * blockCount);
 
-    if (!gExternalStorage.AddImage(key, data, CardImage::BLOCK_SIZE * blockCount)) {
+    if (!gExternalStorage->AddImage(key, data, CardImage::BLOCK_SIZE * blockCount)) {
         delete[] data;
         return false;
     }
@@ -292,7 +448,7 @@ bool Cloudpilot::AllocateCard(const char* key, uint32 blockCount) {
 }
 
 bool Cloudpilot::AdoptCard(const char* key, void* data, uint32 blockCount) {
-    if (!gExternalStorage.AddImage(key, static_cast<uint8_t*>(data),
+    if (!gExternalStorage->AddImage(key, static_cast<uint8_t*>(data),
                                    CardImage::BLOCK_SIZE * blockCount)) {
         free(data);
         return false;
@@ -301,32 +457,32 @@ bool Cloudpilot::AdoptCard(const char* key, void* data, uint32 blockCount) {
     return true;
 }
 
-bool Cloudpilot::MountCard(const char* key) { return gExternalStorage.Mount(key); }
+bool Cloudpilot::MountCard(const char* key) { return gExternalStorage->Mount(key); }
 
-bool Cloudpilot::RemoveCard(const char* key) { return gExternalStorage.RemoveImage(key); }
+bool Cloudpilot::RemoveCard(const char* key) { return gExternalStorage->RemoveImage(key); }
 
 void* Cloudpilot::GetCardData(const char* key) {
-    CardImage* image = gExternalStorage.GetImage(key);
+    CardImage* image = gExternalStorage->GetImage(key);
     if (!image) return nullptr;
 
     return image->RawData();
 }
 
 void* Cloudpilot::GetCardDirtyPages(const char* key) {
-    CardImage* image = gExternalStorage.GetImage(key);
+    CardImage* image = gExternalStorage->GetImage(key);
     if (!image) return nullptr;
 
     return image->DirtyPages();
 }
 
 int Cloudpilot::GetCardSize(const char* key) {
-    CardImage* image = gExternalStorage.GetImage(key);
+    CardImage* image = gExternalStorage->GetImage(key);
     if (!image) return 0;
 
     return image->BlocksTotal() * CardImage::BLOCK_SIZE;
 }
 
-void Cloudpilot::RemountCards() { gExternalStorage.Remount(); }
+void Cloudpilot::RemountCards() { gExternalStorage->Remount(); }
 
 int Cloudpilot::GetSupportLevel(uint32 size) {
     if (size % 512) return static_cast<int>(CardSupportLevel::unsupported);
@@ -345,9 +501,9 @@ const char* Cloudpilot::GetMountedKey() {
     key = "";
 
     for (auto slot : {EmHAL::Slot::memorystick, EmHAL::Slot::sdcard}) {
-        if (!gExternalStorage.IsMounted(slot)) continue;
+        if (!gExternalStorage->IsMounted(slot)) continue;
 
-        key = gExternalStorage.GetImageKeyInSlot(slot);
+        key = gExternalStorage->GetImageKeyInSlot(slot);
         break;
     }
 
@@ -2,12 +2,17 @@
 #define _CLOUDPILOT_H_
 
 #include <memory>
+#include <optional>
 #include <string>
 
 #include "DbBackup.h"
+#include "DeltaSnapshot.h"
 #include "EmDevice.h"
 #include "EmTransportSerialBuffer.h"
 #include "Frame.h"
+#include "FrameConverter.h"
+#include "Recording.h"
+#include "SessionStats.h"
 #include "SuspendContext.h"
 
 enum class CardSupportLevel : int { unsupported = 0, sdOnly = 1, sdAndMs = 2 };
@@ -26,7 +31,16 @@ class Cloudpilot {
     int RunEmulation(int cycles);
     void SetClockFactor(double clockFactor);
 
+    void EnableTurbo(double speed);
+    void DisableTurbo();
+    bool IsTurbo();
+    void SetTurboFrameInterval(int frameInterval);
+    int RunEmulationTurbo(int budgetMsec);
+    bool IsTurboFrameDue();
+
     Frame& CopyFrame();
+    void SetFramePalette(void* palette);
+    void* ConvertFrame();
     bool IsScreenDirty();
     void MarkScreenClean();
 
@@ -69,6 +83,31 @@ class Cloudpilot {
     bool SaveState();
     bool LoadState(void* buffer, int len);
 
+    void ConfigureRewind(int capacity, int intervalMsec);
+    bool Rewind(int msec);
+    int GetRewindDepth();
+
+    // Snapshots after the first only contain the pages that changed since the
+    // previous one. A chain is restored by adding the full snapshot and its
+    // deltas in order and loading it.
+    bool CaptureSnapshot(bool full);
+    void* GetSnapshotPtr();
+    int GetSnapshotSize();
+    bool AddSnapshotToChain(void* buffer, int len);
+    bool LoadSnapshotChain();
+
+    bool StartRecording(int checkpointIntervalMsec);
+    void StopRecording();
+    bool IsRecording();
+    bool SerializeRecording();
+    void* GetRecordingPtr();
+    int GetRecordingSize();
+
+    bool StartReplay(void* buffer, int len);
+    bool SeekReplay(int msec);
+    void StopReplay();
+    bool IsReplaying();
+
     const char* GetHotsyncName();
     void SetHotsyncName(const char* name);
 
@@ -88,6 +127,16 @@ class Cloudpilot {
 
     void SetHotsyncNameManagement(bool toggle);
 
+    void SetSyscallProfiling(bool toggle);
+    bool GetSyscallProfiling();
+    void ResetSyscallProfile();
+    const char* GetSyscallProfileCsv();
+    const char* GetSyscallProfileJson();
+
+    // Rates are calculated since the previous call.
+    const char* GetStatsJson();
+    void SetStatsLogInterval(int intervalMsec);
+
     bool LaunchAppByName(const char* name);
     bool LaunchAppByDbHeader(void* header, int len);
 
@@ -109,6 +158,16 @@ class Cloudpilot {
 
    private:
     Frame frame{320 * 480 * 4};
+
+    FrameConverter frameConverter;
+    unique_ptr<uint32[]> convertedFrame{make_unique<uint32[]>(320 * 480)};
+
+    Recording recording;
+
+    DeltaSnapshot snapshot;
+    vector<DeltaSnapshot> snapshotChain;
+
+    optional<SessionStats::Snapshot> lastStats;
 };
 
 #endif  // _CLOUDPILOT_H_
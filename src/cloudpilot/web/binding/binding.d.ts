@@ -72,7 +72,16 @@ export interface Cloudpilot {
     RunEmulation(cycles: number): number;
     SetClockFactor(clockFactor: number): number;
 
+    EnableTurbo(speed: number): void;
+    DisableTurbo(): void;
+    IsTurbo(): boolean;
+    SetTurboFrameInterval(frameInterval: number): void;
+    RunEmulationTurbo(budgetMsec: number): number;
+    IsTurboFrameDue(): boolean;
+
     CopyFrame(): Frame;
+    SetFramePalette(palette: VoidPtr): void;
+    ConvertFrame(): VoidPtr;
     IsScreenDirty(): boolean;
     MarkScreenClean(): void;
     IsSetupComplete(): boolean;
@@ -115,6 +124,28 @@ export interface Cloudpilot {
     SaveState(): boolean;
     LoadState(buffer: VoidPtr, len: number): boolean;
 
+    ConfigureRewind(capacity: number, intervalMsec: number): void;
+    Rewind(msec: number): boolean;
+    GetRewindDepth(): number;
+
+    CaptureSnapshot(full: boolean): boolean;
+    GetSnapshotPtr(): VoidPtr;
+    GetSnapshotSize(): number;
+    AddSnapshotToChain(buffer: VoidPtr, len: number): boolean;
+    LoadSnapshotChain(): boolean;
+
+    StartRecording(checkpointIntervalMsec: number): boolean;
+    StopRecording(): void;
+    IsRecording(): boolean;
+    SerializeRecording(): boolean;
+    GetRecordingPtr(): VoidPtr;
+    GetRecordingSize(): number;
+
+    StartReplay(buffer: VoidPtr, len: number): boolean;
+    SeekReplay(msec: number): boolean;
+    StopReplay(): void;
+    IsReplaying(): boolean;
+
     GetHotsyncName(): string;
     SetHotsyncName(name: string): void;
 
@@ -134,6 +165,15 @@ export interface Cloudpilot {
 
     SetHotsyncNameManagement(toggle: boolean): void;
 
+    SetSyscallProfiling(toggle: boolean): void;
+    GetSyscallProfiling(): boolean;
+    ResetSyscallProfile(): void;
+    GetSyscallProfileCsv(): string;
+    GetSyscallProfileJson(): string;
+
+    GetStatsJson(): string;
+    SetStatsLogInterval(intervalMsec: number): void;
+
     LaunchAppByName(name: string): boolean;
     LaunchAppByDbHeader(buffer: VoidPtr, len: number): boolean;
 
@@ -163,6 +203,8 @@ export interface Frame {
 
     GetFirstDirtyLine(): number;
     GetLastDirtyLine(): number;
+    GetFirstDirtyColumn(): number;
+    GetLastDirtyColumn(): number;
     GetHasChanges(): boolean;
 
     GetBuffer(): VoidPtr;
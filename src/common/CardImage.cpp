@@ -3,7 +3,18 @@
 #include <algorithm>
 #include <cstring>
 
-CardImage::CardImage(uint8_t* data, size_t blocksTotal) : data(data), blocksTotal(blocksTotal) {
+#ifndef __EMSCRIPTEN__
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+CardImage::CardImage(uint8_t* data, size_t blocksTotal)
+    : CardImage(data, blocksTotal, Backing::heap) {}
+
+CardImage::CardImage(uint8_t* data, size_t blocksTotal, Backing backing)
+    : data(data), blocksTotal(blocksTotal), backing(backing) {
     const size_t pageCount = (blocksTotal >> 4) + ((blocksTotal % 16 != 0) > 0 ? 1 : 0);
     const size_t dirtyPageBufferSize = (pageCount >> 3) + ((pageCount % 8) > 0 ? 1 : 0);
 
@@ -11,13 +22,53 @@ CardImage::CardImage(uint8_t* data, size_t blocksTotal) : data(data), blocksTota
     memset(dirtyPages.get(), 0, dirtyPageBufferSize);
 }
 
+CardImage::~CardImage() {
+#ifndef __EMSCRIPTEN__
+    if (IsMapped()) {
+        Sync();
+        munmap(data, blocksTotal * BLOCK_SIZE);
+
+        return;
+    }
+#endif
+
+    delete[] data;
+}
+
+#ifndef __EMSCRIPTEN__
+std::unique_ptr<CardImage> CardImage::Map(const char* path, MapMode mode) {
+    const int fd = open(path, mode == MapMode::writeBack ? O_RDWR : O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0 ||
+        fileStat.st_size % BLOCK_SIZE != 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    const size_t size = fileStat.st_size;
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                         mode == MapMode::writeBack ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+
+    // The mapping keeps its own reference to the file.
+    close(fd);
+
+    if (mapping == MAP_FAILED) return nullptr;
+
+    return std::unique_ptr<CardImage>(new CardImage(
+        static_cast<uint8_t*>(mapping), size / BLOCK_SIZE,
+        mode == MapMode::writeBack ? Backing::mapWriteBack : Backing::mapCopyOnWrite));
+}
+#endif
+
 size_t CardImage::Read(uint8_t* dest, size_t index, size_t count) {
     if (index >= blocksTotal) return 0;
 
     count = std::min(count, blocksTotal - index);
 
     for (size_t i = 0; i < count; i++)
-        memcpy(dest + i * BLOCK_SIZE, data.get() + (i + index) * BLOCK_SIZE, BLOCK_SIZE);
+        memcpy(dest + i * BLOCK_SIZE, data + (i + index) * BLOCK_SIZE, BLOCK_SIZE);
 
     return count;
 }
@@ -28,7 +79,7 @@ size_t CardImage::Write(const uint8_t* source, size_t index, size_t count) {
     count = std::min(count, blocksTotal - index);
 
     for (size_t block = index; block < index + count; block++) {
-        memcpy(data.get() + block * BLOCK_SIZE, source + (block - index) * BLOCK_SIZE, BLOCK_SIZE);
+        memcpy(data + block * BLOCK_SIZE, source + (block - index) * BLOCK_SIZE, BLOCK_SIZE);
 
         const size_t page = block >> 4;
         dirtyPages[page >> 3] |= 1 << (page & 0x07);
@@ -43,7 +94,7 @@ bool CardImage::WriteByteRange(const uint8_t* source, size_t offset, size_t coun
     if (offset + count > blocksTotal * BLOCK_SIZE) return false;
     if (count == 0) return true;
 
-    memcpy(data.get() + offset, source, count);
+    memcpy(data + offset, source, count);
 
     MarkRangeDirty(offset, count);
 
@@ -53,7 +104,7 @@ bool CardImage::WriteByteRange(const uint8_t* source, size_t offset, size_t coun
 bool CardImage::ReadByteRange(uint8_t* destination, size_t offset, size_t count) {
     if (offset + count > blocksTotal * BLOCK_SIZE) return false;
 
-    memcpy(destination, data.get() + offset, count);
+    memcpy(destination, data + offset, count);
 
     return true;
 }
@@ -68,6 +119,17 @@ void CardImage::MarkRangeDirty(size_t offset, size_t count) {
     }
 }
 
-uint8_t* CardImage::RawData() { return data.get(); }
+uint8_t* CardImage::RawData() { return data; }
 
 uint8_t* CardImage::DirtyPages() { return dirtyPages.get(); }
+
+bool CardImage::IsMapped() const { return backing != Backing::heap; }
+
+bool CardImage::Sync() {
+#ifndef __EMSCRIPTEN__
+    if (backing == Backing::mapWriteBack)
+        return msync(data, blocksTotal * BLOCK_SIZE, MS_SYNC) == 0;
+#endif
+
+    return true;
+}
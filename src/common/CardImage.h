@@ -10,8 +10,28 @@ class CardImage {
     constexpr static size_t BLOCK_SIZE = 512;
     constexpr static size_t DIRTY_PAGE_SIZE = 8192;
 
+#ifndef __EMSCRIPTEN__
+    enum class MapMode { copyOnWrite, writeBack };
+#endif
+
    public:
+    // Takes ownership of data, which must have been allocated with new[].
     CardImage(uint8_t* data, size_t blocksTotal);
+    ~CardImage();
+
+#ifndef __EMSCRIPTEN__
+    // Maps an image file instead of reading it into memory. Pages are only
+    // loaded once they are accessed, and unmodified pages are shared with all
+    // other mappings of the same file.
+    //
+    // copyOnWrite: the file is left untouched, modified pages are copied to
+    //              private memory (the overlay)
+    // writeBack:   modifications are written back to the file
+    //
+    // Returns nullptr if the file cannot be mapped or if its size is not a
+    // multiple of the block size.
+    static std::unique_ptr<CardImage> Map(const char* path, MapMode mode);
+#endif
 
     size_t Read(uint8_t* dest, size_t index, size_t count = 1);
     size_t Write(const uint8_t* source, size_t index, size_t count = 1);
@@ -25,10 +45,29 @@ class CardImage {
     uint8_t* RawData();
     uint8_t* DirtyPages();
 
+    bool IsMapped() const;
+
+    // Flushes modifications to the file for writeBack mappings. A no-op
+    // otherwise. Called on unmount and when the image is destroyed.
+    bool Sync();
+
+   private:
+    enum class Backing { heap, mapCopyOnWrite, mapWriteBack };
+
+   private:
+    CardImage(uint8_t* data, size_t blocksTotal, Backing backing);
+
    private:
-    std::unique_ptr<uint8_t[]> data;
+    uint8_t* data;
     std::unique_ptr<uint8_t[]> dirtyPages;
     size_t blocksTotal;
+    Backing backing;
+
+   private:
+    CardImage(const CardImage&) = delete;
+    CardImage(CardImage&&) = delete;
+    CardImage& operator=(const CardImage&) = delete;
+    CardImage& operator=(CardImage&&) = delete;
 };
 
 #endif  // _CARD_IMAGE_H_
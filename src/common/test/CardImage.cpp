@@ -0,0 +1,111 @@
+#include "CardImage.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    constexpr size_t BLOCKS = 64;
+
+    class CardImageTest : public ::testing::Test {
+       protected:
+        void SetUp() override {
+            char path[] = "/tmp/card-image-test-XXXXXX";
+            const int fd = mkstemp(path);
+            ASSERT_GE(fd, 0);
+            close(fd);
+
+            file = path;
+
+            vector<uint8_t> content(BLOCKS * CardImage::BLOCK_SIZE);
+            for (size_t i = 0; i < content.size(); i++) content[i] = i / CardImage::BLOCK_SIZE;
+
+            WriteFile(content);
+        }
+
+        void TearDown() override { remove(file.c_str()); }
+
+        void WriteFile(const vector<uint8_t>& content) {
+            ofstream stream(file, ios::binary | ios::trunc);
+            stream.write(reinterpret_cast<const char*>(content.data()), content.size());
+        }
+
+        vector<uint8_t> ReadFile() {
+            ifstream stream(file, ios::binary);
+
+            return vector<uint8_t>(istreambuf_iterator<char>(stream), istreambuf_iterator<char>());
+        }
+
+        string file;
+    };
+
+    TEST_F(CardImageTest, mappedImageReadsFile) {
+        auto image = CardImage::Map(file.c_str(), CardImage::MapMode::copyOnWrite);
+        ASSERT_TRUE(image);
+
+        ASSERT_TRUE(image->IsMapped());
+        ASSERT_EQ(image->BlocksTotal(), BLOCKS);
+
+        uint8_t block[CardImage::BLOCK_SIZE];
+        ASSERT_EQ(image->Read(block, 42), 1u);
+        ASSERT_EQ(block[0], 42);
+        ASSERT_EQ(block[CardImage::BLOCK_SIZE - 1], 42);
+    }
+
+    TEST_F(CardImageTest, copyOnWriteLeavesFileUntouched) {
+        auto image = CardImage::Map(file.c_str(), CardImage::MapMode::copyOnWrite);
+        ASSERT_TRUE(image);
+
+        uint8_t block[CardImage::BLOCK_SIZE];
+        memset(block, 0xff, sizeof(block));
+
+        ASSERT_EQ(image->Write(block, 17), 1u);
+        ASSERT_TRUE(image->Sync());
+
+        ASSERT_EQ(image->RawData()[17 * CardImage::BLOCK_SIZE], 0xff);
+        ASSERT_EQ(image->DirtyPages()[0], 0x02);
+
+        ASSERT_EQ(ReadFile()[17 * CardImage::BLOCK_SIZE], 17);
+    }
+
+    TEST_F(CardImageTest, writeBackUpdatesFile) {
+        auto image = CardImage::Map(file.c_str(), CardImage::MapMode::writeBack);
+        ASSERT_TRUE(image);
+
+        const uint8_t data[] = {0xde, 0xad};
+        ASSERT_TRUE(image->WriteByteRange(data, 5 * CardImage::BLOCK_SIZE + 1, sizeof(data)));
+        ASSERT_TRUE(image->Sync());
+
+        image.reset();
+
+        vector<uint8_t> content = ReadFile();
+        ASSERT_EQ(content[5 * CardImage::BLOCK_SIZE], 5);
+        ASSERT_EQ(content[5 * CardImage::BLOCK_SIZE + 1], 0xde);
+        ASSERT_EQ(content[5 * CardImage::BLOCK_SIZE + 2], 0xad);
+    }
+
+    TEST_F(CardImageTest, mappingRequiresWholeBlocks) {
+        WriteFile(vector<uint8_t>(CardImage::BLOCK_SIZE + 1));
+        ASSERT_FALSE(CardImage::Map(file.c_str(), CardImage::MapMode::copyOnWrite));
+
+        WriteFile(vector<uint8_t>());
+        ASSERT_FALSE(CardImage::Map(file.c_str(), CardImage::MapMode::copyOnWrite));
+
+        ASSERT_FALSE(CardImage::Map("/nonexistent/card.img", CardImage::MapMode::copyOnWrite));
+    }
+
+    TEST(CardImageHeapTest, heapImageIsNotMapped) {
+        CardImage image(new uint8_t[4 * CardImage::BLOCK_SIZE](), 4);
+
+        ASSERT_FALSE(image.IsMapped());
+        ASSERT_TRUE(image.Sync());
+    }
+}  // namespace
@@ -1,6 +1,8 @@
 
 #include "CmdFsck.h"
 
+#include <sys/stat.h>
+
 #include <fstream>
 #include <iostream>
 
@@ -17,33 +19,29 @@ CmdFsk::CmdFsk(const argparse::ArgumentParser& cmd) : imageFile(cmd.get(ARGUMENT
 }
 
 bool CmdFsk::Run() {
-    size_t len;
+    struct stat fileStat;
 
-    {
-        fstream stream(imageFile, ios_base::in);
-        if (stream.fail()) {
-            cout << "unable to open '" << imageFile << "'" << endl;
-            return false;
-        }
+    if (stat(imageFile.c_str(), &fileStat) != 0) {
+        cout << "unable to open '" << imageFile << "'" << endl;
+        return false;
+    }
 
-        stream.seekg(0, ios_base::end);
-        len = stream.tellg();
-        stream.seekg(0, ios_base::beg);
+    if (fileStat.st_size == 0 || fileStat.st_size % CardImage::BLOCK_SIZE != 0) {
+        cout << "invalid image: not a multiple of 512 byte sectors" << endl;
+        return false;
+    }
 
-        if (len % 512) {
-            cout << "invalid image: not a multiple of 512 byte sectors" << endl;
-            return false;
-        }
+    // fsck never modifies the image file itself, so a private mapping avoids
+    // reading the whole image into memory.
+    unique_ptr<CardImage> mappedImage =
+        CardImage::Map(imageFile.c_str(), CardImage::MapMode::copyOnWrite);
 
-        data = make_unique<uint8_t[]>(len);
-        stream.read(reinterpret_cast<char*>(data.get()), len);
-        if (static_cast<size_t>(stream.gcount()) != len) {
-            cout << "failed to read '" << imageFile << "'" << endl;
-            return false;
-        }
+    if (!mappedImage) {
+        cout << "unable to map '" << imageFile << "'" << endl;
+        return false;
     }
 
-    CardImage image(data.release(), len >> 9);
+    CardImage& image(*mappedImage);
     CardVolume volume(image);
 
     switch (volume.GetType()) {
@@ -1,8 +1,6 @@
 #ifndef _CMD_FSCK_H_
 #define _CMD_FSCK_H_
 
-#include <cstdint>
-#include <memory>
 #include <string>
 
 #include "argparse.h"
@@ -15,7 +13,6 @@ class CmdFsk {
 
    private:
     std::string imageFile;
-    std::unique_ptr<uint8_t[]> data;
 
     std::string writeFile;
 };
@@ -59,6 +59,8 @@ export interface Frame {
 
     firstDirtyLine: number;
     lastDirtyLine: number;
+    firstDirtyColumn: number;
+    lastDirtyColumn: number;
     hasChanges: boolean;
 
     scaleX: number;
@@ -227,6 +229,36 @@ export class Cloudpilot {
         return this.cloudpilot.RunEmulation(cycles);
     }
 
+    @guard()
+    enableTurbo(speed = 0): void {
+        this.cloudpilot.EnableTurbo(speed);
+    }
+
+    @guard()
+    disableTurbo(): void {
+        this.cloudpilot.DisableTurbo();
+    }
+
+    @guard()
+    isTurbo(): boolean {
+        return this.cloudpilot.IsTurbo();
+    }
+
+    @guard()
+    setTurboFrameInterval(frameInterval: number): void {
+        this.cloudpilot.SetTurboFrameInterval(frameInterval);
+    }
+
+    @guard()
+    runEmulationTurbo(budgetMsec: number): number {
+        return this.cloudpilot.RunEmulationTurbo(budgetMsec);
+    }
+
+    @guard()
+    isTurboFrameDue(): boolean {
+        return this.cloudpilot.IsTurboFrameDue();
+    }
+
     @guard()
     getFrame(): Frame {
         const nativeFrame = this.cloudpilot.CopyFrame();
@@ -241,6 +273,8 @@ export class Cloudpilot {
             margin: nativeFrame.GetMargin(),
             firstDirtyLine: nativeFrame.GetFirstDirtyLine(),
             lastDirtyLine: nativeFrame.GetLastDirtyLine(),
+            firstDirtyColumn: nativeFrame.GetFirstDirtyColumn(),
+            lastDirtyColumn: nativeFrame.GetLastDirtyColumn(),
             hasChanges: nativeFrame.GetHasChanges(),
             scaleX: nativeFrame.GetScaleX(),
             scaleY: nativeFrame.GetScaleY(),
@@ -248,6 +282,25 @@ export class Cloudpilot {
         };
     }
 
+    @guard()
+    setFramePalette(palette: Array<number>): void {
+        const buffer = this.copyIn32(new Uint32Array(palette));
+
+        this.cloudpilot.SetFramePalette(buffer);
+
+        this.cloudpilot.Free(buffer);
+    }
+
+    @guard()
+    convertFrame(frame: Frame): Uint32Array {
+        const ptr = this.module.getPointer(this.cloudpilot.ConvertFrame()) >>> 2;
+
+        return this.module.HEAPU32.subarray(
+            ptr,
+            ptr + frame.lineWidth * (frame.lastDirtyLine - frame.firstDirtyLine + 1),
+        );
+    }
+
     @guard()
     isScreenDirty(): boolean {
         return this.cloudpilot.IsScreenDirty();
@@ -436,6 +489,21 @@ export class Cloudpilot {
         return result;
     }
 
+    @guard()
+    configureRewind(capacity: number, intervalMsec: number): void {
+        this.cloudpilot.ConfigureRewind(capacity, intervalMsec);
+    }
+
+    @guard()
+    rewind(msec: number): boolean {
+        return !!this.cloudpilot.Rewind(msec);
+    }
+
+    @guard()
+    getRewindDepth(): number {
+        return this.cloudpilot.GetRewindDepth();
+    }
+
     @guard()
     getHotsyncName(): string {
         return this.cloudpilot.GetHotsyncName();
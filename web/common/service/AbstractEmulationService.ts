@@ -21,6 +21,7 @@ const DUMMY_SPEED = 1000;
 const MIN_MILLISECONDS_PER_PWD_UPDATE = 10;
 const SERIAL_SYNC_TIMEOUT_MSEC = 250;
 const MAX_IRDA_FRAME_BUFFER = 1024;
+const TURBO_BUDGET_MSEC = 10;
 
 class SerialPortImpl implements SerialPort {
     constructor() {}
@@ -182,6 +183,29 @@ export abstract class AbstractEmulationService {
         return this.cloudpilotInstance ? this.cloudpilotInstance.isSuspended() : false;
     }
 
+    /**
+     * Run emulation as fast as possible (speed = 0) or at a multiple of realtime instead of
+     * pacing it by the wall clock. The screen is updated at most once every frameInterval
+     * milliseconds while turbo mode is on.
+     */
+    enableTurbo(speed = 0, frameInterval?: number): void {
+        if (!this.cloudpilotInstance) return;
+
+        if (frameInterval !== undefined) this.cloudpilotInstance.setTurboFrameInterval(frameInterval);
+        this.cloudpilotInstance.enableTurbo(speed);
+    }
+
+    disableTurbo(): void {
+        if (!this.cloudpilotInstance?.isTurbo()) return;
+
+        this.cloudpilotInstance.disableTurbo();
+        this.clockEmulator = performance.now();
+    }
+
+    isTurbo(): boolean {
+        return this.cloudpilotInstance ? this.cloudpilotInstance.isTurbo() : false;
+    }
+
     getSerialPortSerial(): SerialPort {
         if (!this.serialPortSerial) throw new Error('emulator not initialized');
 
@@ -261,6 +285,7 @@ export abstract class AbstractEmulationService {
         }
 
         this.cloudpilotInstance = cloudpilot;
+        this.cloudpilotInstance.setFramePalette(GRAYSCALE_PALETTE_RGBA);
 
         this.deviceId = device;
         this.resetCanvas();
@@ -394,7 +419,7 @@ export abstract class AbstractEmulationService {
     }
 
     protected performScreenUpdate(): void {
-        if (this.cloudpilotInstance?.isScreenDirty()) {
+        if (this.cloudpilotInstance?.isScreenDirty() && this.cloudpilotInstance.isTurboFrameDue()) {
             this.updateScreen();
             this.cloudpilotInstance.markScreenClean();
 
@@ -459,50 +484,22 @@ export abstract class AbstractEmulationService {
         }
 
         const wasSuspended = this.cloudpilotInstance.isSuspended();
-        let isSuspended = false;
 
         // Scale the clock by the calculated emulation speed
         this.cloudpilotInstance.setClockFactor(this.emulationSpeed * this.getConfiguredSpeed());
 
-        // Limit the time that we try to catch up. This will avoid that we lock onto a low
-        // FPS if the emulation cannot run at full speed
-        if (timestamp - this.clockEmulator > 1000 / MIN_FPS) this.clockEmulator = timestamp - 1000 / MIN_FPS;
-
-        const cyclesToRun = ((timestamp - this.clockEmulator) / 1000) * this.cloudpilotInstance.cyclesPerSecond();
-
-        const timestampBeforeCycle = performance.now();
-
-        let cycles = 0;
-        while (cycles < cyclesToRun) {
-            cycles += this.cloudpilotInstance.runEmulation(Math.ceil(cyclesToRun - cycles));
-
-            if (this.cloudpilotInstance.isSuspended()) {
-                isSuspended = true;
+        let cycles: number;
 
-                break;
-            }
+        if (this.cloudpilotInstance.isTurbo()) {
+            // Turbo mode is not paced by the wall clock. Run for a fixed budget of host time
+            // instead and keep the emulator clock current for when turbo mode ends.
+            cycles = this.cloudpilotInstance.runEmulationTurbo(TURBO_BUDGET_MSEC);
+            this.clockEmulator = performance.now();
+        } else {
+            cycles = this.runEmulationPaced(timestamp);
         }
 
-        const virtualTimePassed = (cycles / this.cloudpilotInstance.cyclesPerSecond()) * 1000;
-        const realTimePassed = performance.now() - timestampBeforeCycle;
-
-        // If the emulation runs too slowly the amount of real time that passed will exceed the
-        // emulated time difference. In this case we compensate by advancing the emulated clock
-        // by the actual time difference; otherwise, the differences will pile up,
-        // resulting in jerky emulation. Our dynamic speed correction will make sure that
-        // this does not happen too often.
-        this.clockEmulator += Math.max(virtualTimePassed, realTimePassed);
-
-        // Update the speed average. Note that we need to compensate this for the factor
-        // by which we scaled the clock --- the factor represents the ratio for a device
-        // running at ful speed
-        this.speedAverage.push(
-            (virtualTimePassed / (realTimePassed > 0 ? realTimePassed : virtualTimePassed / DUMMY_SPEED)) *
-                this.emulationSpeed,
-        );
-
-        // Normalize the speed an apply hysteresis
-        this.updateEmulationSpeed(this.speedAverage.calculateAverage());
+        const isSuspended = this.cloudpilotInstance.isSuspended();
 
         if (isSuspended && !wasSuspended) {
             switch (this.cloudpilotInstance.getSuspendKind()) {
@@ -540,6 +537,49 @@ export abstract class AbstractEmulationService {
         this.onAfterAdvanceEmulation(timestamp, cycles);
     };
 
+    protected runEmulationPaced(timestamp: number): number {
+        const cloudpilot = this.cloudpilotInstance;
+        if (!cloudpilot) return 0;
+
+        // Limit the time that we try to catch up. This will avoid that we lock onto a low
+        // FPS if the emulation cannot run at full speed
+        if (timestamp - this.clockEmulator > 1000 / MIN_FPS) this.clockEmulator = timestamp - 1000 / MIN_FPS;
+
+        const cyclesToRun = ((timestamp - this.clockEmulator) / 1000) * cloudpilot.cyclesPerSecond();
+
+        const timestampBeforeCycle = performance.now();
+
+        let cycles = 0;
+        while (cycles < cyclesToRun) {
+            cycles += cloudpilot.runEmulation(Math.ceil(cyclesToRun - cycles));
+
+            if (cloudpilot.isSuspended()) break;
+        }
+
+        const virtualTimePassed = (cycles / cloudpilot.cyclesPerSecond()) * 1000;
+        const realTimePassed = performance.now() - timestampBeforeCycle;
+
+        // If the emulation runs too slowly the amount of real time that passed will exceed the
+        // emulated time difference. In this case we compensate by advancing the emulated clock
+        // by the actual time difference; otherwise, the differences will pile up,
+        // resulting in jerky emulation. Our dynamic speed correction will make sure that
+        // this does not happen too often.
+        this.clockEmulator += Math.max(virtualTimePassed, realTimePassed);
+
+        // Update the speed average. Note that we need to compensate this for the factor
+        // by which we scaled the clock --- the factor represents the ratio for a device
+        // running at ful speed
+        this.speedAverage.push(
+            (virtualTimePassed / (realTimePassed > 0 ? realTimePassed : virtualTimePassed / DUMMY_SPEED)) *
+                this.emulationSpeed,
+        );
+
+        // Normalize the speed an apply hysteresis
+        this.updateEmulationSpeed(this.speedAverage.calculateAverage());
+
+        return cycles;
+    }
+
     protected checkAndUpdateHotsyncName(): void {
         if (!this.cloudpilotInstance) return;
 
@@ -596,61 +636,12 @@ export abstract class AbstractEmulationService {
             const imageData32 = new Uint32Array(this.imageData.data.buffer);
 
             switch (frame.bpp) {
-                case 1: {
-                    const fg = GRAYSCALE_PALETTE_RGBA[15];
-                    const bg = GRAYSCALE_PALETTE_RGBA[0];
-                    let iDest = 0;
-
-                    for (let y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
-                        const offsetSrc = y * frame.bytesPerLine;
-
-                        for (let i = frame.margin; i < frame.lineWidth + frame.margin; i++) {
-                            imageData32[iDest++] =
-                                frame.buffer[offsetSrc + (i >>> 3)] & (0x80 >>> (i & 0x07)) ? fg : bg;
-                        }
-                    }
-
-                    break;
-                }
-
-                case 2: {
-                    const mapping = this.cloudpilotInstance.getPalette2bitMapping();
-                    const palette = [
-                        GRAYSCALE_PALETTE_RGBA[mapping & 0x000f],
-                        GRAYSCALE_PALETTE_RGBA[(mapping >>> 4) & 0x000f],
-                        GRAYSCALE_PALETTE_RGBA[(mapping >>> 8) & 0x000f],
-                        GRAYSCALE_PALETTE_RGBA[(mapping >>> 12) & 0x000f],
-                    ];
-                    let iDest = 0;
-
-                    for (let y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
-                        const offsetSrc = y * frame.bytesPerLine;
-
-                        for (let i = frame.margin; i < frame.lineWidth + frame.margin; i++) {
-                            imageData32[iDest++] =
-                                palette[(frame.buffer[offsetSrc + (i >>> 2)] >> (6 - 2 * (i & 0x03))) & 0x03];
-                        }
-                    }
-
-                    break;
-                }
-
-                case 4: {
-                    let iDest = 0;
-
-                    for (let y = frame.firstDirtyLine; y <= frame.lastDirtyLine; y++) {
-                        const offsetSrc = y * frame.bytesPerLine;
-
-                        for (let i = frame.margin; i < frame.lineWidth + frame.margin; i++) {
-                            imageData32[iDest++] =
-                                GRAYSCALE_PALETTE_RGBA[
-                                    (frame.buffer[offsetSrc + (i >>> 1)] >>> (4 - 4 * (i & 0x01))) & 0x0f
-                                ];
-                        }
-                    }
+                case 1:
+                case 2:
+                case 4:
+                    imageData32.set(this.cloudpilotInstance.convertFrame(frame));
 
                     break;
-                }
 
                 case 24:
                     {
@@ -689,29 +680,31 @@ export abstract class AbstractEmulationService {
         if (!this.imageData) return;
 
         const scaling = frame.scaleX !== 1 || frame.scaleY !== 1;
+        const dirtyColumns = frame.lastDirtyColumn - frame.firstDirtyColumn + 1;
+        const dirtyLines = frame.lastDirtyLine - frame.firstDirtyLine + 1;
 
         (scaling ? this.contextTmp : this.context).putImageData(
             this.imageData,
             0,
             frame.firstDirtyLine,
+            frame.firstDirtyColumn,
             0,
-            0,
-            frame.lineWidth,
-            frame.lastDirtyLine - frame.firstDirtyLine + 1,
+            dirtyColumns,
+            dirtyLines,
         );
 
         if (scaling) {
             this.context.imageSmoothingEnabled = false;
             this.context.drawImage(
                 this.canvasTmp,
-                0,
+                frame.firstDirtyColumn,
                 frame.firstDirtyLine,
-                frame.lineWidth,
-                frame.lastDirtyLine - frame.firstDirtyLine + 1,
-                0,
+                dirtyColumns,
+                dirtyLines,
+                frame.firstDirtyColumn * frame.scaleX,
                 frame.firstDirtyLine * frame.scaleY,
-                frame.lineWidth * frame.scaleX,
-                (frame.lastDirtyLine - frame.firstDirtyLine + 1) * frame.scaleY,
+                dirtyColumns * frame.scaleX,
+                dirtyLines * frame.scaleY,
             );
         }
 
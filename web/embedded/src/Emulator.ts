@@ -202,6 +202,26 @@ export interface Emulator {
      */
     getSpeed(): number;
 
+    /**
+     * Enable turbo mode. Emulation is no longer paced by the wall clock, and
+     * the screen is updated at a reduced rate. Use this to fast forward through
+     * boot, resets or installation.
+     *
+     * @param speed Maximum speed as a multiple of realtime (0 = unlimited)
+     * @param frameInterval Minimum time between screen updates in milliseconds
+     */
+    enableTurbo(speed?: number, frameInterval?: number): this;
+
+    /**
+     * Disable turbo mode and return to realtime emulation.
+     */
+    disableTurbo(): this;
+
+    /**
+     * Query whether turbo mode is enabled.
+     */
+    isTurbo(): boolean;
+
     /**
      * Set audio volume.
      *
@@ -597,6 +617,22 @@ export class EmulatorImpl implements Emulator {
         return this.session.speed;
     }
 
+    enableTurbo(speed = 0, frameInterval?: number): this {
+        this.emulationService.enableTurbo(speed, frameInterval);
+
+        return this;
+    }
+
+    disableTurbo(): this {
+        this.emulationService.disableTurbo();
+
+        return this;
+    }
+
+    isTurbo(): boolean {
+        return this.emulationService.isTurbo();
+    }
+
     setVolume(volume: number): this {
         this.audioService.setVolume(volume);
 